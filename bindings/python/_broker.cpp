@@ -157,7 +157,12 @@ PYBIND11_MODULE(_broker, m) {
     .def("drop_all_on_destruction", &broker::publisher::drop_all_on_destruction)
     .def("publish", (void (broker::publisher::*)(broker::data d)) &broker::publisher::publish)
     .def("publish_batch",
-       [](broker::publisher& p, std::vector<broker::data> xs) { p.publish(xs); })
+       [](broker::publisher& p, std::vector<broker::data> xs) {
+         // The batch is fully converted at this point, so other Python
+         // threads may run while we wait for capacity in the send buffer.
+         py::gil_scoped_release release;
+         p.publish(xs);
+       })
     .def("reset", &broker::publisher::reset);
 
   using subscriber_base = broker::subscriber_base<broker::subscriber::value_type>;
@@ -208,6 +213,34 @@ PYBIND11_MODULE(_broker, m) {
        return rval;
 	  })
 
+    .def("get_bulk",
+         [](subscriber_base& ep, size_t num) -> std::vector<topic_data_pair> {
+       std::vector<subscriber_base::value_type> res;
+       {
+         py::gil_scoped_release release;
+         res = ep.get(num);
+       }
+       std::vector<topic_data_pair> rval;
+       rval.reserve(res.size());
+       for ( auto& e : res )
+         rval.emplace_back(std::make_pair(broker::get_topic(e), broker::get_data(e)));
+       return rval;
+      })
+
+    .def("get_bulk",
+         [](subscriber_base& ep, size_t num, double secs) -> std::vector<topic_data_pair> {
+       std::vector<subscriber_base::value_type> res;
+       {
+         py::gil_scoped_release release;
+         res = ep.get(num, broker::to_duration(secs));
+       }
+       std::vector<topic_data_pair> rval;
+       rval.reserve(res.size());
+       for ( auto& e : res )
+         rval.emplace_back(std::make_pair(broker::get_topic(e), broker::get_data(e)));
+       return rval;
+      })
+
     .def("poll",
          [](subscriber_base& ep) -> std::vector<topic_data_pair> {
        auto res = ep.poll();
@@ -343,6 +376,9 @@ PYBIND11_MODULE(_broker, m) {
          xs.reserve(batch.size());
          for ( auto& m : batch )
            xs.emplace_back(std::move(m.first), std::move(m.second));
+         // Conversion is done; hand the batch to the core without holding up
+         // other Python threads.
+         py::gil_scoped_release release;
          ep.publish(std::move(xs));
        })
     .def("make_publisher", &broker::endpoint::make_publisher)
@@ -4,6 +4,7 @@ try:
 except ImportError:
     import _broker
 
+import asyncio
 import sys
 import datetime
 import time
@@ -91,8 +92,24 @@ Timespan = _broker.Timespan
 Timestamp = _broker.Timestamp
 Vector = _broker.Vector
 
+# Applications tend to publish to a small, mostly static set of topics, so we
+# cache the str -> Topic conversion instead of re-creating the binding object
+# for every message. Bounded to keep pathological workloads from growing the
+# cache without limit.
+_topic_cache = {}
+_TOPIC_CACHE_MAX_SIZE = 1024
+
 def _make_topic(t):
-    return (Topic(t) if not isinstance(t, Topic) else t)
+    if isinstance(t, Topic):
+        return t
+    if isinstance(t, str):
+        cached = _topic_cache.get(t)
+        if cached is None:
+            if len(_topic_cache) >= _TOPIC_CACHE_MAX_SIZE:
+                _topic_cache.clear()
+            cached = _topic_cache[t] = Topic(t)
+        return cached
+    return Topic(t)
 
 def _make_topics(ts):
     if isinstance(ts, Topic):
@@ -145,6 +162,35 @@ class Subscriber:
 
         assert False
 
+    def get_bulk(self, *args):
+        # Same semantics as get(n) / get(n, secs), but the drain happens with
+        # the GIL released, so other Python threads keep running while we wait.
+        msgs = self._subscriber.get_bulk(*args)
+        return [(d[0].string(), Data.to_py(d[1])) for d in msgs]
+
+    async def get_async(self):
+        # Awaitable variant of get(): yields one (topic, data) message
+        # without blocking the event loop. Built on loop.add_reader() over
+        # the subscriber's file descriptor, which becomes readable whenever
+        # the queue holds at least one message.
+        loop = asyncio.get_event_loop()
+        while not self.available():
+            fut = loop.create_future()
+            fd = self.fileno()
+
+            def _wake():
+                # The descriptor stays readable while the queue is non-empty,
+                # so the callback may fire again before remove_reader() runs.
+                if not fut.done():
+                    fut.set_result(None)
+
+            loop.add_reader(fd, _wake)
+            try:
+                await fut
+            finally:
+                loop.remove_reader(fd)
+        return self.get()
+
     def poll(self):
         msgs = self._subscriber.poll()
         return [(d[0].string(), Data.to_py(d[1])) for d in msgs]
@@ -155,6 +201,11 @@ class Subscriber:
     def fd(self):
         return self._subscriber.fd()
 
+    def fileno(self):
+        # File-object style alias for fd(), so subscribers work directly with
+        # select/poll and asyncio's loop.add_reader().
+        return self._subscriber.fd()
+
     def add_topic(self, topic, block=False):
         return self._subscriber.add_topic(_make_topic(topic), block)
 
@@ -220,6 +271,28 @@ class StatusSubscriber():
     def fd(self):
         return self._subscriber.fd()
 
+    def fileno(self):
+        # File-object style alias for fd(); see Subscriber.fileno().
+        return self._subscriber.fd()
+
+    async def get_async(self):
+        # Awaitable variant of get(); see Subscriber.get_async().
+        loop = asyncio.get_event_loop()
+        while not self.available():
+            fut = loop.create_future()
+            fd = self.fileno()
+
+            def _wake():
+                if not fut.done():
+                    fut.set_result(None)
+
+            loop.add_reader(fd, _wake)
+            try:
+                await fut
+            finally:
+                loop.remove_reader(fd)
+        return self.get()
+
     def _to_result(self, x):
         if isinstance(x, _broker.VectorStatusSubscriberValueType):
             return [self._to_error_or_status(xi) for xi in x]
@@ -395,6 +468,43 @@ class Store:
     def _to_expiry(self, e):
         return (_broker.OptionalTimespan(_broker.Timespan(float(e))) if e is not None else _broker.OptionalTimespan())
 
+    def make_proxy(self):
+        return StoreProxy(_broker.StoreProxy(self._store))
+
+class StoreProxy:
+    # Decouples lookup requests from response processing. Requests return a
+    # correlation id; responses arrive as (id, value) pairs.
+    def __init__(self, internal_proxy):
+        self._proxy = internal_proxy
+
+    def exists(self, key):
+        return self._proxy.exists(Data.from_py(key))
+
+    def get(self, key):
+        return self._proxy.get(Data.from_py(key))
+
+    def keys(self):
+        return self._proxy.keys()
+
+    def fd(self):
+        return self._proxy.fd()
+
+    def fileno(self):
+        return self._proxy.fd()
+
+    def _to_result(self, resp):
+        answer = resp.answer
+        value = Data.to_py(answer.get()) if answer.is_valid() else None
+        return (resp.id, value)
+
+    def receive(self):
+        return self._to_result(self._proxy.receive())
+
+    def receive_all(self):
+        # Blocks for the first response, then returns everything else that is
+        # already waiting; the whole batch costs a single mailbox wakeup.
+        return [self._to_result(r) for r in self._proxy.receive_all()]
+
 class Endpoint(_broker.Endpoint):
     def make_subscriber(self, topics, qsize = 20, subscriber_class=Subscriber):
         topics = _make_topics(topics)
@@ -1,5 +1,7 @@
 
 #include <cstdint>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <array>
 
@@ -7,6 +9,7 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
 #endif
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
@@ -190,7 +193,7 @@ void init_data(py::module& m) {
 
   py::bind_vector<broker::vector>(m, "Vector");
 
-  py::class_<broker::data> data_type{m, "Data"};
+  py::class_<broker::data> data_type{m, "Data", py::buffer_protocol()};
   data_type
     .def(py::init<>())
     .def(py::init<broker::data>())
@@ -235,6 +238,66 @@ void init_data(py::module& m) {
 	return s;
 	})
     .def("as_vector", [](const broker::data& d) { return broker::get<broker::vector>(d); })
+    // One-pass handoff for dense numeric vectors: returns a NumPy view over
+    // the vector storage instead of materializing one Python object per
+    // element. The array keeps a reference to the Data object and is
+    // readonly, since writes would bypass the Data API. Empty vectors yield
+    // an empty float64 array.
+    .def("as_numpy", [](py::object& self) -> py::array {
+      auto& d = py::cast<broker::data&>(self);
+      auto xs = broker::get_if<broker::vector>(d);
+      if (!xs)
+        throw std::invalid_argument("as_numpy requires a vector");
+      auto make_view = [&](auto* first) -> py::array {
+        using value_type = std::remove_pointer_t<decltype(first)>;
+        for (auto& x : *xs)
+          if (!broker::get_if<value_type>(x))
+            throw std::invalid_argument(
+              "as_numpy requires a homogeneous numeric vector");
+        py::array_t<value_type> rval{{static_cast<py::ssize_t>(xs->size())},
+                                     {py::ssize_t{sizeof(broker::data)}},
+                                     first, self};
+        py::detail::array_proxy(rval.ptr())->flags
+          &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+        return rval;
+      };
+      if (xs->empty())
+        return py::array_t<broker::real>(py::ssize_t{0});
+      if (auto first = broker::get_if<broker::count>(xs->front()))
+        return make_view(first);
+      if (auto first = broker::get_if<broker::integer>(xs->front()))
+        return make_view(first);
+      if (auto first = broker::get_if<broker::real>(xs->front()))
+        return make_view(first);
+      throw std::invalid_argument(
+        "as_numpy requires count, integer, or real elements");
+    })
+    // Zero-copy access for bulk consumers: string payloads and vectors that
+    // hold nothing but counts expose their storage through the buffer
+    // protocol. The resulting memoryview holds a reference to the Data
+    // object, which keeps the underlying storage alive.
+    .def_buffer([](broker::data& d) -> py::buffer_info {
+      if (auto str = broker::get_if<std::string>(d))
+        return py::buffer_info(str->data(), 1,
+                               py::format_descriptor<uint8_t>::format(), 1,
+                               {static_cast<py::ssize_t>(str->size())},
+                               {py::ssize_t{1}}, true);
+      if (auto xs = broker::get_if<broker::vector>(d)) {
+        for (auto& x : *xs)
+          if (!broker::get_if<broker::count>(x))
+            throw std::invalid_argument(
+              "no zero-copy view for vectors with non-count elements");
+        // The count lives at a fixed offset inside each element, so the
+        // vector is a strided array of uint64 values.
+        auto ptr = xs->empty() ? nullptr
+                               : broker::get_if<broker::count>(xs->front());
+        return py::buffer_info(ptr, sizeof(broker::count),
+                               py::format_descriptor<broker::count>::format(),
+                               1, {static_cast<py::ssize_t>(xs->size())},
+                               {py::ssize_t{sizeof(broker::data)}}, true);
+      }
+      throw std::invalid_argument("no zero-copy view for this data type");
+    })
     .def("get_type", &broker::data::get_type)
     .def("__str__", [](const broker::data& d) { return broker::to_string(d); })
     .def(hash(py::self))
@@ -42,7 +42,11 @@ void init_enums(py::module& m) {
     .value("PeerRemoved", broker::sc::peer_removed)
     .value("PeerLost", broker::sc::peer_lost)
     .value("EndpointDiscovered", broker::sc::endpoint_discovered)
-    .value("EndpointUnreachable", broker::sc::endpoint_unreachable);
+    .value("EndpointUnreachable", broker::sc::endpoint_unreachable)
+    .value("SlowConsumer", broker::sc::slow_consumer)
+    .value("PeerLatencySpike", broker::sc::peer_latency_spike)
+    .value("StoreBacklog", broker::sc::store_backlog)
+    .value("StoreSloBreach", broker::sc::store_slo_breach);
 
   py::enum_<broker::peer_status>(m, "PeerStatus")
     .value("Initialized", broker::peer_status::initialized)
@@ -72,5 +76,7 @@ void init_enums(py::module& m) {
   py::enum_<broker::backend>(m, "Backend")
     .value("Memory", broker::backend::memory)
     .value("SQLite", broker::backend::sqlite)
+    .value("MMapDB", broker::backend::mmapdb)
+    .value("RocksDB", broker::backend::rocksdb)
     .export_values();
 }
@@ -1,6 +1,7 @@
 
 #include <utility>
 #include <string>
+#include <vector>
 
 #ifdef __GNUC__
 #pragma GCC diagnostic push
@@ -59,11 +60,34 @@ void init_store(py::module& m) {
     .def("pop", &broker::store::pop)
     .def("reset", &broker::store::reset);
 
-// Don't need.
-//  py::class_<broker::store::response>(store, "Response")
-//    .def_readwrite("answer", &broker::store::response::answer)
-//    .def_readwrite("id", &broker::store::response::id);
+  py::class_<broker::store::response>(store, "Response")
+    .def_readonly("id", &broker::store::response::id)
+    .def_readonly("answer", &broker::store::response::answer);
 
+  py::class_<broker::store::proxy>(m, "StoreProxy")
+    .def(py::init<broker::store&>())
+    .def("exists", &broker::store::proxy::exists)
+    .def("get", &broker::store::proxy::get)
+    .def("get_index_from_value", &broker::store::proxy::get_index_from_value)
+    .def("keys", &broker::store::proxy::keys)
+    .def("receive", (broker::store::response (broker::store::proxy::*)()) &broker::store::proxy::receive)
+    .def("receive_all",
+         [](broker::store::proxy& p) {
+       // Drain with the GIL released, then build the result list in one go.
+       std::vector<broker::store::response> xs;
+       {
+         py::gil_scoped_release release;
+         p.receive_all([&xs](broker::store::response resp) {
+           xs.emplace_back(std::move(resp));
+         });
+       }
+       py::list rval;
+       for ( auto& x : xs )
+         rval.append(py::cast(std::move(x)));
+       return rval;
+      })
+    .def("fd",
+         [](broker::store::proxy& p) { return p.mailbox().descriptor(); });
 }
 
 
@@ -8,6 +8,8 @@ namespace broker {
 enum class backend : uint8_t {
   memory, ///< An in-memory backend based on a simple hash table.
   sqlite, ///< A SQLite3 backend.
+  mmapdb, ///< A persistent backend based on a memory-mapped log file.
+  rocksdb, ///< An LSM-tree backend based on RocksDB (optional build).
 };
 
 /// @relates backend
@@ -15,7 +17,7 @@ template <class Inspector>
 bool inspect(Inspector& f, backend& x) {
   auto get = [&] { return static_cast<uint8_t>(x); };
   auto set = [&](uint8_t val) {
-    if (val <= static_cast<uint8_t>(backend::sqlite)) {
+    if (val <= static_cast<uint8_t>(backend::rocksdb)) {
       x = static_cast<backend>(val);
       return true;
     } else {
@@ -0,0 +1,140 @@
+#ifndef BROKER_BROKER_H
+#define BROKER_BROKER_H
+
+/* A flat C API over the Broker C++ library for FFI consumers (cgo, ctypes,
+ * JNI, ...). The API hands out opaque handles for endpoints, subscribers,
+ * and stores, never throws across the boundary, and moves payloads as
+ * pointer/size spans in Broker's compact binary codec (see
+ * broker/detail/data_codec.hh) instead of converting per field. Spans
+ * returned by accessor functions stay valid until the handle they were
+ * obtained from is destroyed.
+ *
+ * All functions returning `int` yield 0 on success and a `broker::ec` value
+ * (see broker/error.hh) on failure. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -- opaque handle types -------------------------------------------------- */
+
+typedef struct broker_endpoint broker_endpoint;
+typedef struct broker_subscriber broker_subscriber;
+typedef struct broker_store broker_store;
+typedef struct broker_message broker_message;
+typedef struct broker_blob broker_blob;
+
+/* Data store backend selector; values match broker::backend. */
+#define BROKER_C_BACKEND_MEMORY 0
+#define BROKER_C_BACKEND_SQLITE 1
+#define BROKER_C_BACKEND_MMAPDB 2
+#define BROKER_C_BACKEND_ROCKSDB 3
+
+/* -- endpoint ------------------------------------------------------------- */
+
+/* Creates an endpoint with default configuration. Returns NULL on failure. */
+broker_endpoint* broker_endpoint_new(void);
+
+/* Shuts the endpoint down and releases it. Subscribers and stores obtained
+ * from the endpoint must be destroyed first. */
+void broker_endpoint_destroy(broker_endpoint* ep);
+
+/* Listens on `address`:`port` (port 0 picks an ephemeral port). Returns the
+ * bound port or 0 on failure. A NULL `address` binds to all interfaces. */
+uint16_t broker_endpoint_listen(broker_endpoint* ep, const char* address,
+                                uint16_t port);
+
+/* Peers with the endpoint at `address`:`port`, retrying every
+ * `retry_interval_secs` seconds (0 disables retries). Blocks until the
+ * peering completes or fails. */
+int broker_endpoint_peer(broker_endpoint* ep, const char* address,
+                         uint16_t port, double retry_interval_secs);
+
+/* Publishes a payload in codec format under the given topic. */
+int broker_endpoint_publish(broker_endpoint* ep, const char* topic,
+                            size_t topic_size, const uint8_t* payload,
+                            size_t payload_size);
+
+/* -- subscriber ----------------------------------------------------------- */
+
+/* Subscribes to `num_topics` topic prefixes. Returns NULL on failure. */
+broker_subscriber* broker_endpoint_subscribe(broker_endpoint* ep,
+                                             const char* const* topics,
+                                             const size_t* topic_sizes,
+                                             size_t num_topics,
+                                             size_t max_qsize);
+
+void broker_subscriber_destroy(broker_subscriber* sub);
+
+/* Returns a file descriptor that becomes readable when messages are
+ * available, for integration with poll/epoll event loops. */
+int broker_subscriber_fd(const broker_subscriber* sub);
+
+/* Returns the number of messages that can be consumed without blocking. */
+size_t broker_subscriber_available(const broker_subscriber* sub);
+
+/* Blocks until a message arrives. Returns NULL only on internal failure.
+ * The caller owns the result and must release it via
+ * broker_message_destroy. */
+broker_message* broker_subscriber_get(broker_subscriber* sub);
+
+/* Like broker_subscriber_get, but gives up after `timeout_secs` seconds and
+ * returns NULL. */
+broker_message* broker_subscriber_get_timeout(broker_subscriber* sub,
+                                              double timeout_secs);
+
+/* -- message -------------------------------------------------------------- */
+
+/* Returns the topic as a span; not NUL-terminated. */
+const char* broker_message_topic(const broker_message* msg, size_t* size);
+
+/* Returns the payload as a span in codec format. */
+const uint8_t* broker_message_payload(const broker_message* msg,
+                                      size_t* size);
+
+void broker_message_destroy(broker_message* msg);
+
+/* -- store ---------------------------------------------------------------- */
+
+/* Attaches a master store with the given backend (BROKER_C_BACKEND_*).
+ * Returns NULL on failure. */
+broker_store* broker_endpoint_attach_master(broker_endpoint* ep,
+                                            const char* name, int backend);
+
+/* Attaches a clone of the master store with the given name. Returns NULL on
+ * failure. */
+broker_store* broker_endpoint_attach_clone(broker_endpoint* ep,
+                                           const char* name);
+
+void broker_store_destroy(broker_store* st);
+
+/* Inserts or updates an entry. Key and value are spans in codec format.
+ * An `expiry_secs` value greater than zero expires the entry after that
+ * many seconds. */
+int broker_store_put(broker_store* st, const uint8_t* key, size_t key_size,
+                     const uint8_t* value, size_t value_size,
+                     double expiry_secs);
+
+/* Removes an entry. */
+int broker_store_erase(broker_store* st, const uint8_t* key,
+                       size_t key_size);
+
+/* Retrieves the value for `key` into `*result` as a span in codec format.
+ * The caller owns the blob and must release it via broker_blob_destroy. */
+int broker_store_get(broker_store* st, const uint8_t* key, size_t key_size,
+                     broker_blob** result);
+
+/* -- blob ----------------------------------------------------------------- */
+
+const uint8_t* broker_blob_data(const broker_blob* blob, size_t* size);
+
+void broker_blob_destroy(broker_blob* blob);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* BROKER_BROKER_H */
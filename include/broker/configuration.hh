@@ -22,6 +22,18 @@ struct skip_init_t {};
 
 constexpr skip_init_t skip_init = skip_init_t{};
 
+/// Selects how the underlying actor system schedules actors onto its worker
+/// threads.
+enum class scheduler_policy : uint8_t {
+  /// Keeps the scheduler configuration of the actor system as-is.
+  system_default,
+  /// All workers share a single job queue. Cheap on mostly idle systems.
+  sharing,
+  /// Per-worker job queues with work stealing. Yields the best throughput on
+  /// many-core machines, e.g., when running sharded dispatch.
+  stealing,
+};
+
 struct broker_options {
   /// If true, peer connections won't use SSL.
   bool disable_ssl = false;
@@ -42,6 +54,36 @@ struct broker_options {
   /// Whether to ignore the `broker.conf` file.
   bool ignore_broker_conf = false;
 
+  /// Scheduling policy for the worker threads of the actor system.
+  scheduler_policy scheduler = scheduler_policy::system_default;
+
+  /// Number of worker threads for scheduling actors. This pool is shared by
+  /// all cooperatively scheduled actors of the endpoint, including every
+  /// driver spawned via ::subscribe and ::publish_all, so applications can
+  /// run many drivers without oversubscribing cores. A value of 0 keeps the
+  /// default of the actor system.
+  size_t max_threads = 0;
+
+  /// If true, data store actors run on dedicated threads instead of sharing
+  /// the worker pool with the core actor. Isolates store I/O (e.g., SQLite
+  /// writes) from the messaging hot path on busy endpoints.
+  bool detach_stores = false;
+
+  /// If true, constructing an ::endpoint only stores the configuration and
+  /// defers spinning up the actor system, core actor and background tasks
+  /// until the first operation that needs them. Short-lived tools get cheap
+  /// construction this way and pay the bring-up cost only once they actually
+  /// touch the network or publish data.
+  bool lazy_init = false;
+
+  /// Selects a named tuning profile that seeds a coherent set of performance
+  /// options before reading the config file and CLI arguments, i.e.,
+  /// explicitly configured values still win. Supported: "low-latency",
+  /// "high-throughput" and "constrained"; an empty string keeps the
+  /// one-size-fits-all defaults. Also selectable via --profile on the
+  /// command line or the BROKER_PROFILE environment variable.
+  std::string profile;
+
   broker_options() = default;
 
   broker_options(const broker_options&) = default;
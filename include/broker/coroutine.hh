@@ -0,0 +1,311 @@
+#pragma once
+
+// Optional C++20 coroutine adapters for publishing and subscribing. The
+// library itself builds as C++17; this header enables the coroutine API only
+// when the including translation unit compiles with coroutine support. Check
+// for BROKER_HAS_COROUTINES before using any of the types below.
+
+#if defined(__has_include)
+#  if __has_include(<version>)
+#    include <version>
+#  endif
+#endif
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine)
+#  define BROKER_HAS_COROUTINES 1
+#endif
+
+#ifdef BROKER_HAS_COROUTINES
+
+#  include <coroutine>
+#  include <deque>
+#  include <exception>
+#  include <memory>
+#  include <utility>
+#  include <vector>
+
+#  include "broker/endpoint.hh"
+#  include "broker/error.hh"
+#  include "broker/message.hh"
+#  include "broker/topic.hh"
+#  include "broker/worker.hh"
+
+namespace broker {
+
+/// A lazy coroutine generator. The coroutine body produces values with
+/// `co_yield`; consumers drive it with `next` and read the current value with
+/// `value`. Unlike the callback-based `publish_all` API, the producer keeps
+/// its local state on the coroutine frame and suspends between values instead
+/// of returning through a state machine.
+template <class T>
+class generator {
+public:
+  struct promise_type {
+    T* current = nullptr;
+    std::exception_ptr err;
+
+    generator get_return_object() {
+      return generator{handle_type::from_promise(*this)};
+    }
+
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_always final_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_always yield_value(T& x) noexcept {
+      current = &x;
+      return {};
+    }
+
+    std::suspend_always yield_value(T&& x) noexcept {
+      current = &x;
+      return {};
+    }
+
+    void return_void() noexcept {
+      // nop
+    }
+
+    void unhandled_exception() {
+      err = std::current_exception();
+    }
+  };
+
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  generator() noexcept = default;
+
+  generator(generator&& other) noexcept
+    : hdl_(std::exchange(other.hdl_, nullptr)) {
+    // nop
+  }
+
+  generator& operator=(generator&& other) noexcept {
+    if (hdl_)
+      hdl_.destroy();
+    hdl_ = std::exchange(other.hdl_, nullptr);
+    return *this;
+  }
+
+  generator(const generator&) = delete;
+
+  generator& operator=(const generator&) = delete;
+
+  ~generator() {
+    if (hdl_)
+      hdl_.destroy();
+  }
+
+  /// Resumes the coroutine until it yields the next value or finishes.
+  /// @returns `true` if a value is available via `value`, `false` otherwise.
+  /// @throws any exception that escaped the coroutine body.
+  bool next() {
+    if (done())
+      return false;
+    hdl_.resume();
+    if (auto& err = hdl_.promise().err)
+      std::rethrow_exception(std::exchange(err, nullptr));
+    return !hdl_.done();
+  }
+
+  /// Returns the value produced by the most recent `next` call.
+  /// @pre `next()` returned `true`
+  T& value() noexcept {
+    return *hdl_.promise().current;
+  }
+
+  /// Queries whether the coroutine has run to completion.
+  bool done() const noexcept {
+    return !hdl_ || hdl_.done();
+  }
+
+private:
+  explicit generator(handle_type hdl) noexcept : hdl_(hdl) {
+    // nop
+  }
+
+  handle_type hdl_;
+};
+
+namespace detail {
+
+/// Shared state between a `data_message_stream` and the sink worker that
+/// feeds it.
+struct coroutine_stream_state {
+  const data_message* current = nullptr;
+  error err;
+  bool done = false;
+};
+
+} // namespace detail
+
+/// An awaitable source of data messages, passed into sink coroutines. Calling
+/// `co_await stream.next()` suspends the coroutine until the endpoint
+/// delivers the next message. The worker resumes the coroutine in-place, so
+/// the returned pointer remains valid only until the next suspension point.
+class data_message_stream {
+public:
+  explicit data_message_stream(
+    std::shared_ptr<detail::coroutine_stream_state> state) noexcept
+    : state_(std::move(state)) {
+    // nop
+  }
+
+  struct awaitable {
+    detail::coroutine_stream_state* state;
+
+    bool await_ready() const noexcept {
+      return state->done;
+    }
+
+    void await_suspend(std::coroutine_handle<>) const noexcept {
+      // The sink worker resumes us when the next message arrives.
+    }
+
+    const data_message* await_resume() const noexcept {
+      return state->done ? nullptr : state->current;
+    }
+  };
+
+  /// Awaits the next message. Resumes with a pointer to the message or
+  /// `nullptr` once the stream terminated.
+  awaitable next() noexcept {
+    return awaitable{state_.get()};
+  }
+
+  /// Returns the error that terminated the stream, if any.
+  const error& err() const noexcept {
+    return state_->err;
+  }
+
+private:
+  std::shared_ptr<detail::coroutine_stream_state> state_;
+};
+
+/// A fire-and-forget coroutine handle for sink coroutines. Returned from the
+/// user-provided coroutine and owned by the sink worker.
+class sink_task {
+public:
+  struct promise_type {
+    std::exception_ptr err;
+
+    sink_task get_return_object() {
+      return sink_task{handle_type::from_promise(*this)};
+    }
+
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_always final_suspend() noexcept {
+      return {};
+    }
+
+    void return_void() noexcept {
+      // nop
+    }
+
+    void unhandled_exception() {
+      err = std::current_exception();
+    }
+  };
+
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  sink_task() noexcept = default;
+
+  sink_task(sink_task&& other) noexcept
+    : hdl_(std::exchange(other.hdl_, nullptr)) {
+    // nop
+  }
+
+  sink_task& operator=(sink_task&& other) noexcept {
+    if (hdl_)
+      hdl_.destroy();
+    hdl_ = std::exchange(other.hdl_, nullptr);
+    return *this;
+  }
+
+  sink_task(const sink_task&) = delete;
+
+  sink_task& operator=(const sink_task&) = delete;
+
+  ~sink_task() {
+    if (hdl_)
+      hdl_.destroy();
+  }
+
+  /// Resumes the coroutine if it has not finished yet.
+  /// @throws any exception that escaped the coroutine body.
+  void resume() {
+    if (done())
+      return;
+    hdl_.resume();
+    if (auto& err = hdl_.promise().err)
+      std::rethrow_exception(std::exchange(err, nullptr));
+  }
+
+  /// Queries whether the coroutine has run to completion.
+  bool done() const noexcept {
+    return !hdl_ || hdl_.done();
+  }
+
+private:
+  explicit sink_task(handle_type hdl) noexcept : hdl_(hdl) {
+    // nop
+  }
+
+  handle_type hdl_;
+};
+
+/// Publishes all values produced by `gen`. The worker pulls values on demand,
+/// so the coroutine suspends between batches instead of blocking a thread.
+/// @param ep the endpoint that owns the publishing worker
+/// @param gen a coroutine yielding the messages to publish
+inline worker publish_generator(endpoint& ep, generator<data_message> gen) {
+  auto g = std::make_shared<generator<data_message>>(std::move(gen));
+  return ep.publish_all(
+    [] {},
+    [g](std::deque<data_message>& buf, size_t hint) {
+      for (size_t produced = 0; produced < hint && g->next(); ++produced)
+        buf.emplace_back(std::move(g->value()));
+    },
+    [g] { return g->done(); });
+}
+
+/// Subscribes to `topics` with a coroutine-based sink. The factory `f`
+/// receives a ::data_message_stream and returns a ::sink_task that awaits
+/// messages via `co_await stream.next()` until the stream terminates.
+/// @param ep the endpoint that owns the sink worker
+/// @param topics the topics to subscribe to
+/// @param f a factory invoked once to create the sink coroutine
+template <class MakeTask>
+worker subscribe_coroutine(endpoint& ep, std::vector<topic> topics,
+                           MakeTask f) {
+  auto state = std::make_shared<detail::coroutine_stream_state>();
+  auto task = std::make_shared<sink_task>(f(data_message_stream{state}));
+  return ep.subscribe(
+    std::move(topics),
+    [task] {
+      // Runs the coroutine up to its first suspension point.
+      task->resume();
+    },
+    [state, task](const data_message& msg) {
+      state->current = &msg;
+      task->resume();
+      state->current = nullptr;
+    },
+    [state, task](const error& what) {
+      state->err = what;
+      state->done = true;
+      task->resume();
+    });
+}
+
+} // namespace broker
+
+#endif // BROKER_HAS_COROUTINES
@@ -15,6 +15,7 @@
 #include <atomic>
 #include <cstddef>
 #include <tuple>
+#include <vector>
 
 namespace broker {
 
@@ -48,9 +49,15 @@ public:
 
     impl& operator=(const impl& other) {
       data = other.data;
+      // The new content invalidates any cached wire representation.
+      delete encoding.exchange(nullptr, std::memory_order_acq_rel);
       return *this;
     }
 
+    ~impl() {
+      delete encoding.load(std::memory_order_acquire);
+    }
+
     impl* copy() const {
       return new impl{*this};
     }
@@ -71,6 +78,11 @@ public:
     alignas(BROKER_CONSTRUCTIVE_INTERFERENCE_SIZE) mutable ref_count_type rc;
 
     data_type data;
+
+    /// Wire representation of `data`, cached by the first binary
+    /// serialization (see the `inspector_access` specialization in
+    /// broker/internal/type_id.hh). Copies never share the cache.
+    mutable std::atomic<std::vector<std::byte>*> encoding = nullptr;
   };
 
   // -- constructors, destructors, and assignment operators --------------------
@@ -129,6 +141,8 @@ public:
   /// reference count of 1.
   data_type& unshared() {
     if (ptr_->unique()) {
+      // Direct mutation may change the wire representation.
+      delete ptr_->encoding.exchange(nullptr, std::memory_order_acq_rel);
       return ptr_->data;
     } else {
       auto new_ptr = ptr_->copy();
@@ -143,6 +157,25 @@ public:
     return ptr_->unique();
   }
 
+  /// Returns the cached wire representation of the managed tuple, if any.
+  const std::vector<std::byte>* encoding() const noexcept {
+    return ptr_->encoding.load(std::memory_order_acquire);
+  }
+
+  /// Caches `bytes` as the wire representation of the managed tuple.
+  /// @returns the surviving blob, i.e., `bytes` or the cache installed by a
+  ///          racing caller.
+  const std::vector<std::byte>&
+  cache_encoding(std::vector<std::byte> bytes) const {
+    auto blob = new std::vector<std::byte>(std::move(bytes));
+    std::vector<std::byte>* expected = nullptr;
+    if (ptr_->encoding.compare_exchange_strong(expected, blob,
+                                               std::memory_order_acq_rel))
+      return *blob;
+    delete blob;
+    return *expected;
+  }
+
   // -- comparison -------------------------------------------------------------
 
   template <class... Us>
@@ -4,6 +4,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <variant>
@@ -12,6 +13,8 @@
 #include "broker/address.hh"
 #include "broker/bad_variant_access.hh"
 #include "broker/convert.hh"
+#include "broker/detail/assert.hh"
+#include "broker/detail/copy_profiler.hh"
 #include "broker/detail/type_traits.hh"
 #include "broker/enum_value.hh"
 #include "broker/fwd.hh"
@@ -119,9 +122,24 @@ public:
 
   /// Default-constructs an empty data value in `none` state.
   data(none = nil) {
-    // nop
+    BROKER_PROFILE_CONSTRUCTION(data);
   }
 
+#ifdef BROKER_HAVE_COPY_PROFILING
+  // Only declared in profiling builds; the compiler-generated special members
+  // apply otherwise.
+
+  data(const data& other);
+
+  data(data&& other) noexcept;
+
+  data& operator=(const data& other);
+
+  data& operator=(data&& other) noexcept;
+
+  ~data() = default;
+#endif
+
   /// Constructs a data value from one of the possible data types.
 	template <
 	  class T,
@@ -134,9 +152,18 @@ public:
             >
 	>
 	data(T&& x) : data_(from<detail::decay_t<T>>(std::forward<T>(x))) {
-	  // nop
+	  BROKER_PROFILE_CONSTRUCTION(data);
 	}
 
+  /// Constructs a data value holding `T`, constructed in place from `args`.
+  /// Unlike the converting constructor, this never materializes a temporary
+  /// `T` outside of the variant.
+  template <class T, class... Args>
+  explicit data(std::in_place_type_t<T> token, Args&&... args)
+    : data_(token, std::forward<Args>(args)...) {
+    BROKER_PROFILE_CONSTRUCTION(data);
+  }
+
   /// Returns a string representation of the stored type.
   const char* get_type_name() const;
 
@@ -155,6 +182,28 @@ public:
     return data_;
   }
 
+  /// Returns the stored `T` without checking the stored alternative. Only
+  /// call when the alternative is already proven, e.g., under a
+  /// @ref shape_token or right after a `get_if` on the same value. Calling
+  /// this on a value holding a different alternative is undefined behavior.
+  /// @pre `get_type() == data_tag<T>()`
+  template <class T>
+  [[nodiscard]] T& unsafe_get() noexcept {
+    auto ptr = std::get_if<T>(&data_);
+    if (ptr == nullptr)
+      BROKER_UNREACHABLE();
+    return *ptr;
+  }
+
+  /// @copydoc unsafe_get
+  template <class T>
+  [[nodiscard]] const T& unsafe_get() const noexcept {
+    auto ptr = std::get_if<T>(&data_);
+    if (ptr == nullptr)
+      BROKER_UNREACHABLE();
+    return *ptr;
+  }
+
 private:
   data_variant data_;
 };
@@ -367,6 +416,90 @@ bool contains(const data& x) {
   else
     return false;
 }
+
+// --- validated shape access --------------------------------------------------
+
+/// Proof object vouching that a vector's first `sizeof...(Ts)` elements hold
+/// exactly the types `Ts...`. One @ref match_shape pass performs all variant
+/// checks up front; the accessors afterwards go through `data::unsafe_get`
+/// and compile down to direct member loads, sparing tight decode loops the
+/// per-element tag branch. The token borrows the vector: it must not outlive
+/// the validated value and mutating the value voids the proof.
+template <class... Ts>
+class shape_token {
+public:
+  /// Number of validated leading elements.
+  static constexpr size_t num_fields = sizeof...(Ts);
+
+  /// Type of the validated element at position `I`.
+  template <size_t I>
+  using type_at = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+  /// Creates an invalid token.
+  shape_token() noexcept = default;
+
+  shape_token(const shape_token&) noexcept = default;
+
+  shape_token& operator=(const shape_token&) noexcept = default;
+
+  /// Returns whether the validation pass succeeded.
+  explicit operator bool() const noexcept {
+    return xs_ != nullptr;
+  }
+
+  /// Returns the element at position `I` with its proven type, without
+  /// re-inspecting the variant.
+  /// @pre the token is valid
+  template <size_t I>
+  const type_at<I>& get() const noexcept {
+    static_assert(I < num_fields, "index beyond the validated shape");
+    return (*xs_)[I].template unsafe_get<type_at<I>>();
+  }
+
+  /// Returns the underlying vector, e.g., for elements beyond the validated
+  /// shape.
+  /// @pre the token is valid
+  const vector& fields() const noexcept {
+    return *xs_;
+  }
+
+private:
+  explicit shape_token(const vector* xs) noexcept : xs_(xs) {
+    // nop
+  }
+
+  template <class... Us>
+  friend shape_token<Us...> match_shape(const vector& xs);
+
+  const vector* xs_ = nullptr;
+};
+
+template <size_t... Is, class... Ts>
+bool match_shape_impl(const vector& xs, std::index_sequence<Is...>,
+                      detail::type_list<Ts...>) {
+  return xs.size() >= sizeof...(Ts) && (is<Ts>(xs[Is]) && ...);
+}
+
+/// Validates in one pass that the first `sizeof...(Ts)` elements of `xs`
+/// hold exactly the types `Ts...`. Unlike @ref contains, matching is strict
+/// (no conversions) and extra trailing elements are permitted.
+/// @returns A valid token on success, an invalid token otherwise.
+/// @relates shape_token
+template <class... Ts>
+shape_token<Ts...> match_shape(const vector& xs) {
+  if (match_shape_impl(xs, std::make_index_sequence<sizeof...(Ts)>{},
+                       detail::type_list<Ts...>{}))
+    return shape_token<Ts...>{&xs};
+  return {};
+}
+
+/// @copydoc match_shape
+template <class... Ts>
+shape_token<Ts...> match_shape(const data& x) {
+  if (auto xs = get_if<vector>(x))
+    return match_shape<Ts...>(*xs);
+  return {};
+}
 } // namespace broker
 
 namespace broker::detail {
@@ -381,6 +514,20 @@ size_t fnv_hash(const broker::table::value_type& x);
 
 size_t fnv_hash(const broker::table& x);
 
+/// Computes a wyhash-based digest of `x` (see broker/detail/hash.hh). This is
+/// the project-wide hasher behind `std::hash`: faster and better distributed
+/// than the byte-at-a-time `fnv_hash`, which remains for callers that pinned
+/// its values.
+size_t fast_hash(const broker::data& x);
+
+size_t fast_hash(const broker::set& x);
+
+size_t fast_hash(const broker::vector& x);
+
+size_t fast_hash(const broker::table::value_type& x);
+
+size_t fast_hash(const broker::table& x);
+
 } // namespace broker::detail
 
 // --- implementations of std::hash --------------------------------------------
@@ -390,35 +537,35 @@ namespace std {
 template <>
 struct hash<broker::data> {
   size_t operator()(const broker::data& x) const {
-    return broker::detail::fnv_hash(x);
+    return broker::detail::fast_hash(x);
   }
 };
 
 template <>
 struct hash<broker::set> {
   size_t operator()(const broker::set& x) const{
-    return broker::detail::fnv_hash(x);
+    return broker::detail::fast_hash(x);
   }
 };
 
 template <>
 struct hash<broker::vector> {
   size_t operator()(const broker::vector& x) const{
-    return broker::detail::fnv_hash(x);
+    return broker::detail::fast_hash(x);
   }
 };
 
 template <>
 struct hash<broker::table::value_type> {
   size_t operator()(const broker::table::value_type& x) const{
-    return broker::detail::fnv_hash(x);
+    return broker::detail::fast_hash(x);
   }
 };
 
 template <>
 struct hash<broker::table> {
   size_t operator()(const broker::table& x) const{
-    return broker::detail::fnv_hash(x);
+    return broker::detail::fast_hash(x);
   }
 };
 
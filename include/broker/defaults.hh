@@ -11,22 +11,212 @@ namespace broker::defaults {
 
 constexpr std::string_view recording_directory = "";
 
+/// Directory for capturing the full mutation stream of master stores, one
+/// generator file per store; empty disables capturing. Override via
+/// "broker.store-recording-directory".
+constexpr std::string_view store_recording_directory = "";
+
 constexpr size_t output_generator_file_cap = std::numeric_limits<size_t>::max();
 
+/// Whether recordings use the compressed generator file format. Requires
+/// zlib support; override via "broker.recording-compression".
+constexpr bool recording_compression = false;
+
+/// Message kinds captured by recordings: "all", "data" or "command".
+/// Override via "broker.recording-types".
+constexpr std::string_view recording_types = "all";
+
+/// Record only every Nth message that passes the recording filters; 0 and 1
+/// capture every matching message. Override via
+/// "broker.recording-sample-rate". Topic prefixes for restricting recordings
+/// go into the "broker.recording-topics" list.
+constexpr uint64_t recording_sample_rate = 0;
+
+/// Whether recordings include the time gaps between messages for timed
+/// replay; override via "broker.recording-timestamps".
+constexpr bool recording_timestamps = false;
+
+/// Number of most recent messages the in-memory flight recorder retains for
+/// on-demand dumps; 0 disables the flight recorder. Only takes effect when no
+/// recording directory is set; override via "broker.flight-recorder-size".
+constexpr size_t flight_recorder_size = 0;
+
 constexpr uint16_t ttl = 20;
 
 constexpr size_t max_pending_inputs_per_source = 512;
 
+/// Maximum number of peering connection attempts in flight at once; further
+/// attempts queue up until a slot frees. Override via
+/// "broker.max-pending-connects".
+constexpr size_t max_pending_connects = 10;
+
+/// Ceiling for the exponential backoff between reconnection attempts; the
+/// delay starts at the configured per-peering retry interval, doubles per
+/// failed attempt and never exceeds this bound.
+constexpr timespan max_peer_retry_delay = std::chrono::minutes(5);
+
+/// Directory holding trained deflate preset dictionaries ("*.dict" files as
+/// produced by broker-dict-train). When set, store actors deflate snapshot
+/// chunks against the dictionary matching the store name (falling back to
+/// "default") and peerings may negotiate dictionary compression for message
+/// payloads. Dictionaries resolve by checksum on the receiving side, so all
+/// nodes must load the same files. Empty (the default) disables preset
+/// dictionaries; override via "broker.compression-dictionary-directory".
+constexpr std::string_view compression_dictionary_directory = "";
+
+/// Byte budget for data buffered in subscriber/publisher queues and the
+/// dispatcher staging area. Exceeding the budget sheds items headed for
+/// subscriber queues until consumers catch up. Zero (the default) disables
+/// enforcement; override via "broker.memory-budget".
+constexpr size_t memory_budget = 0;
+
 } // namespace broker::defaults
 
+namespace broker::defaults::dispatcher {
+
+/// Maximum number of messages the central dispatcher stages before flushing
+/// them downstream as a batch. The effective batch size adapts between
+/// `min_stage_capacity` and this ceiling depending on load.
+constexpr size_t stage_capacity = 256;
+
+/// Smallest batch size the dispatcher falls back to on low-rate traffic.
+constexpr size_t min_stage_capacity = 16;
+
+/// Maximum time a staged message may linger before a forced flush.
+constexpr timespan flush_interval = std::chrono::milliseconds(1);
+
+/// Maximum number of drained message buffers the dispatcher keeps around for
+/// reuse.
+constexpr size_t pool_size = 32;
+
+} // namespace broker::defaults::dispatcher
+
+namespace broker::defaults::subscriber {
+
+/// Number of busy-poll iterations a blocking consumer performs before
+/// parking on the flare file descriptor. Spinning trades CPU time for wakeup
+/// latency when the next message tends to arrive within microseconds. Zero
+/// (the default) parks immediately; override via
+/// "broker.subscriber.spin-count" or per subscriber via
+/// `subscriber_base::set_spin_count`.
+constexpr size_t spin_count = 0;
+
+} // namespace broker::defaults::subscriber
+
 namespace broker::defaults::store {
 
 constexpr timespan tick_interval = std::chrono::milliseconds(50);
 
+/// Number of entries per chunk when streaming a snapshot to a clone. Larger
+/// snapshots ship as a sequence of chunks interleaved with regular command
+/// traffic instead of a single message.
+constexpr size_t snapshot_chunk_size = 4096;
+
+/// Time window for coalescing add/subtract operations on the same key before
+/// broadcasting one merged update to the clones. Zero (the default) disables
+/// coalescing; override via "broker.store.coalesce-interval".
+constexpr timespan coalesce_interval = std::chrono::milliseconds(0);
+
+/// Number of broadcast commands the master keeps in its operation log.
+/// Reconnecting clones that fall behind by no more than this many commands
+/// receive a delta replay instead of a full snapshot.
+constexpr size_t op_log_capacity = 4096;
+
+/// Timeout for a single peer to answer a master resolution query. Peers that
+/// fail or stay silent past this deadline count as a negative answer, so a
+/// dead peer cannot stall clone attachment.
+constexpr timespan resolve_timeout = std::chrono::seconds(1);
+
+/// How long the core remembers a failed master resolution. Repeated attempts
+/// within this window fail fast instead of fanning out to all peers again.
+constexpr timespan resolve_negative_cache = std::chrono::milliseconds(500);
+
+/// Whether snapshot chunks streamed to clones deflate on the wire, on top of
+/// the dictionary encoding. Requires zlib support on the master and on every
+/// clone; override via "broker.store.snapshot-compression".
+constexpr bool snapshot_compression = false;
+
+/// Directory for persistent clone caches, one file per clone. A restarting
+/// clone restores its content from the cache and only fetches the delta from
+/// the master instead of a full snapshot. Empty (the default) keeps clones
+/// memory-only; override via "broker.store.clone-cache-directory".
+constexpr std::string_view clone_cache_directory = "";
+
+/// Interval between write-behind flushes of a clone cache. A flush only
+/// happens when commands arrived since the previous one; override via
+/// "broker.store.clone-cache-interval".
+constexpr timespan clone_cache_interval = std::chrono::seconds(30);
+
+/// Sampling rate for store SLO tracking: the master stamps every Nth
+/// broadcast command with its wall-clock time, and clones measure the
+/// master-to-clone propagation delay of stamped commands in the
+/// "broker.store-propagation-delay" histograms. Zero (the default) disables
+/// stamping; override via "broker.store.slo-sample-rate".
+constexpr uint64_t slo_sample_rate = 0;
+
+/// Interval between idle checks for backend compaction on a master. A check
+/// that finds the store idle and well below its entry high watermark asks
+/// the backend to release excess memory. Zero disables compaction; override
+/// via "broker.store.compaction-interval".
+constexpr timespan compaction_interval = std::chrono::seconds(60);
+
 } // namespace broker::defaults::store
 
 namespace broker::defaults::metrics {
 
 constexpr timespan export_interval = std::chrono::seconds(1);
 
+/// Number of scrape intervals between two full exports. In between, the
+/// exporter publishes only rows that changed since the previous scrape.
+/// Values of 0 or 1 export the full set every interval; override via
+/// "broker.metrics.export.full-sync-interval".
+constexpr size_t full_sync_interval = 10;
+
+/// Interval between two rounds of scheduler-lag probes. When set, a watchdog
+/// posts timestamped no-op messages to all long-lived actors and records the
+/// observed scheduling lag per actor in the "broker.scheduler-lag"
+/// histograms. Zero (the default) disables the watchdog; override via
+/// "broker.metrics.scheduler-lag-interval".
+constexpr timespan scheduler_lag_interval = std::chrono::seconds(0);
+
+/// Sampling rate for end-to-end latency tracing: every Nth locally published
+/// message carries an origin timestamp and contributes to the
+/// "broker.message-latency" histograms on delivery. Zero (the default)
+/// disables tracing; override via "broker.metrics.latency-sample-rate".
+constexpr uint64_t latency_sample_rate = 0;
+
 } // namespace broker::defaults::metrics::export
+
+namespace broker::defaults::health {
+
+/// Number of consecutive seconds a subscriber queue must sit at its high
+/// watermark before Broker emits a `sc::slow_consumer` status. Zero disables
+/// the check; override via "broker.health.slow-consumer-seconds".
+constexpr size_t slow_consumer_seconds = 5;
+
+/// Outbound buffering delay to a peer that triggers a
+/// `sc::peer_latency_spike` status. Zero disables the check; override via
+/// "broker.health.peer-latency-threshold".
+constexpr timespan peer_latency_threshold = std::chrono::seconds(1);
+
+/// Number of commands a clone may buffer while out of sync before Broker
+/// emits a `sc::store_backlog` status. Zero disables the check; override via
+/// "broker.health.store-backlog-threshold".
+constexpr size_t store_backlog_threshold = 1024;
+
+/// Master-to-clone propagation delay of a sampled store command that counts
+/// as an SLO breach on the clone. Only takes effect when
+/// "broker.store.slo-sample-rate" enables sampling; zero records delays
+/// without breach tracking. Override via "broker.health.store-slo-threshold".
+constexpr timespan store_slo_threshold = std::chrono::milliseconds(200);
+
+/// Number of consecutive sampled breaches before a clone emits a
+/// `sc::store_slo_breach` status.
+constexpr size_t store_slo_breach_limit = 3;
+
+/// Minimum time between two health status events of the same kind from the
+/// same source, keeping a persistent condition from flooding the status
+/// stream.
+constexpr timespan cooldown = std::chrono::seconds(30);
+
+} // namespace broker::defaults::health
@@ -6,6 +6,8 @@
 
 #include <deque>
 #include <optional>
+#include <utility>
+#include <vector>
 
 namespace broker::detail {
 
@@ -47,6 +49,14 @@ public:
   virtual expected<void> subtract(const data& key, const data& value,
                                   std::optional<timestamp> expiry = {});
 
+  /// Inserts many key-value pairs in one call, e.g., during a bulk load from
+  /// a file. Entries carry no expiry. The default implementation loops over
+  /// `put`; backends override it to batch the writes.
+  /// @param entries The key-value pairs to insert.
+  /// @returns `nil` on success.
+  virtual expected<void>
+  bulk_insert(std::vector<std::pair<data, data>> entries);
+
   /// Removes a key and its associated value from the store, if it exists.
   /// @param key The key to use.
   /// @returns `nil` if *key* was removed successfully or if *key* did not
@@ -57,6 +67,13 @@ public:
   /// @returns `nil` if the store was successfully emptied out.
   virtual expected<void> clear() = 0;
 
+  /// Releases memory the backend holds beyond its current content, e.g.,
+  /// tables sized for a past peak or cached pages. The master calls this
+  /// while the store sits idle, so implementations may take their time. The
+  /// default implementation does nothing.
+  /// @returns `nil` on success.
+  virtual expected<void> compact();
+
   /// Removes a key and its associated value from the store, if it exists and
   /// has an expiration in the past.
   /// @param key The key to expire.
@@ -95,12 +112,47 @@ public:
   /// @returns The set of current keys.
   virtual expected<data> keys() const = 0;
 
+  /// Retrieves the keys within the half-open range *[from, to)*, ordered by
+  /// key. Callers scan large ranges incrementally by re-issuing the query
+  /// with *from* set past the last key of the previous result. The default
+  /// implementation filters `keys()`; backends with an ordered index
+  /// override it.
+  /// @param from The inclusive lower bound of the scan.
+  /// @param to The exclusive upper bound. Passing `nil` drops the bound.
+  /// @param limit Caps the result at this many keys. Passing 0 drops the cap.
+  /// @returns The set of matching keys.
+  virtual expected<data> keys_in_range(const data& from, const data& to,
+                                       uint64_t limit) const;
+
   /// Retrieves all key-value pairs.
   /// @returns A snapshot of the store that includes its content.
   virtual expected<broker::snapshot> snapshot() const = 0;
 
+  /// Freezes the current content for a subsequent chunked snapshot transfer.
+  /// Backends that support forking serve the frozen state via
+  /// `snapshot_chunk` while writes continue against the live state.
+  /// @returns The number of frozen entries, or `ec::unspecified` if the
+  /// backend does not support forking or a fork is already active.
+  virtual expected<uint64_t> snapshot_fork();
+
+  /// Copies up to *num_entries* entries of the frozen fork, advancing an
+  /// internal cursor. Reading past the last entry releases the fork.
+  /// @returns The next chunk of the frozen state.
+  virtual expected<broker::snapshot> snapshot_chunk(uint64_t num_entries);
+
+  /// Discards an active fork, if any.
+  virtual void snapshot_release();
+
   /// @returns the set of all keys that have expiry times.
   virtual expected<expirables> expiries() const = 0;
+
+  /// Retrieves internal statistics of the backend as a table mapping stat
+  /// names to numeric values, e.g., compaction counters for LSM-based
+  /// backends. The master actor mirrors these values into the telemetry
+  /// registry.
+  /// @returns The statistics, or `ec::unspecified` if the backend does not
+  /// report any.
+  virtual expected<data> stats() const;
 };
 
 } // namespace broker::detail
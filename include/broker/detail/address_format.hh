@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace broker {
+namespace detail {
+
+/// Maximum number of characters that @ref format_ipv4 writes.
+constexpr size_t max_ipv4_chars = 15; // "255.255.255.255"
+
+/// Maximum number of characters that @ref format_ipv6 writes.
+constexpr size_t max_ipv6_chars = 39; // 8 groups of 4 digits plus 7 colons
+
+/// Renders the dotted-quad representation of an IPv4 address into `out`
+/// without going through snprintf or per-octet temporaries.
+/// @param bytes The four address bytes in network order.
+/// @param out A buffer with room for at least @ref max_ipv4_chars characters.
+/// @returns The number of characters written (no null terminator).
+size_t format_ipv4(const uint8_t* bytes, char* out) noexcept;
+
+/// Renders the RFC 5952 canonical representation of an IPv6 address into
+/// `out`: lowercase hex groups and the longest run of two or more zero
+/// groups (leftmost on a tie) compressed to `::`.
+/// @param bytes The 16 address bytes in network order.
+/// @param out A buffer with room for at least @ref max_ipv6_chars characters.
+/// @returns The number of characters written (no null terminator).
+size_t format_ipv6(const uint8_t* bytes, char* out) noexcept;
+
+/// Parses a dotted-quad IPv4 address. Rejects anything but the canonical
+/// form, i.e., four decimal octets without leading zeros.
+/// @param str The input, e.g., "192.168.1.1".
+/// @param bytes Receives the four address bytes in network order.
+/// @returns Whether `str` held a well-formed address.
+bool parse_ipv4(std::string_view str, uint8_t* bytes) noexcept;
+
+/// Parses an IPv6 address in hex-group notation, including `::` compression
+/// and an embedded dotted-quad tail such as "::ffff:192.168.1.1".
+/// @param str The input, e.g., "2001:db8::1".
+/// @param bytes Receives the 16 address bytes in network order.
+/// @returns Whether `str` held a well-formed address.
+bool parse_ipv6(std::string_view str, uint8_t* bytes) noexcept;
+
+} // namespace detail
+} // namespace broker
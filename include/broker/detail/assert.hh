@@ -3,3 +3,16 @@
 #include <cassert>
 
 #define BROKER_ASSERT assert
+
+// Marks a spot that validated invariants rule out. Release builds tell the
+// compiler the branch leading here is dead, so it disappears entirely; debug
+// builds keep a regular assertion failure.
+#ifdef NDEBUG
+#  ifdef _MSC_VER
+#    define BROKER_UNREACHABLE() __assume(false)
+#  else
+#    define BROKER_UNREACHABLE() __builtin_unreachable()
+#  endif
+#else
+#  define BROKER_UNREACHABLE() assert(!"unreachable")
+#endif
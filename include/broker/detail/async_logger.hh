@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "broker/time.hh"
+
+namespace broker::detail {
+
+/// Asynchronous backend for the BROKER_* logging macros. Each producer thread
+/// formats its message and deposits it into a bounded thread-local ring
+/// buffer; a single background thread sweeps all rings and writes the entries
+/// to the sink. Producers never block and never issue I/O: when a ring is
+/// full, the entry is counted as dropped instead. This keeps trace-level
+/// logging cheap enough to enable in production, where routing every message
+/// through a synchronous logger costs a double-digit share of throughput.
+///
+/// The logger is process-global and disabled by default; `configure` toggles
+/// it at runtime. Messages at or below the active level enter the rings, all
+/// others take the regular synchronous path of the macros.
+class async_logger {
+public:
+  /// Numeric log levels, matching CAF's constants so the logging macros can
+  /// pass their level through unchanged.
+  static constexpr int level_quiet = 0;
+  static constexpr int level_error = 3;
+  static constexpr int level_warning = 6;
+  static constexpr int level_info = 9;
+  static constexpr int level_debug = 12;
+  static constexpr int level_trace = 15;
+
+  /// Number of entries per thread-local ring.
+  static constexpr size_t ring_capacity = 1024;
+
+  /// Maximum message text per entry; longer messages get truncated.
+  static constexpr size_t max_message_size = 240;
+
+  /// Returns the process-global instance.
+  static async_logger& instance();
+
+  /// Returns whether messages at `level` should enter the ring buffers.
+  /// This is the per-call-site fast path: one relaxed load.
+  bool accepts(int level) const noexcept {
+    return level <= level_.load(std::memory_order_relaxed);
+  }
+
+  /// Enables levels up to `level` and starts the drain thread on first use.
+  /// An empty `path` writes to stderr; the sink is fixed on the first call,
+  /// later calls only adjust the level. Passing `level_quiet` disables the
+  /// backend again; entries already buffered still drain.
+  void configure(int level, const std::string& path);
+
+  /// Deposits one message into the calling thread's ring, truncating it to
+  /// `max_message_size` characters. Never blocks; returns false and counts
+  /// the message as dropped when the ring is full.
+  bool append(int level, std::string_view msg);
+
+  /// Returns the number of messages dropped due to full rings.
+  uint64_t dropped() const noexcept;
+
+  /// Sweeps all rings once and flushes the sink. Also called periodically by
+  /// the drain thread.
+  void drain();
+
+  /// Stops the drain thread after a final sweep and closes the sink.
+  /// Called automatically at process exit.
+  void shutdown();
+
+private:
+  struct entry {
+    timestamp stamp;
+    int level;
+    uint16_t size;
+    char text[max_message_size];
+  };
+
+  /// A bounded single-producer ring; the drain thread is the only consumer.
+  struct ring {
+    std::atomic<size_t> head = 0;
+    std::atomic<size_t> tail = 0;
+    std::atomic<uint64_t> dropped = 0;
+    /// Set by the owning thread's destructor; the drain thread deletes
+    /// retired rings once they are empty.
+    std::atomic<bool> retired = false;
+    std::array<entry, ring_capacity> entries;
+  };
+
+  async_logger() = default;
+
+  ~async_logger();
+
+  /// Returns the calling thread's ring, registering a fresh one on first use.
+  ring* local_ring();
+
+  /// Body of the drain thread.
+  void drain_loop();
+
+  /// Writes all pending entries of `rg` to `sink`.
+  void drain_ring(ring& rg, FILE* sink);
+
+  /// Active level; `level_quiet` bypasses the backend entirely.
+  std::atomic<int> level_ = level_quiet;
+
+  /// Guards `rings_` and `sink_`.
+  mutable std::mutex mtx_;
+
+  /// All registered rings, including retired ones not yet drained.
+  std::vector<std::unique_ptr<ring>> rings_;
+
+  /// Output destination; never null while the drain thread runs.
+  FILE* sink_ = nullptr;
+
+  /// Whether `sink_` needs `fclose`.
+  bool owns_sink_ = false;
+
+  /// Drop counts inherited from rings of exited threads; guarded by `mtx_`.
+  uint64_t retired_dropped_ = 0;
+
+  std::thread drainer_;
+
+  std::atomic<bool> running_ = false;
+};
+
+} // namespace broker::detail
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "broker/data.hh"
+#include "broker/expected.hh"
+
+namespace broker::detail {
+
+/// Content restored from a clone cache file.
+struct clone_cache_content {
+  /// The cached key-value pairs.
+  std::unordered_map<data, data> entries;
+
+  /// The command sequence number the entries reflect. A restarting clone
+  /// resumes the delta-resync protocol from this position.
+  uint64_t seq = 0;
+};
+
+/// Writes the state of a clone to `path`, replacing any previous cache
+/// atomically: the content lands in a temporary file first and only a
+/// successful write renames it into place, so a crash mid-flush leaves the
+/// previous cache intact. The format mirrors the store file encoding (see
+/// broker/detail/store_file.hh) with the sequence number in the header.
+expected<void> save_clone_cache(const std::string& path,
+                                const std::unordered_map<data, data>& entries,
+                                uint64_t seq);
+
+/// Reads a cache previously produced by `save_clone_cache`. Returns
+/// `ec::backend_failure` if the file does not exist or cannot be read and
+/// `ec::invalid_data` for malformed content.
+expected<clone_cache_content> load_clone_cache(const std::string& path);
+
+} // namespace broker::detail
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "broker/config.hh"
+
+// Opt-in instrumentation (BROKER_ENABLE_COPY_PROFILING) that counts
+// constructions, copies, moves and deep-copied bytes of frequently passed
+// value types. Counting happens in thread-local tallies, so the hot path
+// costs a handful of increments; aggregation across threads only happens on
+// `snapshot` or at process shutdown, when a summary goes to stderr. Default
+// builds compile all hooks away to no-ops.
+
+namespace broker::detail {
+
+/// Lifecycle tally for one instrumented class. @relates copy_profiler
+struct copy_profile {
+  /// Name of the instrumented class.
+  const char* name;
+
+  /// Number of non-copy, non-move constructions.
+  uint64_t constructions;
+
+  /// Number of copy constructions and copy assignments.
+  uint64_t copies;
+
+  /// Number of move constructions and move assignments.
+  uint64_t moves;
+
+  /// Estimated number of bytes duplicated by the copies.
+  uint64_t copied_bytes;
+};
+
+#ifdef BROKER_HAVE_COPY_PROFILING
+
+/// Collects process-wide @ref copy_profile tallies for instrumented classes.
+class copy_profiler {
+public:
+  /// Identifies an instrumented class.
+  enum class slot : size_t {
+    data,
+    topic,
+    num_slots,
+  };
+
+  /// Counts a non-copy, non-move construction for `x`.
+  static void add_construction(slot x) noexcept;
+
+  /// Counts a copy of `bytes` duplicated bytes for `x`.
+  static void add_copy(slot x, size_t bytes) noexcept;
+
+  /// Counts a move for `x`.
+  static void add_move(slot x) noexcept;
+
+  /// Aggregates the tallies of all threads seen so far.
+  static std::vector<copy_profile> snapshot();
+
+  /// Prints a human-readable summary of @ref snapshot to `out`.
+  static void dump(std::ostream& out);
+};
+
+#endif // BROKER_HAVE_COPY_PROFILING
+
+} // namespace broker::detail
+
+#ifdef BROKER_HAVE_COPY_PROFILING
+
+#define BROKER_PROFILE_CONSTRUCTION(cls)                                       \
+  broker::detail::copy_profiler::add_construction(                             \
+    broker::detail::copy_profiler::slot::cls)
+
+#define BROKER_PROFILE_COPY(cls, bytes)                                        \
+  broker::detail::copy_profiler::add_copy(                                     \
+    broker::detail::copy_profiler::slot::cls, bytes)
+
+#define BROKER_PROFILE_MOVE(cls)                                               \
+  broker::detail::copy_profiler::add_move(                                     \
+    broker::detail::copy_profiler::slot::cls)
+
+#else // BROKER_HAVE_COPY_PROFILING
+
+#define BROKER_PROFILE_CONSTRUCTION(cls) static_cast<void>(0)
+
+#define BROKER_PROFILE_COPY(cls, bytes) static_cast<void>(0)
+
+#define BROKER_PROFILE_MOVE(cls) static_cast<void>(0)
+
+#endif // BROKER_HAVE_COPY_PROFILING
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "broker/expected.hh"
+#include "broker/fwd.hh"
+
+namespace broker::detail {
+
+/// A compact binary codec for `data` values. Unlike the generic CAF
+/// inspection path, the format writes a single type tag byte per node,
+/// LEB128 varints for counts and container sizes, and zig-zag varints for
+/// signed integers and time values. Short strings and small containers thus
+/// occupy a couple of bytes instead of fixed-width length fields. The format
+/// is Broker-private: both ends of a connection or a storage file must agree
+/// on the codec version.
+
+/// Appends the LEB128 varint representation of `x` to `buf`. Exposed for
+/// framing code that prefixes codec output with length fields.
+void encode_varint(uint64_t x, std::vector<std::byte>& buf);
+
+/// Decodes a LEB128 varint from `[first, first + size)`.
+/// @returns the number of bytes consumed or 0 for truncated input.
+size_t decode_varint(const std::byte* first, size_t size, uint64_t& x);
+
+/// Appends the serialized representation of `x` to `buf`.
+void encode(const data& x, std::vector<std::byte>& buf);
+
+/// Convenience function that returns a fresh buffer holding `x`.
+std::vector<std::byte> encode(const data& x);
+
+/// Decodes a value previously produced by `encode`. Returns
+/// `ec::invalid_data` for truncated or malformed input.
+expected<data> decode(const std::byte* first, size_t size);
+
+/// @copydoc decode
+expected<data> decode(const std::vector<std::byte>& buf);
+
+// -- dictionary-compressed encoding -------------------------------------------
+
+class string_dictionary;
+
+/// Like `encode`, but routes strings and enum names through `dict`: the
+/// first occurrence travels as a literal, repetitions as a varint slot
+/// reference of typically two bytes. Dictionaries live per connection (see
+/// `peer_feature_dictionary` in broker/detail/peer_protocol.hh) and both
+/// ends must feed theirs every message in transmission order to stay in
+/// sync; see broker/detail/string_dictionary.hh.
+void encode(const data& x, std::vector<std::byte>& buf,
+            string_dictionary& dict);
+
+/// @copydoc encode
+std::vector<std::byte> encode(const data& x, string_dictionary& dict);
+
+/// Decodes a value previously produced by the dictionary-aware `encode`,
+/// applying the mirrored table updates to `dict`.
+expected<data> decode(const std::byte* first, size_t size,
+                      string_dictionary& dict);
+
+/// @copydoc decode
+expected<data> decode(const std::vector<std::byte>& buf,
+                      string_dictionary& dict);
+
+// -- field-level access for typed messages ------------------------------------
+
+class interned_enum;
+
+/// Cursor for decoding individual fields from a codec buffer. Decode
+/// functions advance `pos` past consumed bytes on success and leave the
+/// cursor untouched on failure.
+struct field_reader {
+  const std::byte* pos;
+  const std::byte* end;
+};
+
+/// Writes the header of a vector with `num_fields` elements. Together with
+/// one `encode_field` call per element, this produces bytes identical to
+/// `encode` on an equivalent `data` tree, without constructing that tree.
+void encode_vector_prefix(size_t num_fields, std::vector<std::byte>& buf);
+
+/// Consumes the header of a vector and checks that it announces exactly
+/// `num_fields` elements.
+bool decode_vector_prefix(field_reader& in, size_t num_fields);
+
+/// Appends a single typed field in codec format, i.e., the same bytes that
+/// `encode` produces for a `data` holding the value.
+void encode_field(boolean x, std::vector<std::byte>& buf);
+void encode_field(count x, std::vector<std::byte>& buf);
+void encode_field(integer x, std::vector<std::byte>& buf);
+void encode_field(real x, std::vector<std::byte>& buf);
+void encode_field(const std::string& x, std::vector<std::byte>& buf);
+void encode_field(const address& x, std::vector<std::byte>& buf);
+void encode_field(const subnet& x, std::vector<std::byte>& buf);
+void encode_field(const port& x, std::vector<std::byte>& buf);
+void encode_field(timestamp x, std::vector<std::byte>& buf);
+void encode_field(timespan x, std::vector<std::byte>& buf);
+void encode_field(const enum_value& x, std::vector<std::byte>& buf);
+void encode_field(interned_enum x, std::vector<std::byte>& buf);
+void encode_field(const vector& xs, std::vector<std::byte>& buf);
+void encode_field(const set& xs, std::vector<std::byte>& buf);
+void encode_field(const table& xs, std::vector<std::byte>& buf);
+void encode_field(const data& x, std::vector<std::byte>& buf);
+
+/// Decodes a single typed field, checking that the wire tag matches the
+/// requested type.
+bool decode_field(field_reader& in, boolean& x);
+bool decode_field(field_reader& in, count& x);
+bool decode_field(field_reader& in, integer& x);
+bool decode_field(field_reader& in, real& x);
+bool decode_field(field_reader& in, std::string& x);
+bool decode_field(field_reader& in, address& x);
+bool decode_field(field_reader& in, subnet& x);
+bool decode_field(field_reader& in, port& x);
+bool decode_field(field_reader& in, timestamp& x);
+bool decode_field(field_reader& in, timespan& x);
+bool decode_field(field_reader& in, enum_value& x);
+bool decode_field(field_reader& in, interned_enum& x);
+bool decode_field(field_reader& in, vector& xs);
+bool decode_field(field_reader& in, set& xs);
+bool decode_field(field_reader& in, table& xs);
+bool decode_field(field_reader& in, data& x);
+
+/// Decodes a single value in cursor style, routing string literals and slot
+/// references through `dict` like the buffer-level dictionary overloads.
+bool decode_field(field_reader& in, data& x, string_dictionary& dict);
+
+/// Encodes `x` as a sequence of buffers with at most `max_chunk_size` bytes
+/// each (plus the size of a single encoded element for compound values) and
+/// passes each completed chunk to `sink`. Unlike `encode`, this keeps peak
+/// memory flat for multi-gigabyte tables and sets, since the working buffer
+/// flushes after every element.
+void encode_chunked(const data& x, size_t max_chunk_size,
+                    const std::function<void(std::vector<std::byte>)>& sink);
+
+/// Incrementally reassembles and decodes a value emitted by `encode_chunked`.
+/// Elements of compound values materialize as their bytes arrive, so the
+/// decoder never buffers more than one partial element.
+class chunked_decoder {
+public:
+  chunked_decoder();
+
+  chunked_decoder(chunked_decoder&&) noexcept;
+
+  chunked_decoder& operator=(chunked_decoder&&) noexcept;
+
+  ~chunked_decoder();
+
+  /// Feeds the next chunk into the decoder.
+  void append(const std::byte* first, size_t size);
+
+  /// @copydoc append
+  void append(const std::vector<std::byte>& chunk) {
+    append(chunk.data(), chunk.size());
+  }
+
+  /// Returns the decoded value after feeding all chunks. Returns
+  /// `ec::invalid_data` if the accumulated input was truncated or malformed.
+  expected<data> finish();
+
+private:
+  struct impl;
+  std::unique_ptr<impl> impl_;
+};
+
+} // namespace broker::detail
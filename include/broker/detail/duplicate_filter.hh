@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "broker/detail/peer_table.hh"
+#include "broker/endpoint_id.hh"
+
+namespace broker::detail {
+
+/// Per-origin window state of a duplicate filter.
+struct sequence_window {
+  /// Highest sequence number seen from this origin.
+  uint64_t max_seq = 0;
+
+  /// Bit `i` set means `max_seq - i` was seen. Bit 0 refers to `max_seq`.
+  uint64_t mask = 0;
+};
+
+/// Tracks recently seen per-origin sequence numbers for suppressing
+/// duplicates. Each origin keeps the highest sequence number seen plus a
+/// sliding bitmask of the 64 numbers below it, so slightly out-of-order
+/// arrivals still pass while repeats and stale floods get dropped.
+template <class Key, class Table = std::unordered_map<Key, sequence_window>>
+class basic_duplicate_filter {
+public:
+  /// Number of sequence numbers below the maximum that remain addressable.
+  static constexpr uint64_t window_size = 64;
+
+  /// Checks whether the message `(origin, seq)` was seen before and records
+  /// it otherwise. Sequence numbers that fall behind the window count as
+  /// duplicates, since repeats arrive within a short time span.
+  bool is_duplicate(const Key& origin, uint64_t seq) {
+    auto& win = windows_[origin];
+    if (seq > win.max_seq) {
+      auto shift = seq - win.max_seq;
+      win.mask = shift < window_size ? (win.mask << shift) | 1u : 1u;
+      win.max_seq = seq;
+      return false;
+    }
+    auto offset = win.max_seq - seq;
+    if (offset >= window_size)
+      return true;
+    auto bit = uint64_t{1} << offset;
+    if (win.mask & bit)
+      return true;
+    win.mask |= bit;
+    return false;
+  }
+
+  /// Drops all state for `origin`, e.g., after the peer disconnected.
+  void erase(const Key& origin) {
+    windows_.erase(origin);
+  }
+
+  size_t size() const noexcept {
+    return windows_.size();
+  }
+
+private:
+  Table windows_;
+};
+
+/// Suppresses duplicates that arrive over multiple paths in a multi-hop
+/// topology, keyed by the flooding origin.
+using duplicate_filter
+  = basic_duplicate_filter<endpoint_id, peer_table<sequence_window>>;
+
+} // namespace broker::detail
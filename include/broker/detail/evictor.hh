@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "broker/data.hh"
+#include "broker/time.hh"
+
+namespace broker::detail {
+
+/// Bookkeeping for enforcing a per-store entry budget. Tracks the key set of
+/// a store and picks eviction victims according to a configurable policy:
+/// least-recently-used, nearest expiry first, or uniformly at random. The
+/// caller mirrors every mutation into the evictor and erases the victims it
+/// returns from the actual backend.
+class evictor {
+public:
+  enum class policy : uint8_t {
+    disabled,
+    /// Evicts the entry that went the longest without a read or write.
+    lru,
+    /// Evicts the entry closest to its expiry time; entries without an expiry
+    /// only get evicted once no expiring entries remain, oldest first.
+    ttl,
+    /// Evicts a uniformly random entry.
+    random,
+  };
+
+  evictor() = default;
+
+  evictor(policy p, uint64_t max_entries);
+
+  evictor(evictor&&) = default;
+
+  evictor& operator=(evictor&&) = default;
+
+  // The iterator maps would dangle after a member-wise copy.
+  evictor(const evictor&) = delete;
+
+  evictor& operator=(const evictor&) = delete;
+
+  /// Maps "lru", "ttl" and "random" to the corresponding policy.
+  static std::optional<policy> parse_policy(const std::string& str);
+
+  /// Returns whether this evictor enforces a budget.
+  bool enabled() const noexcept {
+    return policy_ != policy::disabled && max_entries_ > 0;
+  }
+
+  uint64_t max_entries() const noexcept {
+    return max_entries_;
+  }
+
+  /// Returns the number of tracked keys.
+  size_t size() const noexcept;
+
+  /// Records an insert or overwrite of `key`, also refreshing its position in
+  /// the eviction order.
+  void insert(const data& key, std::optional<timestamp> expiry = std::nullopt);
+
+  /// Records a read of `key`. Only affects the LRU order.
+  void touch(const data& key);
+
+  /// Removes `key` from the bookkeeping. Ignores unknown keys.
+  void erase(const data& key);
+
+  /// Removes all keys.
+  void clear();
+
+  /// Removes and returns the next victim, or `nullopt` if no keys remain.
+  std::optional<data> evict();
+
+private:
+  policy policy_ = policy::disabled;
+
+  uint64_t max_entries_ = 0;
+
+  // --- LRU state, least recently used at the front ---------------------------
+
+  std::list<data> lru_order_;
+
+  std::unordered_map<data, std::list<data>::iterator> lru_pos_;
+
+  // --- TTL state -------------------------------------------------------------
+
+  /// Expiring keys, nearest expiry first.
+  std::multimap<timestamp, data> ttl_order_;
+
+  std::unordered_map<data, std::multimap<timestamp, data>::iterator> ttl_pos_;
+
+  /// Non-expiring keys in insertion order; fallback victims once no expiring
+  /// keys remain.
+  std::list<data> fifo_order_;
+
+  std::unordered_map<data, std::list<data>::iterator> fifo_pos_;
+
+  // --- random state, swap-remove keeps eviction O(1) -------------------------
+
+  std::vector<data> keys_;
+
+  std::unordered_map<data, size_t> key_pos_;
+
+  std::minstd_rand engine_{std::random_device{}()};
+};
+
+} // namespace broker::detail
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "broker/detail/hash.hh"
+#include "broker/topic.hh"
+
+namespace broker::detail {
+
+/// A compact Bloom filter over the first topic segment of a subscription
+/// filter. Most peers subscribe to narrow topic slices, so the dispatch path
+/// can reject the bulk of non-matching messages with two hash-and-test
+/// operations before running the full prefix matcher. The filter is rebuilt
+/// whenever the subscription filter changes.
+///
+/// The fast path only engages when every filter entry terminates its first
+/// segment with a separator. An entry such as `/ze` may prefix-match topics
+/// with a *different* first segment (`/zeek/...`), in which case segment
+/// hashing would produce false rejects; such filters degrade to pass-through.
+class first_segment_filter {
+public:
+  /// Number of bits in the filter.
+  static constexpr size_t num_bits = 512;
+
+  first_segment_filter() {
+    clear();
+  }
+
+  /// Resets the filter to pass-through state with no entries.
+  void clear() {
+    bits_.fill(0);
+    exact_ = true;
+  }
+
+  /// Rebuilds the filter from `filter`.
+  void assign(const std::vector<topic>& filter) {
+    clear();
+    for (auto& entry : filter) {
+      auto [segment, complete] = first_segment(entry.string());
+      if (!complete || segment == topic::wildcard_str) {
+        // A partial first segment can match topics with other first
+        // segments and a wildcard matches any of them; disable the fast
+        // path entirely.
+        exact_ = false;
+        return;
+      }
+      add(segment);
+    }
+  }
+
+  /// Checks whether `t` can possibly match the underlying filter. Returning
+  /// true means "maybe"; returning false is definitive.
+  [[nodiscard]] bool may_match(const topic& t) const noexcept {
+    if (!exact_)
+      return true;
+    auto [segment, complete] = first_segment(t.string());
+    // The segment of a full topic is always usable, complete or not.
+    auto h = hash(segment);
+    return contains(h.first) && contains(h.second);
+  }
+
+  /// Returns whether the fast path is active for the current filter.
+  [[nodiscard]] bool active() const noexcept {
+    return exact_;
+  }
+
+private:
+  /// Extracts the first topic segment and whether a separator or further
+  /// characters terminate it within the string.
+  static std::pair<std::string_view, bool>
+  first_segment(std::string_view str) noexcept {
+    if (!str.empty() && str.front() == topic::sep)
+      str.remove_prefix(1);
+    auto pos = str.find(topic::sep);
+    if (pos == std::string_view::npos)
+      return {str, false};
+    return {str.substr(0, pos), true};
+  }
+
+  static std::pair<uint64_t, uint64_t> hash(std::string_view x) noexcept {
+    // The project-wide hasher, then a second hash derived from the first.
+    auto h = hash_bytes(x.data(), x.size());
+    return {h, hash_mix(h, hash_secret[2])};
+  }
+
+  void add(std::string_view segment) {
+    auto h = hash(segment);
+    set(h.first);
+    set(h.second);
+  }
+
+  void set(uint64_t h) {
+    bits_[(h % num_bits) / 64] |= uint64_t{1} << (h % 64);
+  }
+
+  [[nodiscard]] bool contains(uint64_t h) const noexcept {
+    return (bits_[(h % num_bits) / 64] & (uint64_t{1} << (h % 64))) != 0;
+  }
+
+  std::array<uint64_t, num_bits / 64> bits_;
+  bool exact_;
+};
+
+} // namespace broker::detail
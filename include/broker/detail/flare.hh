@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <chrono>
 
@@ -18,10 +19,13 @@ class flare {
 public:
   using timeout_type = clock::time_point;
 
-  /// Constructs a flare by opening a UNIX pipe.
+  /// Constructs a flare. On Linux, the flare keeps its count in an atomic
+  /// variable and uses an `eventfd` merely as a wakeup token, coalescing
+  /// consecutive fires into zero syscalls. Elsewhere, the flare opens a UNIX
+  /// pipe and stores its count as unread bytes.
   flare();
 
-  /// Destructs the flare, closing the UNIX pipe's file descriptors.
+  /// Destructs the flare, closing its file descriptor(s).
   ~flare();
 
   flare(const flare&) = delete;
@@ -55,6 +59,12 @@ public:
   /// Blocks the caller until the object could consume one byte from the pipe.
   void await_one();
 
+  /// Busy-polls the ready state for up to `max_spins` iterations without
+  /// issuing a single syscall and returns whether the flare became ready
+  /// during the spin. Only the Linux implementation can observe its count
+  /// cheaply; the pipe-based fallback always returns `false` immediately.
+  bool spin_await_one(size_t max_spins) const;
+
   /// Blocks the caller until the object could consume one byte from the pipe
   /// or or a timeout occurs.
   template <class Timeout>
@@ -70,7 +80,17 @@ public:
 private:
   bool await_one_impl(int ms_timeout);
 
+#ifdef BROKER_LINUX
+  /// Drains the wakeup token and re-arms it if the count is non-zero, so
+  /// that concurrent fires cannot leave the flare ready without a token.
+  void settle();
+
+  native_socket efd_;
+
+  std::atomic<uint64_t> count_;
+#else
   native_socket fds_[2];
+#endif
 };
 
 } // namespace broker::detail
@@ -0,0 +1,396 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace broker::detail {
+
+/// A hash map with open addressing and robin-hood probing that stores its
+/// entries in a single flat array. Compared to the node-based
+/// `std::unordered_map`, lookups touch one contiguous allocation instead of
+/// chasing a bucket pointer per entry, and insertions amortize to no
+/// allocation at all. Hash digests are cached per slot, so rehashing never
+/// re-runs the hash function and probing skips the (potentially deep) key
+/// comparison on digest mismatch. Deletion uses backward shifting, which
+/// keeps probe sequences short without tombstones.
+///
+/// The table grows by doubling at a load factor of 7/8. Any mutation
+/// invalidates all iterators. Unlike `std::unordered_map`, references to
+/// entries do not remain stable across mutations either.
+template <class Key, class T, class Hash = std::hash<Key>>
+class flat_hash_map {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using key_type = Key;
+
+  using mapped_type = T;
+
+  using value_type = std::pair<Key, T>;
+
+  template <bool IsConst>
+  class iterator_impl {
+  public:
+    using value_type = flat_hash_map::value_type;
+    using reference
+      = std::conditional_t<IsConst, const value_type&, value_type&>;
+    using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+    using difference_type = ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+    iterator_impl() = default;
+
+    iterator_impl(const iterator_impl&) = default;
+
+    iterator_impl& operator=(const iterator_impl&) = default;
+
+    /// Enables implicit conversion from `iterator` to `const_iterator`.
+    template <bool B = IsConst, class = std::enable_if_t<B>>
+    iterator_impl(const iterator_impl<false>& other)
+      : parent_(other.parent_), pos_(other.pos_) {
+      // nop
+    }
+
+    reference operator*() const {
+      return *ptr();
+    }
+
+    pointer operator->() const {
+      return ptr();
+    }
+
+    iterator_impl& operator++() {
+      pos_ = parent_->next_occupied(pos_ + 1);
+      return *this;
+    }
+
+    iterator_impl operator++(int) {
+      auto result = *this;
+      ++*this;
+      return result;
+    }
+
+    friend bool operator==(const iterator_impl& x, const iterator_impl& y) {
+      return x.pos_ == y.pos_;
+    }
+
+    friend bool operator!=(const iterator_impl& x, const iterator_impl& y) {
+      return !(x == y);
+    }
+
+  private:
+    friend class flat_hash_map;
+
+    iterator_impl(const flat_hash_map* parent, size_t pos)
+      : parent_(parent), pos_(pos) {
+      // nop
+    }
+
+    pointer ptr() const {
+      return const_cast<flat_hash_map*>(parent_)->slots() + pos_;
+    }
+
+    const flat_hash_map* parent_ = nullptr;
+    size_t pos_ = 0;
+  };
+
+  using iterator = iterator_impl<false>;
+
+  using const_iterator = iterator_impl<true>;
+
+  // -- construction and assignment --------------------------------------------
+
+  flat_hash_map() = default;
+
+  flat_hash_map(const flat_hash_map& other) {
+    reserve(other.size());
+    for (const auto& kv : other)
+      emplace(kv.first, kv.second);
+  }
+
+  flat_hash_map(flat_hash_map&& other) noexcept
+    : storage_(std::move(other.storage_)),
+      hashes_(std::move(other.hashes_)),
+      dists_(std::move(other.dists_)),
+      size_(other.size_),
+      capacity_(other.capacity_) {
+    other.size_ = 0;
+    other.capacity_ = 0;
+  }
+
+  flat_hash_map& operator=(const flat_hash_map& other) {
+    flat_hash_map tmp{other};
+    swap(tmp);
+    return *this;
+  }
+
+  flat_hash_map& operator=(flat_hash_map&& other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~flat_hash_map() {
+    clear();
+  }
+
+  void swap(flat_hash_map& other) noexcept {
+    storage_.swap(other.storage_);
+    hashes_.swap(other.hashes_);
+    dists_.swap(other.dists_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+  }
+
+  // -- properties -------------------------------------------------------------
+
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  /// Grows the table so that it can hold at least `n` entries without
+  /// rehashing.
+  void reserve(size_t n) {
+    auto required = min_capacity;
+    while (n * 8 > required * 7)
+      required *= 2;
+    if (required > capacity_)
+      rehash(required);
+  }
+
+  /// Shrinks the table to the smallest capacity that holds the current
+  /// entries within the load factor, releasing the excess memory. Growing
+  /// never shrinks on its own, so tables that drained after a peak keep
+  /// their peak-sized arrays until this gets called.
+  void shrink_to_fit() {
+    if (size_ == 0) {
+      storage_.reset();
+      hashes_ = {};
+      dists_ = {};
+      capacity_ = 0;
+      return;
+    }
+    auto required = min_capacity;
+    while (size_ * 8 > required * 7)
+      required *= 2;
+    if (required >= capacity_)
+      return;
+    rehash(required);
+    // The assign in rehash never trims vector capacity.
+    hashes_.shrink_to_fit();
+    dists_.shrink_to_fit();
+  }
+
+  // -- iteration --------------------------------------------------------------
+
+  iterator begin() noexcept {
+    return {this, next_occupied(0)};
+  }
+
+  const_iterator begin() const noexcept {
+    return {this, next_occupied(0)};
+  }
+
+  iterator end() noexcept {
+    return {this, capacity_};
+  }
+
+  const_iterator end() const noexcept {
+    return {this, capacity_};
+  }
+
+  // -- lookup -----------------------------------------------------------------
+
+  iterator find(const Key& key) {
+    auto idx = find_index(Hash{}(key), key);
+    return {this, idx != npos ? idx : capacity_};
+  }
+
+  const_iterator find(const Key& key) const {
+    auto idx = find_index(Hash{}(key), key);
+    return {this, idx != npos ? idx : capacity_};
+  }
+
+  size_t count(const Key& key) const {
+    return find_index(Hash{}(key), key) != npos ? 1 : 0;
+  }
+
+  // -- modifiers --------------------------------------------------------------
+
+  template <class K, class V>
+  std::pair<iterator, bool> emplace(K&& key, V&& value) {
+    auto h = Hash{}(key);
+    if (auto idx = find_index(h, key); idx != npos)
+      return {iterator{this, idx}, false};
+    grow_if_needed();
+    auto idx = insert_slot(h, value_type(Key(std::forward<K>(key)),
+                                         T(std::forward<V>(value))));
+    return {iterator{this, idx}, true};
+  }
+
+  std::pair<iterator, bool> insert(value_type kv) {
+    return emplace(std::move(kv.first), std::move(kv.second));
+  }
+
+  T& operator[](const Key& key) {
+    return emplace(key, T{}).first->second;
+  }
+
+  size_t erase(const Key& key) {
+    auto idx = find_index(Hash{}(key), key);
+    if (idx == npos)
+      return 0;
+    erase_slot(idx);
+    return 1;
+  }
+
+  /// Removes the entry at `i`. Backward shifting moves a later entry into
+  /// the vacated slot, so erasing while iterating visits that entry again.
+  iterator erase(iterator i) {
+    auto pos = i.pos_;
+    erase_slot(pos);
+    return {this, dists_[pos] != 0 ? pos : next_occupied(pos)};
+  }
+
+  void clear() noexcept {
+    for (size_t i = 0; i < capacity_; ++i)
+      if (dists_[i] != 0) {
+        slots()[i].~value_type();
+        dists_[i] = 0;
+      }
+    size_ = 0;
+  }
+
+private:
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+  static constexpr size_t min_capacity = 8;
+
+  using storage_type
+    = std::aligned_storage_t<sizeof(value_type), alignof(value_type)>;
+
+  value_type* slots() noexcept {
+    return reinterpret_cast<value_type*>(storage_.get());
+  }
+
+  size_t mask() const noexcept {
+    return capacity_ - 1;
+  }
+
+  size_t next_occupied(size_t pos) const noexcept {
+    while (pos < capacity_ && dists_[pos] == 0)
+      ++pos;
+    return pos;
+  }
+
+  /// Returns the slot index of `key` or `npos`. Residents store their probe
+  /// distance (starting at 1; 0 marks an empty slot), so hitting a slot
+  /// whose resident sits closer to its home than we are proves the key
+  /// absent.
+  size_t find_index(size_t h, const Key& key) const {
+    if (capacity_ == 0)
+      return npos;
+    auto self = const_cast<flat_hash_map*>(this);
+    auto idx = h & mask();
+    uint32_t dist = 1;
+    for (;;) {
+      auto d = dists_[idx];
+      if (d < dist)
+        return npos;
+      if (hashes_[idx] == h && self->slots()[idx].first == key)
+        return idx;
+      idx = (idx + 1) & mask();
+      ++dist;
+    }
+  }
+
+  /// Places a new entry via robin-hood probing: whenever the entry in hand
+  /// is further from its home slot than the resident, the two swap and the
+  /// probe continues with the displaced resident. Returns the slot where
+  /// the *original* entry ended up.
+  size_t insert_slot(size_t h, value_type&& kv) {
+    auto idx = h & mask();
+    uint32_t dist = 1;
+    auto result = npos;
+    for (;;) {
+      auto& d = dists_[idx];
+      if (d == 0) {
+        new (slots() + idx) value_type(std::move(kv));
+        hashes_[idx] = h;
+        d = dist;
+        ++size_;
+        return result != npos ? result : idx;
+      }
+      if (d < dist) {
+        std::swap(h, hashes_[idx]);
+        std::swap(dist, d);
+        std::swap(kv, slots()[idx]);
+        if (result == npos)
+          result = idx;
+      }
+      idx = (idx + 1) & mask();
+      ++dist;
+    }
+  }
+
+  /// Empties a slot and shifts subsequent out-of-place entries back by one,
+  /// which restores the robin-hood invariant without tombstones.
+  void erase_slot(size_t idx) {
+    slots()[idx].~value_type();
+    auto next = (idx + 1) & mask();
+    while (dists_[next] > 1) {
+      new (slots() + idx) value_type(std::move(slots()[next]));
+      slots()[next].~value_type();
+      hashes_[idx] = hashes_[next];
+      dists_[idx] = dists_[next] - 1;
+      idx = next;
+      next = (next + 1) & mask();
+    }
+    dists_[idx] = 0;
+    --size_;
+  }
+
+  void grow_if_needed() {
+    if (capacity_ == 0)
+      rehash(min_capacity);
+    else if ((size_ + 1) * 8 > capacity_ * 7)
+      rehash(capacity_ * 2);
+  }
+
+  void rehash(size_t new_capacity) {
+    auto old_capacity = capacity_;
+    auto old_storage = std::move(storage_);
+    auto old_hashes = std::move(hashes_);
+    auto old_dists = std::move(dists_);
+    capacity_ = new_capacity;
+    storage_.reset(new storage_type[new_capacity]);
+    hashes_.assign(new_capacity, 0);
+    dists_.assign(new_capacity, 0);
+    size_ = 0;
+    auto old_slots = reinterpret_cast<value_type*>(old_storage.get());
+    for (size_t i = 0; i < old_capacity; ++i)
+      if (old_dists[i] != 0) {
+        // Re-inserting by cached hash: the key never gets hashed again.
+        insert_slot(old_hashes[i], std::move(old_slots[i]));
+        old_slots[i].~value_type();
+      }
+  }
+
+  std::unique_ptr<storage_type[]> storage_;
+  std::vector<size_t> hashes_;
+  std::vector<uint32_t> dists_;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+} // namespace broker::detail
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace broker::detail {
+
+/// An associative container backed by a sorted `std::vector`. Lookups use
+/// binary search and iteration is cache-linear, which makes this a better fit
+/// than `std::map` for mid-sized tables that are built once and then scanned
+/// repeatedly (serialization, store writes). Insertion into a large map is
+/// O(n), so this type is *not* a drop-in replacement for workloads with heavy
+/// random insertion. The interface covers the subset of `std::map` that
+/// Broker uses internally.
+template <class Key, class Val, class Compare = std::less<Key>>
+class flat_map {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using key_type = Key;
+  using mapped_type = Val;
+  using value_type = std::pair<Key, Val>;
+  using storage_type = std::vector<value_type>;
+  using size_type = typename storage_type::size_type;
+  using iterator = typename storage_type::iterator;
+  using const_iterator = typename storage_type::const_iterator;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  flat_map() = default;
+
+  flat_map(std::initializer_list<value_type> xs) {
+    for (auto& x : xs)
+      insert(x);
+  }
+
+  // -- iterators --------------------------------------------------------------
+
+  iterator begin() noexcept {
+    return xs_.begin();
+  }
+
+  const_iterator begin() const noexcept {
+    return xs_.begin();
+  }
+
+  iterator end() noexcept {
+    return xs_.end();
+  }
+
+  const_iterator end() const noexcept {
+    return xs_.end();
+  }
+
+  // -- capacity ---------------------------------------------------------------
+
+  [[nodiscard]] bool empty() const noexcept {
+    return xs_.empty();
+  }
+
+  size_type size() const noexcept {
+    return xs_.size();
+  }
+
+  void reserve(size_type n) {
+    xs_.reserve(n);
+  }
+
+  // -- lookup -----------------------------------------------------------------
+
+  iterator find(const key_type& key) {
+    auto i = lower_bound(key);
+    return i != end() && !cmp_(key, i->first) ? i : end();
+  }
+
+  const_iterator find(const key_type& key) const {
+    auto i = lower_bound(key);
+    return i != end() && !cmp_(key, i->first) ? i : end();
+  }
+
+  size_type count(const key_type& key) const {
+    return find(key) != end() ? 1 : 0;
+  }
+
+  iterator lower_bound(const key_type& key) {
+    return std::lower_bound(begin(), end(), key, key_less);
+  }
+
+  const_iterator lower_bound(const key_type& key) const {
+    return std::lower_bound(begin(), end(), key, key_less);
+  }
+
+  iterator upper_bound(const key_type& key) {
+    return std::upper_bound(begin(), end(), key, value_greater);
+  }
+
+  const_iterator upper_bound(const key_type& key) const {
+    return std::upper_bound(begin(), end(), key, value_greater);
+  }
+
+  // -- modifiers --------------------------------------------------------------
+
+  std::pair<iterator, bool> insert(value_type x) {
+    auto i = lower_bound(x.first);
+    if (i != end() && !cmp_(x.first, i->first))
+      return {i, false};
+    return {xs_.insert(i, std::move(x)), true};
+  }
+
+  template <class... Ts>
+  std::pair<iterator, bool> emplace(Ts&&... ys) {
+    return insert(value_type(std::forward<Ts>(ys)...));
+  }
+
+  mapped_type& operator[](const key_type& key) {
+    auto i = lower_bound(key);
+    if (i != end() && !cmp_(key, i->first))
+      return i->second;
+    return xs_.insert(i, value_type(key, mapped_type{}))->second;
+  }
+
+  iterator erase(const_iterator pos) {
+    return xs_.erase(pos);
+  }
+
+  size_type erase(const key_type& key) {
+    auto i = find(key);
+    if (i == end())
+      return 0;
+    xs_.erase(i);
+    return 1;
+  }
+
+  void clear() noexcept {
+    xs_.clear();
+  }
+
+  // -- comparison -------------------------------------------------------------
+
+  friend bool operator==(const flat_map& xs, const flat_map& ys) {
+    return xs.xs_ == ys.xs_;
+  }
+
+  friend bool operator!=(const flat_map& xs, const flat_map& ys) {
+    return xs.xs_ != ys.xs_;
+  }
+
+private:
+  static bool key_less(const value_type& x, const key_type& y) {
+    return Compare{}(x.first, y);
+  }
+
+  static bool value_greater(const key_type& x, const value_type& y) {
+    return Compare{}(x, y.first);
+  }
+
+  storage_type xs_;
+  Compare cmp_;
+};
+
+} // namespace broker::detail
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "broker/detail/native_socket.hh"
+#include "broker/expected.hh"
+#include "broker/fwd.hh"
+
+namespace broker::detail {
+
+/// Collects borrowed byte segments for scatter-gather socket writes. Instead
+/// of consolidating topic bytes, frame header and payload into one contiguous
+/// buffer, callers register each region and the list writes all of them with
+/// `writev`-style vectored I/O, skipping the consolidating copy entirely.
+///
+/// Segments either borrow stable memory directly or reference a range inside
+/// a scratch buffer by offset. Offset-based segments stay valid even when the
+/// scratch buffer reallocates while assembling further frames; borrowed
+/// segments must point to memory that outlives the write.
+class segment_list {
+public:
+  explicit segment_list(const std::vector<std::byte>* scratch = nullptr)
+    : scratch_(scratch) {
+    // nop
+  }
+
+  /// Appends a segment that borrows `size` bytes at `data`.
+  void append(const void* data, size_t size);
+
+  /// Appends a segment referencing `[offset, offset + size)` in the scratch
+  /// buffer.
+  /// @pre a scratch buffer was passed to the constructor
+  void append_scratch(size_t offset, size_t size);
+
+  /// Returns the number of segments in the list.
+  size_t size() const noexcept {
+    return segments_.size();
+  }
+
+  /// Returns whether the list contains no segments.
+  bool empty() const noexcept {
+    return segments_.empty();
+  }
+
+  /// Returns the total number of payload bytes across all segments.
+  size_t total_bytes() const noexcept {
+    return total_bytes_;
+  }
+
+  /// Returns the number of bytes already written to a socket.
+  size_t written_bytes() const noexcept {
+    return written_;
+  }
+
+  /// Drops all segments and resets the write cursor.
+  void clear() noexcept {
+    segments_.clear();
+    total_bytes_ = 0;
+    written_ = 0;
+  }
+
+  /// Performs a single vectored write of as many unwritten segments as the
+  /// platform allows. Advances the write cursor on success.
+  /// @returns the number of bytes written, 0 if all segments were written
+  ///          already, or -1 on I/O errors (with errno set).
+  ptrdiff_t write_some(native_socket fd);
+
+  /// Writes all remaining segments to a blocking socket, retrying on EINTR
+  /// and partial writes.
+  /// @returns `true` if all bytes reached the socket, `false` on I/O errors
+  ///          (with errno set).
+  bool write_all(native_socket fd);
+
+private:
+  /// A single I/O region; `data == nullptr` marks a scratch-relative segment.
+  struct segment {
+    const std::byte* data;
+    size_t offset;
+    size_t size;
+  };
+
+  const std::byte* segment_data(const segment& x) const noexcept {
+    return x.data != nullptr ? x.data : scratch_->data() + x.offset;
+  }
+
+  const std::vector<std::byte>* scratch_;
+  std::vector<segment> segments_;
+  size_t total_bytes_ = 0;
+  size_t written_ = 0;
+};
+
+/// Appends a wire frame for `msg` to `out` without copying the topic bytes.
+/// The frame consists of two varints (topic size and payload size) and the
+/// payload, both placed in the scratch buffer of `out`, plus a borrowed
+/// segment referencing the topic string of `msg`. The message must stay alive
+/// until the frame is written.
+void encode_frame(const data_message& msg, std::vector<std::byte>& scratch,
+                  segment_list& out);
+
+/// Decodes a frame produced by `encode_frame` from a contiguous buffer, e.g.,
+/// after reading from a socket. Sets `consumed` to the total frame size on
+/// success. Returns `ec::invalid_data` for malformed input and
+/// `ec::end_of_file` for incomplete input, allowing callers to retry the
+/// latter with more bytes.
+expected<data_message> decode_frame(const std::byte* first, size_t size,
+                                    size_t& consumed);
+
+} // namespace broker::detail
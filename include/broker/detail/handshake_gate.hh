@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace broker::detail {
+
+/// Admission control for inbound peering handshakes. After a network outage,
+/// hundreds of peers may reconnect at once; without a gate, the resulting
+/// burst of handshakes and manager setup starves dispatch for established
+/// peers. The gate combines a token bucket, which spreads handshake work over
+/// time, with a cap on handshakes that are admitted but not yet completed.
+/// Accept loops consult `try_admit` before any handshake work and close the
+/// socket on denial, so rejected peers fail fast and their reconnect backoff
+/// starts immediately instead of stalling on an unanswered handshake.
+/// Thread-safe; all accept threads of a @ref peer_listener share one gate.
+class handshake_gate {
+public:
+  /// Creates a gate admitting at most `handshakes_per_second` on average with
+  /// bursts up to `burst` and at most `max_pending` handshakes in flight. A
+  /// non-positive rate disables the token bucket, `burst` 0 defaults to the
+  /// rounded rate (at least 1), and `max_pending` 0 leaves the number of
+  /// in-flight handshakes uncapped.
+  handshake_gate(double handshakes_per_second, size_t burst,
+                 size_t max_pending);
+
+  /// Grants or denies admission for one handshake. On admission, the caller
+  /// owns one in-flight slot and must pair the call with `done`. Never
+  /// blocks; denied handshakes count towards `rejected`.
+  bool try_admit();
+
+  /// Releases the in-flight slot of a completed or failed handshake.
+  void done();
+
+  /// Returns the number of admitted handshakes that have not completed yet.
+  /// Useful as a gauge for monitoring recovery after an outage.
+  size_t pending() const noexcept {
+    return pending_.load(std::memory_order_relaxed);
+  }
+
+  /// Returns the number of handshakes denied since construction.
+  uint64_t rejected() const noexcept {
+    return rejected_.load(std::memory_order_relaxed);
+  }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  /// Average admission rate; non-positive disables the bucket.
+  double rate_;
+
+  /// Bucket capacity.
+  double burst_;
+
+  /// Maximum number of in-flight handshakes; 0 means unlimited.
+  size_t max_pending_;
+
+  /// Guards `tokens_` and `last_refill_`.
+  std::mutex mtx_;
+
+  /// Currently available tokens, refilled on demand from `last_refill_`.
+  double tokens_;
+
+  clock::time_point last_refill_;
+
+  /// Admitted handshakes without a matching `done` yet.
+  std::atomic<size_t> pending_ = 0;
+
+  /// Counts denied handshakes.
+  std::atomic<uint64_t> rejected_ = 0;
+};
+
+} // namespace broker::detail
@@ -1,8 +1,12 @@
 #pragma once
 
-// Note: Broker no longer uses this header, but Zeek still depends on
-// broker::detail::hash_combine.
+// Note: Zeek still depends on broker::detail::hash_combine, which therefore
+// keeps its historic std::hash-based formula. The remainder of this header
+// implements the project-wide hasher.
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 
 namespace broker::detail {
@@ -13,4 +17,107 @@ void hash_combine(size_t& seed, const T& v) {
   seed ^= std::hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
+// -- wyhash-based project-wide hasher -----------------------------------------
+//
+// A seeded 64-bit hash in the wyhash family: the core operation is a full
+// 64x64->128-bit multiply folded back to 64 bits, which spreads every input
+// bit across the whole output in a single instruction pair on 64-bit
+// targets. Hash-keyed containers and filters build on `hash_bytes` for flat
+// byte sequences and on `hash_combine64` for folding the digests of
+// composite values.
+
+/// Secret constants of the hash function (the wyhash defaults).
+constexpr uint64_t hash_secret[4] = {
+  0xa0761d6478bd642full,
+  0xe7037ed1a0b428dbull,
+  0x8ebc6af09c88c6e3ull,
+  0x589965cc75374cc3ull,
+};
+
+/// Computes the full 128-bit product of `a` and `b`, returning the low half
+/// and storing the high half in `hi`.
+inline uint64_t mul128(uint64_t a, uint64_t b, uint64_t& hi) noexcept {
+#ifdef __SIZEOF_INT128__
+  auto r = static_cast<unsigned __int128>(a) * b;
+  hi = static_cast<uint64_t>(r >> 64);
+  return static_cast<uint64_t>(r);
+#else
+  auto lo32 = [](uint64_t x) { return x & 0xFFFFFFFFull; };
+  auto ll = lo32(a) * lo32(b);
+  auto lh = lo32(a) * (b >> 32);
+  auto hl = (a >> 32) * lo32(b);
+  auto hh = (a >> 32) * (b >> 32);
+  auto cross = lh + (ll >> 32) + lo32(hl);
+  hi = hh + (cross >> 32) + (hl >> 32);
+  return (cross << 32) | lo32(ll);
+#endif
+}
+
+/// Multiplies `a` and `b` to 128 bits and folds the halves with XOR.
+inline uint64_t hash_mix(uint64_t a, uint64_t b) noexcept {
+  uint64_t hi = 0;
+  auto lo = mul128(a, b, hi);
+  return lo ^ hi;
+}
+
+/// Folds `value` into `seed`. The ordered fold of the element digests of a
+/// container yields the digest of the container.
+inline uint64_t hash_combine64(uint64_t seed, uint64_t value) noexcept {
+  return hash_mix(seed ^ hash_secret[0], value ^ hash_secret[1]);
+}
+
+/// Hashes `size` bytes starting at `bytes` with `seed`.
+inline uint64_t hash_bytes(const void* bytes, size_t size,
+                           uint64_t seed = 0) noexcept {
+  auto r8 = [](const unsigned char* p) {
+    uint64_t x;
+    memcpy(&x, p, 8);
+    return x;
+  };
+  auto r4 = [](const unsigned char* p) {
+    uint32_t x;
+    memcpy(&x, p, 4);
+    return uint64_t{x};
+  };
+  auto p = static_cast<const unsigned char*>(bytes);
+  seed ^= hash_mix(seed ^ hash_secret[0], hash_secret[1]);
+  uint64_t a = 0;
+  uint64_t b = 0;
+  if (size <= 16) {
+    if (size >= 4) {
+      a = (r4(p) << 32) | r4(p + ((size >> 3) << 2));
+      b = (r4(p + size - 4) << 32) | r4(p + size - 4 - ((size >> 3) << 2));
+    } else if (size > 0) {
+      // One to three bytes: first, middle and last byte.
+      a = (uint64_t{p[0]} << 16) | (uint64_t{p[size >> 1]} << 8) | p[size - 1];
+    }
+  } else {
+    auto i = size;
+    if (i > 48) {
+      auto see1 = seed;
+      auto see2 = seed;
+      do {
+        seed = hash_mix(r8(p) ^ hash_secret[1], r8(p + 8) ^ seed);
+        see1 = hash_mix(r8(p + 16) ^ hash_secret[2], r8(p + 24) ^ see1);
+        see2 = hash_mix(r8(p + 32) ^ hash_secret[3], r8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = hash_mix(r8(p) ^ hash_secret[1], r8(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    a = r8(p + i - 16);
+    b = r8(p + i - 8);
+  }
+  a ^= hash_secret[1];
+  b ^= seed;
+  auto lo = mul128(a, b, b);
+  a = lo;
+  return hash_mix(a ^ hash_secret[0] ^ size, b ^ hash_secret[1]);
+}
+
 } // namespace broker::detail
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <utility>
+
+#include "broker/data.hh"
+
+namespace broker::detail {
+
+/// Pairs a `data` key with its hash value, computed once at construction.
+/// Hash-based containers that key on `data` otherwise re-run the recursive
+/// `fast_hash` walk over compound keys on every rehash and, for stored
+/// entries, on every growth of the table. The cached digest also lets
+/// equality checks bail out early on mismatching hashes.
+class hashed_key {
+public:
+  explicit hashed_key(data value)
+    : value_(std::move(value)), hash_(fast_hash(value_)) {
+    // nop
+  }
+
+  hashed_key() : hash_(fast_hash(data{})) {
+    // nop
+  }
+
+  hashed_key(hashed_key&&) = default;
+  hashed_key(const hashed_key&) = default;
+  hashed_key& operator=(hashed_key&&) = default;
+  hashed_key& operator=(const hashed_key&) = default;
+
+  /// Returns the wrapped key.
+  const data& value() const noexcept {
+    return value_;
+  }
+
+  /// Returns the cached hash digest of the wrapped key.
+  size_t hash() const noexcept {
+    return hash_;
+  }
+
+  friend bool operator==(const hashed_key& x, const hashed_key& y) {
+    return x.hash_ == y.hash_ && x.value_ == y.value_;
+  }
+
+  friend bool operator!=(const hashed_key& x, const hashed_key& y) {
+    return !(x == y);
+  }
+
+private:
+  data value_;
+  size_t hash_;
+};
+
+} // namespace broker::detail
+
+namespace std {
+
+template <>
+struct hash<broker::detail::hashed_key> {
+  size_t operator()(const broker::detail::hashed_key& x) const noexcept {
+    return x.hash();
+  }
+};
+
+} // namespace std
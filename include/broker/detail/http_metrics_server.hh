@@ -0,0 +1,95 @@
+#pragma once
+
+#include "broker/config.hh"
+
+#ifndef BROKER_WINDOWS
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "broker/detail/native_socket.hh"
+#include "broker/expected.hh"
+#include "broker/fwd.hh"
+
+namespace broker::detail {
+
+/// A minimal HTTP/1.1 server for Prometheus scrapes, running on a single
+/// dedicated thread outside the CAF scheduler. Connections are persistent:
+/// the server honors keep-alive, answers pipelined requests in order and
+/// serves every `GET /metrics` from a cached exposition buffer that the
+/// metrics exporter swaps in via `update`. Several Prometheus replicas
+/// scraping at short intervals thus hold one long-lived connection each
+/// instead of paying a TCP handshake per scrape.
+class http_metrics_server {
+public:
+  http_metrics_server() = default;
+
+  http_metrics_server(const http_metrics_server&) = delete;
+
+  http_metrics_server& operator=(const http_metrics_server&) = delete;
+
+  /// Calls `stop`.
+  ~http_metrics_server();
+
+  /// Binds all interfaces on `port` (0 picks an ephemeral port) and starts
+  /// the serving thread. Returns the bound port.
+  expected<uint16_t> start(uint16_t port);
+
+  /// Wakes up and joins the serving thread and closes all sockets.
+  /// Idempotent.
+  void stop();
+
+  /// Replaces the exposition text served to scrapers. Thread-safe; the
+  /// server keeps delivering the previous buffer until the swap completes.
+  void update(std::string exposition);
+
+  /// Returns the port the server listens on.
+  uint16_t port() const noexcept {
+    return port_;
+  }
+
+private:
+  /// State of one client connection, owned by the serving thread.
+  struct connection {
+    native_socket fd;
+
+    /// Buffered request bytes; may hold several pipelined requests.
+    std::string in;
+
+    /// Buffered response bytes not yet written to the socket.
+    std::string out;
+
+    /// Set when the connection should close once `out` drained.
+    bool closing = false;
+  };
+
+  /// Body of the serving thread.
+  void run();
+
+  /// Consumes all complete requests buffered in `conn.in` and appends the
+  /// responses to `conn.out` in order.
+  void handle_requests(connection& conn);
+
+  native_socket listen_fd_ = invalid_native_socket;
+
+  /// Self-pipe for waking up the serving thread in `stop`.
+  native_socket wakeup_read_ = invalid_native_socket;
+  native_socket wakeup_write_ = invalid_native_socket;
+
+  uint16_t port_ = 0;
+
+  std::thread thread_;
+
+  /// Guards `exposition_`.
+  mutable std::mutex mtx_;
+
+  /// Cached exposition text; see `update`.
+  std::string exposition_;
+};
+
+} // namespace broker::detail
+
+#endif // BROKER_WINDOWS
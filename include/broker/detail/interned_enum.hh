@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "broker/enum_value.hh"
+
+namespace broker::detail {
+
+/// An entry in the process-wide enum name intern pool. Entries are never
+/// deallocated, so pointers to them remain valid for the lifetime of the
+/// process.
+struct interned_enum_entry {
+  /// Small integer ID, assigned in interning order. Suitable as an index
+  /// into per-name caches.
+  uint32_t id;
+
+  /// The full enum value name.
+  std::string name;
+};
+
+/// A pointer-sized handle to an interned enum value name. Event streams
+/// carry the same handful of enum names over and over, so hot producers and
+/// consumers can trade one hash lookup at interning time for integer
+/// comparison, integer hashing, and a single shared string per distinct name
+/// afterwards. The public @ref enum_value class and its wire format remain
+/// string-based; interning is a local optimization, and the codec in
+/// broker/detail/data_codec.hh accepts handles directly on the field level.
+class interned_enum {
+public:
+  interned_enum() noexcept : entry_(nullptr) {
+    // nop
+  }
+
+  interned_enum(const interned_enum&) noexcept = default;
+
+  interned_enum& operator=(const interned_enum&) noexcept = default;
+
+  /// Returns the handle for `name`, interning it on first use. Thread-safe.
+  static interned_enum intern(std::string_view name);
+
+  /// @copydoc intern
+  static interned_enum intern(const enum_value& x) {
+    return intern(std::string_view{x.name});
+  }
+
+  /// Returns whether this handle refers to an interned name.
+  [[nodiscard]] bool valid() const noexcept {
+    return entry_ != nullptr;
+  }
+
+  /// Returns the small integer ID of the name.
+  /// @pre `valid()`
+  uint32_t id() const noexcept {
+    return entry_->id;
+  }
+
+  /// Returns the interned name.
+  /// @pre `valid()`
+  const std::string& name() const noexcept {
+    return entry_->name;
+  }
+
+  /// Materializes an @ref enum_value holding a copy of the name. Only needed
+  /// when handing the value to string-based APIs; comparisons and field-level
+  /// encoding work on the handle itself.
+  enum_value to_enum_value() const {
+    return valid() ? enum_value{entry_->name} : enum_value{};
+  }
+
+  friend bool operator==(interned_enum x, interned_enum y) noexcept {
+    return x.entry_ == y.entry_;
+  }
+
+  friend bool operator!=(interned_enum x, interned_enum y) noexcept {
+    return x.entry_ != y.entry_;
+  }
+
+  friend bool operator<(interned_enum x, interned_enum y) noexcept {
+    return x.entry_ < y.entry_;
+  }
+
+private:
+  explicit interned_enum(const interned_enum_entry* entry) noexcept
+    : entry_(entry) {
+    // nop
+  }
+
+  const interned_enum_entry* entry_;
+};
+
+/// Returns the number of enum names interned so far. Mainly useful for
+/// sizing ID-indexed caches.
+size_t interned_enum_count();
+
+} // namespace broker::detail
+
+namespace std {
+
+template <>
+struct hash<broker::detail::interned_enum> {
+  size_t operator()(broker::detail::interned_enum x) const noexcept {
+    return x.valid() ? x.id() : 0;
+  }
+};
+
+} // namespace std
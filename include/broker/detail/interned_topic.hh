@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace broker::detail {
+
+/// An entry in the process-wide topic intern pool. Entries are never
+/// deallocated, so pointers to them remain valid for the lifetime of the
+/// process.
+struct interned_topic_entry {
+  /// Small integer ID, assigned in interning order. Suitable as an index
+  /// into per-topic caches.
+  uint32_t id;
+
+  /// The full topic string.
+  std::string str;
+};
+
+/// A pointer-sized handle to an interned topic string. Endpoints publish on a
+/// small, mostly static set of topics, so the dispatch path can trade one
+/// hash lookup at interning time for integer comparison, integer hashing, and
+/// ID-indexed caching afterwards. The wire format and the public `topic`
+/// class remain string-based; interning is a local optimization.
+class interned_topic {
+public:
+  interned_topic() noexcept : entry_(nullptr) {
+    // nop
+  }
+
+  interned_topic(const interned_topic&) noexcept = default;
+
+  interned_topic& operator=(const interned_topic&) noexcept = default;
+
+  /// Returns the handle for `str`, interning it on first use. Thread-safe.
+  static interned_topic intern(std::string_view str);
+
+  /// Returns whether this handle refers to an interned string.
+  [[nodiscard]] bool valid() const noexcept {
+    return entry_ != nullptr;
+  }
+
+  /// Returns the small integer ID of the topic.
+  /// @pre `valid()`
+  uint32_t id() const noexcept {
+    return entry_->id;
+  }
+
+  /// Returns the interned topic string.
+  /// @pre `valid()`
+  const std::string& string() const noexcept {
+    return entry_->str;
+  }
+
+  friend bool operator==(interned_topic x, interned_topic y) noexcept {
+    return x.entry_ == y.entry_;
+  }
+
+  friend bool operator!=(interned_topic x, interned_topic y) noexcept {
+    return x.entry_ != y.entry_;
+  }
+
+  friend bool operator<(interned_topic x, interned_topic y) noexcept {
+    return x.entry_ < y.entry_;
+  }
+
+private:
+  explicit interned_topic(const interned_topic_entry* entry) noexcept
+    : entry_(entry) {
+    // nop
+  }
+
+  const interned_topic_entry* entry_;
+};
+
+/// Returns the number of topics interned so far. Mainly useful for sizing
+/// ID-indexed caches.
+size_t interned_topic_count();
+
+} // namespace broker::detail
+
+namespace std {
+
+template <>
+struct hash<broker::detail::interned_topic> {
+  size_t operator()(broker::detail::interned_topic x) const noexcept {
+    return x.valid() ? x.id() : 0;
+  }
+};
+
+} // namespace std
@@ -15,4 +15,15 @@ enum class item_scope : uint8_t {
 /// @relates item_scope
 std::string to_string(item_scope);
 
+/// Denotes the delivery priority of an @ref item. Store commands and other
+/// control traffic travel on the high-priority lane and overtake staged bulk
+/// data.
+enum class item_priority : uint8_t {
+  high,   /// Marks an item as control traffic that flushes first.
+  normal, /// Marks an item as bulk data traffic.
+};
+
+/// @relates item_priority
+std::string to_string(item_priority);
+
 } // namespace broker::detail
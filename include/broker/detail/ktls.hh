@@ -0,0 +1,63 @@
+#pragma once
+
+#include "broker/config.hh"
+
+#ifdef BROKER_HAVE_KTLS
+
+#include <array>
+#include <cstdint>
+
+#include "broker/detail/native_socket.hh"
+#include "broker/expected.hh"
+#include "broker/fwd.hh"
+
+namespace broker::detail {
+
+/// Kernel TLS (kTLS) offload for the native peering transport. After a
+/// userspace TLS handshake derived the session keys, handing the crypto
+/// state to the kernel lets all subsequent traffic travel through plain
+/// `send`/`writev` paths: record framing and AES run in the kernel, or on
+/// the NIC where the driver supports crypto offload, cutting out the
+/// userspace encryption pass entirely.
+
+/// TLS 1.2 on-the-wire version code.
+constexpr uint16_t ktls_tls12 = 0x0303;
+
+/// TLS 1.3 on-the-wire version code.
+constexpr uint16_t ktls_tls13 = 0x0304;
+
+/// Key material of one traffic direction for AES-128-GCM, the cipher with
+/// the broadest kTLS support across kernel versions.
+struct ktls_session {
+  /// Negotiated protocol version, `ktls_tls12` or `ktls_tls13`.
+  uint16_t tls_version;
+
+  /// AES key.
+  std::array<uint8_t, 16> key;
+
+  /// Implicit nonce part (TLS 1.2) or first IV bytes (TLS 1.3).
+  std::array<uint8_t, 4> salt;
+
+  /// Explicit nonce part.
+  std::array<uint8_t, 8> iv;
+
+  /// Current record sequence number.
+  std::array<uint8_t, 8> rec_seq;
+};
+
+/// Probes whether the running kernel offers the TLS upper-layer protocol.
+/// The probe attaches the "tls" ULP to a throwaway socket: a kernel without
+/// the TLS module rejects the name outright, one with the module rejects
+/// only the unconnected state.
+bool ktls_available() noexcept;
+
+/// Switches the established TCP connection `fd` to kernel TLS with separate
+/// key material for the transmit and receive directions. On success, all
+/// reads and writes on `fd` transparently cross the record layer in the
+/// kernel; the userspace TLS object must not touch the socket afterwards.
+expected<void> enable_ktls(native_socket fd, const ktls_session& tx,
+                           const ktls_session& rx);
+
+} // namespace broker::detail
+
+#endif // BROKER_HAVE_KTLS
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "broker/data.hh"
+#include "broker/fwd.hh"
+#include "broker/message.hh"
+#include "broker/telemetry/gauge.hh"
+#include "broker/topic.hh"
+
+namespace broker::detail {
+
+/// Identifies a component in the per-endpoint memory accounting.
+enum class memory_region : uint8_t {
+  /// Items buffered in subscriber and publisher queues.
+  queues,
+  /// Messages staged in the central dispatcher.
+  dispatcher,
+};
+
+/// Number of `memory_region` enumerators.
+constexpr size_t num_memory_regions = 2;
+
+/// @relates memory_region
+constexpr std::string_view memory_region_name(memory_region x) {
+  return x == memory_region::queues ? "queues" : "dispatcher";
+}
+
+/// Returns a cheap estimate of the memory footprint of `x`. Counts the
+/// object itself plus its top-level payload, i.e., nested containers
+/// contribute their element slots but not the heap allocations of their
+/// elements. The estimate stays O(1) per value so accounting never becomes a
+/// hot-path cost itself.
+size_t estimated_memory_use(const data& x) noexcept;
+
+/// @copydoc estimated_memory_use
+inline size_t estimated_memory_use(const topic& x) noexcept {
+  return x.string().size();
+}
+
+/// @copydoc estimated_memory_use
+inline size_t estimated_memory_use(const data_message& x) noexcept {
+  return sizeof(data_message) + estimated_memory_use(get_topic(x))
+         + estimated_memory_use(get_data(x));
+}
+
+/// @copydoc estimated_memory_use
+template <class T>
+size_t estimated_memory_use(const T&) noexcept {
+  return sizeof(T);
+}
+
+/// Tracks the estimated memory use of an endpoint per component and
+/// optionally enforces a byte budget. Components report their buffered bytes
+/// through `add` and `sub`; once the total exceeds the budget, producers
+/// consult `over_budget` and shed low-priority items until consumers catch
+/// up. All numbers are estimates based on `estimated_memory_use`, not
+/// allocator-level truth.
+class memory_accountant {
+public:
+  /// Accounts `bytes` additional buffered bytes for `region`.
+  void add(memory_region region, size_t bytes) noexcept {
+    auto index = static_cast<size_t>(region);
+    usage_[index].fetch_add(static_cast<int64_t>(bytes),
+                            std::memory_order_relaxed);
+    if (gauges_[index])
+      gauges_[index]->inc(static_cast<int64_t>(bytes));
+  }
+
+  /// Releases `bytes` previously accounted for `region`.
+  void sub(memory_region region, size_t bytes) noexcept {
+    auto index = static_cast<size_t>(region);
+    usage_[index].fetch_sub(static_cast<int64_t>(bytes),
+                            std::memory_order_relaxed);
+    if (gauges_[index])
+      gauges_[index]->dec(static_cast<int64_t>(bytes));
+  }
+
+  /// Returns the estimated buffered bytes of `region`.
+  int64_t usage(memory_region region) const noexcept {
+    return usage_[static_cast<size_t>(region)].load(std::memory_order_relaxed);
+  }
+
+  /// Returns the estimated buffered bytes across all regions.
+  int64_t total_usage() const noexcept {
+    int64_t result = 0;
+    for (const auto& x : usage_)
+      result += x.load(std::memory_order_relaxed);
+    return result;
+  }
+
+  /// Sets the byte budget; 0 disables enforcement.
+  void budget(size_t bytes) noexcept {
+    budget_.store(bytes, std::memory_order_relaxed);
+  }
+
+  /// Returns the configured byte budget.
+  size_t budget() const noexcept {
+    return budget_.load(std::memory_order_relaxed);
+  }
+
+  /// Returns whether the tracked usage currently exceeds the budget.
+  bool over_budget() const noexcept {
+    auto limit = budget_.load(std::memory_order_relaxed);
+    return limit != 0 && total_usage() > static_cast<int64_t>(limit);
+  }
+
+  /// Attaches a telemetry gauge that mirrors the usage of `region`. Like
+  /// `shared_queue::attach_stats`, this may only be called before other
+  /// threads use the accountant.
+  void attach_gauge(memory_region region, telemetry::gauge<int64_t> g) {
+    gauges_[static_cast<size_t>(region)] = g;
+  }
+
+private:
+  std::array<std::atomic<int64_t>, num_memory_regions> usage_ = {};
+
+  /// Byte budget for the sum over all regions; 0 disables enforcement.
+  std::atomic<size_t> budget_ = 0;
+
+  /// Optional telemetry mirrors, one per region.
+  std::array<std::optional<telemetry::gauge<int64_t>>, num_memory_regions>
+    gauges_;
+};
+
+using memory_accountant_ptr = std::shared_ptr<memory_accountant>;
+
+/// Creates an accountant for `ep` with one "broker.memory-usage" gauge per
+/// region in its telemetry registry and `budget` as byte budget (0 disables
+/// enforcement).
+memory_accountant_ptr make_memory_accountant(endpoint& ep, size_t budget);
+
+} // namespace broker::detail
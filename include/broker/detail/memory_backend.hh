@@ -1,10 +1,13 @@
 #pragma once
 
-#include <unordered_map>
+#include <set>
+#include <vector>
 
 #include "broker/backend_options.hh"
 
 #include "broker/detail/abstract_backend.hh"
+#include "broker/detail/flat_hash_map.hh"
+#include "broker/detail/hashed_key.hh"
 
 namespace broker {
 namespace detail {
@@ -25,10 +28,15 @@ public:
   expected<void> subtract(const data& key, const data& value,
                           std::optional<timestamp> expiry) override;
 
+  expected<void>
+  bulk_insert(std::vector<std::pair<data, data>> entries) override;
+
   expected<void> erase(const data& key) override;
 
   expected<void> clear() override;
 
+  expected<void> compact() override;
+
   expected<bool> expire(const data& key, timestamp current_time) override;
 
   expected<data> get(const data& key) const override;
@@ -41,14 +49,47 @@ public:
 
   expected<data> keys() const override;
 
+  expected<data> keys_in_range(const data& from, const data& to,
+                               uint64_t limit) const override;
+
   expected<broker::snapshot> snapshot() const override;
 
+  expected<uint64_t> snapshot_fork() override;
+
+  expected<broker::snapshot> snapshot_chunk(uint64_t num_entries) override;
+
+  void snapshot_release() override;
+
   expected<expirables> expiries() const override;
 
+  expected<data> stats() const override;
+
 private:
+  /// Preserves the fork-time value of `key` before a mutation, if a fork is
+  /// active and the value has not been preserved yet.
+  void preserve(const hashed_key& key);
+
+  /// Records `expiry` for `key` in the expiry heap, if set.
+  void index_expiry(const data& key, const std::optional<timestamp>& expiry);
+
+  /// Drops heap entries that no longer match the expiry stored in `store_`
+  /// and restores the heap property over the survivors.
+  void compact_expiry_heap();
+
   backend_options options_;
-  std::unordered_map<data, std::pair<data, std::optional<timestamp>>> store_;
-  std::unordered_map<data, timestamp> expirations_;
+  flat_hash_map<hashed_key, std::pair<data, std::optional<timestamp>>> store_;
+  /// Ordered index over the keys in `store_` for range scans.
+  std::set<data> ordered_keys_;
+  /// Binary min-heap of (key, expiry time) pairs, ordered by expiry time.
+  /// Updates push in O(log n) and never remove eagerly; stale entries get
+  /// skipped on read and cleaned out in batches once they outnumber the
+  /// store, so `expiries()` scales with the number of expiring entries
+  /// instead of the full store size.
+  std::vector<expirable> expiry_heap_;
+  bool fork_active_ = false;
+  std::vector<hashed_key> fork_keys_;
+  size_t fork_pos_ = 0;
+  flat_hash_map<hashed_key, data> fork_overlay_;
 };
 
 } // namespace detail
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "broker/backend_options.hh"
+
+#include "broker/detail/abstract_backend.hh"
+
+namespace broker {
+namespace detail {
+
+/// A persistent key-value storage backend without a SQL or B-tree layer.
+/// All entries live in an in-memory table, so lookups cost a single hash
+/// probe. Mutations append compact codec records to a log file that the OS
+/// page cache absorbs; restart recovery memory-maps the log and replays it
+/// in one sequential scan, rewriting the file when too many records turned
+/// out to be superseded.
+class mmap_backend : public abstract_backend {
+public:
+  /// Constructs an mmap backend.
+  /// @param opts The options to create/open a database.
+  /// Required parameters:
+  ///   - `path`: a `std::string` representing the location of the log file
+  ///             on the filesystem.
+  mmap_backend(backend_options opts = backend_options{});
+
+  ~mmap_backend();
+
+  /// Returns whether the constructor failed to open or recover the log.
+  bool init_failed() const;
+
+  expected<void> put(const data& key, data value,
+                     std::optional<timestamp> expiry) override;
+
+  expected<void> add(const data& key, const data& value, data::type init_type,
+                     std::optional<timestamp> expiry) override;
+
+  expected<void> subtract(const data& key, const data& value,
+                          std::optional<timestamp> expiry) override;
+
+  expected<void> erase(const data& key) override;
+
+  expected<void> clear() override;
+
+  expected<void> compact() override;
+
+  expected<bool> expire(const data& key, timestamp current_time) override;
+
+  expected<data> get(const data& key) const override;
+
+  expected<bool> exists(const data& key) const override;
+
+  expected<uint64_t> size() const override;
+
+  expected<data> keys() const override;
+
+  expected<broker::snapshot> snapshot() const override;
+
+  expected<expirables> expiries() const override;
+
+private:
+  /// Opens or creates the log file and replays it into `store_`.
+  bool open(const std::string& path);
+
+  /// Replays all records in `[first, first + size)`. Returns the offset
+  /// right after the last intact record, so torn tail writes from a crash
+  /// get truncated away.
+  size_t scan(const void* first, size_t size);
+
+  /// Appends one mutation record to the log.
+  bool append_put(const data& key, const data& value,
+                  const std::optional<timestamp>& expiry);
+
+  /// @copydoc append_put
+  bool append_erase(const data& key);
+
+  /// Rewrites the log so that it holds exactly one record per live entry.
+  bool compact_log();
+
+  backend_options options_;
+  std::string path_;
+  int fd_ = -1;
+  /// Number of records replayed or appended since the last compaction.
+  /// Together with `store_.size()`, measures how much of the log is dead.
+  uint64_t record_count_ = 0;
+  std::unordered_map<data, std::pair<data, std::optional<timestamp>>> store_;
+};
+
+} // namespace detail
+} // namespace broker
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+namespace broker::detail {
+
+/// The huge page size broker assumes when rounding allocation sizes. Matches
+/// the common default on x86-64 and AArch64 systems.
+constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+/// Returns the size of a regular virtual memory page.
+size_t page_size() noexcept;
+
+/// Allocates `num_bytes` of zero-initialized, page-aligned anonymous memory
+/// directly from the OS. When asking for huge pages, the function first tries
+/// explicitly reserved huge pages and falls back to regular pages with a
+/// transparent-huge-page hint. Returns `nullptr` if the OS cannot satisfy the
+/// request (callers are expected to fall back to the global allocator).
+void* allocate_pages(size_t num_bytes, bool huge_pages) noexcept;
+
+/// Releases memory obtained from `allocate_pages`. Passing a `nullptr` is a
+/// no-op. `num_bytes` must match the size passed to `allocate_pages`.
+void deallocate_pages(void* ptr, size_t num_bytes) noexcept;
+
+/// Asks the OS to place the pages covering `[ptr, ptr + num_bytes)` on the
+/// given NUMA node, migrating already-faulted pages if necessary. The binding
+/// is a preference, i.e., the OS falls back to other nodes when the target
+/// node runs out of memory. Returns `false` on platforms without NUMA support
+/// or when the kernel rejects the request.
+bool bind_to_numa_node(void* ptr, size_t num_bytes, int node) noexcept;
+
+} // namespace broker::detail
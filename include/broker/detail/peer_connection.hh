@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "broker/detail/native_socket.hh"
+#include "broker/detail/peer_protocol.hh"
+#include "broker/expected.hh"
+#include "broker/fwd.hh"
+
+namespace broker::detail {
+
+class preset_dictionary_set;
+struct preset_dictionary;
+
+/// A peering link over a connected socket, speaking the native transport
+/// from broker/detail/peer_protocol.hh. The connection owns the socket,
+/// performs the handshake and enforces window-based flow control: the sender
+/// may have at most the peer-granted credit of unacknowledged message frames
+/// in flight, and the receiver grants fresh credit after consuming half of
+/// its advertised window. Keepalive and credit frames are handled inside
+/// `read` and never surface to the caller. When both handshakes share a
+/// compression bit, message payloads above a small threshold travel
+/// deflate-compressed; `read` returns them decompressed, so negotiation
+/// stays invisible above the transport.
+///
+/// The class performs blocking I/O and is meant to be driven by a dedicated
+/// thread per peering, keeping CAF out of the data path entirely.
+class peer_connection {
+public:
+  /// A frame as delivered to the caller of `read`.
+  struct frame {
+    frame_type type;
+    std::vector<std::byte> payload;
+  };
+
+  /// Transfer statistics of one direction, for per-peer telemetry.
+  struct byte_counters {
+    /// Message payload bytes before compression (sent) or after
+    /// decompression (received).
+    uint64_t raw = 0;
+
+    /// Message payload bytes as they appeared on the wire.
+    uint64_t wire = 0;
+  };
+
+  /// Takes ownership of the connected socket `fd`.
+  explicit peer_connection(native_socket fd);
+
+  peer_connection(peer_connection&& other) noexcept;
+
+  peer_connection& operator=(peer_connection&& other) noexcept;
+
+  peer_connection(const peer_connection&) = delete;
+
+  peer_connection& operator=(const peer_connection&) = delete;
+
+  /// Closes the socket unless it was released before.
+  ~peer_connection();
+
+  /// Installs preset dictionaries for message payload compression; see
+  /// broker/detail/preset_dictionary.hh. `write_dict` primes the compressor
+  /// for outgoing payloads once the remote side announced
+  /// `peer_compression_zlib_dict`; `read_dicts` resolves dictionaries for
+  /// incoming payloads and gates whether this side announces the bit. Both
+  /// pointers remain owned by the caller and must outlive the connection.
+  /// Must be called before the handshake.
+  void use_preset_dictionaries(const preset_dictionary* write_dict,
+                               const preset_dictionary_set* read_dicts)
+    noexcept {
+    write_dict_ = write_dict;
+    read_dicts_ = read_dicts;
+  }
+
+  /// Runs the originator side of the handshake: sends `local`, then awaits
+  /// and validates the acknowledgment.
+  /// @returns the handshake of the remote endpoint.
+  expected<handshake_info> originate_handshake(const handshake_info& local);
+
+  /// Runs the responder side of the handshake: awaits the originator's
+  /// handshake, then acknowledges with `local`.
+  /// @returns the handshake of the remote endpoint.
+  expected<handshake_info> respond_handshake(const handshake_info& local);
+
+  /// Sends one frame, blocking until the peer granted credit if the send
+  /// window is exhausted. Only `data_msg`, `command_msg` and `data_batch`
+  /// frames consume credit. Frames read while waiting for credit queue up
+  /// for `read`.
+  expected<void> send(frame_type type, const std::byte* payload, size_t size);
+
+  /// @copydoc send
+  expected<void> send(frame_type type, const std::vector<std::byte>& payload) {
+    return send(type, payload.data(), payload.size());
+  }
+
+  /// Blocks until the next frame arrives and returns it. Credit, ping and
+  /// pong frames are consumed internally; `bye` returns `ec::end_of_file`.
+  expected<frame> read();
+
+  /// Returns the number of message frames currently sendable without
+  /// blocking on credit.
+  uint32_t send_credit() const noexcept {
+    return send_credit_;
+  }
+
+  /// Returns whether the handshake negotiated payload compression.
+  bool compression_enabled() const noexcept {
+    return compress_;
+  }
+
+  /// Returns whether outgoing payloads deflate against a preset dictionary.
+  bool dictionary_compression_enabled() const noexcept {
+    return dict_send_;
+  }
+
+  /// Returns the transfer statistics for sent message payloads.
+  const byte_counters& sent() const noexcept {
+    return sent_;
+  }
+
+  /// Returns the transfer statistics for received message payloads.
+  const byte_counters& received() const noexcept {
+    return received_;
+  }
+
+  /// Returns the socket and gives up ownership.
+  native_socket release() noexcept;
+
+  /// Returns whether the connection still owns an open socket.
+  bool valid() const noexcept {
+    return fd_ != invalid_native_socket;
+  }
+
+private:
+  /// Writes one frame to the socket without touching the credit window.
+  expected<void> write_frame(frame_type type, const std::byte* payload,
+                             size_t size);
+
+  /// Reads exactly `size` bytes from the socket.
+  expected<void> read_exactly(std::byte* buf, size_t size);
+
+  /// Reads one frame, answering pings and applying credit grants. Credit
+  /// frames surface in `result` so a blocked `send` regains control; ping
+  /// and pong frames never do.
+  expected<void> read_frame(frame& result);
+
+  /// Grants the peer fresh credit when half of the local window drained.
+  expected<void> replenish_credit();
+
+  /// Masks out compression bits this build cannot serve and records the
+  /// negotiation result once the remote handshake is known.
+  void negotiate_compression(uint8_t local_bits, uint8_t remote_bits);
+
+  native_socket fd_;
+
+  /// Remaining message frames we may send before blocking.
+  uint32_t send_credit_ = 0;
+
+  /// Window size we advertised in the handshake.
+  uint32_t recv_window_ = 0;
+
+  /// Message frames consumed since the last credit grant.
+  uint32_t consumed_ = 0;
+
+  /// Whether the handshake negotiated deflate compression.
+  bool compress_ = false;
+
+  /// Preset dictionary for outgoing payloads, if any.
+  const preset_dictionary* write_dict_ = nullptr;
+
+  /// Preset dictionaries for resolving incoming payloads, if any.
+  const preset_dictionary_set* read_dicts_ = nullptr;
+
+  /// Whether outgoing payloads deflate against `write_dict_`.
+  bool dict_send_ = false;
+
+  /// Whether incoming compressed payloads may reference a preset dictionary.
+  bool dict_recv_ = false;
+
+  /// Transfer statistics for sent and received message payloads.
+  byte_counters sent_;
+  byte_counters received_;
+
+  /// Frames that arrived while `send` was blocked on credit.
+  std::vector<frame> backlog_;
+
+  /// Scratch buffer for frame assembly.
+  std::vector<std::byte> write_buf_;
+};
+
+} // namespace broker::detail
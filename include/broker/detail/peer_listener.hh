@@ -0,0 +1,113 @@
+#pragma once
+
+#include "broker/config.hh"
+
+#ifndef BROKER_WINDOWS
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "broker/detail/handshake_gate.hh"
+#include "broker/detail/native_socket.hh"
+#include "broker/expected.hh"
+#include "broker/fwd.hh"
+
+namespace broker::detail {
+
+/// The accepting side of the native peering transport. The listener binds
+/// `num_listeners` sockets to the same address and port via `SO_REUSEPORT`,
+/// so the kernel spreads incoming connections across them, and runs one
+/// accept thread per socket. Each accepted connection surfaces through the
+/// callback passed to `start`, which typically wraps the socket into a
+/// @ref peer_connection and runs the responder handshake; because every
+/// listener accepts independently, a reconnection storm proceeds on all
+/// accept threads concurrently instead of serializing on a single acceptor.
+///
+/// On systems without `SO_REUSEPORT`, the listener degrades to a single
+/// socket and accept thread.
+class peer_listener {
+public:
+  /// Called from an accept thread for each accepted connection. The callback
+  /// owns the socket and must not block the accept loop for long; expensive
+  /// handshake work belongs on a per-connection thread.
+  using accept_callback = std::function<void(native_socket)>;
+
+  /// Creates a listener with `num_listeners` sockets bound to `address` and
+  /// `port`. An empty `address` binds all interfaces, port 0 picks an
+  /// ephemeral port shared by all sockets. The listener accepts nothing
+  /// until `start` runs.
+  static expected<peer_listener> make(const std::string& address,
+                                      uint16_t port, size_t num_listeners);
+
+  peer_listener(peer_listener&& other) noexcept;
+
+  peer_listener& operator=(peer_listener&& other) noexcept;
+
+  peer_listener(const peer_listener&) = delete;
+
+  peer_listener& operator=(const peer_listener&) = delete;
+
+  /// Calls `stop`.
+  ~peer_listener();
+
+  /// Installs admission control for accepted connections. Connections denied
+  /// by the gate close immediately after `accept`, before any handshake work,
+  /// so the remote side fails fast and backs off. The accept callback must
+  /// call `gate->done()` once its handshake completes or fails; the gate must
+  /// outlive the listener.
+  /// @pre `start` was not called yet.
+  void admission(handshake_gate* gate) noexcept {
+    gate_ = gate;
+  }
+
+  /// Spawns one accept thread per listening socket.
+  /// @pre `start` was not called yet.
+  void start(accept_callback f);
+
+  /// Wakes up and joins all accept threads and closes the listening sockets.
+  /// Idempotent.
+  void stop();
+
+  /// Returns the port all listening sockets are bound to.
+  uint16_t port() const noexcept {
+    return port_;
+  }
+
+  /// Returns the number of listening sockets.
+  size_t num_listeners() const noexcept {
+    return fds_.size();
+  }
+
+private:
+  peer_listener() = default;
+
+  /// Accept loop body of the thread owning `fd`.
+  void accept_loop(native_socket fd);
+
+  /// Listening sockets, all bound to the same port.
+  std::vector<native_socket> fds_;
+
+  /// One accept thread per entry in `fds_`.
+  std::vector<std::thread> threads_;
+
+  /// Callback for accepted connections.
+  accept_callback on_accept_;
+
+  /// Optional admission control; see `admission`. Not owned.
+  handshake_gate* gate_ = nullptr;
+
+  /// Self-pipe for waking up accept threads in `stop`; the write end signals,
+  /// all threads poll the read end.
+  native_socket wakeup_read_ = invalid_native_socket;
+  native_socket wakeup_write_ = invalid_native_socket;
+
+  /// Bound port, resolved after binding the first socket.
+  uint16_t port_ = 0;
+};
+
+} // namespace broker::detail
+
+#endif // BROKER_WINDOWS
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "broker/expected.hh"
+#include "broker/filter_type.hh"
+#include "broker/fwd.hh"
+
+namespace broker::detail {
+
+/// Wire format of the native peering transport: a length-prefixed binary
+/// protocol spoken directly over a socket, without CAF streams in between.
+/// Every frame starts with a fixed five-byte header (payload size in network
+/// byte order plus a type tag), followed by the payload. Connections open
+/// with a handshake exchange that pins magic, protocol version, endpoint
+/// identity, subscriptions and the initial flow-control window. Payloads of
+/// message frames use the codec from broker/detail/data_codec.hh.
+
+/// Identifies Broker native-transport connections on the wire ("BRKR").
+constexpr uint32_t peer_protocol_magic = 0x42524b52;
+
+/// Version of the framing and handshake layout. Both sides must match.
+constexpr uint8_t peer_protocol_version = 1;
+
+/// Compression algorithm bit for zlib/deflate in `handshake_info`.
+constexpr uint8_t peer_compression_zlib = 0x01;
+
+/// Compression algorithm bit for deflate with a preset dictionary; see
+/// broker/detail/preset_dictionary.hh. Announcing the bit promises that the
+/// receive path resolves preset dictionaries by checksum, so a sender may
+/// only deflate against a dictionary after the remote side announced it.
+constexpr uint8_t peer_compression_zlib_dict = 0x02;
+
+/// Feature bit in `handshake_info`: the sender accepts best-effort traffic
+/// over a UDP datagram lane. The lane only opens when both sides announce
+/// the bit and a nonzero datagram port.
+constexpr uint8_t peer_feature_datagram = 0x01;
+
+/// Feature bit in `handshake_info`: the sender accepts dictionary-compressed
+/// message payloads (see broker/detail/string_dictionary.hh). When both
+/// sides announce the bit, each direction runs its own pair of streaming
+/// dictionaries, seeded empty at handshake completion.
+constexpr uint8_t peer_feature_dictionary = 0x02;
+
+/// Number of bytes of an encoded frame header.
+constexpr size_t frame_header_size = 5;
+
+/// Discriminates the payload of a frame.
+enum class frame_type : uint8_t {
+  /// Opens a connection; payload is an encoded @ref handshake_info.
+  handshake,
+  /// Confirms a handshake; payload is the responder's @ref handshake_info.
+  handshake_ack,
+  /// A published (topic, data) pair.
+  data_msg,
+  /// A store command.
+  command_msg,
+  /// A `data_msg` with deflate-compressed payload, prefixed by the varint
+  /// uncompressed size. Only valid after negotiating compression.
+  data_msg_z,
+  /// A `command_msg` with deflate-compressed payload; see `data_msg_z`.
+  command_msg_z,
+  /// Replaces the sender's subscription filter.
+  filter_update,
+  /// Grants the receiver additional sending credit (varint payload).
+  credit,
+  /// Keepalive probe; the receiver answers with `pong`.
+  ping,
+  /// Keepalive answer.
+  pong,
+  /// Orderly connection shutdown.
+  bye,
+  /// A homogeneous run of data messages: the shared topic travels once,
+  /// followed by a varint count and the values in codec format. Consumes
+  /// one credit like `data_msg`.
+  data_batch,
+  /// A `data_batch` with deflate-compressed payload; see `data_msg_z`.
+  data_batch_z,
+};
+
+/// @relates frame_type
+const char* to_string(frame_type x);
+
+/// Fixed-size prelude of every frame.
+struct frame_header {
+  /// Number of payload bytes following the header.
+  uint32_t payload_size;
+
+  /// Type of the payload.
+  frame_type type;
+};
+
+/// Appends the five-byte wire form of `hdr` to `buf`.
+/// @relates frame_header
+void encode(const frame_header& hdr, std::vector<std::byte>& buf);
+
+/// Decodes a header from `frame_header_size` bytes at `bytes`. Returns
+/// `ec::invalid_tag` for unknown frame types.
+/// @relates frame_header
+expected<frame_header> decode_frame_header(const std::byte* bytes);
+
+/// Contents of the handshake exchanged when opening a connection.
+struct handshake_info {
+  /// Stringified endpoint ID of the sender.
+  std::string id;
+
+  /// Topics the sender subscribes to.
+  filter_type filter;
+
+  /// Number of message frames the receiver may send before waiting for
+  /// additional credit.
+  uint32_t initial_credit;
+
+  /// Bitmask of compression algorithms the sender accepts; a connection
+  /// compresses only when both sides share a bit.
+  uint8_t compression = 0;
+
+  /// Bitmask of optional transport features the sender supports; a feature
+  /// activates only when both sides share a bit.
+  uint8_t features = 0;
+
+  /// UDP port where the sender receives best-effort datagrams; 0 when the
+  /// sender offers no datagram lane. Only meaningful with
+  /// `peer_feature_datagram` set.
+  uint16_t datagram_port = 0;
+};
+
+/// Appends the encoded payload of a handshake frame to `buf`.
+/// @relates handshake_info
+void encode(const handshake_info& hs, std::vector<std::byte>& buf);
+
+/// Decodes a handshake payload. Returns `ec::peer_incompatible` on magic or
+/// version mismatch and `ec::invalid_data` for malformed input.
+/// @relates handshake_info
+expected<handshake_info> decode_handshake(const std::byte* first, size_t size);
+
+/// Returns the length of the longest prefix of `[msgs, msgs + num)` in which
+/// every message shares the topic of the first one. Senders use this to peel
+/// homogeneous runs off a mixed buffer automatically and ship each run as a
+/// single `data_batch` frame.
+size_t homogeneous_run(const data_message* msgs, size_t num);
+
+/// Appends the payload of a `data_batch` frame to `buf`: the shared topic
+/// once, then a varint count and each value in codec format. All messages
+/// must carry the same topic; see `homogeneous_run`.
+void encode_data_batch(const data_message* msgs, size_t num,
+                       std::vector<std::byte>& buf);
+
+/// Decodes the payload of a `data_batch` frame back into individual data
+/// messages, all sharing the decoded topic. Returns `ec::invalid_data` for
+/// truncated or malformed input.
+expected<std::vector<data_message>> decode_data_batch(const std::byte* first,
+                                                      size_t size);
+
+/// Extracts a view of the length-prefixed topic bytes at the head of a
+/// `data_msg` or `data_batch` payload without constructing a `topic` or
+/// decoding any value bytes. Together with the raw-bytes overload of
+/// `prefix_matcher`, relays can filter and drop non-matching messages
+/// straight from the receive buffer. Returns `false` for truncated input,
+/// leaving `out` untouched.
+bool peek_topic(const std::byte* first, size_t size, std::string_view& out);
+
+} // namespace broker::detail
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "broker/peer_info.hh"
+
+namespace broker::detail {
+
+/// Publishes an immutable snapshot of the peer table. The core actor swaps
+/// in a new snapshot whenever a peering changes state; any thread may grab
+/// the current snapshot without locks or messaging the core. Readers that
+/// hold on to a snapshot simply keep the old version alive while the writer
+/// moves on (RCU-style), so polling the peer table never competes with
+/// message dispatch.
+class peer_status_table {
+public:
+  using snapshot_type = std::shared_ptr<const std::vector<peer_info>>;
+
+  peer_status_table()
+    : snapshot_(std::make_shared<const std::vector<peer_info>>()) {
+    // nop
+  }
+
+  /// Replaces the published snapshot. Only the owning core actor calls this.
+  void publish(std::vector<peer_info> peers) {
+    auto ptr = std::make_shared<const std::vector<peer_info>>(std::move(peers));
+    std::atomic_store_explicit(&snapshot_, std::move(ptr),
+                               std::memory_order_release);
+  }
+
+  /// Returns the most recently published snapshot. Never returns `nullptr`.
+  snapshot_type snapshot() const noexcept {
+    return std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
+  }
+
+private:
+  snapshot_type snapshot_;
+};
+
+using peer_status_table_ptr = std::shared_ptr<peer_status_table>;
+
+} // namespace broker::detail
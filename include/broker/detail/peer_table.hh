@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "broker/detail/hash.hh"
+#include "broker/endpoint_id.hh"
+
+namespace broker::detail {
+
+/// Maps peer endpoint IDs to per-peer state. The table is tuned for the
+/// peer-tracking access pattern: membership changes only on connect and
+/// disconnect, while lookups run on the per-message fast path. Entries live
+/// in a single flat array whose slots stay put for the lifetime of their
+/// entry, so the slot number doubles as a stable integer peer index that
+/// bitmap-based caches can use directly. With at most `small_size` peers,
+/// lookups scan the array linearly - cheaper than any hashing for the
+/// typical handful of peerings. Beyond that, an open-addressing index over
+/// cached digests resolves lookups with one probe in the common case; the
+/// index rebuilds wholesale on erase, trading rare disconnect work for a
+/// tombstone-free probe sequence.
+template <class T>
+class peer_table {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using mapped_type = T;
+
+  // -- constants --------------------------------------------------------------
+
+  /// Largest number of entries resolved by linear scan instead of hashing.
+  static constexpr size_t small_size = 8;
+
+  /// Return value of `index_of` for keys not in the table.
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Returns the state for `key`, default-constructing it if necessary.
+  /// Invalidates no slot indexes.
+  T& operator[](const endpoint_id& key) {
+    return entries_[insert_slot(key)].value;
+  }
+
+  /// Removes the state for `key` and releases its slot for reuse by a future
+  /// insertion. Returns whether an entry was removed. Slot indexes of other
+  /// entries remain valid.
+  bool erase(const endpoint_id& key) {
+    auto slot = index_of(key);
+    if (slot == npos)
+      return false;
+    entries_[slot].key = endpoint_id{};
+    entries_[slot].value = T{};
+    entries_[slot].live = false;
+    free_slots_.push_back(slot);
+    --size_;
+    if (!index_.empty())
+      rebuild_index();
+    return true;
+  }
+
+  /// Removes all entries.
+  void clear() {
+    entries_.clear();
+    free_slots_.clear();
+    index_.clear();
+    size_ = 0;
+  }
+
+  // -- lookup -----------------------------------------------------------------
+
+  /// Returns a pointer to the state for `key` or `nullptr`.
+  T* find(const endpoint_id& key) noexcept {
+    auto slot = index_of(key);
+    return slot != npos ? &entries_[slot].value : nullptr;
+  }
+
+  /// Returns a pointer to the state for `key` or `nullptr`.
+  const T* find(const endpoint_id& key) const noexcept {
+    auto slot = index_of(key);
+    return slot != npos ? &entries_[slot].value : nullptr;
+  }
+
+  /// Returns the slot index of `key` or `npos`. The index is stable for the
+  /// lifetime of the entry and dense enough for direct use as a bit position
+  /// or array offset.
+  size_t index_of(const endpoint_id& key) const noexcept {
+    if (index_.empty()) {
+      for (size_t slot = 0; slot < entries_.size(); ++slot)
+        if (entries_[slot].live && entries_[slot].key == key)
+          return slot;
+      return npos;
+    }
+    auto mask = index_.size() - 1;
+    for (auto probe = hash_of(key) & mask;; probe = (probe + 1) & mask) {
+      auto val = index_[probe];
+      if (val == 0)
+        return npos;
+      if (entries_[val - 1].key == key)
+        return val - 1;
+    }
+  }
+
+  /// Returns the number of entries.
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  /// Returns whether the table holds no entries.
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  /// Returns one past the highest slot index ever handed out, i.e., the
+  /// capacity a slot-indexed side structure must provide.
+  size_t slot_count() const noexcept {
+    return entries_.size();
+  }
+
+private:
+  struct entry {
+    endpoint_id key;
+    T value;
+    bool live = true;
+  };
+
+  static uint64_t hash_of(const endpoint_id& key) noexcept {
+    // The std::hash digest of an endpoint ID is well distributed already;
+    // one extra mix hardens it against the power-of-two mask.
+    return hash_combine64(hash_secret[2], key.hash());
+  }
+
+  /// Returns the slot of `key`, inserting a new entry if necessary.
+  size_t insert_slot(const endpoint_id& key) {
+    if (auto slot = index_of(key); slot != npos)
+      return slot;
+    size_t slot;
+    if (!free_slots_.empty()) {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+      entries_[slot].key = key;
+      entries_[slot].live = true;
+    } else {
+      slot = entries_.size();
+      entries_.push_back(entry{key, T{}, true});
+    }
+    ++size_;
+    if (size_ > small_size && index_.size() < 2 * size_)
+      rebuild_index();
+    else if (!index_.empty())
+      index_insert(slot);
+    return slot;
+  }
+
+  /// Rebuilds the open-addressing index from scratch with room for growth.
+  void rebuild_index() {
+    auto cap = index_.empty() ? size_t{4} : index_.size();
+    while (cap < 4 * size_)
+      cap *= 2;
+    index_.assign(cap, 0);
+    for (size_t slot = 0; slot < entries_.size(); ++slot)
+      if (entries_[slot].live)
+        index_insert(slot);
+  }
+
+  /// Adds `slot` to the open-addressing index.
+  void index_insert(size_t slot) noexcept {
+    auto mask = index_.size() - 1;
+    auto probe = hash_of(entries_[slot].key) & mask;
+    while (index_[probe] != 0)
+      probe = (probe + 1) & mask;
+    index_[probe] = static_cast<uint32_t>(slot + 1);
+  }
+
+  /// Entries by slot. Slots of erased entries stay allocated with `live`
+  /// cleared until an insertion reuses them.
+  std::vector<entry> entries_;
+
+  /// Slots released by `erase`, reused before the array grows.
+  std::vector<size_t> free_slots_;
+
+  /// Open-addressing index storing `slot + 1` (0 marks an empty bucket).
+  /// Stays empty while linear scanning wins; kept at a load factor of at
+  /// most 1/2 otherwise.
+  std::vector<uint32_t> index_;
+
+  /// Number of live entries.
+  size_t size_ = 0;
+};
+
+} // namespace broker::detail
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -8,11 +10,44 @@
 
 namespace broker::detail {
 
+/// Checks whether the pattern matches `t`. The pattern segment `*` matches
+/// exactly one topic segment; all other segments match literally. Like plain
+/// filter entries, patterns match by prefix: `zeek/logs/*/conn` selects
+/// `zeek/logs/x/conn` as well as any topic below it.
+/// @pre `pattern.contains_wildcard()`
+bool match_topic_pattern(const topic& pattern, const topic& t) noexcept;
+
+/// Holds the wildcard entries of a filter, pre-split into segments for
+/// repeated matching. Filter paths that compile plain prefixes into a radix
+/// tree keep an instance of this class next to it for the pattern entries.
+class compiled_patterns {
+public:
+  /// Rebuilds the pattern list from the wildcard entries of `filter`.
+  void assign(const std::vector<topic>& filter);
+
+  /// Checks whether any pattern matches `t`.
+  bool matches(const topic& t) const noexcept;
+
+  /// Returns whether no filter entry contained a wildcard.
+  [[nodiscard]] bool empty() const noexcept {
+    return patterns_.empty();
+  }
+
+private:
+  std::vector<std::vector<std::string>> patterns_;
+};
+
 struct prefix_matcher {
   using filter_type = std::vector<topic>;
 
   bool operator()(const filter_type& filter, const topic& t) const;
 
+  /// Checks whether the filter accepts a topic given only its raw bytes,
+  /// e.g., a topic still sitting in a receive buffer. Equivalent to
+  /// constructing a `topic` from `t` and calling the overload above, minus
+  /// the string allocation.
+  bool operator()(const filter_type& filter, std::string_view t) const;
+
   template <class T>
   bool operator()(const filter_type& filter, const T& x) const {
     return (*this)(filter, get_topic(x));
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "broker/expected.hh"
+
+namespace broker::detail {
+
+/// Preset dictionaries for deflate compression. Small Zeek events share most
+/// of their bytes with other events of the same kind, but a single message
+/// is too short for deflate to find those repetitions on its own. A preset
+/// dictionary primes the compression window with representative content up
+/// front, so even the first occurrence of a common string compresses to a
+/// back-reference. Dictionaries are trained offline by the broker-dict-train
+/// tool from recorded generator files, one per topic prefix, and loaded on
+/// every node from "broker.compression-dictionary-directory". A deflate
+/// stream produced with a preset dictionary embeds the dictionary's Adler-32
+/// checksum, which the receiving side uses to select the matching dictionary
+/// from its loaded set.
+
+/// A single trained dictionary.
+struct preset_dictionary {
+  /// Name of the dictionary, i.e., the file name without the ".dict"
+  /// extension. The training tool names dictionaries after the first topic
+  /// segment of the messages they were trained on, which matches the store
+  /// name for command traffic.
+  std::string name;
+
+  /// Raw dictionary content. Deflate only matches against the final 32 KiB,
+  /// so trained dictionaries never exceed that size.
+  std::vector<std::byte> bytes;
+
+  /// Adler-32 checksum over `bytes`, as embedded into deflate streams that
+  /// were produced with this dictionary.
+  uint32_t checksum = 0;
+};
+
+/// An immutable collection of dictionaries, loaded once at startup. Lookup
+/// results point into the set and remain valid for its lifetime.
+class preset_dictionary_set {
+public:
+  void add(preset_dictionary dict);
+
+  bool empty() const noexcept {
+    return entries_.empty();
+  }
+
+  size_t size() const noexcept {
+    return entries_.size();
+  }
+
+  const std::vector<preset_dictionary>& entries() const noexcept {
+    return entries_;
+  }
+
+  /// Returns the dictionary named `name` or `nullptr` if none exists.
+  const preset_dictionary* by_name(std::string_view name) const noexcept;
+
+  /// Returns the dictionary with the given Adler-32 checksum or `nullptr` if
+  /// none exists.
+  const preset_dictionary* by_checksum(uint32_t checksum) const noexcept;
+
+  /// Returns the dictionary named `name`, falling back to the one named
+  /// "default" and finally `nullptr`.
+  const preset_dictionary* lookup(std::string_view name) const noexcept;
+
+private:
+  std::vector<preset_dictionary> entries_;
+};
+
+/// Computes the Adler-32 checksum of `size` bytes at `first`, matching the
+/// dictionary ID that deflate embeds into streams produced with a preset
+/// dictionary.
+uint32_t preset_dictionary_checksum(const std::byte* first, size_t size);
+
+/// Trains a dictionary from sample payloads. The trainer deduplicates the
+/// samples, orders them by ascending frequency and concatenates them, so the
+/// most common payloads sit at the end of the dictionary where deflate finds
+/// them with the shortest back-references. When the concatenation exceeds
+/// `max_size`, only the trailing `max_size` bytes survive.
+std::vector<std::byte>
+train_preset_dictionary(const std::vector<std::vector<std::byte>>& samples,
+                        size_t max_size);
+
+/// Loads all "*.dict" files from `dir` into a set, ordered by name. The file
+/// name without the extension becomes the dictionary name. Returns
+/// `ec::cannot_open_file` when `dir` is not a readable directory.
+expected<preset_dictionary_set>
+load_preset_dictionaries(const std::string& dir);
+
+/// Deflates `size` bytes at `first` and appends the result to `out`,
+/// priming the compressor with `dict` unless it is `nullptr`. Returns
+/// `false` without touching `out` when compression fails or the build lacks
+/// zlib support.
+bool deflate_bytes(const std::byte* first, size_t size,
+                   const preset_dictionary* dict, std::vector<std::byte>& out);
+
+/// Inflates `size` bytes at `first` into `out`, which callers resize to the
+/// expected uncompressed size upfront. When the stream was deflated against
+/// a preset dictionary, resolves it in `dicts` via the embedded checksum.
+/// Returns `false` for malformed input, a size mismatch, an unknown or
+/// missing dictionary, or builds without zlib support.
+bool inflate_bytes(const std::byte* first, size_t size,
+                   const preset_dictionary_set* dicts,
+                   std::vector<std::byte>& out);
+
+} // namespace broker::detail
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "broker/publish_limit.hh"
+#include "broker/topic.hh"
+
+namespace broker::detail {
+
+/// Enforces token-bucket rate limits per topic prefix. An endpoint shares one
+/// limiter with all of its publishers, so every publish path consults the
+/// limiter before handing messages to the core actor and overload from a
+/// misconfigured producer never reaches the dispatch path. Thread-safe;
+/// endpoints without attached limits only pay one atomic load per publish.
+class publish_limiter {
+public:
+  /// Attaches `limit` to all topics under `prefix`, replacing a previous
+  /// limit for the same prefix. Limits with a non-positive rate detach the
+  /// prefix again.
+  void attach(topic prefix, publish_limit limit);
+
+  /// Grants or denies admission for `n` messages published to `t`. For
+  /// prefixes with the block policy, this blocks the calling thread until the
+  /// bucket refills. Returns false if the messages must be dropped.
+  bool admit(const topic& t, size_t n = 1);
+
+  /// Returns the number of messages dropped across all prefixes.
+  uint64_t dropped() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  struct entry {
+    topic prefix;
+    publish_limit limit;
+    /// Currently available tokens, refilled on demand from `last_refill`.
+    double tokens;
+    clock::time_point last_refill;
+  };
+
+  /// Credits tokens accumulated since the last refill. Callers must hold
+  /// `mtx_`.
+  static void refill(entry& e, clock::time_point now);
+
+  /// Guards `entries_` and the token state inside.
+  mutable std::mutex mtx_;
+
+  std::vector<entry> entries_;
+
+  /// Caches whether any entry exists, so unlimited endpoints skip the lock.
+  std::atomic<bool> active_ = false;
+
+  /// Counts messages discarded by the drop policy.
+  std::atomic<uint64_t> dropped_ = 0;
+};
+
+} // namespace broker::detail
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "broker/fwd.hh"
+#include "broker/telemetry/counter.hh"
+#include "broker/telemetry/gauge.hh"
+#include "broker/telemetry/histogram.hh"
+
+namespace broker::detail {
+
+/// Bundles the optional telemetry instruments of a shared queue. Queues
+/// without instruments skip all bookkeeping, so standalone uses (e.g., in
+/// unit tests) pay nothing.
+struct queue_stats {
+  /// Mirrors the number of items currently buffered in the queue.
+  std::optional<telemetry::gauge<int64_t>> depth;
+
+  /// Tracks the largest depth the queue has reached so far.
+  std::optional<telemetry::gauge<int64_t>> high_watermark;
+
+  /// Samples how long callers block on the queue, in seconds. For subscriber
+  /// queues, this is the time consumers wait for new items; for publisher
+  /// queues, the time producers stall on a full queue.
+  std::optional<telemetry::histogram<double>> wait_time;
+
+  /// Counts items that backpressure policies discarded.
+  std::optional<telemetry::counter<int64_t>> drops;
+};
+
+/// Creates the telemetry instruments for a shared queue in the registry of
+/// `ep`, labeled with `role` ("subscriber" or "publisher") and the
+/// comma-separated topic `filter` of the queue.
+queue_stats make_queue_stats(endpoint& ep, std::string_view role,
+                             const std::vector<topic>& filter);
+
+} // namespace broker::detail
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include "broker/backend_options.hh"
+
+#include "broker/detail/abstract_backend.hh"
+
+namespace broker {
+namespace detail {
+
+/// An LSM-tree storage backend based on RocksDB for write-heavy persistent
+/// stores whose working set exceeds RAM. Only available when Broker was
+/// configured with `BROKER_ENABLE_ROCKSDB`.
+class rocksdb_backend : public abstract_backend {
+public:
+  /// Constructs a RocksDB backend.
+  /// @param opts The options to create/open a database.
+  /// Required parameters:
+  ///   - `path`: a `std::string` representing the location of the database
+  ///             directory on the filesystem.
+  /// Optional parameters:
+  ///   - `write-buffer-size`: a `count` denoting the size of the in-memory
+  ///             write buffer (memtable) in bytes.
+  ///   - `disable-wal`: a `boolean` that skips the write-ahead log for
+  ///             mutations, trading durability for write throughput.
+  rocksdb_backend(backend_options opts = backend_options{});
+
+  ~rocksdb_backend();
+
+  /// Returns whether the constructor failed to open the database.
+  bool init_failed() const;
+
+  expected<void> put(const data& key, data value,
+                     std::optional<timestamp> expiry) override;
+
+  expected<void> add(const data& key, const data& value, data::type init_type,
+                     std::optional<timestamp> expiry) override;
+
+  expected<void> subtract(const data& key, const data& value,
+                          std::optional<timestamp> expiry) override;
+
+  expected<void> erase(const data& key) override;
+
+  expected<void> clear() override;
+
+  expected<bool> expire(const data& key, timestamp current_time) override;
+
+  expected<data> get(const data& key) const override;
+
+  expected<bool> exists(const data& key) const override;
+
+  expected<uint64_t> size() const override;
+
+  expected<data> keys() const override;
+
+  expected<broker::snapshot> snapshot() const override;
+
+  expected<expirables> expiries() const override;
+
+  /// Returns a table mapping RocksDB property names to their current values,
+  /// covering memtable usage and compaction activity.
+  expected<data> stats() const override;
+
+private:
+  struct impl;
+  std::unique_ptr<impl> impl_;
+};
+
+} // namespace detail
+} // namespace broker
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "broker/config.hh"
+
+// Statically defined tracepoints (USDT) for probing a live Broker node with
+// bpftrace, perf or similar tools without rebuilding, e.g.:
+//
+//     bpftrace -e 'usdt:/path/to/libbroker.so:broker:dispatcher_enqueue
+//                  { @msgs = hist(arg1); }'
+//
+// All probes live in the provider "broker". When the build lacks
+// <sys/sdt.h> (or BROKER_ENABLE_USDT is off), the macros expand to no-ops.
+
+#ifdef BROKER_HAVE_SDT
+
+#include <sys/sdt.h>
+
+#define BROKER_PROBE(name) DTRACE_PROBE(broker, name)
+
+#define BROKER_PROBE1(name, a0) DTRACE_PROBE1(broker, name, a0)
+
+#define BROKER_PROBE2(name, a0, a1) DTRACE_PROBE2(broker, name, a0, a1)
+
+#define BROKER_PROBE3(name, a0, a1, a2) DTRACE_PROBE3(broker, name, a0, a1, a2)
+
+#else // BROKER_HAVE_SDT
+
+#define BROKER_PROBE(name) static_cast<void>(0)
+
+#define BROKER_PROBE1(name, a0) static_cast<void>(0)
+
+#define BROKER_PROBE2(name, a0, a1) static_cast<void>(0)
+
+#define BROKER_PROBE3(name, a0, a1, a2) static_cast<void>(0)
+
+#endif // BROKER_HAVE_SDT
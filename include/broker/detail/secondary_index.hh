@@ -0,0 +1,57 @@
+#pragma once
+
+#include <optional>
+#include <set>
+#include <unordered_map>
+
+#include "broker/data.hh"
+#include "broker/snapshot.hh"
+
+namespace broker::detail {
+
+/// Maps values (or one element of composite values) back to the keys that
+/// hold them, so the master answers "which keys have this value" without
+/// scanning the whole store. The master maintains the index incrementally on
+/// each mutation.
+class secondary_index {
+public:
+  /// Constructs an index over entire values, or over the element at position
+  /// `element` for values that are vectors.
+  explicit secondary_index(std::optional<uint64_t> element)
+    : element_(std::move(element)) {
+    // nop
+  }
+
+  /// Returns the indexed element position, or `std::nullopt` when indexing
+  /// entire values.
+  const std::optional<uint64_t>& element() const noexcept {
+    return element_;
+  }
+
+  /// Adds `key` to the bucket of its indexed value.
+  void insert(const data& key, const data& value);
+
+  /// Removes `key` from the bucket of its indexed value.
+  void erase(const data& key, const data& value);
+
+  /// Drops all entries.
+  void clear() {
+    buckets_.clear();
+  }
+
+  /// Re-populates the index from a full snapshot of the store.
+  void rebuild(const broker::snapshot& ss);
+
+  /// Returns the keys whose indexed value equals `value`, as a set.
+  data lookup(const data& value) const;
+
+private:
+  /// Returns the indexed portion of `value`, or `nullptr` for values the
+  /// index does not cover (e.g., non-vectors under an element index).
+  const data* extract(const data& value) const;
+
+  std::optional<uint64_t> element_;
+  std::unordered_map<data, std::set<data>> buckets_;
+};
+
+} // namespace broker::detail
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 
 #include "broker/detail/assert.hh"
@@ -15,10 +16,9 @@ namespace broker::detail {
 ///
 /// The protocol on the flare is as follows:
 /// - the flare starts active
-/// - the flare is active as long as xs_ has below 20 items
-/// - consume() fires the flare when it removes items from xs_ and less than 20
-///   items remain
-/// - produce() extinguishes the flare it adds items to xs_, exceeding 20
+/// - the flare is active as long as the queue has below `capacity` items
+/// - consume() fires the flare when it drops the size below the capacity
+/// - produce() extinguishes the flare when it reaches the capacity
 template <class ValueType = data_message>
 class shared_publisher_queue : public shared_queue<ValueType> {
 public:
@@ -26,8 +26,6 @@ public:
 
   using super = shared_queue<ValueType>;
 
-  using guard_type = typename super::guard_type;
-
   shared_publisher_queue(size_t buffer_size) : capacity_(buffer_size) {
     // The flare is active as long as publishers can write.
     this->fx_.fire();
@@ -40,26 +38,25 @@ public:
   // sync.
   template <class F>
   size_t consume(size_t num, F fun) {
-    guard_type guard{this->mtx_};
-    auto& xs = this->xs_;
-    if (xs.empty()) {
+    auto available = this->size_.load();
+    if (available == 0) {
       this->pending_ = static_cast<long>(num);
-      return false;
+      return 0;
     }
-    auto n = std::min(num, xs.size());
-    auto b = xs.begin();
-    auto e = b + static_cast<ptrdiff_t>(n);
-    for (auto i = b; i != e; ++i)
-      fun(std::move(*i));
-    auto old_size = xs.size();
-    xs.erase(b, e);
-    auto new_size = xs.size();
-    // Extinguish the flare if we reach the capacity or fire it if we drop
-    // below the capacity again.
-    if (new_size >= capacity_ && old_size < capacity_)
-      this->fx_.extinguish();
-    else if (new_size < capacity_ && old_size >= capacity_)
+    auto n = std::min(num, available);
+    value_type x;
+    for (size_t i = 0; i < n; ++i) {
+      auto popped = this->xs_.pop(x);
+      BROKER_ASSERT(popped);
+      this->account_consumed(x);
+      fun(std::move(x));
+    }
+    auto old_size = this->size_.fetch_sub(n);
+    auto new_size = old_size - n;
+    // Fire the flare if we drop below the capacity again.
+    if (new_size < capacity_ && old_size >= capacity_)
       this->fx_.fire();
+    this->note_consumed(n);
     if (num - n > 0)
       this->pending_ = static_cast<long>(num - n);
     return n;
@@ -69,35 +66,37 @@ public:
   /// go beyond the capacity of the queue.
   template <class Iterator>
   bool produce(const topic& t, Iterator first, Iterator last) {
-    guard_type guard{this->mtx_};
-    auto& xs = this->xs_;
-    if (xs.size() >= capacity_)
-      await_consumer(guard);
-    auto xs_old_size = xs.size();
-    BROKER_ASSERT(xs_old_size < capacity_);
-    for (; first != last; ++first)
-      xs.emplace_back(t, std::move(*first));
-    if (xs.size() >= capacity_) {
-      // Extinguish the flare to cause the *next* produce to block.
-      this->fx_.extinguish();
+    await_free_capacity();
+    size_t num = 0;
+    for (; first != last; ++first, ++num) {
+      value_type x{t, std::move(*first)};
+      this->account_produced(x);
+      this->xs_.push(std::move(x));
+    }
+    return add_to_size(num);
+  }
+
+  /// Moves pre-assembled messages into the queue without re-constructing
+  /// them. Returns true if the caller must wake up the consumer. This
+  /// function can go beyond the capacity of the queue.
+  template <class Iterator>
+  bool produce(Iterator first, Iterator last) {
+    await_free_capacity();
+    size_t num = 0;
+    for (; first != last; ++first, ++num) {
+      this->account_produced(*first);
+      this->xs_.push(std::move(*first));
     }
-    return xs_old_size == 0;
+    return add_to_size(num);
   }
 
   // Returns true if the caller must wake up the consumer.
   bool produce(const topic& t, data&& y) {
-    guard_type guard{this->mtx_};
-    auto& xs = this->xs_;
-    if (xs.size() >= capacity_)
-      await_consumer(guard);
-    auto xs_old_size = xs.size();
-    BROKER_ASSERT(xs_old_size < capacity_);
-    xs.emplace_back(t, std::move(y));
-    if (xs.size() >= capacity_) {
-      // Extinguish the flare to cause the *next* produce to block.
-      this->fx_.extinguish();
-    }
-    return xs_old_size == 0;
+    await_free_capacity();
+    value_type x{t, std::move(y)};
+    this->account_produced(x);
+    this->xs_.push(std::move(x));
+    return add_to_size(1);
   }
 
   size_t capacity() const {
@@ -105,19 +104,27 @@ public:
   }
 
 private:
-  void await_consumer(guard_type& guard) {
-    // Block the caller until the consumer catched up.
-    guard.unlock();
-    this->fx_.await_one();
-    guard.lock();
+  /// Blocks the caller until the consumer catched up, i.e., until the queue
+  /// has room for at least one more item.
+  void await_free_capacity() {
+    if (this->size_.load() < capacity_)
+      return;
+    auto t0 = this->wait_begin();
+    while (this->size_.load() >= capacity_)
+      this->fx_.await_one();
+    this->wait_end(t0);
   }
 
-  /// @pre xs.size() < capacity_
-  ptrdiff_t free_space() {
-    return static_cast<ptrdiff_t>(capacity_ - this->xs.size());
+  /// Accounts for `num` new items and extinguishes the flare when reaching
+  /// the capacity to cause the *next* produce to block.
+  bool add_to_size(size_t num) {
+    auto old_size = this->size_.fetch_add(num);
+    if (old_size < capacity_ && old_size + num >= capacity_)
+      this->fx_.extinguish();
+    this->note_produced(num, old_size + num);
+    return old_size == 0;
   }
 
-
   // Configures the amound of items for xs_.
   const size_t capacity_;
 };
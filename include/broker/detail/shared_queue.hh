@@ -1,27 +1,28 @@
 #pragma once
 
 #include <atomic>
-#include <deque>
-#include <mutex>
-#include <thread>
-#include <condition_variable>
+#include <chrono>
 
 #include "broker/data.hh"
 #include "broker/message.hh"
 #include "broker/topic.hh"
 
 #include "broker/detail/flare.hh"
+#include "broker/detail/memory_accounting.hh"
+#include "broker/detail/queue_stats.hh"
+#include "broker/detail/spsc_queue.hh"
 
 namespace broker::detail {
 
 /// Base class for `shared_publisher_queue` and `shared_subscriber_queue`.
+/// Producer and consumer exchange items through a lock-free SPSC queue and
+/// signal each other through the flare, so neither side ever blocks on a
+/// mutex held by the other.
 template <class ValueType = data_message>
 class shared_queue {
 public:
   using value_type = ValueType;
 
-  using guard_type = std::unique_lock<std::mutex>;
-
   virtual ~shared_queue() {
     // nop
   }
@@ -41,8 +42,11 @@ public:
   }
 
   size_t buffer_size() const {
-    guard_type guard{mtx_};
-    return xs_.size();
+    return size_.load();
+  }
+
+  size_t spin_count() const {
+    return spin_count_;
   }
 
   // --- mutators --------------------------------------------------------------
@@ -55,24 +59,64 @@ public:
     rate_ = x;
   }
 
+  /// Configures how many busy-poll iterations the consumer performs before
+  /// parking on the flare fd. May only be called from the consumer thread.
+  void spin_count(size_t x) {
+    spin_count_ = x;
+  }
+
   void wait_on_flare() {
-    fx_.await_one();
+    auto t0 = wait_begin();
+    if (!fx_.spin_await_one(spin_count_))
+      fx_.await_one();
+    wait_end(t0);
   }
 
   template<class Duration>
   bool wait_on_flare(Duration timeout) {
     if (timeout == infinite) {
-      fx_.await_one();
+      wait_on_flare();
       return true;
     }
     auto abs_timeout = std::chrono::high_resolution_clock::now();
     abs_timeout += timeout;
-    return fx_.await_one(abs_timeout);
+    return wait_on_flare_abs(abs_timeout);
   }
 
   template <class T>
   bool wait_on_flare_abs(T abs_timeout) {
-    return fx_.await_one(abs_timeout);
+    auto t0 = wait_begin();
+    auto result = fx_.spin_await_one(spin_count_)
+                  || fx_.await_one(abs_timeout);
+    wait_end(t0);
+    return result;
+  }
+
+  // --- telemetry -------------------------------------------------------------
+
+  /// Attaches telemetry instruments to the queue. May only be called before
+  /// handing the queue to a second thread.
+  void attach_stats(queue_stats stats) {
+    stats_ = std::move(stats);
+  }
+
+  /// Counts `num` items discarded by a backpressure policy.
+  void note_dropped(size_t num) {
+    if (stats_.drops)
+      stats_.drops->inc(static_cast<int64_t>(num));
+  }
+
+  /// Attaches the endpoint-wide memory accountant. Like `attach_stats`, this
+  /// may only be called before handing the queue to a second thread.
+  void attach_accounting(memory_accountant_ptr accountant) {
+    accountant_ = std::move(accountant);
+  }
+
+  /// Places future queue storage near the given NUMA node; see
+  /// `spsc_queue::set_numa_node`. Like `attach_stats`, this may only be
+  /// called before handing the queue to a second thread.
+  void set_numa_node(int node) noexcept {
+    xs_.set_numa_node(node);
   }
 
 protected:
@@ -80,14 +124,71 @@ protected:
     // nop
   }
 
-  /// Guards access to `xs`.
-  mutable std::mutex mtx_;
+  /// Mirrors a size increase of `num` in the telemetry instruments. May only
+  /// run on the producer thread, which is the sole writer of the watermark.
+  void note_produced(size_t num, size_t new_size) {
+    if (stats_.depth)
+      stats_.depth->inc(static_cast<int64_t>(num));
+    if (stats_.high_watermark && new_size > high_watermark_) {
+      stats_.high_watermark->inc(static_cast<int64_t>(new_size
+                                                      - high_watermark_));
+      high_watermark_ = new_size;
+    }
+  }
+
+  /// Mirrors a size decrease of `num` in the telemetry instruments.
+  void note_consumed(size_t num) {
+    if (stats_.depth)
+      stats_.depth->dec(static_cast<int64_t>(num));
+  }
+
+  /// Accounts the estimated footprint of `x` against the queue region.
+  void account_produced(const value_type& x) {
+    if (accountant_)
+      accountant_->add(memory_region::queues, estimated_memory_use(x));
+  }
+
+  /// Releases the estimated footprint of `x` from the queue region.
+  void account_consumed(const value_type& x) {
+    if (accountant_)
+      accountant_->sub(memory_region::queues, estimated_memory_use(x));
+  }
+
+  /// Returns whether the endpoint exceeds its memory budget, in which case
+  /// producers should shed instead of buffering more items.
+  bool over_budget() const {
+    return accountant_ && accountant_->over_budget();
+  }
+
+  /// Takes the start time for a wait-time sample, or a default-constructed
+  /// time point when the queue has no wait-time instrument.
+  std::chrono::steady_clock::time_point wait_begin() const {
+    if (stats_.wait_time)
+      return std::chrono::steady_clock::now();
+    return {};
+  }
+
+  /// Records the time since `t0` in the wait-time histogram.
+  void wait_end(std::chrono::steady_clock::time_point t0) {
+    if (stats_.wait_time && t0 != std::chrono::steady_clock::time_point{}) {
+      fractional_seconds delta = std::chrono::steady_clock::now() - t0;
+      stats_.wait_time->observe(delta.count());
+    }
+  }
 
   /// Signals to users when data can be read or written.
   mutable flare fx_;
 
+  /// Number of busy-poll iterations the consumer performs on the flare state
+  /// before falling back to a blocking fd wait. Zero parks immediately.
+  size_t spin_count_ = 0;
+
   /// Buffers values received by the worker.
-  std::deque<value_type> xs_;
+  spsc_queue<value_type> xs_;
+
+  /// Counts the elements currently in `xs_`. Incremented by the producer
+  /// after pushing, decremented by the consumer after popping.
+  std::atomic<size_t> size_ = 0;
 
   /// Stores what demand the worker has last signaled to the core or vice
   /// versa, depending on the message direction.
@@ -95,6 +196,16 @@ protected:
 
   /// Stores consumption or production rate.
   std::atomic<size_t> rate_;
+
+  /// Optional telemetry instruments; see `attach_stats`.
+  queue_stats stats_;
+
+  /// Optional endpoint-wide memory accounting; see `attach_accounting`.
+  memory_accountant_ptr accountant_;
+
+  /// Largest size reported to the high-watermark gauge. Only the producer
+  /// thread reads and writes this value.
+  size_t high_watermark_ = 0;
 };
 
 } // namespace broker::detail
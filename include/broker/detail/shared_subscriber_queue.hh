@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -9,16 +11,17 @@
 
 namespace broker::detail {
 
-/// Synchronizes a publisher with a background worker. Uses the `pending` flag
+/// Synchronizes a subscriber with a background worker. Uses the `pending` flag
 /// and the `flare` to signalize demand to the user. Users can write as long as
 /// the flare remains active. The user consumes items, while the worker
 /// produces them.
 ///
 /// The protocol on the flare is as follows:
 /// - the flare starts inactive
-/// - the flare is active as long as xs_ has more than one item
-/// - produce() fires the flare when it adds items to xs_ and xs_ was empty
-/// - consume() extinguishes the flare when it removes the last item from xs_
+/// - produce() fires the flare when the queue transitions from empty to
+///   non-empty
+/// - consume() extinguishes the flare when it drains the queue and re-fires
+///   it if the producer raced in new items meanwhile
 template <class ValueType = data_message>
 class shared_subscriber_queue : public shared_queue<ValueType> {
 public:
@@ -26,71 +29,175 @@ public:
 
   using super = shared_queue<value_type>;
 
-  using guard_type = typename super::guard_type;
+  /// Runs on the producer thread for every item that enters the queue.
+  using observer = std::function<void(const value_type&)>;
 
   shared_subscriber_queue() = default;
 
+  /// Attaches an observer to the producer side. Like `attach_stats`, this may
+  /// only be called before handing the queue to a second thread.
+  void attach_observer(observer f) {
+    observer_ = std::move(f);
+  }
+
   // Called to pull up to `num` items out of the queue. Returns the number of
   // consumed elements.
   template <class F>
   size_t consume(size_t num, size_t* size_before_consume, F fun) {
-    guard_type guard{this->mtx_};
-    if (this->xs_.empty())
+    drop_stale();
+    auto available = this->size_.load();
+    if (available == 0)
       return 0;
     if (size_before_consume)
-      *size_before_consume = this->xs_.size();
-    auto n = std::min(num, this->xs_.size());
-    if (n == this->xs_.size()) {
-      for (auto& x : this->xs_)
-        fun(std::move(x));
-      this->xs_.clear();
-      this->fx_.extinguish_one();
-    } else {
-      auto b = this->xs_.begin();
-      auto e = b + static_cast<ptrdiff_t>(n);
-      for (auto i = b; i != e; ++i)
-        fun(std::move(*i));
-      this->xs_.erase(b, e);
+      *size_before_consume = available;
+    auto n = std::min(num, available);
+    value_type x;
+    for (size_t i = 0; i < n; ++i) {
+      auto popped = this->xs_.pop(x);
+      BROKER_ASSERT(popped);
+      this->account_consumed(x);
+      fun(std::move(x));
     }
+    if (this->size_.fetch_sub(n) - n == 0)
+      settle_flare();
+    this->note_consumed(n);
     return n;
   }
 
-  std::vector<value_type> consume_all() {
-    guard_type guard{this->mtx_};
+  // Like `consume`, but invokes `fun(ptr, n)` for contiguous runs of queued
+  // items instead of once per item. The pointer borrows the queue's storage
+  // and the run dies when `fun` returns, so consumers can process a batch
+  // in place without any per-item hand-off.
+  template <class F>
+  size_t consume_raw(size_t num, size_t* size_before_consume, F fun) {
+    drop_stale();
+    auto available = this->size_.load();
+    if (available == 0)
+      return 0;
+    if (size_before_consume)
+      *size_before_consume = available;
+    auto accounted_fun = [this, &fun](value_type* xs, size_t run) {
+      for (size_t i = 0; i < run; ++i)
+        this->account_consumed(xs[i]);
+      fun(xs, run);
+    };
+    auto n = this->xs_.drain(accounted_fun, std::min(num, available));
+    if (this->size_.fetch_sub(n) - n == 0)
+      settle_flare();
+    this->note_consumed(n);
+    return n;
+  }
 
-    std::vector<value_type> rval;
+  // Moves up to `num` items into the caller-provided buffer `buf`. Returns
+  // the number of moved elements.
+  size_t consume_into(value_type* buf, size_t num,
+                      size_t* size_before_consume) {
+    return consume_raw(num, size_before_consume,
+                       [&buf](value_type* xs, size_t n) {
+                         buf = std::move(xs, xs + n, buf);
+                       });
+  }
 
-    if (this->xs_.empty())
+  std::vector<value_type> consume_all() {
+    drop_stale();
+    std::vector<value_type> rval;
+    auto available = this->size_.load();
+    if (available == 0)
       return rval;
-
-    rval.reserve(this->xs_.size());
-
-    for (auto& x : this->xs_)
+    rval.reserve(available);
+    value_type x;
+    for (size_t i = 0; i < available; ++i) {
+      auto popped = this->xs_.pop(x);
+      BROKER_ASSERT(popped);
+      this->account_consumed(x);
       rval.emplace_back(std::move(x));
-
-    this->xs_.clear();
-    this->fx_.extinguish_one();
-
+    }
+    if (this->size_.fetch_sub(available) - available == 0)
+      settle_flare();
+    this->note_consumed(available);
     return rval;
   }
 
-  // Inserts the range `[i, e)` into the queue.
+  /// Asks the consumer to discard the `num` oldest queued elements on its
+  /// next consume call. May only be called from the producer thread.
+  void discard_oldest(size_t num) {
+    stale_.fetch_add(num);
+  }
+
+  // Inserts the range `[i, e)` into the queue. Sheds the entire batch when
+  // the endpoint exceeds its memory budget: subscriber buffering is
+  // transient data that a slow consumer failed to pick up, so it goes first.
   template <class Iter>
-  void produce([[maybe_unused]] size_t num, Iter i, Iter e) {
+  void produce(size_t num, Iter i, Iter e) {
     BROKER_ASSERT(static_cast<ptrdiff_t>(num) == std::distance(i, e));
-    guard_type guard{this->mtx_};
-    if (this->xs_.empty())
+    if (this->over_budget()) {
+      this->note_dropped(num);
+      return;
+    }
+    for (; i != e; ++i) {
+      if (observer_)
+        observer_(*i);
+      this->account_produced(*i);
+      this->xs_.push(*i);
+    }
+    auto old_size = this->size_.fetch_add(num);
+    if (old_size == 0)
       this->fx_.fire();
-    this->xs_.insert(this->xs_.end(), i, e);
+    this->note_produced(num, old_size + num);
   }
 
-  // Inserts `x` into the queue.
+  // Inserts `x` into the queue unless the endpoint exceeds its memory
+  // budget; see the range overload.
   void produce(ValueType x) {
-    guard_type guard{this->mtx_};
-    if (this->xs_.empty())
+    if (this->over_budget()) {
+      this->note_dropped(1);
+      return;
+    }
+    if (observer_)
+      observer_(x);
+    this->account_produced(x);
+    this->xs_.push(std::move(x));
+    auto old_size = this->size_.fetch_add(1);
+    if (old_size == 0)
       this->fx_.fire();
-    this->xs_.emplace_back(std::move(x));
+    this->note_produced(1, old_size + 1);
   }
+
+private:
+  /// Discards elements that the producer marked stale via `discard_oldest`.
+  /// May only be called from the consumer thread.
+  void drop_stale() {
+    auto num = stale_.exchange(0);
+    if (num == 0)
+      return;
+    auto n = std::min(num, this->size_.load());
+    value_type x;
+    for (size_t i = 0; i < n; ++i) {
+      auto popped = this->xs_.pop(x);
+      BROKER_ASSERT(popped);
+      this->account_consumed(x);
+    }
+    if (n > 0 && this->size_.fetch_sub(n) - n == 0)
+      settle_flare();
+    this->note_consumed(n);
+    this->note_dropped(n);
+  }
+
+  /// Extinguishes the flare after draining the queue. Re-checks the size
+  /// afterwards: the producer may have pushed new items between our last pop
+  /// and the extinguish, in which case we restore the active state ourselves
+  /// since the producer only fires on the empty-to-non-empty transition.
+  void settle_flare() {
+    this->fx_.extinguish();
+    if (this->size_.load() != 0)
+      this->fx_.fire();
+  }
+
+  /// Counts the oldest elements that the producer asked us to discard.
+  std::atomic<size_t> stale_ = 0;
+
+  /// Optional per-item callback on the producer side; see `attach_observer`.
+  observer observer_;
 };
 
 template <class ValueType = data_message>
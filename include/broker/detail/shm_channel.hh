@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "broker/config.hh"
+#include "broker/expected.hh"
+#include "broker/fwd.hh"
+
+#ifndef BROKER_WINDOWS
+
+namespace broker::detail {
+
+/// A single-producer/single-consumer byte ring living inside a mapped
+/// segment, carrying length-prefixed message blobs. Cursors are atomics in
+/// the shared region, so producer and consumer may sit in different
+/// processes. In steady state, produce and consume are a memcpy plus two
+/// atomic operations; flare-style doorbell words wake a parked peer (via
+/// futex on Linux, short sleeps elsewhere) only when it announced that it is
+/// waiting, keeping the fast path free of syscalls.
+class shm_ring {
+public:
+  /// Control block at the start of the ring's shared region.
+  struct header;
+
+  /// Returns the bytes a ring with `capacity` payload bytes occupies.
+  static size_t region_size(uint32_t capacity) noexcept;
+
+  /// Constructs a view onto the shared region at `base`; `initialize` must
+  /// be `true` exactly once per region, before any other use.
+  shm_ring(void* base, uint32_t capacity, bool initialize);
+
+  /// Appends one message to the ring.
+  /// @returns `false` when the free space cannot hold the message.
+  bool produce(const std::byte* bytes, size_t size);
+
+  /// Removes the next message from the ring into `out`.
+  /// @returns `false` when the ring is empty.
+  bool consume(std::vector<std::byte>& out);
+
+  /// Blocks the consumer until the ring holds at least one message.
+  void await_input();
+
+  /// Blocks the producer until the ring has at least `size` + prefix bytes
+  /// of free space. @pre the message fits an empty ring
+  void await_space(size_t size);
+
+  /// Returns the number of unconsumed payload bytes (including prefixes).
+  size_t used() const noexcept;
+
+  /// Returns the capacity in payload bytes.
+  uint32_t capacity() const noexcept;
+
+private:
+  header* hdr_;
+  std::byte* data_;
+};
+
+/// A bidirectional same-host transport over a named POSIX shared-memory
+/// segment: one ring per direction plus doorbells. Endpoints on one machine
+/// can exchange serialized messages through it with a single copy per side
+/// and no kernel round trips while both stay busy. The creating side unlinks
+/// the segment again on destruction.
+class shm_channel {
+public:
+  shm_channel(shm_channel&& other) noexcept;
+
+  shm_channel& operator=(shm_channel&& other) noexcept;
+
+  shm_channel(const shm_channel&) = delete;
+
+  shm_channel& operator=(const shm_channel&) = delete;
+
+  /// Unmaps the segment; the creating side also unlinks it.
+  ~shm_channel();
+
+  /// Creates the segment `name` (a `shm_open` name such as "/broker-123")
+  /// with two rings of `capacity` bytes each, rounding the capacity up to
+  /// the next power of two. Fails with `ec::unspecified` if the name exists
+  /// already or `capacity` is zero.
+  static expected<shm_channel> create(const std::string& name,
+                                      uint32_t capacity);
+
+  /// Attaches to a segment previously set up via `create`.
+  static expected<shm_channel> attach(const std::string& name);
+
+  /// Writes one message, blocking while the outbound ring is full.
+  /// @returns `false` for messages larger than the ring.
+  bool put(const std::byte* bytes, size_t size);
+
+  /// @copydoc put
+  bool put(const std::vector<std::byte>& bytes) {
+    return put(bytes.data(), bytes.size());
+  }
+
+  /// Reads the next message into `out`, blocking while the inbound ring is
+  /// empty.
+  void get(std::vector<std::byte>& out);
+
+  /// Reads the next message into `out` if one is available.
+  /// @returns `false` when the inbound ring is empty.
+  bool try_get(std::vector<std::byte>& out);
+
+  /// Returns whether the channel owns a mapped segment.
+  bool valid() const noexcept {
+    return base_ != nullptr;
+  }
+
+private:
+  shm_channel() = default;
+
+  void* base_ = nullptr;
+  size_t mapped_size_ = 0;
+
+  /// Non-empty on the creating side, which unlinks the name on destruction.
+  std::string owned_name_;
+
+  /// Ring this side produces into and ring it consumes from; which is which
+  /// depends on whether the channel was created or attached.
+  std::vector<shm_ring> rings_;
+};
+
+} // namespace broker::detail
+
+#endif // BROKER_WINDOWS
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "broker/detail/assert.hh"
+
+namespace broker::detail {
+
+/// A vector that stores up to `N` elements inline before falling back to the
+/// heap. Hot paths that build many short-lived sequences (e.g., per-message
+/// dispatch buffers) use this type to avoid hitting the allocator for the
+/// common small case. The interface covers the subset of `std::vector` that
+/// Broker uses internally.
+template <class T, size_t N>
+class small_vector {
+public:
+  // -- member types -----------------------------------------------------------
+
+  using value_type = T;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  small_vector() noexcept : data_(inline_data()), size_(0), capacity_(N) {
+    // nop
+  }
+
+  small_vector(std::initializer_list<T> xs) : small_vector() {
+    reserve(xs.size());
+    for (auto& x : xs)
+      emplace_back(x);
+  }
+
+  small_vector(const small_vector& other) : small_vector() {
+    reserve(other.size_);
+    for (auto& x : other)
+      emplace_back(x);
+  }
+
+  small_vector(small_vector&& other) noexcept(
+    std::is_nothrow_move_constructible<T>::value)
+    : small_vector() {
+    move_assign(std::move(other));
+  }
+
+  small_vector& operator=(const small_vector& other) {
+    if (this != &other) {
+      clear();
+      reserve(other.size_);
+      for (auto& x : other)
+        emplace_back(x);
+    }
+    return *this;
+  }
+
+  small_vector& operator=(small_vector&& other) noexcept(
+    std::is_nothrow_move_constructible<T>::value) {
+    if (this != &other) {
+      clear();
+      move_assign(std::move(other));
+    }
+    return *this;
+  }
+
+  ~small_vector() {
+    clear();
+    if (!inlined())
+      ::operator delete(data_);
+  }
+
+  // -- element access ---------------------------------------------------------
+
+  reference operator[](size_type index) {
+    BROKER_ASSERT(index < size_);
+    return data_[index];
+  }
+
+  const_reference operator[](size_type index) const {
+    BROKER_ASSERT(index < size_);
+    return data_[index];
+  }
+
+  reference front() {
+    return (*this)[0];
+  }
+
+  const_reference front() const {
+    return (*this)[0];
+  }
+
+  reference back() {
+    return (*this)[size_ - 1];
+  }
+
+  const_reference back() const {
+    return (*this)[size_ - 1];
+  }
+
+  pointer data() noexcept {
+    return data_;
+  }
+
+  const_pointer data() const noexcept {
+    return data_;
+  }
+
+  // -- iterators --------------------------------------------------------------
+
+  iterator begin() noexcept {
+    return data_;
+  }
+
+  const_iterator begin() const noexcept {
+    return data_;
+  }
+
+  iterator end() noexcept {
+    return data_ + size_;
+  }
+
+  const_iterator end() const noexcept {
+    return data_ + size_;
+  }
+
+  // -- capacity ---------------------------------------------------------------
+
+  [[nodiscard]] bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+  size_type size() const noexcept {
+    return size_;
+  }
+
+  size_type capacity() const noexcept {
+    return capacity_;
+  }
+
+  /// Returns whether elements currently reside in the inline buffer.
+  [[nodiscard]] bool inlined() const noexcept {
+    return data_ == inline_data();
+  }
+
+  void reserve(size_type new_capacity) {
+    if (new_capacity > capacity_)
+      grow(new_capacity);
+  }
+
+  // -- modifiers --------------------------------------------------------------
+
+  void clear() noexcept {
+    for (size_type i = 0; i < size_; ++i)
+      data_[i].~T();
+    size_ = 0;
+  }
+
+  void push_back(const T& x) {
+    emplace_back(x);
+  }
+
+  void push_back(T&& x) {
+    emplace_back(std::move(x));
+  }
+
+  template <class... Ts>
+  reference emplace_back(Ts&&... xs) {
+    if (size_ == capacity_)
+      grow(capacity_ * 2);
+    auto ptr = new (data_ + size_) T(std::forward<Ts>(xs)...);
+    ++size_;
+    return *ptr;
+  }
+
+  void pop_back() {
+    BROKER_ASSERT(size_ > 0);
+    data_[--size_].~T();
+  }
+
+  iterator erase(const_iterator pos) {
+    BROKER_ASSERT(pos >= begin() && pos < end());
+    auto i = const_cast<iterator>(pos);
+    std::move(i + 1, end(), i);
+    pop_back();
+    return i;
+  }
+
+private:
+  pointer inline_data() noexcept {
+    return reinterpret_cast<pointer>(buf_);
+  }
+
+  const_pointer inline_data() const noexcept {
+    return reinterpret_cast<const_pointer>(buf_);
+  }
+
+  void grow(size_type new_capacity) {
+    new_capacity = std::max(new_capacity, capacity_ * 2);
+    auto new_data
+      = static_cast<pointer>(::operator new(sizeof(T) * new_capacity));
+    for (size_type i = 0; i < size_; ++i) {
+      new (new_data + i) T(std::move(data_[i]));
+      data_[i].~T();
+    }
+    if (!inlined())
+      ::operator delete(data_);
+    data_ = new_data;
+    capacity_ = new_capacity;
+  }
+
+  void move_assign(small_vector&& other) {
+    if (other.inlined()) {
+      reserve(other.size_);
+      for (auto& x : other)
+        emplace_back(std::move(x));
+      other.clear();
+    } else {
+      if (!inlined())
+        ::operator delete(data_);
+      data_ = other.data_;
+      size_ = other.size_;
+      capacity_ = other.capacity_;
+      other.data_ = other.inline_data();
+      other.size_ = 0;
+      other.capacity_ = N;
+    }
+  }
+
+  pointer data_;
+  size_type size_;
+  size_type capacity_;
+  alignas(T) std::byte buf_[sizeof(T) * N];
+};
+
+/// @relates small_vector
+template <class T, size_t N>
+bool operator==(const small_vector<T, N>& xs, const small_vector<T, N>& ys) {
+  return std::equal(xs.begin(), xs.end(), ys.begin(), ys.end());
+}
+
+/// @relates small_vector
+template <class T, size_t N>
+bool operator!=(const small_vector<T, N>& xs, const small_vector<T, N>& ys) {
+  return !(xs == ys);
+}
+
+} // namespace broker::detail
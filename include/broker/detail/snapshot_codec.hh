@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "broker/expected.hh"
+#include "broker/snapshot.hh"
+
+namespace broker::detail {
+
+class preset_dictionary_set;
+class string_dictionary;
+struct preset_dictionary;
+
+// Codec for snapshot chunks during clone bootstrapping. Store values share
+// massive structure across entries (identical table schemas, repeated
+// strings), so entries encode through the dictionary-aware data codec with
+// one dictionary per transfer: a string that appeared anywhere earlier in
+// the stream travels as a two-byte slot reference in every later chunk. The
+// framed payload optionally deflates on top of that when Broker ships with
+// zlib support. Like the codec itself, the format is Broker-private: a
+// compressed frame only decodes on a receiver that was also built with zlib.
+
+/// Appends one encoded snapshot chunk to `buf`. Both sides must feed their
+/// dictionary every chunk of the transfer in transmission order; see
+/// broker/detail/string_dictionary.hh. When `compress` is set, the payload
+/// deflates if the build has zlib support and the chunk is large enough for
+/// compression to pay off; otherwise the flag has no effect. Passing a
+/// `preset` additionally primes the compressor with a trained dictionary;
+/// see broker/detail/preset_dictionary.hh.
+void encode_snapshot(const snapshot& ss, bool compress,
+                     std::vector<std::byte>& buf, string_dictionary& dict,
+                     const preset_dictionary* preset = nullptr);
+
+/// Decodes a chunk previously produced by `encode_snapshot`, applying the
+/// mirrored table updates to `dict`. Frames deflated against a preset
+/// dictionary resolve it in `presets` by checksum. Returns
+/// `ec::invalid_data` for truncated or malformed input, for compressed
+/// frames in builds without zlib support and for preset frames whose
+/// dictionary is missing from `presets`.
+expected<snapshot> decode_snapshot(const std::byte* first, size_t size,
+                                   string_dictionary& dict,
+                                   const preset_dictionary_set* presets
+                                   = nullptr);
+
+/// @copydoc decode_snapshot
+expected<snapshot> decode_snapshot(const std::vector<std::byte>& buf,
+                                   string_dictionary& dict,
+                                   const preset_dictionary_set* presets
+                                   = nullptr);
+
+} // namespace broker::detail
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "broker/detail/page_allocation.hh"
+
+namespace broker::detail {
+
+/// An unbounded single-producer, single-consumer FIFO. The queue consists of
+/// a linked list of fixed-size blocks. Producer and consumer synchronize via
+/// per-block atomic indices only: the producer appends a new (larger) block
+/// when the current one fills up and the consumer reclaims fully drained
+/// blocks. Hence, `push` is wait-free except for the occasional allocation
+/// and neither side ever takes a lock.
+template <class T>
+class spsc_queue {
+public:
+  explicit spsc_queue(size_t initial_block_size = 64)
+    : head_block_(new block(initial_block_size, -1)),
+      tail_block_(head_block_) {
+    // nop
+  }
+
+  /// Places storage allocated from now on near the given NUMA node. Intended
+  /// as a locality hint when the consumer runs pinned to a known node; the
+  /// already existing initial block stays where it is. May only be called
+  /// before the queue gains a second thread.
+  void set_numa_node(int node) noexcept {
+    numa_node_ = node;
+  }
+
+  spsc_queue(const spsc_queue&) = delete;
+
+  spsc_queue& operator=(const spsc_queue&) = delete;
+
+  ~spsc_queue() {
+    auto blk = head_block_;
+    while (blk != nullptr) {
+      auto next = blk->next.load(std::memory_order_relaxed);
+      auto head = blk->head.load(std::memory_order_relaxed);
+      auto tail = blk->tail.load(std::memory_order_relaxed);
+      for (auto index = head; index < tail; ++index)
+        blk->ptr(index)->~T();
+      delete blk;
+      blk = next;
+    }
+  }
+
+  /// Appends `x` to the queue. May only be called from the producer thread.
+  void push(T x) {
+    auto blk = tail_block_;
+    auto tail = blk->tail.load(std::memory_order_relaxed);
+    if (tail == blk->capacity) {
+      auto next = new block(blk->capacity * 2, numa_node_);
+      new (next->ptr(0)) T(std::move(x));
+      next->tail.store(1, std::memory_order_relaxed);
+      // Publishes the new block and its first element to the consumer.
+      blk->next.store(next, std::memory_order_release);
+      tail_block_ = next;
+      return;
+    }
+    new (blk->ptr(tail)) T(std::move(x));
+    blk->tail.store(tail + 1, std::memory_order_release);
+  }
+
+  /// Moves the oldest element into `x`. May only be called from the consumer
+  /// thread. Returns `false` if the queue appears empty.
+  bool pop(T& x) {
+    auto blk = head_block_;
+    for (;;) {
+      auto head = blk->head.load(std::memory_order_relaxed);
+      if (head < blk->tail.load(std::memory_order_acquire)) {
+        auto element = blk->ptr(head);
+        x = std::move(*element);
+        element->~T();
+        blk->head.store(head + 1, std::memory_order_relaxed);
+        return true;
+      }
+      if (head < blk->capacity) {
+        // The producer still fills this block, so the queue is empty.
+        return false;
+      }
+      auto next = blk->next.load(std::memory_order_acquire);
+      if (next == nullptr)
+        return false;
+      delete blk;
+      head_block_ = next;
+      blk = next;
+    }
+  }
+
+  /// Invokes `f(ptr, n)` for contiguous runs of queued elements, oldest run
+  /// first, and destroys each run after the callback returns. The pointer
+  /// borrows the queue's storage, so `f` may read or move individual elements
+  /// but must not retain the pointer. Consumes at most `max_n` elements in
+  /// total. May only be called from the consumer thread. Returns the number
+  /// of consumed elements.
+  template <class F>
+  size_t drain(F f, size_t max_n) {
+    size_t consumed = 0;
+    auto blk = head_block_;
+    while (consumed < max_n) {
+      auto head = blk->head.load(std::memory_order_relaxed);
+      auto tail = blk->tail.load(std::memory_order_acquire);
+      if (head < tail) {
+        auto n = std::min(tail - head, max_n - consumed);
+        f(blk->ptr(head), n);
+        for (auto index = head; index < head + n; ++index)
+          blk->ptr(index)->~T();
+        blk->head.store(head + n, std::memory_order_relaxed);
+        consumed += n;
+        continue;
+      }
+      if (head < blk->capacity) {
+        // The producer still fills this block, so the queue is empty.
+        break;
+      }
+      auto next = blk->next.load(std::memory_order_acquire);
+      if (next == nullptr)
+        break;
+      delete blk;
+      head_block_ = next;
+      blk = next;
+    }
+    return consumed;
+  }
+
+  /// Moves up to `max_n` of the oldest elements into `out`. May only be
+  /// called from the consumer thread. Returns the number of moved elements.
+  size_t pop_bulk(T* out, size_t max_n) {
+    return drain(
+      [&out](T* items, size_t n) { out = std::move(items, items + n, out); },
+      max_n);
+  }
+
+private:
+  struct block {
+    block(size_t cap, int numa_node) : capacity(cap) {
+      auto num_bytes = cap * sizeof(T);
+      if (numa_node >= 0) {
+        // Page-granular storage, so the NUMA binding covers exactly this
+        // block and nothing else.
+        auto ps = detail::page_size();
+        num_bytes = (num_bytes + ps - 1) & ~(ps - 1);
+        alignment = std::align_val_t{ps};
+        storage = static_cast<std::byte*>(::operator new(num_bytes, alignment));
+        detail::bind_to_numa_node(storage, num_bytes, numa_node);
+      } else {
+        alignment = std::align_val_t{alignof(T)};
+        storage = static_cast<std::byte*>(::operator new(num_bytes, alignment));
+      }
+    }
+
+    ~block() {
+      ::operator delete(storage, alignment);
+    }
+
+    T* ptr(size_t index) noexcept {
+      return reinterpret_cast<T*>(storage + index * sizeof(T));
+    }
+
+    const size_t capacity;
+
+    /// Index of the next element to read. Written by the consumer only.
+    std::atomic<size_t> head{0};
+
+    /// Index of the next free slot. Written by the producer only.
+    std::atomic<size_t> tail{0};
+
+    /// Successor block, set once by the producer when this block fills up.
+    std::atomic<block*> next{nullptr};
+
+    std::byte* storage;
+
+    /// Alignment used for `storage`; required for releasing it again.
+    std::align_val_t alignment;
+  };
+
+  /// Oldest block. Accessed by the consumer only.
+  block* head_block_;
+
+  /// Newest block. Accessed by the producer only.
+  block* tail_block_;
+
+  /// Optional NUMA placement hint for new blocks; see `set_numa_node`.
+  int numa_node_ = -1;
+};
+
+} // namespace broker::detail
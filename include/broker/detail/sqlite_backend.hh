@@ -14,6 +14,20 @@ public:
   /// Required parameters:
   ///   - `path`: a `std::string` representing the location of the database on
   ///             the filesystem.
+  /// Optional parameters:
+  ///   - `journal-mode`: a `std::string` passed to `pragma journal_mode`.
+  ///             Defaults to `WAL`, which appends commits to a write-ahead
+  ///             log instead of rewriting a rollback journal per commit.
+  ///   - `synchronous`: a `std::string` passed to `pragma synchronous`.
+  ///             Defaults to `normal`, which defers the fsync to WAL
+  ///             checkpoints, so mutations get acknowledged before the data
+  ///             hits the disk. Use `full` for the strongest durability or
+  ///             `off` to skip syncing entirely.
+  ///   - `batch-size`: a `count` denoting how many mutations to group into
+  ///             one transaction before committing. Defaults to 1, i.e., one
+  ///             implicit transaction per mutation. Larger values amortize
+  ///             the per-commit overhead at the cost of losing up to
+  ///             `batch-size - 1` acknowledged mutations on a crash.
   sqlite_backend(backend_options opts = backend_options{});
 
   ~sqlite_backend();
@@ -29,10 +43,15 @@ public:
   expected<void> subtract(const data& key, const data& value,
                           std::optional<timestamp> expiry) override;
 
+  expected<void>
+  bulk_insert(std::vector<std::pair<data, data>> entries) override;
+
   expected<void> erase(const data& key) override;
 
   expected<void> clear() override;
 
+  expected<void> compact() override;
+
   expected<bool> expire(const data& key, timestamp current_time) override;
 
   expected<data> get(const data& key) const override;
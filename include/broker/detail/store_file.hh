@@ -0,0 +1,52 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "broker/data.hh"
+#include "broker/expected.hh"
+
+namespace broker::detail {
+
+/// Streams key-value pairs into a compact binary file for bulk export of a
+/// data store. The format is a fixed header followed by one varint-framed
+/// codec encoding per key and value, so readers never have to materialize
+/// more than one entry at a time. Expiry times are not part of the format,
+/// mirroring the snapshot encoding used for clone synchronization.
+class store_file_writer {
+public:
+  /// Creates or truncates the file at `path` and writes the header.
+  expected<void> open(const std::string& path);
+
+  /// Appends one key-value pair.
+  expected<void> write(const data& key, const data& value);
+
+  /// Flushes buffered entries and closes the file.
+  expected<void> close();
+
+private:
+  std::ofstream out_;
+  std::vector<std::byte> buf_;
+  std::vector<std::byte> scratch_;
+};
+
+/// Reads files produced by `store_file_writer` one entry at a time.
+class store_file_reader {
+public:
+  /// Opens the file at `path` and verifies the header.
+  expected<void> open(const std::string& path);
+
+  /// Reads the next entry into `key` and `value`.
+  /// @returns `true` on success, `false` on a clean end of file, or an error
+  /// for I/O failures and malformed input.
+  expected<bool> read(data& key, data& value);
+
+private:
+  expected<void> read_blob(std::vector<std::byte>& buf);
+
+  std::ifstream in_;
+  std::vector<std::byte> buf_;
+};
+
+} // namespace broker::detail
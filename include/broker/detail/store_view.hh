@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "broker/data.hh"
+
+namespace broker {
+namespace detail {
+
+/// A read-only view of a master store for same-process readers. The master
+/// actor publishes immutable snapshots of its content into the view and
+/// readers pick up the most recent snapshot with a single atomic load, i.e.,
+/// lookups are wait-free and involve no messaging. Readers observe the store
+/// with a bounded delay (`defaults::store::tick_interval`), since the master
+/// batches refreshes instead of publishing after every mutation.
+class store_view {
+public:
+  using map_type = std::unordered_map<data, data>;
+
+  using map_ptr = std::shared_ptr<const map_type>;
+
+  store_view();
+
+  /// Returns the most recently published snapshot. Never returns `nullptr`.
+  map_ptr load() const noexcept;
+
+  /// Publishes a new snapshot, replacing the previous one. Readers holding
+  /// the old snapshot keep it alive until they drop it.
+  void publish(map_type xs);
+
+  /// Returns whether any reader ever attached to this view. Allows the
+  /// master to skip refreshes for views nobody looks at.
+  bool active() const noexcept {
+    return active_.load(std::memory_order_relaxed);
+  }
+
+  /// Creates a view for the master store `name` and registers it for
+  /// `lookup`, replacing any previous registration under the same name.
+  static std::shared_ptr<store_view> make(const std::string& name);
+
+  /// Returns the view of the in-process master store `name`, or `nullptr` if
+  /// no such master exists in this process. Marks the view as active.
+  static std::shared_ptr<store_view> lookup(const std::string& name);
+
+private:
+  map_ptr current_;
+
+  std::atomic<bool> active_;
+};
+
+} // namespace detail
+} // namespace broker
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace broker::detail {
+
+/// A streaming string table for the dictionary-compressed wire encoding (see
+/// broker/detail/data_codec.hh). Log-style traffic repeats the same field
+/// names, enum labels and topic strings endlessly; once a string occupies a
+/// slot, references to the slot replace the literal on the wire.
+///
+/// Both ends of a connection maintain a dictionary each and keep them in
+/// sync without negotiation: the encoder inserts a string when it emits its
+/// literal, the decoder inserts it when it reads that literal, and both
+/// sides apply the same least-recently-used eviction. Slots stay valid
+/// across evictions because eviction reuses the slot of the displaced
+/// string. Synchronization only holds when both sides feed the dictionary
+/// every message of the connection in transmission order.
+class string_dictionary {
+public:
+  /// Invalid slot value returned by `find`.
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+  /// Default number of slots. Slot references stay within two wire bytes
+  /// up to 8192 entries.
+  static constexpr size_t default_capacity = 1024;
+
+  /// Strings below this size take fewer bytes as literals than as
+  /// references.
+  static constexpr size_t min_length = 2;
+
+  /// Upper bound for dictionary entries, keeping the table from pinning
+  /// large one-off payload strings in memory.
+  static constexpr size_t max_length = 120;
+
+  explicit string_dictionary(size_t capacity = default_capacity);
+
+  /// Returns whether strings of `size` bytes enter the dictionary at all.
+  static constexpr bool eligible(size_t size) noexcept {
+    return size >= min_length && size <= max_length;
+  }
+
+  /// Returns the slot holding `str` and marks it as recently used, or
+  /// `npos`.
+  size_t find(const std::string& str) noexcept;
+
+  /// Assigns a slot to `str`, evicting the least recently used entry when
+  /// the table is full.
+  /// @pre `eligible(str.size())` and `find(str) == npos`
+  /// @returns the assigned slot.
+  size_t insert(const std::string& str);
+
+  /// Returns the string in `slot` and marks it as recently used, or
+  /// `nullptr` for empty or out-of-range slots.
+  const std::string* lookup(size_t slot) noexcept;
+
+  /// Returns the number of occupied slots.
+  size_t size() const noexcept {
+    return index_.size();
+  }
+
+  /// Returns the number of slots.
+  size_t capacity() const noexcept {
+    return capacity_;
+  }
+
+private:
+  struct entry {
+    std::string str;
+    size_t prev = npos;
+    size_t next = npos;
+  };
+
+  /// Removes `slot` from the LRU list.
+  void unlink(size_t slot) noexcept;
+
+  /// Prepends `slot` to the LRU list as the most recently used entry.
+  void push_front(size_t slot) noexcept;
+
+  /// Occupied slots, indexed by wire reference.
+  std::vector<entry> slots_;
+
+  /// Maps strings to their slot.
+  std::unordered_map<std::string, size_t> index_;
+
+  /// Most recently used slot.
+  size_t head_ = npos;
+
+  /// Least recently used slot, i.e., the next eviction victim.
+  size_t tail_ = npos;
+
+  size_t capacity_;
+};
+
+} // namespace broker::detail
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include "broker/snapshot.hh"
+#include "broker/subnet.hh"
+
+namespace broker::detail {
+
+/// Longest-prefix-match index over subnet-valued store keys. Threat-intel
+/// stores key CIDR blocks by @ref subnet, but exact-match lookups force
+/// clients to probe every prefix length per address. This index arranges all
+/// subnet keys in a binary trie over the (v4-mapped) network bits, so the
+/// master answers "which stored subnet best covers this address" in a single
+/// walk. The master maintains the trie incrementally on each mutation.
+class subnet_index {
+public:
+  subnet_index();
+
+  subnet_index(subnet_index&&) noexcept;
+
+  subnet_index& operator=(subnet_index&&) noexcept;
+
+  ~subnet_index();
+
+  /// Adds `key` to the trie. Inserting the same subnet twice is a no-op.
+  void insert(const subnet& key);
+
+  /// Removes `key` from the trie, pruning now-empty branches.
+  void erase(const subnet& key);
+
+  /// Drops all entries.
+  void clear();
+
+  /// Re-populates the trie from a full snapshot of the store, skipping
+  /// non-subnet keys.
+  void rebuild(const broker::snapshot& ss);
+
+  /// Returns the longest stored prefix containing `addr`, or `std::nullopt`
+  /// if no stored subnet covers the address.
+  std::optional<subnet> lookup(const address& addr) const;
+
+  /// Returns the number of subnets in the trie.
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  struct node;
+
+private:
+  std::unique_ptr<node> root_;
+  size_t size_ = 0;
+};
+
+} // namespace broker::detail
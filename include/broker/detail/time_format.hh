@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+#include "broker/time.hh"
+
+namespace broker {
+namespace detail {
+
+/// Maximum number of characters that @ref format_iso8601 writes.
+constexpr size_t max_iso8601_chars = 29; // "2262-04-11T23:47:16.854775807"
+
+/// Maximum number of characters that @ref format_timespan writes.
+constexpr size_t max_timespan_chars = 22; // "-9223372036854775808ns"
+
+/// Renders the ISO 8601 representation of `t` in UTC into `out`, e.g.,
+/// "2026-08-31T12:34:56.789". The formatter writes two digits at a time from
+/// a lookup table instead of going through chrono/stdio. Fractional seconds
+/// appear only when nonzero, trimmed to millisecond, microsecond or
+/// nanosecond width.
+/// @param out A buffer with room for at least @ref max_iso8601_chars
+///            characters.
+/// @returns The number of characters written (no null terminator).
+size_t format_iso8601(timestamp t, char* out) noexcept;
+
+/// Renders `s` as a nanosecond count with "ns" suffix into `out`, e.g.,
+/// "42ns", using the same digit-pair kernel as @ref format_iso8601.
+/// @param out A buffer with room for at least @ref max_timespan_chars
+///            characters.
+/// @returns The number of characters written (no null terminator).
+size_t format_timespan(timespan s, char* out) noexcept;
+
+} // namespace detail
+} // namespace broker
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "broker/detail/assert.hh"
+#include "broker/time.hh"
+
+namespace broker::detail {
+
+/// A hierarchical timing wheel for managing a large number of timeouts with
+/// O(1) insertion and amortized O(1) firing. Time advances in fixed-size
+/// ticks. Each level covers the range of the level below it times the number
+/// of slots, with entries cascading down a level whenever the wheel below
+/// wraps around. Entries past the range of the last level park in an overflow
+/// list until the top level wraps.
+template <class Key>
+class timing_wheel {
+public:
+  static constexpr size_t num_levels = 4;
+
+  static constexpr size_t num_slots = 64;
+
+  explicit timing_wheel(timestamp start = timestamp{},
+                        timespan tick = std::chrono::milliseconds(50))
+    : start_(start), tick_(tick) {
+    BROKER_ASSERT(tick.count() > 0);
+  }
+
+  timing_wheel(timing_wheel&&) = default;
+  timing_wheel(const timing_wheel&) = default;
+  timing_wheel& operator=(timing_wheel&&) = default;
+  timing_wheel& operator=(const timing_wheel&) = default;
+
+  /// Schedules `key` to fire at time `when`. Entries with a due time in the
+  /// past fire on the next call to `advance`.
+  void insert(timestamp when, Key key) {
+    emplace(entry{when, std::move(key)});
+    ++size_;
+  }
+
+  /// Moves the keys of all entries due at `now` into `out` and advances the
+  /// wheel. Fired entries leave the wheel.
+  void advance(timestamp now, std::vector<Key>& out) {
+    auto target = ticks_at(now);
+    while (current_ < target) {
+      if (size_ == 0) {
+        // Nothing can fire, so skip ahead in one step.
+        current_ = target;
+        return;
+      }
+      if (level0_size_ == 0) {
+        // Nothing can fire before the next cascade point, so skip ahead.
+        auto next_cascade = ((current_ >> shift) + 1) << shift;
+        current_ = std::min(target, next_cascade - 1);
+        if (current_ == target)
+          return;
+      }
+      ++current_;
+      if ((current_ & mask) == 0)
+        cascade();
+      auto& slot = levels_[0][current_ & mask];
+      level0_size_ -= slot.size();
+      for (auto& e : slot) {
+        out.emplace_back(std::move(e.key));
+        --size_;
+      }
+      slot.clear();
+    }
+  }
+
+  /// Returns the number of pending entries.
+  size_t size() const noexcept {
+    return size_;
+  }
+
+  /// Returns whether no entries are pending.
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+private:
+  static constexpr size_t shift = 6; // log2(num_slots)
+
+  static constexpr uint64_t mask = num_slots - 1;
+
+  struct entry {
+    timestamp when;
+    Key key;
+  };
+
+  uint64_t ticks_at(timestamp t) const {
+    if (t <= start_)
+      return 0;
+    return static_cast<uint64_t>((t - start_) / tick_);
+  }
+
+  /// Returns the first tick with a time greater or equal to `t`, so entries
+  /// never fire before their due time.
+  uint64_t due_tick(timestamp t) const {
+    if (t <= start_)
+      return 0;
+    return static_cast<uint64_t>((t - start_ + tick_ - timespan{1}) / tick_);
+  }
+
+  void emplace(entry e) {
+    auto t = due_tick(e.when);
+    if (t <= current_)
+      t = current_ + 1;
+    auto delta = t - current_;
+    for (size_t level = 0; level < num_levels; ++level) {
+      if (delta < (uint64_t{1} << (shift * (level + 1)))) {
+        levels_[level][(t >> (shift * level)) & mask].emplace_back(
+          std::move(e));
+        if (level == 0)
+          ++level0_size_;
+        return;
+      }
+    }
+    overflow_.emplace_back(std::move(e));
+  }
+
+  /// Moves entries from higher levels (and eventually the overflow list) back
+  /// into the range of the wheels below. Called whenever level 0 wraps.
+  void cascade() {
+    for (size_t level = 1; level < num_levels; ++level) {
+      auto index = (current_ >> (shift * level)) & mask;
+      auto pending = std::move(levels_[level][index]);
+      levels_[level][index].clear();
+      for (auto& e : pending)
+        emplace(std::move(e));
+      if (index != 0)
+        return;
+    }
+    auto pending = std::move(overflow_);
+    overflow_.clear();
+    for (auto& e : pending)
+      emplace(std::move(e));
+  }
+
+  using wheel = std::array<std::vector<entry>, num_slots>;
+
+  std::array<wheel, num_levels> levels_;
+  std::vector<entry> overflow_;
+  timestamp start_;
+  timespan tick_;
+  uint64_t current_ = 0;
+  size_t size_ = 0;
+  size_t level0_size_ = 0;
+};
+
+} // namespace broker::detail
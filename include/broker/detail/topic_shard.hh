@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "broker/topic.hh"
+
+namespace broker::detail {
+
+/// Maps `t` to a shard index in `[0, num_shards)`. The mapping uses FNV-1a on
+/// the raw topic string and thus remains stable across processes and
+/// platforms, so that all parties agree on the shard assignment for a topic.
+/// @pre `num_shards > 0`
+inline size_t topic_shard(const topic& t, size_t num_shards) noexcept {
+  uint64_t digest = 0xCBF29CE484222325ull;
+  for (auto ch : t.string()) {
+    digest ^= static_cast<unsigned char>(ch);
+    digest *= 0x100000001B3ull;
+  }
+  return static_cast<size_t>(digest % num_shards);
+}
+
+} // namespace broker::detail
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "broker/config.hh"
+
+#ifndef BROKER_WINDOWS
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "broker/detail/native_socket.hh"
+#include "broker/detail/peer_protocol.hh"
+#include "broker/expected.hh"
+#include "broker/fwd.hh"
+
+namespace broker::detail {
+
+/// The best-effort datagram lane of the native peering transport. Each
+/// datagram carries exactly one frame in the wire format from
+/// broker/detail/peer_protocol.hh, so receivers reuse the regular frame
+/// decoder. The lane provides neither ordering nor retransmission nor flow
+/// control: when the socket buffer is full, `send` drops the message and
+/// counts the drop instead of blocking. This keeps bulk telemetry from ever
+/// exerting backpressure on the reliable stream lanes.
+///
+/// The lane only opens between consenting peers, i.e., after both handshakes
+/// on the reliable connection announced `peer_feature_datagram` and a nonzero
+/// datagram port.
+class udp_channel {
+public:
+  /// A frame as delivered to the caller of `read` or `try_read`.
+  struct frame {
+    frame_type type;
+    std::vector<std::byte> payload;
+  };
+
+  /// Largest payload accepted for a single datagram. Stays below the usual
+  /// 64k UDP limit with room for the frame header and IP/UDP overhead.
+  static constexpr size_t max_payload = 60000;
+
+  /// Counters for lane statistics, for per-peer telemetry.
+  struct statistics {
+    /// Datagrams handed to the kernel.
+    uint64_t sent = 0;
+
+    /// Messages dropped because the socket buffer was full.
+    uint64_t dropped = 0;
+
+    /// Datagrams received and decoded.
+    uint64_t received = 0;
+
+    /// Datagrams discarded as undecodable or truncated.
+    uint64_t invalid = 0;
+  };
+
+  /// Creates a channel bound to `port` on all interfaces; 0 picks an
+  /// ephemeral port. The channel sends nothing until `connect` succeeds.
+  static expected<udp_channel> make(uint16_t port = 0);
+
+  udp_channel(udp_channel&& other) noexcept;
+
+  udp_channel& operator=(udp_channel&& other) noexcept;
+
+  udp_channel(const udp_channel&) = delete;
+
+  udp_channel& operator=(const udp_channel&) = delete;
+
+  /// Closes the socket.
+  ~udp_channel();
+
+  /// Sets the destination for outgoing datagrams to the port the peer
+  /// announced in its handshake.
+  expected<void> connect(const std::string& host, uint16_t port);
+
+  /// Sends one frame as a single datagram, never blocking. A full socket
+  /// buffer drops the message silently (counted in `stats().dropped`);
+  /// payloads above `max_payload` return `ec::invalid_data`.
+  expected<void> send(frame_type type, const std::byte* payload, size_t size);
+
+  /// @copydoc send
+  expected<void> send(frame_type type, const std::vector<std::byte>& payload) {
+    return send(type, payload.data(), payload.size());
+  }
+
+  /// Blocks until a datagram arrives or `timeout_ms` elapses (-1 blocks
+  /// indefinitely). Returns `ec::request_timeout` on timeout. Undecodable
+  /// datagrams are dropped and the wait continues.
+  expected<frame> read(int timeout_ms = -1);
+
+  /// Returns the next decodable datagram without blocking, or
+  /// `ec::request_timeout` if none is queued.
+  expected<frame> try_read();
+
+  /// Returns the port the channel is bound to.
+  uint16_t local_port() const noexcept {
+    return local_port_;
+  }
+
+  /// Returns the lane statistics.
+  const statistics& stats() const noexcept {
+    return stats_;
+  }
+
+  /// Returns whether the channel owns an open socket.
+  bool valid() const noexcept {
+    return fd_ != invalid_native_socket;
+  }
+
+private:
+  udp_channel() = default;
+
+  /// Receives and decodes one datagram, waiting at most `timeout_ms` (0
+  /// polls, -1 blocks indefinitely).
+  expected<frame> read_datagram(int timeout_ms);
+
+  native_socket fd_ = invalid_native_socket;
+
+  /// Port the socket is bound to.
+  uint16_t local_port_ = 0;
+
+  /// Lane statistics.
+  statistics stats_;
+
+  /// Scratch buffer for datagram assembly.
+  std::vector<std::byte> buf_;
+};
+
+} // namespace broker::detail
+
+#endif // BROKER_WINDOWS
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "broker/config.hh"
+#include "broker/detail/native_socket.hh"
+#include "broker/expected.hh"
+#include "broker/fwd.hh"
+
+#ifdef BROKER_HAVE_IO_URING
+
+namespace broker::detail {
+
+/// A thin wrapper around the raw io_uring system calls (no liburing
+/// dependency) for driving many native-transport sockets from one thread.
+/// Instead of one syscall per read or write, callers stage any number of
+/// operations in the submission queue and flush them with a single
+/// `io_uring_enter`; completions drain in batches from the completion ring
+/// without entering the kernel at all. Receive buffers may be registered
+/// up front, allowing the kernel to pin them once and skip the per-call
+/// mapping cost when filling the deserialization scratch space.
+class uring_loop {
+public:
+  /// Result of one completed operation.
+  struct completion {
+    /// The token passed to the matching `prep_*` call.
+    uint64_t user_data;
+
+    /// Bytes transferred, accepted socket, or negative errno.
+    int32_t result;
+
+    /// Kernel completion flags; `more()` checks for further multishot hits.
+    uint32_t flags;
+
+    /// Returns whether a multishot operation stays armed after this entry.
+    bool more() const noexcept;
+  };
+
+  uring_loop(uring_loop&& other) noexcept;
+
+  uring_loop& operator=(uring_loop&& other) noexcept;
+
+  uring_loop(const uring_loop&) = delete;
+
+  uring_loop& operator=(const uring_loop&) = delete;
+
+  ~uring_loop();
+
+  /// Creates a ring with space for `entries` in-flight operations. Returns
+  /// `ec::unspecified` when the kernel lacks io_uring support.
+  static expected<uring_loop> make(unsigned entries);
+
+  /// Pins `buffers` in the kernel for `prep_recv_fixed`. May only be called
+  /// once and before any fixed-buffer submission.
+  expected<void> register_buffers(
+    const std::vector<std::pair<void*, size_t>>& buffers);
+
+  /// Stages a receive into caller-owned memory.
+  /// @returns `false` when the submission queue is full.
+  bool prep_recv(native_socket fd, void* buf, size_t size, uint64_t user_data);
+
+  /// Stages a receive into the registered buffer at `index`.
+  /// @returns `false` when the submission queue is full.
+  bool prep_recv_fixed(native_socket fd, uint16_t index, void* buf,
+                       size_t size, uint64_t user_data);
+
+  /// Stages a send of caller-owned memory that must stay valid until the
+  /// matching completion arrives.
+  /// @returns `false` when the submission queue is full.
+  bool prep_send(native_socket fd, const void* buf, size_t size,
+                 uint64_t user_data);
+
+  /// Stages a (multishot, where supported) accept on a listening socket.
+  /// Each completion carries one connected socket in `result`.
+  /// @returns `false` when the submission queue is full.
+  bool prep_accept(native_socket fd, uint64_t user_data);
+
+  /// Flushes all staged operations to the kernel in one syscall.
+  /// @returns the number of submitted entries.
+  expected<size_t> submit();
+
+  /// Submits staged operations and blocks until at least `min_complete`
+  /// operations finished, then appends all available completions to `out`.
+  /// @returns the number of appended completions.
+  expected<size_t> run(std::vector<completion>& out, size_t min_complete = 1);
+
+  /// Appends available completions to `out` without entering the kernel.
+  size_t poll(std::vector<completion>& out);
+
+private:
+  uring_loop() = default;
+
+  /// Acquires the next free submission entry, or `nullptr` if none is left.
+  void* next_sqe(uint8_t opcode, native_socket fd, uint64_t user_data);
+
+  /// Hands `to_submit` staged entries to the kernel.
+  expected<size_t> enter(unsigned to_submit, unsigned min_complete,
+                         unsigned flags);
+
+  int ring_fd_ = -1;
+
+  /// Shared submission/completion ring mapping.
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+
+  /// Submission entry array mapping.
+  void* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  /// Cached ring geometry and offsets; see io_uring_setup(2).
+  uint32_t* sq_head_ = nullptr;
+  uint32_t* sq_tail_ = nullptr;
+  uint32_t sq_mask_ = 0;
+  uint32_t* sq_array_ = nullptr;
+  uint32_t* cq_head_ = nullptr;
+  uint32_t* cq_tail_ = nullptr;
+  uint32_t cq_mask_ = 0;
+  void* cqes_ = nullptr;
+
+  /// Entries staged since the last `submit`.
+  unsigned staged_ = 0;
+
+  /// Whether the kernel supports multishot accept.
+  bool multishot_accept_ = false;
+};
+
+} // namespace broker::detail
+
+#endif // BROKER_HAVE_IO_URING
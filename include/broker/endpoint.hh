@@ -3,6 +3,7 @@
 #include <atomic>
 #include <cstdint>
 #include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -11,6 +12,8 @@
 
 #include "broker/backend.hh"
 #include "broker/backend_options.hh"
+#include "broker/detail/memory_accounting.hh"
+#include "broker/detail/peer_status_table.hh"
 #include "broker/detail/sink_driver.hh"
 #include "broker/detail/source_driver.hh"
 #include "broker/endpoint_id.hh"
@@ -21,13 +24,23 @@
 #include "broker/message.hh"
 #include "broker/network_info.hh"
 #include "broker/peer_info.hh"
+#include "broker/publish_limit.hh"
+#include "broker/span.hh"
 #include "broker/status.hh"
 #include "broker/status_subscriber.hh"
+#include "broker/store_derivation.hh"
+#include "broker/store_event_subscriber.hh"
 #include "broker/store.hh"
 #include "broker/time.hh"
 #include "broker/topic.hh"
 #include "broker/worker.hh"
 
+namespace broker::detail {
+
+class publish_limiter;
+
+} // namespace broker::detail
+
 namespace broker::internal {
 
 struct endpoint_access;
@@ -113,10 +126,28 @@ public:
 
   // --- construction and destruction ------------------------------------------
 
+  /// Tag type for constructing a logical endpoint that shares the runtime of
+  /// an existing endpoint.
+  struct shares_runtime_t {};
+
+  /// Tag for constructing a logical endpoint that shares the runtime of an
+  /// existing endpoint.
+  static constexpr shares_runtime_t shares_runtime = {};
+
   endpoint();
 
   explicit endpoint(configuration config);
 
+  /// Constructs a logical endpoint that shares the actor system of `host`,
+  /// i.e., its scheduler, network and clock threads, while keeping its own
+  /// core actor with separate peerings, subscriptions and data stores.
+  /// Processes that run many endpoints side by side avoid one thread pool
+  /// per endpoint this way. The logical endpoint reads its configuration
+  /// from the host and reports the same `node_id`. The shared runtime stays
+  /// alive until the last endpoint using it shuts down, so host and logical
+  /// endpoints may shut down in any order.
+  endpoint(shares_runtime_t, endpoint& host);
+
   endpoint(endpoint&&) = delete;
   endpoint(const endpoint&) = delete;
   endpoint& operator=(endpoint&&) = delete;
@@ -167,6 +198,21 @@ public:
     return peer(info.address, info.port, info.retry);
   }
 
+  /// Initiates a peering with a remote endpoint and returns a future for the
+  /// outcome. Unlike @ref peer, the call never blocks; launching many
+  /// peerings back-to-back establishes the connections concurrently, so a
+  /// full-mesh bring-up completes in the time of the slowest peer rather
+  /// than the sum of all. The number of connection attempts in flight at
+  /// once is bounded by "broker.max-pending-connects".
+  /// @param address The IP address of the remote endpoint.
+  /// @param port The TCP port of the remote endpoint.
+  /// @param retry If non-zero, seconds after which to retry if connection
+  ///        cannot be established, or breaks.
+  /// @returns A future that becomes ready once the peering succeeded or
+  ///          failed for good.
+  std::future<bool> peer_async(const std::string& address, uint16_t port,
+                               timeout::seconds retry = timeout::seconds(10));
+
   /// Initiates a peering with a remote endpoint, without waiting
   /// for the operation to complete.
   /// @param address The IP address of the remote endpoint.
@@ -186,6 +232,20 @@ public:
   ///       indicating sucess or failure.
   bool unpeer(const std::string& address, uint16_t port);
 
+  /// Shuts down a peering with a remote endpoint after draining in-flight
+  /// messages: the endpoint stops routing new messages to the peer, flushes
+  /// all buffered outbound messages and waits for the stream protocol to
+  /// acknowledge them before closing the connection. Unlike `unpeer`, a
+  /// rolling restart thus loses no buffered events.
+  /// @param address The IP address of the remote endpoint.
+  /// @param port The TCP port of the remote endpoint.
+  /// @param drain_timeout Maximum time to wait for the drain to complete
+  ///        before falling back to an immediate teardown.
+  /// @returns True if the drain completed in time and the connection was
+  ///          torn down gracefully.
+  bool unpeer_gracefully(const std::string& address, uint16_t port,
+                         timeout::seconds drain_timeout = timeout::seconds(5));
+
   /// Shuts down a peering with a remote endpoint, without waiting for
   /// for the operation to complete.
   /// @param address The IP address of the remote endpoint.
@@ -195,7 +255,9 @@ public:
   ///       indicating sucess or failure.
   void unpeer_nosync(const std::string& address, uint16_t port);
 
-  /// Retrieves a list of all known peers.
+  /// Retrieves a list of all known peers. Reads a published snapshot that
+  /// the core actor refreshes on every peering change, so polling this
+  /// function never competes with message dispatch.
   /// @returns A pointer to the list
   std::vector<peer_info> peers() const;
 
@@ -226,11 +288,53 @@ public:
   // Publishes all messages in `xs`.
   void publish(std::vector<data_message> xs);
 
-  publisher make_publisher(topic ts);
+  // Publishes all messages in `xs`, moving from the span's elements. Callers
+  // that already hold messages in their own storage avoid materializing a
+  // temporary vector; the spanned elements are in a moved-from state on
+  // return.
+  void publish(span<data_message> xs);
+
+  /// Attaches a token-bucket rate limit to all messages published to topics
+  /// under `prefix`. The limit applies to `publish` calls on this endpoint
+  /// and to publishers created from it; it is enforced before messages reach
+  /// the core actor, so a flooding producer never loads the dispatch path.
+  /// Re-attaching a prefix replaces its limit; a non-positive rate removes
+  /// it. Remote or forwarded messages are not affected.
+  void limit_publish_rate(topic prefix, publish_limit limit);
+
+  /// Marks all topics under `prefix` as order-insensitive. With sharded
+  /// dispatch (see "broker.dispatch-shards"), ordered topics pin to one
+  /// shard by topic hash to preserve per-topic FIFO delivery, which
+  /// serializes heavy topics on a single lane. Unordered topics instead
+  /// spread round-robin over all shards, trading delivery order within the
+  /// topic for parallel multi-core dispatch. Suits stateless traffic such as
+  /// metric samples; without dispatch shards the annotation has no effect.
+  /// Prefixes can also be preconfigured via "broker.unordered-topics".
+  void mark_unordered(topic prefix);
+
+  /// Returns the number of messages discarded by publish rate limits.
+  uint64_t publish_limit_drops() const noexcept;
+
+  /// @private
+  const std::shared_ptr<detail::publish_limiter>&
+  publish_limiter() const noexcept {
+    return publish_limiter_;
+  }
+
+  /// Returns a publisher for the topic `ts`. The optional `numa_node` hint
+  /// places queue storage near the given NUMA node, which pays off when the
+  /// publishing thread runs pinned to that node; -1 disables the hint.
+  publisher make_publisher(topic ts, int numa_node = -1);
+
+  /// Returns a thread-safe publisher that any number of threads may share.
+  shared_publisher make_shared_publisher(topic ts);
 
   /// Starts a background worker from the given set of functions that publishes
   /// a series of messages. The worker will run in the background, but `init`
-  /// is guaranteed to be called before the function returns.
+  /// is guaranteed to be called before the function returns. Workers are
+  /// cooperatively scheduled on the endpoint's bounded work-stealing thread
+  /// pool, so the number of drivers is independent of the number of threads;
+  /// see `broker_options::max_threads`.
   template <class Init, class Pull, class AtEnd>
   worker publish_all(Init init, Pull f, AtEnd pred) {
     using driver_t = detail::source_driver_impl_t<Init, Pull, AtEnd>;
@@ -255,6 +359,12 @@ public:
   /// (optionally) status events.
   status_subscriber make_status_subscriber(bool receive_statuses = false);
 
+  /// Returns a subscriber for the typed store events (inserts, updates,
+  /// erasures and expirations) of the store named `store_name`, without
+  /// requiring manual decoding of the raw event stream.
+  store_event_subscriber
+  make_store_event_subscriber(std::string store_name, size_t max_qsize = 20u);
+
   // --- forwarding events -----------------------------------------------------
 
   // Forward remote events for given topics even if no local subscriber.
@@ -263,11 +373,30 @@ public:
   // --- subscribing data ------------------------------------------------------
 
   /// Returns a subscriber connected to this endpoint for the topics `ts`.
-  subscriber make_subscriber(std::vector<topic> ts, size_t max_qsize = 20u);
+  /// The optional `numa_node` hint places queue storage near the given NUMA
+  /// node, which pays off when the consuming thread runs pinned to that node;
+  /// -1 disables the hint.
+  subscriber make_subscriber(std::vector<topic> ts, size_t max_qsize = 20u,
+                             int numa_node = -1);
+
+  /// Returns a subscriber connected to this endpoint for the topics `ts` with
+  /// explicit backpressure configuration.
+  subscriber make_subscriber(std::vector<topic> ts, backpressure_options opts,
+                             size_t max_qsize = 20u, int numa_node = -1);
+
+  /// Returns a subscriber that receives messages for the topics `ts` directly
+  /// from the core, bypassing the usual stream to a worker actor. This cuts
+  /// an actor hop and a copy off the delivery path and suits topics with a
+  /// single local subscriber. Direct subscribers do not compute a receive
+  /// rate and never throttle publishers.
+  subscriber make_direct_subscriber(std::vector<topic> ts,
+                                    size_t max_qsize = 20u);
 
   /// Starts a background worker from the given set of function that consumes
   /// incoming messages. The worker will run in the background, but `init` is
-  /// guaranteed to be called before the function returns.
+  /// guaranteed to be called before the function returns. Like ::publish_all
+  /// workers, sink drivers share the endpoint's bounded work-stealing thread
+  /// pool instead of owning a thread each.
   template <class Init, class OnNext, class Cleanup>
   worker subscribe(std::vector<topic> topics, Init init, OnNext f,
                    Cleanup cleanup) {
@@ -291,6 +420,12 @@ public:
   // --- data stores -----------------------------------------------------------
 
   /// Attaches and/or creates a *master* data store with a globally unique name.
+  /// Passing a "shards" option (count > 1) runs the master sharded: N actors
+  /// each own a key-hash partition behind the same store name, scaling
+  /// mutation throughput across cores. Sharded masters do not support clones.
+  /// A "max-entries" option (count > 0) bounds the store: once full, the
+  /// master evicts entries according to the "eviction-policy" option ("lru",
+  /// "ttl" or "random"; default "lru") instead of growing without limit.
   /// @param name The name of the master.
   /// @param type The type of backend to use.
   /// @param opts The options controlling backend construction.
@@ -299,6 +434,28 @@ public:
   expected<store> attach_master(std::string name, backend type,
                                 backend_options opts=backend_options());
 
+  /// Attaches and creates a *derived* data store: a master whose content
+  /// follows incrementally from mutations of a base master on this endpoint.
+  /// The base master evaluates `f` in-process after applying each mutation
+  /// and pushes the resulting updates straight to the derived master,
+  /// replacing the event-subscriber round trip otherwise needed for
+  /// maintained aggregations. The derivation seeds the derived store from
+  /// the current base content before going incremental. The derived store
+  /// behaves like any other master, including clone support; direct writes
+  /// to it remain possible but risk diverging from the derivation.
+  /// @param name The name of the derived master.
+  /// @param base The name of an existing master on this endpoint.
+  /// @param f Maps one base-store mutation to derived-store updates.
+  /// @param type The type of backend to use for the derived master.
+  /// @param opts The options controlling backend construction.
+  /// @returns A handle to the frontend representing the derived master, or
+  ///          an error if *base* does not exist on this endpoint or *name*
+  ///          exists already.
+  expected<store> attach_derived(std::string name, const std::string& base,
+                                 store_derivation f,
+                                 backend type = backend::memory,
+                                 backend_options opts = backend_options());
+
 
   /// Attaches and/or creates a *clone* data store to an existing master.
   /// @param name The name of the clone.
@@ -322,16 +479,73 @@ public:
   ///                                 explicitly acknowledged by the master.
   ///                                 A negative/zero value here indicates to
   ///                                 never buffer commands.
+  /// @param local_writes Enables eventually consistent local writes for
+  ///                     commutative data such as counters and grow-only
+  ///                     sets. The clone applies add/subtract operations to
+  ///                     its local cache immediately instead of waiting for
+  ///                     the master's broadcast, trading a transient
+  ///                     divergence from the master for write visibility
+  ///                     without a round trip. Concurrent writers converge
+  ///                     once the master rebroadcasts the merged state.
   /// @returns A handle to the frontend representing the clone, or an error if
   ///          a master *name* could not be found.
   expected<store> attach_clone(std::string name, double resync_interval=10.0,
                                double stale_interval=300.0,
-                               double mutation_buffer_interval=120.0);
+                               double mutation_buffer_interval=120.0,
+                               bool local_writes=false);
+
+  // --- diagnostics -----------------------------------------------------------
+
+  /// Writes the contents of the in-memory flight recorder to `directory`
+  /// using the generator file layout, i.e., the same files that
+  /// `broker.recording-directory` produces. Requires a non-zero
+  /// "broker.flight-recorder-size" setting and an existing directory.
+  /// @returns True if the dump succeeded.
+  bool dump_flight_recorder(const std::string& directory);
+
+  // --- runtime reconfiguration -----------------------------------------------
+
+  /// Updates a runtime-tunable configuration parameter on the running
+  /// endpoint without dropping peerings. Currently tunable:
+  /// "broker.dispatcher.flush-interval" (timespan),
+  /// "broker.dispatcher.stage-capacity" (count), "broker.multipath-dedup"
+  /// (boolean), "broker.metrics.latency-sample-rate" (count) and the
+  /// recording filters "broker.recording-topics" (vector of string),
+  /// "broker.recording-types" (one of "all", "data" or "command") and
+  /// "broker.recording-sample-rate" (count). All other parameters remain
+  /// fixed after construction.
+  /// @returns True if the core actor accepted the new value.
+  bool reconfigure(const std::string& key, data value);
+
+  // --- checkpointing ---------------------------------------------------------
+
+  /// Writes a checkpoint of the endpoint state to `directory`: the local
+  /// subscription filter, the addresses of all connected peers and the
+  /// contents of all master stores with a memory backend (persistent
+  /// backends survive restarts on their own). Setting
+  /// "broker.checkpoint-directory" writes a checkpoint automatically on
+  /// shutdown and restores it on construction.
+  expected<void> save_checkpoint(const std::string& directory);
+
+  /// Restores state previously written by `save_checkpoint`: re-announces
+  /// the subscription filter, re-attaches memory-backend masters with their
+  /// saved contents and finally re-initiates the saved peerings. Intended to
+  /// run right after construction, before accepting new peerings, so the
+  /// node comes back with full visibility instead of resyncing for minutes.
+  /// Local subscribers and clones still need to be re-created by the
+  /// application.
+  expected<void> restore_checkpoint(const std::string& directory);
 
   // --- messaging -------------------------------------------------------------
 
+  /// @private
+  const detail::memory_accountant_ptr& memory_accountant() const {
+    return mem_accountant_;
+  }
+
   /// @private
   void send_later(worker who, timespan after, void* msg) {
+    ensure_init();
     clock_->send_later(std::move(who), after, msg);
   }
 
@@ -363,18 +577,22 @@ public:
   }
 
   bool use_real_time() const {
+    ensure_init();
     return clock_->real_time();
   }
 
   timestamp now() const {
+    ensure_init();
     return clock_->now();
   }
 
   void advance_time(timestamp t) {
+    ensure_init();
     clock_->advance_time(t);
   }
 
   const worker& core() const {
+    ensure_init();
     return core_;
   }
 
@@ -384,6 +602,18 @@ protected:
   worker subscriber_;
 
 private:
+  /// Runs the deferred bring-up of a lazily constructed endpoint. Called at
+  /// the top of every member function that touches the actor system; a no-op
+  /// once the endpoint is initialized. Initialization counts as logically
+  /// const, hence the qualifier.
+  void ensure_init() const;
+
+  /// Spins up the actor system, core actor and background tasks.
+  void init_context(configuration config);
+
+  /// Spawns the telemetry exporter if it is not already running.
+  void ensure_metric_exporter();
+
   worker do_subscribe(std::vector<topic>&& topics,
                       std::shared_ptr<detail::sink_driver> driver,
                       bool block_until_initialized);
@@ -395,12 +625,31 @@ private:
   worker make_worker(F fn);
 
   std::shared_ptr<internal::endpoint_context> ctx_;
+  /// Shared with all publishers of this endpoint; see `limit_publish_rate`.
+  std::shared_ptr<detail::publish_limiter> publish_limiter_;
+  /// Holds the configuration of a lazily constructed endpoint until
+  /// `ensure_init` consumes it.
+  std::unique_ptr<configuration> pending_cfg_;
   worker core_;
+  /// Extra core actors that own a topic-hash partition of the local publish
+  /// path. Empty unless `broker.dispatch-shards` exceeds 1.
+  std::vector<worker> dispatch_shards_;
+  /// Prefixes of topics that forgo per-topic FIFO delivery; see
+  /// `mark_unordered`.
+  filter_type unordered_topics_;
+  /// Round-robin cursor for spreading unordered topics over the shards.
+  size_t unordered_cursor_ = 0;
   worker telemetry_exporter_;
   bool await_stores_on_shutdown_ = false;
   std::vector<worker> children_;
   bool destroyed_ = false;
   std::unique_ptr<clock> clock_;
+  /// Tracks estimated memory use per component and enforces the optional
+  /// budget from "broker.memory-budget".
+  detail::memory_accountant_ptr mem_accountant_;
+  /// Published snapshot of the peer table, refreshed by the core actor and
+  /// read by `peers()` without messaging.
+  detail::peer_status_table_ptr peer_table_;
   std::vector<std::unique_ptr<background_task>> background_tasks_;
 };
 
@@ -143,6 +143,12 @@ private:
 /// @relates error
 std::string to_string(const error& x);
 
+/// Returns a process-wide immutable singleton error for a plain enum code.
+/// Handing out a reference to an interned instance allows hot paths such as
+/// data store misses to report plain-code errors without allocating.
+/// @relates error
+const error& interned_error(ec code);
+
 /// Creates a new @ref error from given @ref ec code.
 inline error make_error(ec code) {
   return error{code};
@@ -44,19 +44,19 @@ public:
   expected(
     U x,
     typename std::enable_if<std::is_convertible<U, T>::value>::type* = nullptr)
-    : engaged_(true) {
+    : content_(content_type::value) {
     new (std::addressof(value_)) T(std::move(x));
   }
 
-  expected(T&& x) noexcept(nothrow_move) : engaged_(true) {
+  expected(T&& x) noexcept(nothrow_move) : content_(content_type::value) {
     new (std::addressof(value_)) T(std::move(x));
   }
 
-  expected(const T& x) noexcept(nothrow_copy) : engaged_(true) {
+  expected(const T& x) noexcept(nothrow_copy) : content_(content_type::value) {
     new (std::addressof(value_)) T(x);
   }
 
-  expected(broker::error e) noexcept : engaged_(false) {
+  expected(broker::error e) noexcept : content_(content_type::err) {
     new (std::addressof(error_)) broker::error{std::move(e)};
   }
 
@@ -64,8 +64,8 @@ public:
     construct(other);
   }
 
-  expected(ec code) : engaged_(false) {
-    new (std::addressof(error_)) broker::error(code);
+  expected(ec code) noexcept : content_(content_type::code) {
+    new (std::addressof(code_)) ec(code);
   }
 
   expected(expected&& other) noexcept(nothrow_move) {
@@ -77,9 +77,9 @@ public:
   }
 
   expected& operator=(const expected& other) noexcept(nothrow_copy) {
-    if (engaged_ && other.engaged_)
+    if (content_ == content_type::value && other.content_ == content_type::value)
       value_ = other.value_;
-    else if (!engaged_ && !other.engaged_)
+    else if (content_ == content_type::err && other.content_ == content_type::err)
       error_ = other.error_;
     else {
       destroy();
@@ -89,9 +89,9 @@ public:
   }
 
   expected& operator=(expected&& other) noexcept(nothrow_move) {
-    if (engaged_ && other.engaged_)
+    if (content_ == content_type::value && other.content_ == content_type::value)
       value_ = std::move(other.value_);
-    else if (!engaged_ && !other.engaged_)
+    else if (content_ == content_type::err && other.content_ == content_type::err)
       error_ = std::move(other.error_);
     else {
       destroy();
@@ -101,22 +101,22 @@ public:
   }
 
   expected& operator=(const T& x) noexcept(nothrow_copy) {
-    if (engaged_) {
+    if (content_ == content_type::value) {
       value_ = x;
     } else {
       destroy();
-      engaged_ = true;
+      content_ = content_type::value;
       new (std::addressof(value_)) T(x);
     }
     return *this;
   }
 
   expected& operator=(T&& x) noexcept(nothrow_move) {
-    if (engaged_) {
+    if (content_ == content_type::value) {
       value_ = std::move(x);
     } else {
       destroy();
-      engaged_ = true;
+      content_ = content_type::value;
       new (std::addressof(value_)) T(std::move(x));
     }
     return *this;
@@ -129,25 +129,28 @@ public:
   }
 
   expected& operator=(broker::error e) noexcept {
-    if (!engaged_)
+    if (content_ == content_type::err)
       error_ = std::move(e);
     else {
       destroy();
-      engaged_ = false;
+      content_ = content_type::err;
       new (std::addressof(error_)) broker::error(std::move(e));
     }
     return *this;
   }
 
-  expected& operator=(ec code) {
-    return *this = make_error(code);
+  expected& operator=(ec code) noexcept {
+    destroy();
+    content_ = content_type::code;
+    new (std::addressof(code_)) ec(code);
+    return *this;
   }
 
   // -- modifiers --------------------------------------------------------------
 
   /// @copydoc cvalue
   T& value() noexcept {
-    BROKER_ASSERT(engaged_);
+    BROKER_ASSERT(content_ == content_type::value);
     return value_;
   }
 
@@ -162,8 +165,12 @@ public:
   }
 
   /// @copydoc cerror
-  broker::error& error() noexcept {
-    BROKER_ASSERT(!engaged_);
+  /// @note Calling this overload on an instance that only carries a plain
+  ///       enum code materializes a full error object first.
+  broker::error& error() {
+    if (content_ == content_type::code)
+      materialize();
+    BROKER_ASSERT(content_ == content_type::err);
     return error_;
   }
 
@@ -172,13 +179,13 @@ public:
   /// Returns the contained value.
   /// @pre `engaged() == true`.
   const T& cvalue() const noexcept {
-    BROKER_ASSERT(engaged_);
+    BROKER_ASSERT(content_ == content_type::value);
     return value_;
   }
 
   /// @copydoc cvalue
   const T& value() const noexcept {
-    BROKER_ASSERT(engaged_);
+    BROKER_ASSERT(content_ == content_type::value);
     return value_;
   }
 
@@ -199,51 +206,83 @@ public:
 
   /// Returns `true` if the object holds a value (is engaged).
   bool engaged() const noexcept {
-    return engaged_;
+    return content_ == content_type::value;
   }
 
-  /// Returns the contained error.
+  /// Returns the contained error. Instances that only carry a plain enum
+  /// code return a reference to a process-wide interned instance, so store
+  /// misses and other common plain-code errors never allocate.
   /// @pre `engaged() == false`.
-  const broker::error& cerror() const noexcept {
-    BROKER_ASSERT(!engaged_);
+  const broker::error& cerror() const {
+    BROKER_ASSERT(content_ != content_type::value);
+    if (content_ == content_type::code)
+      return interned_error(code_);
     return error_;
   }
 
   /// @copydoc cerror
-  const broker::error& error() const noexcept {
-    BROKER_ASSERT(!engaged_);
-    return error_;
+  const broker::error& error() const {
+    return cerror();
   }
 
 private:
+  /// Discriminates the active member of the union. Plain-code errors only
+  /// store their enum code, which makes propagating them allocation-free.
+  enum class content_type : uint8_t {
+    value,
+    err,
+    code,
+  };
+
   void construct(expected&& other) noexcept(nothrow_move) {
-    if (other.engaged_)
-      new (std::addressof(value_)) T(std::move(other.value_));
-    else
-      new (std::addressof(error_)) broker::error(std::move(other.error_));
-    engaged_ = other.engaged_;
+    switch (other.content_) {
+      case content_type::value:
+        new (std::addressof(value_)) T(std::move(other.value_));
+        break;
+      case content_type::err:
+        new (std::addressof(error_)) broker::error(std::move(other.error_));
+        break;
+      case content_type::code:
+        new (std::addressof(code_)) ec(other.code_);
+        break;
+    }
+    content_ = other.content_;
   }
 
   void construct(const expected& other) noexcept(nothrow_copy) {
-    if (other.engaged_)
-      new (std::addressof(value_)) T(other.value_);
-    else
-      new (std::addressof(error_)) broker::error(other.error_);
-    engaged_ = other.engaged_;
+    switch (other.content_) {
+      case content_type::value:
+        new (std::addressof(value_)) T(other.value_);
+        break;
+      case content_type::err:
+        new (std::addressof(error_)) broker::error(other.error_);
+        break;
+      case content_type::code:
+        new (std::addressof(code_)) ec(other.code_);
+        break;
+    }
+    content_ = other.content_;
   }
 
   void destroy() {
-    if (engaged_)
+    if (content_ == content_type::value)
       value_.~T();
-    else
+    else if (content_ == content_type::err)
       error_.~error();
   }
 
-  bool engaged_;
+  void materialize() {
+    auto code = code_;
+    new (std::addressof(error_)) broker::error(code);
+    content_ = content_type::err;
+  }
+
+  content_type content_;
 
   union {
     T value_;
     broker::error error_;
+    ec code_;
   };
 };
 
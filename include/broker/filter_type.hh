@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include "broker/topic.hh"
@@ -19,6 +20,73 @@ bool filter_extend(filter_type& f, const topic& x);
 /// Convenience function for calling `filter_extend` with each topic in `other`.
 bool filter_extend(filter_type& f, const filter_type& other);
 
+/// An incremental change to a subscription filter. Peers exchange deltas
+/// instead of re-broadcasting the full filter on every change; the sequence
+/// number allows receivers to detect missed updates and fall back to a full
+/// sync.
+struct filter_diff {
+  /// Sequence number of the broadcast this delta belongs to.
+  uint64_t seq = 0;
+
+  /// Entries that joined the filter since the previous broadcast.
+  filter_type added;
+
+  /// Entries that left the filter since the previous broadcast.
+  filter_type removed;
+};
+
+/// @relates filter_diff
+template <class Inspector>
+bool inspect(Inspector& f, filter_diff& x) {
+  return f.object(x).fields(f.field("seq", x.seq), f.field("added", x.added),
+                            f.field("removed", x.removed));
+}
+
+/// Computes the delta that transforms `old_filter` into `new_filter`.
+/// @pre both filters are sorted.
+filter_diff make_filter_diff(const filter_type& old_filter,
+                             const filter_type& new_filter);
+
+/// Applies the entries of `diff` to `f`, keeping `f` sorted. Callers must
+/// verify the sequence number beforehand.
+void apply_filter_diff(filter_type& f, const filter_diff& diff);
+
+/// Distinguishes how published messages on a topic travel between peers.
+enum class delivery_class : uint8_t {
+  /// Ordered, loss-free delivery with backpressure (the default).
+  reliable,
+  /// Lossy, unordered delivery over a datagram lane between consenting
+  /// peers. Suited for high-rate telemetry that tolerates loss and must not
+  /// congest the reliable lanes.
+  best_effort,
+};
+
+/// @relates delivery_class
+const char* to_string(delivery_class x);
+
+/// Annotates topic prefixes with a non-default delivery class. Classification
+/// uses the same prefix-matching semantics as subscription filters: a topic
+/// is best-effort when any marked prefix matches it. Internal topics always
+/// classify as reliable, since stores and status updates cannot tolerate
+/// loss.
+class delivery_filter {
+public:
+  /// Marks `x` (and all topics below it) for best-effort delivery.
+  /// @return `true` if the filter changed, `false` otherwise.
+  bool mark_best_effort(const topic& x);
+
+  /// Returns the delivery class for messages published to `t`.
+  delivery_class classify(const topic& t) const noexcept;
+
+  /// Returns the prefixes marked for best-effort delivery.
+  const filter_type& best_effort_prefixes() const noexcept {
+    return best_effort_;
+  }
+
+private:
+  filter_type best_effort_;
+};
+
 /// Convenience function for calling `filter_extend` with each topic in `other`
 /// that matches `predicate`.
 template <class Predicate>
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "broker/fwd.hh"
+#include "broker/topic.hh"
+
+namespace broker {
+
+/// Appends a textual representation of `x` to `out`, producing the same text
+/// as `to_string` but without materializing a temporary string per nested
+/// element. Use this instead of `out += to_string(x)` on hot paths.
+void format_to(std::string& out, const data& x);
+
+/// @copydoc format_to
+void format_to(std::string& out, const vector& xs);
+
+/// @copydoc format_to
+void format_to(std::string& out, const set& xs);
+
+/// @copydoc format_to
+void format_to(std::string& out, const table& xs);
+
+/// @copydoc format_to
+void format_to(std::string& out, const address& x);
+
+/// @copydoc format_to
+void format_to(std::string& out, const status& x);
+
+/// @copydoc format_to
+inline void format_to(std::string& out, const topic& x) {
+  out += x.string();
+}
+
+/// Wraps a value for lazy formatting. The wrapper only holds a pointer;
+/// nothing materializes until someone actually writes the wrapper to a
+/// stream or buffer. Handy for log statements: a filtered-out debug line
+/// never pays for walking a `data` tree.
+template <class T>
+class lazy_formatter {
+public:
+  explicit constexpr lazy_formatter(const T& value) noexcept
+    : value_(&value) {
+    // nop
+  }
+
+  const T& value() const noexcept {
+    return *value_;
+  }
+
+private:
+  const T* value_;
+};
+
+/// Returns a lazy formatter for `x`.
+/// @warning The wrapper borrows `x`; it must not outlive it.
+template <class T>
+constexpr lazy_formatter<T> format_lazy(const T& x) noexcept {
+  return lazy_formatter<T>{x};
+}
+
+/// Materializes the wrapped value into the stream.
+/// @relates lazy_formatter
+template <class Char, class Traits, class T>
+std::basic_ostream<Char, Traits>&
+operator<<(std::basic_ostream<Char, Traits>& os, const lazy_formatter<T>& x) {
+  std::string buf;
+  format_to(buf, x.value());
+  return os << buf;
+}
+
+} // namespace broker
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -16,14 +17,19 @@ namespace broker {
 struct add_command;
 struct broker_options;
 struct clear_command;
+struct derived_update;
 struct endpoint_info;
 struct enum_value;
 struct erase_command;
 struct expire_command;
+struct filter_diff;
+struct multi_erase_command;
+struct multi_put_command;
 struct network_info;
 struct node_message;
 struct none;
 struct peer_info;
+struct publish_limit;
 struct publisher_id;
 struct put_command;
 struct put_unique_command;
@@ -31,6 +37,8 @@ struct set_command;
 struct snapshot_command;
 struct snapshot_sync_command;
 struct subtract_command;
+struct transaction_command;
+struct transaction_op;
 
 // -- classes ------------------------------------------------------------------
 
@@ -43,8 +51,10 @@ class internal_command;
 class mailbox;
 class port;
 class publisher;
+class shared_publisher;
 class status;
 class store;
+class store_event_subscriber;
 class subnet;
 class subscriber;
 class topic;
@@ -58,6 +68,9 @@ class expected;
 template <class... Ts>
 class cow_tuple;
 
+template <class... Ts>
+class typed_topic;
+
 // -- enum classes -------------------------------------------------------------
 
 enum class backend : uint8_t;
@@ -98,6 +111,15 @@ namespace broker::detail {
 
 class abstract_backend;
 
+template <class ValueType>
+class shared_subscriber_queue;
+
+/// A shared handle to a subscriber queue that registered for direct delivery,
+/// i.e., the core writes matching data messages straight into the queue
+/// instead of streaming them to a worker actor.
+using data_message_queue_ptr
+  = std::shared_ptr<shared_subscriber_queue<data_message>>;
+
 } // namespace broker::detail
 
 // -- Zeek interface types -----------------------------------------------------
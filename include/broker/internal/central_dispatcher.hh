@@ -1,11 +1,17 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 #include "broker/detail/assert.hh"
+#include "broker/detail/duplicate_filter.hh"
+#include "broker/detail/memory_accounting.hh"
+#include "broker/detail/small_vector.hh"
 #include "broker/fwd.hh"
+#include "broker/internal/latency_tracer.hh"
 #include "broker/internal/unipath_manager.hh"
+#include "broker/message.hh"
 
 namespace broker::internal {
 
@@ -17,20 +23,213 @@ public:
   void enqueue(const unipath_manager* source, detail::item_scope scope,
                caf::span<const node_message> messages);
 
-  /// Adds a new output path to the dispatcher.
+  /// Stages `msg` for a later batched `enqueue` call. Command messages go to
+  /// the high-priority lane and overtake staged bulk data on the next flush.
+  /// Staged messages flush automatically once the buffer reaches its
+  /// capacity; the owner must call `flush` eventually to drain partially
+  /// filled buffers.
+  void stage(const unipath_manager* source, detail::item_scope scope,
+             node_message msg);
+
+  /// Forwards all staged messages to the sinks, calling `enqueue` once per
+  /// run of messages that share source and scope. Drains the high-priority
+  /// lane before the bulk data lane.
+  void flush();
+
+  /// Returns whether no messages are currently staged.
+  [[nodiscard]] bool stage_empty() const noexcept {
+    return staged_high_.empty() && staged_.empty();
+  }
+
+  /// Returns the maximum time a staged message may linger before the owner
+  /// must force a flush.
+  timespan flush_interval() const noexcept {
+    return flush_interval_;
+  }
+
+  /// Overrides the flush deadline for staged messages at runtime. Takes
+  /// effect with the next flush cycle.
+  void set_flush_interval(timespan value) noexcept {
+    flush_interval_ = value;
+  }
+
+  /// Overrides the upper bound for the adaptive batch size at runtime,
+  /// clamping the current batch size into the new range if necessary.
+  void set_max_stage_capacity(size_t value);
+
+  /// Adds a new output path to the dispatcher, reusing the slot of a
+  /// previously removed sink if one is free. Slots are stable: removing a
+  /// sink never changes the index of any other sink.
   void add(unipath_manager_ptr sink);
 
+  /// Drops all precomputed topic-to-sinks mappings. Must be called whenever
+  /// the filter of any attached sink changes.
+  void invalidate_dispatch_cache() noexcept {
+    dispatch_cache_.clear();
+  }
+
+  /// Registers `queue` for direct delivery of data messages matching
+  /// `filter`, replacing any previous registration for the same queue. An
+  /// empty filter removes the registration. Direct queues bypass the sink
+  /// fan-out entirely: `enqueue` writes matching messages straight into the
+  /// queue of the subscribing thread.
+  void set_direct_queue(const detail::data_message_queue_ptr& queue,
+                        filter_type filter);
+
   auto self() const noexcept {
     return self_;
   }
 
+  /// Returns the sink slots. Entries of removed sinks are null until a new
+  /// sink reuses their slot; callers must skip them.
   const auto& managers() const noexcept {
     return sinks_;
   }
 
+  /// Returns the ID that locally published messages carry as their origin.
+  const endpoint_id& origin_id();
+
+  /// Returns the next sequence number for stamping a locally published
+  /// message.
+  uint64_t next_seq() noexcept {
+    return ++seq_;
+  }
+
+  /// Grants access to the filter that suppresses duplicates arriving over
+  /// multiple paths.
+  auto& dedup() noexcept {
+    return dedup_;
+  }
+
+  /// Returns whether inbound paths drop duplicates that arrive over
+  /// redundant peerings.
+  bool dedup_enabled() const noexcept {
+    return dedup_enabled_;
+  }
+
+  /// Toggles duplicate suppression for redundant peerings at runtime.
+  void set_dedup_enabled(bool value) noexcept {
+    dedup_enabled_ = value;
+  }
+
+  /// Grants access to the end-to-end latency tracer.
+  latency_tracer& tracer() noexcept {
+    return tracer_;
+  }
+
+  /// Attaches the endpoint-wide memory accountant; staged messages then
+  /// count against the dispatcher region.
+  void attach_accounting(detail::memory_accountant_ptr accountant) {
+    accountant_ = std::move(accountant);
+  }
+
 private:
+  /// A subscriber queue that receives matching data messages without going
+  /// through a stream to a worker actor.
+  struct direct_queue {
+    detail::data_message_queue_ptr queue;
+    filter_type filter;
+  };
+
+  /// A maximal sequence of staged messages that share source and scope and
+  /// thus may travel downstream as a single batch.
+  struct staged_run {
+    const unipath_manager* source;
+    detail::item_scope scope;
+    std::vector<node_message> messages;
+  };
+
+  /// The staged runs of one priority lane. Messages from the same source
+  /// merge into the trailing run, so a lane rarely holds more than a handful
+  /// of runs between flushes and stores them inline.
+  using staged_lane = detail::small_vector<staged_run, 4>;
+
+  /// Largest number of sinks the dispatch cache can represent as a bitmap.
+  /// With more sinks, `enqueue` falls back to probing every sink.
+  static constexpr size_t max_cached_sinks = 63;
+
+  /// Marks a dispatch cache entry that has not been computed yet.
+  static constexpr uint64_t dispatch_cache_miss
+    = std::numeric_limits<uint64_t>::max();
+
+  /// Returns the bitmap of sinks that accept messages for `t`, computing and
+  /// caching it on the first lookup.
+  uint64_t sink_set(const topic& t);
+
+  /// Recomputes `local_sinks_mask_` and `remote_sinks_mask_` from the
+  /// current sink list. Must be called whenever `sinks_` changes.
+  void rebuild_scope_masks() noexcept;
+
+  /// Tombstones the sink at `index`, strips its bit from the cached
+  /// destination sets and the scope masks, and trims trailing empty slots.
+  /// Cached bitmaps of other sinks stay valid since indices never move.
+  void remove_sink(size_t index);
+
+  /// Appends `msg` to `lane`, merging it into the trailing run if possible.
+  void stage_in(staged_lane& lane, const unipath_manager* source,
+                detail::item_scope scope, node_message msg);
+
+  /// Fetches a message buffer from the pool or allocates a fresh one.
+  std::vector<node_message> make_buf();
+
+  /// Returns a drained message buffer to the pool for reuse.
+  void recycle(std::vector<node_message>&& buf);
+
   caf::scheduled_actor* self_;
+
+  /// Slot map of the attached sinks. Removal tombstones a slot with a null
+  /// entry instead of erasing it, so surviving sinks keep their indices and
+  /// the dispatch cache bitmaps survive peer churn; `add` reuses free slots.
   std::vector<unipath_manager_ptr> sinks_;
+  std::vector<direct_queue> direct_queues_;
+  endpoint_id origin_id_;
+  uint64_t seq_ = 0;
+  detail::duplicate_filter dedup_;
+  bool dedup_enabled_ = true;
+  latency_tracer tracer_;
+  staged_lane staged_high_;
+  staged_lane staged_;
+  size_t staged_messages_ = 0;
+
+  /// Optional endpoint-wide memory accounting; see `attach_accounting`.
+  detail::memory_accountant_ptr accountant_;
+
+  /// Estimated bytes of all currently staged messages.
+  size_t staged_bytes_ = 0;
+
+  /// Current batch size target. Grows towards `max_stage_capacity_` while
+  /// flushes fill up, shrinks towards `min_stage_capacity_` when the flush
+  /// deadline fires on a mostly empty stage.
+  size_t stage_capacity_;
+  size_t min_stage_capacity_;
+  size_t max_stage_capacity_;
+  timespan flush_interval_;
+
+  /// Maps interned topic IDs to the bitmap of sinks whose filter accepts the
+  /// topic. Recurring topics resolve their destination set with one indexed
+  /// load instead of per-sink prefix matching.
+  std::vector<uint64_t> dispatch_cache_;
+
+  /// Bitmap of sinks that deliver to local subscribers, i.e., receivers of
+  /// data or command messages. Local-scoped items dispatch against this mask
+  /// only, so same-process pub/sub reduces to reference handoffs into local
+  /// sink caches and never touches the peer managers.
+  uint64_t local_sinks_mask_ = 0;
+
+  /// Bitmap of sinks that forward node messages to peers. Remote-scoped
+  /// items dispatch against this mask only.
+  uint64_t remote_sinks_mask_ = 0;
+
+  /// Exposes the adaptive batch size to the telemetry system.
+  caf::telemetry::int_gauge* stage_capacity_gauge_ = nullptr;
+
+  /// Counts messages that the dispatcher flushed downstream.
+  caf::telemetry::int_counter* flushed_messages_ = nullptr;
+
+  /// Pools message buffers across `flush` calls. Clearing a buffer releases
+  /// the message payloads but keeps its capacity, so steady-state staging
+  /// runs without touching the general-purpose heap.
+  std::vector<std::vector<node_message>> pooled_bufs_;
 };
 
 } // namespace broker::internal
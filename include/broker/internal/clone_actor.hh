@@ -1,6 +1,8 @@
 #pragma once
 
+#include <chrono>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <caf/actor.hpp>
@@ -9,10 +11,14 @@
 #include <caf/behavior.hpp>
 
 #include "broker/data.hh"
+#include "broker/defaults.hh"
+#include "broker/detail/preset_dictionary.hh"
+#include "broker/detail/string_dictionary.hh"
 #include "broker/endpoint.hh"
 #include "broker/internal/store_actor.hh"
 #include "broker/internal_command.hh"
 #include "broker/publisher_id.hh"
+#include "broker/snapshot.hh"
 #include "broker/topic.hh"
 
 namespace broker::internal {
@@ -28,6 +34,15 @@ public:
   /// Sends `x` to the master.
   void forward(internal_command&& x);
 
+  /// Emits a `sc::store_backlog` status when the number of buffered commands
+  /// exceeds the configured threshold, at most once per cooldown interval.
+  void check_backlog();
+
+  /// Records the master-to-clone propagation delay of a stamped command and
+  /// emits a `sc::store_slo_breach` status after sustained breaches, at most
+  /// once per cooldown interval.
+  void check_slo(timespan delay);
+
   /// Wraps `x` into a `data` object and forwards it to the master.
   template <class T>
   void forward_from(T& x) {
@@ -38,6 +53,19 @@ public:
 
   void command(internal_command& cmd);
 
+  /// Applies all updates buffered while the clone was catching up and
+  /// releases the buffer. A key-first pass over the buffer first drops
+  /// single-key updates that a later buffered command overwrites, erases or
+  /// clears anyway, so superseded updates never pay their application cost;
+  /// the survivors then apply in one batch.
+  void apply_pending_updates();
+
+  /// Optimistically applies a commutative command (add/subtract) to the
+  /// local cache before the master confirms it. The master's authoritative
+  /// broadcast later overwrites the entry, so concurrent writers converge.
+  /// Non-commutative commands are ignored.
+  void local_apply(internal_command& x);
+
   void operator()(none);
 
   void operator()(put_command&);
@@ -52,6 +80,10 @@ public:
 
   void operator()(subtract_command&);
 
+  void operator()(multi_put_command&);
+
+  void operator()(multi_erase_command&);
+
   void operator()(snapshot_command&);
 
   void operator()(snapshot_sync_command&);
@@ -60,8 +92,19 @@ public:
 
   void operator()(clear_command&);
 
+  void operator()(transaction_command&);
+
+  /// Applies one chunk of a streamed snapshot, emitting insert and update
+  /// events on the fly. The final chunk erases local keys the snapshot did
+  /// not cover, so the clone only ever buffers the covered key set.
+  void apply_snapshot_chunk(broker::snapshot& chunk, bool first, bool last);
+
   data keys() const;
 
+  /// Returns the keys within the half-open range *[from, to)*, ordered by
+  /// key and capped at `limit` entries (0 drops the cap).
+  data keys_in_range(const data& from, const data& to, uint64_t limit) const;
+
   topic master_topic;
 
   caf::actor master;
@@ -70,6 +113,11 @@ public:
 
   bool is_stale = true;
 
+  /// Enables eventually consistent local writes: commutative commands take
+  /// effect on the local cache immediately instead of waiting for the
+  /// master's broadcast.
+  bool local_writes = false;
+
   double stale_time = -1.0;
 
   double unmutable_time = -1.0;
@@ -82,13 +130,64 @@ public:
 
   bool awaiting_snapshot_sync = true;
 
+  /// Keys covered by the chunks of an in-flight streamed snapshot.
+  std::unordered_set<data> snapshot_seen_keys;
+
+  /// Mirror of the master's per-transfer string table for decoding streamed
+  /// snapshot chunks; see broker/detail/snapshot_codec.hh.
+  detail::string_dictionary snapshot_dict;
+
+  /// Trained deflate dictionaries loaded from
+  /// "broker.compression-dictionary-directory", for resolving snapshot
+  /// chunks the master deflated against a preset dictionary.
+  detail::preset_dictionary_set preset_dicts;
+
+  /// Writes the current content and replay position to the persistent cache
+  /// if caching is enabled, the clone holds complete state and commands
+  /// arrived since the previous flush.
+  void flush_cache();
+
+  /// File holding the persistent cache of this clone; empty when
+  /// "broker.store.clone-cache-directory" is unset.
+  std::string cache_path;
+
+  /// Value of `last_applied_seq` at the time of the last cache flush.
+  uint64_t cache_flushed_seq = 0;
+
+  /// Highest command sequence number applied so far. After a brief
+  /// disconnect, the clone asks the master to replay everything past this
+  /// point instead of requesting a full snapshot.
+  uint64_t last_applied_seq = 0;
+
+  /// Sequence counters for stamping commands forwarded to the master, one
+  /// per originating writer. The master drops numbers it has already seen,
+  /// which makes resends such as mutation buffer replays idempotent.
+  std::unordered_map<publisher_id, uint64_t> writer_seqs;
+
+  /// Number of buffered commands that triggers a `sc::store_backlog` status.
+  /// Zero disables the check.
+  size_t backlog_threshold = 0;
+
+  /// Time point of the last emitted backlog status.
+  std::chrono::steady_clock::time_point last_backlog_report{};
+
+  /// Propagation delay of a sampled command that counts as an SLO breach.
+  /// Zero records delays without breach tracking.
+  timespan slo_threshold = defaults::health::store_slo_threshold;
+
+  /// Number of consecutive sampled breaches observed so far.
+  size_t consecutive_slo_breaches = 0;
+
+  /// Time point of the last emitted SLO status.
+  std::chrono::steady_clock::time_point last_slo_report{};
+
   static inline constexpr const char* name = "clone_actor";
 };
 
 caf::behavior clone_actor(caf::stateful_actor<clone_state>* self,
                           caf::actor core, std::string id,
                           double resync_interval, double stale_interval,
-                          double mutation_buffer_interval,
+                          double mutation_buffer_interval, bool local_writes,
                           endpoint::clock* ep_clock);
 
 } // namespace broker::internal
@@ -13,6 +13,8 @@
 #include <caf/stateful_actor.hpp>
 
 #include "broker/configuration.hh"
+#include "broker/detail/memory_accounting.hh"
+#include "broker/detail/peer_status_table.hh"
 #include "broker/detail/radix_tree.hh"
 #include "broker/endpoint.hh"
 #include "broker/endpoint_id.hh"
@@ -55,7 +57,9 @@ public:
 
   core_state(caf::event_based_actor* ptr, const filter_type& filter,
              broker_options opts = broker_options{},
-             endpoint::clock* ep_clock = nullptr);
+             endpoint::clock* ep_clock = nullptr,
+             detail::memory_accountant_ptr accountant = nullptr,
+             detail::peer_status_table_ptr peer_table = nullptr);
 
   // --- initialization --------------------------------------------------------
 
@@ -83,6 +87,12 @@ public:
   /// Adds `xs` to our filter and update all peers on changes.
   void subscribe(filter_type xs);
 
+  // --- runtime reconfiguration -----------------------------------------------
+
+  /// Applies a new value for a runtime-tunable configuration parameter.
+  /// Returns an error for unknown keys or mismatched value types.
+  caf::error reconfigure(const std::string& key, const data& value);
+
   // --- convenience functions for querying state ------------------------------
 
   /// Returns whether `x` is either a pending peer or a connected peer.
@@ -92,11 +102,37 @@ public:
   /// our peers.
   bool has_remote_subscriber(const topic& x) noexcept;
 
+  /// Builds the list of connected and pending peers for `peers()` queries
+  /// and for the published peer table.
+  std::vector<peer_info> peer_info_list();
+
+  /// Publishes a fresh snapshot to the shared peer table, if any.
+  void publish_peer_table();
+
   // --- callbacks -------------------------------------------------------------
   //
   void peer_connected(const peer_id_type& peer_id,
                       const communication_handle_type& hdl);
 
+  void peer_disconnected(const peer_id_type& peer_id,
+                         const communication_handle_type& hdl,
+                         const caf::error& reason);
+
+  void peer_removed(const peer_id_type& peer_id,
+                    const communication_handle_type& hdl);
+
+  /// Keeps the `network_info` overload from the mixin chain visible.
+  using super::peer_unavailable;
+
+  void peer_unavailable(const peer_id_type& peer_id,
+                        const communication_handle_type& hdl,
+                        const caf::error& reason);
+
+  /// Intercepts new peering attempts to reflect the pending connection in
+  /// the published peer table.
+  void start_peering(const peer_id_type& peer_id, caf::actor remote_peer,
+                     caf::response_promise rp);
+
 private:
   // --- member variables ------------------------------------------------------
 
@@ -106,9 +142,22 @@ private:
   /// Requested topics on this core.
   filter_type filter_;
 
+  /// Sequence number of the last filter broadcast to peers.
+  uint64_t filter_seq_ = 0;
+
+  /// Snapshot of `filter_` at the last broadcast, for computing deltas.
+  filter_type last_broadcast_filter_;
+
+  /// Sequence number of the last filter update accepted from each peer.
+  /// Absent or zero entries force a full sync before deltas apply.
+  std::unordered_map<caf::actor, uint64_t> peer_filter_seqs_;
+
   /// Set to `true` after receiving a shutdown message from the endpoint.
   bool shutting_down_ = false;
 
+  /// Shared peer table for lock-free `peers()` queries; may be `nullptr`.
+  detail::peer_status_table_ptr peer_table_;
+
   /// Keeps track of all actors that currently wait for handshakes to
   /// complete.
   std::unordered_map<caf::actor, size_t> peers_awaiting_status_sync_;
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <deque>
 #include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 #include <caf/fwd.hpp>
 
 #include "broker/detail/assert.hh"
+#include "broker/detail/prefix_matcher.hh"
 #include "broker/filter_type.hh"
 #include "broker/internal/generator_file_writer.hh"
 #include "broker/internal/logger.hh"
@@ -13,6 +20,16 @@
 
 namespace broker::internal {
 
+/// Selects which message kinds a recording captures.
+enum class recording_types {
+  all,
+  data,
+  command,
+};
+
+/// Parses "all", "data" or "command"; returns `std::nullopt` otherwise.
+std::optional<recording_types> parse_recording_types(std::string_view str);
+
 class core_recorder {
 public:
   explicit core_recorder(caf::local_actor* self);
@@ -22,19 +39,80 @@ public:
   void record_peer(const caf::node_id& peer_id);
 
   explicit operator bool() const noexcept {
-    return writer_ != nullptr;
+    return writer_ != nullptr || flight_recorder_cap_ > 0;
   }
 
   bool operator!() const noexcept {
-    return !writer_;
+    return !static_cast<bool>(*this);
   }
 
   size_t remaining_records() const noexcept {
     return remaining_records_ ;
   }
 
+  // -- recording filters ------------------------------------------------------
+
+  /// Restricts recording to topics matching `new_filter`; an empty filter
+  /// (the default) records all topics.
+  void topic_filter(filter_type new_filter) {
+    topic_filter_ = std::move(new_filter);
+  }
+
+  const filter_type& topic_filter() const noexcept {
+    return topic_filter_;
+  }
+
+  /// Restricts recording to data or command messages.
+  void recorded_types(recording_types new_types) noexcept {
+    recorded_types_ = new_types;
+  }
+
+  recording_types recorded_types() const noexcept {
+    return recorded_types_;
+  }
+
+  /// Records only every `new_rate`-th message that passes the other filters;
+  /// 0 and 1 capture every matching message.
+  void sample_rate(uint64_t new_rate) noexcept {
+    sample_rate_ = new_rate;
+  }
+
+  uint64_t sample_rate() const noexcept {
+    return sample_rate_;
+  }
+
+  /// Applies the recording filters to `x`. Runs before any serialization, so
+  /// filtered-out messages cost no more than a topic prefix check.
+  template <class T>
+  bool selects(const T& x) {
+    if (recorded_types_ != recording_types::all) {
+      bool is_data;
+      if constexpr (std::is_same<T, data_message>::value)
+        is_data = true;
+      else if constexpr (std::is_same<T, command_message>::value)
+        is_data = false;
+      else
+        is_data = is_data_message(x);
+      if (is_data != (recorded_types_ == recording_types::data))
+        return false;
+    }
+    if (!topic_filter_.empty()
+        && !detail::prefix_matcher{}(topic_filter_, get_topic(x)))
+      return false;
+    if (sample_rate_ > 1 && ++sample_counter_ % sample_rate_ != 0)
+      return false;
+    return true;
+  }
+
   template <class T>
   bool try_record(const T& x) {
+    if (!selects(x))
+      return true;
+    if (flight_recorder_cap_ > 0) {
+      // Messages are copy-on-write, so buffering only bumps a reference count.
+      record_in_memory(node_message_content{x});
+      return true;
+    }
     BROKER_ASSERT(writer_ != nullptr);
     BROKER_ASSERT(remaining_records_ > 0);
     if (auto err = writer_->write(x)) {
@@ -54,9 +132,16 @@ public:
     return try_record(get_content(x));
   }
 
+  /// Writes the buffered flight recorder contents to `directory` using the
+  /// same file layout as always-on disk recording. Afterwards, the buffer is
+  /// empty and recording continues.
+  caf::error dump(const std::string& directory);
+
 private:
   bool open_file(std::ofstream& fs, std::string file_name);
 
+  void record_in_memory(node_message_content x);
+
   /// Helper for recording meta data of published messages.
   generator_file_writer_ptr writer_;
 
@@ -68,6 +153,35 @@ private:
 
   /// Handle for recording all peers.
   std::ofstream peers_file_;
+
+  /// Maximum number of messages kept by the in-memory flight recorder. A
+  /// value of 0 disables the flight recorder.
+  size_t flight_recorder_cap_ = 0;
+
+  /// Ring buffer with the most recent messages when running in flight
+  /// recorder mode.
+  std::deque<node_message_content> flight_buf_;
+
+  /// Subscribed topics observed while running in flight recorder mode.
+  filter_type flight_topics_;
+
+  /// Peers observed while running in flight recorder mode.
+  std::vector<std::string> flight_peers_;
+
+  /// Rendered node ID of the parent actor for writing `id.txt` on dumps.
+  std::string node_id_;
+
+  /// Restricts recording to matching topics; empty records everything.
+  filter_type topic_filter_;
+
+  /// Restricts recording to data or command messages.
+  recording_types recorded_types_ = recording_types::all;
+
+  /// Records only every Nth matching message; 0 and 1 capture all of them.
+  uint64_t sample_rate_ = 0;
+
+  /// Counts matching messages for picking the sampled subset.
+  uint64_t sample_counter_ = 0;
 };
 
 } // namespace broker::internal
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <caf/behavior.hpp>
+#include <caf/event_based_actor.hpp>
+
+namespace broker::internal {
+
+/// Resolves hostnames to IP address literals. The actor wraps the blocking
+/// system resolver, so it must run detached to keep lookups from stalling the
+/// shared worker pool.
+caf::behavior dns_resolver(caf::event_based_actor* self);
+
+} // namespace broker::internal
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
 #include <mutex>
 #include <chrono>
 #include <limits>
@@ -45,14 +49,40 @@ public:
 
   void extinguish_one();
 
-  auto descriptor() const noexcept {
-    return flare_.fd();
-  }
+  /// Removes `num` wakeup tokens with a single lock acquisition, for
+  /// consumers that dequeue a batch of messages before settling the flare.
+  void extinguish_many(size_t num);
+
+  /// Returns a descriptor that becomes ready whenever the mailbox holds
+  /// messages, materializing the flare on first use. Actors that never call
+  /// this function run entirely on a condition variable and own no file
+  /// descriptors, which matters for applications juggling many stores under
+  /// a tight fd limit.
+  detail::native_socket descriptor();
 
 private:
-  detail::flare flare_;
-  int flare_count_;
+  /// Busy-polls `flare_count_` for up to `spin_count_` iterations and returns
+  /// whether a message arrived; the fd-less analogue of
+  /// `flare::spin_await_one`.
+  bool spin_on_count() const;
+
+  /// Created lazily by `descriptor`; until then, `await_data` parks on
+  /// `flare_cv_` instead.
+  std::unique_ptr<detail::flare> flare_;
+
+  /// Number of mailbox messages not yet matched by an extinguish call.
+  /// Writes happen under `flare_mtx_`; the atomic allows lock-free reads in
+  /// the busy-poll phase of `await_data`.
+  std::atomic<int> flare_count_;
+
   std::mutex flare_mtx_;
+
+  /// Wakes up fd-less `await_data` calls; see `descriptor`.
+  std::condition_variable flare_cv_;
+
+  /// Number of busy-poll iterations `await_data` performs before parking on
+  /// the flare fd; taken from "broker.subscriber.spin-count".
+  size_t spin_count_;
 };
 
 } // namespace broker::internal
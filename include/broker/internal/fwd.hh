@@ -3,6 +3,7 @@
 namespace broker::internal {
 
 struct retry_state;
+struct snapshot_chunk;
 
 class central_dispatcher;
 class flare_actor;
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <condition_variable>
 #include <cstddef>
 #include <cstdio>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include <caf/binary_deserializer.hpp>
 
@@ -11,6 +15,7 @@
 #include "broker/detail/native_socket.hh"
 #include "broker/fwd.hh"
 #include "broker/internal/data_generator.hh"
+#include "broker/time.hh"
 #include "broker/topic.hh"
 
 namespace broker::internal {
@@ -33,7 +38,8 @@ public:
     = std::function<bool(value_type*, caf::span<const caf::byte>)>;
 
   generator_file_reader(file_handle_type fd, mapper_handle mapper,
-                        mapped_pointer addr, size_t file_size);
+                        mapped_pointer addr, size_t file_size,
+                        uint8_t file_version);
 
   generator_file_reader(generator_file_reader&&) = delete;
 
@@ -64,6 +70,31 @@ public:
     return topic_table_;
   }
 
+  /// @return The format version from the file header.
+  uint8_t version() const noexcept {
+    return version_;
+  }
+
+  /// Starts a background thread that decodes up to `depth` entries ahead of
+  /// the consumer, overlapping page faults and frame decompression with the
+  /// replay itself. May be called at most once and only before the first
+  /// `read`. Afterwards, only `at_end`, `rewind`, `read` and `drain_gap` may
+  /// be called on this reader.
+  void enable_prefetch(size_t depth);
+
+  /// Returns the recorded time gap that preceded the entry from the last
+  /// `read` and resets it. Always zero for untimed recordings.
+  timespan drain_gap() noexcept {
+    if (prefetching_) {
+      auto result = front_gap_;
+      front_gap_ = timespan{0};
+      return result;
+    }
+    auto result = pending_gap_;
+    pending_gap_ = timespan{0};
+    return result;
+  }
+
   size_t entries() const noexcept {
     return data_entries_ + command_entries_;
   }
@@ -77,6 +108,27 @@ public:
   }
 
 private:
+  /// Decompresses the next frame of a compressed file into `frame_buf_` and
+  /// points `source_` at it. Frames decode lazily: the mapped file stays
+  /// untouched until the reader actually consumes a frame.
+  caf::error load_frame();
+
+  /// Implements `at_end` on the decode state. With prefetching enabled, only
+  /// the prefetch thread may call this.
+  bool at_end_impl() const;
+
+  /// Implements `rewind` on the decode state; same threading rules as
+  /// `at_end_impl`.
+  void rewind_impl();
+
+  /// Implements `read` on the decode state; same threading rules as
+  /// `at_end_impl`.
+  caf::error read_impl(value_type& x);
+
+  /// Body of the prefetch thread: keeps up to `prefetch_depth_` decoded
+  /// entries buffered for the consumer.
+  void prefetch_loop();
+
   file_handle_type fd_;
   mapper_handle mapper_;
   mapped_pointer addr_;
@@ -87,6 +139,63 @@ private:
   size_t data_entries_ = 0;
   size_t command_entries_ = 0;
   bool sealed_ = false;
+  /// The format version from the file header.
+  uint8_t version_ = 0;
+  /// Whether the file stores its entries in compressed frames.
+  bool compressed_ = false;
+  /// Accumulates `time_delta` entries until the next `drain_gap` call.
+  timespan pending_gap_ = timespan{0};
+  /// Offset of the next unread frame in the mapped file.
+  size_t frame_offset_ = 0;
+  /// Holds the decompressed payload of the current frame.
+  std::vector<caf::byte> frame_buf_;
+
+  // -- prefetch pipeline ------------------------------------------------------
+
+  /// A decoded entry plus the time gap that preceded it.
+  struct prefetch_entry {
+    value_type value;
+    timespan gap;
+  };
+
+  /// Whether `enable_prefetch` moved the decode state to a background
+  /// thread. Never changes back once set.
+  bool prefetching_ = false;
+
+  /// Upper bound for decoded entries buffered ahead of the consumer.
+  size_t prefetch_depth_ = 0;
+
+  /// Runs `prefetch_loop`.
+  std::thread prefetch_thread_;
+
+  /// Guards all prefetch state below.
+  mutable std::mutex prefetch_mtx_;
+
+  /// Signals new buffered entries (or EOF) to the consumer. Mutable because
+  /// `at_end` waits on it.
+  mutable std::condition_variable prefetch_consumer_cv_;
+
+  /// Signals free buffer space, rewinds and shutdown to the prefetch thread.
+  std::condition_variable prefetch_producer_cv_;
+
+  /// Decoded entries waiting for the consumer.
+  std::deque<prefetch_entry> prefetch_buf_;
+
+  /// Set when the prefetch thread exhausted the input (or failed).
+  bool prefetch_eof_ = false;
+
+  /// Tells the prefetch thread to terminate.
+  bool prefetch_stop_ = false;
+
+  /// Tells the prefetch thread to rewind the decode state.
+  bool prefetch_rewind_ = false;
+
+  /// First error encountered by the prefetch thread, if any.
+  caf::error prefetch_err_;
+
+  /// Time gap of the entry from the last `read` in prefetch mode. Only the
+  /// consumer thread touches this member.
+  timespan front_gap_ = timespan{0};
 };
 
 using generator_file_reader_ptr = std::unique_ptr<generator_file_reader>;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
@@ -23,15 +24,35 @@ public:
 
     static constexpr uint8_t version = 1;
 
+    /// Identifies the compressed format, where the entries are grouped into
+    /// deflate-compressed frames. Each frame consists of two `uint32_t`
+    /// fields (size of the compressed payload and size after decompression)
+    /// followed by the compressed payload. Entries never span frames.
+    static constexpr uint8_t version_compressed = 2;
+
+    /// Identifies formats whose entry stream includes `time_delta` entries
+    /// that record the gaps between messages, enabling timed replay.
+    static constexpr uint8_t version_timed = 3;
+
+    /// Combines @ref version_compressed and @ref version_timed.
+    static constexpr uint8_t version_timed_compressed = 4;
+
     static constexpr size_t header_size = sizeof(magic) + sizeof(version);
 
+    /// Default amount of entry bytes to accumulate per compressed frame.
+    /// Larger frames compress better, smaller frames decompress lazier.
+    static constexpr size_t default_frame_size = 64 * 1024;
+
     enum class entry_type : uint8_t {
       new_topic,
       data_message,
       command_message,
+      /// A `uint64_t` with the microseconds elapsed since the previous
+      /// message entry was recorded.
+      time_delta,
     };
 
-    static std::array<caf::byte, header_size> header();
+    static std::array<caf::byte, header_size> header(uint8_t file_version);
   };
 
   using data_or_command_message = std::variant<data_message, command_message>;
@@ -48,7 +69,13 @@ public:
 
   ~generator_file_writer();
 
-  caf::error open(std::string file_name);
+  /// Opens `file_name` for writing. Setting `compressed` selects a
+  /// compressed format, which shrinks recordings at the cost of compressing
+  /// each frame on flush (falls back to the uncompressed format when Broker
+  /// was built without zlib support). Setting `timed` records the time gaps
+  /// between messages as `time_delta` entries for timed replay.
+  caf::error open(std::string file_name, bool compressed = false,
+                  bool timed = false);
 
   caf::error write(const data_message& x);
 
@@ -73,17 +100,26 @@ public:
 private:
   caf::error topic_id(const topic& x, uint16_t& id);
 
+  /// Writes a `time_delta` entry for the gap since the last message when
+  /// recording a timed file.
+  caf::error stamp();
+
   caf::binary_serializer::container_type buf_;
   caf::binary_serializer sink_;
   std::ofstream f_;
   size_t flush_threshold_;
   std::vector<topic> topic_table_;
   std::string file_name_;
+  bool compressed_ = false;
+  bool timed_ = false;
+  std::chrono::steady_clock::time_point last_entry_{};
 };
 
 using generator_file_writer_ptr = std::unique_ptr<generator_file_writer>;
 
-generator_file_writer_ptr make_generator_file_writer(const std::string& fname);
+generator_file_writer_ptr make_generator_file_writer(const std::string& fname,
+                                                     bool compressed = false,
+                                                     bool timed = false);
 
 generator_file_writer& operator<<(generator_file_writer& out,
                                   const data_message& x);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <caf/actor.hpp>
+#include <caf/behavior.hpp>
+#include <caf/fwd.hpp>
+#include <caf/stateful_actor.hpp>
+
+#include "broker/fwd.hh"
+#include "broker/time.hh"
+
+namespace broker::internal {
+
+/// Name under which the watchdog registers itself in the actor registry.
+/// Long-lived actors look up this entry on startup and enroll themselves.
+constexpr const char* lag_watchdog_registry_key = "broker.lag-watchdog";
+
+/// Records the time between `sent` and now into the "broker.scheduler-lag"
+/// histogram labeled with `actor_name`. Targets call this from their ping
+/// handler, so the recorded value captures how long the probe message sat in
+/// the mailbox plus the time until a scheduler worker ran the actor.
+void record_scheduler_lag(caf::actor_system& sys, caf::string_view actor_name,
+                          timestamp sent);
+
+/// Enrolls `self` with the lag watchdog if one is running on this system.
+/// No-op otherwise, so targets call this unconditionally on startup.
+void enroll_with_lag_watchdog(caf::local_actor* self);
+
+/// State for the watchdog actor. When enabled via
+/// "broker.metrics.scheduler-lag-interval", the endpoint spawns one watchdog
+/// per actor system. The watchdog periodically posts timestamped no-op
+/// messages to all enrolled long-lived actors (core, masters, clones and the
+/// telemetry exporter). Each target records the observed scheduling lag into
+/// a per-actor histogram in the telemetry registry, which tells a saturated
+/// scheduler (all actors lag) apart from a single actor hogging a worker.
+class lag_watchdog_state {
+public:
+  /// Reads the probe interval from "broker.metrics.scheduler-lag-interval".
+  lag_watchdog_state(caf::event_based_actor* self);
+
+  lag_watchdog_state(caf::event_based_actor* self, caf::timespan interval);
+
+  caf::behavior make_behavior();
+
+  static inline const char* name = "lag-watchdog";
+
+private:
+  /// Points to the actor that owns this state object.
+  caf::event_based_actor* self_;
+
+  /// Time between two rounds of probe messages.
+  caf::timespan interval_;
+
+  /// All enrolled actors; down messages remove entries.
+  std::vector<caf::actor> targets_;
+
+  /// Set once the first target enrolls. The watchdog quits when the last
+  /// target goes down, i.e., when the core and all its stores terminated.
+  bool had_targets_ = false;
+};
+
+using lag_watchdog_actor = caf::stateful_actor<lag_watchdog_state>;
+
+} // namespace broker::internal
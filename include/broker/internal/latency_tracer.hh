@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <caf/fwd.hpp>
+
+#include "broker/fwd.hh"
+#include "broker/message.hh"
+
+namespace broker::internal {
+
+/// Measures end-to-end message latency. When enabled via
+/// "broker.metrics.latency-sample-rate", the endpoint stamps every Nth
+/// locally published message with its wall-clock publish time. On delivery to
+/// a local subscriber, the tracer records the elapsed time into a
+/// high-dynamic-range histogram labeled with the first segment of the topic,
+/// e.g., "zeek" for "/zeek/events/foo". The histograms appear in the
+/// telemetry registry as "broker.message-latency" and thus ship with regular
+/// metric exports and Prometheus scrapes.
+class latency_tracer {
+public:
+  explicit latency_tracer(caf::scheduled_actor* self);
+
+  /// Returns whether tracing is active on this endpoint.
+  [[nodiscard]] bool enabled() const noexcept {
+    return sample_rate_ > 0;
+  }
+
+  /// Changes the sampling rate at runtime; zero disables tracing.
+  void set_sample_rate(uint64_t value) noexcept {
+    sample_rate_ = value;
+  }
+
+  /// Stamps `msg` with the current time if it falls into the sample, i.e.,
+  /// once every `sample_rate_` calls. No-op when tracing is disabled.
+  void stamp(node_message& msg) noexcept {
+    if (sample_rate_ > 0 && ++counter_ % sample_rate_ == 0)
+      msg.stamp = broker::now();
+  }
+
+  /// Records the time since the origin stamp of `msg` under the first
+  /// segment of its topic. No-op for untraced messages.
+  void record(const node_message& msg);
+
+private:
+  /// Returns the histogram instance for the first segment of `t`, creating
+  /// it on first use.
+  caf::telemetry::dbl_histogram* instance(const topic& t);
+
+  /// Every Nth published message carries a stamp; zero disables tracing.
+  uint64_t sample_rate_ = 0;
+
+  /// Counts published messages for picking the sampled subset.
+  uint64_t counter_ = 0;
+
+  /// Parent family of all per-prefix histograms.
+  caf::telemetry::metric_family_impl<caf::telemetry::dbl_histogram>* family_
+    = nullptr;
+
+  /// Caches histogram instances by topic prefix to avoid label lookups on
+  /// the delivery path.
+  std::unordered_map<std::string, caf::telemetry::dbl_histogram*> instances_;
+};
+
+} // namespace broker::internal
@@ -2,7 +2,21 @@
 
 #include <caf/logger.hpp>
 
-#define BROKER_LOG(level, ...) CAF_LOG_IMPL("broker", level, __VA_ARGS__)
+#include "broker/detail/async_logger.hh"
+
+// Each message first consults the asynchronous ring-buffer backend; when it
+// is disabled (the default) or rejects the level, the message falls through
+// to CAF's synchronous logger. The backend check costs one relaxed atomic
+// load, so call sites stay cheap while the backend is off.
+#define BROKER_LOG(level, ...)                                                 \
+  do {                                                                         \
+    auto& broker_log_backend_ = ::broker::detail::async_logger::instance();    \
+    if (broker_log_backend_.accepts(level))                                    \
+      broker_log_backend_.append(                                              \
+        level, (::caf::logger::line_builder{} << __VA_ARGS__).get());          \
+    else                                                                       \
+      CAF_LOG_IMPL("broker", level, __VA_ARGS__);                              \
+  } while (false)
 
 #define BROKER_TRACE(...)                                                      \
   BROKER_LOG(CAF_LOG_LEVEL_TRACE, "ENTRY" << __VA_ARGS__);                     \
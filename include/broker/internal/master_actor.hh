@@ -1,18 +1,36 @@
 #pragma once
 
+#include <deque>
+#include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <caf/actor.hpp>
 #include <caf/behavior.hpp>
+#include <caf/fwd.hpp>
 #include <caf/stateful_actor.hpp>
 #include <caf/event_based_actor.hpp>
 
 #include "broker/data.hh"
+#include "broker/defaults.hh"
+#include "broker/detail/duplicate_filter.hh"
+#include "broker/detail/evictor.hh"
+#include "broker/detail/preset_dictionary.hh"
+#include "broker/detail/secondary_index.hh"
+#include "broker/detail/store_view.hh"
+#include "broker/detail/string_dictionary.hh"
+#include "broker/detail/subnet_index.hh"
 #include "broker/endpoint.hh"
 #include "broker/fwd.hh"
+#include "broker/detail/timing_wheel.hh"
+#include "broker/internal/generator_file_writer.hh"
 #include "broker/internal/store_actor.hh"
 #include "broker/internal_command.hh"
 #include "broker/publisher_id.hh"
+#include "broker/snapshot.hh"
+#include "broker/store_derivation.hh"
 #include "broker/topic.hh"
 
 namespace broker::internal {
@@ -26,26 +44,133 @@ public:
 
   /// Initializes the object.
   void init(caf::event_based_actor* ptr, std::string&& nm,
-            backend_pointer&& bp, caf::actor&& parent, endpoint::clock* clock);
+            backend_pointer&& bp, caf::actor&& parent, endpoint::clock* clock,
+            detail::evictor&& ev);
 
   /// Sends `x` to all clones.
   void broadcast(internal_command&& x);
 
+  /// Appends `x` to the operation log, trimming the log to
+  /// `defaults::store::op_log_capacity` entries.
+  void log_command(const internal_command& x);
+
   template <class T>
   void broadcast_cmd_to_clones(T cmd) {
     BROKER_DEBUG("broadcast" << cmd << "to" << clones.size() << "clones");
+    internal_command ic{std::move(cmd)};
+    // Sync commands coordinate a single snapshot transfer and are meaningless
+    // to other clones, so they remain unnumbered and unlogged.
+    if constexpr (!std::is_same_v<T, snapshot_sync_command>) {
+      ic.seq = ++command_seq;
+      if (slo_sample_rate > 0 && command_seq % slo_sample_rate == 0)
+        ic.stamp = clock->now();
+      log_command(ic);
+      mark_view_dirty();
+    }
     if (!clones.empty())
-      broadcast(internal_command{std::move(cmd)});
+      broadcast(std::move(ic));
+  }
+
+  /// Flags the in-process read view as out of date and schedules a refresh,
+  /// unless no reader ever attached to the view.
+  void mark_view_dirty();
+
+  /// Publishes the current backend content into the in-process read view.
+  void refresh_view();
+
+  /// Schedules the next view refresh unless one is already pending.
+  void schedule_view_refresh();
+
+  /// Returns whether write coalescing is enabled.
+  bool coalescing() const noexcept {
+    return coalesce_interval.count() > 0;
   }
 
+  /// Marks `key` as dirty instead of broadcasting an update for it right
+  /// away. The next coalesce flush broadcasts one merged update per dirty
+  /// key, carrying the then-current value.
+  void coalesce_update(const data& key, std::optional<timespan> expiry,
+                       publisher_id publisher);
+
+  /// Broadcasts one `put_command` per dirty key and clears the dirty set.
+  void flush_coalesced();
+
+  /// Schedules the next coalesce flush unless one is already pending.
+  void schedule_coalesce_flush();
+
+  /// Applies a mutation of `key` to all secondary indexes and runs all
+  /// derivation functions. Passing `nullptr` for `old_value` records an
+  /// insert, `nullptr` for `new_value` an erase.
+  void update_indexes(const data& key, const data* old_value,
+                      const data* new_value);
+
+  /// A derivation installed on this master: maps each mutation to updates of
+  /// a derived store, forwarded as regular commands to the derived master.
+  struct derivation {
+    store_derivation fn;
+    caf::actor target;
+  };
+
+  /// Runs one derivation function for a mutation of `key` and sends the
+  /// resulting commands to the derived master.
+  void run_derivation(derivation& d, const data& key, const data* old_value,
+                      const data* new_value);
+
+  /// Runs all derivation functions for a mutation of `key`.
+  void run_derivations(const data& key, const data* old_value,
+                       const data* new_value);
+
+  /// Re-populates all secondary indexes from the backend, e.g., after a bulk
+  /// load replaced store content wholesale.
+  void rebuild_indexes();
+
+  /// Adds `key` to the subnet trie if it holds a subnet and the trie exists.
+  void subnet_index_insert(const data& key);
+
+  /// Removes `key` from the subnet trie if it holds a subnet and the trie
+  /// exists.
+  void subnet_index_erase(const data& key);
+
+  /// Returns the subnet trie, building it from a backend snapshot on first
+  /// use. Afterwards, mutations keep the trie current.
+  caf::expected<detail::subnet_index*> lazy_subnet_index();
+
+  /// Evicts entries until the store fits its entry budget again. Each
+  /// eviction runs like a regular erase: it updates the backend, indexes and
+  /// clones and emits an erase event.
+  void enforce_budget();
+
+  /// Runs a backend compaction if no commands arrived since the last check
+  /// and the store shrank substantially below its entry high watermark,
+  /// e.g., after an expiry wave. Records the pause in the telemetry
+  /// registry.
+  void maybe_compact();
+
+  /// Schedules the next compaction check.
+  void schedule_compaction_tick();
+
+  /// Mirrors the current backend statistics into the telemetry registry as
+  /// gauges labeled with the store name and the stat name.
+  void refresh_stats();
+
+  /// Schedules the next stats refresh.
+  void schedule_stats_tick();
+
   void remind(timespan expiry, const data& key);
 
+  /// Schedules the next expiry tick unless one is already pending or no
+  /// expiries exist.
+  void schedule_expiry_tick();
+
   void expire(data& key);
 
   void command(internal_command& cmd);
 
   void command(internal_command::variant_type& cmd);
 
+  /// Appends `cmd` to the command recording file for later replay.
+  void record_command(const internal_command::variant_type& cmd);
+
   void operator()(none);
 
   void operator()(put_command&);
@@ -60,6 +185,10 @@ public:
 
   void operator()(subtract_command&);
 
+  void operator()(multi_put_command&);
+
+  void operator()(multi_erase_command&);
+
   void operator()(snapshot_command&);
 
   void operator()(snapshot_sync_command&);
@@ -68,12 +197,156 @@ public:
 
   void operator()(clear_command&);
 
+  void operator()(transaction_command&);
+
+  /// Bookkeeping for a cursor-based scan. Fork-backed sessions read from the
+  /// copy-on-write fork of the backend; otherwise, the session iterates an
+  /// upfront copy in `remaining`.
+  struct scan_session {
+    broker::snapshot remaining;
+    bool from_fork = false;
+    uint64_t fork_left = 0;
+  };
+
+  /// Open scan sessions by cursor.
+  std::unordered_map<uint64_t, scan_session> scans;
+
+  /// Cursor of the most recently opened scan session.
+  uint64_t next_scan_id = 0;
+
+  /// Bookkeeping for streaming a snapshot to a clone in bounded chunks.
+  /// Reads either from a copy-on-write fork of the backend or, if the backend
+  /// does not support forking, from an upfront copy in `remaining`.
+  struct snapshot_transfer {
+    caf::actor clone;
+    broker::snapshot remaining;
+    uint64_t seq;
+    uint64_t num_chunks;
+    bool from_fork = false;
+    /// String table shared by all chunks of this transfer; see
+    /// broker/detail/snapshot_codec.hh.
+    detail::string_dictionary dict;
+  };
+
+  /// Sends the next chunk of the oldest pending transfer and re-schedules
+  /// itself through the mailbox, so chunks interleave with command traffic.
+  void continue_snapshot_transfer();
+
+  /// Gates `clone` behind a sync point on the update channel and streams the
+  /// current backend content to it, either as a single message or as a
+  /// sequence of bounded chunks.
+  void resync_clone(const caf::actor& clone);
+
   topic clones_topic;
 
   backend_pointer backend;
 
+  /// Captures the full mutation stream of this master when
+  /// "broker.store-recording-directory" is set, for replaying production
+  /// workloads against other backends.
+  generator_file_writer_ptr cmd_recorder;
+
   std::unordered_map<caf::actor_addr, caf::actor> clones;
 
+  std::deque<snapshot_transfer> snapshot_transfers;
+
+  /// Sequence number of the last command broadcasted to the clones.
+  uint64_t command_seq = 0;
+
+  /// Sampling rate for SLO stamping: every Nth broadcast command carries the
+  /// master's wall-clock time so clones can measure the propagation delay.
+  /// Zero disables stamping; see "broker.store.slo-sample-rate".
+  uint64_t slo_sample_rate = defaults::store::slo_sample_rate;
+
+  /// Recently broadcasted commands, ordered by sequence number. Allows
+  /// reconnecting clones to catch up via a delta replay instead of a full
+  /// snapshot.
+  std::deque<std::pair<uint64_t, internal_command>> op_log;
+
+  /// Read-only view of this store for same-process readers, refreshed at
+  /// most once per `defaults::store::tick_interval` while mutations occur.
+  std::shared_ptr<detail::store_view> view;
+
+  /// Marks the view as out of date with respect to the backend.
+  bool view_dirty = false;
+
+  /// Guards against scheduling more than one view refresh at a time.
+  bool view_refresh_pending = false;
+
+  /// Per-key metadata of the last buffered add/subtract operation.
+  struct coalesced_update {
+    std::optional<timespan> expiry;
+    publisher_id publisher;
+  };
+
+  /// Time window for merging add/subtract operations on the same key into a
+  /// single broadcast. Zero disables coalescing.
+  timespan coalesce_interval = defaults::store::coalesce_interval;
+
+  /// Whether snapshot chunks additionally deflate on the wire; see
+  /// "broker.store.snapshot-compression".
+  bool snapshot_compression = defaults::store::snapshot_compression;
+
+  /// Trained deflate dictionaries loaded from
+  /// "broker.compression-dictionary-directory". Never mutated after init, so
+  /// `snapshot_preset` stays valid.
+  detail::preset_dictionary_set preset_dicts;
+
+  /// Dictionary for deflating snapshot chunks: the entry matching the store
+  /// name, falling back to "default". Null leaves chunks dictionary-less.
+  const detail::preset_dictionary* snapshot_preset = nullptr;
+
+  /// Time between idle checks for backend compaction. Zero disables
+  /// compaction; see "broker.store.compaction-interval".
+  timespan compaction_interval = defaults::store::compaction_interval;
+
+  /// Commands processed since the last compaction check. A check only
+  /// compacts when this stayed at zero, i.e., the store sits idle.
+  uint64_t commands_since_compaction_tick = 0;
+
+  /// Largest entry count observed since the last compaction.
+  uint64_t compaction_watermark = 0;
+
+  /// Tracks the stall caused by backend compactions in the telemetry
+  /// registry. Only set when compaction is enabled.
+  caf::telemetry::dbl_histogram* compaction_pause = nullptr;
+
+  /// Keys with applied but not yet broadcasted add/subtract operations.
+  std::unordered_map<data, coalesced_update> coalesced;
+
+  /// Guards against scheduling more than one coalesce flush at a time.
+  bool coalesce_flush_pending = false;
+
+  /// Secondary indexes over store values, maintained incrementally on each
+  /// mutation.
+  std::vector<detail::secondary_index> indexes;
+
+  /// Derivations feeding derived stores from mutations of this master.
+  std::vector<derivation> derivations;
+
+  /// Longest-prefix-match trie over subnet keys, built lazily on the first
+  /// subnet lookup and maintained incrementally afterwards.
+  std::optional<detail::subnet_index> subnet_keys;
+
+  /// Enforces the entry budget of this store, if any.
+  detail::evictor evictor;
+
+  /// Counts evictions of this store in the telemetry registry. Only set when
+  /// the evictor is enabled.
+  caf::telemetry::int_counter* evictions = nullptr;
+
+  /// Drops writer commands this master already applied, keyed by the
+  /// publisher of the command. Writers stamp a per-writer sequence number
+  /// into `internal_command::seq`, which makes resends idempotent.
+  detail::basic_duplicate_filter<publisher_id> writer_filter;
+
+  /// Pending expiries, batched per tick instead of one clock message per
+  /// entry.
+  detail::timing_wheel<data> expiry_wheel;
+
+  /// Guards against scheduling more than one expiry tick at a time.
+  bool expiry_tick_pending = false;
+
   bool exists(const data& key);
 
   static inline constexpr const char* name = "master_actor";
@@ -82,6 +355,6 @@ public:
 caf::behavior master_actor(caf::stateful_actor<master_state>* self,
                            caf::actor core, std::string id,
                            master_state::backend_pointer backend,
-                           endpoint::clock* clock);
+                           endpoint::clock* clock, detail::evictor evictor);
 
 } // namespace broker::internal
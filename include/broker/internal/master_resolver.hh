@@ -1,21 +1,35 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include <caf/actor.hpp>
 #include <caf/behavior.hpp>
 #include <caf/stateful_actor.hpp>
+#include <caf/typed_response_promise.hpp>
 
 namespace broker::internal {
 
 struct master_resolver_state {
-  size_t remaining_responses;
-  caf::actor who_asked;
+  /// Number of in-flight peer queries.
+  size_t remaining_responses = 0;
+
+  /// Remaining fan-out targets while the hinted peer gets its head start.
+  std::vector<caf::actor> peers;
+
+  /// Name of the store whose master we are looking for.
+  std::string name;
+
+  /// Delivers the resolved master together with the peer that answered, or
+  /// an `ec::no_such_master` error once every peer failed or timed out.
+  caf::typed_response_promise<caf::actor, caf::actor> rp;
 };
 
 using master_resolver_actor = caf::stateful_actor<master_resolver_state>;
 
-/// Queries each peer in `peers`.
+/// Queries all peers concurrently for the master of a store and responds
+/// with the first positive answer. An optional hint designates a preferred
+/// peer that gets queried exclusively first.
 caf::behavior master_resolver(master_resolver_actor* self);
 
 } // namespace broker::internal
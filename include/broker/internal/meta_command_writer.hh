@@ -30,6 +30,10 @@ public:
 
   caf::error operator()(const subtract_command& x);
 
+  caf::error operator()(const multi_put_command& x);
+
+  caf::error operator()(const multi_erase_command& x);
+
   caf::error operator()(const snapshot_command& x);
 
   caf::error operator()(const snapshot_sync_command& x);
@@ -38,6 +42,8 @@ public:
 
   caf::error operator()(const clear_command& x);
 
+  caf::error operator()(const transaction_command& x);
+
 private:
   caf::error apply_tag(uint8_t tag);
 
@@ -33,6 +33,11 @@ public:
     return (*this)(x.second);
   }
 
+  caf::error operator()(const std::pair<data, data>& x) {
+    BROKER_TRY((*this)(x.first));
+    return (*this)(x.second);
+  }
+
   caf::error operator()(const std::string& x) {
     BROKER_TRY(apply(data_tag<std::string>()));
     return apply(x.size());
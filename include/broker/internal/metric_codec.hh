@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+#include "broker/data.hh"
+#include "broker/expected.hh"
+
+namespace broker::internal {
+
+/// Encodes scraped metric rows (the meta data row followed by one row per
+/// metric instance, cf. `metric_view`) into a compact binary blob for the
+/// exporter-to-collector channel. The blob stores each distinct metric
+/// family - prefix, name, type, unit, helptext and label dimensions - only
+/// once in a dictionary and packs the per-instance rows as a family
+/// reference plus label values, so the repeated family meta data no longer
+/// dominates the payload. Rows that do not match the `metric_view` schema
+/// are silently dropped.
+std::string encode_metric_rows(const vector& rows);
+
+/// Checks whether `content` carries a blob produced by `encode_metric_rows`.
+bool is_metric_blob(const data& content);
+
+/// Reconstructs the standard row format from a blob produced by
+/// `encode_metric_rows`. Returns `ec::invalid_data` for truncated or
+/// otherwise malformed input.
+expected<vector> decode_metric_rows(const std::string& blob);
+
+} // namespace broker::internal
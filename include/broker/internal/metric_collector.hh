@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
@@ -41,7 +42,9 @@ public:
 
     ~remote_metric() override;
 
-    virtual void update(metric_view mv) = 0;
+    /// Overrides the stored value with the contents of `mv`. Returns whether
+    /// the stored value actually changed.
+    virtual bool update(metric_view mv) = 0;
 
     virtual void append_to(caf::telemetry::collector::prometheus&) = 0;
 
@@ -64,7 +67,9 @@ public:
   size_t insert_or_update(const std::string& endpoint_name, timestamp ts,
                           caf::span<const data> rows);
 
-  /// Returns the recorded metrics in the Prometheus text format.
+  /// Returns the recorded metrics in the Prometheus text format. Renderings
+  /// are cached per metric family: only families whose update generation
+  /// changed since the last call re-render, the rest serve their cached text.
   [[nodiscard]] std::string_view prometheus_text();
 
   void clear();
@@ -79,6 +84,16 @@ private:
   struct metric_scope {
     family_ptr family;
     std::vector<instance_ptr> instances;
+
+    /// Counts updates that changed any instance of this family. Starts at 1
+    /// so that a fresh scope always out-dates `rendered_generation`.
+    uint64_t generation = 1;
+
+    /// Value of `generation` that produced `rendered`.
+    uint64_t rendered_generation = 0;
+
+    /// Cached Prometheus text for this family.
+    std::string rendered;
   };
 
   using name_map = std::unordered_map<std::string, metric_scope>;
@@ -98,8 +113,14 @@ private:
   /// Extracts the label dimensions from `mv`.
   label_span labels_for(const std::string& endpoint_name, metric_view mv);
 
-  /// Retrieves or lazily creates a metric object for `mv`.
-  remote_metric* instance(const std::string& endpoint_name, metric_view mv);
+  /// Retrieves or lazily creates the scope that holds metric objects for the
+  /// prefix and name of `mv`.
+  metric_scope& scope_of(metric_view mv);
+
+  /// Retrieves or lazily creates a metric object for `mv` in `scope`. Bumps
+  /// the generation of `scope` when adding a new family or instance.
+  remote_metric* instance(metric_scope& scope, const std::string& endpoint_name,
+                          metric_view mv);
 
   /// Caches labels (key/value pairs) for instance lookups.
   std::vector<caf::telemetry::label_view> labels_;
@@ -113,8 +134,12 @@ private:
   /// Stores last-seen-times by endpoints.
   std::unordered_map<std::string, timestamp> last_seen_;
 
-  /// Generates Prometheus-formatted text.
+  /// Generates Prometheus-formatted text for one family at a time.
   caf::telemetry::collector::prometheus generator_;
+
+  /// Concatenation of the per-family renderings, rebuilt only when at least
+  /// one family re-rendered.
+  std::string text_;
 };
 
 } // namespace broker::internal
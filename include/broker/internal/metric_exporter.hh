@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <vector>
@@ -11,9 +12,12 @@
 #include <caf/stateful_actor.hpp>
 #include <caf/telemetry/importer/process.hpp>
 
+#include "broker/defaults.hh"
 #include "broker/detail/next_tick.hh"
 #include "broker/filter_type.hh"
+#include "broker/internal/lag_watchdog.hh"
 #include "broker/internal/logger.hh"
+#include "broker/internal/metric_codec.hh"
 #include "broker/internal/metric_scraper.hh"
 #include "broker/internal/type_id.hh"
 #include "broker/message.hh"
@@ -28,12 +32,16 @@ struct metric_exporter_params {
   caf::timespan interval;
   topic target;
   std::string id;
+  bool binary = false;
+  size_t full_sync_interval = defaults::metrics::full_sync_interval;
   static metric_exporter_params from(const caf::actor_system_config& cfg);
   [[nodiscard]] bool valid() const noexcept;
 };
 
 /// State for an actor that periodically exports local metrics by publishing
-/// `data`-encoded metrics to a user-defined Broker topic.
+/// `data`-encoded metrics to a user-defined Broker topic. The endpoint spawns
+/// this actor detached: scraping the registry then runs on a dedicated thread
+/// and never blocks message dispatch on the shared scheduler.
 template <class Self>
 class metric_exporter_state {
 public:
@@ -41,11 +49,16 @@ public:
 
   metric_exporter_state(Self* self, caf::actor core,
                         std::vector<std::string> selected_prefixes,
-                        caf::timespan interval, topic target, std::string id)
+                        caf::timespan interval, topic target, std::string id,
+                        bool binary = false,
+                        size_t full_sync_interval
+                        = defaults::metrics::full_sync_interval)
     : self(self),
       core(std::move(core)),
       interval(interval),
       target(std::move(target)),
+      binary(binary),
+      full_sync_interval(full_sync_interval),
       proc_importer(self->system().metrics()),
       impl(std::move(selected_prefixes), std::move(id)) {
     // nop
@@ -55,7 +68,8 @@ public:
                         metric_exporter_params&& params)
     : metric_exporter_state(
       self, std::move(core), std::move(params.selected_prefixes),
-      params.interval, std::move(params.target), std::move(params.id)) {
+      params.interval, std::move(params.target), std::move(params.id),
+      params.binary, params.full_sync_interval) {
     //nop
   }
 
@@ -70,14 +84,13 @@ public:
       }
     });
     cold_boot();
+    enroll_with_lag_watchdog(self);
     return {
       [this](caf::tick_atom) {
         if (running_) {
           proc_importer.update();
           impl.scrape(self->system().metrics());
-          // Send nothing if we only have meta data (or nothing) to send.
-          if (const auto& rows = impl.rows(); rows.size() > 1)
-            self->send(core, atom::publish_v, make_data_message(target, rows));
+          publish_rows();
           auto t = detail::next_tick(tick_init, self->clock().now(), interval);
           self->scheduled_send(self, t, caf::tick_atom_v);
         }
@@ -94,11 +107,52 @@ public:
       [this](atom::put, filter_type& new_prefixes_filter) {
         set_prefixes(std::move(new_prefixes_filter));
       },
+      [this](atom::ping, timestamp sent) {
+        record_scheduler_lag(self->system(), "telemetry-exporter", sent);
+      },
     };
   }
 
   // -- utility functions ------------------------------------------------------
 
+  /// Publishes the rows of the last scrape. Most scrapes ship only rows that
+  /// changed since the previous one (most gauges are static between events);
+  /// every `full_sync_interval`-th publish ships the full set, so late
+  /// subscribers and collectors converge without tracking deletions.
+  void publish_rows() {
+    const auto& rows = impl.rows();
+    // Send nothing if we only have meta data (or nothing) to send.
+    if (rows.size() <= 1)
+      return;
+    if (full_sync_countdown_ <= 1) {
+      publish(rows);
+      full_sync_countdown_ = full_sync_interval;
+    } else {
+      vector delta;
+      delta.reserve(rows.size());
+      // The meta row (scraper ID plus timestamp) travels with every delta.
+      // Even an otherwise empty delta goes out: collectors rely on the
+      // periodic publish as a liveness signal.
+      delta.emplace_back(rows[0]);
+      for (size_t i = 1; i < rows.size(); ++i)
+        if (!std::binary_search(last_rows_.begin(), last_rows_.end(), rows[i]))
+          delta.emplace_back(rows[i]);
+      publish(delta);
+      --full_sync_countdown_;
+    }
+    last_rows_.assign(rows.begin() + 1, rows.end());
+    std::sort(last_rows_.begin(), last_rows_.end());
+  }
+
+  /// Ships `rows` to the target topic, honoring the binary setting.
+  void publish(const vector& rows) {
+    if (binary)
+      self->send(core, atom::publish_v,
+                 make_data_message(target, encode_metric_rows(rows)));
+    else
+      self->send(core, atom::publish_v, make_data_message(target, rows));
+  }
+
   [[nodiscard]] bool has_valid_config() const noexcept {
     return !target.empty();
   }
@@ -174,6 +228,14 @@ public:
   /// Configures the topic for periodically publishing scrape results to.
   topic target;
 
+  /// Configures whether scrape results go out in the compact binary format
+  /// (cf. `metric_codec`) instead of plain `data` rows.
+  bool binary = false;
+
+  /// Configures how many publishes lie between two full exports; see
+  /// `publish_rows`.
+  size_t full_sync_interval = defaults::metrics::full_sync_interval;
+
   /// Adds metrics for CPU and RAM usage.
   caf::telemetry::importer::process proc_importer;
 
@@ -181,6 +243,14 @@ public:
   metric_scraper impl;
 
   bool running_ = false;
+
+  /// Rows of the previous scrape (sans meta row), sorted for lookup when
+  /// computing deltas.
+  vector last_rows_;
+
+  /// Publishes remaining until the next full export. Starts at zero, so the
+  /// very first publish always ships the full set.
+  size_t full_sync_countdown_ = 0;
 };
 
 using metric_exporter_actor
@@ -5,6 +5,8 @@
 
 #include <caf/telemetry/metric_registry.hpp>
 
+#include <string_view>
+
 namespace broker::internal {
 
 /// Scrapes local CAF metrics and encodes them into `data` objects (for
@@ -91,6 +93,16 @@ private:
   void add_row(const caf::telemetry::metric_family* family, std::string type,
                table labels, T value);
 
+  /// @copydoc add_row
+  template <class T>
+  void add_row(std::string_view prefix, std::string_view name,
+               std::string type, std::string_view unit,
+               std::string_view helptext, bool is_sum, table labels, T value);
+
+  /// Appends rows for all @ref telemetry::log_histogram instances, which keep
+  /// their cells outside of the CAF registry.
+  void add_log_histograms();
+
   // -- member variables -------------------------------------------------------
 
   /// Configures which metrics the scraper includes.
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "broker/defaults.hh"
 #include "broker/detail/lift.hh"
 #include "broker/error.hh"
 #include "broker/internal/logger.hh"
@@ -10,6 +11,11 @@
 #include <caf/allowed_unsafe_message_type.hpp>
 #include <caf/response_promise.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <random>
+
 namespace broker::internal::mixin {
 
 /// Adds these handlers:
@@ -35,13 +41,23 @@ public:
   template <class... Ts>
   explicit connector(Ts&&... xs)
     : super(std::forward<Ts>(xs)...), cache_(super::self()) {
-    // nop
+    max_pending_connects_
+      = caf::get_or(super::self()->system().config(),
+                    "broker.max-pending-connects",
+                    defaults::max_pending_connects);
   }
 
   void try_peering(const network_info& addr, caf::response_promise rp,
                    uint32_t count) {
     BROKER_TRACE(BROKER_ARG(count));
     auto self = super::self();
+    // Bound the number of concurrent connection attempts; a cold start with
+    // many unreachable peers otherwise floods the middleman.
+    if (connects_in_flight_ >= max_pending_connects_) {
+      deferred_connects_.emplace_back(retry_state{addr, std::move(rp), count});
+      return;
+    }
+    ++connects_in_flight_;
     // Fetch the comm. handle from the cache and with that fetch the ID from the
     // remote peer via direct request messages.
     cache_.fetch(
@@ -49,20 +65,51 @@ public:
       [=](communication_handle_type hdl) mutable {
         BROKER_DEBUG("lookup successful:" << BROKER_ARG(addr)
                                           << BROKER_ARG(hdl));
+        dref().connect_slot_freed();
         dref().start_peering(hdl.node(), hdl, std::move(rp));
       },
       [=](caf::error err) mutable {
         BROKER_DEBUG("lookup failed:" << BROKER_ARG(addr) << BROKER_ARG(err));
+        dref().connect_slot_freed();
         dref().peer_unavailable(addr);
         if (addr.retry.count() == 0 && ++count < 10) {
           rp.deliver(std::move(err));
         } else {
-          self->delayed_send(self, addr.retry,
-                             retry_state{addr, std::move(rp), count});
+          self->delayed_send(self, backoff_delay(addr.retry, count),
+                             retry_state{addr, std::move(rp), count + 1});
         }
       });
   }
 
+  /// Releases one connection slot and resumes a deferred attempt, if any.
+  void connect_slot_freed() {
+    if (connects_in_flight_ > 0)
+      --connects_in_flight_;
+    if (!deferred_connects_.empty()
+        && connects_in_flight_ < max_pending_connects_) {
+      auto st = std::move(deferred_connects_.front());
+      deferred_connects_.pop_front();
+      try_peering(st.addr, std::move(st.rp), st.count);
+    }
+  }
+
+  /// Computes the delay before reconnection attempt number `count` + 1: the
+  /// per-peering retry interval doubled per failed attempt, capped at
+  /// `defaults::max_peer_retry_delay`, with ±25% jitter so peers that lost
+  /// the same target do not reconnect in lockstep.
+  static caf::timespan backoff_delay(timeout::seconds base, uint32_t count) {
+    auto delay = std::chrono::duration_cast<caf::timespan>(base);
+    constexpr auto cap
+      = std::chrono::duration_cast<caf::timespan>(defaults::max_peer_retry_delay);
+    for (uint32_t i = 0; i < count && delay < cap; ++i)
+      delay += delay;
+    delay = std::min(delay, cap);
+    thread_local std::minstd_rand engine{std::random_device{}()};
+    std::uniform_real_distribution<double> jitter{0.75, 1.25};
+    auto scaled = static_cast<double>(delay.count()) * jitter(engine);
+    return caf::timespan{static_cast<caf::timespan::rep>(scaled)};
+  }
+
   void try_publish(const network_info& addr, data_message& msg,
                    caf::response_promise rp) {
     auto self = super::self();
@@ -114,6 +161,17 @@ public:
           dref().unpeer(*hdl);
         else
           dref().cannot_remove_peer(addr);
+      },
+      [=](atom::unpeer, atom::drain, const network_info& addr,
+          caf::timespan drain_timeout) {
+        auto rp = super::self()->make_response_promise();
+        if (auto hdl = cache_.find(addr)) {
+          dref().unpeer_gracefully(hdl->node(), *hdl, drain_timeout,
+                                   std::move(rp));
+        } else {
+          rp.deliver(caf::make_error(ec::peer_invalid));
+          dref().cannot_remove_peer(addr);
+        }
       });
   }
 
@@ -128,6 +186,15 @@ private:
 
   /// Associates network addresses to remote actor handles and vice versa.
   network_cache cache_;
+
+  /// Maximum number of concurrent connection attempts.
+  size_t max_pending_connects_ = defaults::max_pending_connects;
+
+  /// Number of connection attempts currently in flight.
+  size_t connects_in_flight_ = 0;
+
+  /// Attempts waiting for a free connection slot.
+  std::deque<retry_state> deferred_connects_;
 };
 
 } // namespace broker::internal::mixin
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <unordered_map>
 
@@ -8,6 +9,9 @@
 
 #include "broker/backend.hh"
 #include "broker/backend_options.hh"
+#include "broker/defaults.hh"
+#include "broker/detail/evictor.hh"
+#include "broker/detail/flat_map.hh"
 #include "broker/detail/lift.hh"
 #include "broker/detail/make_backend.hh"
 #include "broker/endpoint.hh"
@@ -16,6 +20,7 @@
 #include "broker/internal/logger.hh"
 #include "broker/internal/master_actor.hh"
 #include "broker/internal/master_resolver.hh"
+#include "broker/internal/shard_router.hh"
 #include "broker/topic.hh"
 
 namespace broker::internal::mixin {
@@ -33,6 +38,8 @@ public:
 
   static constexpr auto spawn_flags = caf::linked + caf::lazy_init;
 
+  static constexpr auto detached_spawn_flags = spawn_flags + caf::detached;
+
   // --- construction and destruction ------------------------------------------
 
   template <class... Ts>
@@ -51,6 +58,13 @@ public:
     return dref().has_remote_subscriber(name / topic::master_suffix());
   }
 
+  /// Returns whether data store actors run on dedicated threads instead of
+  /// sharing the worker pool with this actor.
+  bool detached_stores() {
+    return caf::get_or(super::self()->system().config(),
+                       "broker.detach-stores", false);
+  }
+
   const auto& masters() const noexcept {
     return masters_;
   }
@@ -59,6 +73,12 @@ public:
     return clones_;
   }
 
+  /// Returns the backend type of each attached master, e.g., for selecting
+  /// the stores worth checkpointing.
+  const auto& master_backends() const noexcept {
+    return master_backends_;
+  }
+
   // -- data store management --------------------------------------------------
 
   /// Attaches a master for given store to this peer.
@@ -73,27 +93,105 @@ public:
       BROKER_WARNING("remote master with same name exists already");
       return caf::make_error(ec::master_exists);
     }
+    // The "max-entries" option bounds the store; "eviction-policy" selects
+    // how to shrink it back to the bound (default: "lru").
+    count max_entries = 0;
+    if (auto i = opts.find("max-entries"); i != opts.end())
+      if (auto n = get_if<count>(i->second))
+        max_entries = *n;
+    auto ev_policy = detail::evictor::policy::disabled;
+    if (max_entries > 0) {
+      ev_policy = detail::evictor::policy::lru;
+      if (auto i = opts.find("eviction-policy"); i != opts.end()) {
+        std::optional<detail::evictor::policy> parsed;
+        if (auto str = get_if<std::string>(i->second))
+          parsed = detail::evictor::parse_policy(*str);
+        if (!parsed) {
+          BROKER_WARNING("invalid eviction-policy option for" << name);
+          return caf::make_error(ec::invalid_data, "invalid eviction-policy");
+        }
+        ev_policy = *parsed;
+      }
+    }
+    // The "shards" option selects the sharded master mode: N master shards
+    // behind one router, each owning a key-hash partition.
+    count num_shards = 0;
+    if (auto i = opts.find("shards"); i != opts.end())
+      if (auto n = get_if<count>(i->second))
+        num_shards = *n;
+    if (num_shards > 1)
+      return attach_sharded_master(name, backend_type, std::move(opts),
+                                   num_shards, ev_policy, max_entries);
     auto ptr = detail::make_backend(backend_type, std::move(opts));
     if (!ptr)
       return caf::make_error(ec::backend_failure);
     BROKER_INFO("spawning new master:" << name);
     auto self = super::self();
-    auto ms = self->template spawn<spawn_flags>(master_actor, self, name,
-                                                std::move(ptr), clock_);
+    auto ev = detail::evictor{ev_policy, max_entries};
+    auto ms = detached_stores()
+                ? self->template spawn<detached_spawn_flags>(
+                    master_actor, self, name, std::move(ptr), clock_,
+                    std::move(ev))
+                : self->template spawn<spawn_flags>(master_actor, self, name,
+                                                    std::move(ptr), clock_,
+                                                    std::move(ev));
     filter_type filter{name / topic::master_suffix()};
     if (auto err = dref().add_store(ms, filter))
       return err;
     masters_.emplace(name, ms);
+    master_backends_.emplace(name, backend_type);
+    return ms;
+  }
+
+  /// Attaches a sharded master for the given store to this peer: one
+  /// `shard_router` fronting `num_shards` master actors, each with its own
+  /// backend instance. File-backed backends get a per-shard path suffix.
+  caf::result<caf::actor>
+  attach_sharded_master(const std::string& name, backend backend_type,
+                        backend_options opts, count num_shards,
+                        detail::evictor::policy ev_policy, count max_entries) {
+    BROKER_INFO("spawning sharded master:" << name << "with" << num_shards
+                                           << "shards");
+    std::vector<shard_router_state::backend_pointer> backends;
+    backends.reserve(num_shards);
+    for (count i = 0; i < num_shards; ++i) {
+      auto shard_opts = opts;
+      if (auto j = shard_opts.find("path"); j != shard_opts.end())
+        if (auto path = get_if<std::string>(j->second))
+          *path += "-shard-" + std::to_string(i);
+      auto ptr = detail::make_backend(backend_type, std::move(shard_opts));
+      if (!ptr)
+        return caf::make_error(ec::backend_failure);
+      backends.push_back(std::move(ptr));
+    }
+    auto self = super::self();
+    // An entry budget applies to the whole logical store; each shard enforces
+    // its even share.
+    auto shard_budget = (max_entries + num_shards - 1) / num_shards;
+    auto ms = detached_stores()
+                ? self->template spawn<detached_spawn_flags>(
+                    shard_router, self, name, std::move(backends), clock_,
+                    ev_policy, shard_budget)
+                : self->template spawn<spawn_flags>(
+                    shard_router, self, name, std::move(backends), clock_,
+                    ev_policy, shard_budget);
+    filter_type filter{name / topic::master_suffix()};
+    if (auto err = dref().add_store(ms, filter))
+      return err;
+    masters_.emplace(name, ms);
+    master_backends_.emplace(name, backend_type);
     return ms;
   }
 
   /// Attaches a clone for given store to this peer.
   caf::result<caf::actor>
   attach_clone(const std::string& name, double resync_interval,
-               double stale_interval, double mutation_buffer_interval) {
+               double stale_interval, double mutation_buffer_interval,
+               bool local_writes) {
     BROKER_TRACE(BROKER_ARG(name)
                  << BROKER_ARG(resync_interval) << BROKER_ARG(stale_interval)
-                 << BROKER_ARG(mutation_buffer_interval));
+                 << BROKER_ARG(mutation_buffer_interval)
+                 << BROKER_ARG(local_writes));
     if (auto i = masters_.find(name); i != masters_.end()) {
       BROKER_WARNING("attempted to run clone & master on the same endpoint");
       return caf::make_error(ec::no_such_master);
@@ -102,10 +200,13 @@ public:
       return i->second;
     BROKER_INFO("spawning new clone:" << name);
     auto self = super::self();
-    auto cl = self->template spawn<spawn_flags>(clone_actor, self, name,
-                                                resync_interval, stale_interval,
-                                                mutation_buffer_interval,
-                                                clock_);
+    auto cl = detached_stores()
+                ? self->template spawn<detached_spawn_flags>(
+                    clone_actor, self, name, resync_interval, stale_interval,
+                    mutation_buffer_interval, local_writes, clock_)
+                : self->template spawn<spawn_flags>(
+                    clone_actor, self, name, resync_interval, stale_interval,
+                    mutation_buffer_interval, local_writes, clock_);
     filter_type filter{name / topic::clone_suffix()};
     if (auto err = dref().add_store(cl, filter))
       return err;
@@ -141,6 +242,7 @@ public:
     };
     f(masters_);
     f(clones_);
+    master_backends_.clear();
   }
 
   // -- factories --------------------------------------------------------------
@@ -166,6 +268,16 @@ public:
           self->send(who_asked, atom::master_v, i->second);
           return;
         }
+        if (auto j = unresolved_.find(name); j != unresolved_.end()) {
+          if (std::chrono::steady_clock::now() < j->second) {
+            BROKER_DEBUG("negative cache hit for master" << name);
+            self->send(who_asked, atom::master_v,
+                       caf::make_error(ec::no_such_master,
+                                       "recently failed to resolve"));
+            return;
+          }
+          unresolved_.erase(j);
+        }
         auto peers = dref().peer_handles();
         if (peers.empty()) {
           BROKER_INFO("no peers to ask for the master");
@@ -173,9 +285,27 @@ public:
                      caf::make_error(ec::no_such_master, "no peers"));
           return;
         }
+        // The peer that answered the last successful resolution gets an
+        // exclusive first shot before the query fans out to everyone.
+        caf::actor hint;
+        if (auto j = resolve_hints_.find(name); j != resolve_hints_.end())
+          hint = j->second;
         auto resolver = self->template spawn<caf::lazy_init>(master_resolver);
-        self->send(resolver, std::move(peers), std::move(name),
-                   std::move(who_asked));
+        self
+          ->request(resolver, caf::infinite, std::move(peers), name,
+                    std::move(hint))
+          .then(
+            [this, self, name, who_asked](caf::actor& master,
+                                          caf::actor& peer) {
+              resolve_hints_[name] = std::move(peer);
+              self->send(who_asked, atom::master_v, std::move(master));
+            },
+            [this, self, name, who_asked](caf::error& err) {
+              resolve_hints_.erase(name);
+              unresolved_[name] = std::chrono::steady_clock::now()
+                                  + defaults::store::resolve_negative_cache;
+              self->send(who_asked, atom::master_v, std::move(err));
+            });
       });
   }
 
@@ -191,11 +321,24 @@ protected:
   /// Enables manual time management by the user.
   endpoint::clock* clock_;
 
-  /// Stores all master actors created by this core.
-  std::unordered_map<std::string, caf::actor> masters_;
+  /// Stores all master actors created by this core. Store creation is rare
+  /// while name lookups run per command, hence the flat map.
+  detail::flat_map<std::string, caf::actor> masters_;
+
+  /// Remembers the backend type for each entry in `masters_`.
+  detail::flat_map<std::string, backend> master_backends_;
 
   /// Stores all clone actors created by this core.
-  std::unordered_map<std::string, caf::actor> clones_;
+  detail::flat_map<std::string, caf::actor> clones_;
+
+  /// Remembers, per store name, which peer answered the last successful
+  /// master resolution. Subsequent resolutions query that peer first.
+  std::unordered_map<std::string, caf::actor> resolve_hints_;
+
+  /// Remembers, per store name, until when a failed resolution answers
+  /// repeated attempts immediately instead of fanning out again.
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+    unresolved_;
 };
 
 } // namespace broker::internal::mixin
@@ -47,6 +47,10 @@ public:
     super::peer_connected(remote_id, hdl);
   }
 
+  core_recorder& recorder() noexcept {
+    return rec_;
+  }
+
 private:
   core_recorder rec_;
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <set>
 #include <string>
@@ -41,27 +42,70 @@ public:
       f(*y);
       return;
     }
+    // Address literals connect directly; hostnames go through the caching
+    // resolver first so a slow or dead DNS server cannot stall this actor.
+    if (is_ip_literal(x.address)) {
+      connect(x, x.address, std::move(f), std::move(g));
+      return;
+    }
+    if (auto entry = dns_lookup(x.address)) {
+      if (entry->address.empty()) {
+        // Negative cache hit: fail fast instead of hammering the resolver.
+        g(caf::make_error(ec::peer_unavailable,
+                          "cannot resolve hostname: " + x.address));
+        return;
+      }
+      connect(x, entry->address, std::move(f), std::move(g));
+      return;
+    }
+    BROKER_INFO("resolving hostname" << x.address);
+    self->request(resolver(), infinite, atom::resolve_v, x.address)
+      .then(
+        [=](std::string& address) mutable {
+          dns_store(x.address, address);
+          connect(x, address, std::move(f), std::move(g));
+        },
+        [=](caf::error& err) mutable {
+          dns_store(x.address, std::string{});
+          count_connect_failure();
+          g(std::move(err));
+        });
+  }
+
+  /// Connects to `resolved` (an address literal) and caches the resulting
+  /// handle under `x`.
+  template <class OnResult, class OnError>
+  void connect(const network_info& x, const std::string& resolved, OnResult f,
+               OnError g) {
+    using namespace caf;
     BROKER_INFO("initiating connection to"
                 << (x.address + ":" + std::to_string(x.port))
                 << (use_ssl ? "(SSL)" : "(no SSL)"));
     auto hdl = (use_ssl ? self->home_system().openssl_manager().actor_handle()
                         : self->home_system().middleman().actor_handle());
-    self->request(hdl, infinite, atom::connect_v, x.address, x.port)
+    auto t0 = std::chrono::steady_clock::now();
+    self->request(hdl, infinite, atom::connect_v, resolved, x.port)
       .then(
         [=](const node_id&, strong_actor_ptr& res,
             std::set<std::string>& ifs) mutable {
-          if (!ifs.empty())
+          if (!ifs.empty()) {
+            count_connect_failure();
             g(caf::make_error(sec::unexpected_actor_messaging_interface));
-          else if (res == nullptr)
+          } else if (res == nullptr) {
+            count_connect_failure();
             g(caf::make_error(sec::no_actor_published_at_port));
-          else {
+          } else {
+            observe_connect(secs_since(t0));
             auto hdl = actor_cast<actor>(std::move(res));
             hdls_.emplace(x, hdl);
             addrs_.emplace(hdl, x);
             f(std::move(hdl));
           }
         },
-        [=](caf::error& err) mutable { g(std::move(err)); });
+        [=](caf::error& err) mutable {
+          count_connect_failure();
+          g(std::move(err));
+        });
   }
 
   template <class OnResult, class OnError>
@@ -103,15 +147,61 @@ public:
   void remove(const network_info& x);
 
 private:
+  /// Caches the outcome of one hostname lookup. An empty address marks a
+  /// failed lookup (negative caching).
+  struct dns_entry {
+    std::string address;
+    std::chrono::steady_clock::time_point expiry;
+  };
+
+  /// Returns whether `address` is an IPv4 or IPv6 address literal.
+  static bool is_ip_literal(const std::string& address);
+
+  /// Returns the cached lookup result for `host` or `nullptr` if the cache
+  /// holds no (unexpired) entry.
+  const dns_entry* dns_lookup(const std::string& host);
+
+  /// Caches `address` as the lookup result for `host`. An empty `address`
+  /// records a failed lookup, which expires after the (shorter) negative TTL.
+  void dns_store(const std::string& host, std::string address);
+
+  /// Returns the resolver actor, spawning it on first use. The resolver runs
+  /// detached because it wraps the blocking system resolver.
+  caf::actor& resolver();
+
+  /// Records one completed connection setup, including the transport
+  /// handshake (full TLS handshake when running with SSL), in the
+  /// "broker.connect-duration" histogram.
+  void observe_connect(double seconds);
+
+  /// Counts one failed connection attempt in "broker.connect-failures".
+  void count_connect_failure();
+
+  /// Returns the seconds elapsed since `t0` as a double.
+  static double secs_since(std::chrono::steady_clock::time_point t0) {
+    std::chrono::duration<double> diff = std::chrono::steady_clock::now() - t0;
+    return diff.count();
+  }
+
   // Parent.
   caf::event_based_actor* self;
   bool use_ssl = true;
 
+  // Telemetry instances, fetched lazily on first use (labeled by transport).
+  caf::telemetry::dbl_histogram* connect_duration_ = nullptr;
+  caf::telemetry::int_counter* connect_failures_ = nullptr;
+
   // Maps remote actor handles to network addresses.
   std::unordered_map<caf::actor, network_info> addrs_;
 
   // Maps network addresses to remote actor handles.
   std::unordered_map<network_info, caf::actor> hdls_;
+
+  // Maps hostnames to resolved addresses with an expiry time.
+  std::unordered_map<std::string, dns_entry> dns_cache_;
+
+  // Handle to the resolver actor, spawned lazily.
+  caf::actor resolver_;
 };
 
 } // namespace broker::internal
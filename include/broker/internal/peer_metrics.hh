@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <caf/fwd.hpp>
+
+#include "broker/fwd.hh"
+#include "broker/message.hh"
+
+namespace broker::internal {
+
+/// Bundles per-peer telemetry instances for traffic accounting. All
+/// instances carry the label "peer" with the ID of the remote endpoint and
+/// appear in the telemetry registry under the "broker" prefix, i.e., they
+/// ship with regular metric exports and Prometheus scrapes. A
+/// default-constructed bundle turns all member functions into no-ops, which
+/// allows the stream managers to call into the bundle unconditionally and
+/// only pay for the accounting on paths that represent peers.
+class peer_metrics {
+public:
+  peer_metrics() noexcept = default;
+
+  peer_metrics(caf::telemetry::metric_registry& reg,
+               const std::string& peer_id);
+
+  peer_metrics(const peer_metrics&) noexcept = default;
+
+  peer_metrics& operator=(const peer_metrics&) noexcept = default;
+
+  /// Returns whether this bundle points to registry instances.
+  explicit operator bool() const noexcept {
+    return messages_in_ != nullptr;
+  }
+
+  /// Counts one batch of `num_messages` with an estimated total wire size of
+  /// `num_bytes` received from the peer.
+  void count_inbound_batch(size_t num_messages, size_t num_bytes) noexcept;
+
+  /// Counts `num_messages` with an estimated total wire size of `num_bytes`
+  /// buffered for shipping to the peer.
+  void count_outbound(size_t num_messages, size_t num_bytes) noexcept;
+
+  /// Counts one batch emitted to the peer.
+  void count_outbound_batch() noexcept;
+
+  /// Counts `num_messages` that the filter of the peer rejected.
+  void count_rejected(size_t num_messages) noexcept;
+
+  /// Records how long messages were buffered before going out to the peer.
+  void observe_queue_time(double seconds) noexcept;
+
+  /// Records the time between starting and completing the stream handshake.
+  void observe_handshake_rtt(double seconds) noexcept;
+
+private:
+  caf::telemetry::int_counter* messages_in_ = nullptr;
+  caf::telemetry::int_counter* messages_out_ = nullptr;
+  caf::telemetry::int_counter* bytes_in_ = nullptr;
+  caf::telemetry::int_counter* bytes_out_ = nullptr;
+  caf::telemetry::int_counter* batches_in_ = nullptr;
+  caf::telemetry::int_counter* batches_out_ = nullptr;
+  caf::telemetry::int_counter* rejected_ = nullptr;
+  caf::telemetry::dbl_histogram* queue_time_ = nullptr;
+  caf::telemetry::dbl_histogram* handshake_rtt_ = nullptr;
+};
+
+/// Returns a rough estimate for the wire size of `msg` in bytes. The
+/// estimate traverses the payload instead of serializing it, so it reflects
+/// relative traffic volume rather than exact byte counts on the wire.
+size_t estimated_wire_size(const data_message& msg) noexcept;
+
+/// @copydoc estimated_wire_size
+size_t estimated_wire_size(const command_message& msg) noexcept;
+
+/// @copydoc estimated_wire_size
+size_t estimated_wire_size(const node_message& msg) noexcept;
+
+} // namespace broker::internal
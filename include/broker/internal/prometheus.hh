@@ -8,6 +8,7 @@
 #include <caf/io/broker.hpp>
 #include <caf/io/connection_handle.hpp>
 
+#include "broker/detail/http_metrics_server.hh"
 #include "broker/filter_type.hh"
 #include "broker/internal/metric_collector.hh"
 #include "broker/internal/metric_exporter.hh"
@@ -57,6 +58,14 @@ private:
   /// Optional export of local metrics if the user configured a value for
   /// "broker.metrics.export.topic".
   std::unique_ptr<exporter_state_type> exporter_;
+
+#ifndef BROKER_WINDOWS
+  /// Optional keep-alive HTTP server for scrapes if the user configured a
+  /// port via "broker.metrics.keepalive-port". The server runs on its own
+  /// thread and serves a cached exposition buffer that this actor refreshes
+  /// periodically, so scrape traffic never touches the CAF scheduler.
+  std::unique_ptr<detail::http_metrics_server> http_server_;
+#endif
 };
 
 } // namespace broker::internal
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <caf/actor.hpp>
+#include <caf/behavior.hpp>
+#include <caf/stateful_actor.hpp>
+#include <caf/event_based_actor.hpp>
+
+#include "broker/data.hh"
+#include "broker/detail/abstract_backend.hh"
+#include "broker/detail/evictor.hh"
+#include "broker/endpoint.hh"
+#include "broker/fwd.hh"
+#include "broker/internal_command.hh"
+
+namespace broker::internal {
+
+/// Fans a logical master store out over N `master_actor` shards, each owning
+/// one key-hash partition. The router registers under the store name in place
+/// of a single master and forwards every keyed command or query to the shard
+/// owning the key, so mutations on disjoint partitions run in parallel.
+/// Key-less operations (keys queries, clear) fan out to all shards.
+class shard_router_state {
+public:
+  using backend_pointer = std::unique_ptr<detail::abstract_backend>;
+
+  /// Initializes the state and spawns one linked `master_actor` per backend.
+  /// Each shard enforces an entry budget of `ev_max_entries` under
+  /// `ev_policy`, unless the policy is `disabled`.
+  void init(caf::event_based_actor* ptr, std::string&& nm, caf::actor&& core,
+            std::vector<backend_pointer>&& backends, endpoint::clock* clock,
+            detail::evictor::policy ev_policy, uint64_t ev_max_entries);
+
+  /// Returns the shard owning `key`.
+  const caf::actor& shard_for(const data& key) const;
+
+  /// Forwards `cmd` to the owning shard, splitting multi-key commands into
+  /// per-shard pieces and fanning key-less commands out to all shards.
+  void route(internal_command& cmd);
+
+  caf::event_based_actor* self = nullptr;
+
+  std::string id;
+
+  caf::actor core;
+
+  std::vector<caf::actor> shards;
+
+  /// Open scans by cursor, each pointing at the shard currently being
+  /// iterated and the cursor within that shard.
+  std::unordered_map<uint64_t, std::pair<size_t, uint64_t>> scans;
+
+  /// Cursor of the most recently opened scan.
+  uint64_t next_scan_id = 0;
+
+  static inline constexpr const char* name = "shard_router";
+};
+
+caf::behavior shard_router(caf::stateful_actor<shard_router_state>* self,
+                           caf::actor core, std::string id,
+                           std::vector<shard_router_state::backend_pointer>
+                             backends,
+                           endpoint::clock* clock,
+                           detail::evictor::policy ev_policy,
+                           uint64_t ev_max_entries);
+
+} // namespace broker::internal
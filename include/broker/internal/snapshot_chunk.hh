@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <caf/span.hpp>
+
+namespace broker::internal {
+
+/// One chunk of a snapshot transfer from a master to a clone, holding
+/// `broker::detail::encode_snapshot` output. Shipping codec bytes instead of
+/// a `broker::snapshot` keeps the dictionary compression of the transfer
+/// intact across the CAF serialization boundary.
+struct snapshot_chunk {
+  /// Position of this chunk in the transfer, starting at 0.
+  uint64_t seq;
+
+  /// Total number of chunks in the transfer.
+  uint64_t num_chunks;
+
+  /// The encoded entries; see broker/detail/snapshot_codec.hh.
+  std::vector<std::byte> bytes;
+};
+
+/// @relates snapshot_chunk
+template <class Inspector>
+bool inspect(Inspector& f, snapshot_chunk& x) {
+  // CAF has no inspector access for std::byte; the buffer travels as a raw
+  // span prefixed by its size.
+  if constexpr (Inspector::is_loading) {
+    uint64_t num_bytes = 0;
+    if (!f.value(x.seq) || !f.value(x.num_chunks) || !f.value(num_bytes))
+      return false;
+    x.bytes.resize(num_bytes);
+    auto first = reinterpret_cast<caf::byte*>(x.bytes.data());
+    return f.value(caf::make_span(first, x.bytes.size()));
+  } else {
+    auto num_bytes = static_cast<uint64_t>(x.bytes.size());
+    auto first = reinterpret_cast<const caf::byte*>(x.bytes.data());
+    return f.value(x.seq) && f.value(x.num_chunks) && f.value(num_bytes)
+           && f.value(caf::make_span(first, x.bytes.size()));
+  }
+}
+
+} // namespace broker::internal
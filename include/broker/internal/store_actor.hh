@@ -7,6 +7,7 @@
 #include <caf/event_based_actor.hpp>
 
 #include "broker/endpoint.hh"
+#include "broker/internal/store_metrics.hh"
 #include "broker/topic.hh"
 
 namespace broker::internal {
@@ -82,6 +83,10 @@ public:
 
   /// Destination for emitted events.
   topic dst;
+
+  /// Counters and runtime histograms for processed commands, by command
+  /// type.
+  store_metrics metrics;
 };
 
 } // namespace broker::internal
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <variant>
+
+#include <caf/fwd.hpp>
+
+#include "broker/internal_command.hh"
+#include "broker/telemetry/fwd.hh"
+
+namespace broker::internal {
+
+/// Bundles per-command-type telemetry instances for data store actors. All
+/// instances carry the labels "store" with the name of the store and
+/// "command" with the name of the command type, and appear in the telemetry
+/// registry under the "broker" prefix. Updates go through the sharded
+/// telemetry cells, so recording a command on the store's hot path never
+/// touches shared cache lines. A default-constructed bundle turns all member
+/// functions into no-ops.
+class store_metrics {
+public:
+  /// Number of alternatives in `internal_command::variant_type`.
+  static constexpr size_t num_command_types
+    = std::variant_size_v<internal_command::variant_type>;
+
+  store_metrics() noexcept = default;
+
+  store_metrics(caf::actor_system& sys, const std::string& store_name);
+
+  store_metrics(const store_metrics&) noexcept = default;
+
+  store_metrics& operator=(const store_metrics&) noexcept = default;
+
+  /// Returns whether this bundle points to registry instances.
+  explicit operator bool() const noexcept {
+    return counts_[0] != nullptr;
+  }
+
+  /// Counts one processed command of the type at `index` in
+  /// `internal_command::variant_type` and records its processing time.
+  /// @pre `index < num_command_types`
+  void observe(size_t index, double seconds);
+
+  /// Adds propagation-delay and SLO-breach instances for clone-side SLO
+  /// tracking. Masters never call this, so the extra rows only appear for
+  /// stores that actually measure propagation.
+  void enable_slo_tracking(caf::actor_system& sys,
+                           const std::string& store_name);
+
+  /// Records the master-to-clone propagation delay of a sampled command.
+  void observe_propagation(double seconds);
+
+  /// Counts one sampled command that exceeded the SLO threshold.
+  void count_slo_breach();
+
+private:
+  std::array<telemetry::int_counter_hdl*, num_command_types> counts_{};
+  std::array<telemetry::dbl_histogram_hdl*, num_command_types> runtimes_{};
+  telemetry::dbl_histogram_hdl* propagation_ = nullptr;
+  telemetry::int_counter_hdl* slo_breaches_ = nullptr;
+};
+
+} // namespace broker::internal
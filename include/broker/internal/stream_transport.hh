@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -31,6 +32,7 @@
 #include "broker/internal/logger.hh"
 #include "broker/internal/native.hh"
 #include "broker/internal/peer_filter.hh"
+#include "broker/internal/peer_metrics.hh"
 #include "broker/internal/type_id.hh"
 #include "broker/internal/unipath_manager.hh"
 #include "broker/internal_command.hh"
@@ -62,6 +64,9 @@ public:
   struct pending_connection {
     manager_ptr mgr;
     caf::response_promise rp;
+    /// Time point of the first handshake step for measuring the RTT.
+    std::chrono::steady_clock::time_point start
+      = std::chrono::steady_clock::now();
   };
 
   /// Maps peer actor handles to their stream managers.
@@ -95,7 +100,24 @@ public:
 
   template <class... Fs>
   caf::behavior make_behavior(Fs... fs) {
-    return {std::move(fs)...};
+    return {
+      std::move(fs)...,
+      [this](atom::flush) {
+        flush_pending_ = false;
+        dispatcher_.flush();
+      },
+      [this](atom::unpeer, atom::drain, const caf::actor& hdl) {
+        // Deadline message from `unpeer_gracefully`: if the drain is still
+        // in progress, give up and fall back to the immediate teardown.
+        if (auto mgr = mgr_by_hdl(hdl)) {
+          if (auto i = draining_.find(mgr.get()); i != draining_.end()) {
+            i->second.deliver(caf::make_error(ec::request_timeout));
+            draining_.erase(i);
+            unpeer(hdl);
+          }
+        }
+      },
+    };
   }
 
   // -- properties -------------------------------------------------------------
@@ -180,6 +202,39 @@ public:
       unpeer(hdl.node(), hdl);
   }
 
+  /// Disconnects a peer by demand of the user after draining in-flight
+  /// messages: stops routing new messages to the peer immediately, flushes
+  /// staged items, ships all buffered batches and lets the stream protocol's
+  /// acknowledgments confirm receipt before closing both paths. Falls back
+  /// to the immediate teardown when the drain exceeds `drain_timeout`, in
+  /// which case `rp` receives `ec::request_timeout`.
+  void unpeer_gracefully(const peer_id_type& peer_id, const caf::actor& hdl,
+                         caf::timespan drain_timeout,
+                         caf::response_promise rp) {
+    BROKER_TRACE(BROKER_ARG(peer_id) << BROKER_ARG(hdl));
+    if (auto i = hdl_to_mgr_.find(hdl); i != hdl_to_mgr_.end()) {
+      auto mgr = i->second;
+      if (draining_.count(mgr.get()) != 0) {
+        // A second request while draining cannot succeed.
+        rp.deliver(caf::make_error(ec::peer_invalid));
+        return;
+      }
+      // An empty filter stops routing new messages to the peer while keeping
+      // the outbound path alive for the drain.
+      mgr->filter(filter_type{});
+      draining_.emplace(mgr.get(), std::move(rp));
+      // Push staged items downstream, then close once all buffered batches
+      // went out; `closing` fires on completion.
+      dispatcher_.flush();
+      mgr->shutdown();
+      self()->delayed_send(self(), drain_timeout, atom::unpeer_v,
+                           atom::drain_v, hdl);
+    } else {
+      rp.deliver(caf::make_error(ec::peer_invalid));
+      dref().cannot_remove_peer(peer_id, hdl);
+    }
+  }
+
   /// Starts the handshake process for a new peering (step #1 in core_actor.cc).
   /// @returns `false` if the peer is already connected, `true` otherwise.
   /// @param peer_hdl Handle to the peering (remote) core actor.
@@ -206,6 +261,8 @@ public:
       if (auto i = pending_connections_.count(peer_hdl) == 0) {
         auto mgr = make_peer_manager(&dispatcher_, this);
         mgr->filter(std::move(peer_filter));
+        mgr->metrics(peer_metrics{self()->system().metrics(),
+                                  caf::to_string(peer_hdl.node())});
         pending_connections_[peer_hdl].mgr = mgr;
         return mgr->template add_unchecked_outbound_path<node_message>(
           peer_hdl, std::make_tuple(dref().filter(), std::move(self_hdl)));
@@ -242,6 +299,8 @@ public:
     }
     // Create necessary state and send message to remote core.
     auto mgr = make_peer_manager(&dispatcher_, this);
+    mgr->metrics(peer_metrics{self()->system().metrics(),
+                              caf::to_string(remote_peer.node())});
     pending_connections().emplace(remote_peer,
                                   pending_connection{mgr, std::move(rp)});
     self()->send(self() * remote_peer, atom::peer_v, dref().filter(), self());
@@ -283,10 +342,28 @@ public:
     }
   }
 
+  /// Applies a filter delta to the filter of `hdl`. Callers must verify the
+  /// sequence number beforehand.
+  bool update_peer(const caf::actor& hdl, const filter_diff& diff) {
+    BROKER_TRACE(BROKER_ARG(hdl));
+    if (auto i = hdl_to_mgr_.find(hdl); i != hdl_to_mgr_.end()) {
+      auto filter = i->second->filter();
+      apply_filter_diff(filter, diff);
+      i->second->filter(std::move(filter));
+      return true;
+    } else {
+      BROKER_DEBUG("cannot update filter of unknown peer");
+      return false;
+    }
+  }
+
   void try_finalize_handshake(const caf::actor& hdl) {
     if (auto i = pending_connections_.find(hdl);
         i != pending_connections_.end()) {
       if (auto mgr = i->second.mgr; mgr->fully_connected()) {
+        std::chrono::duration<double> rtt
+          = std::chrono::steady_clock::now() - i->second.start;
+        mgr->metrics().observe_handshake_rtt(rtt.count());
         mgr->unblock_inputs();
         dispatcher_.add(mgr);
         hdl_to_mgr_.emplace(hdl, mgr);
@@ -304,7 +381,8 @@ public:
     auto i = std::find_if(dispatcher_.managers().begin(),
                           dispatcher_.managers().end(),
                           [out_slot](const auto& ptr) {
-                            return ptr->outbound_path_slot() == out_slot;
+                            return ptr != nullptr
+                                   && ptr->outbound_path_slot() == out_slot;
                           });
     if (i != dispatcher_.managers().end())
       (*i)->filter(std::move(filter));
@@ -353,16 +431,29 @@ public:
   template <class T>
   void local_push(T msg) {
     BROKER_TRACE(BROKER_ARG(msg));
-    auto wrapped = make_node_message(std::move(msg), ttl());
-    dispatcher_.enqueue(nullptr, detail::item_scope::local,
-                        caf::make_span(&wrapped, 1));
+    stage(detail::item_scope::local, make_node_message(std::move(msg), ttl()));
   }
 
   /// Pushes messages to peers without forwarding it to local subscribers.
   void remote_push(node_message msg) {
     BROKER_TRACE(BROKER_ARG(msg));
-    dispatcher_.enqueue(nullptr, detail::item_scope::remote,
-                        caf::make_span(&msg, 1));
+    stage(detail::item_scope::remote, std::move(msg));
+  }
+
+  /// Stages `msg` in the dispatcher and schedules a flush, allowing bursts of
+  /// individually published messages to travel downstream as batches.
+  void stage(detail::item_scope scope, node_message msg) {
+    if (!msg.origin) {
+      msg.origin = dispatcher_.origin_id();
+      msg.seq = dispatcher_.next_seq();
+      dispatcher_.tracer().stamp(msg);
+    }
+    dispatcher_.stage(nullptr, scope, std::move(msg));
+    if (!flush_pending_ && !dispatcher_.stage_empty()) {
+      flush_pending_ = true;
+      self()->delayed_send(self(), dispatcher_.flush_interval(),
+                           atom::flush_v);
+    }
   }
 
   /// Pushes data to peers.
@@ -408,6 +499,28 @@ public:
 
   void closing(unipath_manager* ptr, bool graceful,
                const caf::error& reason) override {
+    if (auto i = draining_.find(ptr); i != draining_.end()) {
+      // A drained peering closed after shipping its buffered messages;
+      // report the outcome to the caller of `unpeer_gracefully`.
+      if (graceful)
+        i->second.deliver(caf::unit);
+      else
+        i->second.deliver(caf::error{reason});
+      draining_.erase(i);
+      caf::actor hdl;
+      if (auto j = mgr_to_hdl_.find(manager_ptr{ptr}); j != mgr_to_hdl_.end()) {
+        hdl = j->second;
+        hdl_to_mgr_.erase(hdl);
+        mgr_to_hdl_.erase(j);
+      }
+      if (hdl)
+        dref().peer_removed(hdl.node(), hdl);
+      // Shut down when the last peer stops listening.
+      if (dref().shutting_down() && pending_connections_.empty()
+          && hdl_to_mgr_.empty())
+        self()->quit(caf::exit_reason::user_shutdown);
+      return;
+    }
     drop_peer(ptr->hdl(), graceful, reason);
   }
 
@@ -567,12 +680,19 @@ protected:
   /// pointers to all active unipath managers for outbound traffic.
   central_dispatcher dispatcher_;
 
+  /// Stores whether a delayed `atom::flush` message is already in flight.
+  bool flush_pending_ = false;
+
   /// Maps peer handles to their respective unipath manager.
   hdl_to_mgr_map hdl_to_mgr_;
 
   /// Maps unipath managers to their respective peer handle.
   mgr_to_hdl_map mgr_to_hdl_;
 
+  /// Maps managers of peerings that `unpeer_gracefully` currently drains to
+  /// the response promise of the initiating request.
+  std::unordered_map<unipath_manager*, caf::response_promise> draining_;
+
   /// Maps pending peer handles to output IDs. An invalid stream ID indicates
   /// that only "step #0" was performed so far. An invalid stream ID corresponds
   /// to `peer_status::connecting` and a valid stream ID cooresponds to
@@ -4,8 +4,14 @@
 #include "broker/error.hh"
 #include "broker/internal/fwd.hh"
 #include "broker/internal/native.hh"
+#include "broker/store_derivation.hh"
 #include "broker/time.hh"
 
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <caf/allowed_unsafe_message_type.hpp>
 #include <caf/config.hpp>
 #include <caf/fwd.hpp>
 #include <caf/type_id.hpp>
@@ -24,6 +30,7 @@ BROKER_CAF_ATOM_ALIAS(get)
 BROKER_CAF_ATOM_ALIAS(join)
 BROKER_CAF_ATOM_ALIAS(leave)
 BROKER_CAF_ATOM_ALIAS(ok)
+BROKER_CAF_ATOM_ALIAS(ping)
 BROKER_CAF_ATOM_ALIAS(publish)
 BROKER_CAF_ATOM_ALIAS(put)
 BROKER_CAF_ATOM_ALIAS(subscribe)
@@ -57,6 +64,8 @@ CAF_BEGIN_TYPE_ID_BLOCK(broker, caf::first_custom_type_id)
 
   BROKER_ADD_ATOM(ack)
   BROKER_ADD_ATOM(default_)
+  BROKER_ADD_ATOM(drain)
+  BROKER_ADD_ATOM(dump)
   BROKER_ADD_ATOM(id)
   BROKER_ADD_ATOM(init)
   BROKER_ADD_ATOM(name)
@@ -79,11 +88,14 @@ CAF_BEGIN_TYPE_ID_BLOCK(broker, caf::first_custom_type_id)
   BROKER_ADD_ATOM(attach)
   BROKER_ADD_ATOM(clear)
   BROKER_ADD_ATOM(clone)
+  BROKER_ADD_ATOM(compact)
   BROKER_ADD_ATOM(decrement)
+  BROKER_ADD_ATOM(derive)
   BROKER_ADD_ATOM(erase)
   BROKER_ADD_ATOM(exists)
   BROKER_ADD_ATOM(expire)
   BROKER_ADD_ATOM(increment)
+  BROKER_ADD_ATOM(index)
   BROKER_ADD_ATOM(keys)
   BROKER_ADD_ATOM(local)
   BROKER_ADD_ATOM(master)
@@ -92,12 +104,16 @@ CAF_BEGIN_TYPE_ID_BLOCK(broker, caf::first_custom_type_id)
   BROKER_ADD_ATOM(restart)
   BROKER_ADD_ATOM(stale_check)
   BROKER_ADD_ATOM(store)
+  BROKER_ADD_ATOM(subnet)
   BROKER_ADD_ATOM(subtract)
   BROKER_ADD_ATOM(sync_point)
 
   // -- atoms for communciation with the core actor ----------------------------
 
+  BROKER_ADD_ATOM(checkpoint)
+  BROKER_ADD_ATOM(flush)
   BROKER_ADD_ATOM(no_events)
+  BROKER_ADD_ATOM(replay)
   BROKER_ADD_ATOM(snapshot)
   BROKER_ADD_ATOM(subscriptions)
 
@@ -111,14 +127,19 @@ CAF_BEGIN_TYPE_ID_BLOCK(broker, caf::first_custom_type_id)
   BROKER_ADD_TYPE_ID((broker::command_message))
   BROKER_ADD_TYPE_ID((broker::data))
   BROKER_ADD_TYPE_ID((broker::data_message))
+  BROKER_ADD_TYPE_ID((broker::detail::data_message_queue_ptr))
   BROKER_ADD_TYPE_ID((broker::internal::retry_state))
+  BROKER_ADD_TYPE_ID((broker::internal::snapshot_chunk))
   BROKER_ADD_TYPE_ID((broker::ec))
   BROKER_ADD_TYPE_ID((broker::endpoint_info))
   BROKER_ADD_TYPE_ID((broker::enum_value))
   BROKER_ADD_TYPE_ID((broker::erase_command))
   BROKER_ADD_TYPE_ID((broker::expire_command))
+  BROKER_ADD_TYPE_ID((broker::filter_diff))
   BROKER_ADD_TYPE_ID((broker::filter_type))
   BROKER_ADD_TYPE_ID((broker::internal_command))
+  BROKER_ADD_TYPE_ID((broker::multi_erase_command))
+  BROKER_ADD_TYPE_ID((broker::multi_put_command))
   BROKER_ADD_TYPE_ID((broker::network_info))
   BROKER_ADD_TYPE_ID((broker::node_message))
   BROKER_ADD_TYPE_ID((broker::node_message_content))
@@ -136,10 +157,12 @@ CAF_BEGIN_TYPE_ID_BLOCK(broker, caf::first_custom_type_id)
   BROKER_ADD_TYPE_ID((broker::snapshot_command))
   BROKER_ADD_TYPE_ID((broker::snapshot_sync_command))
   BROKER_ADD_TYPE_ID((broker::status))
+  BROKER_ADD_TYPE_ID((broker::store_derivation))
   BROKER_ADD_TYPE_ID((broker::subnet))
   BROKER_ADD_TYPE_ID((broker::subtract_command))
   BROKER_ADD_TYPE_ID((broker::table))
   BROKER_ADD_TYPE_ID((broker::topic))
+  BROKER_ADD_TYPE_ID((broker::transaction_command))
   BROKER_ADD_TYPE_ID((broker::vector))
 
   // -- STD/CAF type announcements ---------------------------------------------
@@ -160,6 +183,12 @@ CAF_END_TYPE_ID_BLOCK(broker)
 
 CAF_ERROR_CODE_ENUM(broker::ec)
 
+// Queue handles only travel between actors of the same process.
+CAF_ALLOW_UNSAFE_MESSAGE_TYPE(broker::detail::data_message_queue_ptr)
+
+// Derivation functions only travel from the endpoint to a local master.
+CAF_ALLOW_UNSAFE_MESSAGE_TYPE(broker::store_derivation)
+
 namespace caf {
 
 template <class... Ts>
@@ -168,10 +197,33 @@ struct inspector_access<broker::cow_tuple<Ts...>> {
 
   template <class Inspector>
   static bool apply(Inspector& f, value_type& x) {
-    if constexpr (Inspector::is_loading)
+    if constexpr (Inspector::is_loading) {
       return f.tuple(x.unshared());
-    else
+    } else if constexpr (std::is_same<Inspector, caf::binary_serializer>::value) {
+      // Serialize-once fan-out: the first binary encode caches the wire bytes
+      // with the shared tuple, every further encode appends the cached blob.
+      // Broadcasting one message to N peers thus serializes it once instead
+      // of N times. The blob matches the field-wise encoding byte for byte,
+      // so the loading path stays untouched.
+      auto write = [&f](const std::vector<std::byte>& blob) {
+        auto first = reinterpret_cast<const caf::byte*>(blob.data());
+        return f.value(caf::make_span(first, blob.size()));
+      };
+      if (auto cached = x.encoding())
+        return write(*cached);
+      caf::byte_buffer buf;
+      caf::binary_serializer sink{f.context(), buf};
+      if (!sink.tuple(detail::as_mutable_ref(x.data()))) {
+        f.set_error(sink.get_error());
+        return false;
+      }
+      std::vector<std::byte> blob(buf.size());
+      if (!buf.empty())
+        memcpy(blob.data(), buf.data(), buf.size());
+      return write(x.cache_encoding(std::move(blob)));
+    } else {
       return f.tuple(x.data());
+    }
   }
 
   template <class Inspector>
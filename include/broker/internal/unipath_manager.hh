@@ -8,6 +8,7 @@
 #include "broker/detail/item_scope.hh"
 #include "broker/fwd.hh"
 #include "broker/internal/fwd.hh"
+#include "broker/internal/peer_metrics.hh"
 
 namespace broker::internal {
 
@@ -94,6 +95,20 @@ public:
     observer_ = nullptr;
   }
 
+  /// Returns the per-peer telemetry instances. All member functions of the
+  /// result are no-ops unless `metrics(peer_metrics)` was called.
+  peer_metrics& metrics() noexcept {
+    return metrics_;
+  }
+
+  /// Attaches per-peer telemetry instances for traffic accounting. Only
+  /// called for managers that represent remote peers.
+  virtual void metrics(peer_metrics new_metrics);
+
+  /// Publishes a `sc::peer_latency_spike` status for this peer to local
+  /// status subscribers.
+  void emit_latency_spike(double seconds);
+
   // -- overrides --------------------------------------------------------------
 
   bool congested(const caf::inbound_path&) const noexcept override;
@@ -111,6 +126,7 @@ protected:
 
   central_dispatcher* dispatcher_;
   observer* observer_ = nullptr;
+  peer_metrics metrics_;
 };
 
 using unipath_manager_ptr = caf::intrusive_ptr<unipath_manager>;
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "broker/data.hh"
+#include "broker/message.hh"
+#include "broker/topic.hh"
+
+namespace broker::internal {
+
+/// Produces a deterministic, seedable stream of synthetic data messages from
+/// distribution parameters instead of recorded meta data (see
+/// `data_generator` for the recording-based counterpart). Enables exploring
+/// scaling limits such as message size vs. rate vs. peer count without
+/// hauling capture files around.
+class workload_generator {
+public:
+  /// Describes the shape of the generated workload.
+  struct parameters {
+    /// Seed for the random engine. Streams with equal parameters and seeds
+    /// are identical.
+    unsigned seed = 0;
+
+    /// Number of distinct topics to publish under.
+    size_t num_topics = 10;
+
+    /// Zipf exponent for the topic popularity distribution. A value of 0
+    /// picks topics uniformly; larger values skew traffic towards the
+    /// first topics.
+    double topic_skew = 0;
+
+    /// Median payload size in bytes. Actual sizes follow a log-normal
+    /// distribution around this value.
+    size_t value_size_median = 128;
+
+    /// Log-normal shape parameter for payload sizes. A value of 0 makes all
+    /// payloads `value_size_median` bytes.
+    double value_size_sigma = 0.5;
+
+    /// Maximum nesting depth of generated containers. A value of 0 produces
+    /// flat string payloads.
+    size_t max_nesting_depth = 2;
+  };
+
+  explicit workload_generator(parameters params);
+
+  /// Returns the next message of the stream.
+  data_message next();
+
+  /// Returns all topics this generator publishes under.
+  const std::vector<topic>& topics() const noexcept {
+    return topics_;
+  }
+
+  const parameters& params() const noexcept {
+    return params_;
+  }
+
+private:
+  /// Picks a topic according to the configured skew.
+  const topic& pick_topic();
+
+  /// Generates a value of roughly `budget` bytes with up to `depth` levels
+  /// of container nesting.
+  data make_value(size_t budget, size_t depth);
+
+  parameters params_;
+  std::vector<topic> topics_;
+  std::minstd_rand engine_;
+  std::discrete_distribution<size_t> topic_dist_;
+  std::lognormal_distribution<double> size_dist_;
+};
+
+} // namespace broker::internal
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "broker/data.hh"
 #include "broker/fwd.hh"
@@ -105,6 +106,33 @@ bool inspect(Inspector& f, subtract_command& x) {
                             f.field("publisher", x.publisher));
 }
 
+/// Sets multiple values in the key-value store with a single command,
+/// amortizing the messaging overhead of the per-key variant.
+struct multi_put_command {
+  std::vector<std::pair<data, data>> entries;
+  std::optional<timespan> expiry;
+  publisher_id publisher;
+};
+
+template <class Inspector>
+bool inspect(Inspector& f, multi_put_command& x) {
+  return f.object(x).fields(f.field("entries", x.entries),
+                            f.field("expiry", x.expiry),
+                            f.field("publisher", x.publisher));
+}
+
+/// Removes multiple values in the key-value store with a single command.
+struct multi_erase_command {
+  std::vector<data> keys;
+  publisher_id publisher;
+};
+
+template <class Inspector>
+bool inspect(Inspector& f, multi_erase_command& x) {
+  return f.object(x).fields(f.field("keys", x.keys),
+                            f.field("publisher", x.publisher));
+}
+
 /// Causes the master to reply with a snapshot of its state.
 struct snapshot_command {
   worker remote_core;
@@ -139,6 +167,46 @@ bool inspect(Inspector& f, set_command& x) {
   return f.object(x).fields(f.field("state", x.state));
 }
 
+/// One operation inside a ::transaction_command.
+struct transaction_op {
+  /// Discriminates the staged operation. The master resolves `add` and
+  /// `subtract` to plain `put` operations before broadcasting, so clones
+  /// only ever see `put` and `erase`.
+  enum class action_type : uint8_t {
+    put,
+    erase,
+    add,
+    subtract,
+  };
+
+  action_type action;
+  data key;
+  data value;
+  data::type init_type = data::type::none;
+};
+
+template <class Inspector>
+bool inspect(Inspector& f, transaction_op& x) {
+  return f.object(x).fields(f.field("action", x.action), f.field("key", x.key),
+                            f.field("value", x.value),
+                            f.field("init_type", x.init_type));
+}
+
+/// Applies a bundle of operations as one atomic unit: the master executes
+/// all operations back to back without interleaving commands from other
+/// writers and broadcasts the bundle to clones as a single message.
+struct transaction_command {
+  std::vector<transaction_op> ops;
+  std::optional<timespan> expiry;
+  publisher_id publisher;
+};
+
+template <class Inspector>
+bool inspect(Inspector& f, transaction_command& x) {
+  return f.object(x).fields(f.field("ops", x.ops), f.field("expiry", x.expiry),
+                            f.field("publisher", x.publisher));
+}
+
 /// Drops all values.
 struct clear_command {
   publisher_id publisher;
@@ -159,20 +227,37 @@ public:
     expire_command,
     add_command,
     subtract_command,
+    multi_put_command,
+    multi_erase_command,
     snapshot_command,
     snapshot_sync_command,
     set_command,
     clear_command,
+    transaction_command,
   };
 
   using variant_type
     = std::variant<none, put_command, put_unique_command, erase_command,
                    expire_command, add_command, subtract_command,
-                   snapshot_command, snapshot_sync_command, set_command,
-                   clear_command>;
+                   multi_put_command, multi_erase_command, snapshot_command,
+                   snapshot_sync_command, set_command, clear_command,
+                   transaction_command>;
 
   variant_type content;
 
+  /// Sequence number of this command; 0 marks an unnumbered command. On the
+  /// writer-to-master path, the writer stamps a per-writer number that lets
+  /// the master drop duplicated sends. On the master-to-clone path, the
+  /// master overwrites it with the broadcast number that enables clones to
+  /// request a delta resynchronization after a brief disconnect.
+  uint64_t seq = 0;
+
+  /// Wall-clock time at which the master broadcasted this command. The
+  /// master only stamps every Nth command when "broker.store.slo-sample-rate"
+  /// enables SLO tracking; clones measure the propagation delay of stamped
+  /// commands. A default (epoch) value marks an unstamped command.
+  timestamp stamp = timestamp{};
+
   internal_command(variant_type value);
 
   internal_command() = default;
@@ -187,9 +272,14 @@ internal_command make_internal_command(Ts&&... xs) {
   return internal_command{T{std::forward<Ts>(xs)...}};
 }
 
+/// Returns the publisher stored in `cmd`, or an invalid ID for commands
+/// without a publisher field (`none` and the snapshot handshake commands).
+publisher_id publisher_of(const internal_command::variant_type& cmd);
+
 template <class Inspector>
 bool inspect(Inspector& f, internal_command& x) {
-  return f.object(x).fields(f.field("content", x.content));
+  return f.object(x).fields(f.field("content", x.content),
+                            f.field("seq", x.seq), f.field("stamp", x.stamp));
 }
 
 namespace detail {
@@ -213,10 +303,13 @@ INTERNAL_COMMAND_TAG_ORACLE(erase_command);
 INTERNAL_COMMAND_TAG_ORACLE(expire_command);
 INTERNAL_COMMAND_TAG_ORACLE(add_command);
 INTERNAL_COMMAND_TAG_ORACLE(subtract_command);
+INTERNAL_COMMAND_TAG_ORACLE(multi_put_command);
+INTERNAL_COMMAND_TAG_ORACLE(multi_erase_command);
 INTERNAL_COMMAND_TAG_ORACLE(snapshot_command);
 INTERNAL_COMMAND_TAG_ORACLE(snapshot_sync_command);
 INTERNAL_COMMAND_TAG_ORACLE(set_command);
 INTERNAL_COMMAND_TAG_ORACLE(clear_command);
+INTERNAL_COMMAND_TAG_ORACLE(transaction_command);
 
 #undef INTERNAL_COMMAND_TAG_ORACLE
 
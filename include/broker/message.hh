@@ -5,8 +5,11 @@
 
 #include "broker/cow_tuple.hh"
 #include "broker/data.hh"
+#include "broker/endpoint_id.hh"
 #include "broker/internal_command.hh"
+#include "broker/time.hh"
 #include "broker/topic.hh"
+#include "broker/vector_builder.hh"
 
 namespace broker {
 
@@ -29,6 +32,20 @@ struct node_message {
 
   /// Time-to-life counter.
   uint16_t ttl;
+
+  /// Identifies the endpoint that first published the message. Invalid on
+  /// messages that never left their endpoint of origin.
+  endpoint_id origin;
+
+  /// Sequence number assigned by the origin. Together with `origin`, allows
+  /// relays to drop duplicates that arrive over multiple paths.
+  uint64_t seq = 0;
+
+  /// Wall-clock time at which the origin published the message, or the epoch
+  /// for untraced messages. Endpoints with latency tracing enabled stamp a
+  /// sampled subset of their locally published messages and record the time
+  /// since the stamp when delivering to a local subscriber.
+  timestamp stamp = timestamp{};
 };
 
 /// Returns whether `x` contains a ::node_message.
@@ -55,7 +72,10 @@ inline bool is_command_message(const node_message& x) {
 template <class Inspector>
 bool inspect(Inspector& f, node_message& x) {
   return f.object(x).fields(f.field("content", x.content),
-                            f.field("ttl", x.ttl));
+                            f.field("ttl", x.ttl),
+                            f.field("origin", x.origin),
+                            f.field("seq", x.seq),
+                            f.field("stamp", x.stamp));
 }
 
 /// Generates a ::data_message.
@@ -64,6 +84,14 @@ data_message make_data_message(Topic&& t, Data&& d) {
   return data_message(std::forward<Topic>(t), std::forward<Data>(d));
 }
 
+/// Generates a ::data_message holding the vector assembled by `builder`,
+/// without copying the elements.
+template <class Topic>
+data_message make_data_message(Topic&& t, vector_builder&& builder) {
+  return data_message(std::forward<Topic>(t),
+                      data{std::move(builder).build()});
+}
+
 /// Generates a ::command_message.
 template <class Topic, class Command>
 command_message make_command_message(Topic&& t, Command&& d) {
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace broker {
+
+/// Selects how publish calls react when a topic exhausts its rate limit.
+enum class publish_limit_policy : uint8_t {
+  /// Blocks the publishing thread until the token bucket refills.
+  block,
+  /// Discards the message and increments a drop counter.
+  drop,
+};
+
+/// @relates publish_limit_policy
+std::string to_string(publish_limit_policy x);
+
+/// Configures a token-bucket rate limit for publishing under a topic prefix.
+struct publish_limit {
+  /// Sustained publish rate in messages per second. Values less than or equal
+  /// to zero disable the limit.
+  double messages_per_second = 0;
+
+  /// Maximum burst size, i.e., the capacity of the token bucket. Zero
+  /// defaults to the sustained rate, but at least one message.
+  size_t burst = 0;
+
+  /// Reaction when the bucket runs empty.
+  publish_limit_policy policy = publish_limit_policy::drop;
+};
+
+} // namespace broker
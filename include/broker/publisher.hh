@@ -2,13 +2,22 @@
 
 #include <chrono>
 #include <cstddef>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "broker/detail/shared_publisher_queue.hh"
 #include "broker/fwd.hh"
 #include "broker/message.hh"
+#include "broker/span.hh"
 #include "broker/worker.hh"
 
+namespace broker::detail {
+
+class publish_limiter;
+
+} // namespace broker::detail
+
 namespace broker {
 
 /// Provides asynchronous publishing of data with demand management.
@@ -18,12 +27,52 @@ public:
 
   friend class endpoint;
 
+  friend class shared_publisher;
+
   // --- nested types ----------------------------------------------------------
 
   using value_type = data_message;
 
   using guard_type = std::unique_lock<std::mutex>;
 
+  /// Accumulates messages for a single handoff to the queue. Building a batch
+  /// constructs each ::data_message exactly once in user-space; publishing it
+  /// moves the whole sequence into the queue under one lock acquisition and
+  /// with at most one consumer wakeup, instead of paying for a lock, a topic
+  /// copy, and a flare operation per item.
+  class batch {
+  public:
+    friend class publisher;
+
+    explicit batch(topic t) : topic_(std::move(t)) {
+      // nop
+    }
+
+    /// Appends a message for `x` to this batch.
+    void add(data x) {
+      msgs_.emplace_back(topic_, std::move(x));
+    }
+
+    /// Returns the number of accumulated messages.
+    size_t size() const noexcept {
+      return msgs_.size();
+    }
+
+    /// Returns whether this batch holds no messages.
+    [[nodiscard]] bool empty() const noexcept {
+      return msgs_.empty();
+    }
+
+    /// Pre-allocates space for `n` messages.
+    void reserve(size_t n) {
+      msgs_.reserve(n);
+    }
+
+  private:
+    topic topic_;
+    std::vector<data_message> msgs_;
+  };
+
   // --- constructors and destructors ------------------------------------------
 
   publisher(publisher&&) = default;
@@ -82,6 +131,20 @@ public:
   /// Sends `xs` to all subscribers.
   void publish(std::vector<data> xs);
 
+  /// Sends `xs` to all subscribers, moving from the span's elements. Spares
+  /// callers with caller-owned storage the temporary vector; the spanned
+  /// elements are in a moved-from state on return.
+  void publish(span<data> xs);
+
+  /// Returns a batch builder for this publisher's topic.
+  batch make_batch() const {
+    return batch{topic_};
+  }
+
+  /// Moves all messages of `xs` to the subscribers. The batch is empty
+  /// afterwards and may be reused.
+  void publish(batch&& xs);
+
   // --- miscellaneous ---------------------------------------------------------
 
   /// Release any state held by the object, rendering it invalid.
@@ -98,12 +161,15 @@ public:
 
 private:
   // -- force users to use `endpoint::make_publsiher` -------------------------
-  publisher(endpoint& ep, topic t);
+  publisher(endpoint& ep, topic t, int numa_node = -1);
 
   bool drop_on_destruction_;
   detail::shared_publisher_queue_ptr<> queue_;
   broker::worker worker_;
   topic topic_;
+  /// Rate limiter shared with the endpoint; see
+  /// `endpoint::limit_publish_rate`.
+  std::shared_ptr<detail::publish_limiter> limiter_;
 };
 
 } // namespace broker
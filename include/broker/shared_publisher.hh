@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "broker/fwd.hh"
+#include "broker/message.hh"
+#include "broker/publisher.hh"
+#include "broker/topic.hh"
+
+namespace broker {
+
+/// A thread-safe publishing handle. Copies of a `shared_publisher` refer to
+/// the same queue and the same downstream path into the core, so any number
+/// of worker threads can publish through one handle instead of maintaining a
+/// separate publisher (and thus a separate flare and inbound path) per
+/// thread.
+///
+/// Producers serialize on a short mutex around the enqueue only. The core
+/// actor consumes from the underlying lock-free queue and never takes that
+/// mutex, so publishing threads cannot stall the core.
+class shared_publisher {
+public:
+  // --- friend declarations ---------------------------------------------------
+
+  friend class endpoint;
+
+  // --- nested types ----------------------------------------------------------
+
+  using value_type = data_message;
+
+  // --- constructors and destructors ------------------------------------------
+
+  shared_publisher(shared_publisher&&) = default;
+
+  shared_publisher& operator=(shared_publisher&&) = default;
+
+  shared_publisher(const shared_publisher&) = default;
+
+  shared_publisher& operator=(const shared_publisher&) = default;
+
+  ~shared_publisher();
+
+  // --- accessors -------------------------------------------------------------
+
+  /// Returns the current size of the output queue.
+  size_t buffered() const;
+
+  /// Returns the capacity of the output queue.
+  size_t capacity() const;
+
+  // --- messaging -------------------------------------------------------------
+
+  /// Sends `x` to all subscribers of this publisher's topic.
+  void publish(data x);
+
+  /// Sends `xs` to all subscribers of this publisher's topic.
+  void publish(std::vector<data> xs);
+
+  /// Moves the pre-assembled messages `[first, first + num)` to the
+  /// subscribers of their respective topics.
+  void publish(data_message* first, size_t num);
+
+  /// Moves all messages of `xs` to the subscribers of their respective
+  /// topics. The vector is empty afterwards and may be reused.
+  void publish(std::vector<data_message>& xs);
+
+private:
+  // -- force users to use `endpoint::make_shared_publisher` -------------------
+
+  explicit shared_publisher(publisher pub);
+
+  struct impl;
+
+  std::shared_ptr<impl> impl_;
+};
+
+} // namespace broker
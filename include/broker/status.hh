@@ -30,6 +30,14 @@ enum class sc : uint8_t {
   endpoint_discovered,
   /// Lost all paths to a Broker endpoint.
   endpoint_unreachable,
+  /// A local subscriber queue remained at its high watermark for too long.
+  slow_consumer,
+  /// Shipping messages to a peer exceeded the configured latency threshold.
+  peer_latency_spike,
+  /// A data store accumulated a backlog of buffered commands.
+  store_backlog,
+  /// A clone repeatedly exceeded the propagation-delay SLO of its store.
+  store_slo_breach,
 };
 // --sc-enum-end
 
@@ -54,7 +62,7 @@ template <class Inspector>
 bool inspect(Inspector& f, sc& x) {
   auto get = [&] { return static_cast<uint8_t>(x); };
   auto set = [&](uint8_t val) {
-    if (val <= static_cast<uint8_t>(sc::endpoint_unreachable)) {
+    if (val <= static_cast<uint8_t>(sc::store_slo_breach)) {
       x = static_cast<sc>(val);
       return true;
     } else {
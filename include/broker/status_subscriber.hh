@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "broker/bad_variant_access.hh"
@@ -77,6 +80,30 @@ public:
   /// @copydoc subscriber::poll
   std::vector<value_type> poll();
 
+  // --- wait-free sampling ----------------------------------------------------
+
+  /// Returns the number of events (errors and statuses) that arrived since
+  /// construction. A plain atomic load that never touches the queue, so
+  /// high-frequency control loops can detect new activity by comparing
+  /// against the value from their previous tick. The events themselves remain
+  /// queued for `get` and `poll`.
+  uint64_t generation() const noexcept {
+    return probe_->generation.load(std::memory_order_acquire);
+  }
+
+  /// Returns the number of errors that arrived since construction. Wait-free;
+  /// never touches the queue.
+  uint64_t error_count() const noexcept {
+    return probe_->errors.load(std::memory_order_acquire);
+  }
+
+  /// Returns the code of the most recent error, or `ec::none` if no error
+  /// arrived yet. Pair with `error_count` to detect new errors: the code
+  /// alone cannot distinguish consecutive errors of the same kind.
+  ec last_error() const noexcept {
+    return static_cast<ec>(probe_->last_error.load(std::memory_order_acquire));
+  }
+
   // --- properties ------------------------------------------------------------
 
   /// @copydoc subscriber::set_rate_calculation
@@ -118,11 +145,23 @@ private:
   // -- force users to use `endpoint::make_status_subscriber` ------------------
   status_subscriber(endpoint& ep, bool receive_statuses = false);
 
+  /// Counters shared with the background worker, which bumps them for every
+  /// event that enters the queue. Enables the wait-free sampling API above.
+  struct sampling_state {
+    std::atomic<uint64_t> generation = 0;
+    std::atomic<uint64_t> errors = 0;
+    std::atomic<uint8_t> last_error = 0;
+  };
+
   value_type convert(const data_message& msg);
 
   void append_converted(std::vector<value_type>& result,
                         const data_message& msg);
 
+  /// Initialized before `impl_`, which captures a reference to the state in
+  /// the observer it hands to the worker.
+  std::shared_ptr<sampling_state> probe_;
+
   subscriber impl_;
 };
 
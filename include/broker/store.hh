@@ -1,14 +1,18 @@
 #pragma once
 
 #include "broker/data.hh"
+#include "broker/detail/store_view.hh"
 #include "broker/expected.hh"
 #include "broker/fwd.hh"
+#include "broker/internal_command.hh"
 #include "broker/mailbox.hh"
 #include "broker/timeout.hh"
 #include "broker/worker.hh"
 
+#include <functional>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace broker {
@@ -47,6 +51,39 @@ public:
     /// response.
     request_id get(data key);
 
+    /// Performs a request to retrieve multiple values with a single
+    /// round trip. The response carries a vector with one entry per key,
+    /// holding the value under the respective key or `nil` for missing keys.
+    /// @param keys The keys of the values to retrieve.
+    /// @returns A unique identifier for this request to correlate it with a
+    /// response.
+    request_id multi_get(std::vector<data> keys);
+
+    /// Schedules a key for retrieval without sending a request yet.
+    /// Scheduled keys accumulate until the next call to `flush`.
+    /// @param key The key of the value to retrieve.
+    void schedule_get(data key);
+
+    /// Sends all scheduled keys as a single pipelined request with one
+    /// correlation id. The response carries a vector with one entry per
+    /// scheduled key (in scheduling order), holding the value under the
+    /// respective key or `nil` for missing keys.
+    /// @returns A unique identifier for the batch, or 0 if no keys are
+    /// scheduled.
+    request_id flush();
+
+    /// Consumes all responses that are ready, blocking only if none arrived
+    /// yet. Amortizes the per-response mailbox wakeup at high query rates.
+    /// @returns At least one response plus everything else already waiting.
+    std::vector<response> drain();
+
+    /// Passes every ready response to `f`, blocking only if none arrived
+    /// yet. Unlike calling `receive` in a loop, the entire batch settles the
+    /// mailbox flare once instead of paying one wakeup interaction per
+    /// response.
+    /// @param f The callback to invoke once per response.
+    void receive_all(const std::function<void(response)>& f);
+
     /// Inserts a value if the key does not already exist.
     /// @param key The key of the key-value pair.
     /// @param value The value of the key-value pair.
@@ -69,6 +106,18 @@ public:
     /// response.
     request_id keys();
 
+    /// Performs a request to retrieve the store's keys within the half-open
+    /// range *[from, to)*, ordered by key.
+    /// @param from The first key of the range.
+    /// @param to The exclusive upper bound of the range, or `nil` for no
+    /// upper bound.
+    /// @param limit Caps the response at this many keys, or 0 for no cap. To
+    /// scan a large range incrementally, re-issue the request with *from*
+    /// set past the last key of the previous response.
+    /// @returns A unique identifier for this request to correlate it with a
+    /// response.
+    request_id keys_in_range(data from, data to, uint64_t limit = 0);
+
     /// Retrieves the proxy's mailbox that reflects query responses.
     broker::mailbox mailbox();
 
@@ -87,6 +136,33 @@ public:
     request_id id_ = 0;
     worker frontend_;
     worker proxy_;
+    std::vector<data> scheduled_;
+  };
+
+  /// A read-only handle for same-process lookups on a master store. Readers
+  /// operate on immutable snapshots that the master publishes into shared
+  /// memory, so lookups are wait-free and never round-trip through the store
+  /// actor's mailbox. The view trails the store by up to one refresh
+  /// interval (`defaults::store::tick_interval`).
+  class reader {
+  public:
+    friend class store;
+
+    /// Default-constructs an uninitialized reader.
+    reader() = default;
+
+    /// Retrieves a value from the current view of the store.
+    /// @param key The key of the value to retrieve.
+    /// @returns The value under *key* or an error.
+    expected<data> get(const data& key) const;
+
+    /// Checks whether a key exists in the current view of the store.
+    bool exists(const data& key) const;
+
+  private:
+    explicit reader(std::shared_ptr<detail::store_view> view);
+
+    std::shared_ptr<detail::store_view> view_;
   };
 
   /// Default-constructs an uninitialized store.
@@ -107,6 +183,12 @@ public:
   /// @returns The value under *key* or an error.
   expected<data> get(data key) const;
 
+  /// Retrieves multiple values with a single round trip.
+  /// @param keys The keys of the values to retrieve.
+  /// @returns A vector with one entry per key, holding the value under the
+  /// respective key or `nil` for missing keys.
+  expected<data> multi_get(std::vector<data> keys) const;
+
   /// Inserts a value if the key does not already exist.
   /// @param key The key of the key-value pair.
   /// @param value The value of the key-value pair.
@@ -124,9 +206,92 @@ public:
   /// Always returns an error if the store does not have the key.
   expected<data> get_index_from_value(data key, data index) const;
 
+  /// Creates a read-only handle for wait-free lookups without messaging.
+  /// Requires the master for this store to run in the same process.
+  /// @returns A ::reader or an error if no in-process master exists.
+  expected<reader> create_reader() const;
+
   /// Retrieves a copy of the store's current keys, returned as a set.
   expected<data> keys() const;
 
+  /// Retrieves the store's keys within the half-open range *[from, to)*,
+  /// ordered by key and returned as a set.
+  /// @param from The first key of the range.
+  /// @param to The exclusive upper bound of the range, or `nil` for no upper
+  /// bound.
+  /// @param limit Caps the result at this many keys, or 0 for no cap. To scan
+  /// a large range incrementally, re-issue the request with *from* set past
+  /// the last key of the previous result.
+  /// @returns The matching keys or an error.
+  expected<data> keys_in_range(data from, data to, uint64_t limit = 0) const;
+
+  /// Retrieves the store's string keys starting with *prefix*, ordered by
+  /// key and returned as a set.
+  /// @param prefix The common prefix of the keys to retrieve.
+  /// @param limit Caps the result at this many keys, or 0 for no cap.
+  /// @returns The matching keys or an error.
+  expected<data> keys_with_prefix(std::string prefix,
+                                  uint64_t limit = 0) const;
+
+  /// Writes the master's current content to a compact binary file, e.g., to
+  /// seed another store via `load_from`. Expiry times are not part of the
+  /// file. Requires the frontend to be the master.
+  /// @param path The path of the file to create or overwrite. Resolved on
+  /// the node running the master.
+  /// @returns `nil` on success or an error.
+  expected<void> save_to(const std::string& path) const;
+
+  /// Populates the store from a file written by `save_to`, writing directly
+  /// into the backend instead of sending one command per entry. Attached
+  /// clones receive a fresh snapshot afterwards. Requires the frontend to be
+  /// the master.
+  /// @param path The path of the file to read. Resolved on the node running
+  /// the master.
+  /// @returns `nil` on success or an error.
+  expected<void> load_from(const std::string& path) const;
+
+  /// Reads the next page of a snapshot-consistent scan over the store. Scans
+  /// observe the content as of their first page: the master pins the state
+  /// via a copy-on-write fork (or an upfront copy if the fork is taken), so
+  /// concurrent mutations neither stall nor leak into the result. A scan
+  /// holds its pinned state until driven to completion.
+  /// @param cursor In/out scan position. Pass 0 to start a new scan; each
+  /// call updates it and resets it to 0 once the scan completes.
+  /// @param max_n Caps the number of entries per page, or 0 for the default
+  /// chunk size.
+  /// @returns A table with up to *max_n* entries or an error.
+  expected<data> scan(uint64_t& cursor, uint64_t max_n = 0) const;
+
+  /// Creates a secondary index over the stored values, maintained
+  /// incrementally on every mutation. Without *element*, the index covers
+  /// whole values; with *element*, it covers that position of vector values
+  /// (non-vector values and shorter vectors stay unindexed). Creating the
+  /// same index twice is a no-op. Requires the frontend to be the master.
+  /// @param element The vector element to index, or `nullopt` for whole
+  /// values.
+  /// @returns `nil` on success or an error.
+  expected<void> create_index(std::optional<uint64_t> element
+                              = std::nullopt) const;
+
+  /// Retrieves all keys whose indexed value equals *value* from an index
+  /// previously created via `create_index`. Requires the frontend to be the
+  /// master.
+  /// @param value The indexed value to look up.
+  /// @param element Selects the index, analogous to `create_index`.
+  /// @returns A set of keys (possibly empty) or an error if no such index
+  /// exists.
+  expected<data> get_index(data value, std::optional<uint64_t> element
+                                       = std::nullopt) const;
+
+  /// Retrieves the entry whose subnet key best covers *addr*, i.e., the
+  /// longest-prefix match over all subnet-typed keys, in a single operation.
+  /// The master builds a subnet trie on the first lookup and maintains it
+  /// incrementally afterwards. Requires the frontend to be the master.
+  /// @param addr The address to look up.
+  /// @returns A two-element vector holding the matching subnet key and its
+  /// value, or `ec::no_such_key` if no stored subnet contains *addr*.
+  expected<data> lookup_subnet(address addr) const;
+
   /// Retrieves the frontend.
   inline const worker& frontend() const {
     return frontend_;
@@ -143,13 +308,90 @@ public:
   /// @param expiry An optional expiration time for *key*.
   void put(data key, data value, std::optional<timespan> expiry = {}) const;
 
+  /// Inserts or updates multiple values with a single command.
+  /// @param entries The key-value pairs to insert or update.
+  /// @param expiry An optional expiration time, applied to all keys.
+  void multi_put(std::vector<std::pair<data, data>> entries,
+                 std::optional<timespan> expiry = {}) const;
+
   /// Removes the value associated with a given key.
   /// @param key The key to remove from the store.
   void erase(data key) const;
 
+  /// Removes the values associated with multiple keys with a single command.
+  /// @param keys The keys to remove from the store.
+  void multi_erase(std::vector<data> keys) const;
+
   /// Empties out the store.
   void clear() const;
 
+  /// Accumulates operations for atomic application via ::transact.
+  /// Operations apply in staging order; staging the same key twice means the
+  /// later operation sees the effect of the earlier one.
+  class transaction {
+  public:
+    friend class store;
+
+    transaction() = default;
+    transaction(transaction&&) = default;
+    transaction(const transaction&) = default;
+    transaction& operator=(transaction&&) = default;
+    transaction& operator=(const transaction&) = default;
+
+    /// Stages an insert or update.
+    void put(data key, data value) {
+      ops_.push_back(transaction_op{transaction_op::action_type::put,
+                                    std::move(key), std::move(value),
+                                    data::type::none});
+    }
+
+    /// Stages a removal.
+    void erase(data key) {
+      ops_.push_back(transaction_op{transaction_op::action_type::erase,
+                                    std::move(key), data{}, data::type::none});
+    }
+
+    /// Stages a type-specific "add" as performed by `store::increment` and
+    /// friends. The master evaluates it against the value as of this point
+    /// in the bundle.
+    void add(data key, data value, data::type init_type) {
+      ops_.push_back(transaction_op{transaction_op::action_type::add,
+                                    std::move(key), std::move(value),
+                                    init_type});
+    }
+
+    /// Stages a type-specific "subtract"; fails on the master if the key
+    /// does not exist at this point in the bundle.
+    void subtract(data key, data value) {
+      ops_.push_back(transaction_op{transaction_op::action_type::subtract,
+                                    std::move(key), std::move(value),
+                                    data::type::none});
+    }
+
+    /// Returns the number of staged operations.
+    size_t size() const noexcept {
+      return ops_.size();
+    }
+
+    /// Returns whether no operations are staged.
+    bool empty() const noexcept {
+      return ops_.empty();
+    }
+
+  private:
+    std::vector<transaction_op> ops_;
+  };
+
+  /// Submits all operations staged in `tx` as a single command. The master
+  /// applies them back to back without interleaving updates from other
+  /// writers and broadcasts the result to clones as one message, making the
+  /// bundle suitable for read-modify-write sequences across keys. A failing
+  /// operation is logged and skipped on the master; it does not roll back
+  /// the rest of the bundle.
+  /// @param tx The staged operations; consumed by the call.
+  /// @param expiry An optional expiration time, applied to all written keys.
+  void transact(transaction tx, std::optional<timespan> expiry = {}) const;
+
   /// Increments a value by a given amount. This is supported for all
   /// numerical types as well as for timestamps.
   /// @param key The key of the value to increment.
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "broker/data.hh"
+
+namespace broker {
+
+/// A single update that a derivation function requests on its derived store.
+struct derived_update {
+  /// Discriminates how the update applies to the derived store.
+  enum class action : uint8_t {
+    put,      ///< Sets `key` to `value`.
+    add,      ///< Adds `value` to the existing value at `key`.
+    subtract, ///< Subtracts `value` from the existing value at `key`.
+    erase,    ///< Removes `key`; `value` remains unused.
+  };
+
+  action op;
+  data key;
+  data value;
+};
+
+/// Maps one mutation of a base store to updates of a derived store. The
+/// master of the base store evaluates the function in-process after applying
+/// each mutation, passing the mutated key, the previous value (`nullptr` on
+/// insert) and the new value (`nullptr` on erase or expiry). The function
+/// appends its derived updates to `out`; leaving `out` untouched skips the
+/// mutation. Derivation functions never leave the endpoint they were
+/// installed on.
+using store_derivation
+  = std::function<void(const data& key, const data* old_value,
+                       const data* new_value,
+                       std::vector<derived_update>& out)>;
+
+} // namespace broker
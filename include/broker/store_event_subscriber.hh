@@ -0,0 +1,181 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "broker/data.hh"
+#include "broker/fwd.hh"
+#include "broker/store_event.hh"
+#include "broker/subscriber.hh"
+#include "broker/worker.hh"
+
+namespace broker {
+
+/// Provides blocking access to the stream of store events (inserts, updates,
+/// erasures and expirations) of a single data store. Events arrive already
+/// decoded; accessing keys and values goes through the zero-copy view types
+/// of @ref store_event.
+class store_event_subscriber {
+public:
+  // --- friend declarations ---------------------------------------------------
+
+  friend class endpoint;
+
+  // --- member types ----------------------------------------------------------
+
+  /// Owns one store-event message. The typed views returned by `to_insert`
+  /// and friends point into the owned message and remain valid for the
+  /// lifetime of this object.
+  class event {
+  public:
+    event() = default;
+
+    explicit event(data content) : content_(std::move(content)) {
+      // nop
+    }
+
+    event(event&&) = default;
+
+    event(const event&) = default;
+
+    event& operator=(event&&) = default;
+
+    event& operator=(const event&) = default;
+
+    /// Returns whether this object holds a well-formed store event.
+    explicit operator bool() const noexcept;
+
+    /// Returns the type of the event. Only valid if `*this` is `true`.
+    store_event::type type() const noexcept;
+
+    /// Returns an `insert` view, or an invalid view for other event types.
+    store_event::insert to_insert() const noexcept {
+      return store_event::insert::make(content_);
+    }
+
+    /// Returns an `update` view, or an invalid view for other event types.
+    store_event::update to_update() const noexcept {
+      return store_event::update::make(content_);
+    }
+
+    /// Returns an `erase` view, or an invalid view for other event types.
+    store_event::erase to_erase() const noexcept {
+      return store_event::erase::make(content_);
+    }
+
+    /// Returns an `expire` view, or an invalid view for other event types.
+    store_event::expire to_expire() const noexcept {
+      return store_event::expire::make(content_);
+    }
+
+    /// Returns the raw event encoding.
+    const data& content() const noexcept {
+      return content_;
+    }
+
+  private:
+    data content_;
+  };
+
+  using value_type = event;
+
+  // --- constructors and destructors ------------------------------------------
+
+  store_event_subscriber(store_event_subscriber&&) = default;
+
+  store_event_subscriber& operator=(store_event_subscriber&&) = default;
+
+  // --- access to values ------------------------------------------------------
+
+  /// @copydoc subscriber::get
+  value_type get(timestamp timeout);
+
+  /// @copydoc subscriber::get
+  template <class Duration>
+  value_type get(Duration relative_timeout) {
+    value_type result;
+    do {
+      if (auto maybe_msg = impl_.get(relative_timeout))
+        result = convert(*maybe_msg);
+    } while (!result && relative_timeout == infinite);
+    return result;
+  }
+
+  /// @copydoc subscriber::get
+  value_type get() {
+    return get(infinite);
+  }
+
+  /// @copydoc subscriber::get
+  std::vector<value_type> get(size_t num, timestamp timeout);
+
+  /// @copydoc subscriber::get
+  template <class Duration>
+  std::vector<value_type> get(size_t num, Duration relative_timeout) {
+    std::vector<value_type> result;
+    do {
+      auto msgs = impl_.get(num, relative_timeout);
+      for (auto& msg : msgs)
+        append_converted(result, msg);
+    } while (result.empty() && relative_timeout == infinite);
+    return result;
+  }
+
+  /// @copydoc subscriber::get
+  std::vector<value_type> get(size_t num) {
+    return get(num, infinite);
+  }
+
+  /// @copydoc subscriber::poll
+  std::vector<value_type> poll();
+
+  // --- properties ------------------------------------------------------------
+
+  /// @copydoc subscriber::set_rate_calculation
+  void set_rate_calculation(bool x) {
+    impl_.set_rate_calculation(x);
+  }
+
+  size_t rate() const {
+    return impl_.rate();
+  }
+
+  const broker::worker& worker() const {
+    return impl_.worker();
+  }
+
+  size_t available() const {
+    return impl_.available();
+  }
+
+  auto fd() const {
+    return impl_.fd();
+  }
+
+  // --- miscellaneous ---------------------------------------------------------
+
+  /// Release any state held by the object, rendering it invalid.
+  /// @warning Performing *any* action on this object afterwards invokes
+  ///          undefined behavior, except:
+  ///          - Destroying the object by calling the destructor.
+  ///          - Using copy- or move-assign from a valid `store` to "revive"
+  ///            this object.
+  ///          - Calling `reset` again (multiple invocations are no-ops).
+  /// @note This member function specifically targets the Python bindings. When
+  ///       writing Broker applications using the native C++ API, there's no
+  ///       point in calling this member function.
+  void reset();
+
+private:
+  // -- force users to use `endpoint::make_store_event_subscriber` -------------
+  store_event_subscriber(endpoint& ep, std::string store_name,
+                         size_t max_qsize);
+
+  value_type convert(data_message& msg);
+
+  void append_converted(std::vector<value_type>& result, data_message& msg);
+
+  subscriber impl_;
+};
+
+} // namespace broker
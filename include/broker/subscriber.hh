@@ -13,6 +13,37 @@
 
 namespace broker {
 
+/// Selects how a subscriber reacts when its queue reaches the high watermark.
+enum class backpressure_policy {
+  /// Stops granting credit upstream until the queue drains to the low
+  /// watermark again, throttling the publishers.
+  block,
+  /// Keeps granting credit and discards the oldest queued messages instead.
+  drop_oldest,
+  /// Keeps granting credit and discards incoming messages.
+  drop_newest,
+};
+
+/// Configures the backpressure behavior of a subscriber.
+struct backpressure_options {
+  /// Queue size that trips the backpressure mechanism. Zero defaults to the
+  /// maximum queue size of the subscriber.
+  size_t high_watermark = 0;
+
+  /// Queue size at which a tripped subscriber resumes normal operation. Zero
+  /// defaults to half of the high watermark.
+  size_t low_watermark = 0;
+
+  /// Selects the reaction when reaching the high watermark.
+  backpressure_policy policy = backpressure_policy::block;
+
+  /// If non-null, the subscriber invokes this callback from its background
+  /// worker with `true` whenever the high watermark trips and with `false`
+  /// once the queue drains to the low watermark again. Implementations must
+  /// be thread-safe and must not block.
+  std::function<void(bool)> on_congestion;
+};
+
 /// Provides blocking access to a stream of data.
 class subscriber : public subscriber_base<data_message> {
 public:
@@ -20,6 +51,7 @@ public:
 
   friend class endpoint;
   friend class status_subscriber;
+  friend class store_event_subscriber;
 
   // --- nested types ----------------------------------------------------------
 
@@ -71,9 +103,23 @@ private:
   // -- force users to use `endpoint::make_status_subscriber` ------------------
   subscriber(endpoint& ep, std::vector<topic> ts, size_t max_qsize);
 
+  subscriber(endpoint& ep, std::vector<topic> ts, size_t max_qsize,
+             backpressure_options opts, queue_type::observer obs = nullptr,
+             int numa_node = -1);
+
+  /// Tag type for selecting the direct delivery mode.
+  struct direct_tag {};
+
+  subscriber(endpoint& ep, std::vector<topic> ts, size_t max_qsize,
+             direct_tag);
+
   broker::worker worker_;
   std::vector<topic> filter_;
   endpoint* ep_;
+
+  /// Stores whether this subscriber registered its queue with the core for
+  /// direct delivery instead of spawning a worker with a stream sink.
+  bool direct_ = false;
 };
 
 } // namespace broker
@@ -6,6 +6,7 @@
 #include "broker/fwd.hh"
 #include "broker/topic.hh"
 
+#include <limits>
 #include <vector>
 
 namespace broker {
@@ -141,6 +142,32 @@ public:
     return rval;
   }
 
+  /// Invokes `f(ptr, n)` for contiguous runs of currently available values
+  /// without blocking, consuming at most `max_n` values in total. The pointer
+  /// borrows the queue's storage: `f` may read or move individual values, but
+  /// the run dies when `f` returns. Unlike `poll`, this never materializes an
+  /// intermediate vector. Returns the number of consumed values.
+  template <class F>
+  size_t drain(F f, size_t max_n = std::numeric_limits<size_t>::max()) {
+    size_t prev_size = 0;
+    auto got = queue_->consume_raw(max_n, &prev_size, std::move(f));
+    if (prev_size >= static_cast<size_t>(max_qsize_)
+        && prev_size - got < static_cast<size_t>(max_qsize_))
+      became_not_full();
+    return got;
+  }
+
+  /// Moves up to `capacity` currently available values into `buf` without
+  /// blocking or allocating. Returns the number of moved values.
+  size_t try_get_bulk(value_type* buf, size_t capacity) {
+    size_t prev_size = 0;
+    auto got = queue_->consume_into(buf, capacity, &prev_size);
+    if (prev_size >= static_cast<size_t>(max_qsize_)
+        && prev_size - got < static_cast<size_t>(max_qsize_))
+      became_not_full();
+    return got;
+  }
+
   // --- accessors -------------------------------------------------------------
 
   /// Returns the amound of values than can be extracted immediately without
@@ -155,6 +182,16 @@ public:
     return queue_->fd();
   }
 
+  // --- tuning ----------------------------------------------------------------
+
+  /// Configures how many times a blocking `get` busy-polls the queue before
+  /// parking on the file descriptor. Spinning trades CPU time for wakeup
+  /// latency; zero parks immediately. May only be called from the thread
+  /// that consumes this subscriber.
+  void set_spin_count(size_t x) {
+    queue_->spin_count(x);
+  }
+
 protected:
   /// This hook allows subclasses to perform some action if the queue changed
   /// state from full to not-full. This allows subscribers to make sure new
@@ -28,6 +28,8 @@ class histogram;
 template <class T>
 class histogram_family;
 
+class log_histogram;
+
 // -- convenience aliases ------------------------------------------------------
 
 using label_view = std::pair<std::string_view, std::string_view>;
@@ -20,7 +20,7 @@ double value(dbl_gauge_hdl* hdl) noexcept;
 
 /// @pre @p hdl must be a dbl_gauge family handle.
 dbl_gauge_hdl* dbl_gauge_get_or_add(metric_family_hdl* hdl,
-                                    span<telemetry::label_view> labels);
+                                    span<const label_view> labels);
 
 /// Increments the value of @p hdl by one.
 int64_t inc(int_gauge_hdl* hdl) noexcept;
@@ -39,7 +39,7 @@ int64_t value(int_gauge_hdl* hdl) noexcept;
 
 /// @pre @p hdl must be an int_gauge family handle.
 int_gauge_hdl* int_gauge_get_or_add(metric_family_hdl* hdl,
-                                    span<telemetry::label_view> labels);
+                                    span<const label_view> labels);
 
 /// A handle to a metric that represents an single value. Wraps an opaque gauge
 /// handle to provide a class-based interface.
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace broker::telemetry {
+
+/// Generates upper bounds for a log-linear bucket layout. Each power-of-two
+/// range `[2^e, 2^(e+1))` for `e` in `[min_exponent, max_exponent)` is split
+/// into `2^subbucket_bits` equally sized buckets, preceded by one underflow
+/// bucket with upper bound `2^min_exponent`. Values above `2^max_exponent`
+/// land in the implicit overflow bucket.
+std::vector<double> log_linear_bounds(int min_exponent, int max_exponent,
+                                      int subbucket_bits);
+
+/// A histogram with log-linear buckets and O(1) bucket selection. Regular
+/// @ref histogram handles scan their bucket bounds linearly on every
+/// observation, which becomes measurable for latency histograms with dozens
+/// of buckets at millions of observations per second. This type instead
+/// derives the bucket index directly from the exponent and leading mantissa
+/// bits of the observed value and bumps an atomic cell, so the cost per
+/// observation is independent of the number of buckets.
+///
+/// Instances live outside of the CAF registry and register themselves in a
+/// process-wide list that the scraper reads, so exported rows and the
+/// Prometheus output include them like any other histogram. Handles are
+/// cheap to copy and share the same cells.
+class log_histogram {
+public:
+  log_histogram() = delete;
+
+  log_histogram(const log_histogram&) = default;
+
+  log_histogram& operator=(const log_histogram&) = default;
+
+  /// Returns the histogram with the full name `pre.name`, creating it lazily
+  /// if necessary. The first call wins when called multiple times with
+  /// different bucket settings.
+  /// @param pre The prefix (namespace) this metric belongs to.
+  /// @param name The human-readable name of the metric, e.g., `queue-time`.
+  /// @param min_exponent Exponent of the smallest explicit upper bound.
+  /// @param max_exponent Exponent of the largest explicit upper bound.
+  /// @param subbucket_bits Log2 of the number of buckets per power of two.
+  /// @param helptext Short explanation of the metric.
+  /// @param unit Unit of measurement.
+  static log_histogram get_or_add(std::string_view pre, std::string_view name,
+                                  int min_exponent, int max_exponent,
+                                  int subbucket_bits, std::string_view helptext,
+                                  std::string_view unit = "1");
+
+  /// Increments the bucket for @p value by one and adds @p value to the total
+  /// sum of all observed values.
+  void observe(double value) noexcept;
+
+  /// @return The index of the bucket that @p value falls into.
+  size_t index_of(double value) const noexcept;
+
+  /// @return The sum of all observed values.
+  double sum() const noexcept;
+
+  /// @return The number of buckets, including the implicit overflow bucket.
+  size_t num_buckets() const noexcept;
+
+  /// @return The number of observations in the bucket at @p index.
+  /// @pre `index < num_buckets()`
+  int64_t count_at(size_t index) const noexcept;
+
+  /// @return The upper bound of the bucket at @p index (infinity for the
+  ///         overflow bucket).
+  /// @pre `index < num_buckets()`
+  double upper_bound_at(size_t index) const noexcept;
+
+  /// @return The prefix (namespace) of the metric.
+  const std::string& prefix() const noexcept;
+
+  /// @return The human-readable name of the metric.
+  const std::string& name() const noexcept;
+
+  /// @return The short explanation of the metric.
+  const std::string& helptext() const noexcept;
+
+  /// @return The unit of measurement.
+  const std::string& unit() const noexcept;
+
+  /// @return Whether @c this and @p other refer to the same histogram.
+  bool is_same_as(const log_histogram& other) const noexcept {
+    return impl_ == other.impl_;
+  }
+
+private:
+  struct impl;
+
+  explicit log_histogram(std::shared_ptr<impl> ptr) noexcept
+    : impl_(std::move(ptr)) {
+    // nop
+  }
+
+  std::shared_ptr<impl> impl_;
+};
+
+/// @relates log_histogram
+inline bool operator==(const log_histogram& x, const log_histogram& y) {
+  return x.is_same_as(y);
+}
+
+/// @relates log_histogram
+inline bool operator!=(const log_histogram& x, const log_histogram& y) {
+  return !(x == y);
+}
+
+/// @return A snapshot of all @ref log_histogram instances in this process.
+/// @relates log_histogram
+std::vector<log_histogram> log_histograms();
+
+} // namespace broker::telemetry
@@ -5,6 +5,7 @@
 #include "broker/telemetry/counter.hh"
 #include "broker/telemetry/gauge.hh"
 #include "broker/telemetry/histogram.hh"
+#include "broker/telemetry/log_histogram.hh"
 #include "broker/telemetry/metric_registry_impl.hh"
 
 #include <cstdint>
@@ -61,11 +62,15 @@ public:
                       std::string_view helptext, std::string_view unit = "1",
                       bool is_sum = false) {
     if constexpr (std::is_same_v<T, int64_t>) {
-      return impl_->int_counter_fam(pre, name, labels, helptext, unit, is_sum);
+      auto hdl
+        = impl_->int_counter_fam(pre, name, labels, helptext, unit, is_sum);
+      return int_counter_family{hdl};
     } else {
       static_assert(std::is_same_v<T, double>,
                     "metrics only support int64_t and double values");
-      return impl_->dbl_counter_fam(pre, name, labels, helptext, unit, is_sum);
+      auto hdl
+        = impl_->dbl_counter_fam(pre, name, labels, helptext, unit, is_sum);
+      return dbl_counter_family{hdl};
     }
   }
 
@@ -98,7 +103,7 @@ public:
     return with_label_names(labels, [&, this](auto labelNames) {
       auto family
         = counter_family<T>(pre, name, labelNames, helptext, unit, is_sum);
-      return family.getOrAdd(labels);
+      return family.get_or_add(labels);
     });
   }
 
@@ -150,11 +155,15 @@ public:
                     std::string_view helptext, std::string_view unit = "1",
                     bool is_sum = false) {
     if constexpr (std::is_same<T, int64_t>::value) {
-      return impl_->int_gauge_fam(pre, name, labels, helptext, unit, is_sum);
+      auto hdl
+        = impl_->int_gauge_fam(pre, name, labels, helptext, unit, is_sum);
+      return int_gauge_family{hdl};
     } else {
       static_assert(std::is_same<T, double>::value,
                     "metrics only support int64_t and double values");
-      return impl_->dbl_gauge_fam(pre, name, labels, helptext, unit, is_sum);
+      auto hdl
+        = impl_->dbl_gauge_fam(pre, name, labels, helptext, unit, is_sum);
+      return dbl_gauge_family{hdl};
     }
   }
 
@@ -187,7 +196,7 @@ public:
     return with_label_names(labels, [&, this](auto labelNames) {
       auto family
         = gauge_family<T>(pre, name, labelNames, helptext, unit, is_sum);
-      return family.getOrAdd(labels);
+      return family.get_or_add(labels);
     });
   }
 
@@ -313,7 +322,7 @@ public:
     return with_label_names(labels, [&, this](auto labelNames) {
       auto family = histogram_family<T>(
         pre, name, labelNames, default_upper_bounds, helptext, unit, is_sum);
-      return family.getOrAdd(labels);
+      return family.get_or_add(labels);
     });
   }
 
@@ -362,6 +371,30 @@ public:
     return fam.get_or_add({});
   }
 
+  /**
+   * Returns a histogram with log-linear buckets and O(1) bucket selection
+   * for hot-path measurements such as nanosecond latencies. Unlike
+   * @ref histogram_singleton, observations do not scan the bucket bounds:
+   * the bucket index derives from the exponent of the observed value.
+   * Instances register process-wide and appear in scrapes like any other
+   * histogram.
+   * @param pre The prefix (namespace) this metric belongs to.
+   * @param name The human-readable name of the metric, e.g., `queue-time`.
+   * @param min_exponent Exponent of the smallest explicit upper bound.
+   * @param max_exponent Exponent of the largest explicit upper bound.
+   * @param subbucket_bits Log2 of the number of buckets per power of two.
+   * @param helptext Short explanation of the metric.
+   * @param unit Unit of measurement.
+   * @note The first call wins when calling this function multiple times with
+   *       different bucket settings.
+   */
+  log_histogram log_histogram_singleton(std::string_view pre,
+                                        std::string_view name,
+                                        int min_exponent, int max_exponent,
+                                        int subbucket_bits,
+                                        std::string_view helptext,
+                                        std::string_view unit = "1");
+
   [[nodiscard]] metric_registry_impl* pimpl() const noexcept {
     return impl_;
   }
@@ -370,17 +403,17 @@ private:
   metric_registry(metric_registry_impl* impl, bool add_ref) noexcept;
 
   template <class F>
-  static void with_label_names(span<const label_view> xs, F continuation) {
+  static auto with_label_names(span<const label_view> xs, F continuation) {
     if (xs.size() <= 10) {
       std::string_view buf[10];
       for (size_t index = 0; index < xs.size(); ++index)
         buf[index] = xs[index].first;
-      return continuation(span{buf, xs.size()});
+      return continuation(span<const std::string_view>{buf, xs.size()});
     } else {
       std::vector<std::string_view> buf;
       for (auto x : xs)
-        buf.emplace_back(x.first, x.second);
-      return continuation(span{buf});
+        buf.emplace_back(x.first);
+      return continuation(span<const std::string_view>{buf});
     }
   }
 
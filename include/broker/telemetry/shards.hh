@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+#include "broker/telemetry/fwd.hh"
+
+namespace broker::telemetry::shards {
+
+/// Per-thread sharding for hot-path metric updates. Incrementing a shared
+/// counter from many threads bounces its cache line between cores; these
+/// functions instead accumulate updates in thread-local cells and drain them
+/// into the underlying metric lazily, so the hot path only ever touches
+/// memory owned by the calling thread.
+///
+/// Readers must call `flush()` first to observe pending updates; the facade
+/// functions in counter.hh and histogram.hh as well as the scraper do so
+/// automatically.
+
+/// Adds `amount` to the calling thread's cell for `hdl`.
+void add(int_counter_hdl* hdl, int64_t amount) noexcept;
+
+/// @copydoc add
+void add(dbl_counter_hdl* hdl, double amount) noexcept;
+
+/// Records `value` in the calling thread's cell for `hdl`. Cells buffer raw
+/// observations and replay them in batches, preserving the exact bucket
+/// distribution and sum of the histogram.
+void observe(int_histogram_hdl* hdl, int64_t value);
+
+/// @copydoc observe
+void observe(dbl_histogram_hdl* hdl, double value);
+
+/// Drains the cells of all threads into the underlying metrics.
+void flush();
+
+} // namespace broker::telemetry::shards
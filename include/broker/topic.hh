@@ -7,6 +7,8 @@
 #include <utility>
 #include <vector>
 
+#include "broker/detail/copy_profiler.hh"
+#include "broker/detail/hash.hh"
 #include "broker/detail/operators.hh"
 
 namespace broker {
@@ -20,6 +22,10 @@ public:
   /// A reserved string which must not appear in a user topic.
   static constexpr std::string_view reserved = "<$>";
 
+  /// A segment that matches any single topic segment when used in a filter
+  /// entry, e.g., `zeek/logs/*/conn`.
+  static constexpr std::string_view wildcard_str = "*";
+
   static constexpr std::string_view master_suffix_str = "<$>/data/master";
 
   static constexpr std::string_view clone_suffix_str = "<$>/data/clone";
@@ -54,6 +60,31 @@ public:
   /// Default-constructs an empty topic.
   topic() = default;
 
+#ifdef BROKER_HAVE_COPY_PROFILING
+  // Only declared in profiling builds; the compiler-generated special members
+  // apply otherwise.
+
+  topic(const topic& other) : str_(other.str_) {
+    BROKER_PROFILE_COPY(topic, str_.size());
+  }
+
+  topic(topic&& other) noexcept : str_(std::move(other.str_)) {
+    BROKER_PROFILE_MOVE(topic);
+  }
+
+  topic& operator=(const topic& other) {
+    str_ = other.str_;
+    BROKER_PROFILE_COPY(topic, str_.size());
+    return *this;
+  }
+
+  topic& operator=(topic&& other) noexcept {
+    str_ = std::move(other.str_);
+    BROKER_PROFILE_MOVE(topic);
+    return *this;
+  }
+#endif
+
   /// Constructs a topic from a type that is convertible to a string.
   /// @param x A value convertible to a string.
   template <
@@ -63,7 +94,7 @@ public:
     >::type
   >
   topic(T&& x) : str_(std::forward<T>(x)) {
-    // nop
+    BROKER_PROFILE_CONSTRUCTION(topic);
   }
 
   /// Appends a topic components with a separator.
@@ -80,6 +111,10 @@ public:
   /// Returns whether this topic is a prefix match for `t`.
   bool prefix_of(const topic& t) const;
 
+  /// Returns whether this topic contains a wildcard segment and thus acts as
+  /// a pattern rather than a plain prefix when used in a filter.
+  [[nodiscard]] bool contains_wildcard() const noexcept;
+
   /// Returns the suffix of the topic, i.e., the characters after the last
   /// separator. For example, the suffix of `/foo/bar` is `bar`.
   std::string_view suffix() const noexcept;
@@ -142,7 +177,8 @@ namespace std {
 template <>
 struct hash<broker::topic> {
   size_t operator()(const broker::topic& t) const {
-    return std::hash<std::string>{}(t.string());
+    auto& str = t.string();
+    return broker::detail::hash_bytes(str.data(), str.size());
   }
 };
 
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "broker/cow_tuple.hh"
+#include "broker/detail/data_codec.hh"
+#include "broker/expected.hh"
+#include "broker/topic.hh"
+
+namespace broker {
+
+/// Binds a topic to a fixed message schema. Producers with a known field
+/// layout can encode directly to the wire codec without constructing the
+/// intermediate `data` tree, and subscribers decode into a typed tuple
+/// instead of a `data` variant per field. The bytes are identical to
+/// encoding `data{vector{fields...}}`, so typed and untyped peers on the
+/// same topic interoperate freely.
+///
+/// ```
+/// using conn_topic = typed_topic<timestamp, address, port, count>;
+/// conn_topic events{"/zeek/events/conn"};
+/// auto bytes = events.encode(broker::now(), src, dst_port, num_bytes);
+/// // ...
+/// if (auto msg = events.decode(bytes))
+///   auto& src = get<1>(*msg);
+/// ```
+template <class... Ts>
+class typed_topic {
+public:
+  static_assert(sizeof...(Ts) > 0, "a typed topic needs at least one field");
+
+  /// The typed representation of one message.
+  using tuple_type = cow_tuple<Ts...>;
+
+  /// Number of fields in the schema.
+  static constexpr size_t num_fields = sizeof...(Ts);
+
+  explicit typed_topic(topic t) : topic_(std::move(t)) {
+    // nop
+  }
+
+  typed_topic(const typed_topic&) = default;
+
+  typed_topic& operator=(const typed_topic&) = default;
+
+  /// Returns the topic this schema is bound to.
+  const topic& name() const noexcept {
+    return topic_;
+  }
+
+  /// Appends the encoded fields to `buf`.
+  static void encode_to(std::vector<std::byte>& buf, const Ts&... fields) {
+    detail::encode_vector_prefix(num_fields, buf);
+    (detail::encode_field(fields, buf), ...);
+  }
+
+  /// Returns a fresh buffer holding the encoded fields.
+  static std::vector<std::byte> encode(const Ts&... fields) {
+    std::vector<std::byte> buf;
+    encode_to(buf, fields...);
+    return buf;
+  }
+
+  /// @copydoc encode
+  static std::vector<std::byte> encode(const tuple_type& msg) {
+    return std::apply([](const Ts&... fields) { return encode(fields...); },
+                      msg.data());
+  }
+
+  /// Decodes a message previously produced by `encode` (or by the generic
+  /// codec from an equivalent `data` tree). Returns `ec::invalid_data` for
+  /// truncated input or a schema mismatch.
+  static expected<tuple_type> decode(const std::byte* first, size_t size) {
+    detail::field_reader in{first, first + size};
+    if (!detail::decode_vector_prefix(in, num_fields))
+      return ec::invalid_data;
+    std::tuple<Ts...> fields;
+    auto decode_one = [&in](auto&... xs) {
+      return (detail::decode_field(in, xs) && ...);
+    };
+    if (!std::apply(decode_one, fields) || in.pos != in.end)
+      return ec::invalid_data;
+    return std::apply(
+      [](Ts&... xs) { return tuple_type{std::move(xs)...}; }, fields);
+  }
+
+  /// @copydoc decode
+  static expected<tuple_type> decode(const std::vector<std::byte>& buf) {
+    return decode(buf.data(), buf.size());
+  }
+
+private:
+  topic topic_;
+};
+
+} // namespace broker
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "broker/data.hh"
+
+namespace broker {
+
+/// Assembles a @ref vector with a single up-front allocation and in-place
+/// element construction. Batch producers that know their element count can
+/// thus skip both the repeated reallocation of `push_back` loops and the
+/// temporary `data` value per element:
+///
+/// ```
+/// vector_builder fields{3};
+/// fields.emplace<std::string>(buf, len);
+/// fields.emplace<count>(num_bytes);
+/// fields.add(src_addr);
+/// publish(make_data_message(topic, std::move(fields)));
+/// ```
+class vector_builder {
+public:
+  vector_builder() = default;
+
+  /// Reserves room for `size_hint` elements up front.
+  explicit vector_builder(size_t size_hint) {
+    xs_.reserve(size_hint);
+  }
+
+  vector_builder(vector_builder&&) = default;
+
+  vector_builder& operator=(vector_builder&&) = default;
+
+  /// Appends an element holding `T`, constructed in place inside the data
+  /// variant from constructor arguments.
+  template <class T, class... Args>
+  data& emplace(Args&&... args) {
+    return xs_.emplace_back(std::in_place_type<T>,
+                            std::forward<Args>(args)...);
+  }
+
+  /// Appends a prebuilt value.
+  template <class T>
+  data& add(T&& x) {
+    return xs_.emplace_back(std::forward<T>(x));
+  }
+
+  /// Returns the number of elements added so far.
+  size_t size() const noexcept {
+    return xs_.size();
+  }
+
+  /// Returns the assembled vector. The builder is in a moved-from state
+  /// afterwards.
+  vector build() && {
+    return std::move(xs_);
+  }
+
+private:
+  vector xs_;
+};
+
+} // namespace broker
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
 #include "broker/data.hh"
 
 namespace broker::zeek {
@@ -81,8 +86,33 @@ public:
   }
 
 protected:
-  Message(Type type, vector content)
-    : data_(vector{ProtocolVersion, count(type), std::move(content)}) {
+  /// Returns the preconstructed header prototype for `type`: the outer
+  /// protocol vector with version, type tag, and a nil content slot. The
+  /// registry gets built once per process, so per-message construction only
+  /// copies two inline counts plus the nil placeholder before moving the
+  /// payload into place.
+  static const data& header_prototype(Type type) {
+    static const std::array<data, Type::MAX + 1> prototypes = [] {
+      std::array<data, Type::MAX + 1> xs;
+      for ( size_t i = 0; i < xs.size(); ++i )
+        xs[i] = data(vector{ProtocolVersion, count(i), data()});
+      return xs;
+    }();
+    return prototypes[type];
+  }
+
+  /// Assembles a content vector without going through an initializer list,
+  /// which would deep-copy every element.
+  template <class... Ts>
+  static vector build_content(Ts&&... xs) {
+    vector rval;
+    rval.reserve(sizeof...(Ts));
+    (rval.emplace_back(std::forward<Ts>(xs)), ...);
+    return rval;
+  }
+
+  Message(Type type, vector content) : data_(header_prototype(type)) {
+    get<vector>(data_)[2] = data(std::move(content));
   }
 
   Message(data msg) : data_(std::move(msg)) {
@@ -95,7 +125,8 @@ protected:
 class Event : public Message {
   public:
   Event(std::string name, vector args)
-    : Message(Message::Type::Event, {std::move(name), std::move(args)}) {}
+    : Message(Message::Type::Event,
+              build_content(std::move(name), std::move(args))) {}
 
   Event(data msg) : Message(std::move(msg)) {}
 
@@ -141,6 +172,78 @@ class Event : public Message {
 
     return true;
   }
+
+  /// A validated view onto an event. Construction performs the structural
+  /// checks of `type()` and `valid()` exactly once; the accessors afterwards
+  /// dereference stored pointers without re-inspecting the variant. The view
+  /// borrows the message and must not outlive it.
+  class view {
+  public:
+    view(const view&) noexcept = default;
+
+    view& operator=(const view&) noexcept = default;
+
+    /// Creates a view for `msg`.
+    /// @returns A valid view if `msg` is a structurally valid event, an
+    /// invalid view otherwise.
+    static view make(const data& msg) {
+      auto outer = get_if<vector>(&msg);
+
+      if ( ! outer || outer->size() < 3 )
+        return view{};
+
+      auto type_ptr = get_if<count>(&(*outer)[1]);
+
+      if ( ! type_ptr || *type_ptr != Type::Event )
+        return view{};
+
+      auto inner = get_if<vector>(&(*outer)[2]);
+
+      if ( ! inner || inner->size() < 2 )
+        return view{};
+
+      auto name_ptr = get_if<std::string>(&(*inner)[0]);
+      auto args_ptr = get_if<vector>(&(*inner)[1]);
+
+      if ( ! name_ptr || ! args_ptr )
+        return view{};
+
+      return view{name_ptr, args_ptr};
+    }
+
+    bool valid() const noexcept {
+      return name_ != nullptr;
+    }
+
+    explicit operator bool() const noexcept {
+      return valid();
+    }
+
+    /// @pre `valid()`
+    const std::string& name() const noexcept {
+      return *name_;
+    }
+
+    /// @pre `valid()`
+    const vector& args() const noexcept {
+      return *args_;
+    }
+
+  private:
+    view() noexcept = default;
+
+    view(const std::string* name_ptr, const vector* args_ptr) noexcept
+      : name_(name_ptr), args_(args_ptr) {
+    }
+
+    const std::string* name_ = nullptr;
+    const vector* args_ = nullptr;
+  };
+
+  /// Creates a validated view onto this event.
+  view make_view() const {
+    return view::make(as_data());
+  }
 };
 
 /// A batch of other messages.
@@ -149,8 +252,41 @@ class Batch : public Message {
   Batch(vector msgs)
     : Message(Message::Type::Batch, std::move(msgs)) {}
 
+  /// Creates an empty batch with room for `size_hint` messages, so that
+  /// assembling the batch performs a single allocation up front instead of
+  /// reallocating while messages get added.
+  explicit Batch(size_t size_hint)
+    : Message(Message::Type::Batch, vector{}) {
+    batch().reserve(size_hint);
+  }
+
   Batch(data msg) : Message(std::move(msg)) {}
 
+  /// Appends a message to the batch without copying its content.
+  void add(Message&& msg) {
+    batch().emplace_back(msg.move_data());
+  }
+
+  /// @copydoc add
+  void add(data msg) {
+    batch().emplace_back(std::move(msg));
+  }
+
+  /// Moves the message at index `i` out of the batch, e.g., for routing it
+  /// to a different destination without a deep copy. The slot keeps a `nil`
+  /// placeholder so that remaining indices stay valid.
+  /// @pre `i < batch().size()`
+  data take(size_t i) {
+    return std::exchange(batch()[i], data{});
+  }
+
+  /// Iterates a batch as lightweight message views; see @ref MessageView.
+  class const_iterator;
+
+  const_iterator begin() const;
+
+  const_iterator end() const;
+
   const vector& batch() const {
     return get<vector>(as_vector()[2]);
   }
@@ -179,8 +315,8 @@ public:
   LogCreate(enum_value stream_id, enum_value writer_id, data writer_info,
             data fields_data)
     : Message(Message::Type::LogCreate,
-              {std::move(stream_id), std::move(writer_id),
-               std::move(writer_info), std::move(fields_data)}) {
+              build_content(std::move(stream_id), std::move(writer_id),
+                            std::move(writer_info), std::move(fields_data))) {
   }
 
   LogCreate(data msg) : Message(std::move(msg)) {
@@ -249,8 +385,8 @@ public:
   LogWrite(enum_value stream_id, enum_value writer_id, data path,
            data serial_data)
     : Message(Message::Type::LogWrite,
-              {std::move(stream_id), std::move(writer_id),
-               std::move(path), std::move(serial_data)}) {
+              build_content(std::move(stream_id), std::move(writer_id),
+                            std::move(path), std::move(serial_data))) {
   }
 
   LogWrite(data msg) : Message(std::move(msg)) {
@@ -310,13 +446,185 @@ public:
 
     return true;
   }
+
+  /// A validated view onto a log-write message. Construction performs the
+  /// structural checks of `type()` and `valid()` exactly once; the accessors
+  /// afterwards dereference stored pointers without re-inspecting the
+  /// variant. The view borrows the message and must not outlive it.
+  class view {
+  public:
+    view(const view&) noexcept = default;
+
+    view& operator=(const view&) noexcept = default;
+
+    /// Creates a view for `msg`.
+    /// @returns A valid view if `msg` is a structurally valid log-write
+    /// message, an invalid view otherwise.
+    static view make(const data& msg) {
+      auto outer = get_if<vector>(&msg);
+
+      if ( ! outer || outer->size() < 3 )
+        return view{};
+
+      auto type_ptr = get_if<count>(&(*outer)[1]);
+
+      if ( ! type_ptr || *type_ptr != Type::LogWrite )
+        return view{};
+
+      auto inner = get_if<vector>(&(*outer)[2]);
+
+      if ( ! inner || inner->size() < 4 )
+        return view{};
+
+      auto stream_ptr = get_if<enum_value>(&(*inner)[0]);
+      auto writer_ptr = get_if<enum_value>(&(*inner)[1]);
+
+      if ( ! stream_ptr || ! writer_ptr )
+        return view{};
+
+      return view{inner, stream_ptr, writer_ptr};
+    }
+
+    bool valid() const noexcept {
+      return fields_ != nullptr;
+    }
+
+    explicit operator bool() const noexcept {
+      return valid();
+    }
+
+    /// @pre `valid()`
+    const enum_value& stream_id() const noexcept {
+      return *stream_;
+    }
+
+    /// @pre `valid()`
+    const enum_value& writer_id() const noexcept {
+      return *writer_;
+    }
+
+    /// @pre `valid()`
+    const data& path() const noexcept {
+      return (*fields_)[2];
+    }
+
+    /// @pre `valid()`
+    const data& serial_data() const noexcept {
+      return (*fields_)[3];
+    }
+
+  private:
+    view() noexcept = default;
+
+    view(const vector* fields_ptr, const enum_value* stream_ptr,
+         const enum_value* writer_ptr) noexcept
+      : fields_(fields_ptr), stream_(stream_ptr), writer_(writer_ptr) {
+    }
+
+    const vector* fields_ = nullptr;
+    const enum_value* stream_ = nullptr;
+    const enum_value* writer_ = nullptr;
+  };
+
+  /// Creates a validated view onto this message.
+  view make_view() const {
+    return view::make(as_data());
+  }
+};
+
+/// A lightweight non-owning view of one message inside a batch. Unlike
+/// wrapping the element in a @ref Message subclass, creating the view copies
+/// nothing; it borrows the batch and must not outlive it.
+class MessageView {
+public:
+  explicit MessageView(const data& msg) noexcept : msg_(&msg) {
+  }
+
+  MessageView(const MessageView&) noexcept = default;
+
+  MessageView& operator=(const MessageView&) noexcept = default;
+
+  Message::Type type() const {
+    return Message::type(*msg_);
+  }
+
+  const data& as_data() const noexcept {
+    return *msg_;
+  }
+
+  /// Returns a validated event view, or an invalid view if the message is
+  /// not a structurally valid event.
+  Event::view as_event() const {
+    return Event::view::make(*msg_);
+  }
+
+  /// Returns a validated log-write view, or an invalid view if the message
+  /// is not a structurally valid log write.
+  LogWrite::view as_log_write() const {
+    return LogWrite::view::make(*msg_);
+  }
+
+private:
+  const data* msg_;
+};
+
+class Batch::const_iterator {
+public:
+  using iterator_category = std::input_iterator_tag;
+
+  using value_type = MessageView;
+
+  using difference_type = ptrdiff_t;
+
+  using pointer = void;
+
+  using reference = MessageView;
+
+  MessageView operator*() const {
+    return MessageView{*pos_};
+  }
+
+  const_iterator& operator++() {
+    ++pos_;
+    return *this;
+  }
+
+  const_iterator operator++(int) {
+    auto tmp = *this;
+    ++pos_;
+    return tmp;
+  }
+
+  bool operator==(const const_iterator& other) const noexcept {
+    return pos_ == other.pos_;
+  }
+
+  bool operator!=(const const_iterator& other) const noexcept {
+    return pos_ != other.pos_;
+  }
+
+private:
+  friend class Batch;
+
+  explicit const_iterator(vector::const_iterator pos) : pos_(pos) {
+  }
+
+  vector::const_iterator pos_;
 };
 
+inline Batch::const_iterator Batch::begin() const {
+  return const_iterator{batch().begin()};
+}
+
+inline Batch::const_iterator Batch::end() const {
+  return const_iterator{batch().end()};
+}
+
 class IdentifierUpdate : public Message {
 public:
   IdentifierUpdate(std::string id_name, data id_value)
-    : Message(Message::Type::IdentifierUpdate, {std::move(id_name),
-    		                                    std::move(id_value)}) {
+    : Message(Message::Type::IdentifierUpdate,
+              build_content(std::move(id_name), std::move(id_value))) {
   }
 
   IdentifierUpdate(data msg) : Message(std::move(msg)) {
@@ -9,6 +9,7 @@
 #include <string>
 
 #include "broker/config.hh"
+#include "broker/detail/address_format.hh"
 
 #include <caf/detail/network_order.hpp>
 #include <caf/hash/fnv.hpp>
@@ -122,11 +123,29 @@ size_t address::hash() const {
 }
 
 bool address::convert_to(std::string& str) const {
-  str = to_string(native_t{bytes_});
+  char buf[detail::max_ipv6_chars];
+  auto len = is_v4() ? detail::format_ipv4(bytes_.data() + 12, buf)
+                     : detail::format_ipv6(bytes_.data(), buf);
+  str.assign(buf, len);
   return true;
 }
 
 bool address::convert_from(const std::string& str) {
+  // The fast parsers cover canonical v4 and v6 notation; anything they
+  // reject goes through the generic CAF parser so that no previously
+  // accepted spelling changes behavior.
+  array_type parsed;
+  if (str.find(':') != std::string::npos) {
+    if (detail::parse_ipv6(str, parsed.data())) {
+      bytes_ = parsed;
+      return true;
+    }
+  } else if (detail::parse_ipv4(str, parsed.data() + 12)) {
+    std::copy(v4_mapped_prefix.begin(), v4_mapped_prefix.end(),
+              parsed.begin());
+    bytes_ = parsed;
+    return true;
+  }
   native_t tmp;
   if (auto err = caf::parse(str, tmp)) {
     return false;
@@ -0,0 +1,215 @@
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <caf/actor_system_config.hpp>
+#include <caf/config_option_adder.hpp>
+#include <caf/span.hpp>
+
+#include "broker/configuration.hh"
+#include "broker/detail/filesystem.hh"
+#include "broker/detail/preset_dictionary.hh"
+#include "broker/internal/configuration_access.hh"
+#include "broker/internal/generator_file_reader.hh"
+#include "broker/internal/type_id.hh"
+#include "broker/message.hh"
+#include "broker/topic.hh"
+
+using std::string;
+
+using string_list = std::vector<string>;
+
+// Trains deflate preset dictionaries from recorded generator files, one
+// dictionary per topic prefix plus a catch-all "default" dictionary. The
+// emitted "*.dict" files feed "broker.compression-dictionary-directory"; see
+// broker/detail/preset_dictionary.hh for how endpoints use them.
+
+namespace {
+
+template <class... Ts>
+void println(Ts&&... xs) {
+  (std::cout << ... << xs) << std::endl;
+}
+
+template <class... Ts>
+void err_println(Ts&&... xs) {
+  (std::cerr << "broker-dict-train: " << ... << xs) << std::endl;
+}
+
+void extend_config(broker::configuration& broker_cfg) {
+  auto& cfg = broker::internal::configuration_access(&broker_cfg).cfg();
+  caf::config_option_adder{cfg.custom_options(), "global"}
+    .add<string_list>("input,i", "generator files to train from")
+    .add<string>("output-dir,o",
+                 "directory for the emitted .dict files (default: .)")
+    .add<size_t>("max-dict-size,s",
+                 "byte cap per dictionary (default: 32768, the deflate "
+                 "window size)")
+    .add<size_t>("min-samples,m",
+                 "minimum number of messages per topic prefix to train a "
+                 "dictionary (default: 16)");
+}
+
+/// Returns the first topic segment, which matches the store name for command
+/// traffic.
+string first_segment(const string& topic_str) {
+  auto begin = topic_str.find_first_not_of(broker::topic::sep);
+  if (begin == string::npos)
+    return "default";
+  auto end = topic_str.find(broker::topic::sep, begin);
+  auto result = topic_str.substr(begin, end == string::npos ? end
+                                                            : end - begin);
+  // Segments double as file names; replace anything unsafe.
+  for (auto& c : result)
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_'
+        && c != '.')
+      c = '_';
+  return result;
+}
+
+using sample_list = std::vector<std::vector<std::byte>>;
+
+/// Collects the raw entry bytes of `file_name` into `samples`, keyed by the
+/// first topic segment. Returns `false` when the file cannot be read.
+bool collect_samples(const string& file_name,
+                     std::map<string, sample_list>& samples) {
+  auto reader = broker::internal::make_generator_file_reader(file_name);
+  if (reader == nullptr) {
+    err_println("unable to open generator file: ", file_name);
+    return false;
+  }
+  using value_type = broker::internal::generator_file_reader::value_type;
+  auto add_sample = [&](value_type* ptr, caf::span<const caf::byte> bytes) {
+    // Topic table and time gap entries carry no message payload.
+    if (ptr == nullptr)
+      return true;
+    auto& topic_str = std::visit(
+      [](const auto& msg) -> const string& {
+        return get_topic(msg).string();
+      },
+      *ptr);
+    std::vector<std::byte> sample;
+    sample.reserve(bytes.size());
+    for (auto b : bytes)
+      sample.push_back(static_cast<std::byte>(b));
+    samples[first_segment(topic_str)].emplace_back(std::move(sample));
+    return true;
+  };
+  if (auto err = reader->read_raw(add_sample)) {
+    err_println("error while parsing ", file_name, ": ", to_string(err));
+    return false;
+  }
+  return true;
+}
+
+/// Sums the deflated size of all samples, priming the compressor with `dict`
+/// unless it is `nullptr`. Returns 0 in builds without zlib support.
+size_t deflated_total(const sample_list& samples,
+                      const broker::detail::preset_dictionary* dict) {
+  size_t result = 0;
+  std::vector<std::byte> scratch;
+  for (const auto& sample : samples) {
+    scratch.clear();
+    if (!broker::detail::deflate_bytes(sample.data(), sample.size(), dict,
+                                       scratch))
+      return 0;
+    result += scratch.size();
+  }
+  return result;
+}
+
+bool train_and_emit(const string& name, const sample_list& samples,
+                    const string& output_dir, size_t max_size) {
+  broker::detail::preset_dictionary dict;
+  dict.name = name;
+  dict.bytes = broker::detail::train_preset_dictionary(samples, max_size);
+  if (dict.bytes.empty())
+    return true;
+  dict.checksum = broker::detail::preset_dictionary_checksum(
+    dict.bytes.data(), dict.bytes.size());
+  auto path = output_dir + "/" + name + ".dict";
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  out.write(reinterpret_cast<const char*>(dict.bytes.data()),
+            static_cast<std::streamsize>(dict.bytes.size()));
+  if (!out) {
+    err_println("unable to write ", path);
+    return false;
+  }
+  size_t raw = 0;
+  for (const auto& sample : samples)
+    raw += sample.size();
+  println(path, ": ", dict.bytes.size(), " bytes from ", samples.size(),
+          " samples");
+  // Report how much the dictionary buys over plain deflate, if this build
+  // can measure it.
+  auto plain = deflated_total(samples, nullptr);
+  auto primed = deflated_total(samples, &dict);
+  if (plain > 0 && primed > 0 && raw > 0)
+    println("  deflate ratio without dictionary: ",
+            static_cast<double>(raw) / static_cast<double>(plain),
+            ", with dictionary: ",
+            static_cast<double>(raw) / static_cast<double>(primed));
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  broker::configuration::init_global_state();
+  broker::configuration cfg{broker::skip_init};
+  extend_config(cfg);
+  try {
+    cfg.init(argc, argv);
+  } catch (std::exception& ex) {
+    err_println(ex.what());
+    return EXIT_FAILURE;
+  }
+  if (cfg.cli_helptext_printed())
+    return EXIT_SUCCESS;
+  auto& caf_cfg = broker::internal::configuration_access(&cfg).cfg();
+  auto inputs = caf::get_or(caf_cfg, "input", string_list{});
+  if (inputs.empty()) {
+    err_println("no generator files specified (see --input)");
+    return EXIT_FAILURE;
+  }
+  auto output_dir = caf::get_or(caf_cfg, "output-dir", string{"."});
+  auto max_size = caf::get_or(caf_cfg, "max-dict-size", size_t{32768});
+  auto min_samples = caf::get_or(caf_cfg, "min-samples", size_t{16});
+  if (!broker::detail::is_directory(output_dir)
+      && !broker::detail::mkdirs(output_dir)) {
+    err_println("unable to create output directory: ", output_dir);
+    return EXIT_FAILURE;
+  }
+  std::map<string, sample_list> samples;
+  for (const auto& input : inputs)
+    if (!collect_samples(input, samples))
+      return EXIT_FAILURE;
+  // The "default" dictionary covers every prefix, serving as the fallback
+  // for stores and topics without a dedicated dictionary.
+  auto& fallback = samples["default"];
+  for (const auto& [name, list] : samples)
+    if (name != "default")
+      fallback.insert(fallback.end(), list.begin(), list.end());
+  auto emitted = 0;
+  for (const auto& [name, list] : samples) {
+    if (list.size() < min_samples)
+      continue;
+    if (!train_and_emit(name, list, output_dir, max_size))
+      return EXIT_FAILURE;
+    ++emitted;
+  }
+  if (emitted == 0) {
+    err_println("no topic prefix reached ", min_samples,
+                " samples; nothing emitted");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -208,10 +208,11 @@ void extend_config(broker::configuration& broker_cfg) {
   auto& cfg = broker::internal::configuration_access(&broker_cfg).cfg();
   caf::config_option_adder{cfg.custom_options(), "global"}
     .add<bool>("verbose,v", "print status and debug output")
-    .add<bool>("rate,r", "print receive rate ('relay' mode only)")
+    .add<bool>("rate,r", "print receive rate ('relay' and 'route' modes only)")
     .add<string>("name,N", "set node name in verbose output")
     .add<string_list>("topics,t", "topics for sending/receiving messages")
-    .add<std::string>("mode,m", "'relay', 'generate', 'ping', or 'pong'")
+    .add<std::string>("mode,m",
+                      "'relay', 'route', 'generate', 'ping', or 'pong'")
     .add<string>("generator-file,g",
                  "path to a generator file ('generate' mode only)")
     .add<size_t>("payload-size,s",
@@ -226,6 +227,17 @@ void extend_config(broker::configuration& broker_cfg) {
                    "<tcp://$host:$port> notation")
     .add<uint16_t>("local-port,l",
                    "local port for publishing this endpoint at");
+  // Options for running as a routing/relay daemon ('route' mode). All of
+  // them are meant to live in a config file passed via --config-file, so a
+  // deployed relay carries its peerings and rules as configuration rather
+  // than custom code.
+  caf::config_option_adder{cfg.custom_options(), "route"}
+    .add<string_list>("rules",
+                      "transform rules in '<src-prefix>-><dst-prefix>' "
+                      "notation; matching messages get republished with the "
+                      "prefix rewritten")
+    .add<string_list>("drop",
+                      "topic prefixes to drop instead of forwarding");
 }
 
 // -- convenience get_or and get_if overloads for enpoint ----------------------
@@ -337,6 +349,103 @@ void relay_mode(broker::endpoint& ep, topic_list topics) {
   }
 }
 
+struct route_rule {
+  topic src;
+  topic dst;
+};
+
+bool parse_route_rule(const string& str, route_rule& rule) {
+  auto pos = str.find("->");
+  if (pos == 0 || pos == string::npos || pos + 2 >= str.size())
+    return false;
+  rule.src = topic{str.substr(0, pos)};
+  rule.dst = topic{str.substr(pos + 2)};
+  return true;
+}
+
+void route_mode(broker::endpoint& ep, topic_list topics) {
+  // Read the per-topic rules from the configuration. Without any rules, this
+  // mode degenerates to plain relaying, since `main` already called
+  // `ep.forward(topics)` for transparent peer-to-peer forwarding.
+  std::vector<route_rule> rules;
+  for (auto& str : get_or(ep, "route.rules", string_list{})) {
+    route_rule rule;
+    if (!parse_route_rule(str, rule))
+      return err::println("invalid route rule (expected '<src>-><dst>'): ",
+                          str);
+    rules.emplace_back(std::move(rule));
+  }
+  topic_list drop;
+  for (auto& str : get_or(ep, "route.drop", string_list{}))
+    drop.emplace_back(str);
+  if (rules.empty() && drop.empty())
+    return relay_mode(ep, std::move(topics));
+  // Reject rule sets that would republish into a subscribed prefix, because
+  // that makes the relay feed its own input.
+  for (auto& rule : rules)
+    for (auto& other : rules)
+      if (other.src.prefix_of(rule.dst))
+        return err::println("route rule destination ", rule.dst.string(),
+                            " overlaps with source prefix ",
+                            other.src.string());
+  verbose::println("route messages with ", rules.size(), " rules and ",
+                   drop.size(), " drop prefixes");
+  // Transforming and dropping require an explicit subscription to the
+  // affected prefixes; everything else flows through the forwarding paths.
+  topic_list subscriptions;
+  for (auto& rule : rules)
+    subscriptions.emplace_back(rule.src);
+  subscriptions.insert(subscriptions.end(), drop.begin(), drop.end());
+  auto in = ep.make_subscriber(std::move(subscriptions));
+  size_t transformed = 0;
+  size_t dropped = 0;
+  auto handle_message = [&](const broker::data_message& x) {
+    auto& val = get_data(x);
+    if (is_stop_msg(val)) {
+      verbose::println("received stop");
+      return false;
+    }
+    auto& t = get_topic(x);
+    for (auto& prefix : drop)
+      if (prefix.prefix_of(t)) {
+        ++dropped;
+        return true;
+      }
+    for (auto& rule : rules)
+      if (rule.src.prefix_of(t)) {
+        auto suffix = t.string().substr(rule.src.string().size());
+        ep.publish(topic{rule.dst.string() + suffix}, val);
+        ++transformed;
+        return true;
+      }
+    return true;
+  };
+  auto& cfg = broker::internal::endpoint_access{&ep}.cfg();
+  if (get_or(cfg, "verbose", false) && get_or(cfg, "rate", false)) {
+    auto timeout = std::chrono::system_clock::now();
+    timeout += std::chrono::seconds(1);
+    for (;;) {
+      auto x = in.get(timeout);
+      if (x) {
+        if (!handle_message(*x))
+          return;
+      } else {
+        verbose::println(transformed, " transformed/s, ", dropped,
+                         " dropped/s");
+        timeout += std::chrono::seconds(1);
+        transformed = 0;
+        dropped = 0;
+      }
+    }
+  } else {
+    for (;;) {
+      auto x = in.get();
+      if (!handle_message(x))
+        return;
+    }
+  }
+}
+
 void generator(caf::event_based_actor* self, caf::actor core,
                std::shared_ptr<size_t> count, const std::string& file_name,
                broker::internal::generator_file_reader_ptr ptr) {
@@ -557,8 +666,10 @@ int main(int argc, char** argv) {
   }
   // Select function f based on the mode.
   mode_fun f = nullptr;
-  if (*mode == "replay") {
+  if (*mode == "relay" || *mode == "replay") {
     f = relay_mode;
+  } else if (*mode == "route") {
+    f = route_mode;
   } else if (*mode == "ping") {
     f = ping_mode;
   } else if (*mode == "pong") {
@@ -0,0 +1,290 @@
+#include "broker/broker.h"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "broker/data.hh"
+#include "broker/detail/data_codec.hh"
+#include "broker/endpoint.hh"
+#include "broker/error.hh"
+#include "broker/message.hh"
+#include "broker/store.hh"
+#include "broker/subscriber.hh"
+#include "broker/time.hh"
+#include "broker/topic.hh"
+
+// The C API never lets exceptions cross the language boundary: every entry
+// point catches everything and reports failure through its return value.
+// Handles are plain structs wrapping the C++ objects, allocated with `new`
+// and handed out as opaque pointers.
+
+struct broker_endpoint {
+  broker::endpoint ep;
+};
+
+struct broker_subscriber {
+  broker::subscriber sub;
+};
+
+struct broker_store {
+  broker::store st;
+};
+
+struct broker_message {
+  explicit broker_message(broker::data_message msg) : msg(std::move(msg)) {
+    payload = broker::detail::encode(broker::get_data(this->msg));
+  }
+
+  broker::data_message msg;
+  std::vector<std::byte> payload;
+};
+
+struct broker_blob {
+  std::vector<std::byte> bytes;
+};
+
+namespace {
+
+constexpr int c_success = 0;
+
+int to_c_error(const broker::error& err) {
+  auto code = err.code();
+  return code != 0 ? static_cast<int>(code)
+                   : static_cast<int>(broker::ec::unspecified);
+}
+
+int c_error(broker::ec code) {
+  return static_cast<int>(code);
+}
+
+} // namespace
+
+extern "C" {
+
+// -- endpoint -----------------------------------------------------------------
+
+broker_endpoint* broker_endpoint_new(void) {
+  try {
+    return new broker_endpoint;
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void broker_endpoint_destroy(broker_endpoint* ep) {
+  delete ep;
+}
+
+uint16_t broker_endpoint_listen(broker_endpoint* ep, const char* address,
+                                uint16_t port) {
+  try {
+    return ep->ep.listen(address != nullptr ? address : "", port);
+  } catch (...) {
+    return 0;
+  }
+}
+
+int broker_endpoint_peer(broker_endpoint* ep, const char* address,
+                         uint16_t port, double retry_interval_secs) {
+  try {
+    auto retry = broker::timeout::seconds{
+      static_cast<broker::timeout::seconds::rep>(retry_interval_secs)};
+    if (ep->ep.peer(address, port, retry))
+      return c_success;
+    return c_error(broker::ec::peer_unavailable);
+  } catch (...) {
+    return c_error(broker::ec::unspecified);
+  }
+}
+
+int broker_endpoint_publish(broker_endpoint* ep, const char* topic,
+                            size_t topic_size, const uint8_t* payload,
+                            size_t payload_size) {
+  try {
+    auto value
+      = broker::detail::decode(reinterpret_cast<const std::byte*>(payload),
+                               payload_size);
+    if (!value)
+      return to_c_error(value.error());
+    ep->ep.publish(broker::topic{std::string{topic, topic_size}},
+                   std::move(*value));
+    return c_success;
+  } catch (...) {
+    return c_error(broker::ec::unspecified);
+  }
+}
+
+// -- subscriber ---------------------------------------------------------------
+
+broker_subscriber* broker_endpoint_subscribe(broker_endpoint* ep,
+                                             const char* const* topics,
+                                             const size_t* topic_sizes,
+                                             size_t num_topics,
+                                             size_t max_qsize) {
+  try {
+    std::vector<broker::topic> ts;
+    ts.reserve(num_topics);
+    for (size_t i = 0; i < num_topics; ++i)
+      ts.emplace_back(std::string{topics[i], topic_sizes[i]});
+    return new broker_subscriber{ep->ep.make_subscriber(std::move(ts),
+                                                        max_qsize)};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void broker_subscriber_destroy(broker_subscriber* sub) {
+  delete sub;
+}
+
+int broker_subscriber_fd(const broker_subscriber* sub) {
+  return sub->sub.fd();
+}
+
+size_t broker_subscriber_available(const broker_subscriber* sub) {
+  return sub->sub.available();
+}
+
+broker_message* broker_subscriber_get(broker_subscriber* sub) {
+  try {
+    return new broker_message{sub->sub.get()};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+broker_message* broker_subscriber_get_timeout(broker_subscriber* sub,
+                                              double timeout_secs) {
+  try {
+    auto msg = sub->sub.get(broker::to_duration(timeout_secs));
+    if (!msg)
+      return nullptr;
+    return new broker_message{std::move(*msg)};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+// -- message ------------------------------------------------------------------
+
+const char* broker_message_topic(const broker_message* msg, size_t* size) {
+  const auto& str = broker::get_topic(msg->msg).string();
+  *size = str.size();
+  return str.data();
+}
+
+const uint8_t* broker_message_payload(const broker_message* msg,
+                                      size_t* size) {
+  *size = msg->payload.size();
+  return reinterpret_cast<const uint8_t*>(msg->payload.data());
+}
+
+void broker_message_destroy(broker_message* msg) {
+  delete msg;
+}
+
+// -- store --------------------------------------------------------------------
+
+broker_store* broker_endpoint_attach_master(broker_endpoint* ep,
+                                            const char* name, int backend) {
+  try {
+    if (backend < BROKER_C_BACKEND_MEMORY
+        || backend > BROKER_C_BACKEND_ROCKSDB)
+      return nullptr;
+    auto res = ep->ep.attach_master(name,
+                                    static_cast<broker::backend>(backend));
+    if (!res)
+      return nullptr;
+    return new broker_store{std::move(*res)};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+broker_store* broker_endpoint_attach_clone(broker_endpoint* ep,
+                                           const char* name) {
+  try {
+    auto res = ep->ep.attach_clone(name);
+    if (!res)
+      return nullptr;
+    return new broker_store{std::move(*res)};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void broker_store_destroy(broker_store* st) {
+  delete st;
+}
+
+int broker_store_put(broker_store* st, const uint8_t* key, size_t key_size,
+                     const uint8_t* value, size_t value_size,
+                     double expiry_secs) {
+  try {
+    auto k = broker::detail::decode(reinterpret_cast<const std::byte*>(key),
+                                    key_size);
+    if (!k)
+      return to_c_error(k.error());
+    auto v = broker::detail::decode(reinterpret_cast<const std::byte*>(value),
+                                    value_size);
+    if (!v)
+      return to_c_error(v.error());
+    std::optional<broker::timespan> expiry;
+    if (expiry_secs > 0)
+      expiry = broker::to_duration(expiry_secs);
+    st->st.put(std::move(*k), std::move(*v), expiry);
+    return c_success;
+  } catch (...) {
+    return c_error(broker::ec::unspecified);
+  }
+}
+
+int broker_store_erase(broker_store* st, const uint8_t* key,
+                       size_t key_size) {
+  try {
+    auto k = broker::detail::decode(reinterpret_cast<const std::byte*>(key),
+                                    key_size);
+    if (!k)
+      return to_c_error(k.error());
+    st->st.erase(std::move(*k));
+    return c_success;
+  } catch (...) {
+    return c_error(broker::ec::unspecified);
+  }
+}
+
+int broker_store_get(broker_store* st, const uint8_t* key, size_t key_size,
+                     broker_blob** result) {
+  try {
+    auto k = broker::detail::decode(reinterpret_cast<const std::byte*>(key),
+                                    key_size);
+    if (!k)
+      return to_c_error(k.error());
+    auto res = st->st.get(std::move(*k));
+    if (!res)
+      return to_c_error(res.error());
+    *result = new broker_blob{broker::detail::encode(*res)};
+    return c_success;
+  } catch (...) {
+    return c_error(broker::ec::unspecified);
+  }
+}
+
+// -- blob ---------------------------------------------------------------------
+
+const uint8_t* broker_blob_data(const broker_blob* blob, size_t* size) {
+  *size = blob->bytes.size();
+  return reinterpret_cast<const uint8_t*>(blob->bytes.data());
+}
+
+void broker_blob_destroy(broker_blob* blob) {
+  delete blob;
+}
+
+} // extern "C"
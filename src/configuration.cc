@@ -104,11 +104,40 @@ struct configuration::impl : public caf::actor_system_config {
       .add(options.ttl, "ttl", "drop messages after traversing TTL hops")
       .add<string>("recording-directory",
                    "path for storing recorded meta information")
+      .add<string>("store-recording-directory",
+                   "path for recording store commands on masters")
       .add<size_t>(
         "output-generator-file-cap",
         "maximum number of entries when recording published messages")
+      .add<size_t>("flight-recorder-size",
+                   "number of recent messages buffered for on-demand dumps")
       .add<size_t>("max-pending-inputs-per-source",
-                   "maximum number of items we buffer per peer or publisher");
+                   "maximum number of items we buffer per peer or publisher")
+      .add<size_t>("max-pending-connects",
+                   "maximum number of peering connection attempts in flight")
+      .add<bool>("detach-stores",
+                 "run data store actors on dedicated threads")
+      .add<bool>("multipath-dedup",
+                 "drop duplicate messages arriving over redundant peerings")
+      .add<size_t>("memory-budget",
+                   "maximum bytes of buffered data before shedding "
+                   "(0 = unlimited)")
+      .add<string>("checkpoint-directory",
+                   "path for saving endpoint state on shutdown and restoring "
+                   "it on startup")
+      .add<string>("profile",
+                   "named tuning profile: 'low-latency', 'high-throughput' "
+                   "or 'constrained'");
+    opt_group{custom_options_, "broker.dns"}
+      .add<caf::timespan>("ttl", "lifetime of cached hostname lookups")
+      .add<caf::timespan>(
+        "negative-ttl", "lifetime of cached hostname lookup failures");
+    opt_group{custom_options_, "broker.dispatcher"}
+      .add<size_t>("stage-capacity",
+                   "maximum number of messages batched before a flush")
+      .add<caf::timespan>(
+        "flush-interval",
+        "maximum time staged messages may linger before a forced flush");
     opt_group{custom_options_, "broker.metrics"}
       .add<uint16_t>("port", "port for incoming Prometheus (HTTP) requests")
       .add<string>("address", "bind address for the HTTP server socket")
@@ -160,6 +189,8 @@ struct configuration::impl : public caf::actor_system_config {
 
   void init(int argc, char** argv);
 
+  void apply_profile(const std::string& name);
+
   broker_options options;
 };
 
@@ -174,6 +205,19 @@ configuration::configuration(broker_options opts) : configuration(skip_init) {
   impl_->options = opts;
   impl_->set("broker.ttl", opts.ttl);
   caf::put(impl_->content, "broker.forward", opts.forward);
+  caf::put(impl_->content, "broker.detach-stores", opts.detach_stores);
+  if (opts.max_threads > 0)
+    impl_->set("caf.scheduler.max-threads", opts.max_threads);
+  switch (opts.scheduler) {
+    default:
+      break;
+    case scheduler_policy::sharing:
+      impl_->set("caf.scheduler.policy", std::string{"sharing"});
+      break;
+    case scheduler_policy::stealing:
+      impl_->set("caf.scheduler.policy", std::string{"stealing"});
+      break;
+  }
   init(0, nullptr);
   impl_->config_file_path = "broker.conf";
 }
@@ -195,6 +239,44 @@ configuration::~configuration() {
   // nop, but must stay out-of-line because impl is incomplete in the header.
 }
 
+void configuration::impl::apply_profile(const std::string& name) {
+  using std::chrono::microseconds;
+  using std::chrono::milliseconds;
+  if (name == "low-latency") {
+    // Small batches with an aggressive flush deadline and dedicated store
+    // threads keep messages off queues as much as possible.
+    put(content, "broker.dispatcher.stage-capacity", size_t{32});
+    put(content, "broker.dispatcher.flush-interval",
+        caf::timespan{microseconds(100)});
+    put(content, "broker.store.coalesce-interval", caf::timespan{0});
+    put(content, "broker.detach-stores", true);
+  } else if (name == "high-throughput") {
+    // Big batches, a relaxed flush deadline, generous input buffers and
+    // coalesced store updates maximize messages per syscall and per wakeup.
+    put(content, "broker.dispatcher.stage-capacity", size_t{2048});
+    put(content, "broker.dispatcher.flush-interval",
+        caf::timespan{milliseconds(5)});
+    put(content, "broker.store.coalesce-interval",
+        caf::timespan{milliseconds(50)});
+    put(content, "broker.max-pending-inputs-per-source", size_t{2048});
+  } else if (name == "constrained") {
+    // Tight queue and buffer budgets plus a small thread pool bound the
+    // memory footprint on small boxes.
+    put(content, "broker.dispatcher.stage-capacity", size_t{64});
+    put(content, "broker.dispatcher.flush-interval",
+        caf::timespan{milliseconds(2)});
+    put(content, "broker.max-pending-inputs-per-source", size_t{64});
+    put(content, "broker.max-pending-connects", size_t{4});
+    put(content, "caf.scheduler.max-threads", size_t{2});
+  } else {
+    auto what = concat("unknown tuning profile: '", name,
+                       "' (legal values: 'low-latency', 'high-throughput', "
+                       "'constrained')");
+    throw std::invalid_argument(what);
+  }
+  put(content, "broker.profile", name);
+}
+
 void configuration::impl::init(int argc, char** argv) {
   std::vector<std::string> args;
   if (argc > 1 && argv != nullptr)
@@ -203,6 +285,20 @@ void configuration::impl::init(int argc, char** argv) {
   load<caf::io::middleman>();
   if (not options.disable_ssl)
     load<caf::openssl::manager>();
+  // Phase 0: seed the tuning profile, if any. Profiles apply before reading
+  //          the config file and CLI arguments, so explicitly configured
+  //          values always win over profile values.
+  {
+    auto profile = options.profile;
+    if (auto env = getenv("BROKER_PROFILE"))
+      profile = env;
+    for (const auto& arg : args)
+      for (auto prefix : {"--profile=", "--broker.profile="})
+        if (arg.compare(0, strlen(prefix), prefix) == 0)
+          profile = arg.substr(strlen(prefix));
+    if (!profile.empty())
+      apply_profile(profile);
+  }
   // Phase 1: parse broker.conf or configuration file specified by the user on
   //          the command line (overrides hard-coded defaults).
   if (!options.ignore_broker_conf) {
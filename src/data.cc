@@ -1,9 +1,13 @@
 #include "broker/data.hh"
 
+#include <cstring>
+
 #include <caf/hash/fnv.hpp>
 #include <caf/node_id.hpp>
 
 #include "broker/convert.hh"
+#include "broker/detail/hash.hh"
+#include "broker/format.hh"
 #include "broker/expected.hh"
 #include "broker/internal/native.hh"
 #include "broker/internal/type_id.hh"
@@ -185,23 +189,82 @@ const char* data::get_type_name() const {
   return visit(type_name_getter(), *this);
 }
 
+#ifdef BROKER_HAVE_COPY_PROFILING
+
 namespace {
 
-template <class Container>
-void container_convert(Container& c, std::string& str,
-                       const char* left, const char* right,
-                       const char* delim = ", ") {
-  auto first = begin(c);
-  auto last = end(c);
-  str += left;
-  if (first != last) {
-    str += to_string(*first);
-    while (++first != last)
-      str += delim + to_string(*first);
-  }
-  str += right;
+size_t deep_size(const data& x);
+
+// Estimates how many bytes a deep copy of a value duplicates, i.e., the
+// dynamically allocated payload plus the inline footprint of nested elements.
+struct deep_size_getter {
+  using result_type = size_t;
+
+  result_type operator()(const std::string& x) {
+    return x.size();
+  }
+
+  result_type operator()(const enum_value& x) {
+    return x.name.size();
+  }
+
+  result_type operator()(const broker::set& xs) {
+    result_type result = 0;
+    for (auto& x : xs)
+      result += sizeof(data) + deep_size(x);
+    return result;
+  }
+
+  result_type operator()(const table& xs) {
+    result_type result = 0;
+    for (auto& [key, val] : xs)
+      result += 2 * sizeof(data) + deep_size(key) + deep_size(val);
+    return result;
+  }
+
+  result_type operator()(const vector& xs) {
+    result_type result = 0;
+    for (auto& x : xs)
+      result += sizeof(data) + deep_size(x);
+    return result;
+  }
+
+  template <class T>
+  result_type operator()(const T&) {
+    return 0;
+  }
+};
+
+size_t deep_size(const data& x) {
+  return visit(deep_size_getter(), x);
 }
 
+} // namespace
+
+data::data(const data& other) : data_(other.data_) {
+  BROKER_PROFILE_COPY(data, sizeof(data) + deep_size(*this));
+}
+
+data::data(data&& other) noexcept : data_(std::move(other.data_)) {
+  BROKER_PROFILE_MOVE(data);
+}
+
+data& data::operator=(const data& other) {
+  data_ = other.data_;
+  BROKER_PROFILE_COPY(data, sizeof(data) + deep_size(*this));
+  return *this;
+}
+
+data& data::operator=(data&& other) noexcept {
+  data_ = std::move(other.data_);
+  BROKER_PROFILE_MOVE(data);
+  return *this;
+}
+
+#endif // BROKER_HAVE_COPY_PROFILING
+
+namespace {
+
 struct data_converter {
   using result_type = bool;
 
@@ -226,22 +289,24 @@ struct data_converter {
 } // namespace <anonymous>
 
 bool convert(const table::value_type& x, std::string& str) {
-  str += to_string(x.first) + " -> " + to_string(x.second);
+  format_to(str, x.first);
+  str += " -> ";
+  format_to(str, x.second);
   return true;
 }
 
 bool convert(const vector& x, std::string& str) {
-  container_convert(x, str, "(", ")");
+  format_to(str, x);
   return true;
 }
 
 bool convert(const set& x, std::string& str) {
-  container_convert(x, str, "{", "}");
+  format_to(str, x);
   return true;
 }
 
 bool convert(const table& x, std::string& str) {
-  container_convert(x, str, "{", "}");
+  format_to(str, x);
   return true;
 }
 
@@ -302,4 +367,126 @@ size_t fnv_hash(const broker::table& x) {
   return caf::hash::fnv<size_t>::compute(x);
 }
 
+namespace {
+
+/// Recursively digests a data value. Each alternative folds its payload
+/// digest into a seed derived from its type tag, so equal payloads of
+/// different types (e.g., `count{1}` and `integer{1}`) hash apart.
+struct fast_hash_visitor {
+  uint64_t seed_of(data::type tag) const noexcept {
+    return hash_combine64(hash_secret[2], static_cast<uint64_t>(tag));
+  }
+
+  uint64_t operator()(broker::none) const noexcept {
+    return seed_of(data::type::none);
+  }
+
+  uint64_t operator()(broker::boolean x) const noexcept {
+    return hash_combine64(seed_of(data::type::boolean), x ? 1 : 0);
+  }
+
+  uint64_t operator()(broker::count x) const noexcept {
+    return hash_combine64(seed_of(data::type::count), x);
+  }
+
+  uint64_t operator()(broker::integer x) const noexcept {
+    return hash_combine64(seed_of(data::type::integer),
+                          static_cast<uint64_t>(x));
+  }
+
+  uint64_t operator()(broker::real x) const noexcept {
+    uint64_t bits;
+    static_assert(sizeof(bits) == sizeof(x));
+    memcpy(&bits, &x, sizeof(bits));
+    return hash_combine64(seed_of(data::type::real), bits);
+  }
+
+  uint64_t operator()(const std::string& x) const noexcept {
+    return hash_bytes(x.data(), x.size(), seed_of(data::type::string));
+  }
+
+  uint64_t operator()(const broker::address& x) const noexcept {
+    return hash_bytes(x.bytes().data(), x.bytes().size(),
+                      seed_of(data::type::address));
+  }
+
+  uint64_t operator()(const broker::subnet& x) const noexcept {
+    auto& bytes = x.network().bytes();
+    auto h = hash_bytes(bytes.data(), bytes.size(),
+                        seed_of(data::type::subnet));
+    return hash_combine64(h, x.length());
+  }
+
+  uint64_t operator()(const broker::port& x) const noexcept {
+    auto bits = uint64_t{x.number()} | (static_cast<uint64_t>(x.type()) << 16);
+    return hash_combine64(seed_of(data::type::port), bits);
+  }
+
+  uint64_t operator()(broker::timestamp x) const noexcept {
+    return hash_combine64(seed_of(data::type::timestamp),
+                          static_cast<uint64_t>(
+                            x.time_since_epoch().count()));
+  }
+
+  uint64_t operator()(broker::timespan x) const noexcept {
+    return hash_combine64(seed_of(data::type::timespan),
+                          static_cast<uint64_t>(x.count()));
+  }
+
+  uint64_t operator()(const broker::enum_value& x) const noexcept {
+    return hash_bytes(x.name.data(), x.name.size(),
+                      seed_of(data::type::enum_value));
+  }
+
+  uint64_t operator()(const broker::set& xs) const noexcept {
+    return fold(seed_of(data::type::set), xs);
+  }
+
+  uint64_t operator()(const broker::table& xs) const noexcept {
+    auto seed = seed_of(data::type::table);
+    for (auto& [key, val] : xs)
+      seed = hash_combine64(hash_combine64(seed, (*this)(key)), (*this)(val));
+    return hash_combine64(seed, xs.size());
+  }
+
+  uint64_t operator()(const broker::vector& xs) const noexcept {
+    return fold(seed_of(data::type::vector), xs);
+  }
+
+  uint64_t operator()(const broker::data& x) const noexcept {
+    return visit(*this, x);
+  }
+
+  template <class Container>
+  uint64_t fold(uint64_t seed, const Container& xs) const noexcept {
+    for (auto& x : xs)
+      seed = hash_combine64(seed, (*this)(x));
+    return hash_combine64(seed, xs.size());
+  }
+};
+
+} // namespace
+
+size_t fast_hash(const broker::data& x) {
+  return static_cast<size_t>(fast_hash_visitor{}(x));
+}
+
+size_t fast_hash(const broker::set& x) {
+  return static_cast<size_t>(fast_hash_visitor{}(x));
+}
+
+size_t fast_hash(const broker::vector& x) {
+  return static_cast<size_t>(fast_hash_visitor{}(x));
+}
+
+size_t fast_hash(const broker::table::value_type& x) {
+  fast_hash_visitor f;
+  return static_cast<size_t>(
+    hash_combine64(f(x.first), f(x.second)));
+}
+
+size_t fast_hash(const broker::table& x) {
+  return static_cast<size_t>(fast_hash_visitor{}(x));
+}
+
 } // namespace broker::detail
@@ -1,3 +1,5 @@
+#include <iterator>
+
 #include "broker/detail/appliers.hh"
 #include "broker/detail/abstract_backend.hh"
 
@@ -12,7 +14,7 @@ expected<void> abstract_backend::add(const data& key, const data& value,
       return v.error();
     v = expected<data>{data::from_type(init_type)};
   }
-  if (auto result = visit(adder{value}, *v))
+  if (auto result = apply(adder{value}, *v))
     return put(key, *v, expiry);
   else
     return result;
@@ -23,7 +25,7 @@ expected<void> abstract_backend::subtract(const data& key, const data& value,
   auto v = get(key);
   if (!v)
     return v.error();
-  if (auto result = visit(remover{value}, *v))
+  if (auto result = apply(remover{value}, *v))
     return put(key, *v, expiry);
   else
     return result;
@@ -32,9 +34,60 @@ expected<void> abstract_backend::subtract(const data& key, const data& value,
 expected<data> abstract_backend::get(const data& key, const data& value) const {
 
   if (auto k = get(key))
-    return visit(retriever{value}, *k);
+    return apply(retriever{value}, *k);
   else
     return k;
 }
 
+expected<data> abstract_backend::keys_in_range(const data& from, const data& to,
+                                               uint64_t limit) const {
+  auto ks = keys();
+  if (!ks)
+    return ks;
+  set result;
+  auto add = [&](const data& key) {
+    if (!(key < from) && (is<none>(to) || key < to))
+      result.insert(key);
+  };
+  if (auto xs = get_if<set>(*ks)) {
+    for (auto& key : *xs)
+      add(key);
+  } else if (auto xs = get_if<vector>(*ks)) {
+    for (auto& key : *xs)
+      add(key);
+  }
+  if (limit > 0)
+    while (result.size() > limit)
+      result.erase(std::prev(result.end()));
+  return {data{std::move(result)}};
+}
+
+expected<void>
+abstract_backend::bulk_insert(std::vector<std::pair<data, data>> entries) {
+  for (auto& [key, value] : entries)
+    if (auto res = put(key, std::move(value), std::nullopt); !res)
+      return res;
+  return {};
+}
+
+expected<void> abstract_backend::compact() {
+  return {};
+}
+
+expected<uint64_t> abstract_backend::snapshot_fork() {
+  return ec::unspecified;
+}
+
+expected<broker::snapshot> abstract_backend::snapshot_chunk(uint64_t) {
+  return ec::unspecified;
+}
+
+void abstract_backend::snapshot_release() {
+  // nop
+}
+
+expected<data> abstract_backend::stats() const {
+  return ec::unspecified;
+}
+
 } // namespace broker::detail
@@ -0,0 +1,221 @@
+#include "broker/detail/address_format.hh"
+
+#include <cstring>
+
+#include "broker/config.hh"
+
+#ifdef BROKER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace broker {
+namespace detail {
+
+namespace {
+
+// All two-digit decimal numbers as consecutive character pairs. Emitting two
+// digits as a single 2-byte copy halves the stores for the common octets.
+constexpr char digit_pairs[]
+  = "00010203040506070809101112131415161718192021222324252627282930313233343"
+    "53637383940414243444546474849505152535455565758596061626364656667686970"
+    "71727374757677787980818283848586878889909192939495969798" "99";
+
+char* put_u8(uint8_t value, char* out) noexcept {
+  if (value >= 100) {
+    *out++ = static_cast<char>('0' + value / 100);
+    memcpy(out, digit_pairs + (value % 100) * 2, 2);
+    return out + 2;
+  }
+  if (value >= 10) {
+    memcpy(out, digit_pairs + value * 2, 2);
+    return out + 2;
+  }
+  *out++ = static_cast<char>('0' + value);
+  return out;
+}
+
+constexpr char hex_digits[] = "0123456789abcdef";
+
+// Emits one 16-bit group in lowercase hex without leading zeros.
+char* put_group(uint16_t group, char* out) noexcept {
+  int shift = 12;
+  while (shift > 0 && ((group >> shift) & 0xf) == 0)
+    shift -= 4;
+  for (; shift >= 0; shift -= 4)
+    *out++ = hex_digits[(group >> shift) & 0xf];
+  return out;
+}
+
+int hex_value(char c) noexcept {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// Parses a run of single-colon-separated 16-bit hex groups into `out`. The
+// last token may be a dotted quad, which then occupies two groups. Returns
+// the number of groups written or -1 on a malformed input. The caller deals
+// with `::`, so empty tokens are errors here.
+int parse_groups(std::string_view str, uint16_t* out, int max_groups,
+                 bool allow_v4_tail) noexcept {
+  if (str.empty())
+    return 0;
+  int num_groups = 0;
+  for (;;) {
+    auto pos = str.find(':');
+    auto token = str.substr(0, pos);
+    if (token.empty() || num_groups == max_groups)
+      return -1;
+    if (token.find('.') != std::string_view::npos) {
+      // A dotted-quad tail is only legal as the very last token.
+      uint8_t quad[4];
+      if (!allow_v4_tail || pos != std::string_view::npos
+          || num_groups > max_groups - 2 || !parse_ipv4(token, quad))
+        return -1;
+      out[num_groups++] = static_cast<uint16_t>(quad[0] << 8 | quad[1]);
+      out[num_groups++] = static_cast<uint16_t>(quad[2] << 8 | quad[3]);
+      return num_groups;
+    }
+    if (token.size() > 4)
+      return -1;
+    uint16_t group = 0;
+    for (auto c : token) {
+      auto val = hex_value(c);
+      if (val < 0)
+        return -1;
+      group = static_cast<uint16_t>(group << 4 | val);
+    }
+    out[num_groups++] = group;
+    if (pos == std::string_view::npos)
+      return num_groups;
+    str.remove_prefix(pos + 1);
+  }
+}
+
+} // namespace
+
+size_t format_ipv4(const uint8_t* bytes, char* out) noexcept {
+  auto pos = put_u8(bytes[0], out);
+  for (int i = 1; i < 4; ++i) {
+    *pos++ = '.';
+    pos = put_u8(bytes[i], pos);
+  }
+  return static_cast<size_t>(pos - out);
+}
+
+size_t format_ipv6(const uint8_t* bytes, char* out) noexcept {
+  uint16_t groups[8];
+  for (int i = 0; i < 8; ++i)
+    groups[i] = static_cast<uint16_t>(bytes[i * 2] << 8 | bytes[i * 2 + 1]);
+  // Find the longest run of zero groups; RFC 5952 only compresses runs of
+  // two or more and picks the leftmost on a tie.
+  int best_start = -1;
+  int best_len = 1;
+  for (int i = 0; i < 8;) {
+    if (groups[i] != 0) {
+      ++i;
+      continue;
+    }
+    auto j = i;
+    while (j < 8 && groups[j] == 0)
+      ++j;
+    if (j - i > best_len) {
+      best_start = i;
+      best_len = j - i;
+    }
+    i = j;
+  }
+  auto pos = out;
+  for (int i = 0; i < 8;) {
+    if (i == best_start) {
+      *pos++ = ':';
+      if (i + best_len == 8)
+        *pos++ = ':';
+      i += best_len;
+      continue;
+    }
+    if (i > 0)
+      *pos++ = ':';
+    pos = put_group(groups[i], pos);
+    ++i;
+  }
+  return static_cast<size_t>(pos - out);
+}
+
+bool parse_ipv4(std::string_view str, uint8_t* bytes) noexcept {
+  if (str.size() < 7 || str.size() > max_ipv4_chars)
+    return false;
+#ifdef BROKER_USE_SSE2
+  // One 16-byte compare classifies the entire input: every character must be
+  // a decimal digit or a dot, and a dotted quad has exactly three dots. This
+  // rejects hostnames and IPv6 literals before the digit loop even starts.
+  char buf[16];
+  memset(buf, '0', sizeof(buf));
+  memcpy(buf, str.data(), str.size());
+  auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+  auto not_digit
+    = _mm_or_si128(_mm_cmplt_epi8(chunk, _mm_set1_epi8('0')),
+                   _mm_cmpgt_epi8(chunk, _mm_set1_epi8('9')));
+  auto dot = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('.'));
+  if (_mm_movemask_epi8(_mm_andnot_si128(dot, not_digit)) != 0
+      || __builtin_popcount(_mm_movemask_epi8(dot)) != 3)
+    return false;
+#endif
+  uint32_t octet = 0;
+  int num_digits = 0;
+  int num_octets = 0;
+  for (auto c : str) {
+    if (c >= '0' && c <= '9') {
+      // More than one digit with a zero accumulator means a leading zero.
+      if (++num_digits > 3 || (num_digits > 1 && octet == 0))
+        return false;
+      octet = octet * 10 + static_cast<uint32_t>(c - '0');
+      if (octet > 255)
+        return false;
+    } else if (c == '.') {
+      if (num_digits == 0 || num_octets == 3)
+        return false;
+      bytes[num_octets++] = static_cast<uint8_t>(octet);
+      octet = 0;
+      num_digits = 0;
+    } else {
+      return false;
+    }
+  }
+  if (num_digits == 0 || num_octets != 3)
+    return false;
+  bytes[3] = static_cast<uint8_t>(octet);
+  return true;
+}
+
+bool parse_ipv6(std::string_view str, uint8_t* bytes) noexcept {
+  uint16_t groups[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  auto pos = str.find("::");
+  if (pos == std::string_view::npos) {
+    if (parse_groups(str, groups, 8, true) != 8)
+      return false;
+  } else {
+    if (str.find(':', pos + 2) == pos + 2) // catches ":::" and "1::::2"
+      return false;
+    uint16_t head[8];
+    uint16_t tail[8];
+    auto num_head = parse_groups(str.substr(0, pos), head, 7, false);
+    auto num_tail = parse_groups(str.substr(pos + 2), tail, 7, true);
+    if (num_head < 0 || num_tail < 0 || num_head + num_tail > 7)
+      return false;
+    memcpy(groups, head, static_cast<size_t>(num_head) * 2);
+    memcpy(groups + 8 - num_tail, tail, static_cast<size_t>(num_tail) * 2);
+  }
+  for (int i = 0; i < 8; ++i) {
+    bytes[i * 2] = static_cast<uint8_t>(groups[i] >> 8);
+    bytes[i * 2 + 1] = static_cast<uint8_t>(groups[i] & 0xff);
+  }
+  return true;
+}
+
+} // namespace detail
+} // namespace broker
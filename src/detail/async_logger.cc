@@ -0,0 +1,162 @@
+#include "broker/detail/async_logger.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "broker/detail/time_format.hh"
+
+namespace broker::detail {
+
+namespace {
+
+const char* level_name(int level) {
+  if (level <= async_logger::level_error)
+    return "ERROR";
+  if (level <= async_logger::level_warning)
+    return "WARN ";
+  if (level <= async_logger::level_info)
+    return "INFO ";
+  if (level <= async_logger::level_debug)
+    return "DEBUG";
+  return "TRACE";
+}
+
+void flush_at_exit() {
+  async_logger::instance().shutdown();
+}
+
+} // namespace
+
+async_logger& async_logger::instance() {
+  // Leaked on purpose: thread-local rings may retire during static
+  // destruction, after a function-local static would already be gone.
+  static auto* inst = new async_logger;
+  return *inst;
+}
+
+void async_logger::configure(int level, const std::string& path) {
+  std::unique_lock guard{mtx_};
+  if (!running_.load(std::memory_order_relaxed)) {
+    if (path.empty()) {
+      sink_ = stderr;
+      owns_sink_ = false;
+    } else if (auto f = std::fopen(path.c_str(), "a")) {
+      sink_ = f;
+      owns_sink_ = true;
+    } else {
+      sink_ = stderr;
+      owns_sink_ = false;
+    }
+    running_.store(true, std::memory_order_relaxed);
+    drainer_ = std::thread{[this] { drain_loop(); }};
+    std::atexit(flush_at_exit);
+  }
+  level_.store(level, std::memory_order_relaxed);
+}
+
+bool async_logger::append(int level, std::string_view msg) {
+  auto rg = local_ring();
+  auto head = rg->head.load(std::memory_order_relaxed);
+  auto tail = rg->tail.load(std::memory_order_acquire);
+  if (head - tail == ring_capacity) {
+    rg->dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  auto& e = rg->entries[head % ring_capacity];
+  e.stamp = broker::now();
+  e.level = level;
+  auto n = std::min(msg.size(), max_message_size);
+  memcpy(e.text, msg.data(), n);
+  e.size = static_cast<uint16_t>(n);
+  rg->head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+uint64_t async_logger::dropped() const noexcept {
+  std::unique_lock guard{mtx_};
+  auto result = retired_dropped_;
+  for (auto& rg : rings_)
+    result += rg->dropped.load(std::memory_order_relaxed);
+  return result;
+}
+
+void async_logger::drain() {
+  std::unique_lock guard{mtx_};
+  if (sink_ == nullptr)
+    return;
+  for (auto& rg : rings_)
+    drain_ring(*rg, sink_);
+  auto drained = [](const std::unique_ptr<ring>& rg) {
+    return rg->retired.load(std::memory_order_acquire)
+           && rg->head.load(std::memory_order_acquire)
+                == rg->tail.load(std::memory_order_relaxed);
+  };
+  for (auto& rg : rings_)
+    if (drained(rg))
+      retired_dropped_ += rg->dropped.load(std::memory_order_relaxed);
+  rings_.erase(std::remove_if(rings_.begin(), rings_.end(), drained),
+               rings_.end());
+  std::fflush(sink_);
+}
+
+void async_logger::shutdown() {
+  if (!running_.exchange(false, std::memory_order_relaxed))
+    return;
+  drainer_.join();
+  drain();
+  std::unique_lock guard{mtx_};
+  level_.store(level_quiet, std::memory_order_relaxed);
+  if (owns_sink_)
+    std::fclose(sink_);
+  sink_ = nullptr;
+  owns_sink_ = false;
+}
+
+async_logger::~async_logger() {
+  shutdown();
+}
+
+async_logger::ring* async_logger::local_ring() {
+  // Retiring instead of unregistering keeps buffered entries of short-lived
+  // threads alive until the drain thread has written them.
+  struct holder {
+    ring* ptr = nullptr;
+    ~holder() {
+      if (ptr)
+        ptr->retired.store(true, std::memory_order_release);
+    }
+  };
+  thread_local holder tls;
+  if (tls.ptr == nullptr) {
+    auto rg = std::make_unique<ring>();
+    tls.ptr = rg.get();
+    std::unique_lock guard{mtx_};
+    rings_.push_back(std::move(rg));
+  }
+  return tls.ptr;
+}
+
+void async_logger::drain_loop() {
+  while (running_.load(std::memory_order_relaxed)) {
+    drain();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void async_logger::drain_ring(ring& rg, FILE* sink) {
+  auto head = rg.head.load(std::memory_order_acquire);
+  auto tail = rg.tail.load(std::memory_order_relaxed);
+  while (tail != head) {
+    auto& e = rg.entries[tail % ring_capacity];
+    char stamp[max_iso8601_chars];
+    auto n = format_iso8601(e.stamp, stamp);
+    std::fprintf(sink, "%.*s %s %.*s\n", static_cast<int>(n), stamp,
+                 level_name(e.level), static_cast<int>(e.size), e.text);
+    ++tail;
+  }
+  rg.tail.store(tail, std::memory_order_release);
+}
+
+} // namespace broker::detail
@@ -0,0 +1,128 @@
+#include "broker/detail/clone_cache.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "broker/detail/data_codec.hh"
+#include "broker/error.hh"
+
+namespace broker::detail {
+
+namespace {
+
+constexpr char magic[] = {'B', 'R', 'K', 'C'};
+
+constexpr char version = 1;
+
+expected<void> write_blob(std::ofstream& out, const data& x,
+                          std::vector<std::byte>& buf,
+                          std::vector<std::byte>& scratch) {
+  buf.clear();
+  scratch.clear();
+  encode(x, scratch);
+  encode_varint(scratch.size(), buf);
+  buf.insert(buf.end(), scratch.begin(), scratch.end());
+  out.write(reinterpret_cast<const char*>(buf.data()),
+            static_cast<std::streamsize>(buf.size()));
+  if (!out)
+    return ec::backend_failure;
+  return {};
+}
+
+bool read_varint(std::ifstream& in, uint64_t& x) {
+  x = 0;
+  int shift = 0;
+  for (;;) {
+    auto c = in.get();
+    if (!in || shift > 63)
+      return false;
+    x |= static_cast<uint64_t>(c & 0x7f) << shift;
+    if ((c & 0x80) == 0)
+      return true;
+    shift += 7;
+  }
+}
+
+expected<data> read_blob(std::ifstream& in, std::vector<std::byte>& buf) {
+  uint64_t size = 0;
+  if (!read_varint(in, size))
+    return {ec::invalid_data};
+  buf.resize(size);
+  in.read(reinterpret_cast<char*>(buf.data()),
+          static_cast<std::streamsize>(size));
+  if (!in)
+    return {ec::invalid_data};
+  return decode(buf);
+}
+
+} // namespace
+
+expected<void> save_clone_cache(const std::string& path,
+                                const std::unordered_map<data, data>& entries,
+                                uint64_t seq) {
+  auto tmp_path = path + ".tmp";
+  {
+    std::ofstream out{tmp_path, std::ios::binary | std::ios::trunc};
+    if (!out)
+      return ec::backend_failure;
+    out.write(magic, sizeof(magic));
+    out.put(version);
+    std::vector<std::byte> header;
+    encode_varint(seq, header);
+    encode_varint(entries.size(), header);
+    out.write(reinterpret_cast<const char*>(header.data()),
+              static_cast<std::streamsize>(header.size()));
+    if (!out)
+      return ec::backend_failure;
+    std::vector<std::byte> buf;
+    std::vector<std::byte> scratch;
+    for (const auto& [key, value] : entries) {
+      if (auto res = write_blob(out, key, buf, scratch); !res)
+        return res;
+      if (auto res = write_blob(out, value, buf, scratch); !res)
+        return res;
+    }
+    out.flush();
+    if (!out)
+      return ec::backend_failure;
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return ec::backend_failure;
+  }
+  return {};
+}
+
+expected<clone_cache_content> load_clone_cache(const std::string& path) {
+  std::ifstream in{path, std::ios::binary};
+  if (!in)
+    return {ec::backend_failure};
+  char header[sizeof(magic) + 1];
+  in.read(header, sizeof(header));
+  if (!in || memcmp(header, magic, sizeof(magic)) != 0
+      || header[sizeof(magic)] != version)
+    return {ec::invalid_data};
+  clone_cache_content result;
+  uint64_t num_entries = 0;
+  if (!read_varint(in, result.seq) || !read_varint(in, num_entries))
+    return {ec::invalid_data};
+  result.entries.reserve(num_entries);
+  std::vector<std::byte> buf;
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    auto key = read_blob(in, buf);
+    if (!key)
+      return {key.error()};
+    auto value = read_blob(in, buf);
+    if (!value)
+      return {value.error()};
+    result.entries.emplace(std::move(*key), std::move(*value));
+  }
+  // Trailing bytes indicate a corrupt or foreign file.
+  if (in.peek() != std::ifstream::traits_type::eof())
+    return {ec::invalid_data};
+  return {std::move(result)};
+}
+
+} // namespace broker::detail
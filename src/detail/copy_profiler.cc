@@ -0,0 +1,106 @@
+#include "broker/detail/copy_profiler.hh"
+
+#ifdef BROKER_HAVE_COPY_PROFILING
+
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <ostream>
+
+namespace broker::detail {
+
+namespace {
+
+constexpr size_t num_slots
+  = static_cast<size_t>(copy_profiler::slot::num_slots);
+
+constexpr const char* slot_names[num_slots] = {
+  "broker::data",
+  "broker::topic",
+};
+
+/// Tally block of a single thread. Writers only touch their own block, but
+/// `snapshot` reads blocks of live threads, hence the relaxed atomics.
+struct tally_block {
+  std::atomic<uint64_t> constructions[num_slots];
+  std::atomic<uint64_t> copies[num_slots];
+  std::atomic<uint64_t> moves[num_slots];
+  std::atomic<uint64_t> copied_bytes[num_slots];
+};
+
+std::mutex blocks_mtx;
+
+// Blocks are never removed: a thread may die before shutdown, but its counts
+// must still appear in the final summary. A list keeps the addresses stable.
+std::list<tally_block>& blocks() {
+  static std::list<tally_block> instance;
+  return instance;
+}
+
+tally_block& this_thread_block() {
+  static thread_local tally_block* instance = [] {
+    std::unique_lock guard{blocks_mtx};
+    return &blocks().emplace_back();
+  }();
+  return *instance;
+}
+
+/// Prints the summary to stderr when the process shuts down.
+struct shutdown_dumper {
+  ~shutdown_dumper() {
+    copy_profiler::dump(std::cerr);
+  }
+};
+
+shutdown_dumper dumper;
+
+} // namespace
+
+void copy_profiler::add_construction(slot x) noexcept {
+  auto& counter = this_thread_block().constructions[static_cast<size_t>(x)];
+  counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+void copy_profiler::add_copy(slot x, size_t bytes) noexcept {
+  auto& blk = this_thread_block();
+  blk.copies[static_cast<size_t>(x)].fetch_add(1, std::memory_order_relaxed);
+  blk.copied_bytes[static_cast<size_t>(x)].fetch_add(
+    bytes, std::memory_order_relaxed);
+}
+
+void copy_profiler::add_move(slot x) noexcept {
+  auto& counter = this_thread_block().moves[static_cast<size_t>(x)];
+  counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<copy_profile> copy_profiler::snapshot() {
+  std::vector<copy_profile> result;
+  result.reserve(num_slots);
+  for (size_t i = 0; i < num_slots; ++i)
+    result.push_back(copy_profile{slot_names[i], 0, 0, 0, 0});
+  std::unique_lock guard{blocks_mtx};
+  for (auto& blk : blocks())
+    for (size_t i = 0; i < num_slots; ++i) {
+      result[i].constructions
+        += blk.constructions[i].load(std::memory_order_relaxed);
+      result[i].copies += blk.copies[i].load(std::memory_order_relaxed);
+      result[i].moves += blk.moves[i].load(std::memory_order_relaxed);
+      result[i].copied_bytes
+        += blk.copied_bytes[i].load(std::memory_order_relaxed);
+    }
+  return result;
+}
+
+void copy_profiler::dump(std::ostream& out) {
+  out << "copy profile:\n";
+  for (auto& x : snapshot())
+    out << "  " << x.name << ": " << x.constructions << " constructions, "
+        << x.copies << " copies (" << x.copied_bytes << " bytes), " << x.moves
+        << " moves\n";
+  out.flush();
+}
+
+} // namespace broker::detail
+
+#endif // BROKER_HAVE_COPY_PROFILING
@@ -0,0 +1,818 @@
+#include "broker/detail/data_codec.hh"
+
+#include <cstring>
+
+#include "broker/data.hh"
+#include "broker/detail/interned_enum.hh"
+#include "broker/detail/sdt.hh"
+#include "broker/detail/string_dictionary.hh"
+#include "broker/error.hh"
+
+namespace broker::detail {
+
+namespace {
+
+// -- primitive writers --------------------------------------------------------
+
+void put_varint(uint64_t x, std::vector<std::byte>& buf) {
+  while (x >= 0x80) {
+    buf.push_back(static_cast<std::byte>((x & 0x7F) | 0x80));
+    x >>= 7;
+  }
+  buf.push_back(static_cast<std::byte>(x));
+}
+
+uint64_t zigzag(int64_t x) {
+  return (static_cast<uint64_t>(x) << 1) ^ static_cast<uint64_t>(x >> 63);
+}
+
+int64_t unzigzag(uint64_t x) {
+  return static_cast<int64_t>(x >> 1) ^ -static_cast<int64_t>(x & 1);
+}
+
+void put_bytes(const void* first, size_t n, std::vector<std::byte>& buf) {
+  auto ptr = static_cast<const std::byte*>(first);
+  buf.insert(buf.end(), ptr, ptr + n);
+}
+
+struct encoder {
+  std::vector<std::byte>& buf;
+
+  /// Connection-level string table; strings and enum names encode as slot
+  /// references when set. See string_dictionary for the sync contract.
+  string_dictionary* dict = nullptr;
+
+  void tag(data::type x) {
+    buf.push_back(static_cast<std::byte>(x));
+  }
+
+  /// Writes a string body in dictionary format: an even varint `2 * size`
+  /// announces a literal, an odd varint `2 * slot + 1` references a table
+  /// entry.
+  void put_dict_string(const std::string& x) {
+    if (auto slot = dict->find(x); slot != string_dictionary::npos) {
+      put_varint((slot << 1) | 1, buf);
+      return;
+    }
+    put_varint(x.size() << 1, buf);
+    put_bytes(x.data(), x.size(), buf);
+    if (string_dictionary::eligible(x.size()))
+      dict->insert(x);
+  }
+
+  void operator()(none) {
+    tag(data::type::none);
+  }
+
+  void operator()(boolean x) {
+    tag(data::type::boolean);
+    buf.push_back(static_cast<std::byte>(x ? 1 : 0));
+  }
+
+  void operator()(count x) {
+    tag(data::type::count);
+    put_varint(x, buf);
+  }
+
+  void operator()(integer x) {
+    tag(data::type::integer);
+    put_varint(zigzag(x), buf);
+  }
+
+  void operator()(real x) {
+    tag(data::type::real);
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    put_bytes(&bits, sizeof(bits), buf);
+  }
+
+  void operator()(const std::string& x) {
+    tag(data::type::string);
+    if (dict != nullptr) {
+      put_dict_string(x);
+      return;
+    }
+    put_varint(x.size(), buf);
+    put_bytes(x.data(), x.size(), buf);
+  }
+
+  void operator()(const address& x) {
+    tag(data::type::address);
+    put_bytes(x.bytes().data(), address::num_bytes, buf);
+  }
+
+  void operator()(const subnet& x) {
+    tag(data::type::subnet);
+    put_bytes(x.network().bytes().data(), address::num_bytes, buf);
+    buf.push_back(static_cast<std::byte>(x.length()));
+  }
+
+  void operator()(const port& x) {
+    tag(data::type::port);
+    put_varint(x.number(), buf);
+    buf.push_back(static_cast<std::byte>(x.type()));
+  }
+
+  void operator()(timestamp x) {
+    tag(data::type::timestamp);
+    put_varint(zigzag(x.time_since_epoch().count()), buf);
+  }
+
+  void operator()(timespan x) {
+    tag(data::type::timespan);
+    put_varint(zigzag(x.count()), buf);
+  }
+
+  void operator()(const enum_value& x) {
+    tag(data::type::enum_value);
+    if (dict != nullptr) {
+      put_dict_string(x.name);
+      return;
+    }
+    put_varint(x.name.size(), buf);
+    put_bytes(x.name.data(), x.name.size(), buf);
+  }
+
+  void operator()(const set& xs) {
+    tag(data::type::set);
+    put_varint(xs.size(), buf);
+    for (auto& x : xs)
+      visit(*this, x);
+  }
+
+  void operator()(const table& xs) {
+    tag(data::type::table);
+    put_varint(xs.size(), buf);
+    for (auto& [key, val] : xs) {
+      visit(*this, key);
+      visit(*this, val);
+    }
+  }
+
+  void operator()(const vector& xs) {
+    tag(data::type::vector);
+    put_varint(xs.size(), buf);
+    for (auto& x : xs)
+      visit(*this, x);
+  }
+};
+
+// -- primitive readers --------------------------------------------------------
+
+struct decoder {
+  const std::byte* pos;
+  const std::byte* end;
+
+  /// Mirror of the sender-side table; must be set iff the sender encoded
+  /// with a dictionary.
+  string_dictionary* dict = nullptr;
+
+  bool get_byte(uint8_t& x) {
+    if (pos == end)
+      return false;
+    x = static_cast<uint8_t>(*pos++);
+    return true;
+  }
+
+  bool get_varint(uint64_t& x) {
+    x = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t b;
+      if (!get_byte(b))
+        return false;
+      x |= static_cast<uint64_t>(b & 0x7F) << shift;
+      if ((b & 0x80) == 0)
+        return true;
+    }
+    return false;
+  }
+
+  bool get_bytes(void* out, size_t n) {
+    if (static_cast<size_t>(end - pos) < n)
+      return false;
+    std::memcpy(out, pos, n);
+    pos += n;
+    return true;
+  }
+
+  bool get_string(std::string& out) {
+    if (dict != nullptr)
+      return get_dict_string(out);
+    uint64_t n;
+    if (!get_varint(n) || static_cast<size_t>(end - pos) < n)
+      return false;
+    out.assign(reinterpret_cast<const char*>(pos), n);
+    pos += n;
+    return true;
+  }
+
+  /// Reads a string body in dictionary format, mirroring the sender-side
+  /// table updates of `encoder::put_dict_string`.
+  bool get_dict_string(std::string& out) {
+    uint64_t k;
+    if (!get_varint(k))
+      return false;
+    if (k & 1) {
+      auto str = dict->lookup(k >> 1);
+      if (str == nullptr)
+        return false;
+      out = *str;
+      return true;
+    }
+    auto n = k >> 1;
+    if (static_cast<size_t>(end - pos) < n)
+      return false;
+    out.assign(reinterpret_cast<const char*>(pos), n);
+    pos += n;
+    if (string_dictionary::eligible(out.size()))
+      dict->insert(out);
+    return true;
+  }
+
+  bool operator()(data& result) {
+    uint8_t tag;
+    if (!get_byte(tag) || tag > static_cast<uint8_t>(data::type::vector))
+      return false;
+    switch (static_cast<data::type>(tag)) {
+      case data::type::none:
+        result = nil;
+        return true;
+      case data::type::boolean: {
+        uint8_t x;
+        if (!get_byte(x))
+          return false;
+        result = x != 0;
+        return true;
+      }
+      case data::type::count: {
+        uint64_t x;
+        if (!get_varint(x))
+          return false;
+        result = count{x};
+        return true;
+      }
+      case data::type::integer: {
+        uint64_t x;
+        if (!get_varint(x))
+          return false;
+        result = integer{unzigzag(x)};
+        return true;
+      }
+      case data::type::real: {
+        uint64_t bits;
+        if (!get_bytes(&bits, sizeof(bits)))
+          return false;
+        real x;
+        std::memcpy(&x, &bits, sizeof(x));
+        result = x;
+        return true;
+      }
+      case data::type::string: {
+        std::string x;
+        if (!get_string(x))
+          return false;
+        result = std::move(x);
+        return true;
+      }
+      case data::type::address: {
+        address x;
+        if (!get_bytes(x.bytes().data(), address::num_bytes))
+          return false;
+        result = x;
+        return true;
+      }
+      case data::type::subnet: {
+        address x;
+        uint8_t len;
+        if (!get_bytes(x.bytes().data(), address::num_bytes) || !get_byte(len))
+          return false;
+        result = subnet{x, len};
+        return true;
+      }
+      case data::type::port: {
+        uint64_t num;
+        uint8_t proto;
+        if (!get_varint(num) || num > 0xFFFF || !get_byte(proto)
+            || proto > static_cast<uint8_t>(port::protocol::icmp))
+          return false;
+        result = port{static_cast<port::number_type>(num),
+                      static_cast<port::protocol>(proto)};
+        return true;
+      }
+      case data::type::timestamp: {
+        uint64_t x;
+        if (!get_varint(x))
+          return false;
+        result = timestamp{timespan{unzigzag(x)}};
+        return true;
+      }
+      case data::type::timespan: {
+        uint64_t x;
+        if (!get_varint(x))
+          return false;
+        result = timespan{unzigzag(x)};
+        return true;
+      }
+      case data::type::enum_value: {
+        enum_value x;
+        if (!get_string(x.name))
+          return false;
+        result = std::move(x);
+        return true;
+      }
+      case data::type::set: {
+        uint64_t n;
+        if (!get_varint(n))
+          return false;
+        set xs;
+        for (uint64_t i = 0; i < n; ++i) {
+          data x;
+          if (!(*this)(x))
+            return false;
+          xs.insert(std::move(x));
+        }
+        result = std::move(xs);
+        return true;
+      }
+      case data::type::table: {
+        uint64_t n;
+        if (!get_varint(n))
+          return false;
+        table xs;
+        for (uint64_t i = 0; i < n; ++i) {
+          data key;
+          data val;
+          if (!(*this)(key) || !(*this)(val))
+            return false;
+          xs.emplace(std::move(key), std::move(val));
+        }
+        result = std::move(xs);
+        return true;
+      }
+      case data::type::vector: {
+        uint64_t n;
+        if (!get_varint(n))
+          return false;
+        vector xs;
+        xs.reserve(n < 4096 ? n : 4096);
+        for (uint64_t i = 0; i < n; ++i) {
+          data x;
+          if (!(*this)(x))
+            return false;
+          xs.push_back(std::move(x));
+        }
+        result = std::move(xs);
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+} // namespace
+
+void encode_varint(uint64_t x, std::vector<std::byte>& buf) {
+  put_varint(x, buf);
+}
+
+size_t decode_varint(const std::byte* first, size_t size, uint64_t& x) {
+  x = 0;
+  int shift = 0;
+  for (size_t i = 0; i < size && shift < 64; ++i) {
+    auto byte = static_cast<uint64_t>(first[i]);
+    x |= (byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+      return i + 1;
+    shift += 7;
+  }
+  return 0;
+}
+
+void encode(const data& x, std::vector<std::byte>& buf) {
+  BROKER_PROBE(serialize_begin);
+  encoder f{buf};
+  visit(f, x);
+  BROKER_PROBE1(serialize_end, buf.size());
+}
+
+std::vector<std::byte> encode(const data& x) {
+  std::vector<std::byte> buf;
+  encode(x, buf);
+  return buf;
+}
+
+expected<data> decode(const std::byte* first, size_t size) {
+  BROKER_PROBE1(deserialize_begin, size);
+  decoder f{first, first + size};
+  data result;
+  if (!f(result) || f.pos != f.end) {
+    BROKER_PROBE(deserialize_end);
+    return {ec::invalid_data};
+  }
+  BROKER_PROBE(deserialize_end);
+  return {std::move(result)};
+}
+
+expected<data> decode(const std::vector<std::byte>& buf) {
+  return decode(buf.data(), buf.size());
+}
+
+void encode(const data& x, std::vector<std::byte>& buf,
+            string_dictionary& dict) {
+  BROKER_PROBE(serialize_begin);
+  encoder f{buf, &dict};
+  visit(f, x);
+  BROKER_PROBE1(serialize_end, buf.size());
+}
+
+std::vector<std::byte> encode(const data& x, string_dictionary& dict) {
+  std::vector<std::byte> buf;
+  encode(x, buf, dict);
+  return buf;
+}
+
+expected<data> decode(const std::byte* first, size_t size,
+                      string_dictionary& dict) {
+  BROKER_PROBE1(deserialize_begin, size);
+  decoder f{first, first + size, &dict};
+  data result;
+  if (!f(result) || f.pos != f.end) {
+    BROKER_PROBE(deserialize_end);
+    return {ec::invalid_data};
+  }
+  BROKER_PROBE(deserialize_end);
+  return {std::move(result)};
+}
+
+expected<data> decode(const std::vector<std::byte>& buf,
+                      string_dictionary& dict) {
+  return decode(buf.data(), buf.size(), dict);
+}
+
+// -- field-level access for typed messages ------------------------------------
+
+namespace {
+
+// Decodes one value and checks that it holds the requested alternative. For
+// scalar fields, the intermediate `data` lives on the stack and the final
+// move transfers any heap storage, so no extra allocation happens.
+template <class T>
+bool decode_field_impl(field_reader& in, T& x) {
+  decoder f{in.pos, in.end};
+  data tmp;
+  if (!f(tmp))
+    return false;
+  auto ptr = get_if<T>(&tmp);
+  if (!ptr)
+    return false;
+  x = std::move(*ptr);
+  in.pos = f.pos;
+  return true;
+}
+
+} // namespace
+
+void encode_vector_prefix(size_t num_fields, std::vector<std::byte>& buf) {
+  buf.push_back(static_cast<std::byte>(data::type::vector));
+  put_varint(num_fields, buf);
+}
+
+bool decode_vector_prefix(field_reader& in, size_t num_fields) {
+  decoder f{in.pos, in.end};
+  uint8_t tag;
+  uint64_t n;
+  if (!f.get_byte(tag) || tag != static_cast<uint8_t>(data::type::vector)
+      || !f.get_varint(n) || n != num_fields)
+    return false;
+  in.pos = f.pos;
+  return true;
+}
+
+void encode_field(boolean x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(count x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(integer x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(real x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(const std::string& x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(const address& x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(const subnet& x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(const port& x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(timestamp x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(timespan x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(const enum_value& x, std::vector<std::byte>& buf) {
+  encoder{buf}(x);
+}
+
+void encode_field(interned_enum x, std::vector<std::byte>& buf) {
+  if (!x.valid()) {
+    encoder{buf}(enum_value{});
+    return;
+  }
+  // Same bytes as encode_field(enum_value{x.name()}, buf), minus the copy.
+  encoder f{buf};
+  f.tag(data::type::enum_value);
+  auto& name = x.name();
+  put_varint(name.size(), buf);
+  put_bytes(name.data(), name.size(), buf);
+}
+
+void encode_field(const vector& xs, std::vector<std::byte>& buf) {
+  encoder{buf}(xs);
+}
+
+void encode_field(const set& xs, std::vector<std::byte>& buf) {
+  encoder{buf}(xs);
+}
+
+void encode_field(const table& xs, std::vector<std::byte>& buf) {
+  encoder{buf}(xs);
+}
+
+void encode_field(const data& x, std::vector<std::byte>& buf) {
+  encoder f{buf};
+  visit(f, x);
+}
+
+bool decode_field(field_reader& in, boolean& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, count& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, integer& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, real& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, std::string& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, address& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, subnet& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, port& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, timestamp& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, timespan& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, enum_value& x) {
+  return decode_field_impl(in, x);
+}
+
+bool decode_field(field_reader& in, interned_enum& x) {
+  decoder f{in.pos, in.end};
+  uint8_t tag;
+  if (!f.get_byte(tag) || tag != static_cast<uint8_t>(data::type::enum_value))
+    return false;
+  uint64_t n;
+  if (!f.get_varint(n) || static_cast<size_t>(f.end - f.pos) < n)
+    return false;
+  // Interning straight from the wire bytes skips the intermediate
+  // std::string; only the first occurrence of a name ever allocates.
+  x = interned_enum::intern(
+    std::string_view{reinterpret_cast<const char*>(f.pos), n});
+  in.pos = f.pos + n;
+  return true;
+}
+
+bool decode_field(field_reader& in, vector& xs) {
+  return decode_field_impl(in, xs);
+}
+
+bool decode_field(field_reader& in, set& xs) {
+  return decode_field_impl(in, xs);
+}
+
+bool decode_field(field_reader& in, table& xs) {
+  return decode_field_impl(in, xs);
+}
+
+bool decode_field(field_reader& in, data& x) {
+  decoder f{in.pos, in.end};
+  if (!f(x))
+    return false;
+  in.pos = f.pos;
+  return true;
+}
+
+bool decode_field(field_reader& in, data& x, string_dictionary& dict) {
+  decoder f{in.pos, in.end, &dict};
+  if (!f(x))
+    return false;
+  in.pos = f.pos;
+  return true;
+}
+
+// -- chunked encoding ---------------------------------------------------------
+
+void encode_chunked(const data& x, size_t max_chunk_size,
+                    const std::function<void(std::vector<std::byte>)>& sink) {
+  std::vector<std::byte> buf;
+  auto flush = [&] {
+    if (!buf.empty()) {
+      sink(std::move(buf));
+      buf = std::vector<std::byte>{};
+    }
+  };
+  auto maybe_flush = [&] {
+    if (buf.size() >= max_chunk_size)
+      flush();
+  };
+  encoder f{buf};
+  if (auto xs = get_if<vector>(&x)) {
+    f.tag(data::type::vector);
+    put_varint(xs->size(), buf);
+    for (auto& elem : *xs) {
+      visit(f, elem);
+      maybe_flush();
+    }
+  } else if (auto s = get_if<set>(&x)) {
+    f.tag(data::type::set);
+    put_varint(s->size(), buf);
+    for (auto& elem : *s) {
+      visit(f, elem);
+      maybe_flush();
+    }
+  } else if (auto t = get_if<table>(&x)) {
+    f.tag(data::type::table);
+    put_varint(t->size(), buf);
+    for (auto& [key, val] : *t) {
+      visit(f, key);
+      visit(f, val);
+      maybe_flush();
+    }
+  } else {
+    visit(f, x);
+  }
+  flush();
+}
+
+// -- chunked decoding ---------------------------------------------------------
+
+struct chunked_decoder::impl {
+  /// Bytes received but not yet consumed by element decoding.
+  std::vector<std::byte> pending;
+
+  /// Number of consumed bytes at the front of `pending`.
+  size_t offset = 0;
+
+  /// Whether the top-level tag and size were parsed already.
+  bool header_done = false;
+
+  /// Type tag of the top-level value.
+  data::type tag = data::type::none;
+
+  /// For compound values, the number of elements still missing.
+  uint64_t remaining = 0;
+
+  /// The partially built compound value.
+  data result;
+
+  /// Whether the top-level value is a set, table, or vector.
+  bool is_compound = false;
+
+  /// Whether the value decoded completely.
+  bool done = false;
+
+  void drain() {
+    if (done)
+      return;
+    auto end = pending.data() + pending.size();
+    if (!header_done) {
+      decoder d{pending.data() + offset, end};
+      uint8_t tag_byte;
+      if (!d.get_byte(tag_byte)
+          || tag_byte > static_cast<uint8_t>(data::type::vector))
+        return; // Wait for more input; malformed tags surface in finish().
+      tag = static_cast<data::type>(tag_byte);
+      is_compound = tag == data::type::set || tag == data::type::table
+                    || tag == data::type::vector;
+      if (!is_compound) {
+        header_done = true;
+        return; // Scalars decode in one go during finish().
+      }
+      if (!d.get_varint(remaining))
+        return;
+      header_done = true;
+      offset = static_cast<size_t>(d.pos - pending.data());
+      switch (tag) {
+        case data::type::set:
+          result = set{};
+          break;
+        case data::type::table:
+          result = table{};
+          break;
+        default:
+          result = vector{};
+          break;
+      }
+    }
+    while (remaining > 0) {
+      decoder d{pending.data() + offset, end};
+      if (tag == data::type::table) {
+        data key;
+        data val;
+        if (!d(key) || !d(val))
+          break;
+        get_if<table>(&result)->emplace(std::move(key), std::move(val));
+      } else {
+        data elem;
+        if (!d(elem))
+          break;
+        if (tag == data::type::set)
+          get_if<set>(&result)->insert(std::move(elem));
+        else
+          get_if<vector>(&result)->push_back(std::move(elem));
+      }
+      offset = static_cast<size_t>(d.pos - pending.data());
+      --remaining;
+    }
+    if (remaining == 0)
+      done = true;
+    // Drop the consumed prefix once it grows large to keep memory flat.
+    constexpr size_t compact_threshold = 1024 * 1024;
+    if (offset >= compact_threshold) {
+      pending.erase(pending.begin(),
+                    pending.begin() + static_cast<ptrdiff_t>(offset));
+      offset = 0;
+    }
+  }
+};
+
+chunked_decoder::chunked_decoder() : impl_(std::make_unique<impl>()) {
+  // nop
+}
+
+chunked_decoder::chunked_decoder(chunked_decoder&&) noexcept = default;
+
+chunked_decoder& chunked_decoder::operator=(chunked_decoder&&) noexcept
+  = default;
+
+chunked_decoder::~chunked_decoder() = default;
+
+void chunked_decoder::append(const std::byte* first, size_t size) {
+  impl_->pending.insert(impl_->pending.end(), first, first + size);
+  impl_->drain();
+}
+
+expected<data> chunked_decoder::finish() {
+  auto& st = *impl_;
+  if (st.done) {
+    if (st.offset != st.pending.size())
+      return {ec::invalid_data};
+    return {std::move(st.result)};
+  }
+  if (!st.header_done || st.is_compound)
+    return {ec::invalid_data};
+  // Scalar values (including long strings) decode from the full input.
+  return decode(st.pending.data() + st.offset, st.pending.size() - st.offset);
+}
+
+} // namespace broker::detail
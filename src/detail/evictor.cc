@@ -0,0 +1,142 @@
+#include "broker/detail/evictor.hh"
+
+namespace broker::detail {
+
+evictor::evictor(policy p, uint64_t max_entries)
+  : policy_(p), max_entries_(max_entries) {
+  // nop
+}
+
+std::optional<evictor::policy> evictor::parse_policy(const std::string& str) {
+  if (str == "lru")
+    return policy::lru;
+  if (str == "ttl")
+    return policy::ttl;
+  if (str == "random")
+    return policy::random;
+  return std::nullopt;
+}
+
+size_t evictor::size() const noexcept {
+  switch (policy_) {
+    case policy::lru:
+      return lru_pos_.size();
+    case policy::ttl:
+      return ttl_pos_.size() + fifo_pos_.size();
+    case policy::random:
+      return key_pos_.size();
+    default:
+      return 0;
+  }
+}
+
+void evictor::insert(const data& key, std::optional<timestamp> expiry) {
+  switch (policy_) {
+    case policy::lru:
+      touch(key);
+      if (lru_pos_.count(key) == 0) {
+        lru_order_.push_back(key);
+        lru_pos_.emplace(key, std::prev(lru_order_.end()));
+      }
+      break;
+    case policy::ttl:
+      // Overwrites may add, drop or change the expiry; start from scratch.
+      erase(key);
+      if (expiry) {
+        auto i = ttl_order_.emplace(*expiry, key);
+        ttl_pos_.emplace(key, i);
+      } else {
+        fifo_order_.push_back(key);
+        fifo_pos_.emplace(key, std::prev(fifo_order_.end()));
+      }
+      break;
+    case policy::random:
+      if (key_pos_.count(key) == 0) {
+        keys_.push_back(key);
+        key_pos_.emplace(key, keys_.size() - 1);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void evictor::touch(const data& key) {
+  if (policy_ != policy::lru)
+    return;
+  if (auto i = lru_pos_.find(key); i != lru_pos_.end())
+    lru_order_.splice(lru_order_.end(), lru_order_, i->second);
+}
+
+void evictor::erase(const data& key) {
+  switch (policy_) {
+    case policy::lru:
+      if (auto i = lru_pos_.find(key); i != lru_pos_.end()) {
+        lru_order_.erase(i->second);
+        lru_pos_.erase(i);
+      }
+      break;
+    case policy::ttl:
+      if (auto i = ttl_pos_.find(key); i != ttl_pos_.end()) {
+        ttl_order_.erase(i->second);
+        ttl_pos_.erase(i);
+      } else if (auto j = fifo_pos_.find(key); j != fifo_pos_.end()) {
+        fifo_order_.erase(j->second);
+        fifo_pos_.erase(j);
+      }
+      break;
+    case policy::random:
+      if (auto i = key_pos_.find(key); i != key_pos_.end()) {
+        auto pos = i->second;
+        key_pos_.erase(i);
+        if (pos != keys_.size() - 1) {
+          keys_[pos] = std::move(keys_.back());
+          key_pos_[keys_[pos]] = pos;
+        }
+        keys_.pop_back();
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void evictor::clear() {
+  lru_order_.clear();
+  lru_pos_.clear();
+  ttl_order_.clear();
+  ttl_pos_.clear();
+  fifo_order_.clear();
+  fifo_pos_.clear();
+  keys_.clear();
+  key_pos_.clear();
+}
+
+std::optional<data> evictor::evict() {
+  std::optional<data> result;
+  switch (policy_) {
+    case policy::lru:
+      if (!lru_order_.empty())
+        result = lru_order_.front();
+      break;
+    case policy::ttl:
+      if (!ttl_order_.empty())
+        result = ttl_order_.begin()->second;
+      else if (!fifo_order_.empty())
+        result = fifo_order_.front();
+      break;
+    case policy::random:
+      if (!keys_.empty()) {
+        auto dis = std::uniform_int_distribution<size_t>{0, keys_.size() - 1};
+        result = keys_[dis(engine_)];
+      }
+      break;
+    default:
+      break;
+  }
+  if (result)
+    erase(*result);
+  return result;
+}
+
+} // namespace broker::detail
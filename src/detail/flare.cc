@@ -7,6 +7,7 @@
 
 #include "broker/config.hh"
 #include "broker/detail/assert.hh"
+#include "broker/detail/sdt.hh"
 #include "broker/internal/logger.hh"
 
 #include <caf/io/network/native_socket.hpp>
@@ -40,6 +41,10 @@ bool try_again_later() {
 #include <poll.h>
 #include <unistd.h>
 
+#ifdef BROKER_LINUX
+#include <sys/eventfd.h>
+#endif
+
 #define PIPE_WRITE ::write
 
 #define PIPE_READ ::read
@@ -59,6 +64,121 @@ bool try_again_later() {
 
 namespace broker::detail {
 
+#ifdef BROKER_LINUX
+
+// -- eventfd-based implementation ---------------------------------------------
+//
+// The count lives in `count_` and changes without any syscall. The eventfd
+// only carries a wakeup token that makes `fd()` readable: `fire` arms it on
+// the zero-to-nonzero transition and the extinguish functions call `settle`
+// after draining the count, which removes the token and re-arms it if a
+// concurrent fire raced in new counts. Hence, back-to-back fires while the
+// flare is already active cost no syscall at all.
+
+namespace {
+
+void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#else
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+void arm(native_socket fd) {
+  uint64_t token = 1;
+  if (::write(fd, &token, sizeof(token)) != sizeof(token)) {
+    BROKER_ERROR("unable to write flare eventfd!");
+    std::terminate();
+  }
+}
+
+bool disarm(native_socket fd) {
+  uint64_t token = 0;
+  if (::read(fd, &token, sizeof(token)) == sizeof(token))
+    return true;
+  if (try_again_later())
+    return false;
+  BROKER_ERROR("unable to read flare eventfd!");
+  std::terminate();
+}
+
+} // namespace
+
+flare::flare() : count_(0) {
+  efd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (efd_ == -1) {
+    BROKER_ERROR("failed to create flare eventfd");
+    std::terminate();
+  }
+}
+
+flare::~flare() {
+  ::close(efd_);
+}
+
+native_socket flare::fd() const {
+  return efd_;
+}
+
+void flare::fire(size_t num) {
+  BROKER_PROBE1(flare_fire, num);
+  if (count_.fetch_add(num) == 0)
+    arm(efd_);
+}
+
+size_t flare::extinguish() {
+  auto result = count_.exchange(0);
+  settle();
+  BROKER_PROBE1(flare_extinguish, result);
+  return static_cast<size_t>(result);
+}
+
+bool flare::extinguish_one() {
+  auto count = count_.load();
+  while (count > 0)
+    if (count_.compare_exchange_weak(count, count - 1)) {
+      if (count == 1)
+        settle();
+      return true;
+    }
+  return false;
+}
+
+size_t flare::extinguish_some(size_t num) {
+  auto count = count_.load();
+  for (;;) {
+    if (count == 0)
+      return 0;
+    auto n = std::min(static_cast<uint64_t>(num), count);
+    if (count_.compare_exchange_weak(count, count - n)) {
+      if (count == n)
+        settle();
+      return static_cast<size_t>(n);
+    }
+  }
+}
+
+void flare::settle() {
+  if (disarm(efd_) && count_.load() != 0)
+    arm(efd_);
+}
+
+bool flare::spin_await_one(size_t max_spins) const {
+  for (size_t i = 0; i < max_spins; ++i) {
+    if (count_.load(std::memory_order_acquire) > 0)
+      return true;
+    cpu_relax();
+  }
+  return false;
+}
+
+#else // BROKER_LINUX
+
+// -- pipe-based implementation ------------------------------------------------
+
 namespace {
 
 namespace net = caf::io::network;
@@ -102,6 +222,7 @@ native_socket flare::fd() const {
 }
 
 void flare::fire(size_t num) {
+  BROKER_PROBE1(flare_fire, num);
   stack_buffer tmp;
   size_t remaining = num;
   while (remaining > 0) {
@@ -120,10 +241,12 @@ size_t flare::extinguish() {
   size_t result = 0;
   for (;;) {
     auto n = PIPE_READ(fds_[0], tmp.data, stack_buffer_size);
-    if (n > 0)
+    if (n > 0) {
       result += static_cast<size_t>(n);
-    else if (n == -1 && try_again_later())
+    } else if (n == -1 && try_again_later()) {
+      BROKER_PROBE1(flare_extinguish, result);
       return result; // Pipe is now drained.
+    }
   }
 }
 
@@ -138,9 +261,24 @@ bool flare::extinguish_one() {
   }
 }
 
+size_t flare::extinguish_some(size_t num) {
+  size_t result = 0;
+  while (result < num && extinguish_one())
+    ++result;
+  return result;
+}
+
+bool flare::spin_await_one(size_t) const {
+  // The pipe stores the count as unread bytes, so any readiness check costs
+  // a syscall and spinning cannot beat going to poll() right away.
+  return false;
+}
+
+#endif // BROKER_LINUX
+
 void flare::await_one() {
   BROKER_TRACE("");
-  pollfd p = {fds_[0], POLLIN, 0};
+  pollfd p = {fd(), POLLIN, 0};
   for (;;) {
     BROKER_DEBUG("polling");
     auto n = ::poll(&p, 1, -1);
@@ -155,7 +293,7 @@ void flare::await_one() {
 
 bool flare::await_one_impl(int ms_timeout) {
   BROKER_TRACE("");
-  pollfd p = {fds_[0], POLLIN, 0};
+  pollfd p = {fd(), POLLIN, 0};
   auto n = ::poll(&p, 1, ms_timeout);
   if (n < 0 && !try_again_later())
     std::terminate();
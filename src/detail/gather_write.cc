@@ -0,0 +1,137 @@
+#include "broker/detail/gather_write.hh"
+
+#include <cerrno>
+
+#include "broker/detail/assert.hh"
+#include "broker/detail/data_codec.hh"
+#include "broker/error.hh"
+#include "broker/message.hh"
+
+#ifdef BROKER_WINDOWS
+#include <winsock2.h>
+#else
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace broker::detail {
+
+namespace {
+
+/// Caps the number of segments per vectored write call.
+constexpr size_t max_iovecs = 64;
+
+} // namespace
+
+void segment_list::append(const void* data, size_t size) {
+  if (size == 0)
+    return;
+  segments_.emplace_back(
+    segment{static_cast<const std::byte*>(data), 0, size});
+  total_bytes_ += size;
+}
+
+void segment_list::append_scratch(size_t offset, size_t size) {
+  BROKER_ASSERT(scratch_ != nullptr);
+  if (size == 0)
+    return;
+  segments_.emplace_back(segment{nullptr, offset, size});
+  total_bytes_ += size;
+}
+
+ptrdiff_t segment_list::write_some(native_socket fd) {
+  if (written_ >= total_bytes_)
+    return 0;
+  // Find the first segment with unwritten bytes.
+  size_t index = 0;
+  size_t skipped = 0;
+  while (skipped + segments_[index].size <= written_)
+    skipped += segments_[index++].size;
+  auto first_offset = written_ - skipped;
+#ifndef BROKER_WINDOWS
+  iovec iov[max_iovecs];
+  size_t num = 0;
+  for (auto i = index; i < segments_.size() && num < max_iovecs; ++i) {
+    auto& seg = segments_[i];
+    auto* base = segment_data(seg);
+    auto len = seg.size;
+    if (num == 0) {
+      base += first_offset;
+      len -= first_offset;
+    }
+    iov[num].iov_base = const_cast<std::byte*>(base);
+    iov[num].iov_len = len;
+    ++num;
+  }
+  auto res = ::writev(fd, iov, static_cast<int>(num));
+  if (res < 0)
+    return -1;
+  written_ += static_cast<size_t>(res);
+  return res;
+#else
+  // No writev on Windows sockets; fall back to writing one segment at a time.
+  auto& seg = segments_[index];
+  auto* base = segment_data(seg) + first_offset;
+  auto len = seg.size - first_offset;
+  auto res = ::send(fd, reinterpret_cast<const char*>(base),
+                    static_cast<int>(len), 0);
+  if (res < 0)
+    return -1;
+  written_ += static_cast<size_t>(res);
+  return res;
+#endif
+}
+
+bool segment_list::write_all(native_socket fd) {
+  while (written_ < total_bytes_) {
+    auto res = write_some(fd);
+    if (res < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+  }
+  return true;
+}
+
+void encode_frame(const data_message& msg, std::vector<std::byte>& scratch,
+                  segment_list& out) {
+  const auto& topic_str = get_topic(msg).string();
+  // Encode the payload first so that the header can carry its exact size.
+  auto payload_offset = scratch.size();
+  encode(get_data(msg), scratch);
+  auto payload_size = scratch.size() - payload_offset;
+  auto header_offset = scratch.size();
+  encode_varint(topic_str.size(), scratch);
+  encode_varint(payload_size, scratch);
+  out.append_scratch(header_offset, scratch.size() - header_offset);
+  out.append(topic_str.data(), topic_str.size());
+  out.append_scratch(payload_offset, payload_size);
+}
+
+expected<data_message> decode_frame(const std::byte* first, size_t size,
+                                    size_t& consumed) {
+  uint64_t topic_size = 0;
+  uint64_t payload_size = 0;
+  auto n1 = decode_varint(first, size, topic_size);
+  if (n1 == 0)
+    return make_error(ec::end_of_file);
+  auto n2 = decode_varint(first + n1, size - n1, payload_size);
+  if (n2 == 0)
+    return make_error(ec::end_of_file);
+  auto header_size = n1 + n2;
+  if (topic_size > size || payload_size > size
+      || header_size + topic_size + payload_size > size)
+    return make_error(ec::end_of_file);
+  auto* topic_bytes = reinterpret_cast<const char*>(first + header_size);
+  auto* payload_bytes = first + header_size + topic_size;
+  auto payload = decode(payload_bytes, payload_size);
+  if (!payload)
+    return payload.error();
+  consumed = header_size + topic_size + payload_size;
+  return make_data_message(topic{std::string{topic_bytes, topic_size}},
+                           std::move(*payload));
+}
+
+} // namespace broker::detail
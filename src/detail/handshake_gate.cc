@@ -0,0 +1,55 @@
+#include "broker/detail/handshake_gate.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace broker::detail {
+
+handshake_gate::handshake_gate(double handshakes_per_second, size_t burst,
+                               size_t max_pending)
+  : rate_(handshakes_per_second),
+    burst_(burst > 0 ? static_cast<double>(burst)
+                     : std::max(1.0, std::round(handshakes_per_second))),
+    max_pending_(max_pending),
+    tokens_(burst_),
+    last_refill_(clock::now()) {
+  // nop
+}
+
+bool handshake_gate::try_admit() {
+  // Claim an in-flight slot first; the bucket only matters when a slot is
+  // free.
+  for (;;) {
+    auto in_flight = pending_.load(std::memory_order_relaxed);
+    if (max_pending_ > 0 && in_flight >= max_pending_) {
+      rejected_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (pending_.compare_exchange_weak(in_flight, in_flight + 1,
+                                       std::memory_order_relaxed))
+      break;
+  }
+  if (rate_ <= 0)
+    return true;
+  std::unique_lock guard{mtx_};
+  auto now = clock::now();
+  if (now > last_refill_) {
+    std::chrono::duration<double> elapsed = now - last_refill_;
+    last_refill_ = now;
+    tokens_ = std::min(burst_, tokens_ + elapsed.count() * rate_);
+  }
+  if (tokens_ >= 1.0) {
+    tokens_ -= 1.0;
+    return true;
+  }
+  guard.unlock();
+  pending_.fetch_sub(1, std::memory_order_relaxed);
+  rejected_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void handshake_gate::done() {
+  pending_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+} // namespace broker::detail
@@ -0,0 +1,262 @@
+#include "broker/detail/http_metrics_server.hh"
+
+#ifndef BROKER_WINDOWS
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "broker/error.hh"
+
+namespace broker::detail {
+
+namespace {
+
+using std::string_view;
+
+// Cap buffered request bytes per connection.
+constexpr size_t max_request_size = 64 * 1024;
+
+constexpr string_view valid_request_start = "GET /metrics HTTP/1.";
+
+constexpr string_view response_too_large
+  = "HTTP/1.1 413 Request Entity Too Large\r\n"
+    "Connection: close\r\n\r\n";
+
+constexpr string_view response_not_supported
+  = "HTTP/1.1 501 Not Implemented\r\n"
+    "Connection: close\r\n\r\n";
+
+void close_socket(native_socket fd) {
+  if (fd != invalid_native_socket)
+    ::close(fd);
+}
+
+void nonblocking(native_socket fd) {
+  auto flags = fcntl(fd, F_GETFL, 0);
+  if (flags != -1)
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/// Returns whether the request head asks for closing the connection after
+/// the response. HTTP/1.1 defaults to keep-alive, HTTP/1.0 to close.
+bool wants_close(string_view head) {
+  auto to_lower = [](char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+  };
+  constexpr string_view field = "connection:";
+  size_t pos = 0;
+  while ((pos = head.find('\n', pos)) != string_view::npos) {
+    auto line = head.substr(++pos);
+    if (line.size() < field.size())
+      continue;
+    auto matches_field = [&] {
+      for (size_t i = 0; i < field.size(); ++i)
+        if (to_lower(line[i]) != field[i])
+          return false;
+      return true;
+    };
+    if (!matches_field())
+      continue;
+    auto value = line.substr(field.size());
+    if (auto end = value.find('\r'); end != string_view::npos)
+      value = value.substr(0, end);
+    return value.find("close") != string_view::npos;
+  }
+  // No Connection header: the version decides.
+  return head.size() > valid_request_start.size()
+         && head[valid_request_start.size()] == '0';
+}
+
+} // namespace
+
+http_metrics_server::~http_metrics_server() {
+  stop();
+}
+
+expected<uint16_t> http_metrics_server::start(uint16_t port) {
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  addrinfo* res = nullptr;
+  if (getaddrinfo(nullptr, std::to_string(port).c_str(), &hints, &res) != 0
+      || res == nullptr)
+    return {ec::unspecified};
+  auto fd = ::socket(res->ai_family, SOCK_STREAM, 0);
+  if (fd < 0) {
+    freeaddrinfo(res);
+    return {ec::unspecified};
+  }
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  auto ok = ::bind(fd, res->ai_addr, res->ai_addrlen) == 0
+            && ::listen(fd, SOMAXCONN) == 0;
+  freeaddrinfo(res);
+  if (!ok) {
+    ::close(fd);
+    return {ec::unspecified};
+  }
+  sockaddr_storage addr;
+  socklen_t len = sizeof(addr);
+  if (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    ::close(fd);
+    return {ec::unspecified};
+  }
+  if (addr.ss_family == AF_INET)
+    port_ = ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+  else
+    port_ = ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+  int pipe_fds[2];
+  if (::pipe(pipe_fds) != 0) {
+    ::close(fd);
+    return {ec::unspecified};
+  }
+  nonblocking(fd);
+  listen_fd_ = fd;
+  wakeup_read_ = pipe_fds[0];
+  wakeup_write_ = pipe_fds[1];
+  thread_ = std::thread{[this] { run(); }};
+  return port_;
+}
+
+void http_metrics_server::stop() {
+  if (wakeup_write_ == invalid_native_socket)
+    return;
+  char dummy = 0;
+  [[maybe_unused]] auto unused = ::write(wakeup_write_, &dummy, 1);
+  thread_.join();
+  close_socket(listen_fd_);
+  close_socket(wakeup_read_);
+  close_socket(wakeup_write_);
+  listen_fd_ = invalid_native_socket;
+  wakeup_read_ = invalid_native_socket;
+  wakeup_write_ = invalid_native_socket;
+}
+
+void http_metrics_server::update(std::string exposition) {
+  std::unique_lock guard{mtx_};
+  exposition_ = std::move(exposition);
+}
+
+void http_metrics_server::run() {
+  std::vector<connection> conns;
+  std::vector<pollfd> fds;
+  for (;;) {
+    fds.clear();
+    fds.push_back({listen_fd_, POLLIN, 0});
+    fds.push_back({wakeup_read_, POLLIN, 0});
+    for (auto& conn : conns) {
+      short events = POLLIN;
+      if (!conn.out.empty())
+        events |= POLLOUT;
+      fds.push_back({conn.fd, events, 0});
+    }
+    if (::poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (fds[1].revents != 0)
+      break;
+    // Freshly accepted connections have no pollfd entry yet; remember how
+    // many connections this round polled.
+    auto num_polled = conns.size();
+    if (fds[0].revents != 0) {
+      for (;;) {
+        auto client = ::accept(listen_fd_, nullptr, nullptr);
+        if (client < 0)
+          break;
+        nonblocking(client);
+        conns.push_back(connection{client, {}, {}, false});
+      }
+    }
+    for (size_t i = 0; i < num_polled; ++i) {
+      auto& conn = conns[i];
+      auto revents = fds[i + 2].revents;
+      auto dead = (revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+      if (!dead && (revents & POLLIN) != 0) {
+        char buf[4096];
+        for (;;) {
+          auto n = ::recv(conn.fd, buf, sizeof(buf), 0);
+          if (n > 0) {
+            conn.in.append(buf, static_cast<size_t>(n));
+            continue;
+          }
+          if (n == 0 || (errno != EWOULDBLOCK && errno != EAGAIN))
+            dead = true;
+          break;
+        }
+        if (!dead)
+          handle_requests(conn);
+      }
+      if (!dead && !conn.out.empty()) {
+        auto n = ::send(conn.fd, conn.out.data(), conn.out.size(), 0);
+        if (n > 0)
+          conn.out.erase(0, static_cast<size_t>(n));
+        else if (errno != EWOULDBLOCK && errno != EAGAIN)
+          dead = true;
+      }
+      if (dead || (conn.closing && conn.out.empty())) {
+        close_socket(conn.fd);
+        conn.fd = invalid_native_socket;
+      }
+    }
+    auto gone = [](const connection& conn) {
+      return conn.fd == invalid_native_socket;
+    };
+    conns.erase(std::remove_if(conns.begin(), conns.end(), gone), conns.end());
+  }
+  for (auto& conn : conns)
+    close_socket(conn.fd);
+}
+
+void http_metrics_server::handle_requests(connection& conn) {
+  for (;;) {
+    if (conn.closing)
+      return;
+    auto end = conn.in.find("\r\n\r\n");
+    if (end == std::string::npos) {
+      if (conn.in.size() > max_request_size) {
+        conn.out.append(response_too_large);
+        conn.closing = true;
+      }
+      return;
+    }
+    auto head = string_view{conn.in}.substr(0, end + 4);
+    if (head.size() < valid_request_start.size()
+        || head.compare(0, valid_request_start.size(), valid_request_start)
+             != 0) {
+      conn.out.append(response_not_supported);
+      conn.closing = true;
+      return;
+    }
+    conn.closing = wants_close(head);
+    std::string body;
+    {
+      std::unique_lock guard{mtx_};
+      body = exposition_;
+    }
+    conn.out += "HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/plain\r\n"
+                "Content-Length: ";
+    conn.out += std::to_string(body.size());
+    conn.out += conn.closing ? "\r\nConnection: close\r\n\r\n"
+                             : "\r\nConnection: keep-alive\r\n\r\n";
+    conn.out += body;
+    conn.in.erase(0, end + 4);
+  }
+}
+
+} // namespace broker::detail
+
+#endif // BROKER_WINDOWS
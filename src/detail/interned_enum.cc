@@ -0,0 +1,44 @@
+#include "broker/detail/interned_enum.hh"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace broker::detail {
+
+namespace {
+
+struct intern_pool {
+  std::mutex mtx;
+  // Entries live in a deque for pointer stability; the map only refers to
+  // them. Entries are never removed.
+  std::deque<interned_enum_entry> entries;
+  std::unordered_map<std::string_view, const interned_enum_entry*> index;
+};
+
+intern_pool& pool() {
+  static intern_pool instance;
+  return instance;
+}
+
+} // namespace
+
+interned_enum interned_enum::intern(std::string_view name) {
+  auto& p = pool();
+  std::unique_lock guard{p.mtx};
+  if (auto i = p.index.find(name); i != p.index.end())
+    return interned_enum{i->second};
+  auto id = static_cast<uint32_t>(p.entries.size());
+  auto& entry = p.entries.emplace_back(
+    interned_enum_entry{id, std::string{name}});
+  p.index.emplace(std::string_view{entry.name}, &entry);
+  return interned_enum{&entry};
+}
+
+size_t interned_enum_count() {
+  auto& p = pool();
+  std::unique_lock guard{p.mtx};
+  return p.entries.size();
+}
+
+} // namespace broker::detail
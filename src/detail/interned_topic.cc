@@ -0,0 +1,44 @@
+#include "broker/detail/interned_topic.hh"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace broker::detail {
+
+namespace {
+
+struct intern_pool {
+  std::mutex mtx;
+  // Entries live in a deque for pointer stability; the map only refers to
+  // them. Entries are never removed.
+  std::deque<interned_topic_entry> entries;
+  std::unordered_map<std::string_view, const interned_topic_entry*> index;
+};
+
+intern_pool& pool() {
+  static intern_pool instance;
+  return instance;
+}
+
+} // namespace
+
+interned_topic interned_topic::intern(std::string_view str) {
+  auto& p = pool();
+  std::unique_lock guard{p.mtx};
+  if (auto i = p.index.find(str); i != p.index.end())
+    return interned_topic{i->second};
+  auto id = static_cast<uint32_t>(p.entries.size());
+  auto& entry = p.entries.emplace_back(
+    interned_topic_entry{id, std::string{str}});
+  p.index.emplace(std::string_view{entry.str}, &entry);
+  return interned_topic{&entry};
+}
+
+size_t interned_topic_count() {
+  auto& p = pool();
+  std::unique_lock guard{p.mtx};
+  return p.entries.size();
+}
+
+} // namespace broker::detail
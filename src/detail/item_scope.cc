@@ -16,4 +16,17 @@ std::string to_string(item_scope x) {
   return item_scope_strings[static_cast<uint8_t>(x)];
 }
 
+namespace {
+
+constexpr const char* item_priority_strings[] = {
+  "high",
+  "normal",
+};
+
+} // namespace
+
+std::string to_string(item_priority x) {
+  return item_priority_strings[static_cast<uint8_t>(x)];
+}
+
 } // namespace broker::detail
@@ -0,0 +1,89 @@
+#include "broker/detail/ktls.hh"
+
+#ifdef BROKER_HAVE_KTLS
+
+#include <cerrno>
+#include <cstring>
+
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "broker/error.hh"
+
+// Older glibc versions lack these even when the kernel supports them.
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+namespace broker::detail {
+
+namespace {
+
+bool fill(const ktls_session& session,
+          tls12_crypto_info_aes_gcm_128& info) noexcept {
+  memset(&info, 0, sizeof(info));
+  switch (session.tls_version) {
+    case ktls_tls12:
+      info.info.version = TLS_1_2_VERSION;
+      break;
+#ifdef TLS_1_3_VERSION
+    case ktls_tls13:
+      info.info.version = TLS_1_3_VERSION;
+      break;
+#endif
+    default:
+      return false;
+  }
+  info.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+  static_assert(sizeof(info.key) == sizeof(session.key));
+  static_assert(sizeof(info.salt) == sizeof(session.salt));
+  static_assert(sizeof(info.iv) == sizeof(session.iv));
+  static_assert(sizeof(info.rec_seq) == sizeof(session.rec_seq));
+  memcpy(info.key, session.key.data(), sizeof(info.key));
+  memcpy(info.salt, session.salt.data(), sizeof(info.salt));
+  memcpy(info.iv, session.iv.data(), sizeof(info.iv));
+  memcpy(info.rec_seq, session.rec_seq.data(), sizeof(info.rec_seq));
+  return true;
+}
+
+} // namespace
+
+bool ktls_available() noexcept {
+  auto fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0)
+    return false;
+  auto res = setsockopt(fd, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls"));
+  auto reason = errno;
+  ::close(fd);
+  // ENOENT means the kernel cannot find a ULP named "tls"; any other error
+  // (usually ENOTCONN) indicates the module exists but the socket state does
+  // not fit, which is all this probe needs to know.
+  return res == 0 || reason != ENOENT;
+}
+
+expected<void> enable_ktls(native_socket fd, const ktls_session& tx,
+                           const ktls_session& rx) {
+  if (setsockopt(fd, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")) != 0)
+    return {ec::unspecified};
+  tls12_crypto_info_aes_gcm_128 info;
+  if (!fill(tx, info))
+    return {ec::invalid_data};
+  if (setsockopt(fd, SOL_TLS, TLS_TX, &info, sizeof(info)) != 0)
+    return {ec::unspecified};
+  if (!fill(rx, info))
+    return {ec::invalid_data};
+  if (setsockopt(fd, SOL_TLS, TLS_RX, &info, sizeof(info)) != 0)
+    return {ec::unspecified};
+  return {};
+}
+
+} // namespace broker::detail
+
+#endif // BROKER_HAVE_KTLS
@@ -3,8 +3,13 @@
 #include "broker/detail/die.hh"
 #include "broker/detail/make_backend.hh"
 #include "broker/detail/memory_backend.hh"
+#include "broker/detail/mmap_backend.hh"
 #include "broker/detail/sqlite_backend.hh"
 
+#ifdef BROKER_HAVE_ROCKSDB
+#include "broker/detail/rocksdb_backend.hh"
+#endif
+
 namespace broker {
 namespace detail {
 
@@ -19,6 +24,22 @@ std::unique_ptr<detail::abstract_backend> make_backend(backend type,
         return nullptr;
       return rval;
     }
+    case backend::mmapdb: {
+      auto rval = std::make_unique<mmap_backend>(std::move(opts));
+      if (rval->init_failed())
+        return nullptr;
+      return rval;
+    }
+    case backend::rocksdb: {
+#ifdef BROKER_HAVE_ROCKSDB
+      auto rval = std::make_unique<rocksdb_backend>(std::move(opts));
+      if (rval->init_failed())
+        return nullptr;
+      return rval;
+#else
+      return nullptr;
+#endif
+    }
   }
 
   die("invalid backend type");
@@ -0,0 +1,64 @@
+#include "broker/detail/memory_accounting.hh"
+
+#include "broker/endpoint.hh"
+#include "broker/telemetry/metric_registry.hh"
+
+namespace broker::detail {
+
+namespace {
+
+// Estimates the top-level heap payload of a value. Containers count their
+// element slots only; recursing into elements would make the estimate O(n)
+// in the nesting depth and too expensive for per-message accounting.
+struct payload_estimator {
+  using result_type = size_t;
+
+  result_type operator()(const std::string& x) {
+    return x.capacity();
+  }
+
+  result_type operator()(const enum_value& x) {
+    return x.name.capacity();
+  }
+
+  result_type operator()(const broker::set& xs) {
+    return xs.size() * (sizeof(data) + 2 * sizeof(void*));
+  }
+
+  result_type operator()(const table& xs) {
+    return xs.size() * (2 * sizeof(data) + 2 * sizeof(void*));
+  }
+
+  result_type operator()(const vector& xs) {
+    return xs.capacity() * sizeof(data);
+  }
+
+  template <class T>
+  result_type operator()(const T&) {
+    return 0;
+  }
+};
+
+} // namespace
+
+size_t estimated_memory_use(const data& x) noexcept {
+  return sizeof(data) + visit(payload_estimator{}, x);
+}
+
+memory_accountant_ptr make_memory_accountant(endpoint& ep, size_t budget) {
+  auto reg = telemetry::metric_registry::from(ep);
+  auto result = std::make_shared<memory_accountant>();
+  result->budget(budget);
+  for (auto region : {memory_region::queues, memory_region::dispatcher}) {
+    telemetry::label_view labels[] = {{"region", memory_region_name(region)}};
+    auto label_span = span<const telemetry::label_view>{labels, 1};
+    result->attach_gauge(
+      region, reg.gauge_instance(
+                "broker", "memory-usage", label_span,
+                "Estimated number of bytes buffered by the component.",
+                "bytes"));
+  }
+  return result;
+}
+
+} // namespace broker::detail
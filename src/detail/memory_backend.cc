@@ -1,13 +1,27 @@
+#include <algorithm>
 #include <set>
 #include <cstdint>
+#include <unordered_set>
 #include <utility>
 
 #include "broker/detail/appliers.hh"
+#include "broker/detail/memory_accounting.hh"
 #include "broker/detail/memory_backend.hh"
 
 namespace broker {
 namespace detail {
 
+namespace {
+
+/// Orders the expiry heap as a min-heap on the expiry time.
+struct later {
+  bool operator()(const expirable& x, const expirable& y) const noexcept {
+    return x.second > y.second;
+  }
+};
+
+} // namespace
+
 
 memory_backend::memory_backend(backend_options opts)
   : options_{std::move(opts)} {
@@ -16,83 +30,131 @@ memory_backend::memory_backend(backend_options opts)
 
 expected<void> memory_backend::put(const data& key, data value,
                                    std::optional<timestamp> expiry) {
-  store_[key] = {std::move(value), std::move(expiry)};
+  hashed_key hk{key};
+  preserve(hk);
+  store_[hk] = {std::move(value), expiry};
+  ordered_keys_.insert(key);
+  index_expiry(key, expiry);
   return {};
 }
 
 expected<void> memory_backend::add(const data& key, const data& value,
                                    data::type init_type,
                                    std::optional<timestamp> expiry) {
-  auto i = store_.find(key);
+  preserve(hashed_key{key});
+  auto i = store_.find(hashed_key{key});
   if (i == store_.end()) {
     if (init_type == data::type::none)
       return ec::type_clash;
     auto newv = std::make_pair(data::from_type(init_type), expiry);
-    i = store_.emplace(std::move(key), std::move(newv)).first;
+    i = store_.emplace(hashed_key{key}, std::move(newv)).first;
+    ordered_keys_.insert(key);
+  }
+  auto result = apply(adder{value}, i->second.first);
+  if (result) {
+    i->second.second = expiry;
+    index_expiry(key, expiry);
   }
-  auto result = visit(adder{value}, i->second.first);
-  if (result)
-    i->second.second = std::move(expiry);
   return result;
 }
 
 expected<void> memory_backend::subtract(const data& key, const data& value,
                                         std::optional<timestamp> expiry) {
-  auto i = store_.find(key);
+  preserve(hashed_key{key});
+  auto i = store_.find(hashed_key{key});
   if (i == store_.end())
     return ec::no_such_key;
-  auto result = visit(remover{value}, i->second.first);
-  if (result)
-    i->second.second = std::move(expiry);
+  auto result = apply(remover{value}, i->second.first);
+  if (result) {
+    i->second.second = expiry;
+    index_expiry(key, expiry);
+  }
   return result;
 }
 
+expected<void>
+memory_backend::bulk_insert(std::vector<std::pair<data, data>> entries) {
+  // Growing the table once up front avoids rehashing during the load.
+  store_.reserve(store_.size() + entries.size());
+  for (auto& [key, value] : entries)
+    if (auto res = put(key, std::move(value), std::nullopt); !res)
+      return res;
+  return {};
+}
+
 expected<void> memory_backend::erase(const data& key) {
-  store_.erase(key);
+  hashed_key hk{key};
+  preserve(hk);
+  store_.erase(hk);
+  ordered_keys_.erase(key);
   return {};
 }
 
 expected<void> memory_backend::clear() {
+   if (fork_active_)
+     for (auto& p : store_)
+       preserve(p.first);
    store_.clear();
+   ordered_keys_.clear();
+   expiry_heap_.clear();
    return {};
 }
 
+expected<void> memory_backend::compact() {
+  compact_expiry_heap();
+  expiry_heap_.shrink_to_fit();
+  store_.shrink_to_fit();
+  return {};
+}
+
 expected<bool> memory_backend::expire(const data& key, timestamp ts) {
-  auto i = store_.find(key);
+  auto i = store_.find(hashed_key{key});
   if (i == store_.end())
     return false;
   if (!i->second.second || ts < i->second.second)
     return false;
+  preserve(i->first);
+  ordered_keys_.erase(i->first.value());
   store_.erase(i);
   return true;
 }
 
 expected<data> memory_backend::get(const data& key) const {
-  auto i = store_.find(key);
+  auto i = store_.find(hashed_key{key});
   if (i == store_.end())
     return ec::no_such_key;
   return i->second.first;
 }
 
 expected<data> memory_backend::keys() const {
-  set keys;
-  for ( auto i = store_.begin(); i != store_.end(); i++ )
-    keys.insert(i->first);
-  return expected<data>(std::move(keys));
+  return expected<data>(set{ordered_keys_});
+}
+
+expected<data> memory_backend::keys_in_range(const data& from, const data& to,
+                                             uint64_t limit) const {
+  set result;
+  auto e = ordered_keys_.end();
+  for (auto i = ordered_keys_.lower_bound(from);
+       i != e && (is<none>(to) || *i < to); ++i) {
+    result.insert(result.end(), *i);
+    if (limit > 0 && result.size() == limit)
+      break;
+  }
+  return {data{std::move(result)}};
 }
 
 expected<data> memory_backend::get(const data& key, const data& value) const {
-  auto i = store_.find(key);
+  auto i = store_.find(hashed_key{key});
   if (i == store_.end())
     return ec::no_such_key;
   // We do not use the default implementation because operating directly on the
   // stored data element is more efficient in case the visitation returns an
   // error.
-  return visit(retriever{value}, i->second.first);
+  return apply(retriever{value}, i->second.first);
 }
 
 expected<bool> memory_backend::exists(const data& key) const {
-  return store_.count(key) == 1;
+  return store_.count(hashed_key{key}) == 1;
 }
 
 expected<uint64_t> memory_backend::size() const {
@@ -102,18 +164,109 @@ expected<uint64_t> memory_backend::size() const {
 expected<snapshot> memory_backend::snapshot() const {
   broker::snapshot ss;
   for (auto& p : store_)
-    ss.emplace(p.first, p.second.first);
+    ss.emplace(p.first.value(), p.second.first);
   return {std::move(ss)};
 }
 
-expected<expirables> memory_backend::expiries() const {
-  expirables rval;
+expected<uint64_t> memory_backend::snapshot_fork() {
+  if (fork_active_)
+    return ec::unspecified;
+  // Copy-on-write at entry granularity: freezing only captures the key set.
+  // Mutations preserve the fork-time value of an entry on first touch, so
+  // taking the fork never walks the values and writes never stall.
+  fork_keys_.clear();
+  fork_keys_.reserve(store_.size());
+  for (auto& p : store_)
+    fork_keys_.emplace_back(p.first);
+  fork_pos_ = 0;
+  fork_active_ = true;
+  return fork_keys_.size();
+}
 
-  for (auto& p : store_) {
-    if (p.second.second)
-      rval.emplace_back(expirable(p.first, *p.second.second));
+expected<broker::snapshot> memory_backend::snapshot_chunk(
+  uint64_t num_entries) {
+  if (!fork_active_)
+    return ec::unspecified;
+  broker::snapshot chunk;
+  while (fork_pos_ < fork_keys_.size() && chunk.size() < num_entries) {
+    auto& key = fork_keys_[fork_pos_++];
+    if (auto o = fork_overlay_.find(key); o != fork_overlay_.end())
+      chunk.emplace(key.value(), o->second);
+    else if (auto i = store_.find(key); i != store_.end())
+      chunk.emplace(key.value(), i->second.first);
   }
+  if (fork_pos_ == fork_keys_.size())
+    snapshot_release();
+  return {std::move(chunk)};
+}
+
+void memory_backend::snapshot_release() {
+  fork_active_ = false;
+  fork_keys_.clear();
+  fork_keys_.shrink_to_fit();
+  fork_pos_ = 0;
+  fork_overlay_.clear();
+}
+
+void memory_backend::preserve(const hashed_key& key) {
+  if (!fork_active_ || fork_overlay_.count(key) != 0)
+    return;
+  if (auto i = store_.find(key); i != store_.end())
+    fork_overlay_.emplace(key, i->second.first);
+}
+
+void memory_backend::index_expiry(const data& key,
+                                  const std::optional<timestamp>& expiry) {
+  if (!expiry)
+    return;
+  // Erasures and overwrites leave their old heap entries in place; compact
+  // once the stale ones could outnumber the live entries.
+  if (expiry_heap_.size() >= 64 && expiry_heap_.size() > 2 * store_.size())
+    compact_expiry_heap();
+  expiry_heap_.emplace_back(key, *expiry);
+  std::push_heap(expiry_heap_.begin(), expiry_heap_.end(), later{});
+}
 
+void memory_backend::compact_expiry_heap() {
+  auto stale = [this](const expirable& e) {
+    auto i = store_.find(hashed_key{e.first});
+    return i == store_.end() || !i->second.second
+           || *i->second.second != e.second;
+  };
+  expiry_heap_.erase(std::remove_if(expiry_heap_.begin(), expiry_heap_.end(),
+                                    stale),
+                     expiry_heap_.end());
+  std::make_heap(expiry_heap_.begin(), expiry_heap_.end(), later{});
+}
+
+expected<data> memory_backend::stats() const {
+  // Walks all entries, but only on the stats tick of the master actor, i.e.,
+  // once per export interval.
+  size_t bytes = 0;
+  for (auto& p : store_)
+    bytes += estimated_memory_use(p.first.value())
+             + estimated_memory_use(p.second.first);
+  table result;
+  result.emplace(data{"entries"}, data{count{store_.size()}});
+  result.emplace(data{"estimated-bytes"}, data{count{bytes}});
+  return {data{std::move(result)}};
+}
+
+expected<expirables> memory_backend::expiries() const {
+  // Walks the expiry heap instead of the full store, skipping entries that an
+  // overwrite or erasure left behind. A key can appear more than once only
+  // with identical times, hence deduplication by key suffices.
+  expirables rval;
+  std::unordered_set<hashed_key> seen;
+  for (auto& e : expiry_heap_) {
+    hashed_key hk{e.first};
+    auto i = store_.find(hk);
+    if (i == store_.end() || !i->second.second
+        || *i->second.second != e.second)
+      continue;
+    if (seen.insert(std::move(hk)).second)
+      rval.emplace_back(e);
+  }
   return {std::move(rval)};
 }
 
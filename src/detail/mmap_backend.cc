@@ -0,0 +1,428 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "broker/detail/appliers.hh"
+#include "broker/detail/data_codec.hh"
+#include "broker/detail/filesystem.hh"
+#include "broker/detail/mmap_backend.hh"
+#include "broker/internal/logger.hh"
+
+namespace broker {
+namespace detail {
+
+namespace {
+
+// Log layout: an 8-byte header followed by a sequence of records. Each
+// record starts with a one-byte opcode, then the varint-framed codec
+// encoding of the key and - for puts - the value, then an 8-byte
+// little-endian expiry for records carrying one.
+constexpr char file_magic[] = {'B', 'R', 'K', 'M'};
+
+constexpr uint8_t file_version = 1;
+
+constexpr size_t header_size = 8;
+
+enum class record_op : uint8_t {
+  put = 1,
+  put_with_expiry = 2,
+  erase = 3,
+};
+
+// Compact the log at open time when it holds more than twice as many
+// records as live entries and rewriting actually pays for itself.
+constexpr uint64_t compaction_min_records = 4096;
+
+void append_value(const data& x, std::vector<std::byte>& buf) {
+  auto bytes = encode(x);
+  encode_varint(bytes.size(), buf);
+  buf.insert(buf.end(), bytes.begin(), bytes.end());
+}
+
+void append_fixed64(uint64_t x, std::vector<std::byte>& buf) {
+  for (int i = 0; i < 8; ++i)
+    buf.emplace_back(static_cast<std::byte>((x >> (i * 8)) & 0xff));
+}
+
+uint64_t read_fixed64(const std::byte* bytes) {
+  uint64_t result = 0;
+  for (int i = 0; i < 8; ++i)
+    result |= static_cast<uint64_t>(std::to_integer<uint8_t>(bytes[i]))
+              << (i * 8);
+  return result;
+}
+
+bool write_all(int fd, const void* buf, size_t size) {
+  auto pos = static_cast<const char*>(buf);
+  while (size > 0) {
+    auto n = ::write(fd, pos, size);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    pos += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+} // namespace
+
+mmap_backend::mmap_backend(backend_options opts) : options_{std::move(opts)} {
+  auto i = options_.find("path");
+  if (i == options_.end()) {
+    BROKER_ERROR("mmap backend options are missing required 'path' string");
+    return;
+  }
+  if (auto path = get_if<std::string>(&i->second)) {
+    if (!open(*path))
+      BROKER_ERROR("unable to open mmap database " << *path);
+  } else {
+    BROKER_ERROR("mmap backend option 'path' is not a string");
+  }
+}
+
+mmap_backend::~mmap_backend() {
+  if (fd_ != -1)
+    ::close(fd_);
+}
+
+bool mmap_backend::init_failed() const {
+  return fd_ == -1;
+}
+
+bool mmap_backend::open(const std::string& path) {
+  BROKER_TRACE(BROKER_ARG(path));
+  auto dir = detail::dirname(path);
+  if (!dir.empty() && !detail::is_directory(dir) && !detail::mkdirs(dir))
+    return false;
+  path_ = path;
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ == -1) {
+    BROKER_ERROR("failed to open log file:" << path << ":" << strerror(errno));
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  auto file_size = static_cast<size_t>(st.st_size);
+  if (file_size == 0) {
+    // Fresh database: write the header.
+    char header[header_size] = {file_magic[0], file_magic[1], file_magic[2],
+                                file_magic[3], static_cast<char>(file_version)};
+    if (!write_all(fd_, header, header_size)) {
+      ::close(fd_);
+      fd_ = -1;
+      return false;
+    }
+    return true;
+  }
+  if (file_size < header_size) {
+    BROKER_ERROR("mmap database too small for a header:" << path);
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  // Recovery: map the log and replay it with one sequential scan.
+  auto base = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (base == MAP_FAILED) {
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  auto bytes = static_cast<const std::byte*>(base);
+  if (memcmp(bytes, file_magic, sizeof(file_magic)) != 0
+      || std::to_integer<uint8_t>(bytes[4]) != file_version) {
+    BROKER_ERROR("unrecognized mmap database format:" << path);
+    ::munmap(base, file_size);
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  auto intact = header_size + scan(bytes + header_size,
+                                   file_size - header_size);
+  ::munmap(base, file_size);
+  if (intact < file_size) {
+    // A torn record at the tail means we crashed mid-append; drop it.
+    BROKER_WARNING("dropping" << (file_size - intact)
+                              << "bytes of torn log tail in" << path);
+    if (ftruncate(fd_, static_cast<off_t>(intact)) != 0) {
+      ::close(fd_);
+      fd_ = -1;
+      return false;
+    }
+  }
+  if (lseek(fd_, 0, SEEK_END) == -1) {
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  if (record_count_ >= compaction_min_records
+      && record_count_ > 2 * store_.size() && !compact_log()) {
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  return true;
+}
+
+size_t mmap_backend::scan(const void* first, size_t size) {
+  auto bytes = static_cast<const std::byte*>(first);
+  size_t pos = 0;
+  auto read_data = [&](data& out) {
+    uint64_t frame = 0;
+    auto n = decode_varint(bytes + pos, size - pos, frame);
+    if (n == 0 || frame > size - pos - n)
+      return false;
+    auto x = decode(bytes + pos + n, frame);
+    if (!x)
+      return false;
+    out = std::move(*x);
+    pos += n + frame;
+    return true;
+  };
+  while (pos < size) {
+    auto record_start = pos;
+    auto op = static_cast<record_op>(std::to_integer<uint8_t>(bytes[pos]));
+    ++pos;
+    data key;
+    if (!read_data(key))
+      return record_start;
+    switch (op) {
+      default:
+        return record_start;
+      case record_op::erase:
+        store_.erase(key);
+        break;
+      case record_op::put:
+      case record_op::put_with_expiry: {
+        data value;
+        if (!read_data(value))
+          return record_start;
+        std::optional<timestamp> expiry;
+        if (op == record_op::put_with_expiry) {
+          if (size - pos < 8)
+            return record_start;
+          expiry = timestamp{timespan{
+            static_cast<int64_t>(read_fixed64(bytes + pos))}};
+          pos += 8;
+        }
+        store_[std::move(key)] = {std::move(value), expiry};
+        break;
+      }
+    }
+    ++record_count_;
+  }
+  return pos;
+}
+
+bool mmap_backend::append_put(const data& key, const data& value,
+                              const std::optional<timestamp>& expiry) {
+  std::vector<std::byte> rec;
+  rec.emplace_back(static_cast<std::byte>(
+    expiry ? record_op::put_with_expiry : record_op::put));
+  append_value(key, rec);
+  append_value(value, rec);
+  if (expiry)
+    append_fixed64(
+      static_cast<uint64_t>(expiry->time_since_epoch().count()), rec);
+  if (!write_all(fd_, rec.data(), rec.size()))
+    return false;
+  ++record_count_;
+  return true;
+}
+
+bool mmap_backend::append_erase(const data& key) {
+  std::vector<std::byte> rec;
+  rec.emplace_back(static_cast<std::byte>(record_op::erase));
+  append_value(key, rec);
+  if (!write_all(fd_, rec.data(), rec.size()))
+    return false;
+  ++record_count_;
+  return true;
+}
+
+bool mmap_backend::compact_log() {
+  auto tmp_path = path_ + ".compact";
+  auto tmp_fd = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (tmp_fd == -1)
+    return false;
+  char header[header_size] = {file_magic[0], file_magic[1], file_magic[2],
+                              file_magic[3], static_cast<char>(file_version)};
+  auto ok = write_all(tmp_fd, header, header_size);
+  for (auto i = store_.begin(); ok && i != store_.end(); ++i) {
+    std::vector<std::byte> rec;
+    rec.emplace_back(static_cast<std::byte>(
+      i->second.second ? record_op::put_with_expiry : record_op::put));
+    append_value(i->first, rec);
+    append_value(i->second.first, rec);
+    if (i->second.second)
+      append_fixed64(static_cast<uint64_t>(
+                       i->second.second->time_since_epoch().count()),
+                     rec);
+    ok = write_all(tmp_fd, rec.data(), rec.size());
+  }
+  if (!ok || fsync(tmp_fd) != 0
+      || ::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+    ::close(tmp_fd);
+    ::unlink(tmp_path.c_str());
+    return false;
+  }
+  ::close(fd_);
+  fd_ = tmp_fd;
+  record_count_ = store_.size();
+  return lseek(fd_, 0, SEEK_END) != -1;
+}
+
+expected<void> mmap_backend::put(const data& key, data value,
+                                 std::optional<timestamp> expiry) {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  if (!append_put(key, value, expiry))
+    return ec::backend_failure;
+  store_[key] = {std::move(value), expiry};
+  return {};
+}
+
+expected<void> mmap_backend::add(const data& key, const data& value,
+                                 data::type init_type,
+                                 std::optional<timestamp> expiry) {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  auto i = store_.find(key);
+  if (i == store_.end()) {
+    if (init_type == data::type::none)
+      return ec::type_clash;
+    i = store_.emplace(key, std::make_pair(data::from_type(init_type), expiry))
+          .first;
+  }
+  auto result = apply(adder{value}, i->second.first);
+  if (!result)
+    return result;
+  i->second.second = expiry;
+  if (!append_put(key, i->second.first, expiry))
+    return ec::backend_failure;
+  return {};
+}
+
+expected<void> mmap_backend::subtract(const data& key, const data& value,
+                                      std::optional<timestamp> expiry) {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  auto i = store_.find(key);
+  if (i == store_.end())
+    return ec::no_such_key;
+  auto result = apply(remover{value}, i->second.first);
+  if (!result)
+    return result;
+  i->second.second = expiry;
+  if (!append_put(key, i->second.first, expiry))
+    return ec::backend_failure;
+  return {};
+}
+
+expected<void> mmap_backend::erase(const data& key) {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  if (!append_erase(key))
+    return ec::backend_failure;
+  store_.erase(key);
+  return {};
+}
+
+expected<void> mmap_backend::clear() {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  if (ftruncate(fd_, header_size) != 0
+      || lseek(fd_, 0, SEEK_END) == -1)
+    return ec::backend_failure;
+  store_.clear();
+  record_count_ = 0;
+  return {};
+}
+
+expected<void> mmap_backend::compact() {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  if (!compact_log())
+    return ec::backend_failure;
+  return {};
+}
+
+expected<bool> mmap_backend::expire(const data& key, timestamp ts) {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  auto i = store_.find(key);
+  if (i == store_.end())
+    return false;
+  if (!i->second.second || ts < i->second.second)
+    return false;
+  if (!append_erase(key))
+    return ec::backend_failure;
+  store_.erase(i);
+  return true;
+}
+
+expected<data> mmap_backend::get(const data& key) const {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  auto i = store_.find(key);
+  if (i == store_.end())
+    return ec::no_such_key;
+  return i->second.first;
+}
+
+expected<bool> mmap_backend::exists(const data& key) const {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  return store_.count(key) == 1;
+}
+
+expected<uint64_t> mmap_backend::size() const {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  return store_.size();
+}
+
+expected<data> mmap_backend::keys() const {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  set result;
+  for (auto& p : store_)
+    result.insert(p.first);
+  return {data{std::move(result)}};
+}
+
+expected<broker::snapshot> mmap_backend::snapshot() const {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  broker::snapshot ss;
+  for (auto& p : store_)
+    ss.emplace(p.first, p.second.first);
+  return {std::move(ss)};
+}
+
+expected<expirables> mmap_backend::expiries() const {
+  if (fd_ == -1)
+    return ec::backend_failure;
+  expirables rval;
+  for (auto& p : store_)
+    if (p.second.second)
+      rval.emplace_back(expirable(p.first, *p.second.second));
+  return {std::move(rval)};
+}
+
+} // namespace detail
+} // namespace broker
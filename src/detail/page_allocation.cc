@@ -0,0 +1,89 @@
+#include "broker/detail/page_allocation.hh"
+
+#include <cstdint>
+
+#include "broker/config.hh"
+
+#ifndef BROKER_WINDOWS
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef BROKER_LINUX
+#include <sys/syscall.h>
+#endif
+
+namespace broker::detail {
+
+size_t page_size() noexcept {
+#ifdef BROKER_WINDOWS
+  return 4096;
+#else
+  static const auto cached = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  return cached;
+#endif
+}
+
+void* allocate_pages(size_t num_bytes, [[maybe_unused]] bool huge_pages) noexcept {
+#ifdef BROKER_WINDOWS
+  // Windows builds always use the global allocator.
+  return nullptr;
+#else
+#if defined(BROKER_LINUX) && defined(MAP_HUGETLB)
+  if (huge_pages) {
+    auto ptr = ::mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED)
+      return ptr;
+    // No pre-reserved huge pages available: fall through to regular pages
+    // and ask the kernel to back them with transparent huge pages instead.
+  }
+#endif
+  auto ptr = ::mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED)
+    return nullptr;
+#if defined(BROKER_LINUX) && defined(MADV_HUGEPAGE)
+  if (huge_pages)
+    ::madvise(ptr, num_bytes, MADV_HUGEPAGE);
+#endif
+  return ptr;
+#endif
+}
+
+void deallocate_pages(void* ptr, size_t num_bytes) noexcept {
+#ifndef BROKER_WINDOWS
+  if (ptr != nullptr)
+    ::munmap(ptr, num_bytes);
+#else
+  static_cast<void>(ptr);
+  static_cast<void>(num_bytes);
+#endif
+}
+
+bool bind_to_numa_node(void* ptr, size_t num_bytes, int node) noexcept {
+#if defined(BROKER_LINUX) && defined(SYS_mbind)
+  using mask_type = unsigned long;
+  if (ptr == nullptr || node < 0
+      || static_cast<size_t>(node) >= 8 * sizeof(mask_type))
+    return false;
+  // mbind operates on whole pages and requires an aligned start address.
+  auto ps = page_size();
+  auto begin = reinterpret_cast<uintptr_t>(ptr) & ~(ps - 1);
+  auto end = (reinterpret_cast<uintptr_t>(ptr) + num_bytes + ps - 1) & ~(ps - 1);
+  mask_type mask = mask_type{1} << node;
+  // MPOL_PREFERRED (1) keeps the binding a hint, i.e., the OS falls back to
+  // other nodes instead of failing allocations when the target node is full.
+  // MPOL_MF_MOVE (2) migrates pages that were already faulted in elsewhere.
+  return ::syscall(SYS_mbind, begin, end - begin, 1, &mask, 8 * sizeof(mask),
+                   2ul)
+         == 0;
+#else
+  static_cast<void>(ptr);
+  static_cast<void>(num_bytes);
+  static_cast<void>(node);
+  return false;
+#endif
+}
+
+} // namespace broker::detail
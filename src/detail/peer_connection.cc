@@ -0,0 +1,415 @@
+#include "broker/detail/peer_connection.hh"
+
+#include <cerrno>
+#include <utility>
+
+#include "broker/detail/data_codec.hh"
+#include "broker/detail/preset_dictionary.hh"
+#include "broker/error.hh"
+
+#ifdef BROKER_WINDOWS
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifdef BROKER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace broker::detail {
+
+namespace {
+
+/// Default flow-control window when the handshake does not override it.
+constexpr uint32_t default_window = 512;
+
+/// Message payloads below this size always travel uncompressed.
+constexpr size_t compression_threshold = 64;
+
+/// Upper bound for the uncompressed size of a single frame, guarding the
+/// decompressor against hostile size prefixes.
+constexpr uint64_t max_uncompressed_frame = uint64_t{1} << 30;
+
+/// Returns the compression bits this build can serve. The preset dictionary
+/// bit additionally requires installed dictionaries; the handshake functions
+/// mask it separately.
+uint8_t supported_compression() {
+#ifdef BROKER_HAVE_ZLIB
+  return peer_compression_zlib | peer_compression_zlib_dict;
+#else
+  return 0;
+#endif
+}
+
+void close_socket(native_socket fd) {
+  if (fd == invalid_native_socket)
+    return;
+#ifdef BROKER_WINDOWS
+  ::closesocket(fd);
+#else
+  ::close(fd);
+#endif
+}
+
+bool is_message(frame_type x) {
+  return x == frame_type::data_msg || x == frame_type::command_msg
+         || x == frame_type::data_batch;
+}
+
+} // namespace
+
+peer_connection::peer_connection(native_socket fd) : fd_(fd) {
+  // nop
+}
+
+peer_connection::peer_connection(peer_connection&& other) noexcept
+  : fd_(other.fd_),
+    send_credit_(other.send_credit_),
+    recv_window_(other.recv_window_),
+    consumed_(other.consumed_),
+    compress_(other.compress_),
+    write_dict_(other.write_dict_),
+    read_dicts_(other.read_dicts_),
+    dict_send_(other.dict_send_),
+    dict_recv_(other.dict_recv_),
+    sent_(other.sent_),
+    received_(other.received_),
+    backlog_(std::move(other.backlog_)),
+    write_buf_(std::move(other.write_buf_)) {
+  other.fd_ = invalid_native_socket;
+}
+
+peer_connection& peer_connection::operator=(peer_connection&& other) noexcept {
+  if (this != &other) {
+    close_socket(fd_);
+    fd_ = other.fd_;
+    send_credit_ = other.send_credit_;
+    recv_window_ = other.recv_window_;
+    consumed_ = other.consumed_;
+    compress_ = other.compress_;
+    write_dict_ = other.write_dict_;
+    read_dicts_ = other.read_dicts_;
+    dict_send_ = other.dict_send_;
+    dict_recv_ = other.dict_recv_;
+    sent_ = other.sent_;
+    received_ = other.received_;
+    backlog_ = std::move(other.backlog_);
+    write_buf_ = std::move(other.write_buf_);
+    other.fd_ = invalid_native_socket;
+  }
+  return *this;
+}
+
+peer_connection::~peer_connection() {
+  close_socket(fd_);
+}
+
+expected<handshake_info>
+peer_connection::originate_handshake(const handshake_info& local) {
+  auto hs = local;
+  if (hs.initial_credit == 0)
+    hs.initial_credit = default_window;
+  hs.compression &= supported_compression();
+  if (read_dicts_ == nullptr || read_dicts_->empty())
+    hs.compression &= ~peer_compression_zlib_dict;
+  recv_window_ = hs.initial_credit;
+  std::vector<std::byte> payload;
+  encode(hs, payload);
+  if (auto res = write_frame(frame_type::handshake, payload.data(),
+                             payload.size());
+      !res)
+    return res.error();
+  frame ack;
+  if (auto res = read_frame(ack); !res)
+    return res.error();
+  if (ack.type != frame_type::handshake_ack)
+    return {ec::peer_disconnect_during_handshake};
+  auto remote = decode_handshake(ack.payload.data(), ack.payload.size());
+  if (remote) {
+    send_credit_ = remote->initial_credit;
+    negotiate_compression(hs.compression, remote->compression);
+  }
+  return remote;
+}
+
+expected<handshake_info>
+peer_connection::respond_handshake(const handshake_info& local) {
+  frame req;
+  if (auto res = read_frame(req); !res)
+    return res.error();
+  if (req.type != frame_type::handshake)
+    return {ec::peer_disconnect_during_handshake};
+  auto remote = decode_handshake(req.payload.data(), req.payload.size());
+  if (!remote)
+    return remote;
+  send_credit_ = remote->initial_credit;
+  auto hs = local;
+  if (hs.initial_credit == 0)
+    hs.initial_credit = default_window;
+  hs.compression &= supported_compression();
+  if (read_dicts_ == nullptr || read_dicts_->empty())
+    hs.compression &= ~peer_compression_zlib_dict;
+  negotiate_compression(hs.compression, remote->compression);
+  recv_window_ = hs.initial_credit;
+  std::vector<std::byte> payload;
+  encode(hs, payload);
+  if (auto res = write_frame(frame_type::handshake_ack, payload.data(),
+                             payload.size());
+      !res)
+    return res.error();
+  return remote;
+}
+
+expected<void> peer_connection::send(frame_type type, const std::byte* payload,
+                                     size_t size) {
+  if (is_message(type)) {
+    // Pump incoming frames until the peer grants fresh credit. Anything that
+    // is not handled internally queues up for the next read().
+    while (send_credit_ == 0) {
+      frame x;
+      if (auto res = read_frame(x); !res)
+        return res.error();
+      if (x.type != frame_type::credit)
+        backlog_.push_back(std::move(x));
+    }
+    --send_credit_;
+#ifdef BROKER_HAVE_ZLIB
+    if ((compress_ || dict_send_) && size >= compression_threshold) {
+      std::vector<std::byte> zbuf;
+      encode_varint(size, zbuf);
+      auto prefix = zbuf.size();
+      // Prefer the preset dictionary; fall back to plain deflate, which the
+      // remote side accepts either way.
+      auto ok = dict_send_ && deflate_bytes(payload, size, write_dict_, zbuf);
+      if (!ok && compress_) {
+        auto bound = compressBound(static_cast<uLong>(size));
+        zbuf.resize(prefix + bound);
+        auto zsize = static_cast<uLongf>(bound);
+        ok = compress2(reinterpret_cast<Bytef*>(zbuf.data() + prefix), &zsize,
+                       reinterpret_cast<const Bytef*>(payload),
+                       static_cast<uLong>(size), Z_DEFAULT_COMPRESSION)
+             == Z_OK;
+        if (ok)
+          zbuf.resize(prefix + zsize);
+      }
+      if (ok && zbuf.size() < size) {
+        sent_.raw += size;
+        sent_.wire += zbuf.size();
+        auto ztype = frame_type::command_msg_z;
+        if (type == frame_type::data_msg)
+          ztype = frame_type::data_msg_z;
+        else if (type == frame_type::data_batch)
+          ztype = frame_type::data_batch_z;
+        return write_frame(ztype, zbuf.data(), zbuf.size());
+      }
+    }
+#endif
+    sent_.raw += size;
+    sent_.wire += size;
+  }
+  return write_frame(type, payload, size);
+}
+
+expected<peer_connection::frame> peer_connection::read() {
+  if (!backlog_.empty()) {
+    auto result = std::move(backlog_.front());
+    backlog_.erase(backlog_.begin());
+    return result;
+  }
+  frame result;
+  do {
+    if (auto res = read_frame(result); !res)
+      return res.error();
+  } while (result.type == frame_type::credit);
+  return result;
+}
+
+native_socket peer_connection::release() noexcept {
+  return std::exchange(fd_, invalid_native_socket);
+}
+
+expected<void> peer_connection::write_frame(frame_type type,
+                                            const std::byte* payload,
+                                            size_t size) {
+  if (!valid())
+    return {ec::unspecified};
+  write_buf_.clear();
+  encode(frame_header{static_cast<uint32_t>(size), type}, write_buf_);
+#ifndef BROKER_WINDOWS
+  // Gather-write header and payload in one syscall instead of copying the
+  // payload into the scratch buffer first. Besides saving the copy, a single
+  // write keeps each frame in one TLS record on kernel-TLS sockets.
+  iovec iov[2];
+  iov[0].iov_base = write_buf_.data();
+  iov[0].iov_len = write_buf_.size();
+  iov[1].iov_base = const_cast<std::byte*>(payload);
+  iov[1].iov_len = size;
+  size_t index = 0;
+  while (index < 2) {
+    auto res = ::writev(fd_, iov + index, static_cast<int>(2 - index));
+    if (res < 0) {
+      if (errno == EINTR)
+        continue;
+      return {ec::unspecified};
+    }
+    auto written = static_cast<size_t>(res);
+    while (index < 2 && written >= iov[index].iov_len) {
+      written -= iov[index].iov_len;
+      ++index;
+    }
+    if (index < 2 && written > 0) {
+      iov[index].iov_base = static_cast<std::byte*>(iov[index].iov_base)
+                            + written;
+      iov[index].iov_len -= written;
+    }
+  }
+#else // BROKER_WINDOWS
+  write_buf_.insert(write_buf_.end(), payload, payload + size);
+  auto remaining = write_buf_.size();
+  auto pos = write_buf_.data();
+  while (remaining > 0) {
+    auto res = ::send(fd_, reinterpret_cast<const char*>(pos),
+                      static_cast<int>(remaining), 0);
+    if (res < 0) {
+      if (errno == EINTR)
+        continue;
+      return {ec::unspecified};
+    }
+    pos += res;
+    remaining -= static_cast<size_t>(res);
+  }
+#endif // BROKER_WINDOWS
+  return {};
+}
+
+expected<void> peer_connection::read_exactly(std::byte* buf, size_t size) {
+  while (size > 0) {
+    auto res = ::recv(fd_, reinterpret_cast<char*>(buf),
+                      static_cast<int>(size), 0);
+    if (res == 0)
+      return {ec::end_of_file};
+    if (res < 0) {
+      if (errno == EINTR)
+        continue;
+      return {ec::unspecified};
+    }
+    buf += res;
+    size -= static_cast<size_t>(res);
+  }
+  return {};
+}
+
+expected<void> peer_connection::read_frame(frame& result) {
+  if (!valid())
+    return {ec::unspecified};
+  for (;;) {
+    std::byte header_bytes[frame_header_size];
+    if (auto res = read_exactly(header_bytes, frame_header_size); !res)
+      return res;
+    auto hdr = decode_frame_header(header_bytes);
+    if (!hdr)
+      return hdr.error();
+    result.type = hdr->type;
+    result.payload.resize(hdr->payload_size);
+    if (hdr->payload_size > 0)
+      if (auto res = read_exactly(result.payload.data(), hdr->payload_size);
+          !res)
+        return res;
+    switch (hdr->type) {
+      case frame_type::credit: {
+        uint64_t granted = 0;
+        if (decode_varint(result.payload.data(), result.payload.size(),
+                          granted)
+            == 0)
+          return {ec::invalid_data};
+        send_credit_ += static_cast<uint32_t>(granted);
+        // Surfaces to send() so a blocked credit pump regains control; the
+        // public read() skips over it.
+        return {};
+      }
+      case frame_type::ping:
+        if (auto res = write_frame(frame_type::pong, nullptr, 0); !res)
+          return res;
+        continue;
+      case frame_type::pong:
+        continue;
+      case frame_type::bye:
+        return {ec::end_of_file};
+      case frame_type::data_msg_z:
+      case frame_type::command_msg_z:
+      case frame_type::data_batch_z: {
+#ifdef BROKER_HAVE_ZLIB
+        uint64_t raw_size = 0;
+        auto n = decode_varint(result.payload.data(), result.payload.size(),
+                               raw_size);
+        if (n == 0 || raw_size > max_uncompressed_frame)
+          return {ec::invalid_data};
+        std::vector<std::byte> raw(static_cast<size_t>(raw_size));
+        if (dict_recv_) {
+          // Also accepts streams without a dictionary, so the sender may mix
+          // both forms freely.
+          if (!inflate_bytes(result.payload.data() + n,
+                             result.payload.size() - n, read_dicts_, raw))
+            return {ec::invalid_data};
+        } else {
+          auto out_size = static_cast<uLongf>(raw_size);
+          if (uncompress(reinterpret_cast<Bytef*>(raw.data()), &out_size,
+                         reinterpret_cast<const Bytef*>(result.payload.data()
+                                                        + n),
+                         static_cast<uLong>(result.payload.size() - n))
+                != Z_OK
+              || out_size != raw_size)
+            return {ec::invalid_data};
+        }
+        result.payload = std::move(raw);
+        if (hdr->type == frame_type::data_msg_z)
+          result.type = frame_type::data_msg;
+        else if (hdr->type == frame_type::data_batch_z)
+          result.type = frame_type::data_batch;
+        else
+          result.type = frame_type::command_msg;
+        break;
+#else
+        // The peer may only send compressed frames after we offered
+        // compression in the handshake, which this build never does.
+        return {ec::invalid_data};
+#endif
+      }
+      default:
+        break;
+    }
+    if (is_message(result.type)) {
+      received_.raw += result.payload.size();
+      received_.wire += hdr->payload_size;
+      ++consumed_;
+      if (auto res = replenish_credit(); !res)
+        return res;
+    }
+    return {};
+  }
+}
+
+void peer_connection::negotiate_compression(uint8_t local_bits,
+                                            uint8_t remote_bits) {
+  compress_ = (local_bits & remote_bits & peer_compression_zlib) != 0;
+  // The dictionary bit is direction-specific: the remote bit permits
+  // deflating outgoing payloads against the installed dictionary, the local
+  // bit obliges us to resolve preset dictionaries on the receive path.
+  dict_send_ = write_dict_ != nullptr
+               && (remote_bits & peer_compression_zlib_dict) != 0;
+  dict_recv_ = (local_bits & peer_compression_zlib_dict) != 0;
+}
+
+expected<void> peer_connection::replenish_credit() {
+  if (recv_window_ == 0 || consumed_ < recv_window_ / 2)
+    return {};
+  std::vector<std::byte> payload;
+  encode_varint(consumed_, payload);
+  consumed_ = 0;
+  return write_frame(frame_type::credit, payload.data(), payload.size());
+}
+
+} // namespace broker::detail
@@ -0,0 +1,198 @@
+#include "broker/detail/peer_listener.hh"
+
+#ifndef BROKER_WINDOWS
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "broker/error.hh"
+
+namespace broker::detail {
+
+namespace {
+
+void close_socket(native_socket fd) {
+  if (fd != invalid_native_socket)
+    ::close(fd);
+}
+
+/// Creates one listening socket bound to `host`/`service` with address
+/// reuse enabled. Returns the socket and fills `bound_port` with the port
+/// the kernel assigned.
+expected<native_socket> make_listen_socket(const char* host,
+                                           const std::string& service,
+                                           uint16_t& bound_port) {
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  addrinfo* res = nullptr;
+  if (getaddrinfo(host, service.c_str(), &hints, &res) != 0 || res == nullptr)
+    return {ec::unspecified};
+  auto fd = ::socket(res->ai_family, SOCK_STREAM, 0);
+  if (fd < 0) {
+    freeaddrinfo(res);
+    return {ec::unspecified};
+  }
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#ifdef SO_REUSEPORT
+  setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+#endif
+  auto ok = ::bind(fd, res->ai_addr, res->ai_addrlen) == 0
+            && ::listen(fd, SOMAXCONN) == 0;
+  freeaddrinfo(res);
+  if (!ok) {
+    ::close(fd);
+    return {ec::unspecified};
+  }
+  sockaddr_storage addr;
+  socklen_t len = sizeof(addr);
+  if (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    ::close(fd);
+    return {ec::unspecified};
+  }
+  if (addr.ss_family == AF_INET)
+    bound_port = ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+  else
+    bound_port = ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+  return fd;
+}
+
+} // namespace
+
+expected<peer_listener> peer_listener::make(const std::string& address,
+                                            uint16_t port,
+                                            size_t num_listeners) {
+  if (num_listeners == 0)
+    num_listeners = 1;
+#ifndef SO_REUSEPORT
+  // Without SO_REUSEPORT, a second bind to the same port fails.
+  num_listeners = 1;
+#endif
+  peer_listener result;
+  int pipe_fds[2];
+  if (::pipe(pipe_fds) != 0)
+    return {ec::unspecified};
+  result.wakeup_read_ = pipe_fds[0];
+  result.wakeup_write_ = pipe_fds[1];
+  auto host = address.empty() ? nullptr : address.c_str();
+  result.port_ = port;
+  for (size_t i = 0; i < num_listeners; ++i) {
+    // After the first socket bound an ephemeral port, the remaining sockets
+    // must share that concrete port.
+    auto fd = make_listen_socket(host, std::to_string(result.port_),
+                                 result.port_);
+    if (!fd)
+      return fd.error();
+    result.fds_.push_back(*fd);
+  }
+  return result;
+}
+
+peer_listener::peer_listener(peer_listener&& other) noexcept
+  : fds_(std::move(other.fds_)),
+    threads_(std::move(other.threads_)),
+    on_accept_(std::move(other.on_accept_)),
+    gate_(other.gate_),
+    wakeup_read_(other.wakeup_read_),
+    wakeup_write_(other.wakeup_write_),
+    port_(other.port_) {
+  other.fds_.clear();
+  other.wakeup_read_ = invalid_native_socket;
+  other.wakeup_write_ = invalid_native_socket;
+}
+
+peer_listener& peer_listener::operator=(peer_listener&& other) noexcept {
+  if (this != &other) {
+    stop();
+    fds_ = std::move(other.fds_);
+    threads_ = std::move(other.threads_);
+    on_accept_ = std::move(other.on_accept_);
+    gate_ = other.gate_;
+    wakeup_read_ = other.wakeup_read_;
+    wakeup_write_ = other.wakeup_write_;
+    port_ = other.port_;
+    other.fds_.clear();
+    other.wakeup_read_ = invalid_native_socket;
+    other.wakeup_write_ = invalid_native_socket;
+  }
+  return *this;
+}
+
+peer_listener::~peer_listener() {
+  stop();
+}
+
+void peer_listener::start(accept_callback f) {
+  on_accept_ = std::move(f);
+  threads_.reserve(fds_.size());
+  for (auto fd : fds_)
+    threads_.emplace_back([this, fd] { accept_loop(fd); });
+}
+
+void peer_listener::stop() {
+  if (wakeup_write_ != invalid_native_socket) {
+    // One byte suffices: no thread ever drains the pipe, so every poll on the
+    // read end turns readable at once.
+    char dummy = 0;
+    [[maybe_unused]] auto unused = ::write(wakeup_write_, &dummy, 1);
+  }
+  for (auto& hdl : threads_)
+    hdl.join();
+  threads_.clear();
+  for (auto fd : fds_)
+    close_socket(fd);
+  fds_.clear();
+  close_socket(wakeup_read_);
+  close_socket(wakeup_write_);
+  wakeup_read_ = invalid_native_socket;
+  wakeup_write_ = invalid_native_socket;
+}
+
+void peer_listener::accept_loop(native_socket fd) {
+  for (;;) {
+    pollfd fds[] = {
+      {fd, POLLIN, 0},
+      {wakeup_read_, POLLIN, 0},
+    };
+    if (::poll(fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+    if (fds[1].revents != 0)
+      return;
+    if (fds[0].revents == 0)
+      continue;
+    auto client = ::accept(fd, nullptr, nullptr);
+    if (client < 0) {
+      // Transient conditions (aborted connections, descriptor pressure) keep
+      // the loop alive; anything else ends it.
+      if (errno == EINTR || errno == ECONNABORTED || errno == EMFILE
+          || errno == ENFILE)
+        continue;
+      return;
+    }
+    if (gate_ != nullptr && !gate_->try_admit()) {
+      // Denied during a reconnect storm: closing right away lets the remote
+      // side fail fast and retry with backoff instead of timing out on an
+      // unanswered handshake.
+      ::close(client);
+      continue;
+    }
+    on_accept_(client);
+  }
+}
+
+} // namespace broker::detail
+
+#endif // BROKER_WINDOWS
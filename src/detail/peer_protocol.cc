@@ -0,0 +1,216 @@
+#include "broker/detail/peer_protocol.hh"
+
+#include <limits>
+
+#include "broker/detail/assert.hh"
+#include "broker/detail/data_codec.hh"
+#include "broker/error.hh"
+#include "broker/message.hh"
+#include "broker/topic.hh"
+
+namespace broker::detail {
+
+namespace {
+
+void put_u32(uint32_t x, std::vector<std::byte>& buf) {
+  buf.push_back(static_cast<std::byte>((x >> 24) & 0xff));
+  buf.push_back(static_cast<std::byte>((x >> 16) & 0xff));
+  buf.push_back(static_cast<std::byte>((x >> 8) & 0xff));
+  buf.push_back(static_cast<std::byte>(x & 0xff));
+}
+
+uint32_t get_u32(const std::byte* bytes) {
+  return (static_cast<uint32_t>(bytes[0]) << 24)
+         | (static_cast<uint32_t>(bytes[1]) << 16)
+         | (static_cast<uint32_t>(bytes[2]) << 8)
+         | static_cast<uint32_t>(bytes[3]);
+}
+
+void put_string(const std::string& x, std::vector<std::byte>& buf) {
+  encode_varint(x.size(), buf);
+  auto bytes = reinterpret_cast<const std::byte*>(x.data());
+  buf.insert(buf.end(), bytes, bytes + x.size());
+}
+
+bool get_string(const std::byte*& first, const std::byte* last,
+                std::string& x) {
+  uint64_t size = 0;
+  auto n = decode_varint(first, static_cast<size_t>(last - first), size);
+  if (n == 0 || size > static_cast<uint64_t>(last - (first + n)))
+    return false;
+  first += n;
+  x.assign(reinterpret_cast<const char*>(first), static_cast<size_t>(size));
+  first += size;
+  return true;
+}
+
+} // namespace
+
+const char* to_string(frame_type x) {
+  switch (x) {
+    case frame_type::handshake:
+      return "handshake";
+    case frame_type::handshake_ack:
+      return "handshake_ack";
+    case frame_type::data_msg:
+      return "data_msg";
+    case frame_type::command_msg:
+      return "command_msg";
+    case frame_type::data_msg_z:
+      return "data_msg_z";
+    case frame_type::command_msg_z:
+      return "command_msg_z";
+    case frame_type::filter_update:
+      return "filter_update";
+    case frame_type::credit:
+      return "credit";
+    case frame_type::ping:
+      return "ping";
+    case frame_type::pong:
+      return "pong";
+    case frame_type::bye:
+      return "bye";
+    case frame_type::data_batch:
+      return "data_batch";
+    case frame_type::data_batch_z:
+      return "data_batch_z";
+    default:
+      return "invalid";
+  }
+}
+
+void encode(const frame_header& hdr, std::vector<std::byte>& buf) {
+  put_u32(hdr.payload_size, buf);
+  buf.push_back(static_cast<std::byte>(hdr.type));
+}
+
+expected<frame_header> decode_frame_header(const std::byte* bytes) {
+  frame_header result;
+  result.payload_size = get_u32(bytes);
+  auto tag = static_cast<uint8_t>(bytes[4]);
+  if (tag > static_cast<uint8_t>(frame_type::data_batch_z))
+    return {ec::invalid_tag};
+  result.type = static_cast<frame_type>(tag);
+  return result;
+}
+
+void encode(const handshake_info& hs, std::vector<std::byte>& buf) {
+  put_u32(peer_protocol_magic, buf);
+  buf.push_back(static_cast<std::byte>(peer_protocol_version));
+  put_string(hs.id, buf);
+  encode_varint(hs.initial_credit, buf);
+  buf.push_back(static_cast<std::byte>(hs.compression));
+  buf.push_back(static_cast<std::byte>(hs.features));
+  encode_varint(hs.datagram_port, buf);
+  encode_varint(hs.filter.size(), buf);
+  for (auto& x : hs.filter)
+    put_string(x.string(), buf);
+}
+
+expected<handshake_info> decode_handshake(const std::byte* first,
+                                          size_t size) {
+  auto last = first + size;
+  if (size < sizeof(uint32_t) + 1)
+    return {ec::invalid_data};
+  if (get_u32(first) != peer_protocol_magic)
+    return {ec::peer_incompatible};
+  first += sizeof(uint32_t);
+  if (static_cast<uint8_t>(*first++) != peer_protocol_version)
+    return {ec::peer_incompatible};
+  handshake_info result;
+  if (!get_string(first, last, result.id))
+    return {ec::invalid_data};
+  uint64_t credit = 0;
+  auto n = decode_varint(first, static_cast<size_t>(last - first), credit);
+  if (n == 0 || credit > std::numeric_limits<uint32_t>::max())
+    return {ec::invalid_data};
+  first += n;
+  result.initial_credit = static_cast<uint32_t>(credit);
+  if (first == last)
+    return {ec::invalid_data};
+  result.compression = static_cast<uint8_t>(*first++);
+  if (first == last)
+    return {ec::invalid_data};
+  result.features = static_cast<uint8_t>(*first++);
+  uint64_t port = 0;
+  n = decode_varint(first, static_cast<size_t>(last - first), port);
+  if (n == 0 || port > std::numeric_limits<uint16_t>::max())
+    return {ec::invalid_data};
+  first += n;
+  result.datagram_port = static_cast<uint16_t>(port);
+  uint64_t num_topics = 0;
+  n = decode_varint(first, static_cast<size_t>(last - first), num_topics);
+  // Every topic consumes at least one payload byte, so a count beyond the
+  // remaining bytes is malformed; checking before the reserve keeps hostile
+  // counts from forcing huge allocations.
+  if (n == 0 || num_topics > static_cast<size_t>(last - first) - n)
+    return {ec::invalid_data};
+  first += n;
+  result.filter.reserve(static_cast<size_t>(num_topics));
+  for (uint64_t i = 0; i < num_topics; ++i) {
+    std::string str;
+    if (!get_string(first, last, str))
+      return {ec::invalid_data};
+    result.filter.emplace_back(std::move(str));
+  }
+  if (first != last)
+    return {ec::invalid_data};
+  return result;
+}
+
+size_t homogeneous_run(const data_message* msgs, size_t num) {
+  if (num == 0)
+    return 0;
+  const auto& shared = get_topic(msgs[0]);
+  size_t n = 1;
+  while (n < num && get_topic(msgs[n]) == shared)
+    ++n;
+  return n;
+}
+
+void encode_data_batch(const data_message* msgs, size_t num,
+                       std::vector<std::byte>& buf) {
+  BROKER_ASSERT(homogeneous_run(msgs, num) == num);
+  put_string(get_topic(msgs[0]).string(), buf);
+  encode_varint(num, buf);
+  for (size_t i = 0; i < num; ++i)
+    encode(get_data(msgs[i]), buf);
+}
+
+expected<std::vector<data_message>> decode_data_batch(const std::byte* first,
+                                                      size_t size) {
+  auto last = first + size;
+  std::string str;
+  if (!get_string(first, last, str))
+    return {ec::invalid_data};
+  topic shared{std::move(str)};
+  uint64_t num = 0;
+  auto n = decode_varint(first, static_cast<size_t>(last - first), num);
+  if (n == 0 || num > size)
+    return {ec::invalid_data};
+  first += n;
+  std::vector<data_message> result;
+  result.reserve(static_cast<size_t>(num));
+  field_reader in{first, last};
+  for (uint64_t i = 0; i < num; ++i) {
+    data value;
+    if (!decode_field(in, value))
+      return {ec::invalid_data};
+    result.emplace_back(make_data_message(shared, std::move(value)));
+  }
+  if (in.pos != in.end)
+    return {ec::invalid_data};
+  return result;
+}
+
+bool peek_topic(const std::byte* first, size_t size, std::string_view& out) {
+  uint64_t len = 0;
+  auto n = decode_varint(first, size, len);
+  if (n == 0 || len > size - n)
+    return false;
+  out = std::string_view{reinterpret_cast<const char*>(first + n),
+                         static_cast<size_t>(len)};
+  return true;
+}
+
+} // namespace broker::detail
@@ -1,15 +1,100 @@
 #include "broker/detail/prefix_matcher.hh"
 
+#include <string_view>
+
 namespace broker {
 namespace detail {
 
+namespace {
+
+/// Splits off the next segment of `str`, skipping a leading separator.
+std::string_view next_segment(std::string_view& str) noexcept {
+  if (!str.empty() && str.front() == topic::sep)
+    str.remove_prefix(1);
+  auto pos = str.find(topic::sep);
+  auto result = str.substr(0, pos);
+  str.remove_prefix(pos == std::string_view::npos ? str.size() : pos);
+  return result;
+}
+
+/// Matches the topic string `s` against pattern segments, one topic segment
+/// per pattern segment.
+template <class Segments>
+bool match_segments(const Segments& pattern, std::string_view s) noexcept {
+  for (const auto& pseg : pattern) {
+    if (s.empty())
+      return false;
+    auto sseg = next_segment(s);
+    if (pseg != topic::wildcard_str && pseg != sseg)
+      return false;
+  }
+  return true;
+}
+
+/// Matches raw topic bytes `s` against the pattern string `p`.
+bool match_pattern_view(std::string_view p, std::string_view s) noexcept {
+  while (!p.empty()) {
+    if (s.empty())
+      return false;
+    auto pseg = next_segment(p);
+    auto sseg = next_segment(s);
+    if (pseg != topic::wildcard_str && pseg != sseg)
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+bool match_topic_pattern(const topic& pattern, const topic& t) noexcept {
+  return match_pattern_view(pattern.string(), t.string());
+}
+
+void compiled_patterns::assign(const std::vector<topic>& filter) {
+  patterns_.clear();
+  for (const auto& entry : filter) {
+    if (!entry.contains_wildcard())
+      continue;
+    std::string_view p = entry.string();
+    auto& segments = patterns_.emplace_back();
+    while (!p.empty())
+      segments.emplace_back(next_segment(p));
+  }
+}
+
+bool compiled_patterns::matches(const topic& t) const noexcept {
+  for (const auto& pattern : patterns_)
+    if (match_segments(pattern, t.string()))
+      return true;
+  return false;
+}
+
 bool prefix_matcher::operator()(const filter_type& filter,
                                 const topic& t) const {
-  for (auto& prefix : filter)
-    if (prefix.prefix_of(t))
+  for (auto& prefix : filter) {
+    if (prefix.contains_wildcard()) {
+      if (match_topic_pattern(prefix, t))
+        return true;
+    } else if (prefix.prefix_of(t)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool prefix_matcher::operator()(const filter_type& filter,
+                                std::string_view t) const {
+  for (auto& prefix : filter) {
+    if (prefix.contains_wildcard()) {
+      if (match_pattern_view(prefix.string(), t))
+        return true;
+    } else if (t.size() >= prefix.string().size()
+               && t.compare(0, prefix.string().size(), prefix.string()) == 0) {
       return true;
+    }
+  }
   return false;
 }
 
 } // namespace detail
-} // namespace broker 
+} // namespace broker
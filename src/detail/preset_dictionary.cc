@@ -0,0 +1,245 @@
+#include "broker/detail/preset_dictionary.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <utility>
+
+#include "broker/config.hh"
+#include "broker/detail/filesystem.hh"
+#include "broker/error.hh"
+#include "broker/internal/logger.hh"
+
+#ifdef BROKER_HAS_STD_FILESYSTEM
+#include <filesystem>
+#else
+#include <dirent.h>
+#endif
+
+#ifdef BROKER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace broker::detail {
+
+namespace {
+
+constexpr std::string_view dict_extension = ".dict";
+
+/// Returns the names of all regular files in `dir` ending in ".dict", or
+/// nothing when `dir` cannot be read.
+std::optional<std::vector<std::string>> list_dict_files(const std::string& dir) {
+  std::vector<std::string> result;
+#ifdef BROKER_HAS_STD_FILESYSTEM
+  std::error_code err;
+  std::filesystem::directory_iterator i{dir, err};
+  if (err)
+    return std::nullopt;
+  for (const auto& entry : i)
+    if (entry.is_regular_file(err))
+      result.emplace_back(entry.path().filename().string());
+#else
+  auto dp = ::opendir(dir.c_str());
+  if (dp == nullptr)
+    return std::nullopt;
+  while (auto entry = ::readdir(dp))
+    if (is_file(dir + "/" + entry->d_name))
+      result.emplace_back(entry->d_name);
+  ::closedir(dp);
+#endif
+  auto lacks_extension = [](const std::string& name) {
+    return name.size() <= dict_extension.size()
+           || name.compare(name.size() - dict_extension.size(),
+                           dict_extension.size(), dict_extension)
+                != 0;
+  };
+  result.erase(std::remove_if(result.begin(), result.end(), lacks_extension),
+               result.end());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+} // namespace
+
+void preset_dictionary_set::add(preset_dictionary dict) {
+  entries_.emplace_back(std::move(dict));
+}
+
+const preset_dictionary*
+preset_dictionary_set::by_name(std::string_view name) const noexcept {
+  for (const auto& entry : entries_)
+    if (entry.name == name)
+      return &entry;
+  return nullptr;
+}
+
+const preset_dictionary*
+preset_dictionary_set::by_checksum(uint32_t checksum) const noexcept {
+  for (const auto& entry : entries_)
+    if (entry.checksum == checksum)
+      return &entry;
+  return nullptr;
+}
+
+const preset_dictionary*
+preset_dictionary_set::lookup(std::string_view name) const noexcept {
+  if (auto ptr = by_name(name))
+    return ptr;
+  return by_name("default");
+}
+
+uint32_t preset_dictionary_checksum(const std::byte* first, size_t size) {
+  // Adler-32 as specified in RFC 1950, matching zlib's adler32(1, ...).
+  constexpr uint32_t mod = 65521;
+  uint32_t s1 = 1;
+  uint32_t s2 = 0;
+  for (size_t i = 0; i < size; ++i) {
+    s1 = (s1 + static_cast<uint8_t>(first[i])) % mod;
+    s2 = (s2 + s1) % mod;
+  }
+  return (s2 << 16) | s1;
+}
+
+std::vector<std::byte>
+train_preset_dictionary(const std::vector<std::vector<std::byte>>& samples,
+                        size_t max_size) {
+  // Count duplicates; the map also fixes a deterministic tie-break order.
+  std::map<std::vector<std::byte>, size_t> counted;
+  for (const auto& sample : samples)
+    if (!sample.empty())
+      ++counted[sample];
+  using iterator = decltype(counted)::const_iterator;
+  std::vector<iterator> by_frequency;
+  by_frequency.reserve(counted.size());
+  for (auto i = counted.begin(); i != counted.end(); ++i)
+    by_frequency.emplace_back(i);
+  std::stable_sort(by_frequency.begin(), by_frequency.end(),
+                   [](iterator lhs, iterator rhs) {
+                     return lhs->second < rhs->second;
+                   });
+  std::vector<std::byte> result;
+  for (auto i : by_frequency)
+    result.insert(result.end(), i->first.begin(), i->first.end());
+  // Deflate prefers common strings towards the end; trimming the front keeps
+  // the most frequent samples.
+  if (result.size() > max_size)
+    result.erase(result.begin(), result.end() - max_size);
+  return result;
+}
+
+expected<preset_dictionary_set>
+load_preset_dictionaries(const std::string& dir) {
+  auto files = list_dict_files(dir);
+  if (!files)
+    return {ec::cannot_open_file};
+  preset_dictionary_set result;
+  for (const auto& file : *files) {
+    auto path = dir + "/" + file;
+    std::ifstream in{path, std::ios::binary};
+    std::vector<std::byte> bytes;
+    char buf[4096];
+    while (in.read(buf, sizeof(buf)) || in.gcount() > 0) {
+      auto n = static_cast<size_t>(in.gcount());
+      auto old_size = bytes.size();
+      bytes.resize(old_size + n);
+      memcpy(bytes.data() + old_size, buf, n);
+    }
+    if (bytes.empty()) {
+      BROKER_WARNING("skipping empty preset dictionary" << path);
+      continue;
+    }
+    preset_dictionary dict;
+    dict.name = file.substr(0, file.size() - dict_extension.size());
+    dict.checksum = preset_dictionary_checksum(bytes.data(), bytes.size());
+    dict.bytes = std::move(bytes);
+    result.add(std::move(dict));
+  }
+  return {std::move(result)};
+}
+
+bool deflate_bytes(const std::byte* first, size_t size,
+                   const preset_dictionary* dict,
+                   std::vector<std::byte>& out) {
+#ifdef BROKER_HAVE_ZLIB
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  if (deflateInit(&strm, Z_DEFAULT_COMPRESSION) != Z_OK)
+    return false;
+  if (dict != nullptr
+      && deflateSetDictionary(&strm,
+                              reinterpret_cast<const Bytef*>(
+                                dict->bytes.data()),
+                              static_cast<uInt>(dict->bytes.size()))
+           != Z_OK) {
+    deflateEnd(&strm);
+    return false;
+  }
+  auto offset = out.size();
+  auto bound = deflateBound(&strm, static_cast<uLong>(size));
+  out.resize(offset + bound);
+  strm.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(first));
+  strm.avail_in = static_cast<uInt>(size);
+  strm.next_out = reinterpret_cast<Bytef*>(out.data() + offset);
+  strm.avail_out = static_cast<uInt>(bound);
+  auto res = deflate(&strm, Z_FINISH);
+  auto produced = bound - strm.avail_out;
+  deflateEnd(&strm);
+  if (res != Z_STREAM_END) {
+    out.resize(offset);
+    return false;
+  }
+  out.resize(offset + produced);
+  return true;
+#else // BROKER_HAVE_ZLIB
+  static_cast<void>(first);
+  static_cast<void>(size);
+  static_cast<void>(dict);
+  static_cast<void>(out);
+  return false;
+#endif // BROKER_HAVE_ZLIB
+}
+
+bool inflate_bytes(const std::byte* first, size_t size,
+                   const preset_dictionary_set* dicts,
+                   std::vector<std::byte>& out) {
+#ifdef BROKER_HAVE_ZLIB
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  if (inflateInit(&strm) != Z_OK)
+    return false;
+  strm.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(first));
+  strm.avail_in = static_cast<uInt>(size);
+  strm.next_out = reinterpret_cast<Bytef*>(out.data());
+  strm.avail_out = static_cast<uInt>(out.size());
+  auto res = inflate(&strm, Z_FINISH);
+  if (res == Z_NEED_DICT) {
+    // The stream names the dictionary it was deflated against by checksum.
+    auto dict = dicts != nullptr
+                  ? dicts->by_checksum(static_cast<uint32_t>(strm.adler))
+                  : nullptr;
+    if (dict == nullptr
+        || inflateSetDictionary(&strm,
+                                reinterpret_cast<const Bytef*>(
+                                  dict->bytes.data()),
+                                static_cast<uInt>(dict->bytes.size()))
+             != Z_OK) {
+      inflateEnd(&strm);
+      return false;
+    }
+    res = inflate(&strm, Z_FINISH);
+  }
+  auto ok = res == Z_STREAM_END && strm.avail_out == 0 && strm.avail_in == 0;
+  inflateEnd(&strm);
+  return ok;
+#else // BROKER_HAVE_ZLIB
+  static_cast<void>(first);
+  static_cast<void>(size);
+  static_cast<void>(dicts);
+  static_cast<void>(out);
+  return false;
+#endif // BROKER_HAVE_ZLIB
+}
+
+} // namespace broker::detail
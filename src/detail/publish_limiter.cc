@@ -0,0 +1,87 @@
+#include "broker/detail/publish_limiter.hh"
+
+#include <algorithm>
+#include <thread>
+
+namespace broker {
+
+std::string to_string(publish_limit_policy x) {
+  switch (x) {
+    case publish_limit_policy::block:
+      return "block";
+    default:
+      return "drop";
+  }
+}
+
+} // namespace broker
+
+namespace broker::detail {
+
+void publish_limiter::attach(topic prefix, publish_limit limit) {
+  std::unique_lock guard{mtx_};
+  auto pred = [&prefix](const entry& e) { return e.prefix == prefix; };
+  auto i = std::find_if(entries_.begin(), entries_.end(), pred);
+  if (limit.messages_per_second <= 0) {
+    if (i != entries_.end())
+      entries_.erase(i);
+    active_.store(!entries_.empty(), std::memory_order_release);
+    return;
+  }
+  if (limit.burst == 0)
+    limit.burst
+      = std::max(size_t{1}, static_cast<size_t>(limit.messages_per_second));
+  if (i != entries_.end()) {
+    i->limit = limit;
+    i->tokens = std::min(i->tokens, static_cast<double>(limit.burst));
+    return;
+  }
+  entries_.push_back(entry{std::move(prefix), limit,
+                           static_cast<double>(limit.burst), clock::now()});
+  active_.store(true, std::memory_order_release);
+}
+
+bool publish_limiter::admit(const topic& t, size_t n) {
+  if (n == 0 || !active_.load(std::memory_order_acquire))
+    return true;
+  for (;;) {
+    clock::duration delay;
+    {
+      std::unique_lock guard{mtx_};
+      auto pred = [&t](const entry& e) { return e.prefix.prefix_of(t); };
+      auto i = std::find_if(entries_.begin(), entries_.end(), pred);
+      if (i == entries_.end())
+        return true;
+      refill(*i, clock::now());
+      // Batches larger than the bucket capacity drain a full bucket instead,
+      // otherwise the block policy could never admit them.
+      auto needed = std::min(static_cast<double>(n),
+                             static_cast<double>(i->limit.burst));
+      if (i->tokens >= needed) {
+        i->tokens -= needed;
+        return true;
+      }
+      if (i->limit.policy == publish_limit_policy::drop) {
+        dropped_.fetch_add(n, std::memory_order_relaxed);
+        return false;
+      }
+      // Block policy: compute how long the bucket needs for the missing
+      // tokens, then sleep without holding the lock and try again.
+      auto missing = needed - i->tokens;
+      delay = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(missing / i->limit.messages_per_second));
+    }
+    std::this_thread::sleep_for(delay);
+  }
+}
+
+void publish_limiter::refill(entry& e, clock::time_point now) {
+  if (now <= e.last_refill)
+    return;
+  std::chrono::duration<double> elapsed = now - e.last_refill;
+  e.last_refill = now;
+  e.tokens = std::min(static_cast<double>(e.limit.burst),
+                      e.tokens + elapsed.count() * e.limit.messages_per_second);
+}
+
+} // namespace broker::detail
@@ -0,0 +1,48 @@
+#include "broker/detail/queue_stats.hh"
+
+#include <string>
+
+#include "broker/endpoint.hh"
+#include "broker/telemetry/metric_registry.hh"
+#include "broker/topic.hh"
+
+namespace broker::detail {
+
+namespace {
+
+/// Upper bounds for the wait-time histograms in seconds. Log-spaced buckets
+/// cover sub-millisecond wakeups up to multi-second stalls.
+constexpr double wait_time_bounds[] = {
+  0.000001, 0.00001, 0.0001, 0.001, 0.01, 0.1, 1.0, 10.0,
+};
+
+} // namespace
+
+queue_stats make_queue_stats(endpoint& ep, std::string_view role,
+                             const std::vector<topic>& filter) {
+  auto reg = telemetry::metric_registry::from(ep);
+  std::string filter_str;
+  for (const auto& t : filter) {
+    if (!filter_str.empty())
+      filter_str += ',';
+    filter_str += t.string();
+  }
+  telemetry::label_view labels[] = {{"role", role}, {"filter", filter_str}};
+  auto label_span = span<const telemetry::label_view>{labels, 2};
+  queue_stats result;
+  result.depth = reg.gauge_instance(
+    "broker", "queue-depth", label_span,
+    "Number of items currently buffered in the queue.");
+  result.high_watermark = reg.gauge_instance(
+    "broker", "queue-high-watermark", label_span,
+    "Largest number of items the queue has buffered so far.");
+  result.wait_time = reg.histogram_instance<double>(
+    "broker", "queue-wait-time", label_span, wait_time_bounds,
+    "Time callers spent blocked on the queue.", "seconds");
+  result.drops = reg.counter_instance(
+    "broker", "queue-drops", label_span,
+    "Total number of items discarded by backpressure policies.", "1", true);
+  return result;
+}
+
+} // namespace broker::detail
@@ -0,0 +1,338 @@
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <rocksdb/db.h>
+#include <rocksdb/iterator.h>
+#include <rocksdb/options.h>
+#include <rocksdb/write_batch.h>
+
+#include "broker/detail/appliers.hh"
+#include "broker/detail/data_codec.hh"
+#include "broker/detail/rocksdb_backend.hh"
+#include "broker/internal/logger.hh"
+
+namespace broker {
+namespace detail {
+
+namespace {
+
+// Values carry a one-byte expiry flag, followed by an 8-byte little-endian
+// expiry for entries that have one, followed by the codec encoding.
+constexpr size_t expiry_prefix_size = 9;
+
+std::string to_key_blob(const data& x) {
+  auto bytes = encode(x);
+  return std::string{reinterpret_cast<const char*>(bytes.data()),
+                     bytes.size()};
+}
+
+std::string to_value_blob(const data& x,
+                          const std::optional<timestamp>& expiry) {
+  std::string result;
+  if (expiry) {
+    auto count = static_cast<uint64_t>(expiry->time_since_epoch().count());
+    result.push_back(1);
+    for (int i = 0; i < 8; ++i)
+      result.push_back(static_cast<char>((count >> (i * 8)) & 0xff));
+  } else {
+    result.push_back(0);
+  }
+  auto bytes = encode(x);
+  result.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  return result;
+}
+
+expected<data> from_blob(const char* buf, size_t size) {
+  return decode(reinterpret_cast<const std::byte*>(buf), size);
+}
+
+expected<data> value_from_blob(const std::string& buf) {
+  if (buf.empty())
+    return ec::invalid_data;
+  auto skip = buf[0] != 0 ? expiry_prefix_size : size_t{1};
+  if (buf.size() < skip)
+    return ec::invalid_data;
+  return from_blob(buf.data() + skip, buf.size() - skip);
+}
+
+std::optional<timestamp> expiry_from_blob(const std::string& buf) {
+  if (buf.size() < expiry_prefix_size || buf[0] == 0)
+    return std::nullopt;
+  uint64_t count = 0;
+  for (int i = 0; i < 8; ++i)
+    count |= static_cast<uint64_t>(static_cast<uint8_t>(buf[i + 1]))
+             << (i * 8);
+  return timestamp{timespan{static_cast<int64_t>(count)}};
+}
+
+// Properties worth exporting: memtable pressure and compaction activity.
+constexpr const char* stat_properties[] = {
+  "rocksdb.estimate-num-keys",
+  "rocksdb.cur-size-all-mem-tables",
+  "rocksdb.num-running-compactions",
+  "rocksdb.compaction-pending",
+  "rocksdb.estimate-pending-compaction-bytes",
+  "rocksdb.num-running-flushes",
+};
+
+} // namespace
+
+struct rocksdb_backend::impl {
+  impl(backend_options opts) : options{std::move(opts)} {
+    auto i = options.find("path");
+    if (i == options.end()) {
+      BROKER_ERROR(
+        "RocksDB backend options are missing required 'path' string");
+      return;
+    }
+    auto path = get_if<std::string>(&i->second);
+    if (!path) {
+      BROKER_ERROR("RocksDB backend option 'path' is not a string");
+      return;
+    }
+    rocksdb::Options db_opts;
+    db_opts.create_if_missing = true;
+    if (auto o = options.find("write-buffer-size"); o != options.end()) {
+      if (auto n = get_if<count>(&o->second))
+        db_opts.write_buffer_size = *n;
+      else
+        BROKER_ERROR("RocksDB backend option 'write-buffer-size' is not a "
+                     "count");
+    }
+    if (auto o = options.find("disable-wal"); o != options.end()) {
+      if (auto b = get_if<boolean>(&o->second))
+        write_opts.disableWAL = *b;
+      else
+        BROKER_ERROR("RocksDB backend option 'disable-wal' is not a boolean");
+    }
+    rocksdb::DB* ptr = nullptr;
+    auto status = rocksdb::DB::Open(db_opts, *path, &ptr);
+    if (!status.ok()) {
+      BROKER_ERROR("unable to open RocksDB database" << *path << ":"
+                                                     << status.ToString());
+      return;
+    }
+    db.reset(ptr);
+  }
+
+  expected<std::string> read(const data& key) const {
+    std::string result;
+    auto status = db->Get(rocksdb::ReadOptions{}, to_key_blob(key), &result);
+    if (status.IsNotFound())
+      return ec::no_such_key;
+    if (!status.ok())
+      return ec::backend_failure;
+    return {std::move(result)};
+  }
+
+  backend_options options;
+  rocksdb::WriteOptions write_opts;
+  std::unique_ptr<rocksdb::DB> db;
+};
+
+rocksdb_backend::rocksdb_backend(backend_options opts)
+  : impl_{std::make_unique<impl>(std::move(opts))} {
+}
+
+rocksdb_backend::~rocksdb_backend() {
+}
+
+bool rocksdb_backend::init_failed() const {
+  return !impl_->db;
+}
+
+expected<void> rocksdb_backend::put(const data& key, data value,
+                                    std::optional<timestamp> expiry) {
+  if (!impl_->db)
+    return ec::backend_failure;
+  auto status = impl_->db->Put(impl_->write_opts, to_key_blob(key),
+                               to_value_blob(value, expiry));
+  if (!status.ok())
+    return ec::backend_failure;
+  return {};
+}
+
+expected<void> rocksdb_backend::add(const data& key, const data& value,
+                                    data::type init_type,
+                                    std::optional<timestamp> expiry) {
+  auto v = get(key);
+  data vv;
+  if (!v) {
+    if (v.error() != ec::no_such_key)
+      return v.error();
+    if (init_type == data::type::none)
+      return ec::type_clash;
+    vv = data::from_type(init_type);
+  } else {
+    vv = std::move(*v);
+  }
+  auto result = apply(adder{value}, vv);
+  if (!result)
+    return result;
+  return put(key, std::move(vv), expiry);
+}
+
+expected<void> rocksdb_backend::subtract(const data& key, const data& value,
+                                         std::optional<timestamp> expiry) {
+  auto v = get(key);
+  if (!v)
+    return v.error();
+  auto result = apply(remover{value}, *v);
+  if (!result)
+    return result;
+  return put(key, std::move(*v), expiry);
+}
+
+expected<void> rocksdb_backend::erase(const data& key) {
+  if (!impl_->db)
+    return ec::backend_failure;
+  auto status = impl_->db->Delete(impl_->write_opts, to_key_blob(key));
+  if (!status.ok())
+    return ec::backend_failure;
+  return {};
+}
+
+expected<void> rocksdb_backend::clear() {
+  if (!impl_->db)
+    return ec::backend_failure;
+  rocksdb::WriteBatch batch;
+  std::unique_ptr<rocksdb::Iterator> i{
+    impl_->db->NewIterator(rocksdb::ReadOptions{})};
+  for (i->SeekToFirst(); i->Valid(); i->Next())
+    batch.Delete(i->key());
+  if (!i->status().ok())
+    return ec::backend_failure;
+  if (!impl_->db->Write(impl_->write_opts, &batch).ok())
+    return ec::backend_failure;
+  return {};
+}
+
+expected<bool> rocksdb_backend::expire(const data& key, timestamp ts) {
+  if (!impl_->db)
+    return ec::backend_failure;
+  auto blob = impl_->read(key);
+  if (!blob) {
+    if (blob.error() == ec::no_such_key)
+      return false;
+    return blob.error();
+  }
+  auto expiry = expiry_from_blob(*blob);
+  if (!expiry || ts < *expiry)
+    return false;
+  auto status = impl_->db->Delete(impl_->write_opts, to_key_blob(key));
+  if (!status.ok())
+    return ec::backend_failure;
+  return true;
+}
+
+expected<data> rocksdb_backend::get(const data& key) const {
+  if (!impl_->db)
+    return ec::backend_failure;
+  auto blob = impl_->read(key);
+  if (!blob)
+    return blob.error();
+  return value_from_blob(*blob);
+}
+
+expected<bool> rocksdb_backend::exists(const data& key) const {
+  if (!impl_->db)
+    return ec::backend_failure;
+  auto blob = impl_->read(key);
+  if (!blob) {
+    if (blob.error() == ec::no_such_key)
+      return false;
+    return blob.error();
+  }
+  return true;
+}
+
+expected<uint64_t> rocksdb_backend::size() const {
+  if (!impl_->db)
+    return ec::backend_failure;
+  // The "estimate-num-keys" property may over-count until compaction runs,
+  // so we pay for an exact scan here.
+  uint64_t result = 0;
+  std::unique_ptr<rocksdb::Iterator> i{
+    impl_->db->NewIterator(rocksdb::ReadOptions{})};
+  for (i->SeekToFirst(); i->Valid(); i->Next())
+    ++result;
+  if (!i->status().ok())
+    return ec::backend_failure;
+  return result;
+}
+
+expected<data> rocksdb_backend::keys() const {
+  if (!impl_->db)
+    return ec::backend_failure;
+  set result;
+  std::unique_ptr<rocksdb::Iterator> i{
+    impl_->db->NewIterator(rocksdb::ReadOptions{})};
+  for (i->SeekToFirst(); i->Valid(); i->Next()) {
+    auto key = from_blob(i->key().data(), i->key().size());
+    if (!key)
+      return key.error();
+    result.insert(std::move(*key));
+  }
+  if (!i->status().ok())
+    return ec::backend_failure;
+  return {data{std::move(result)}};
+}
+
+expected<broker::snapshot> rocksdb_backend::snapshot() const {
+  if (!impl_->db)
+    return ec::backend_failure;
+  broker::snapshot ss;
+  std::unique_ptr<rocksdb::Iterator> i{
+    impl_->db->NewIterator(rocksdb::ReadOptions{})};
+  for (i->SeekToFirst(); i->Valid(); i->Next()) {
+    auto key = from_blob(i->key().data(), i->key().size());
+    if (!key)
+      return key.error();
+    auto blob = std::string{i->value().data(), i->value().size()};
+    auto value = value_from_blob(blob);
+    if (!value)
+      return value.error();
+    ss.emplace(std::move(*key), std::move(*value));
+  }
+  if (!i->status().ok())
+    return ec::backend_failure;
+  return {std::move(ss)};
+}
+
+expected<expirables> rocksdb_backend::expiries() const {
+  if (!impl_->db)
+    return ec::backend_failure;
+  expirables rval;
+  std::unique_ptr<rocksdb::Iterator> i{
+    impl_->db->NewIterator(rocksdb::ReadOptions{})};
+  for (i->SeekToFirst(); i->Valid(); i->Next()) {
+    auto blob = std::string{i->value().data(), i->value().size()};
+    auto expiry = expiry_from_blob(blob);
+    if (!expiry)
+      continue;
+    auto key = from_blob(i->key().data(), i->key().size());
+    if (!key)
+      return key.error();
+    rval.emplace_back(expirable(std::move(*key), *expiry));
+  }
+  if (!i->status().ok())
+    return ec::backend_failure;
+  return {std::move(rval)};
+}
+
+expected<data> rocksdb_backend::stats() const {
+  if (!impl_->db)
+    return ec::backend_failure;
+  table result;
+  for (auto prop : stat_properties) {
+    uint64_t value = 0;
+    if (impl_->db->GetIntProperty(prop, &value))
+      result.emplace(data{std::string{prop}}, data{count{value}});
+  }
+  return {data{std::move(result)}};
+}
+
+} // namespace detail
+} // namespace broker
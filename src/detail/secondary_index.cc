@@ -0,0 +1,41 @@
+#include "broker/detail/secondary_index.hh"
+
+namespace broker::detail {
+
+void secondary_index::insert(const data& key, const data& value) {
+  if (auto x = extract(value))
+    buckets_[*x].insert(key);
+}
+
+void secondary_index::erase(const data& key, const data& value) {
+  auto x = extract(value);
+  if (!x)
+    return;
+  if (auto i = buckets_.find(*x); i != buckets_.end()) {
+    i->second.erase(key);
+    if (i->second.empty())
+      buckets_.erase(i);
+  }
+}
+
+void secondary_index::rebuild(const broker::snapshot& ss) {
+  buckets_.clear();
+  for (auto& [key, value] : ss)
+    insert(key, value);
+}
+
+data secondary_index::lookup(const data& value) const {
+  if (auto i = buckets_.find(value); i != buckets_.end())
+    return data{i->second};
+  return data{set{}};
+}
+
+const data* secondary_index::extract(const data& value) const {
+  if (!element_)
+    return &value;
+  if (auto xs = get_if<vector>(value); xs && *element_ < xs->size())
+    return &(*xs)[*element_];
+  return nullptr;
+}
+
+} // namespace broker::detail
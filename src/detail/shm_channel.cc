@@ -0,0 +1,303 @@
+#include "broker/detail/shm_channel.hh"
+
+#ifndef BROKER_WINDOWS
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef BROKER_LINUX
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#else
+#include <thread>
+#endif
+
+#include "broker/error.hh"
+
+namespace broker::detail {
+
+namespace {
+
+/// Bytes of the length prefix preceding each message in a ring.
+constexpr size_t prefix_size = 4;
+
+/// Rounds `x` up to the next power of two.
+/// @pre `x > 0 && x <= (1u << 31)`
+uint32_t next_pow2(uint32_t x) {
+  uint32_t result = 1;
+  while (result < x)
+    result <<= 1;
+  return result;
+}
+
+void doorbell_wait(std::atomic<uint32_t>* word, uint32_t expected) {
+#ifdef BROKER_LINUX
+  // Cross-process futex; deliberately not FUTEX_PRIVATE.
+  ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected,
+            nullptr, nullptr, 0);
+#else
+  if (word->load() == expected)
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+#endif
+}
+
+void doorbell_ring(std::atomic<uint32_t>* word) {
+#ifdef BROKER_LINUX
+  ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX,
+            nullptr, nullptr, 0);
+#else
+  static_cast<void>(word);
+#endif
+}
+
+} // namespace
+
+struct shm_ring::header {
+  alignas(BROKER_CONSTRUCTIVE_INTERFERENCE_SIZE) std::atomic<uint32_t> head;
+  alignas(BROKER_CONSTRUCTIVE_INTERFERENCE_SIZE) std::atomic<uint32_t> tail;
+  alignas(BROKER_CONSTRUCTIVE_INTERFERENCE_SIZE)
+    std::atomic<uint32_t> consumer_parked;
+  alignas(BROKER_CONSTRUCTIVE_INTERFERENCE_SIZE)
+    std::atomic<uint32_t> producer_parked;
+  alignas(BROKER_CONSTRUCTIVE_INTERFERENCE_SIZE) uint32_t capacity;
+};
+
+size_t shm_ring::region_size(uint32_t capacity) noexcept {
+  return sizeof(header) + capacity;
+}
+
+shm_ring::shm_ring(void* base, uint32_t capacity, bool initialize) {
+  hdr_ = static_cast<header*>(base);
+  data_ = static_cast<std::byte*>(base) + sizeof(header);
+  if (initialize) {
+    hdr_->head.store(0, std::memory_order_relaxed);
+    hdr_->tail.store(0, std::memory_order_relaxed);
+    hdr_->consumer_parked.store(0, std::memory_order_relaxed);
+    hdr_->producer_parked.store(0, std::memory_order_relaxed);
+    hdr_->capacity = capacity;
+  }
+}
+
+bool shm_ring::produce(const std::byte* bytes, size_t size) {
+  auto cap = hdr_->capacity;
+  auto needed = size + prefix_size;
+  auto head = hdr_->head.load(std::memory_order_acquire);
+  auto tail = hdr_->tail.load(std::memory_order_relaxed);
+  if (needed > cap - (tail - head))
+    return false;
+  // Length prefix, little endian, written byte-wise to handle wrapping. The
+  // mask relies on create() rounding the capacity up to a power of two;
+  // otherwise the free-running cursors would lose slot continuity when they
+  // wrap around the 32-bit counter range.
+  auto at = [&](uint32_t cursor) -> std::byte& {
+    return data_[cursor & (cap - 1)];
+  };
+  auto len = static_cast<uint32_t>(size);
+  for (size_t i = 0; i < prefix_size; ++i)
+    at(tail + static_cast<uint32_t>(i))
+      = static_cast<std::byte>((len >> (8 * i)) & 0xff);
+  auto pos = tail + static_cast<uint32_t>(prefix_size);
+  auto index = pos & (cap - 1);
+  auto chunk = std::min(size, static_cast<size_t>(cap - index));
+  std::memcpy(data_ + index, bytes, chunk);
+  if (chunk < size)
+    std::memcpy(data_, bytes + chunk, size - chunk);
+  hdr_->tail.store(tail + static_cast<uint32_t>(needed),
+                   std::memory_order_release);
+  if (hdr_->consumer_parked.load(std::memory_order_acquire) != 0)
+    doorbell_ring(&hdr_->tail);
+  return true;
+}
+
+bool shm_ring::consume(std::vector<std::byte>& out) {
+  auto cap = hdr_->capacity;
+  auto tail = hdr_->tail.load(std::memory_order_acquire);
+  auto head = hdr_->head.load(std::memory_order_relaxed);
+  if (tail == head)
+    return false;
+  auto at = [&](uint32_t cursor) -> const std::byte& {
+    return data_[cursor & (cap - 1)];
+  };
+  uint32_t len = 0;
+  for (size_t i = 0; i < prefix_size; ++i)
+    len |= static_cast<uint32_t>(at(head + static_cast<uint32_t>(i)))
+           << (8 * i);
+  out.resize(len);
+  auto pos = head + static_cast<uint32_t>(prefix_size);
+  auto index = pos & (cap - 1);
+  auto chunk = std::min(static_cast<size_t>(len),
+                        static_cast<size_t>(cap - index));
+  std::memcpy(out.data(), data_ + index, chunk);
+  if (chunk < len)
+    std::memcpy(out.data() + chunk, data_, len - chunk);
+  hdr_->head.store(head + static_cast<uint32_t>(len + prefix_size),
+                   std::memory_order_release);
+  if (hdr_->producer_parked.load(std::memory_order_acquire) != 0)
+    doorbell_ring(&hdr_->head);
+  return true;
+}
+
+void shm_ring::await_input() {
+  for (;;) {
+    auto tail = hdr_->tail.load(std::memory_order_acquire);
+    if (tail != hdr_->head.load(std::memory_order_relaxed))
+      return;
+    hdr_->consumer_parked.store(1, std::memory_order_seq_cst);
+    // Recheck after announcing, so a concurrent produce either sees the flag
+    // or we see its tail update.
+    if (hdr_->tail.load(std::memory_order_seq_cst) != tail) {
+      hdr_->consumer_parked.store(0, std::memory_order_relaxed);
+      return;
+    }
+    doorbell_wait(&hdr_->tail, tail);
+    hdr_->consumer_parked.store(0, std::memory_order_relaxed);
+  }
+}
+
+void shm_ring::await_space(size_t size) {
+  auto cap = hdr_->capacity;
+  auto needed = size + prefix_size;
+  for (;;) {
+    auto head = hdr_->head.load(std::memory_order_acquire);
+    if (needed <= cap - (hdr_->tail.load(std::memory_order_relaxed) - head))
+      return;
+    hdr_->producer_parked.store(1, std::memory_order_seq_cst);
+    if (hdr_->head.load(std::memory_order_seq_cst) != head) {
+      hdr_->producer_parked.store(0, std::memory_order_relaxed);
+      continue;
+    }
+    doorbell_wait(&hdr_->head, head);
+    hdr_->producer_parked.store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t shm_ring::used() const noexcept {
+  return hdr_->tail.load(std::memory_order_acquire)
+         - hdr_->head.load(std::memory_order_acquire);
+}
+
+uint32_t shm_ring::capacity() const noexcept {
+  return hdr_->capacity;
+}
+
+shm_channel::shm_channel(shm_channel&& other) noexcept
+  : base_(other.base_),
+    mapped_size_(other.mapped_size_),
+    owned_name_(std::move(other.owned_name_)),
+    rings_(std::move(other.rings_)) {
+  other.base_ = nullptr;
+  other.owned_name_.clear();
+}
+
+shm_channel& shm_channel::operator=(shm_channel&& other) noexcept {
+  if (this != &other) {
+    this->~shm_channel();
+    new (this) shm_channel(std::move(other));
+  }
+  return *this;
+}
+
+shm_channel::~shm_channel() {
+  if (base_ != nullptr)
+    ::munmap(base_, mapped_size_);
+  if (!owned_name_.empty())
+    ::shm_unlink(owned_name_.c_str());
+}
+
+expected<shm_channel> shm_channel::create(const std::string& name,
+                                          uint32_t capacity) {
+  if (capacity == 0 || capacity > (uint32_t{1} << 31))
+    return {ec::unspecified};
+  // The head and tail cursors run freely and map to slots by masking. This
+  // stays continuous across the 32-bit counter wrap only when the capacity
+  // divides 2^32, so round up to the next power of two.
+  capacity = next_pow2(capacity);
+  auto fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+    return {ec::unspecified};
+  shm_channel result;
+  result.owned_name_ = name;
+  result.mapped_size_ = 2 * shm_ring::region_size(capacity);
+  if (::ftruncate(fd, static_cast<off_t>(result.mapped_size_)) != 0) {
+    ::close(fd);
+    return {ec::unspecified};
+  }
+  result.base_ = ::mmap(nullptr, result.mapped_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (result.base_ == MAP_FAILED) {
+    result.base_ = nullptr;
+    return {ec::unspecified};
+  }
+  auto second = static_cast<std::byte*>(result.base_)
+                + shm_ring::region_size(capacity);
+  // The creator produces into the first ring and consumes from the second.
+  result.rings_.emplace_back(result.base_, capacity, true);
+  result.rings_.emplace_back(second, capacity, true);
+  return result;
+}
+
+expected<shm_channel> shm_channel::attach(const std::string& name) {
+  auto fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0)
+    return {ec::unspecified};
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return {ec::unspecified};
+  }
+  shm_channel result;
+  result.mapped_size_ = static_cast<size_t>(st.st_size);
+  result.base_ = ::mmap(nullptr, result.mapped_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (result.base_ == MAP_FAILED) {
+    result.base_ = nullptr;
+    return {ec::unspecified};
+  }
+  shm_ring first{result.base_, 0, false};
+  auto capacity = first.capacity();
+  // A valid creator always writes a power-of-two capacity; anything else
+  // signals a corrupt or foreign segment.
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0
+      || result.mapped_size_ != 2 * shm_ring::region_size(capacity))
+    return {ec::invalid_data};
+  auto second = static_cast<std::byte*>(result.base_)
+                + shm_ring::region_size(capacity);
+  // Mirror of create(): produce into the second ring, consume the first.
+  result.rings_.emplace_back(second, capacity, false);
+  result.rings_.emplace_back(result.base_, capacity, false);
+  return result;
+}
+
+bool shm_channel::put(const std::byte* bytes, size_t size) {
+  auto& ring = rings_[0];
+  if (size + prefix_size > ring.capacity())
+    return false;
+  while (!ring.produce(bytes, size))
+    ring.await_space(size);
+  return true;
+}
+
+void shm_channel::get(std::vector<std::byte>& out) {
+  auto& ring = rings_[1];
+  while (!ring.consume(out))
+    ring.await_input();
+}
+
+bool shm_channel::try_get(std::vector<std::byte>& out) {
+  return rings_[1].consume(out);
+}
+
+} // namespace broker::detail
+
+#endif // BROKER_WINDOWS
@@ -0,0 +1,153 @@
+#include "broker/detail/snapshot_codec.hh"
+
+#include <cstring>
+#include <utility>
+
+#include "broker/detail/data_codec.hh"
+#include "broker/detail/preset_dictionary.hh"
+#include "broker/detail/string_dictionary.hh"
+#include "broker/error.hh"
+
+#ifdef BROKER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace broker::detail {
+
+namespace {
+
+/// Frame tag for an uncompressed payload.
+constexpr uint8_t frame_plain = 0;
+
+/// Frame tag for a deflate-compressed payload, prefixed by the varint
+/// uncompressed size.
+constexpr uint8_t frame_deflate = 1;
+
+/// Frame tag for a payload deflated against a preset dictionary, prefixed by
+/// the varint uncompressed size. The deflate stream embeds the dictionary's
+/// checksum; see broker/detail/preset_dictionary.hh.
+constexpr uint8_t frame_deflate_preset = 2;
+
+/// Payloads below this size always travel uncompressed.
+constexpr size_t compression_threshold = 64;
+
+/// Upper bound for the uncompressed size of a single frame, guarding the
+/// decompressor against hostile size prefixes.
+constexpr uint64_t max_uncompressed_frame = uint64_t{1} << 30;
+
+} // namespace
+
+void encode_snapshot(const snapshot& ss, bool compress,
+                     std::vector<std::byte>& buf, string_dictionary& dict,
+                     const preset_dictionary* preset) {
+  std::vector<std::byte> payload;
+  encode_varint(ss.size(), payload);
+  for (const auto& [key, value] : ss) {
+    encode(key, payload, dict);
+    encode(value, payload, dict);
+  }
+#ifdef BROKER_HAVE_ZLIB
+  if (compress && preset != nullptr
+      && payload.size() >= compression_threshold) {
+    auto offset = buf.size();
+    buf.push_back(std::byte{frame_deflate_preset});
+    encode_varint(payload.size(), buf);
+    if (deflate_bytes(payload.data(), payload.size(), preset, buf))
+      return;
+    // Fall through to the dictionary-less frame formats.
+    buf.resize(offset);
+  }
+  if (compress && payload.size() >= compression_threshold) {
+    auto bound = compressBound(static_cast<uLong>(payload.size()));
+    auto offset = buf.size();
+    buf.push_back(std::byte{frame_deflate});
+    encode_varint(payload.size(), buf);
+    auto prefix = buf.size();
+    buf.resize(prefix + bound);
+    auto zsize = static_cast<uLongf>(bound);
+    if (compress2(reinterpret_cast<Bytef*>(buf.data() + prefix), &zsize,
+                  reinterpret_cast<const Bytef*>(payload.data()),
+                  static_cast<uLong>(payload.size()), Z_DEFAULT_COMPRESSION)
+        == Z_OK) {
+      buf.resize(prefix + zsize);
+      return;
+    }
+    // Compression failure is not fatal; fall through to the plain frame.
+    buf.resize(offset);
+  }
+#else // BROKER_HAVE_ZLIB
+  static_cast<void>(compress);
+  static_cast<void>(preset);
+#endif // BROKER_HAVE_ZLIB
+  buf.push_back(std::byte{frame_plain});
+  buf.insert(buf.end(), payload.begin(), payload.end());
+}
+
+expected<snapshot> decode_snapshot(const std::byte* first, size_t size,
+                                   string_dictionary& dict,
+                                   const preset_dictionary_set* presets) {
+  if (size == 0)
+    return {ec::invalid_data};
+  auto tag = static_cast<uint8_t>(*first);
+  ++first;
+  --size;
+  std::vector<std::byte> inflated;
+  if (tag == frame_deflate || tag == frame_deflate_preset) {
+#ifdef BROKER_HAVE_ZLIB
+    uint64_t uncompressed_size = 0;
+    auto n = decode_varint(first, size, uncompressed_size);
+    if (n == 0 || uncompressed_size > max_uncompressed_frame)
+      return {ec::invalid_data};
+    first += n;
+    size -= n;
+    inflated.resize(uncompressed_size);
+    if (tag == frame_deflate_preset) {
+      if (!inflate_bytes(first, size, presets, inflated))
+        return {ec::invalid_data};
+    } else {
+      auto zsize = static_cast<uLongf>(uncompressed_size);
+      if (uncompress(reinterpret_cast<Bytef*>(inflated.data()), &zsize,
+                     reinterpret_cast<const Bytef*>(first),
+                     static_cast<uLong>(size))
+            != Z_OK
+          || zsize != uncompressed_size)
+        return {ec::invalid_data};
+    }
+    first = inflated.data();
+    size = inflated.size();
+#else // BROKER_HAVE_ZLIB
+    static_cast<void>(presets);
+    return {ec::invalid_data};
+#endif // BROKER_HAVE_ZLIB
+  } else if (tag != frame_plain) {
+    return {ec::invalid_data};
+  }
+  uint64_t num_entries = 0;
+  auto n = decode_varint(first, size, num_entries);
+  // Each entry consumes at least one byte for the key and one for the value,
+  // so a count beyond the remaining payload bytes is malformed; checking
+  // before the reserve keeps hostile counts from forcing huge allocations.
+  if (n == 0 || num_entries > size - n)
+    return {ec::invalid_data};
+  field_reader in{first + n, first + size};
+  snapshot result;
+  result.reserve(num_entries);
+  for (uint64_t i = 0; i < num_entries; ++i) {
+    data key;
+    data value;
+    if (!decode_field(in, key, dict) || !decode_field(in, value, dict))
+      return {ec::invalid_data};
+    result.emplace(std::move(key), std::move(value));
+  }
+  if (in.pos != in.end)
+    return {ec::invalid_data};
+  return {std::move(result)};
+}
+
+expected<snapshot> decode_snapshot(const std::vector<std::byte>& buf,
+                                   string_dictionary& dict,
+                                   const preset_dictionary_set* presets) {
+  return decode_snapshot(buf.data(), buf.size(), dict, presets);
+}
+
+} // namespace broker::detail
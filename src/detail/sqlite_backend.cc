@@ -53,6 +53,31 @@ expected<data> from_blob(const void* buf, size_t size) {
 
 struct sqlite_backend::impl {
   impl(backend_options opts) : options{std::move(opts)} {
+    if (auto o = options.find("journal-mode"); o != options.end()) {
+      if (auto str = get_if<std::string>(&o->second))
+        journal_mode = *str;
+      else
+        BROKER_ERROR("SQLite backend option 'journal-mode' is not a string");
+    }
+    if (auto o = options.find("synchronous"); o != options.end()) {
+      if (auto str = get_if<std::string>(&o->second))
+        synchronous = *str;
+      else
+        BROKER_ERROR("SQLite backend option 'synchronous' is not a string");
+    }
+    if (auto o = options.find("batch-size"); o != options.end()) {
+      if (auto n = get_if<count>(&o->second))
+        batch_size = *n;
+      else
+        BROKER_ERROR("SQLite backend option 'batch-size' is not a count");
+    }
+    if (auto o = options.find("incremental-blobs"); o != options.end()) {
+      if (auto b = get_if<boolean>(&o->second))
+        incremental_blobs = *b;
+      else
+        BROKER_ERROR("SQLite backend option 'incremental-blobs' is not a "
+                     "boolean");
+    }
     auto i = options.find("path");
     if (i == options.end()) {
       BROKER_ERROR("SQLite backend options are missing required 'path' string");
@@ -69,6 +94,8 @@ struct sqlite_backend::impl {
   ~impl() {
     if (!db)
       return;
+    // Commit any buffered mutations before shutting down.
+    flush_transaction();
     // Deallocate prepared statements.
     for (auto stmt : finalize)
       sqlite3_finalize(stmt);
@@ -132,12 +159,30 @@ struct sqlite_backend::impl {
       db = nullptr;
       return false;
     }
+    // Configure journaling and durability. The write-ahead log appends
+    // commits instead of rewriting a rollback journal per commit, and
+    // synchronous=normal defers the fsync to WAL checkpoints, i.e., commits
+    // return as soon as the data reaches the OS.
+    auto pragmas = "pragma journal_mode=" + journal_mode
+                   + ";pragma synchronous=" + synchronous + ";";
+    result = sqlite3_exec(db, pragmas.c_str(), nullptr, nullptr, nullptr);
+    if (result != SQLITE_OK) {
+      BROKER_ERROR("failed to configure journal mode" << journal_mode
+                   << "with synchronous" << synchronous);
+      sqlite3_close(db);
+      db = nullptr;
+      return false;
+    }
     // Prepare statements.
     std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
+      {&begin, "begin transaction;"},
+      {&commit, "commit;"},
       {&replace, "replace into store(key, value, expiry) values(?, ?, ?);"},
       {&update, "update store set value = ?, expiry = ? where key = ?;"},
       {&erase, "delete from store where key = ?;"},
       {&expire, "delete from store where key = ? and expiry <= ?;"},
+      {&rowid_lookup,
+       "select rowid, length(value), expiry from store where key = ?;"},
 
       {&lookup, "select value from store where key = ?;"},
       {&exists, "select 1 from store where key = ?;"},
@@ -163,6 +208,7 @@ struct sqlite_backend::impl {
 
   bool modify(const data& key, const data& value,
               std::optional<timestamp> expiry) {
+    begin_write();
     auto [key_ok, key_blob] = to_blob(key);
     if (!key_ok) {
       BROKER_DEBUG("impl::modify: to_blob(key) failed");
@@ -173,6 +219,10 @@ struct sqlite_backend::impl {
       BROKER_DEBUG("impl::modify: to_blob(value) failed");
       return false;
     }
+    if (try_inplace_update(key_blob, value_blob, expiry)) {
+      finish_write();
+      return true;
+    }
     auto guard = make_statement_guard(update);
 
     // Bind value.
@@ -201,15 +251,116 @@ struct sqlite_backend::impl {
       return false;
 
     // Execute statement.
-    return sqlite3_step(update) == SQLITE_DONE;
+    if (sqlite3_step(update) != SQLITE_DONE)
+      return false;
+    finish_write();
+    return true;
+  }
+
+  // Attempts to update the stored value for `key_blob` in place through the
+  // incremental blob API, writing only the byte span that actually changed.
+  // Overwriting one element of a large value otherwise rewrites the whole
+  // row, including every untouched overflow page. Only applies when the new
+  // serialized form has the same size as the stored one and the expiry stays
+  // unchanged: `sqlite3_blob_write` cannot resize a blob, and touching the
+  // expiry column would force a full row rewrite anyway.
+  bool try_inplace_update(const caf::binary_serializer::container_type& key_blob,
+                          const caf::binary_serializer::container_type& value_blob,
+                          std::optional<timestamp> expiry) {
+    if (!incremental_blobs || value_blob.empty())
+      return false;
+    sqlite3_int64 rowid = 0;
+    {
+      auto guard = make_statement_guard(rowid_lookup);
+      if (sqlite3_bind_blob64(rowid_lookup, 1, key_blob.data(),
+                              key_blob.size(), SQLITE_STATIC)
+          != SQLITE_OK)
+        return false;
+      if (sqlite3_step(rowid_lookup) != SQLITE_ROW)
+        return false;
+      rowid = sqlite3_column_int64(rowid_lookup, 0);
+      auto size = static_cast<size_t>(sqlite3_column_int64(rowid_lookup, 1));
+      if (size != value_blob.size())
+        return false;
+      if (expiry) {
+        if (sqlite3_column_type(rowid_lookup, 2) == SQLITE_NULL
+            || sqlite3_column_int64(rowid_lookup, 2)
+                 != expiry->time_since_epoch().count())
+          return false;
+      } else if (sqlite3_column_type(rowid_lookup, 2) != SQLITE_NULL) {
+        return false;
+      }
+    }
+    sqlite3_blob* blob = nullptr;
+    if (sqlite3_blob_open(db, "main", "store", "value", rowid, 1, &blob)
+        != SQLITE_OK)
+      return false;
+    auto blob_guard
+      = caf::detail::make_scope_guard([=] { sqlite3_blob_close(blob); });
+    // Read the stored bytes and narrow the write to the span that changed.
+    std::vector<unsigned char> old_bytes(value_blob.size());
+    if (sqlite3_blob_read(blob, old_bytes.data(),
+                          static_cast<int>(old_bytes.size()), 0)
+        != SQLITE_OK)
+      return false;
+    auto new_bytes = reinterpret_cast<const unsigned char*>(value_blob.data());
+    size_t first = 0;
+    while (first < old_bytes.size() && old_bytes[first] == new_bytes[first])
+      ++first;
+    if (first == old_bytes.size())
+      return true; // Identical bytes; nothing to write.
+    auto last = old_bytes.size();
+    while (last > first + 1 && old_bytes[last - 1] == new_bytes[last - 1])
+      --last;
+    return sqlite3_blob_write(blob, new_bytes + first,
+                              static_cast<int>(last - first),
+                              static_cast<int>(first))
+           == SQLITE_OK;
+  }
+
+  // Opens a transaction covering up to `batch_size` mutations, unless one is
+  // open already or batching is disabled.
+  void begin_write() {
+    if (batch_size <= 1 || in_transaction || !db)
+      return;
+    auto guard = make_statement_guard(begin);
+    if (sqlite3_step(begin) == SQLITE_DONE)
+      in_transaction = true;
+  }
+
+  // Counts a completed mutation and commits once the batch is full.
+  void finish_write() {
+    if (in_transaction && ++pending_writes >= batch_size)
+      flush_transaction();
+  }
+
+  void flush_transaction() {
+    if (!in_transaction)
+      return;
+    auto guard = make_statement_guard(commit);
+    if (sqlite3_step(commit) != SQLITE_DONE)
+      BROKER_ERROR("failed to commit transaction:" << sqlite3_errmsg(db));
+    in_transaction = false;
+    pending_writes = 0;
   }
 
   backend_options options;
+  std::string journal_mode = "WAL";
+  std::string synchronous = "normal";
+  uint64_t batch_size = 1;
+  uint64_t pending_writes = 0;
+  bool in_transaction = false;
+  /// Whether same-size value updates go through `try_inplace_update`;
+  /// see the "incremental-blobs" backend option.
+  bool incremental_blobs = true;
   sqlite3* db = nullptr;
+  sqlite3_stmt* begin = nullptr;
+  sqlite3_stmt* commit = nullptr;
   sqlite3_stmt* replace = nullptr;
   sqlite3_stmt* update = nullptr;
   sqlite3_stmt* erase = nullptr;
   sqlite3_stmt* expire = nullptr;
+  sqlite3_stmt* rowid_lookup = nullptr;
   sqlite3_stmt* lookup = nullptr;
   sqlite3_stmt* exists = nullptr;
   sqlite3_stmt* size = nullptr;
@@ -236,23 +387,28 @@ expected<void> sqlite_backend::put(const data& key, data value,
                                    std::optional<timestamp> expiry) {
   if (!impl_->db)
     return ec::backend_failure;
-  auto guard = make_statement_guard(impl_->replace);
-  // Bind key.
+  impl_->begin_write();
   auto [key_ok, key_blob] = to_blob(key);
   if (!key_ok) {
     BROKER_DEBUG("sqlite_backend::put: to_blob(key) failed");
     return ec::invalid_data;
   }
-  auto result = sqlite3_bind_blob64(impl_->replace, 1, key_blob.data(),
-                                    key_blob.size(), SQLITE_STATIC);
-  if (result != SQLITE_OK)
-    return ec::backend_failure;
-  // Bind value.
   auto [value_ok, value_blob] = to_blob(value);
   if (!value_ok) {
     BROKER_DEBUG("sqlite_backend::put: to_blob(key) failed");
     return ec::invalid_data;
   }
+  if (impl_->try_inplace_update(key_blob, value_blob, expiry)) {
+    impl_->finish_write();
+    return {};
+  }
+  auto guard = make_statement_guard(impl_->replace);
+  // Bind key.
+  auto result = sqlite3_bind_blob64(impl_->replace, 1, key_blob.data(),
+                                    key_blob.size(), SQLITE_STATIC);
+  if (result != SQLITE_OK)
+    return ec::backend_failure;
+  // Bind value.
   result = sqlite3_bind_blob64(impl_->replace, 2, value_blob.data(),
                                value_blob.size(), SQLITE_STATIC);
   if (result != SQLITE_OK)
@@ -267,6 +423,7 @@ expected<void> sqlite_backend::put(const data& key, data value,
   // Execute statement.
   if (sqlite3_step(impl_->replace) != SQLITE_DONE)
     return ec::backend_failure;
+  impl_->finish_write();
   return {};
 }
 
@@ -282,7 +439,7 @@ expected<void> sqlite_backend::add(const data& key, const data& value,
   } else {
     vv = std::move(*v);
   }
-  auto result = visit(adder{value}, vv);
+  auto result = apply(adder{value}, vv);
   if (!result)
     return result;
   return put(key, std::move(vv), expiry);
@@ -293,7 +450,7 @@ expected<void> sqlite_backend::subtract(const data& key, const data& value,
   auto v = get(key);
   if (!v)
     return v.error();
-  auto result = visit(remover{value}, *v);
+  auto result = apply(remover{value}, *v);
   if (!result)
     return result;
   if (!impl_->modify(key, *v, expiry))
@@ -301,9 +458,25 @@ expected<void> sqlite_backend::subtract(const data& key, const data& value,
   return {};
 }
 
+expected<void>
+sqlite_backend::bulk_insert(std::vector<std::pair<data, data>> entries) {
+  if (!impl_->db)
+    return ec::backend_failure;
+  // Cover the entire batch with a single transaction, regardless of the
+  // configured batch size.
+  auto saved_batch_size = impl_->batch_size;
+  impl_->flush_transaction();
+  impl_->batch_size = entries.size() + 1;
+  auto result = abstract_backend::bulk_insert(std::move(entries));
+  impl_->flush_transaction();
+  impl_->batch_size = saved_batch_size;
+  return result;
+}
+
 expected<void> sqlite_backend::erase(const data& key) {
   if (!impl_->db)
     return ec::backend_failure;
+  impl_->begin_write();
   auto guard = make_statement_guard(impl_->erase);
   auto [key_ok, key_blob] = to_blob(key);
   if (!key_ok) {
@@ -319,22 +492,37 @@ expected<void> sqlite_backend::erase(const data& key) {
     return ec::backend_failure;
   //if (sqlite3_changes(impl_->db) == 0)
   //  return ec::no_such_key;
+  impl_->finish_write();
   return {};
 }
 
 expected<void> sqlite_backend::clear() {
   if (!impl_->db)
     return ec::backend_failure;
+  impl_->begin_write();
   auto guard = make_statement_guard(impl_->clear);
   auto result = sqlite3_step(impl_->clear);
   if (result != SQLITE_DONE)
     return ec::backend_failure;
+  impl_->finish_write();
+  return {};
+}
+
+expected<void> sqlite_backend::compact() {
+  if (!impl_->db)
+    return ec::backend_failure;
+  // Commit any pending batch first, then hand cached pages back to the OS.
+  // The row data itself lives on disk, so releasing the page cache is all
+  // the shrinking there is to do.
+  impl_->flush_transaction();
+  sqlite3_db_release_memory(impl_->db);
   return {};
 }
 
 expected<bool> sqlite_backend::expire(const data& key, timestamp ts) {
   if (!impl_->db)
     return ec::backend_failure;
+  impl_->begin_write();
   auto guard = make_statement_guard(impl_->expire);
   // Bind key.
 	auto [key_ok, key_blob] = to_blob(key);
@@ -354,7 +542,10 @@ expected<bool> sqlite_backend::expire(const data& key, timestamp ts) {
 	result = sqlite3_step(impl_->expire);
   if (result != SQLITE_DONE)
     return ec::backend_failure;
-  return sqlite3_changes(impl_->db) == 1;
+  auto changed = sqlite3_changes(impl_->db) == 1;
+  if (changed)
+    impl_->finish_write();
+  return changed;
 }
 
 expected<data> sqlite_backend::get(const data& key) const {
@@ -0,0 +1,102 @@
+#include "broker/detail/store_file.hh"
+
+#include <cstring>
+
+#include "broker/detail/data_codec.hh"
+
+namespace broker::detail {
+
+namespace {
+
+constexpr char magic[] = {'B', 'R', 'K', 'S'};
+
+constexpr char version = 1;
+
+} // namespace
+
+expected<void> store_file_writer::open(const std::string& path) {
+  out_.open(path, std::ios::binary | std::ios::trunc);
+  if (!out_)
+    return ec::backend_failure;
+  out_.write(magic, sizeof(magic));
+  out_.put(version);
+  if (!out_)
+    return ec::backend_failure;
+  return {};
+}
+
+expected<void> store_file_writer::write(const data& key, const data& value) {
+  buf_.clear();
+  for (auto x : {&key, &value}) {
+    scratch_.clear();
+    encode(*x, scratch_);
+    encode_varint(scratch_.size(), buf_);
+    buf_.insert(buf_.end(), scratch_.begin(), scratch_.end());
+  }
+  out_.write(reinterpret_cast<const char*>(buf_.data()),
+             static_cast<std::streamsize>(buf_.size()));
+  if (!out_)
+    return ec::backend_failure;
+  return {};
+}
+
+expected<void> store_file_writer::close() {
+  out_.flush();
+  if (!out_)
+    return ec::backend_failure;
+  out_.close();
+  return {};
+}
+
+expected<void> store_file_reader::open(const std::string& path) {
+  in_.open(path, std::ios::binary);
+  if (!in_)
+    return ec::backend_failure;
+  char header[sizeof(magic) + 1];
+  in_.read(header, sizeof(header));
+  if (!in_ || memcmp(header, magic, sizeof(magic)) != 0
+      || header[sizeof(magic)] != version)
+    return ec::invalid_data;
+  return {};
+}
+
+expected<bool> store_file_reader::read(data& key, data& value) {
+  if (in_.peek() == std::ifstream::traits_type::eof())
+    return false;
+  if (auto res = read_blob(buf_); !res)
+    return res.error();
+  auto k = decode(buf_);
+  if (!k)
+    return k.error();
+  if (auto res = read_blob(buf_); !res)
+    return res.error();
+  auto v = decode(buf_);
+  if (!v)
+    return v.error();
+  key = std::move(*k);
+  value = std::move(*v);
+  return true;
+}
+
+expected<void> store_file_reader::read_blob(std::vector<std::byte>& buf) {
+  // Varints arrive byte by byte; the stream buffer makes this cheap.
+  uint64_t size = 0;
+  int shift = 0;
+  for (;;) {
+    auto b = in_.get();
+    if (b == std::ifstream::traits_type::eof() || shift > 63)
+      return ec::invalid_data;
+    size |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if ((b & 0x80) == 0)
+      break;
+    shift += 7;
+  }
+  buf.resize(size);
+  in_.read(reinterpret_cast<char*>(buf.data()),
+           static_cast<std::streamsize>(size));
+  if (!in_)
+    return ec::invalid_data;
+  return {};
+}
+
+} // namespace broker::detail
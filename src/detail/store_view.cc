@@ -0,0 +1,54 @@
+#include <mutex>
+#include <utility>
+
+#include "broker/detail/store_view.hh"
+
+namespace broker {
+namespace detail {
+
+namespace {
+
+// Maps master store names to their views. Entries are weak: the view lives
+// exactly as long as its master actor or an attached reader holds on to it.
+std::mutex registry_mtx;
+std::unordered_map<std::string, std::weak_ptr<store_view>> registry;
+
+} // namespace
+
+store_view::store_view() : active_(false) {
+  current_ = std::make_shared<const map_type>();
+}
+
+store_view::map_ptr store_view::load() const noexcept {
+  return std::atomic_load_explicit(&current_, std::memory_order_acquire);
+}
+
+void store_view::publish(map_type xs) {
+  auto ptr = std::make_shared<const map_type>(std::move(xs));
+  std::atomic_store_explicit(&current_, map_ptr{std::move(ptr)},
+                             std::memory_order_release);
+}
+
+std::shared_ptr<store_view> store_view::make(const std::string& name) {
+  auto result = std::make_shared<store_view>();
+  std::unique_lock<std::mutex> guard{registry_mtx};
+  registry[name] = result;
+  return result;
+}
+
+std::shared_ptr<store_view> store_view::lookup(const std::string& name) {
+  std::unique_lock<std::mutex> guard{registry_mtx};
+  auto i = registry.find(name);
+  if (i == registry.end())
+    return nullptr;
+  auto result = i->second.lock();
+  if (!result) {
+    registry.erase(i);
+    return nullptr;
+  }
+  result->active_.store(true, std::memory_order_relaxed);
+  return result;
+}
+
+} // namespace detail
+} // namespace broker
@@ -0,0 +1,74 @@
+#include "broker/detail/string_dictionary.hh"
+
+#include "broker/detail/assert.hh"
+
+namespace broker::detail {
+
+string_dictionary::string_dictionary(size_t capacity)
+  : capacity_(capacity > 0 ? capacity : 1) {
+  slots_.reserve(capacity_ < 64 ? capacity_ : 64);
+  index_.reserve(capacity_ < 64 ? capacity_ : 64);
+}
+
+size_t string_dictionary::find(const std::string& str) noexcept {
+  auto i = index_.find(str);
+  if (i == index_.end())
+    return npos;
+  unlink(i->second);
+  push_front(i->second);
+  return i->second;
+}
+
+size_t string_dictionary::insert(const std::string& str) {
+  BROKER_ASSERT(eligible(str.size()));
+  size_t slot;
+  if (slots_.size() < capacity_) {
+    slot = slots_.size();
+    slots_.emplace_back();
+  } else {
+    // Reuse the slot of the least recently used entry, keeping all other
+    // slot references valid.
+    slot = tail_;
+    unlink(slot);
+    index_.erase(slots_[slot].str);
+  }
+  slots_[slot].str = str;
+  index_.emplace(str, slot);
+  push_front(slot);
+  return slot;
+}
+
+const std::string* string_dictionary::lookup(size_t slot) noexcept {
+  if (slot >= slots_.size())
+    return nullptr;
+  unlink(slot);
+  push_front(slot);
+  return &slots_[slot].str;
+}
+
+void string_dictionary::unlink(size_t slot) noexcept {
+  auto& e = slots_[slot];
+  if (e.prev != npos)
+    slots_[e.prev].next = e.next;
+  else if (head_ == slot)
+    head_ = e.next;
+  if (e.next != npos)
+    slots_[e.next].prev = e.prev;
+  else if (tail_ == slot)
+    tail_ = e.prev;
+  e.prev = npos;
+  e.next = npos;
+}
+
+void string_dictionary::push_front(size_t slot) noexcept {
+  auto& e = slots_[slot];
+  e.prev = npos;
+  e.next = head_;
+  if (head_ != npos)
+    slots_[head_].prev = slot;
+  head_ = slot;
+  if (tail_ == npos)
+    tail_ = slot;
+}
+
+} // namespace broker::detail
@@ -0,0 +1,103 @@
+#include "broker/detail/subnet_index.hh"
+
+#include "broker/address.hh"
+#include "broker/data.hh"
+
+namespace broker::detail {
+
+struct subnet_index::node {
+  std::unique_ptr<node> child[2];
+  std::optional<subnet> key;
+};
+
+namespace {
+
+// Returns bit `i` of a 16-byte address, most significant bit first.
+int bit_at(const address::array_type& bytes, uint8_t i) noexcept {
+  return (bytes[i / 8] >> (7 - i % 8)) & 1;
+}
+
+// Trie depth of a subnet. The subnet class stores v4 networks v4-mapped, so
+// the depth is always relative to 128 bits and v4 and v6 keys share one trie
+// with matching semantics.
+uint8_t trie_depth(const subnet& sn) noexcept {
+  return sn.network().is_v4() ? sn.length() + 96 : sn.length();
+}
+
+// Clears the terminal for the key bits below `slot` and prunes branches that
+// hold neither a key nor children afterwards.
+void erase_at(std::unique_ptr<subnet_index::node>& slot,
+              const address::array_type& bytes, uint8_t len, uint8_t depth,
+              size_t& size) {
+  if (!slot)
+    return;
+  if (depth == len) {
+    if (slot->key) {
+      slot->key.reset();
+      --size;
+    }
+  } else {
+    erase_at(slot->child[bit_at(bytes, depth)], bytes, len, depth + 1, size);
+  }
+  if (!slot->key && !slot->child[0] && !slot->child[1])
+    slot.reset();
+}
+
+} // namespace
+
+subnet_index::subnet_index() = default;
+
+subnet_index::subnet_index(subnet_index&&) noexcept = default;
+
+subnet_index& subnet_index::operator=(subnet_index&&) noexcept = default;
+
+subnet_index::~subnet_index() = default;
+
+void subnet_index::insert(const subnet& key) {
+  if (!root_)
+    root_ = std::make_unique<node>();
+  auto ptr = root_.get();
+  auto& bytes = key.network().bytes();
+  auto len = trie_depth(key);
+  for (uint8_t i = 0; i < len; ++i) {
+    auto& child = ptr->child[bit_at(bytes, i)];
+    if (!child)
+      child = std::make_unique<node>();
+    ptr = child.get();
+  }
+  if (!ptr->key)
+    ++size_;
+  ptr->key = key;
+}
+
+void subnet_index::erase(const subnet& key) {
+  erase_at(root_, key.network().bytes(), trie_depth(key), 0, size_);
+}
+
+void subnet_index::clear() {
+  root_.reset();
+  size_ = 0;
+}
+
+void subnet_index::rebuild(const broker::snapshot& ss) {
+  clear();
+  for (auto& [key, value] : ss)
+    if (auto sn = get_if<subnet>(key))
+      insert(*sn);
+}
+
+std::optional<subnet> subnet_index::lookup(const address& addr) const {
+  std::optional<subnet> best;
+  auto& bytes = addr.bytes();
+  auto ptr = root_.get();
+  for (uint8_t i = 0; ptr != nullptr; ++i) {
+    if (ptr->key)
+      best = ptr->key;
+    if (i == address::num_bytes * 8)
+      break;
+    ptr = ptr->child[bit_at(bytes, i)].get();
+  }
+  return best;
+}
+
+} // namespace broker::detail
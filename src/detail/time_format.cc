@@ -0,0 +1,124 @@
+#include "broker/detail/time_format.hh"
+
+#include <cstdint>
+#include <cstring>
+
+namespace broker {
+namespace detail {
+
+namespace {
+
+// All two-digit decimal numbers as consecutive character pairs. Emitting two
+// digits as a single 2-byte copy halves the stores for every field.
+constexpr char digit_pairs[]
+  = "00010203040506070809101112131415161718192021222324252627282930313233343"
+    "53637383940414243444546474849505152535455565758596061626364656667686970"
+    "71727374757677787980818283848586878889909192939495969798" "99";
+
+char* put_pair(unsigned value, char* out) noexcept {
+  memcpy(out, digit_pairs + value * 2, 2);
+  return out + 2;
+}
+
+constexpr int64_t ns_per_sec = 1'000'000'000;
+
+constexpr int64_t ns_per_day = 86'400 * ns_per_sec;
+
+// Converts a count of days since 1970-01-01 into a civil date. This is the
+// days-to-civil algorithm from Howard Hinnant's date library: one division
+// chain, no iteration, no table of month lengths.
+void civil_from_days(int64_t z, int& year, unsigned& month,
+                     unsigned& day) noexcept {
+  z += 719468;
+  auto era = (z >= 0 ? z : z - 146096) / 146097;
+  auto doe = static_cast<uint64_t>(z - era * 146097);          // [0, 146096]
+  auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  auto y = static_cast<int64_t>(yoe) + era * 400;
+  auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);          // [0, 365]
+  auto mp = (5 * doy + 2) / 153;                               // [0, 11]
+  day = static_cast<unsigned>(doy - (153 * mp + 2) / 5 + 1);   // [1, 31]
+  month = static_cast<unsigned>(mp < 10 ? mp + 3 : mp - 9);    // [1, 12]
+  year = static_cast<int>(y + (month <= 2));
+}
+
+} // namespace
+
+size_t format_iso8601(timestamp t, char* out) noexcept {
+  auto ns = t.time_since_epoch().count();
+  // Floor division, so pre-epoch timestamps land on the preceding day.
+  auto days = ns / ns_per_day;
+  auto ns_of_day = ns % ns_per_day;
+  if (ns_of_day < 0) {
+    --days;
+    ns_of_day += ns_per_day;
+  }
+  int year;
+  unsigned month;
+  unsigned day;
+  civil_from_days(days, year, month, day);
+  auto pos = out;
+  // The date: a 64-bit nanosecond epoch spans 1677..2262, so four year
+  // digits always suffice.
+  pos = put_pair(static_cast<unsigned>(year / 100), pos);
+  pos = put_pair(static_cast<unsigned>(year % 100), pos);
+  *pos++ = '-';
+  pos = put_pair(month, pos);
+  *pos++ = '-';
+  pos = put_pair(day, pos);
+  *pos++ = 'T';
+  // The time of day.
+  auto sec_of_day = static_cast<unsigned>(ns_of_day / ns_per_sec);
+  auto frac = static_cast<unsigned>(ns_of_day % ns_per_sec);
+  pos = put_pair(sec_of_day / 3600, pos);
+  *pos++ = ':';
+  pos = put_pair(sec_of_day / 60 % 60, pos);
+  *pos++ = ':';
+  pos = put_pair(sec_of_day % 60, pos);
+  if (frac == 0)
+    return static_cast<size_t>(pos - out);
+  // The fraction, trimmed to the coarsest of ms/us/ns that loses nothing.
+  *pos++ = '.';
+  pos = put_pair(frac / 10'000'000, pos);
+  *pos++ = static_cast<char>('0' + frac / 1'000'000 % 10);
+  if (frac % 1'000'000 == 0)
+    return static_cast<size_t>(pos - out);
+  pos = put_pair(frac / 10'000 % 100, pos);
+  *pos++ = static_cast<char>('0' + frac / 1'000 % 10);
+  if (frac % 1'000 == 0)
+    return static_cast<size_t>(pos - out);
+  pos = put_pair(frac / 10 % 100, pos);
+  *pos++ = static_cast<char>('0' + frac % 10);
+  return static_cast<size_t>(pos - out);
+}
+
+size_t format_timespan(timespan s, char* out) noexcept {
+  auto pos = out;
+  // Negating as uint64_t also covers INT64_MIN.
+  auto x = static_cast<uint64_t>(s.count());
+  if (s.count() < 0) {
+    *pos++ = '-';
+    x = 0 - x;
+  }
+  char tmp[20];
+  auto rpos = tmp + sizeof(tmp);
+  while (x >= 100) {
+    rpos -= 2;
+    memcpy(rpos, digit_pairs + x % 100 * 2, 2);
+    x /= 100;
+  }
+  if (x >= 10) {
+    rpos -= 2;
+    memcpy(rpos, digit_pairs + x * 2, 2);
+  } else {
+    *--rpos = static_cast<char>('0' + x);
+  }
+  auto len = static_cast<size_t>(tmp + sizeof(tmp) - rpos);
+  memcpy(pos, rpos, len);
+  pos += len;
+  *pos++ = 'n';
+  *pos++ = 's';
+  return static_cast<size_t>(pos - out);
+}
+
+} // namespace detail
+} // namespace broker
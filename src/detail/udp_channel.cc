@@ -0,0 +1,162 @@
+#include "broker/detail/udp_channel.hh"
+
+#ifndef BROKER_WINDOWS
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "broker/error.hh"
+
+namespace broker::detail {
+
+expected<udp_channel> udp_channel::make(uint16_t port) {
+  auto fd = ::socket(AF_INET6, SOCK_DGRAM, 0);
+  if (fd < 0)
+    return {ec::unspecified};
+  // Accept v4 senders on the same socket.
+  int off = 0;
+  setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+  sockaddr_in6 addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin6_family = AF_INET6;
+  addr.sin6_addr = in6addr_any;
+  addr.sin6_port = htons(port);
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return {ec::unspecified};
+  }
+  socklen_t len = sizeof(addr);
+  if (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    ::close(fd);
+    return {ec::unspecified};
+  }
+  udp_channel result;
+  result.fd_ = fd;
+  result.local_port_ = ntohs(addr.sin6_port);
+  return result;
+}
+
+udp_channel::udp_channel(udp_channel&& other) noexcept
+  : fd_(other.fd_),
+    local_port_(other.local_port_),
+    stats_(other.stats_),
+    buf_(std::move(other.buf_)) {
+  other.fd_ = invalid_native_socket;
+}
+
+udp_channel& udp_channel::operator=(udp_channel&& other) noexcept {
+  if (this != &other) {
+    if (fd_ != invalid_native_socket)
+      ::close(fd_);
+    fd_ = other.fd_;
+    local_port_ = other.local_port_;
+    stats_ = other.stats_;
+    buf_ = std::move(other.buf_);
+    other.fd_ = invalid_native_socket;
+  }
+  return *this;
+}
+
+udp_channel::~udp_channel() {
+  if (fd_ != invalid_native_socket)
+    ::close(fd_);
+}
+
+expected<void> udp_channel::connect(const std::string& host, uint16_t port) {
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = AI_V4MAPPED;
+  addrinfo* res = nullptr;
+  auto service = std::to_string(port);
+  if (getaddrinfo(host.c_str(), service.c_str(), &hints, &res) != 0
+      || res == nullptr)
+    return {ec::unspecified};
+  auto err = ::connect(fd_, res->ai_addr, res->ai_addrlen);
+  freeaddrinfo(res);
+  if (err != 0)
+    return {ec::unspecified};
+  return {};
+}
+
+expected<void> udp_channel::send(frame_type type, const std::byte* payload,
+                                 size_t size) {
+  if (size > max_payload)
+    return {ec::invalid_data};
+  buf_.clear();
+  frame_header hdr{static_cast<uint32_t>(size), type};
+  encode(hdr, buf_);
+  buf_.insert(buf_.end(), payload, payload + size);
+  for (;;) {
+    auto res = ::send(fd_, buf_.data(), buf_.size(), MSG_DONTWAIT);
+    if (res >= 0) {
+      ++stats_.sent;
+      return {};
+    }
+    if (errno == EINTR)
+      continue;
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+      // Best-effort semantics: a full buffer sheds load instead of blocking.
+      ++stats_.dropped;
+      return {};
+    }
+    return {ec::unspecified};
+  }
+}
+
+expected<udp_channel::frame> udp_channel::read(int timeout_ms) {
+  return read_datagram(timeout_ms);
+}
+
+expected<udp_channel::frame> udp_channel::try_read() {
+  return read_datagram(0);
+}
+
+expected<udp_channel::frame> udp_channel::read_datagram(int timeout_ms) {
+  for (;;) {
+    pollfd pfd{fd_, POLLIN, 0};
+    auto ready = ::poll(&pfd, 1, timeout_ms);
+    if (ready < 0) {
+      if (errno == EINTR)
+        continue;
+      return {ec::unspecified};
+    }
+    if (ready == 0)
+      return {ec::request_timeout};
+    buf_.resize(frame_header_size + max_payload);
+    auto res = ::recv(fd_, buf_.data(), buf_.size(), 0);
+    if (res < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+        continue;
+      return {ec::unspecified};
+    }
+    auto received = static_cast<size_t>(res);
+    if (received < frame_header_size) {
+      ++stats_.invalid;
+      continue;
+    }
+    auto hdr = decode_frame_header(buf_.data());
+    if (!hdr || hdr->payload_size != received - frame_header_size) {
+      ++stats_.invalid;
+      continue;
+    }
+    frame result;
+    result.type = hdr->type;
+    result.payload.assign(buf_.begin() + frame_header_size,
+                          buf_.begin() + received);
+    ++stats_.received;
+    return result;
+  }
+}
+
+} // namespace broker::detail
+
+#endif // BROKER_WINDOWS
@@ -0,0 +1,291 @@
+#include "broker/detail/uring_loop.hh"
+
+#ifdef BROKER_HAVE_IO_URING
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include "broker/error.hh"
+
+namespace broker::detail {
+
+namespace {
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                       unsigned flags) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit,
+                                    min_complete, flags, nullptr, 0));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void* arg,
+                          unsigned nr_args) {
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg,
+                                    nr_args));
+}
+
+/// Returns whether the running kernel is at least `major.minor`.
+bool kernel_at_least(int major, int minor) {
+  utsname buf;
+  if (::uname(&buf) != 0)
+    return false;
+  int have_major = 0;
+  int have_minor = 0;
+  if (std::sscanf(buf.release, "%d.%d", &have_major, &have_minor) != 2)
+    return false;
+  return have_major > major
+         || (have_major == major && have_minor >= minor);
+}
+
+} // namespace
+
+bool uring_loop::completion::more() const noexcept {
+#ifdef IORING_CQE_F_MORE
+  return (flags & IORING_CQE_F_MORE) != 0;
+#else
+  return false;
+#endif
+}
+
+uring_loop::uring_loop(uring_loop&& other) noexcept
+  : ring_fd_(other.ring_fd_),
+    sq_ring_(other.sq_ring_),
+    sq_ring_size_(other.sq_ring_size_),
+    cq_ring_(other.cq_ring_),
+    cq_ring_size_(other.cq_ring_size_),
+    sqes_(other.sqes_),
+    sqes_size_(other.sqes_size_),
+    sq_head_(other.sq_head_),
+    sq_tail_(other.sq_tail_),
+    sq_mask_(other.sq_mask_),
+    sq_array_(other.sq_array_),
+    cq_head_(other.cq_head_),
+    cq_tail_(other.cq_tail_),
+    cq_mask_(other.cq_mask_),
+    cqes_(other.cqes_),
+    staged_(other.staged_),
+    multishot_accept_(other.multishot_accept_) {
+  other.ring_fd_ = -1;
+  other.sq_ring_ = nullptr;
+  other.cq_ring_ = nullptr;
+  other.sqes_ = nullptr;
+}
+
+uring_loop& uring_loop::operator=(uring_loop&& other) noexcept {
+  if (this != &other) {
+    this->~uring_loop();
+    new (this) uring_loop(std::move(other));
+  }
+  return *this;
+}
+
+uring_loop::~uring_loop() {
+  if (sqes_ != nullptr)
+    ::munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+    ::munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr)
+    ::munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ != -1)
+    ::close(ring_fd_);
+}
+
+expected<uring_loop> uring_loop::make(unsigned entries) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  auto fd = sys_io_uring_setup(entries, &params);
+  if (fd < 0)
+    return {ec::unspecified};
+  uring_loop result;
+  result.ring_fd_ = fd;
+  auto sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  auto cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  auto single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_size = std::max(sq_size, cq_size);
+    cq_size = sq_size;
+  }
+  result.sq_ring_size_ = sq_size;
+  result.sq_ring_ = ::mmap(nullptr, sq_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (result.sq_ring_ == MAP_FAILED) {
+    result.sq_ring_ = nullptr;
+    return {ec::unspecified};
+  }
+  result.cq_ring_size_ = cq_size;
+  if (single_mmap) {
+    result.cq_ring_ = result.sq_ring_;
+  } else {
+    result.cq_ring_ = ::mmap(nullptr, cq_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd,
+                             IORING_OFF_CQ_RING);
+    if (result.cq_ring_ == MAP_FAILED) {
+      result.cq_ring_ = nullptr;
+      return {ec::unspecified};
+    }
+  }
+  result.sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  result.sqes_ = ::mmap(nullptr, result.sqes_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (result.sqes_ == MAP_FAILED) {
+    result.sqes_ = nullptr;
+    return {ec::unspecified};
+  }
+  auto sq_base = static_cast<char*>(result.sq_ring_);
+  result.sq_head_
+    = reinterpret_cast<uint32_t*>(sq_base + params.sq_off.head);
+  result.sq_tail_
+    = reinterpret_cast<uint32_t*>(sq_base + params.sq_off.tail);
+  result.sq_mask_
+    = *reinterpret_cast<uint32_t*>(sq_base + params.sq_off.ring_mask);
+  result.sq_array_
+    = reinterpret_cast<uint32_t*>(sq_base + params.sq_off.array);
+  auto cq_base = static_cast<char*>(result.cq_ring_);
+  result.cq_head_
+    = reinterpret_cast<uint32_t*>(cq_base + params.cq_off.head);
+  result.cq_tail_
+    = reinterpret_cast<uint32_t*>(cq_base + params.cq_off.tail);
+  result.cq_mask_
+    = *reinterpret_cast<uint32_t*>(cq_base + params.cq_off.ring_mask);
+  result.cqes_ = cq_base + params.cq_off.cqes;
+#ifdef IORING_ACCEPT_MULTISHOT
+  // No feature or probe bit covers the multishot accept flag; it appeared in
+  // kernel 5.19 together with no queryable capability.
+  result.multishot_accept_ = kernel_at_least(5, 19);
+#endif
+  return result;
+}
+
+expected<void> uring_loop::register_buffers(
+  const std::vector<std::pair<void*, size_t>>& buffers) {
+  std::vector<iovec> iovs;
+  iovs.reserve(buffers.size());
+  for (auto& [base, len] : buffers)
+    iovs.push_back(iovec{base, len});
+  if (sys_io_uring_register(ring_fd_, IORING_REGISTER_BUFFERS, iovs.data(),
+                            static_cast<unsigned>(iovs.size()))
+      != 0)
+    return {ec::unspecified};
+  return {};
+}
+
+void* uring_loop::next_sqe(uint8_t opcode, native_socket fd,
+                           uint64_t user_data) {
+  auto head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  auto tail = *sq_tail_;
+  if (tail - head > sq_mask_)
+    return nullptr; // Submission queue is full.
+  auto index = tail & sq_mask_;
+  auto* sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+  std::memset(sqe, 0, sizeof(io_uring_sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++staged_;
+  return sqe;
+}
+
+bool uring_loop::prep_recv(native_socket fd, void* buf, size_t size,
+                           uint64_t user_data) {
+  auto* sqe = static_cast<io_uring_sqe*>(
+    next_sqe(IORING_OP_RECV, fd, user_data));
+  if (sqe == nullptr)
+    return false;
+  sqe->addr = reinterpret_cast<uint64_t>(buf);
+  sqe->len = static_cast<uint32_t>(size);
+  return true;
+}
+
+bool uring_loop::prep_recv_fixed(native_socket fd, uint16_t index, void* buf,
+                                 size_t size, uint64_t user_data) {
+  auto* sqe = static_cast<io_uring_sqe*>(
+    next_sqe(IORING_OP_READ_FIXED, fd, user_data));
+  if (sqe == nullptr)
+    return false;
+  sqe->addr = reinterpret_cast<uint64_t>(buf);
+  sqe->len = static_cast<uint32_t>(size);
+  sqe->buf_index = index;
+  return true;
+}
+
+bool uring_loop::prep_send(native_socket fd, const void* buf, size_t size,
+                           uint64_t user_data) {
+  auto* sqe = static_cast<io_uring_sqe*>(
+    next_sqe(IORING_OP_SEND, fd, user_data));
+  if (sqe == nullptr)
+    return false;
+  sqe->addr = reinterpret_cast<uint64_t>(buf);
+  sqe->len = static_cast<uint32_t>(size);
+  return true;
+}
+
+bool uring_loop::prep_accept(native_socket fd, uint64_t user_data) {
+  auto* sqe = static_cast<io_uring_sqe*>(
+    next_sqe(IORING_OP_ACCEPT, fd, user_data));
+  if (sqe == nullptr)
+    return false;
+#ifdef IORING_ACCEPT_MULTISHOT
+  if (multishot_accept_)
+    sqe->ioprio |= IORING_ACCEPT_MULTISHOT;
+#endif
+  return true;
+}
+
+expected<size_t> uring_loop::submit() {
+  return enter(staged_, 0, 0);
+}
+
+expected<size_t> uring_loop::run(std::vector<completion>& out,
+                                 size_t min_complete) {
+  if (auto res = enter(staged_, static_cast<unsigned>(min_complete),
+                       IORING_ENTER_GETEVENTS);
+      !res)
+    return res.error();
+  return poll(out);
+}
+
+size_t uring_loop::poll(std::vector<completion>& out) {
+  auto head = *cq_head_;
+  auto tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  size_t result = 0;
+  while (head != tail) {
+    auto* cqe = static_cast<io_uring_cqe*>(cqes_) + (head & cq_mask_);
+    out.push_back(completion{cqe->user_data, cqe->res, cqe->flags});
+    ++head;
+    ++result;
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  return result;
+}
+
+expected<size_t> uring_loop::enter(unsigned to_submit, unsigned min_complete,
+                                   unsigned flags) {
+  for (;;) {
+    auto res = sys_io_uring_enter(ring_fd_, to_submit, min_complete, flags);
+    if (res >= 0) {
+      staged_ -= std::min(staged_, static_cast<unsigned>(res));
+      return static_cast<size_t>(res);
+    }
+    if (errno != EINTR)
+      return {ec::unspecified};
+  }
+}
+
+} // namespace broker::detail
+
+#endif // BROKER_HAVE_IO_URING
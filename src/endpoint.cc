@@ -2,15 +2,23 @@
 
 #include "broker/configuration.hh"
 #include "broker/defaults.hh"
+#include "broker/detail/async_logger.hh"
 #include "broker/detail/die.hh"
 #include "broker/detail/filesystem.hh"
+#include "broker/detail/prefix_matcher.hh"
+#include "broker/detail/publish_limiter.hh"
+#include "broker/detail/store_file.hh"
+#include "broker/detail/topic_shard.hh"
+#include "broker/filter_type.hh"
 #include "broker/internal/configuration_access.hh"
 #include "broker/internal/core_actor.hh"
 #include "broker/internal/endpoint_access.hh"
+#include "broker/internal/lag_watchdog.hh"
 #include "broker/internal/logger.hh"
 #include "broker/internal/metric_exporter.hh"
 #include "broker/internal/prometheus.hh"
 #include "broker/publisher.hh"
+#include "broker/shared_publisher.hh"
 #include "broker/status_subscriber.hh"
 #include "broker/subscriber.hh"
 #include "broker/timeout.hh"
@@ -50,6 +58,13 @@ caf::actor_system_config& nat_cfg(configuration& cfg) {
   return helper.cfg();
 }
 
+/// Priority tag for control-plane messages to the core actor. High-priority
+/// messages land in the urgent queue of the actor's mailbox and overtake
+/// queued data batches, so peering control and filter updates complete
+/// independently of the data backlog. CAF still drains both queues with a
+/// bounded quantum per run, so data traffic cannot starve either.
+constexpr auto ctrl = caf::message_priority::high;
+
 } // namespace
 
 // --- nested classes ----------------------------------------------------------
@@ -277,18 +292,21 @@ private:
 // --- metrics_exporter_t::endpoint class --------------------------------------
 
 void endpoint::metrics_exporter_t::set_interval(caf::timespan new_interval) {
+  parent_->ensure_metric_exporter();
   if (new_interval.count() > 0)
     caf::anon_send(native(parent_->telemetry_exporter_), atom::put_v,
                    new_interval);
 }
 
 void endpoint::metrics_exporter_t::set_target(topic new_target) {
+  parent_->ensure_metric_exporter();
   if (!new_target.empty())
     caf::anon_send(native(parent_->telemetry_exporter_), atom::put_v,
                    std::move(new_target));
 }
 
 void endpoint::metrics_exporter_t::set_id(std::string new_id) {
+  parent_->ensure_metric_exporter();
   if (!new_id.empty())
     caf::anon_send(native(parent_->telemetry_exporter_), atom::put_v,
                    std::move(new_id));
@@ -299,6 +317,7 @@ void endpoint::metrics_exporter_t::set_prefixes(
   // We only wrap the prefixes into a filter to get around assigning a type ID
   // to std::vector<std::string> (which technically would require us to change
   // Broker ID on the network).
+  parent_->ensure_metric_exporter();
   filter_type boxed;
   for (auto& prefix : new_prefixes)
     boxed.emplace_back(std::move(prefix));
@@ -309,6 +328,7 @@ void endpoint::metrics_exporter_t::set_prefixes(
 // --- endpoint class ----------------------------------------------------------
 
 endpoint_id endpoint::node_id() const {
+  ensure_init();
   return facade(ctx_->sys.node());
 }
 
@@ -362,13 +382,51 @@ endpoint::endpoint() : endpoint(configuration{}) {
   // nop
 }
 
-endpoint::endpoint(configuration config) {
+endpoint::endpoint(configuration config)
+  : publish_limiter_(std::make_shared<detail::publish_limiter>()) {
+  if (config.options().lazy_init) {
+    BROKER_INFO("deferring endpoint initialization until first use");
+    pending_cfg_ = std::make_unique<configuration>(std::move(config));
+    return;
+  }
+  init_context(std::move(config));
+}
+
+void endpoint::ensure_init() const {
+  // Deferred bring-up counts as logically const: observable state only moves
+  // from "pending" to "initialized".
+  auto self = const_cast<endpoint*>(this);
+  if (self->ctx_ == nullptr && self->pending_cfg_ != nullptr) {
+    auto cfg = std::move(*self->pending_cfg_);
+    self->pending_cfg_.reset();
+    self->init_context(std::move(cfg));
+  }
+}
+
+void endpoint::init_context(configuration config) {
   ctx_ = std::make_shared<internal::endpoint_context>(std::move(config));
   auto& sys = ctx_->sys;
   auto& cfg = nat_cfg(ctx_->cfg);
   // Stop immediately if any helptext was printed.
   if (cfg.cli_helptext_printed)
     exit(0);
+  // Route BROKER_* log output through the asynchronous backend if requested.
+  if (auto lvl = caf::get_as<std::string>(cfg, "broker.async-log-level")) {
+    using detail::async_logger;
+    auto level = async_logger::level_quiet;
+    if (*lvl == "error")
+      level = async_logger::level_error;
+    else if (*lvl == "warning")
+      level = async_logger::level_warning;
+    else if (*lvl == "info")
+      level = async_logger::level_info;
+    else if (*lvl == "debug")
+      level = async_logger::level_debug;
+    else if (*lvl == "trace")
+      level = async_logger::level_trace;
+    auto path = caf::get_or(cfg, "broker.async-log-file", std::string{});
+    async_logger::instance().configure(level, path);
+  }
   // Create a directory for storing the meta data if requested.
   auto meta_dir = get_or(cfg, "broker.recording-directory",
                          caf::string_view{defaults::recording_directory});
@@ -393,11 +451,45 @@ endpoint::endpoint(configuration config) {
     clock_.reset(new real_time_clock(ctx_.get()));
   else
     clock_.reset(new sim_clock(ctx_.get()));
+  auto mem_budget = caf::get_or(cfg, "broker.memory-budget",
+                                defaults::memory_budget);
+  mem_accountant_ = detail::make_memory_accountant(*this, mem_budget);
+  peer_table_ = std::make_shared<detail::peer_status_table>();
+  // The watchdog must exist before the core spawns so that the core and all
+  // stores find it in the actor registry and enroll themselves. It quits on
+  // its own when the last enrolled actor terminates.
+  if (auto lag_interval
+      = caf::get_or(cfg, "broker.metrics.scheduler-lag-interval",
+                    defaults::metrics::scheduler_lag_interval);
+      lag_interval.count() > 0) {
+    BROKER_INFO("starting scheduler-lag watchdog");
+    sys.spawn<internal::lag_watchdog_actor>();
+  }
   if (ctx_->sys.has_openssl_manager() || opts.disable_ssl) {
     BROKER_INFO("creating core actor");
-    auto hdl
-      = sys.spawn<internal::core_actor_type>(filter_type{}, opts, clock_.get());
+    auto hdl = sys.spawn<internal::core_actor_type>(filter_type{}, opts,
+                                                    clock_.get(),
+                                                    mem_accountant_,
+                                                    peer_table_);
     core_ = facade(hdl);
+    // Spawn extra core actors for partitioning the local publish path by topic
+    // hash. The shards peer with the primary core over regular streams, so
+    // subscriptions and remote peerings keep working unchanged while publish
+    // traffic fans out over multiple scheduler threads.
+    if (auto n = caf::get_or(cfg, "broker.dispatch-shards", size_t{1}); n > 1) {
+      BROKER_INFO("creating" << n << "dispatch shards");
+      for (size_t i = 0; i < n; ++i) {
+        auto shard = sys.spawn<internal::core_actor_type>(filter_type{}, opts,
+                                                          clock_.get(),
+                                                          mem_accountant_);
+        caf::anon_send<ctrl>(shard, atom::peer_v, hdl);
+        dispatch_shards_.emplace_back(facade(shard));
+      }
+      // Preconfigured order-insensitive prefixes; see `mark_unordered`.
+      for (auto& str : caf::get_or(cfg, "broker.unordered-topics",
+                                   std::vector<std::string>{}))
+        filter_extend(unordered_topics_, topic{str});
+    }
   } else {
     detail::die("SSL is enabled but CAF OpenSSL manager is not available");
   }
@@ -413,14 +505,61 @@ endpoint::endpoint(configuration config) {
     } else {
       BROKER_ERROR("failed to expose metrics:" << actual_port.error());
     }
-  } else {
-    using exporter_t = internal::metric_exporter_actor;
-    auto params = internal::metric_exporter_params::from(cfg);
-    auto hdl = sys.spawn<exporter_t>(native(core_), std::move(params));
-    telemetry_exporter_ = facade(hdl);
+  } else if (internal::metric_exporter_params::from(cfg).valid()) {
+    // Only spawn the exporter when a target topic is configured; an
+    // unconfigured exporter burns a thread without ever publishing. Runtime
+    // configuration through `metrics_exporter()` spawns it on demand.
+    ensure_metric_exporter();
+  }
+  // Restore a previous checkpoint before the endpoint accepts any peerings.
+  if (auto dir = caf::get_or(cfg, "broker.checkpoint-directory", std::string{});
+      !dir.empty() && detail::exists(dir + "/endpoint.meta")) {
+    BROKER_INFO("restoring checkpoint from" << dir);
+    if (auto res = restore_checkpoint(dir); !res)
+      BROKER_WARNING("failed to restore checkpoint from" << dir << ":"
+                                                         << res.error());
   }
 }
 
+void endpoint::ensure_metric_exporter() {
+  if (telemetry_exporter_ != nullptr || destroyed_)
+    return;
+  ensure_init();
+  // Spawn the exporter detached so that scraping the registry runs on its
+  // own thread and never competes with message dispatch for scheduler
+  // workers. The Prometheus task gets the same isolation from its dedicated
+  // multiplexer thread.
+  using exporter_t = internal::metric_exporter_actor;
+  auto params = internal::metric_exporter_params::from(nat_cfg(ctx_->cfg));
+  auto hdl = ctx_->sys.spawn<exporter_t, caf::detached>(native(core_),
+                                                        std::move(params));
+  telemetry_exporter_ = facade(hdl);
+}
+
+endpoint::endpoint(shares_runtime_t, endpoint& host)
+  : publish_limiter_(std::make_shared<detail::publish_limiter>()) {
+  host.ensure_init();
+  ctx_ = host.ctx_;
+  auto& sys = ctx_->sys;
+  auto& opts = ctx_->cfg.options();
+  if (opts.use_real_time)
+    clock_.reset(new real_time_clock(ctx_.get()));
+  else
+    clock_.reset(new sim_clock(ctx_.get()));
+  BROKER_INFO("creating core actor for logical endpoint");
+  // Logical endpoints share the memory accounting of their host, but publish
+  // their own peer table: each logical endpoint has its own core actor.
+  mem_accountant_ = host.mem_accountant_;
+  peer_table_ = std::make_shared<detail::peer_status_table>();
+  auto hdl = sys.spawn<internal::core_actor_type>(filter_type{}, opts,
+                                                  clock_.get(),
+                                                  mem_accountant_,
+                                                  peer_table_);
+  core_ = facade(hdl);
+  // No telemetry exporter or Prometheus task here: the host endpoint already
+  // exports the registry that all cores in the shared system feed into.
+}
+
 endpoint::~endpoint() {
   BROKER_INFO("destroying endpoint");
   shutdown();
@@ -431,9 +570,23 @@ void endpoint::shutdown() {
   if (destroyed_)
     return;
   destroyed_ = true;
+  if (ctx_ == nullptr) {
+    // Lazy endpoint that never got used: nothing to tear down.
+    pending_cfg_.reset();
+    return;
+  }
+  // Write a checkpoint while the core and all stores are still alive.
+  if (auto dir = caf::get_or(nat_cfg(ctx_->cfg), "broker.checkpoint-directory",
+                             std::string{});
+      !dir.empty()) {
+    BROKER_INFO("writing checkpoint to" << dir);
+    if (auto res = save_checkpoint(dir); !res)
+      BROKER_WARNING("failed to write checkpoint to" << dir << ":"
+                                                     << res.error());
+  }
   if (!await_stores_on_shutdown_) {
     BROKER_DEBUG("tell core actor to terminate stores");
-    caf::anon_send(native(core_), atom::shutdown_v, atom::store_v);
+    caf::anon_send<ctrl>(native(core_), atom::shutdown_v, atom::store_v);
   }
   if (!children_.empty()) {
     caf::scoped_actor self{ctx_->sys};
@@ -452,14 +605,21 @@ void endpoint::shutdown() {
   BROKER_DEBUG("stop background tasks");
   telemetry_exporter_ = nullptr;
   background_tasks_.clear();
+  if (!dispatch_shards_.empty()) {
+    BROKER_DEBUG("send shutdown messages to dispatch shards");
+    for (auto& shard : dispatch_shards_)
+      caf::anon_send<ctrl>(native(shard), atom::shutdown_v);
+    dispatch_shards_.clear();
+  }
   BROKER_DEBUG("send shutdown message to core actor");
-  caf::anon_send(native(core_), atom::shutdown_v);
+  caf::anon_send<ctrl>(native(core_), atom::shutdown_v);
   core_ = nullptr;
   clock_.reset();
   ctx_.reset();
 }
 
 uint16_t endpoint::listen(const std::string& address, uint16_t port) {
+  ensure_init();
   BROKER_INFO("listening on"
               << (address + ":" + std::to_string(port))
               << (ctx_->cfg.options().disable_ssl ? "(no SSL)" : "(SSL)"));
@@ -479,6 +639,7 @@ uint16_t endpoint::listen(const std::string& address, uint16_t port) {
 
 bool endpoint::peer(const std::string& address, uint16_t port,
                     timeout::seconds retry) {
+  ensure_init();
   BROKER_TRACE(BROKER_ARG(address) << BROKER_ARG(port) << BROKER_ARG(retry));
   BROKER_INFO("starting to peer with" << (address + ":" + std::to_string(port))
                                       << "retry:" << to_string(retry)
@@ -486,8 +647,8 @@ bool endpoint::peer(const std::string& address, uint16_t port,
   bool result = false;
   caf::scoped_actor self{ctx_->sys};
   self
-    ->request(native(core_), caf::infinite, atom::peer_v,
-              network_info{address, port, retry})
+    ->request<ctrl>(native(core_), caf::infinite, atom::peer_v,
+                    network_info{address, port, retry})
     .receive([&](const caf::actor&) { result = true; },
              [&](caf::error& err) {
                BROKER_DEBUG("Cannot peer to" << address << "on port" << port
@@ -496,25 +657,51 @@ bool endpoint::peer(const std::string& address, uint16_t port,
   return result;
 }
 
+std::future<bool> endpoint::peer_async(const std::string& address,
+                                       uint16_t port, timeout::seconds retry) {
+  ensure_init();
+  BROKER_TRACE(BROKER_ARG(address) << BROKER_ARG(port) << BROKER_ARG(retry));
+  BROKER_INFO("starting to peer with" << (address + ":" + std::to_string(port))
+                                      << "retry:" << to_string(retry)
+                                      << "[future]");
+  auto prom = std::make_shared<std::promise<bool>>();
+  auto result = prom->get_future();
+  auto core = native(core_);
+  ctx_->sys.spawn([=](caf::event_based_actor* self) {
+    self
+      ->request<ctrl>(core, caf::infinite, atom::peer_v,
+                      network_info{address, port, retry})
+      .then([prom](const caf::actor&) { prom->set_value(true); },
+            [prom, address, port](caf::error& err) {
+              BROKER_DEBUG("Cannot peer to" << address << "on port" << port
+                                            << ":" << err);
+              prom->set_value(false);
+            });
+  });
+  return result;
+}
+
 void endpoint::peer_nosync(const std::string& address, uint16_t port,
 			   timeout::seconds retry) {
+  ensure_init();
   BROKER_TRACE(BROKER_ARG(address) << BROKER_ARG(port));
   BROKER_INFO("starting to peer with" << (address + ":" + std::to_string(port))
                                       << "retry:" << to_string(retry)
                                       << "[asynchronous]");
-  caf::anon_send(native(core_), atom::peer_v,
-                 network_info{address, port, retry});
+  caf::anon_send<ctrl>(native(core_), atom::peer_v,
+                       network_info{address, port, retry});
 }
 
 bool endpoint::unpeer(const std::string& address, uint16_t port) {
+  ensure_init();
   BROKER_TRACE(BROKER_ARG(address) << BROKER_ARG(port));
   BROKER_INFO("stopping to peer with" << address << ":" << port
                                       << "[synchronous]");
   bool result = false;
   caf::scoped_actor self{ctx_->sys};
   self
-    ->request(native(core_), caf::infinite, atom::unpeer_v,
-              network_info{address, port})
+    ->request<ctrl>(native(core_), caf::infinite, atom::unpeer_v,
+                    network_info{address, port})
     .receive([&](void) { result = true; },
              [&](caf::error& err) {
                BROKER_DEBUG("Cannot unpeer from" << address << "on port" << port
@@ -524,33 +711,152 @@ bool endpoint::unpeer(const std::string& address, uint16_t port) {
   return result;
 }
 
+bool endpoint::unpeer_gracefully(const std::string& address, uint16_t port,
+                                 timeout::seconds drain_timeout) {
+  ensure_init();
+  BROKER_TRACE(BROKER_ARG(address) << BROKER_ARG(port));
+  BROKER_INFO("draining peering with" << address << ":" << port
+                                      << "[synchronous]");
+  bool result = false;
+  caf::scoped_actor self{ctx_->sys};
+  auto timeout = std::chrono::duration_cast<caf::timespan>(drain_timeout);
+  self
+    ->request<ctrl>(native(core_), caf::infinite, atom::unpeer_v,
+                    atom::drain_v, network_info{address, port}, timeout)
+    .receive([&](void) { result = true; },
+             [&](caf::error& err) {
+               BROKER_DEBUG("Cannot drain peering with"
+                            << address << "on port" << port << ":" << err);
+             });
+  return result;
+}
+
 void endpoint::unpeer_nosync(const std::string& address, uint16_t port) {
+  ensure_init();
   BROKER_TRACE(BROKER_ARG(address) << BROKER_ARG(port));
   BROKER_INFO("stopping to peer with " << address << ":" << port
                                        << "[asynchronous]");
-  caf::anon_send(native(core_), atom::unpeer_v, network_info{address, port});
+  caf::anon_send<ctrl>(native(core_), atom::unpeer_v,
+                       network_info{address, port});
 }
 
-std::vector<peer_info> endpoint::peers() const {
-  std::vector<peer_info> result;
+bool endpoint::dump_flight_recorder(const std::string& directory) {
+  ensure_init();
+  BROKER_TRACE(BROKER_ARG(directory));
+  bool result = false;
   caf::scoped_actor self{ctx_->sys};
-  self->request(native(core_), caf::infinite, atom::get_v, atom::peer_v)
-  .receive(
-    [&](std::vector<peer_info>& peers) {
-      result = std::move(peers);
-    },
-    [](const caf::error& e) {
-      detail::die("failed to get peers:", to_string(e));
-    }
-  );
+  self
+    ->request(native(core_), caf::infinite, atom::dump_v, directory)
+    .receive([&](atom::ok) { result = true; },
+             [&](caf::error& err) {
+               BROKER_WARNING("cannot dump flight recorder to" << directory
+                                                               << ":" << err);
+             });
+  return result;
+}
+
+bool endpoint::reconfigure(const std::string& key, data value) {
+  ensure_init();
+  BROKER_TRACE(BROKER_ARG(key) << BROKER_ARG(value));
+  bool result = false;
+  caf::scoped_actor self{ctx_->sys};
+  self
+    ->request(native(core_), caf::infinite, atom::put_v, key, std::move(value))
+    .receive([&](atom::ok) { result = true; },
+             [&](caf::error& err) {
+               BROKER_WARNING("cannot reconfigure" << key << ":" << err);
+             });
+  return result;
+}
+
+expected<void> endpoint::save_checkpoint(const std::string& directory) {
+  ensure_init();
+  BROKER_TRACE(BROKER_ARG(directory));
+  expected<void> result{ec::unspecified};
+  caf::scoped_actor self{ctx_->sys};
+  self
+    ->request(native(core_), caf::infinite, atom::checkpoint_v, directory)
+    .receive([&](atom::ok) { result = {}; },
+             [&](caf::error& err) { result = facade(err); });
   return result;
 }
 
+expected<void> endpoint::restore_checkpoint(const std::string& directory) {
+  ensure_init();
+  BROKER_TRACE(BROKER_ARG(directory));
+  detail::store_file_reader reader;
+  if (auto res = reader.open(directory + "/endpoint.meta"); !res)
+    return res;
+  std::vector<topic> filter;
+  std::vector<std::pair<std::string, uint16_t>> peer_addrs;
+  std::vector<std::string> store_names;
+  data key;
+  data value;
+  for (;;) {
+    auto more = reader.read(key, value);
+    if (!more)
+      return more.error();
+    if (!*more)
+      break;
+    auto section = get_if<std::string>(key);
+    if (!section)
+      return make_error(ec::invalid_data, "malformed checkpoint metadata");
+    if (*section == "version") {
+      if (value != data{count{1}})
+        return make_error(ec::invalid_data, "unknown checkpoint version");
+    } else if (*section == "filter") {
+      if (auto xs = get_if<vector>(value))
+        for (auto& x : *xs)
+          if (auto str = get_if<std::string>(x))
+            filter.emplace_back(*str);
+    } else if (*section == "peers") {
+      if (auto xs = get_if<vector>(value))
+        for (auto& x : *xs)
+          if (auto fields = get_if<vector>(x); fields && fields->size() == 2) {
+            auto host = get_if<std::string>((*fields)[0]);
+            auto port = get_if<count>((*fields)[1]);
+            if (host && port)
+              peer_addrs.emplace_back(*host, static_cast<uint16_t>(*port));
+          }
+    } else if (*section == "stores") {
+      if (auto xs = get_if<vector>(value))
+        for (auto& x : *xs)
+          if (auto str = get_if<std::string>(x))
+            store_names.emplace_back(*str);
+    }
+    // Unknown sections from newer versions get skipped silently.
+  }
+  // Re-announce the filter before peering, so the peering handshake carries
+  // the full subscription set right away.
+  if (!filter.empty())
+    forward(std::move(filter));
+  for (auto& name : store_names) {
+    auto hdl = attach_master(name, backend::memory);
+    if (!hdl)
+      return hdl.error();
+    if (auto res = hdl->load_from(directory + "/store-" + name + ".dat"); !res)
+      return res;
+  }
+  // Peerings go last and run asynchronously with the regular retry logic.
+  for (auto& [host, port] : peer_addrs)
+    peer_nosync(host, port);
+  return {};
+}
+
+std::vector<peer_info> endpoint::peers() const {
+  ensure_init();
+  // The core publishes a fresh snapshot on every peering change, so reading
+  // it here never round-trips through the actor. Supervisors may poll this
+  // at high frequency without adding load to the dispatch path.
+  return *peer_table_->snapshot();
+}
+
 std::vector<topic> endpoint::peer_subscriptions() const {
+  ensure_init();
   std::vector<topic> result;
   caf::scoped_actor self{ctx_->sys};
-  self->request(native(core_), caf::infinite, atom::get_v,
-                atom::peer_v, atom::subscriptions_v)
+  self->request<ctrl>(native(core_), caf::infinite, atom::get_v,
+                      atom::peer_v, atom::subscriptions_v)
   .receive(
     [&](std::vector<topic>& ts) {
       result = std::move(ts);
@@ -564,36 +870,78 @@ std::vector<topic> endpoint::peer_subscriptions() const {
 
 void endpoint::forward(std::vector<topic> ts)
 {
+  ensure_init();
   BROKER_INFO("forwarding topics" << ts);
-  caf::anon_send(native(core_), atom::subscribe_v, std::move(ts));
+  caf::anon_send<ctrl>(native(core_), atom::subscribe_v, std::move(ts));
 }
 
 void endpoint::publish(topic t, data d) {
   BROKER_INFO("publishing" << std::make_pair(t, d));
-  caf::anon_send(native(core_), atom::publish_v,
-                 make_data_message(std::move(t), std::move(d)));
+  publish(make_data_message(std::move(t), std::move(d)));
 }
 
 void endpoint::publish(const endpoint_info& dst, topic t, data d) {
+  ensure_init();
+  if (!publish_limiter_->admit(t))
+    return;
   BROKER_INFO("publishing" << std::make_pair(t, d) << "to" << dst.node);
   caf::anon_send(native(core_), atom::publish_v, dst,
                  make_data_message(std::move(t), std::move(d)));
 }
 
 void endpoint::publish(data_message x){
+  ensure_init();
+  if (!publish_limiter_->admit(get_topic(x)))
+    return;
   BROKER_INFO("publishing" << x);
-  caf::anon_send(native(core_), atom::publish_v, std::move(x));
+  if (dispatch_shards_.empty()) {
+    caf::anon_send(native(core_), atom::publish_v, std::move(x));
+  } else {
+    // Ordered topics pin to a shard by hash to keep per-topic FIFO delivery;
+    // unordered topics spread round-robin for parallel dispatch.
+    size_t index;
+    if (detail::prefix_matcher{}(unordered_topics_, get_topic(x)))
+      index = unordered_cursor_++ % dispatch_shards_.size();
+    else
+      index = detail::topic_shard(get_topic(x), dispatch_shards_.size());
+    caf::anon_send(native(dispatch_shards_[index]), atom::publish_v,
+                   std::move(x));
+  }
 }
 
 
 void endpoint::publish(std::vector<data_message> xs) {
+  publish(span<data_message>{xs.data(), xs.size()});
+}
+
+void endpoint::publish(span<data_message> xs) {
   BROKER_INFO("publishing" << xs.size() << "messages");
   for (auto& x : xs)
     publish(std::move(x));
 }
 
-publisher endpoint::make_publisher(topic ts) {
-  publisher result{*this, std::move(ts)};
+void endpoint::limit_publish_rate(topic prefix, publish_limit limit) {
+  BROKER_INFO("limiting publish rate for" << prefix << "to"
+                                          << limit.messages_per_second
+                                          << "messages per second");
+  publish_limiter_->attach(std::move(prefix), limit);
+}
+
+uint64_t endpoint::publish_limit_drops() const noexcept {
+  return publish_limiter_->dropped();
+}
+
+void endpoint::mark_unordered(topic prefix) {
+  BROKER_INFO("marking topics under" << prefix << "as order-insensitive");
+  filter_extend(unordered_topics_, prefix);
+}
+
+shared_publisher endpoint::make_shared_publisher(topic ts) {
+  return shared_publisher{make_publisher(std::move(ts))};
+}
+
+publisher endpoint::make_publisher(topic ts, int numa_node) {
+  publisher result{*this, std::move(ts), numa_node};
   children_.emplace_back(result.worker());
   return result;
 }
@@ -604,14 +952,39 @@ status_subscriber endpoint::make_status_subscriber(bool receive_statuses) {
   return result;
 }
 
-subscriber endpoint::make_subscriber(std::vector<topic> ts, size_t max_qsize) {
-  subscriber result{*this, std::move(ts), max_qsize};
+store_event_subscriber
+endpoint::make_store_event_subscriber(std::string store_name,
+                                      size_t max_qsize) {
+  store_event_subscriber result{*this, std::move(store_name), max_qsize};
+  children_.emplace_back(result.worker());
+  return result;
+}
+
+subscriber endpoint::make_subscriber(std::vector<topic> ts, size_t max_qsize,
+                                     int numa_node) {
+  subscriber result{*this, std::move(ts), max_qsize, backpressure_options{},
+                    nullptr, numa_node};
   children_.emplace_back(result.worker());
   return result;
 }
 
+subscriber endpoint::make_subscriber(std::vector<topic> ts,
+                                     backpressure_options opts,
+                                     size_t max_qsize, int numa_node) {
+  subscriber result{*this, std::move(ts), max_qsize, std::move(opts), nullptr,
+                    numa_node};
+  children_.emplace_back(result.worker());
+  return result;
+}
+
+subscriber endpoint::make_direct_subscriber(std::vector<topic> ts,
+                                            size_t max_qsize) {
+  return subscriber{*this, std::move(ts), max_qsize, subscriber::direct_tag{}};
+}
+
 template <class F>
 worker endpoint::make_worker(F fn) {
+  ensure_init();
   auto nat = ctx_->sys.spawn([f{std::move(fn)}](caf::event_based_actor* self) {
 #ifndef CAF_NO_EXCEPTION
     // "Hide" unhandled-exception warning if users throw.
@@ -630,6 +1003,8 @@ worker endpoint::make_worker(F fn) {
 }
 
 broker_options endpoint::options() const {
+  if (ctx_ == nullptr && pending_cfg_ != nullptr)
+    return pending_cfg_->options();
   return ctx_->cfg.options();
 }
 
@@ -712,6 +1087,7 @@ worker endpoint::do_publish_all(std::shared_ptr<detail::source_driver> driver,
 
 expected<store> endpoint::attach_master(std::string name, backend type,
                                         backend_options opts) {
+  ensure_init();
   BROKER_INFO("attaching master store" << name << "of type" << type);
   expected<store> res{ec::unspecified};
   caf::scoped_actor self{ctx_->sys};
@@ -726,17 +1102,53 @@ expected<store> endpoint::attach_master(std::string name, backend type,
   return res;
 }
 
+expected<store> endpoint::attach_derived(std::string name,
+                                         const std::string& base,
+                                         store_derivation f, backend type,
+                                         backend_options opts) {
+  ensure_init();
+  BROKER_INFO("attaching derived store" << name << "to base" << base);
+  if (!f)
+    return make_error(ec::invalid_data, "empty derivation function");
+  caf::scoped_actor self{ctx_->sys};
+  // Resolve the base master; it has to live on this endpoint because the
+  // derivation function never crosses the network.
+  caf::actor base_hdl;
+  caf::error err;
+  self
+    ->request(native(core_), caf::infinite, atom::store_v, atom::master_v,
+              atom::get_v, base)
+    .receive([&](caf::actor& hdl) { base_hdl = std::move(hdl); },
+             [&](caf::error& e) { err = std::move(e); });
+  if (err)
+    return facade(err);
+  auto res = attach_master(std::move(name), type, std::move(opts));
+  if (!res)
+    return res;
+  // Install the derivation on the base master, which seeds the derived store
+  // from its current content before going incremental.
+  self
+    ->request(base_hdl, caf::infinite, atom::derive_v,
+              native(res->frontend()), std::move(f))
+    .receive([&](atom::ok) {}, [&](caf::error& e) { err = std::move(e); });
+  if (err)
+    return facade(err);
+  return res;
+}
+
 expected<store> endpoint::attach_clone(std::string name,
                                        double resync_interval,
                                        double stale_interval,
-                                       double mutation_buffer_interval) {
+                                       double mutation_buffer_interval,
+                                       bool local_writes) {
+  ensure_init();
   BROKER_INFO("attaching clone store" << name);
   expected<store> res{ec::unspecified};
   caf::scoped_actor self{ctx_->sys};
   self
     ->request(native(core_), caf::infinite, atom::store_v, atom::clone_v,
               atom::attach_v, name, resync_interval, stale_interval,
-              mutation_buffer_interval)
+              mutation_buffer_interval, local_writes)
     .receive(
       [&](caf::actor& clone) {
         res = store{facade(clone), std::move(name)};
@@ -746,6 +1158,7 @@ expected<store> endpoint::attach_clone(std::string name,
 }
 
 void endpoint::wait_for(worker who) {
+  ensure_init();
   caf::scoped_actor tmp{ctx_->sys};
   tmp->wait_for(native(who));
 }
@@ -768,14 +1181,17 @@ endpoint_context::endpoint_context(configuration&& src)
 }
 
 caf::actor_system& endpoint_access::sys() {
+  ep->ensure_init();
   return ep->ctx_->sys;
 }
 
 const caf::actor_system_config& endpoint_access::cfg() {
+  ep->ensure_init();
   return nat_cfg(ep->ctx_->cfg);
 }
 
 std::shared_ptr<endpoint_context> endpoint_access::ctx() {
+  ep->ensure_init();
   return ep->ctx_;
 }
 
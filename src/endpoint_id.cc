@@ -4,6 +4,7 @@
 
 #include <caf/node_id.hpp>
 
+#include "broker/detail/hash.hh"
 #include "broker/internal/native.hh"
 
 namespace broker {
@@ -61,7 +62,10 @@ int endpoint_id::compare(const endpoint_id& other) const noexcept {
 
 size_t endpoint_id::hash() const noexcept {
   std::hash<caf::node_id> f;
-  return f(native(*this));
+  // Run the FNV-style digest through the project-wide mixer for a full
+  // avalanche; node IDs differ in few bytes and land in hash-keyed routing
+  // tables.
+  return detail::hash_mix(f(native(*this)), detail::hash_secret[2]);
 }
 
 endpoint_id::impl* endpoint_id::native_ptr() noexcept {
@@ -8,6 +8,8 @@
 
 #include "caf/const_typed_message_view.hpp"
 
+#include <array>
+
 static_assert(sizeof(caf::error) == sizeof(broker::error::impl*));
 static_assert(std::is_same_v<caf::type_id_t, uint16_t>);
 
@@ -147,6 +149,18 @@ error make_error(ec code, endpoint_info info, std::string description) {
   return error{code, std::move(info), std::move(description)};
 }
 
+const error& interned_error(ec code) {
+  static const auto instances = [] {
+    std::array<error, std::size(ec_names)> result;
+    for (size_t index = 0; index < result.size(); ++index)
+      result[index] = error{static_cast<ec>(index)};
+    return result;
+  }();
+  auto index = static_cast<uint8_t>(code);
+  BROKER_ASSERT(index < instances.size());
+  return instances[index];
+}
+
 std::string to_string(ec code) {
   auto index = static_cast<uint8_t>(code);
   BROKER_ASSERT(index < sizeof(ec_names));
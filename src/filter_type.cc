@@ -1,6 +1,7 @@
 #include "broker/filter_type.hh"
 
 #include <algorithm>
+#include <iterator>
 
 namespace broker {
 
@@ -50,4 +51,48 @@ bool filter_extend(filter_type& f, const filter_type& other) {
   return count > 0;
 }
 
+filter_diff make_filter_diff(const filter_type& old_filter,
+                             const filter_type& new_filter) {
+  filter_diff result;
+  std::set_difference(new_filter.begin(), new_filter.end(), old_filter.begin(),
+                      old_filter.end(), std::back_inserter(result.added));
+  std::set_difference(old_filter.begin(), old_filter.end(), new_filter.begin(),
+                      new_filter.end(), std::back_inserter(result.removed));
+  return result;
+}
+
+const char* to_string(delivery_class x) {
+  switch (x) {
+    case delivery_class::reliable:
+      return "reliable";
+    case delivery_class::best_effort:
+      return "best-effort";
+    default:
+      return "invalid";
+  }
+}
+
+bool delivery_filter::mark_best_effort(const topic& x) {
+  return filter_extend(best_effort_, x);
+}
+
+delivery_class delivery_filter::classify(const topic& t) const noexcept {
+  if (is_internal(t))
+    return delivery_class::reliable;
+  for (auto& prefix : best_effort_)
+    if (prefix.prefix_of(t))
+      return delivery_class::best_effort;
+  return delivery_class::reliable;
+}
+
+void apply_filter_diff(filter_type& f, const filter_diff& diff) {
+  auto in_removed = [&](const topic& x) {
+    return std::binary_search(diff.removed.begin(), diff.removed.end(), x);
+  };
+  f.erase(std::remove_if(f.begin(), f.end(), in_removed), f.end());
+  f.insert(f.end(), diff.added.begin(), diff.added.end());
+  std::sort(f.begin(), f.end());
+  f.erase(std::unique(f.begin(), f.end()), f.end());
+}
+
 } // namespace broker
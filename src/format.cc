@@ -0,0 +1,95 @@
+#include "broker/format.hh"
+
+#include "broker/address.hh"
+#include "broker/convert.hh"
+#include "broker/data.hh"
+#include "broker/status.hh"
+
+namespace broker {
+
+namespace {
+
+void format_to(std::string& out, const table::value_type& x);
+
+template <class Container>
+void container_format(std::string& out, const Container& xs, const char* left,
+                      const char* right, const char* delim = ", ") {
+  auto first = begin(xs);
+  auto last = end(xs);
+  out += left;
+  if (first != last) {
+    format_to(out, *first);
+    while (++first != last) {
+      out += delim;
+      format_to(out, *first);
+    }
+  }
+  out += right;
+}
+
+void format_to(std::string& out, const table::value_type& x) {
+  format_to(out, x.first);
+  out += " -> ";
+  format_to(out, x.second);
+}
+
+struct data_formatter {
+  std::string& out;
+
+  void operator()(const vector& xs) {
+    format_to(out, xs);
+  }
+
+  void operator()(const set& xs) {
+    format_to(out, xs);
+  }
+
+  void operator()(const table& xs) {
+    format_to(out, xs);
+  }
+
+  void operator()(bool b) {
+    out += b ? 'T' : 'F';
+  }
+
+  void operator()(const std::string& x) {
+    out += x;
+  }
+
+  // Scalars produce short strings that fit into the small-string buffer, so
+  // going through `to_string` costs no heap allocation here.
+  template <class T>
+  void operator()(const T& x) {
+    out += to_string(x);
+  }
+};
+
+} // namespace
+
+void format_to(std::string& out, const data& x) {
+  visit(data_formatter{out}, x);
+}
+
+void format_to(std::string& out, const vector& xs) {
+  container_format(out, xs, "(", ")");
+}
+
+void format_to(std::string& out, const set& xs) {
+  container_format(out, xs, "{", "}");
+}
+
+void format_to(std::string& out, const table& xs) {
+  container_format(out, xs, "{", "}");
+}
+
+void format_to(std::string& out, const address& x) {
+  std::string str;
+  if (x.convert_to(str))
+    out += str;
+}
+
+void format_to(std::string& out, const status& x) {
+  out += to_string(x);
+}
+
+} // namespace broker
@@ -1,13 +1,48 @@
 #include "broker/internal/central_dispatcher.hh"
 
+#include <algorithm>
+
+#include <caf/span.hpp>
+
+#include "broker/defaults.hh"
+#include "broker/detail/interned_topic.hh"
+#include "broker/detail/sdt.hh"
+#include "broker/detail/prefix_matcher.hh"
+#include "broker/detail/shared_subscriber_queue.hh"
 #include "broker/internal/logger.hh"
+#include "broker/internal/native.hh"
+#include "broker/internal/type_id.hh"
 #include "broker/message.hh"
 
+#include <caf/actor_system.hpp>
+#include <caf/actor_system_config.hpp>
+#include <caf/scheduled_actor.hpp>
+#include <caf/telemetry/counter.hpp>
+#include <caf/telemetry/gauge.hpp>
+#include <caf/telemetry/metric_registry.hpp>
+
 namespace broker::internal {
 
 central_dispatcher::central_dispatcher(caf::scheduled_actor* self)
-  : self_(self) {
-  // nop
+  : self_(self), tracer_(self) {
+  const auto& cfg = self->system().config();
+  max_stage_capacity_ = caf::get_or(cfg, "broker.dispatcher.stage-capacity",
+                                    defaults::dispatcher::stage_capacity);
+  min_stage_capacity_ = std::min(defaults::dispatcher::min_stage_capacity,
+                                 max_stage_capacity_);
+  stage_capacity_ = min_stage_capacity_;
+  flush_interval_ = caf::get_or(cfg, "broker.dispatcher.flush-interval",
+                                defaults::dispatcher::flush_interval);
+  dedup_enabled_ = caf::get_or(cfg, "broker.multipath-dedup", true);
+  auto& reg = self->system().metrics();
+  stage_capacity_gauge_ = reg.gauge_singleton(
+    "broker", "dispatcher-stage-capacity",
+    "Current adaptive batch size of the central dispatcher.");
+  stage_capacity_gauge_->inc(static_cast<int64_t>(stage_capacity_));
+  flushed_messages_ = reg.counter_singleton(
+    "broker", "dispatcher-flushed-messages",
+    "Total number of messages the central dispatcher flushed downstream.",
+    "1", true);
 }
 
 void central_dispatcher::enqueue(const unipath_manager* source,
@@ -15,12 +50,234 @@ void central_dispatcher::enqueue(const unipath_manager* source,
                                  caf::span<const node_message> xs) {
   BROKER_DEBUG("central enqueue" << BROKER_ARG(scope)
                                  << BROKER_ARG2("xs.size", xs.size()));
-  auto f = [&](auto& sink) { return !sink->enqueue(source, scope, xs); };
-  sinks_.erase(std::remove_if(sinks_.begin(), sinks_.end(), f), sinks_.end());
+  BROKER_PROBE2(dispatcher_enqueue, static_cast<int>(scope), xs.size());
+  if (scope != detail::item_scope::remote && !direct_queues_.empty()) {
+    detail::prefix_matcher accept;
+    for (auto& [queue, filter] : direct_queues_)
+      for (auto& msg : xs)
+        if (is_data_message(msg) && accept(filter, get_topic(msg.content))) {
+          tracer_.record(msg);
+          queue->produce(std::get<data_message>(msg.content));
+        }
+  }
+  if (xs.empty())
+    return;
+  if (sinks_.size() > max_cached_sinks) {
+    // Too many sinks for the bitmap cache: probe each sink with the full
+    // batch and let it run its own filter.
+    auto f = [&](auto& sink) {
+      return sink == nullptr || !sink->enqueue(source, scope, xs);
+    };
+    sinks_.erase(std::remove_if(sinks_.begin(), sinks_.end(), f), sinks_.end());
+    invalidate_dispatch_cache();
+    rebuild_scope_masks();
+    return;
+  }
+  // Sinks of the wrong kind would reject the batch anyway: local items never
+  // reach peers and remote items never reach local subscribers. Masking them
+  // out up front skips their enqueue calls entirely, so delivering a
+  // local-scoped data message costs a reference handoff per local sink and
+  // zero work per peer.
+  auto scope_mask = ~uint64_t{0};
+  if (scope == detail::item_scope::local)
+    scope_mask = local_sinks_mask_;
+  else if (scope == detail::item_scope::remote)
+    scope_mask = remote_sinks_mask_;
+  // Resolve the destination set per topic through the dispatch cache and
+  // forward runs of messages that share a topic as one batch.
+  uint64_t dead = 0;
+  size_t i = 0;
+  while (i < xs.size()) {
+    auto j = i + 1;
+    while (j < xs.size() && get_topic(xs[j]) == get_topic(xs[i]))
+      ++j;
+    auto group = xs.subspan(i, j - i);
+    auto mask = sink_set(get_topic(xs[i])) & scope_mask & ~dead;
+    for (size_t index = 0; mask != 0; ++index, mask >>= 1)
+      if ((mask & 1) != 0 && !sinks_[index]->enqueue(source, scope, group))
+        dead |= uint64_t{1} << index;
+    i = j;
+  }
+  if (dead != 0)
+    for (auto index = sinks_.size(); index-- > 0;)
+      if ((dead & (uint64_t{1} << index)) != 0)
+        remove_sink(index);
+}
+
+uint64_t central_dispatcher::sink_set(const topic& t) {
+  auto id = detail::interned_topic::intern(t.string()).id();
+  if (id >= dispatch_cache_.size())
+    dispatch_cache_.resize(id + 1, dispatch_cache_miss);
+  auto& entry = dispatch_cache_[id];
+  if (entry == dispatch_cache_miss) {
+    uint64_t mask = 0;
+    for (size_t index = 0; index < sinks_.size(); ++index)
+      if (sinks_[index] != nullptr && sinks_[index]->accepts(t))
+        mask |= uint64_t{1} << index;
+    entry = mask;
+  }
+  return entry;
+}
+
+const endpoint_id& central_dispatcher::origin_id() {
+  // Lazily initialized: the node ID may not be set yet during construction.
+  if (!origin_id_)
+    origin_id_ = facade(self_->node());
+  return origin_id_;
+}
+
+void central_dispatcher::stage(const unipath_manager* source,
+                               detail::item_scope scope, node_message msg) {
+  // Store commands carry state updates and clone sync; they must not wait
+  // behind a burst of bulk data.
+  auto& lane = is_command_message(msg) ? staged_high_ : staged_;
+  if (accountant_) {
+    auto bytes = is_data_message(msg)
+                   ? detail::estimated_memory_use(
+                       std::get<data_message>(msg.content))
+                   : sizeof(node_message);
+    staged_bytes_ += bytes;
+    accountant_->add(detail::memory_region::dispatcher, bytes);
+  }
+  stage_in(lane, source, scope, std::move(msg));
+  if (++staged_messages_ >= stage_capacity_)
+    flush();
+}
+
+void central_dispatcher::stage_in(staged_lane& lane,
+                                  const unipath_manager* source,
+                                  detail::item_scope scope, node_message msg) {
+  if (lane.empty() || lane.back().source != source
+      || lane.back().scope != scope)
+    lane.emplace_back(staged_run{source, scope, make_buf()});
+  lane.back().messages.emplace_back(std::move(msg));
+}
+
+void central_dispatcher::flush() {
+  if (stage_empty())
+    return;
+  BROKER_DEBUG("flush" << BROKER_ARG2("messages", staged_messages_)
+                       << BROKER_ARG2("high runs", staged_high_.size())
+                       << BROKER_ARG2("runs", staged_.size()));
+  // Adapt the batch size: a full stage means the link is busy and larger
+  // batches amortize more per-batch overhead, while a deadline flush on a
+  // mostly empty stage means we only add latency by waiting.
+  auto old_capacity = stage_capacity_;
+  if (staged_messages_ >= stage_capacity_)
+    stage_capacity_ = std::min(stage_capacity_ * 2, max_stage_capacity_);
+  else if (staged_messages_ <= stage_capacity_ / 4)
+    stage_capacity_ = std::max(stage_capacity_ / 2, min_stage_capacity_);
+  if (stage_capacity_ != old_capacity)
+    stage_capacity_gauge_->inc(static_cast<int64_t>(stage_capacity_)
+                               - static_cast<int64_t>(old_capacity));
+  flushed_messages_->inc(static_cast<int64_t>(staged_messages_));
+  if (accountant_) {
+    accountant_->sub(detail::memory_region::dispatcher, staged_bytes_);
+    staged_bytes_ = 0;
+  }
+  // Move out the stage first: enqueue may trigger re-entrant stage calls.
+  auto high_runs = std::move(staged_high_);
+  auto runs = std::move(staged_);
+  staged_messages_ = 0;
+  for (auto* lane : {&high_runs, &runs})
+    for (auto& run : *lane) {
+      enqueue(run.source, run.scope, caf::make_span(run.messages));
+      recycle(std::move(run.messages));
+    }
+  // Hand the run vector back to the stage as well unless a re-entrant call
+  // already started filling a new one.
+  if (staged_.empty()) {
+    runs.clear();
+    staged_ = std::move(runs);
+  }
+}
+
+void central_dispatcher::set_max_stage_capacity(size_t value) {
+  max_stage_capacity_ = value;
+  min_stage_capacity_ = std::min(defaults::dispatcher::min_stage_capacity,
+                                 max_stage_capacity_);
+  auto clamped = std::clamp(stage_capacity_, min_stage_capacity_,
+                            max_stage_capacity_);
+  if (clamped != stage_capacity_) {
+    stage_capacity_gauge_->inc(static_cast<int64_t>(clamped)
+                               - static_cast<int64_t>(stage_capacity_));
+    stage_capacity_ = clamped;
+  }
+}
+
+std::vector<node_message> central_dispatcher::make_buf() {
+  if (pooled_bufs_.empty())
+    return {};
+  auto result = std::move(pooled_bufs_.back());
+  pooled_bufs_.pop_back();
+  return result;
+}
+
+void central_dispatcher::recycle(std::vector<node_message>&& buf) {
+  if (pooled_bufs_.size() >= defaults::dispatcher::pool_size)
+    return;
+  buf.clear();
+  pooled_bufs_.emplace_back(std::move(buf));
 }
 
 void central_dispatcher::add(unipath_manager_ptr sink) {
-  sinks_.emplace_back(std::move(sink));
+  // Reuse the slot of a previously removed sink if one is free. Surviving
+  // sinks keep their indices, so the bits of cached destination sets stay
+  // meaningful across peer churn.
+  auto i = std::find(sinks_.begin(), sinks_.end(), nullptr);
+  if (i != sinks_.end())
+    *i = std::move(sink);
+  else
+    sinks_.emplace_back(std::move(sink));
+  // The new sink may accept already-cached topics, so the cached sets must
+  // recompute; they come back with unchanged bits for the existing sinks.
+  invalidate_dispatch_cache();
+  rebuild_scope_masks();
+}
+
+void central_dispatcher::remove_sink(size_t index) {
+  // Tombstone the slot instead of erasing it: all other sinks keep their
+  // indices and the in-flight manager stays alive through its reference
+  // count until the last batch referencing it drains.
+  sinks_[index] = nullptr;
+  auto bit = uint64_t{1} << index;
+  local_sinks_mask_ &= ~bit;
+  remote_sinks_mask_ &= ~bit;
+  // Strip the slot from the cached destination sets rather than dropping
+  // them wholesale, so hot topics keep their precomputed bitmaps.
+  for (auto& entry : dispatch_cache_)
+    if (entry != dispatch_cache_miss)
+      entry &= ~bit;
+  while (!sinks_.empty() && sinks_.back() == nullptr)
+    sinks_.pop_back();
+}
+
+void central_dispatcher::rebuild_scope_masks() noexcept {
+  local_sinks_mask_ = 0;
+  remote_sinks_mask_ = 0;
+  auto num = std::min(sinks_.size(), max_cached_sinks);
+  for (size_t index = 0; index < num; ++index) {
+    if (sinks_[index] == nullptr)
+      continue;
+    if (sinks_[index]->message_type() == caf::type_id_v<node_message>)
+      remote_sinks_mask_ |= uint64_t{1} << index;
+    else
+      local_sinks_mask_ |= uint64_t{1} << index;
+  }
+}
+
+void central_dispatcher::set_direct_queue(
+  const detail::data_message_queue_ptr& queue, filter_type filter) {
+  auto is_mine = [&](const direct_queue& x) { return x.queue == queue; };
+  auto i = std::find_if(direct_queues_.begin(), direct_queues_.end(), is_mine);
+  if (filter.empty()) {
+    if (i != direct_queues_.end())
+      direct_queues_.erase(i);
+  } else if (i != direct_queues_.end()) {
+    i->filter = std::move(filter);
+  } else {
+    direct_queues_.emplace_back(direct_queue{queue, std::move(filter)});
+  }
 }
 
 } // namespace broker::internal
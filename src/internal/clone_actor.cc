@@ -1,6 +1,7 @@
 #include "broker/internal/logger.hh" // Needs to come before CAF includes.
 
 #include <caf/actor.hpp>
+#include <caf/actor_system_config.hpp>
 #include <caf/attach_stream_sink.hpp>
 #include <caf/behavior.hpp>
 #include <caf/error.hpp>
@@ -14,14 +15,26 @@
 
 #include "broker/convert.hh"
 #include "broker/data.hh"
+#include "broker/defaults.hh"
 #include "broker/detail/appliers.hh"
+#include "broker/detail/clone_cache.hh"
+#include "broker/detail/filesystem.hh"
+#include "broker/detail/snapshot_codec.hh"
 #include "broker/error.hh"
 #include "broker/internal/clone_actor.hh"
+#include "broker/internal/lag_watchdog.hh"
+#include "broker/internal/native.hh"
+#include "broker/internal/snapshot_chunk.hh"
 #include "broker/internal/type_id.hh"
+#include "broker/status.hh"
 #include "broker/store.hh"
 #include "broker/topic.hh"
 
+#include <algorithm>
 #include <chrono>
+#include <iterator>
+#include <type_traits>
+#include <unordered_set>
 
 namespace broker::internal {
 
@@ -46,6 +59,75 @@ void clone_state::init(caf::event_based_actor* ptr, std::string&& nm,
                        caf::actor&& parent, endpoint::clock* ep_clock) {
   super::init(ptr, ep_clock, std::move(nm), std::move(parent));
   master_topic = id / topic::master_suffix();
+  backlog_threshold
+    = caf::get_or(self->system().config(),
+                  "broker.health.store-backlog-threshold",
+                  defaults::health::store_backlog_threshold);
+  slo_threshold = caf::get_or(self->system().config(),
+                              "broker.health.store-slo-threshold",
+                              defaults::health::store_slo_threshold);
+  metrics.enable_slo_tracking(self->system(), id);
+  auto dict_dir
+    = caf::get_or(self->system().config(),
+                  "broker.compression-dictionary-directory",
+                  caf::string_view{
+                    defaults::compression_dictionary_directory});
+  if (!dict_dir.empty()) {
+    if (auto dicts = detail::load_preset_dictionaries(dict_dir))
+      preset_dicts = std::move(*dicts);
+    else
+      BROKER_WARNING("cannot load preset dictionaries from" << dict_dir);
+  }
+  auto cache_dir
+    = caf::get_or(self->system().config(),
+                  "broker.store.clone-cache-directory",
+                  caf::string_view{defaults::store::clone_cache_directory});
+  if (!cache_dir.empty() && detail::is_directory(cache_dir)) {
+    cache_path = cache_dir + "/" + id + ".cache";
+    if (auto cached = detail::load_clone_cache(cache_path)) {
+      // Serve the cached content once the master confirms freshness: the
+      // restored sequence number turns the initial sync into a delta replay
+      // (or a full snapshot if the master cannot cover the gap).
+      store = std::move(cached->entries);
+      last_applied_seq = cached->seq;
+      cache_flushed_seq = cached->seq;
+      BROKER_INFO("restored" << store.size() << "entries at sequence"
+                             << last_applied_seq << "from" << cache_path);
+    }
+  }
+}
+
+void clone_state::flush_cache() {
+  if (cache_path.empty() || cache_flushed_seq == last_applied_seq)
+    return;
+  // Never capture a half-applied snapshot transfer.
+  if (awaiting_snapshot || awaiting_snapshot_sync)
+    return;
+  if (auto res = detail::save_clone_cache(cache_path, store, last_applied_seq))
+    cache_flushed_seq = last_applied_seq;
+  else
+    BROKER_ERROR("failed to write clone cache" << cache_path << ":"
+                                               << res.error());
+}
+
+void clone_state::check_backlog() {
+  if (backlog_threshold == 0)
+    return;
+  auto buffered = mutation_buffer.size() + pending_remote_updates.size();
+  if (buffered < backlog_threshold)
+    return;
+  auto now = std::chrono::steady_clock::now();
+  if (last_backlog_report.time_since_epoch().count() != 0
+      && now - last_backlog_report < defaults::health::cooldown)
+    return;
+  last_backlog_report = now;
+  BROKER_WARNING("clone" << id << "buffered" << buffered << "commands");
+  auto stat = status::make<sc::store_backlog>(
+    facade(self->node()), "clone \"" + id + "\" buffered "
+                            + std::to_string(buffered)
+                            + " commands while out of sync");
+  self->send(core, atom::publish_v, atom::local_v,
+             make_data_message(topic::statuses(), get_as<data>(stat)));
 }
 
 void clone_state::forward(internal_command&& x) {
@@ -54,11 +136,139 @@ void clone_state::forward(internal_command&& x) {
 }
 
 void clone_state::command(internal_command::variant_type& cmd) {
+  auto t0 = std::chrono::steady_clock::now();
   std::visit(*this, cmd);
+  std::chrono::duration<double> runtime = std::chrono::steady_clock::now() - t0;
+  metrics.observe(cmd.index(), runtime.count());
 }
 
 void clone_state::command(internal_command& cmd) {
+  if (cmd.seq > last_applied_seq)
+    last_applied_seq = cmd.seq;
   command(cmd.content);
+  if (cmd.stamp.time_since_epoch().count() != 0)
+    check_slo(clock->now() - cmd.stamp);
+}
+
+void clone_state::check_slo(timespan delay) {
+  // Clock skew between master and clone hosts can push the difference below
+  // zero; clamp rather than report nonsense.
+  auto seconds
+    = std::max(std::chrono::duration_cast<std::chrono::duration<double>>(delay)
+                 .count(),
+               0.0);
+  metrics.observe_propagation(seconds);
+  if (slo_threshold.count() == 0)
+    return;
+  if (delay <= slo_threshold) {
+    consecutive_slo_breaches = 0;
+    return;
+  }
+  metrics.count_slo_breach();
+  if (++consecutive_slo_breaches < defaults::health::store_slo_breach_limit)
+    return;
+  auto now = std::chrono::steady_clock::now();
+  if (last_slo_report.time_since_epoch().count() != 0
+      && now - last_slo_report < defaults::health::cooldown)
+    return;
+  last_slo_report = now;
+  BROKER_WARNING("clone" << id << "exceeds the propagation-delay SLO");
+  auto stat = status::make<sc::store_slo_breach>(
+    facade(self->node()),
+    "clone \"" + id + "\" repeatedly exceeded its propagation-delay SLO");
+  self->send(core, atom::publish_v, atom::local_v,
+             make_data_message(topic::statuses(), get_as<data>(stat)));
+}
+
+void clone_state::apply_pending_updates() {
+  auto& buf = pending_remote_updates;
+  if (!buf.empty()) {
+    // Key-first pass, newest to oldest: a buffered put, erase or expire is
+    // dead when a later buffered command touches the same key, and a clear
+    // supersedes every earlier mutation wholesale. Dropping dead updates
+    // here spares the store writes and the event churn; observers see the
+    // coalesced effect, consistent with the catch-up snapshot semantics.
+    std::vector<bool> dead(buf.size(), false);
+    std::unordered_set<data> touched;
+    bool cleared = false;
+    for (auto i = buf.size(); i-- > 0;) {
+      auto& content = buf[i].content;
+      if (cleared) {
+        dead[i] = !std::holds_alternative<snapshot_sync_command>(content);
+        continue;
+      }
+      if (auto cmd = std::get_if<put_command>(&content)) {
+        dead[i] = !touched.insert(cmd->key).second;
+      } else if (auto cmd = std::get_if<erase_command>(&content)) {
+        dead[i] = !touched.insert(cmd->key).second;
+      } else if (auto cmd = std::get_if<expire_command>(&content)) {
+        dead[i] = !touched.insert(cmd->key).second;
+      } else if (auto cmd = std::get_if<multi_put_command>(&content)) {
+        for (auto& [key, value] : cmd->entries)
+          touched.insert(key);
+      } else if (auto cmd = std::get_if<multi_erase_command>(&content)) {
+        for (auto& key : cmd->keys)
+          touched.insert(key);
+      } else if (auto cmd = std::get_if<transaction_command>(&content)) {
+        for (auto& op : cmd->ops)
+          touched.insert(op.key);
+      } else if (std::holds_alternative<clear_command>(content)) {
+        cleared = true;
+      }
+    }
+    // Sequence numbers must advance past dropped commands as well, so that
+    // the next delta replay request starts after the full buffer.
+    auto max_seq = last_applied_seq;
+    for (auto& cmd : buf)
+      if (cmd.seq > max_seq)
+        max_seq = cmd.seq;
+    size_t applied = 0;
+    for (size_t i = 0; i < buf.size(); ++i)
+      if (!dead[i]) {
+        command(buf[i]);
+        ++applied;
+      }
+    last_applied_seq = max_seq;
+    BROKER_INFO("applied" << applied << "of" << buf.size()
+                          << "buffered updates");
+  }
+  buf.clear();
+  buf.shrink_to_fit();
+}
+
+void clone_state::local_apply(internal_command& x) {
+  auto apply = [this](const auto& cmd, auto& applier) {
+    auto i = store.find(cmd.key);
+    if (i == store.end()) {
+      if constexpr (std::is_same_v<std::decay_t<decltype(cmd)>, add_command>) {
+        if (cmd.init_type == data::type::none)
+          return;
+        auto value = data::from_type(cmd.init_type);
+        if (!detail::apply(applier, value))
+          return;
+        emit_insert_event(cmd.key, value, cmd.expiry, cmd.publisher);
+        store.emplace(cmd.key, std::move(value));
+      }
+      return;
+    }
+    auto old_value = i->second;
+    if (!detail::apply(applier, i->second)) {
+      i->second = std::move(old_value);
+      return;
+    }
+    emit_update_event(cmd.key, old_value, i->second, cmd.expiry, cmd.publisher);
+  };
+  if (auto cmd = std::get_if<add_command>(&x.content)) {
+    BROKER_INFO("LOCAL ADD" << *cmd);
+    detail::adder f{cmd->value};
+    apply(*cmd, f);
+  } else if (auto cmd = std::get_if<subtract_command>(&x.content)) {
+    BROKER_INFO("LOCAL SUBTRACT" << *cmd);
+    detail::remover f{cmd->value};
+    apply(*cmd, f);
+  }
+  // Everything else is not commutative and only takes effect once the master
+  // broadcasts it back.
 }
 
 void clone_state::operator()(none) {
@@ -102,6 +312,26 @@ void clone_state::operator()(subtract_command&) {
   BROKER_ERROR("clone received subtract_command");
 }
 
+void clone_state::operator()(multi_put_command& x) {
+  BROKER_INFO("MULTI_PUT with" << x.entries.size() << "entries");
+  for (auto& [key, value] : x.entries) {
+    if (auto i = store.find(key); i != store.end()) {
+      emit_update_event(key, i->second, value, x.expiry, x.publisher);
+      i->second = std::move(value);
+    } else {
+      emit_insert_event(key, value, x.expiry, x.publisher);
+      store.emplace(std::move(key), std::move(value));
+    }
+  }
+}
+
+void clone_state::operator()(multi_erase_command& x) {
+  BROKER_INFO("MULTI_ERASE with" << x.keys.size() << "keys");
+  for (auto& key : x.keys)
+    if (store.erase(key) != 0)
+      emit_erase_event(key, x.publisher);
+}
+
 void clone_state::operator()(snapshot_command&) {
   BROKER_ERROR("received SNAPSHOT in a clone");
 }
@@ -156,6 +386,40 @@ void clone_state::operator()(set_command& x) {
   store = std::move(x.state);
 }
 
+void clone_state::apply_snapshot_chunk(broker::snapshot& chunk, bool first,
+                                       bool last) {
+  BROKER_INFO("SNAPSHOT chunk with" << chunk.size() << "entries");
+  publisher_id publisher{facade(master.node()), master.id()};
+  if (first)
+    snapshot_seen_keys.clear();
+  while (!chunk.empty()) {
+    auto node = chunk.extract(chunk.begin());
+    snapshot_seen_keys.insert(node.key());
+    if (auto i = store.find(node.key()); i != store.end()) {
+      if (i->second != node.mapped()) {
+        emit_update_event(node.key(), i->second, node.mapped(), std::nullopt,
+                          publisher);
+        i->second = std::move(node.mapped());
+      }
+    } else {
+      emit_insert_event(node.key(), node.mapped(), std::nullopt, publisher);
+      store.insert(std::move(node));
+    }
+  }
+  if (last) {
+    // Erase everything the snapshot did not cover.
+    std::vector<data> stale_keys;
+    for (auto& kvp : store)
+      if (snapshot_seen_keys.count(kvp.first) == 0)
+        stale_keys.emplace_back(kvp.first);
+    for (auto& key : stale_keys) {
+      emit_erase_event(key, publisher_id{});
+      store.erase(key);
+    }
+    snapshot_seen_keys.clear();
+  }
+}
+
 void clone_state::operator()(clear_command& x) {
   BROKER_INFO("CLEAR");
   for (auto& kvp : store)
@@ -163,6 +427,34 @@ void clone_state::operator()(clear_command& x) {
   store.clear();
 }
 
+void clone_state::operator()(transaction_command& x) {
+  BROKER_INFO("TRANSACTION with" << x.ops.size() << "operations");
+  using action_type = transaction_op::action_type;
+  for (auto& op : x.ops) {
+    switch (op.action) {
+      case action_type::put:
+        if (auto i = store.find(op.key); i != store.end()) {
+          auto old_value = std::move(i->second);
+          i->second = std::move(op.value);
+          emit_update_event(op.key, old_value, i->second, x.expiry,
+                            x.publisher);
+        } else {
+          emit_insert_event(op.key, op.value, x.expiry, x.publisher);
+          store.emplace(std::move(op.key), std::move(op.value));
+        }
+        break;
+      case action_type::erase:
+        if (store.erase(op.key) != 0)
+          emit_erase_event(op.key, x.publisher);
+        break;
+      default:
+        // The master resolves add and subtract before broadcasting.
+        BROKER_ERROR("clone received an unresolved transaction op");
+        break;
+    }
+  }
+}
+
 data clone_state::keys() const {
   set result;
   for (auto& kvp : store)
@@ -170,17 +462,34 @@ data clone_state::keys() const {
   return result;
 }
 
+data clone_state::keys_in_range(const data& from, const data& to,
+                                uint64_t limit) const {
+  set result;
+  for (auto& kvp : store)
+    if (!(kvp.first < from) && (is<none>(to) || kvp.first < to))
+      result.insert(kvp.first);
+  if (limit > 0)
+    while (result.size() > limit)
+      result.erase(std::prev(result.end()));
+  return result;
+}
+
 caf::behavior clone_actor(caf::stateful_actor<clone_state>* self,
                           caf::actor core, std::string id,
                           double resync_interval, double stale_interval,
-                          double mutation_buffer_interval,
+                          double mutation_buffer_interval, bool local_writes,
                           endpoint::clock* clock) {
   self->monitor(core);
   self->state.init(self, std::move(id), std::move(core), clock);
+  self->state.local_writes = local_writes;
+  enroll_with_lag_watchdog(self);
   self->set_down_handler(
     [=](const caf::down_msg& msg) {
       if (msg.source == core) {
         BROKER_INFO("core is down, kill clone as well");
+        // A final flush captures the freshest replay position for the next
+        // start.
+        self->state.flush_cache();
         self->quit(msg.reason);
       } else {
         BROKER_INFO("lost master");
@@ -224,9 +533,29 @@ caf::behavior clone_actor(caf::stateful_actor<clone_state>* self,
 
   self->send(self, atom::master_v, atom::resolve_v);
 
+  if ( ! self->state.cache_path.empty() )
+    {
+    auto fi = caf::get_or(self->system().config(),
+                          "broker.store.clone-cache-interval",
+                          defaults::store::clone_cache_interval);
+    auto msg = caf::make_message(atom::tick_v, atom::flush_v);
+    clock->send_later(facade(caf::actor{self}), fi, &msg);
+    }
+
   return {
     // --- local communication -------------------------------------------------
     [=](atom::local, internal_command& x) {
+      // Stamp a per-writer sequence number exactly once, so that a later
+      // resend of the same command - e.g., a mutation buffer replay -
+      // carries the same number and the master drops it if it already
+      // applied the original.
+      if ( x.seq == 0 )
+        if ( auto writer = publisher_of(x.content) )
+          x.seq = ++self->state.writer_seqs[writer];
+
+      if ( self->state.local_writes )
+        self->state.local_apply(x);
+
       if ( self->state.master )
         {
         // forward all commands to the master
@@ -241,18 +570,52 @@ caf::behavior clone_actor(caf::stateful_actor<clone_state>* self,
         return;
 
       self->state.mutation_buffer.emplace_back(std::move(x));
+      self->state.check_backlog();
     },
     [=](set_command& x) {
       self->state(x);
       self->state.awaiting_snapshot = false;
 
-      if ( ! self->state.awaiting_snapshot_sync ) {
-        for ( auto& update : self->state.pending_remote_updates )
-          self->state.command(update);
-
-        self->state.pending_remote_updates.clear();
-        self->state.pending_remote_updates.shrink_to_fit();
+      if ( ! self->state.awaiting_snapshot_sync )
+        self->state.apply_pending_updates();
+    },
+    [=](snapshot_chunk& msg) {
+      auto& st = self->state;
+      auto first = msg.seq == 0;
+      auto last = msg.seq + 1 == msg.num_chunks;
+      if ( first )
+        st.snapshot_dict = detail::string_dictionary{};
+      auto chunk = detail::decode_snapshot(msg.bytes, st.snapshot_dict,
+                                           &st.preset_dicts);
+      if ( ! chunk ) {
+        // A retry would desynchronize the dictionary; wait for the master
+        // to restart the transfer from scratch.
+        BROKER_ERROR("failed to decode a snapshot chunk for" << st.id);
+        return;
       }
+      st.apply_snapshot_chunk(*chunk, first, last);
+      if ( ! last )
+        return;
+
+      st.awaiting_snapshot = false;
+
+      if ( ! st.awaiting_snapshot_sync )
+        st.apply_pending_updates();
+    },
+    [=](atom::replay, internal_command& x) {
+      self->state.command(x);
+    },
+    [=](atom::replay, atom::ack) {
+      auto& st = self->state;
+      st.awaiting_snapshot = false;
+
+      if ( ! st.awaiting_snapshot_sync )
+        st.apply_pending_updates();
+    },
+    [=](atom::replay, atom::restart) {
+      BROKER_INFO("master cannot replay, requesting a full snapshot");
+      self->send(self->state.core, atom::store_v, atom::master_v,
+                 atom::snapshot_v, self->state.id, self);
     },
     [=](atom::sync_point, caf::actor& who) {
       self->send(who, atom::sync_point_v);
@@ -286,8 +649,15 @@ caf::behavior clone_actor(caf::stateful_actor<clone_state>* self,
       self->state.mutation_buffer.clear();
       self->state.mutation_buffer.shrink_to_fit();
 
-      self->send(self->state.core, atom::store_v, atom::master_v,
-                 atom::snapshot_v, self->state.id, self);
+      if ( self->state.last_applied_seq == 0 )
+        self->send(self->state.core, atom::store_v, atom::master_v,
+                   atom::snapshot_v, self->state.id, self);
+      else
+        // Ask the master for a delta replay of everything we missed. Falls
+        // back to the full snapshot protocol if the master cannot comply.
+        self->send(self->state.master, atom::replay_v,
+                   self->state.last_applied_seq, self->state.core,
+                   caf::actor{self});
     },
     [=](atom::master, caf::error err) {
       if ( self->state.master )
@@ -307,6 +677,14 @@ caf::behavior clone_actor(caf::stateful_actor<clone_state>* self,
 
       self->state.is_stale = true;
     },
+    [=](atom::tick, atom::flush) {
+      self->state.flush_cache();
+      auto fi = caf::get_or(self->system().config(),
+                            "broker.store.clone-cache-interval",
+                            defaults::store::clone_cache_interval);
+      auto msg = caf::make_message(atom::tick_v, atom::flush_v);
+      clock->send_later(facade(caf::actor{self}), fi, &msg);
+    },
     [=](atom::tick, atom::mutable_check) {
       if ( self->state.unmutable_time < 0 )
         return;
@@ -324,6 +702,23 @@ caf::behavior clone_actor(caf::stateful_actor<clone_state>* self,
       BROKER_INFO("KEYS ->" << x);
       return {x};
     },
+    [=](atom::get, atom::keys, const data& from, const data& to,
+        uint64_t limit) -> caf::result<data> {
+      if ( self->state.is_stale )
+        return {caf::make_error(ec::stale_data)};
+      auto x = self->state.keys_in_range(from, to, limit);
+      BROKER_INFO("KEYS_IN_RANGE" << from << "->" << to << "limit" << limit);
+      return {x};
+    },
+    [=](atom::get, atom::keys, const data& from, const data& to,
+        uint64_t limit, request_id id) {
+      if ( self->state.is_stale )
+        return caf::make_message(caf::make_error(ec::stale_data), id);
+      auto x = self->state.keys_in_range(from, to, limit);
+      BROKER_INFO("KEYS_IN_RANGE" << from << "->" << to << "limit" << limit
+                                  << "with id" << id);
+      return caf::make_message(std::move(x), id);
+    },
     [=](atom::get, atom::keys, request_id id) {
       if ( self->state.is_stale )
         return caf::make_message(caf::make_error(ec::stale_data), id);
@@ -358,6 +753,31 @@ caf::behavior clone_actor(caf::stateful_actor<clone_state>* self,
       BROKER_INFO("GET" << key << "->" << result);
       return to_caf_res(std::move(result));
     },
+    [=](atom::get, const vector& keys) -> caf::result<data> {
+      if (self->state.is_stale)
+        return {caf::make_error(ec::stale_data)};
+      vector xs;
+      xs.reserve(keys.size());
+      // Missing keys yield nil, so the result aligns with the request.
+      for (auto& key : keys) {
+        auto i = self->state.store.find(key);
+        xs.emplace_back(i != self->state.store.end() ? i->second : data{});
+      }
+      BROKER_INFO("MULTI_GET with" << keys.size() << "keys");
+      return {data{std::move(xs)}};
+    },
+    [=](atom::get, const vector& keys, request_id id) {
+      if (self->state.is_stale)
+        return caf::make_message(caf::make_error(ec::stale_data), id);
+      vector xs;
+      xs.reserve(keys.size());
+      for (auto& key : keys) {
+        auto i = self->state.store.find(key);
+        xs.emplace_back(i != self->state.store.end() ? i->second : data{});
+      }
+      BROKER_INFO("MULTI_GET with" << keys.size() << "keys and id" << id);
+      return caf::make_message(data{std::move(xs)}, id);
+    },
     [=](atom::get, const data& key, const data& aspect) -> caf::result<data> {
       if (self->state.is_stale)
         return {caf::make_error(ec::stale_data)};
@@ -403,6 +823,10 @@ caf::behavior clone_actor(caf::stateful_actor<clone_state>* self,
       return result;
     },
     [=](atom::get, atom::name) { return self->state.id; },
+    // --- scheduler-lag probes from the watchdog ------------------------------
+    [=](atom::ping, timestamp sent) {
+      record_scheduler_lag(self->system(), "clone/" + self->state.id, sent);
+    },
     // --- stream handshake with core ------------------------------------------
     [=](caf::stream<command_message> in) {
       attach_stream_sink(
@@ -428,6 +852,7 @@ caf::behavior clone_actor(caf::stateful_actor<clone_state>* self,
 
           if ( self->state.awaiting_snapshot ) {
             self->state.pending_remote_updates.emplace_back(std::move(cmd));
+            self->state.check_backlog();
             return;
           }
 
@@ -1,5 +1,7 @@
 #include "broker/internal/core_actor.hh"
 
+#include <algorithm>
+
 #include <caf/actor.hpp>
 #include <caf/actor_cast.hpp>
 #include <caf/allowed_unsafe_message_type.hpp>
@@ -25,8 +27,11 @@
 #include "broker/convert.hh"
 #include "broker/defaults.hh"
 #include "broker/detail/assert.hh"
+#include "broker/detail/filesystem.hh"
+#include "broker/detail/store_file.hh"
 #include "broker/endpoint.hh"
 #include "broker/error.hh"
+#include "broker/internal/lag_watchdog.hh"
 #include "broker/internal/logger.hh"
 #include "broker/internal/type_id.hh"
 #include "broker/peer_status.hh"
@@ -39,24 +44,35 @@ namespace broker::internal {
 
 core_state::core_state(caf::event_based_actor* ptr,
                        const filter_type& initial_filter, broker_options opts,
-                       endpoint::clock* ep_clock)
+                       endpoint::clock* ep_clock,
+                       detail::memory_accountant_ptr accountant,
+                       detail::peer_status_table_ptr peer_table)
   : super(ep_clock, ptr, initial_filter),
     options_(opts),
-    filter_(initial_filter) {
+    filter_(initial_filter),
+    peer_table_(std::move(peer_table)) {
+  dispatcher_.attach_accounting(std::move(accountant));
   cache().set_use_ssl(!options_.disable_ssl);
   // We monitor remote inbound peerings and local outbound peerings.
   self_->set_down_handler([this](const caf::down_msg& down) {
     if (!down.source)
       ; // Ignore bogus message.
-    else if (auto hdl = caf::actor_cast<caf::actor>(down.source))
+    else if (auto hdl = caf::actor_cast<caf::actor>(down.source)) {
+      peer_filter_seqs_.erase(hdl);
       drop_peer(hdl, false, down.reason);
+    }
   });
+  // Keep the filter sorted; delta computation relies on it.
+  std::sort(filter_.begin(), filter_.end());
 }
 
 void core_state::update_filter_on_peers() {
   BROKER_TRACE("");
-  for_each_peer([this](const actor& hdl) {
-    self()->send(hdl, atom::update_v, filter_);
+  auto diff = make_filter_diff(last_broadcast_filter_, filter_);
+  diff.seq = ++filter_seq_;
+  last_broadcast_filter_ = filter_;
+  for_each_peer([this, &diff](const actor& hdl) {
+    self()->send(hdl, atom::update_v, diff);
   });
 }
 
@@ -77,16 +93,139 @@ void core_state::subscribe(filter_type xs) {
   }
 }
 
+caf::error core_state::reconfigure(const std::string& key, const data& value) {
+  BROKER_TRACE(BROKER_ARG(key) << BROKER_ARG(value));
+  auto type_clash = [&key] {
+    return caf::make_error(ec::type_clash, "invalid value type for " + key);
+  };
+  if (key == "broker.dispatcher.flush-interval") {
+    auto val = get_if<timespan>(&value);
+    if (!val || val->count() <= 0)
+      return type_clash();
+    dispatcher_.set_flush_interval(*val);
+    return {};
+  }
+  if (key == "broker.dispatcher.stage-capacity") {
+    auto val = get_if<count>(&value);
+    if (!val || *val == 0)
+      return type_clash();
+    dispatcher_.set_max_stage_capacity(static_cast<size_t>(*val));
+    return {};
+  }
+  if (key == "broker.multipath-dedup") {
+    auto val = get_if<boolean>(&value);
+    if (!val)
+      return type_clash();
+    dispatcher_.set_dedup_enabled(*val);
+    return {};
+  }
+  if (key == "broker.metrics.latency-sample-rate") {
+    auto val = get_if<count>(&value);
+    if (!val)
+      return type_clash();
+    dispatcher_.tracer().set_sample_rate(*val);
+    return {};
+  }
+  if (key == "broker.recording-topics") {
+    auto val = get_if<vector>(&value);
+    if (!val)
+      return type_clash();
+    filter_type new_filter;
+    for (auto& x : *val) {
+      auto str = get_if<std::string>(&x);
+      if (!str)
+        return type_clash();
+      new_filter.emplace_back(*str);
+    }
+    recorder().topic_filter(std::move(new_filter));
+    return {};
+  }
+  if (key == "broker.recording-types") {
+    auto val = get_if<std::string>(&value);
+    if (!val)
+      return type_clash();
+    auto types = parse_recording_types(*val);
+    if (!types)
+      return type_clash();
+    recorder().recorded_types(*types);
+    return {};
+  }
+  if (key == "broker.recording-sample-rate") {
+    auto val = get_if<count>(&value);
+    if (!val)
+      return type_clash();
+    recorder().sample_rate(*val);
+    return {};
+  }
+  return caf::make_error(ec::no_such_key,
+                         "not a runtime-tunable option: " + key);
+}
+
 bool core_state::has_remote_subscriber(const topic& x) noexcept {
   return any_peer_manager([&x](const auto& mgr) { return mgr->accepts(x); });
 }
 
+std::vector<peer_info> core_state::peer_info_list() {
+  std::vector<peer_info> result;
+  auto add = [&](actor hdl, peer_status status) {
+    peer_info tmp;
+    tmp.status = status;
+    tmp.flags = peer_flags::remote + peer_flags::inbound + peer_flags::outbound;
+    tmp.peer.node = facade(hdl.node());
+    auto addrs = cache().find(hdl);
+    // the peer_info only holds a single address, so ... pick first?
+    if (addrs)
+      tmp.peer.network = *addrs;
+    result.emplace_back(std::move(tmp));
+  };
+  // collect connected peers
+  for_each_peer([&](const actor& hdl) { add(hdl, peer_status::peered); });
+  // collect pending peers
+  for (const auto& kvp : pending_connections())
+    add(kvp.first, peer_status::connecting);
+  return result;
+}
+
+void core_state::publish_peer_table() {
+  if (peer_table_)
+    peer_table_->publish(peer_info_list());
+}
+
 void core_state::peer_connected(const peer_id_type& peer_id,
                                 const communication_handle_type& hdl) {
   super::peer_connected(peer_id, hdl);
+  publish_peer_table();
+}
+
+void core_state::peer_disconnected(const peer_id_type& peer_id,
+                                   const communication_handle_type& hdl,
+                                   const caf::error& reason) {
+  super::peer_disconnected(peer_id, hdl, reason);
+  publish_peer_table();
+}
+
+void core_state::peer_removed(const peer_id_type& peer_id,
+                              const communication_handle_type& hdl) {
+  super::peer_removed(peer_id, hdl);
+  publish_peer_table();
+}
+
+void core_state::peer_unavailable(const peer_id_type& peer_id,
+                                  const communication_handle_type& hdl,
+                                  const caf::error& reason) {
+  super::peer_unavailable(peer_id, hdl, reason);
+  publish_peer_table();
+}
+
+void core_state::start_peering(const peer_id_type& peer_id,
+                               caf::actor remote_peer,
+                               caf::response_promise rp) {
+  super::start_peering(peer_id, std::move(remote_peer), std::move(rp));
+  publish_peer_table();
 }
 
 caf::behavior core_state::make_behavior() {
+  enroll_with_lag_watchdog(self());
   return super::make_behavior(
     // --- filter manipulation -------------------------------------------------
     [=](atom::subscribe, filter_type& f) {
@@ -157,6 +296,44 @@ caf::behavior core_state::make_behavior() {
       if (!update_peer(p, std::move(f)))
         BROKER_DEBUG("Cannot update filter of unknown peer:" << to_string(p));
     },
+    [=](atom::update, filter_diff& d) {
+      BROKER_TRACE(BROKER_ARG(d.seq));
+      auto p = caf::actor_cast<caf::actor>(self()->current_sender());
+      if (p == nullptr) {
+        BROKER_DEBUG("Received anonymous filter delta.");
+        return;
+      }
+      auto& seen = peer_filter_seqs_[p];
+      if (seen == 0 || d.seq != seen + 1) {
+        // Missed an update (or never saw a numbered full sync); ask the peer
+        // to re-send its full filter.
+        BROKER_DEBUG("Filter delta out of sequence; requesting full sync.");
+        self()->send(p, atom::update_v);
+        return;
+      }
+      if (update_peer(p, d))
+        seen = d.seq;
+      else
+        BROKER_DEBUG("Cannot update filter of unknown peer:" << to_string(p));
+    },
+    [=](atom::update, uint64_t seq, filter_type& f) {
+      BROKER_TRACE(BROKER_ARG(seq) << BROKER_ARG(f));
+      auto p = caf::actor_cast<caf::actor>(self()->current_sender());
+      if (p == nullptr) {
+        BROKER_DEBUG("Received anonymous filter update.");
+        return;
+      }
+      if (update_peer(p, std::move(f)))
+        peer_filter_seqs_[p] = seq;
+      else
+        BROKER_DEBUG("Cannot update filter of unknown peer:" << to_string(p));
+    },
+    [=](atom::update) {
+      // A peer missed one of our deltas and asks for a full sync.
+      auto p = caf::actor_cast<caf::actor>(self()->current_sender());
+      if (p != nullptr)
+        self()->send(p, atom::update_v, filter_seq_, filter_);
+    },
     // --- communication to local actors: incoming streams and subscriptions ---
     [=](atom::join, filter_type& filter) {
       BROKER_TRACE(BROKER_ARG(filter));
@@ -178,6 +355,15 @@ caf::behavior core_state::make_behavior() {
     [=](atom::join, atom::store, const filter_type& filter) {
       return add_sending_store(filter);
     },
+    [=](atom::join, atom::local, filter_type& filter,
+        detail::data_message_queue_ptr& queue) {
+      BROKER_TRACE(BROKER_ARG(filter));
+      // Direct fast path: deliver matching data messages straight into the
+      // subscriber queue instead of streaming them to a worker actor.
+      dispatcher_.set_direct_queue(queue, filter);
+      if (!filter.empty())
+        subscribe(std::move(filter));
+    },
     [=](caf::stream<data_message> in) {
       BROKER_TRACE("add data_message input stream");
       make_source(&dispatcher_, in);
@@ -225,29 +411,7 @@ caf::behavior core_state::make_behavior() {
       self()->send(hdl, atom::publish_v, atom::local_v, std::move(x));
     },
     // --- accessors -----------------------------------------------------------
-    [=](atom::get, atom::peer) {
-      std::vector<peer_info> result;
-      auto add = [&](actor hdl, peer_status status) {
-        peer_info tmp;
-        tmp.status = status;
-        tmp.flags = peer_flags::remote + peer_flags::inbound
-                    + peer_flags::outbound;
-        tmp.peer.node = facade(hdl.node());
-        auto addrs = cache().find(hdl);
-        // the peer_info only holds a single address, so ... pick first?
-        if (addrs)
-          tmp.peer.network = *addrs;
-        result.emplace_back(std::move(tmp));
-      };
-      // collect connected peers
-      for_each_peer([&](const actor& hdl) {
-        add(hdl, peer_status::peered);
-      });
-      // collect pending peers
-      for (const auto& kvp : pending_connections())
-        add(kvp.first, peer_status::connecting);
-      return result;
-    },
+    [=](atom::get, atom::peer) { return peer_info_list(); },
     [=](atom::get, atom::peer, atom::subscriptions) {
       std::vector<topic> result;
       // Collect filters for all peers.
@@ -262,8 +426,91 @@ caf::behavior core_state::make_behavior() {
         result.erase(e, result.end());
       return result;
     },
+    [=](atom::dump, std::string& directory) -> caf::result<atom::ok> {
+      if (auto err = recorder().dump(directory))
+        return err;
+      return atom::ok_v;
+    },
+    [=](atom::put, const std::string& key,
+        const data& value) -> caf::result<atom::ok> {
+      if (auto err = reconfigure(key, value))
+        return err;
+      return atom::ok_v;
+    },
+    [=](atom::checkpoint, const std::string& directory)
+      -> caf::result<atom::ok> {
+      BROKER_INFO("writing checkpoint to" << directory);
+      if (!broker::detail::mkdirs(directory))
+        return caf::make_error(ec::cannot_open_file,
+                               "cannot create checkpoint directory: "
+                                 + directory);
+      // Only masters with a memory backend need checkpointing; persistent
+      // backends carry their state across restarts on their own.
+      std::vector<std::pair<std::string, actor>> memory_masters;
+      for (auto& [name, hdl] : masters_)
+        if (auto i = master_backends().find(name);
+            i != master_backends().end() && i->second == backend::memory)
+          memory_masters.emplace_back(name, hdl);
+      broker::detail::store_file_writer writer;
+      if (auto res = writer.open(directory + "/endpoint.meta"); !res)
+        return native(res.error());
+      auto write_entry = [&writer](std::string key, data value) {
+        return writer.write(data{std::move(key)}, std::move(value));
+      };
+      vector filter_entries;
+      for (auto& t : filter_)
+        filter_entries.emplace_back(t.string());
+      vector peer_entries;
+      for_each_peer([&](const actor& hdl) {
+        // Peers without a cached address came in via an inbound connection;
+        // we cannot re-establish those from our side anyway.
+        if (auto addr = cache().find(hdl))
+          peer_entries.emplace_back(
+            vector{addr->address, count{addr->port}});
+      });
+      vector store_entries;
+      for (auto& [name, hdl] : memory_masters)
+        store_entries.emplace_back(name);
+      if (auto res = write_entry("version", data{count{1}}); !res)
+        return native(res.error());
+      if (auto res = write_entry("filter", data{std::move(filter_entries)});
+          !res)
+        return native(res.error());
+      if (auto res = write_entry("peers", data{std::move(peer_entries)}); !res)
+        return native(res.error());
+      if (auto res = write_entry("stores", data{std::move(store_entries)});
+          !res)
+        return native(res.error());
+      if (auto res = writer.close(); !res)
+        return native(res.error());
+      if (memory_masters.empty())
+        return atom::ok_v;
+      // Fan out to the masters and collapse their answers into one response.
+      auto rp = self()->make_response_promise<atom::ok>();
+      auto remaining = std::make_shared<size_t>(memory_masters.size());
+      for (auto& [name, hdl] : memory_masters) {
+        auto path = directory + "/store-" + name + ".dat";
+        self()
+          ->request(hdl, caf::infinite, atom::store_v, atom::write_v,
+                    std::move(path))
+          .then(
+            [rp, remaining](atom::ok) mutable {
+              if (--*remaining == 0 && rp.pending())
+                rp.deliver(atom::ok_v);
+            },
+            [rp](caf::error& err) mutable {
+              if (rp.pending())
+                rp.deliver(std::move(err));
+            });
+      }
+      return rp;
+    },
     // --- destructive state manipulations -------------------------------------
     [=](atom::unpeer, actor x) { unpeer(x); },
+    [=](atom::unpeer, atom::drain, actor x, caf::timespan drain_timeout) {
+      unpeer_gracefully(x.node(), x, drain_timeout,
+                        self()->make_response_promise());
+    },
     [=](atom::shutdown) {
       self()->quit(exit_reason::user_shutdown);
       /* -- To consider:
@@ -301,6 +548,10 @@ caf::behavior core_state::make_behavior() {
         self()->send_exit(kvp.second, caf::exit_reason::user_shutdown);
       for (auto& kvp : clones_)
         self()->send_exit(kvp.second, caf::exit_reason::user_shutdown);
+    },
+    // --- scheduler-lag probes from the watchdog -------------------------------
+    [=](atom::ping, timestamp sent) {
+      record_scheduler_lag(self()->system(), name, sent);
     });
 }
 
@@ -1,5 +1,7 @@
 #include "broker/internal/core_recorder.hh"
 
+#include <variant>
+
 #include <caf/actor_system_config.hpp>
 #include <caf/config_value.hpp>
 #include <caf/local_actor.hpp>
@@ -7,37 +9,78 @@
 
 #include "broker/defaults.hh"
 #include "broker/detail/filesystem.hh"
+#include "broker/error.hh"
 #include "broker/internal/logger.hh"
 
 namespace broker::internal {
 
+std::optional<recording_types> parse_recording_types(std::string_view str) {
+  if (str == "all")
+    return recording_types::all;
+  if (str == "data")
+    return recording_types::data;
+  if (str == "command")
+    return recording_types::command;
+  return std::nullopt;
+}
+
 core_recorder::core_recorder(caf::local_actor* self) {
   auto& cfg = self->config();
+  node_id_ = to_string(self->node());
+  // The filters apply to disk recording and flight recorder alike.
+  for (auto& str : get_or(cfg, "broker.recording-topics",
+                          std::vector<std::string>{}))
+    topic_filter_.emplace_back(std::move(str));
+  auto types_str = get_or(cfg, "broker.recording-types",
+                          caf::string_view{defaults::recording_types});
+  if (auto types = parse_recording_types(types_str))
+    recorded_types_ = *types;
+  else
+    BROKER_WARNING("invalid value for broker.recording-types:" << types_str);
+  sample_rate_ = get_or(cfg, "broker.recording-sample-rate",
+                        defaults::recording_sample_rate);
   auto meta_dir = get_or(cfg, "broker.recording-directory",
                          caf::string_view{defaults::recording_directory});
-  if (!meta_dir.empty() && detail::is_directory(meta_dir)) {
-    if (!open_file(topics_file_, meta_dir + "/topics.txt"))
-      return;
-    if (!open_file(peers_file_, meta_dir + "/peers.txt"))
-      return;
-    std::ofstream id_file;
-    if (!open_file(id_file, meta_dir + "/id.txt"))
-      return;
-    id_file << to_string(self->node()) << '\n';
-    auto messages_file_name = meta_dir + "/messages.dat";
-    writer_ = make_generator_file_writer(messages_file_name);
-    if (writer_ == nullptr) {
-      BROKER_WARNING("cannot open recording file" << messages_file_name);
-    } else {
-      BROKER_DEBUG("opened file for recording:" << messages_file_name);
-      remaining_records_ = get_or(cfg, "broker.output-generator-file-cap",
-                                  defaults::output_generator_file_cap);
-    }
+  if (meta_dir.empty() || !detail::is_directory(meta_dir)) {
+    // Without always-on disk recording, fall back to the in-memory flight
+    // recorder if configured.
+    flight_recorder_cap_ = get_or(cfg, "broker.flight-recorder-size",
+                                  defaults::flight_recorder_size);
+    if (flight_recorder_cap_ > 0)
+      BROKER_DEBUG("flight recorder keeps the last"
+                   << flight_recorder_cap_ << "messages in memory");
+    return;
+  }
+  if (!open_file(topics_file_, meta_dir + "/topics.txt"))
+    return;
+  if (!open_file(peers_file_, meta_dir + "/peers.txt"))
+    return;
+  std::ofstream id_file;
+  if (!open_file(id_file, meta_dir + "/id.txt"))
+    return;
+  id_file << node_id_ << '\n';
+  auto messages_file_name = meta_dir + "/messages.dat";
+  auto compressed = get_or(cfg, "broker.recording-compression",
+                           defaults::recording_compression);
+  auto timed = get_or(cfg, "broker.recording-timestamps",
+                      defaults::recording_timestamps);
+  writer_ = make_generator_file_writer(messages_file_name, compressed, timed);
+  if (writer_ == nullptr) {
+    BROKER_WARNING("cannot open recording file" << messages_file_name);
+  } else {
+    BROKER_DEBUG("opened file for recording:" << messages_file_name);
+    remaining_records_ = get_or(cfg, "broker.output-generator-file-cap",
+                                defaults::output_generator_file_cap);
   }
 }
 
 void core_recorder::record_subscription(const filter_type& what) {
   BROKER_TRACE(BROKER_ARG(what));
+  if (flight_recorder_cap_ > 0) {
+    // Simply append to topics without de-duplication, same as the file.
+    flight_topics_.insert(flight_topics_.end(), what.begin(), what.end());
+    return;
+  }
   if (!topics_file_)
     return;
   // Simply append to topics without de-duplication.
@@ -54,10 +97,56 @@ void core_recorder::record_subscription(const filter_type& what) {
 }
 
 void core_recorder::record_peer(const caf::node_id& peer_id) {
+  if (flight_recorder_cap_ > 0) {
+    flight_peers_.emplace_back(to_string(peer_id));
+    return;
+  }
   if (peers_file_)
     peers_file_ << to_string(peer_id) << std::endl;
 }
 
+caf::error core_recorder::dump(const std::string& directory) {
+  BROKER_TRACE(BROKER_ARG(directory));
+  if (flight_recorder_cap_ == 0)
+    return caf::make_error(ec::unspecified, "flight recorder disabled");
+  if (directory.empty() || !detail::is_directory(directory))
+    return caf::make_error(ec::cannot_open_file, directory);
+  std::ofstream topics_file;
+  if (!open_file(topics_file, directory + "/topics.txt"))
+    return caf::make_error(ec::cannot_open_file, directory + "/topics.txt");
+  for (const auto& x : flight_topics_)
+    topics_file << x.string() << '\n';
+  std::ofstream peers_file;
+  if (!open_file(peers_file, directory + "/peers.txt"))
+    return caf::make_error(ec::cannot_open_file, directory + "/peers.txt");
+  for (const auto& x : flight_peers_)
+    peers_file << x << '\n';
+  std::ofstream id_file;
+  if (!open_file(id_file, directory + "/id.txt"))
+    return caf::make_error(ec::cannot_open_file, directory + "/id.txt");
+  id_file << node_id_ << '\n';
+  auto messages_file_name = directory + "/messages.dat";
+  auto writer = make_generator_file_writer(messages_file_name);
+  if (writer == nullptr)
+    return caf::make_error(ec::cannot_open_file, messages_file_name);
+  for (const auto& msg : flight_buf_) {
+    auto write_entry = [&](const auto& x) { return writer->write(x); };
+    if (auto err = std::visit(write_entry, msg))
+      return err;
+  }
+  BROKER_INFO("dumped" << flight_buf_.size() << "buffered messages to"
+                       << directory);
+  // Start over with an empty buffer rather than dumping overlapping windows.
+  flight_buf_.clear();
+  return caf::none;
+}
+
+void core_recorder::record_in_memory(node_message_content x) {
+  flight_buf_.emplace_back(std::move(x));
+  if (flight_buf_.size() > flight_recorder_cap_)
+    flight_buf_.pop_front();
+}
+
 bool core_recorder::open_file(std::ofstream& fs, std::string file_name) {
   fs.open(file_name);
   if (fs.is_open()) {
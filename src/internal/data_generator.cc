@@ -154,6 +154,27 @@ caf::error data_generator::generate(internal_command::type tag,
       x.content = subtract_command{std::move(key), std::move(val)};
       break;
     }
+    case tag_type::multi_put_command: {
+      uint32_t size = 0;
+      BROKER_TRY(read_value(source_, size));
+      std::vector<std::pair<data, data>> entries;
+      entries.reserve(size);
+      for (size_t i = 0; i < size; ++i) {
+        data key;
+        data val;
+        GENERATE(key);
+        GENERATE(val);
+        entries.emplace_back(std::move(key), std::move(val));
+      }
+      x.content = multi_put_command{std::move(entries), std::nullopt};
+      break;
+    }
+    case tag_type::multi_erase_command: {
+      vector keys;
+      GENERATE(keys);
+      x.content = multi_erase_command{std::move(keys)};
+      break;
+    }
     case tag_type::snapshot_command: {
       x.content = snapshot_command{worker{nullptr}, worker{nullptr}};
       break;
@@ -172,6 +193,27 @@ caf::error data_generator::generate(internal_command::type tag,
       x.content = clear_command{};
       break;
     }
+    case tag_type::transaction_command: {
+      uint32_t size = 0;
+      BROKER_TRY(read_value(source_, size));
+      std::vector<transaction_op> ops;
+      ops.reserve(size);
+      for (size_t i = 0; i < size; ++i) {
+        uint8_t action = 0;
+        data key;
+        data val;
+        data::type init_type{};
+        BROKER_TRY(read_value(source_, action));
+        GENERATE(key);
+        GENERATE(val);
+        BROKER_TRY(read_value(source_, init_type));
+        ops.push_back(
+          transaction_op{static_cast<transaction_op::action_type>(action),
+                         std::move(key), std::move(val), init_type});
+      }
+      x.content = transaction_command{std::move(ops), std::nullopt};
+      break;
+    }
     default:
       return ec::invalid_tag;
   }
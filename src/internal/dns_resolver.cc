@@ -0,0 +1,78 @@
+#include "broker/internal/dns_resolver.hh"
+
+#include <cstring>
+#include <string>
+
+#include "broker/config.hh"
+
+#ifdef BROKER_WINDOWS
+#  include <ws2tcpip.h>
+#else
+#  include <arpa/inet.h>
+#  include <netdb.h>
+#  include <sys/socket.h>
+#endif
+
+#include <caf/expected.hpp>
+#include <caf/result.hpp>
+
+#include "broker/error.hh"
+#include "broker/internal/logger.hh"
+#include "broker/internal/type_id.hh"
+
+namespace broker::internal {
+
+namespace {
+
+/// Runs `getaddrinfo` for `host` and renders the first result as an address
+/// literal, preferring IPv4 over IPv6 when both are available.
+caf::expected<std::string> blocking_resolve(const std::string& host) {
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* res = nullptr;
+  if (getaddrinfo(host.c_str(), nullptr, &hints, &res) != 0 || res == nullptr)
+    return caf::make_error(ec::peer_unavailable,
+                           "cannot resolve hostname: " + host);
+  char buf[INET6_ADDRSTRLEN];
+  const char* rendered = nullptr;
+  for (auto family : {AF_INET, AF_INET6}) {
+    for (auto i = res; i != nullptr && rendered == nullptr; i = i->ai_next) {
+      if (i->ai_family != family)
+        continue;
+      if (family == AF_INET) {
+        auto addr = reinterpret_cast<sockaddr_in*>(i->ai_addr);
+        rendered = inet_ntop(AF_INET, &addr->sin_addr, buf, sizeof(buf));
+      } else {
+        auto addr = reinterpret_cast<sockaddr_in6*>(i->ai_addr);
+        rendered = inet_ntop(AF_INET6, &addr->sin6_addr, buf, sizeof(buf));
+      }
+    }
+    if (rendered != nullptr)
+      break;
+  }
+  freeaddrinfo(res);
+  if (rendered == nullptr)
+    return caf::make_error(ec::peer_unavailable,
+                           "cannot resolve hostname: " + host);
+  return std::string{rendered};
+}
+
+} // namespace
+
+caf::behavior dns_resolver(caf::event_based_actor* self) {
+  return {
+    [=](atom::resolve, const std::string& host) -> caf::result<std::string> {
+      auto result = blocking_resolve(host);
+      if (!result) {
+        BROKER_DEBUG("failed to resolve" << host);
+        return std::move(result.error());
+      }
+      BROKER_DEBUG("resolved" << host << "to" << *result);
+      return std::move(*result);
+    },
+  };
+}
+
+} // namespace broker::internal
@@ -5,6 +5,7 @@
 #include <caf/execution_unit.hpp>
 #include <caf/mailbox_element.hpp>
 
+#include "broker/defaults.hh"
 #include "broker/internal/logger.hh"
 
 namespace broker::internal {
@@ -12,6 +13,8 @@ namespace broker::internal {
 flare_actor::flare_actor(caf::actor_config& sys)
     : blocking_actor{sys},
       flare_count_{0} {
+  spin_count_ = caf::get_or(config(), "broker.subscriber.spin-count",
+                            defaults::subscriber::spin_count);
 }
 
 void flare_actor::launch(caf::execution_unit*, bool, bool) {
@@ -27,31 +30,59 @@ void flare_actor::act() {
 void flare_actor::await_data() {
   BROKER_DEBUG("awaiting data");
   std::unique_lock<std::mutex> lock{flare_mtx_};
-  if (flare_count_ > 0 )
+  if (flare_count_.load(std::memory_order_relaxed) > 0)
     return;
+  if (!flare_) {
+    // No descriptor consumer exists: park on the condition variable instead
+    // of a file descriptor.
+    lock.unlock();
+    if (spin_on_count())
+      return;
+    lock.lock();
+    flare_cv_.wait(lock, [this] {
+      return flare_count_.load(std::memory_order_relaxed) > 0;
+    });
+    return;
+  }
   lock.unlock();
-  flare_.await_one();
+  if (flare_->spin_await_one(spin_count_))
+    return;
+  flare_->await_one();
 }
 
 bool flare_actor::await_data(timeout_type timeout) {
   BROKER_DEBUG("awaiting data with timeout");
   std::unique_lock<std::mutex> lock{flare_mtx_};
-  if (flare_count_ > 0)
+  if (flare_count_.load(std::memory_order_relaxed) > 0)
     return true;
+  if (!flare_) {
+    lock.unlock();
+    if (spin_on_count())
+      return true;
+    lock.lock();
+    return flare_cv_.wait_until(lock, timeout, [this] {
+      return flare_count_.load(std::memory_order_relaxed) > 0;
+    });
+  }
   lock.unlock();
-  auto res = flare_.await_one(timeout);
+  if (flare_->spin_await_one(spin_count_))
+    return true;
+  auto res = flare_->await_one(timeout);
   return res;
 }
 
 void flare_actor::enqueue(caf::mailbox_element_ptr ptr, caf::execution_unit*) {
   auto mid = ptr->mid;
   auto sender = ptr->sender;
+  auto fired = false;
   std::unique_lock<std::mutex> lock{flare_mtx_};
   switch (mailbox().enqueue(ptr.release())) {
     case caf::detail::enqueue_result::unblocked_reader: {
       BROKER_DEBUG("firing flare");
-      flare_.fire();
-      ++flare_count_;
+      if (flare_)
+        flare_->fire();
+      flare_count_.fetch_add(1, std::memory_order_release);
+      fired = true;
       break;
     }
     case caf::detail::enqueue_result::queue_closed:
@@ -61,11 +92,18 @@ void flare_actor::enqueue(caf::mailbox_element_ptr ptr, caf::execution_unit*) {
       }
       break;
     case caf::detail::enqueue_result::success: {
-      flare_.fire();
-      ++flare_count_;
+      if (flare_)
+        flare_->fire();
+      flare_count_.fetch_add(1, std::memory_order_release);
+      fired = true;
       break;
     }
   }
+  lock.unlock();
+  // Without a waiter, the notify call is practically free; with one, it
+  // replaces the flare syscall of the fd-based path.
+  if (fired)
+    flare_cv_.notify_one();
 }
 
 caf::mailbox_element_ptr flare_actor::dequeue() {
@@ -84,9 +122,43 @@ const char* flare_actor::name() const {
 
 void flare_actor::extinguish_one() {
   std::unique_lock<std::mutex> lock{flare_mtx_};
-  auto extinguished = flare_.extinguish_one();
-  CAF_ASSERT(extinguished);
-  --flare_count_;
+  if (flare_) {
+    auto extinguished = flare_->extinguish_one();
+    CAF_ASSERT(extinguished);
+  }
+  flare_count_.fetch_sub(1, std::memory_order_release);
+}
+
+void flare_actor::extinguish_many(size_t num) {
+  if (num == 0)
+    return;
+  std::unique_lock<std::mutex> lock{flare_mtx_};
+  if (flare_) {
+    auto extinguished = flare_->extinguish_some(num);
+    CAF_ASSERT(extinguished == num);
+  }
+  flare_count_.fetch_sub(static_cast<int>(num), std::memory_order_release);
+}
+
+detail::native_socket flare_actor::descriptor() {
+  std::unique_lock<std::mutex> lock{flare_mtx_};
+  if (!flare_) {
+    // First descriptor consumer: materialize the flare and transfer the
+    // pending count, so the fd reports ready for messages that arrived while
+    // the actor still ran fd-less.
+    flare_ = std::make_unique<detail::flare>();
+    auto pending = flare_count_.load(std::memory_order_relaxed);
+    if (pending > 0)
+      flare_->fire(static_cast<size_t>(pending));
+  }
+  return flare_->fd();
+}
+
+bool flare_actor::spin_on_count() const {
+  for (size_t i = 0; i < spin_count_; ++i)
+    if (flare_count_.load(std::memory_order_acquire) > 0)
+      return true;
+  return false;
 }
 
 } // namespace broker::internal
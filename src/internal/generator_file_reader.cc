@@ -9,6 +9,11 @@
 #include <caf/none.hpp>
 
 #include "broker/config.hh"
+
+#ifdef BROKER_HAVE_ZLIB
+#  include <zlib.h>
+#endif
+
 #include "broker/detail/assert.hh"
 #include "broker/error.hh"
 #include "broker/internal/generator_file_writer.hh"
@@ -110,7 +115,8 @@ namespace broker::internal {
 generator_file_reader::generator_file_reader(file_handle_type fd,
                                              mapper_handle mapper,
                                              mapped_pointer addr,
-                                             size_t file_size)
+                                             size_t file_size,
+                                             uint8_t file_version)
   : fd_(fd),
     mapper_(mapper),
     addr_(addr),
@@ -119,29 +125,134 @@ generator_file_reader::generator_file_reader(file_handle_type fd,
             caf::make_span(reinterpret_cast<caf::byte*>(addr), file_size)),
     generator_(source_) {
   // We've already verified the file header in make_generator_file_reader.
-  source_.skip(sizeof(generator_file_writer::format::magic)
-               + sizeof(generator_file_writer::format::version));
+  using format = generator_file_writer::format;
+  version_ = file_version;
+  compressed_ = file_version == format::version_compressed
+                || file_version == format::version_timed_compressed;
+  if (compressed_) {
+    // Frames decode lazily in load_frame; start with an empty source.
+    frame_offset_ = format::header_size;
+    source_.reset({});
+  } else {
+    source_.skip(format::header_size);
+  }
 }
 
 generator_file_reader::~generator_file_reader() {
+  if (prefetching_) {
+    {
+      std::unique_lock guard{prefetch_mtx_};
+      prefetch_stop_ = true;
+    }
+    prefetch_producer_cv_.notify_one();
+    prefetch_thread_.join();
+  }
   unmap_file(addr_, file_size_);
   close_file(fd_);
 }
 
 bool generator_file_reader::at_end() const {
+  if (prefetching_) {
+    // Wait until the pipeline settles: a `false` from this function must
+    // guarantee that the next read pops an entry instead of hitting EOF.
+    std::unique_lock guard{prefetch_mtx_};
+    prefetch_consumer_cv_.wait(guard, [this] {
+      return !prefetch_buf_.empty() || prefetch_eof_;
+    });
+    return prefetch_buf_.empty() && prefetch_eof_;
+  }
+  return at_end_impl();
+}
+
+bool generator_file_reader::at_end_impl() const {
+  if (compressed_)
+    return source_.remaining() == 0 && frame_offset_ >= file_size_;
   return source_.remaining() == 0;
 }
 
 void generator_file_reader::rewind() {
   BROKER_ASSERT(at_end());
+  if (prefetching_) {
+    {
+      // The prefetch thread parks once it reports EOF, so we may safely clear
+      // the EOF state here: a subsequent read then blocks until the thread
+      // performed the rewind and refilled the buffer.
+      std::unique_lock guard{prefetch_mtx_};
+      front_gap_ = timespan{0};
+      prefetch_eof_ = false;
+      prefetch_err_ = caf::none;
+      prefetch_rewind_ = true;
+    }
+    prefetch_producer_cv_.notify_one();
+    return;
+  }
+  rewind_impl();
+}
+
+void generator_file_reader::rewind_impl() {
   sealed_ = true;
+  pending_gap_ = timespan{0};
+  if (compressed_) {
+    frame_offset_ = generator_file_writer::format::header_size;
+    source_.reset({});
+    return;
+  }
   source_.reset({reinterpret_cast<caf::byte*>(addr_), file_size_});
   source_.skip(sizeof(generator_file_writer::format::magic)
                + sizeof(generator_file_writer::format::version));
 }
 
+caf::error generator_file_reader::load_frame() {
+#ifdef BROKER_HAVE_ZLIB
+  BROKER_ASSERT(compressed_);
+  uint32_t sizes[2]; // Compressed and decompressed payload size.
+  if (frame_offset_ + sizeof(sizes) > file_size_)
+    return ec::end_of_file;
+  auto base = reinterpret_cast<const char*>(addr_);
+  memcpy(sizes, base + frame_offset_, sizeof(sizes));
+  if (frame_offset_ + sizeof(sizes) + sizes[0] > file_size_)
+    return ec::invalid_data;
+  frame_buf_.resize(sizes[1]);
+  auto decompressed_size = static_cast<uLongf>(sizes[1]);
+  if (uncompress(reinterpret_cast<Bytef*>(frame_buf_.data()),
+                 &decompressed_size,
+                 reinterpret_cast<const Bytef*>(base + frame_offset_
+                                                + sizeof(sizes)),
+                 sizes[0])
+        != Z_OK
+      || decompressed_size != sizes[1])
+    return ec::invalid_data;
+  frame_offset_ += sizeof(sizes) + sizes[0];
+  source_.reset(caf::make_span(frame_buf_));
+  return caf::none;
+#else
+  return ec::invalid_data;
+#endif
+}
+
 caf::error generator_file_reader::read(value_type& x) {
-  if (at_end())
+  if (prefetching_) {
+    std::unique_lock guard{prefetch_mtx_};
+    prefetch_consumer_cv_.wait(guard, [this] {
+      return !prefetch_buf_.empty() || prefetch_eof_;
+    });
+    if (prefetch_buf_.empty()) {
+      if (prefetch_err_)
+        return prefetch_err_;
+      return ec::end_of_file;
+    }
+    x = std::move(prefetch_buf_.front().value);
+    front_gap_ = prefetch_buf_.front().gap;
+    prefetch_buf_.pop_front();
+    guard.unlock();
+    prefetch_producer_cv_.notify_one();
+    return caf::none;
+  }
+  return read_impl(x);
+}
+
+caf::error generator_file_reader::read_impl(value_type& x) {
+  if (at_end_impl())
     return ec::end_of_file;
   auto f = [&x](value_type* ptr, caf::span<const caf::byte>) {
     // Skip topic entries.
@@ -156,7 +267,9 @@ caf::error generator_file_reader::read(value_type& x) {
 caf::error generator_file_reader::read_raw(read_raw_callback f) {
   using entry_type = generator_file_writer::format::entry_type;
   // Read until we've reached the end or the callback return false.
-  while (!at_end()) {
+  while (!at_end_impl()) {
+    if (compressed_ && source_.remaining() == 0)
+      BROKER_TRY(load_frame());
     entry_type entry{};
     auto pos = source_.remainder().data();
     BROKER_TRY(read_value(source_, entry));
@@ -187,6 +300,16 @@ caf::error generator_file_reader::read_raw(read_raw_callback f) {
           return caf::none;
         break;
       }
+      case entry_type::time_delta: {
+        uint64_t us = 0;
+        BROKER_TRY(read_value(source_, us));
+        pending_gap_ += std::chrono::duration_cast<timespan>(
+          std::chrono::microseconds(us));
+        auto consumed = caf::make_span(pos, source_.remainder().data());
+        if (!f(nullptr, consumed))
+          return caf::none;
+        break;
+      }
       case entry_type::command_message: {
         uint16_t topic_id;
         BROKER_TRY(read_value(source_, topic_id));
@@ -209,19 +332,67 @@ caf::error generator_file_reader::read_raw(read_raw_callback f) {
 }
 
 caf::error generator_file_reader::skip() {
-  if (at_end())
+  if (at_end_impl())
     return ec::end_of_file;
   value_type tmp;
-  return read(tmp);
+  return read_impl(tmp);
 }
 
 caf::error generator_file_reader::skip_to_end() {
-  while (!at_end())
+  while (!at_end_impl())
     if (auto err = skip())
       return err;
   return caf::none;
 }
 
+void generator_file_reader::enable_prefetch(size_t depth) {
+  BROKER_ASSERT(!prefetching_);
+  if (depth == 0)
+    return;
+  prefetch_depth_ = depth;
+  prefetching_ = true;
+  prefetch_thread_ = std::thread{[this] { prefetch_loop(); }};
+}
+
+void generator_file_reader::prefetch_loop() {
+  std::unique_lock guard{prefetch_mtx_};
+  for (;;) {
+    prefetch_producer_cv_.wait(guard, [this] {
+      return prefetch_stop_ || prefetch_rewind_
+             || (!prefetch_eof_ && prefetch_buf_.size() < prefetch_depth_);
+    });
+    if (prefetch_stop_)
+      return;
+    if (prefetch_rewind_) {
+      prefetch_rewind_ = false;
+      prefetch_eof_ = false;
+      prefetch_err_ = caf::none;
+      rewind_impl();
+    }
+    // Decode outside the lock; only this thread touches the decode state.
+    guard.unlock();
+    if (at_end_impl()) {
+      guard.lock();
+      prefetch_eof_ = true;
+      prefetch_consumer_cv_.notify_one();
+      continue;
+    }
+    prefetch_entry entry;
+    auto err = read_impl(entry.value);
+    entry.gap = pending_gap_;
+    pending_gap_ = timespan{0};
+    guard.lock();
+    if (err) {
+      BROKER_ERROR("prefetch thread stops after read error:" << err);
+      prefetch_err_ = std::move(err);
+      prefetch_eof_ = true;
+    } else {
+      prefetch_buf_.emplace_back(std::move(entry));
+    }
+    prefetch_consumer_cv_.notify_one();
+  }
+}
+
 generator_file_reader_ptr make_generator_file_reader(const std::string& fname) {
   // Get a file handle for the file.
   auto [fd, fd_ok] = open_file(fname.c_str());
@@ -265,12 +436,20 @@ generator_file_reader_ptr make_generator_file_reader(const std::string& fname) {
     BROKER_ERROR("unexpected file header (magic mismatch):" << fname);
     return nullptr;
   }
-  if (version != generator_file_writer::format::version) {
+  using format = generator_file_writer::format;
+  if (version < format::version || version > format::version_timed_compressed) {
     BROKER_ERROR("unexpected file header (version mismatch):" << fname);
     return nullptr;
   }
+#ifndef BROKER_HAVE_ZLIB
+  if (version == format::version_compressed
+      || version == format::version_timed_compressed) {
+    BROKER_ERROR("compressed generator file requires zlib support:" << fname);
+    return nullptr;
+  }
+#endif
   // Done.
-  auto ptr = new generator_file_reader(fd, mapper, addr, fsize);
+  auto ptr = new generator_file_reader(fd, mapper, addr, fsize, version);
   guard1.disable();
   guard2.disable();
   return generator_file_reader_ptr{ptr};
@@ -3,6 +3,12 @@
 #include <caf/error.hpp>
 #include <caf/sec.hpp>
 
+#include "broker/config.hh"
+
+#ifdef BROKER_HAVE_ZLIB
+#  include <zlib.h>
+#endif
+
 #include "broker/error.hh"
 #include "broker/internal/logger.hh"
 #include "broker/internal/meta_command_writer.hh"
@@ -13,13 +19,12 @@
 
 namespace broker::internal {
 
-auto generator_file_writer::format::header()
+auto generator_file_writer::format::header(uint8_t file_version)
   -> std::array<caf::byte, header_size> {
   std::array<caf::byte, header_size> result;
   auto m = format::magic;
-  auto v = format::version;
   memcpy(result.data(), &m, sizeof(m));
-  memcpy(result.data() + sizeof(m), &v, sizeof(v));
+  memcpy(result.data() + sizeof(m), &file_version, sizeof(file_version));
   return result;
 }
 
@@ -33,15 +38,34 @@ generator_file_writer::~generator_file_writer() {
     BROKER_ERROR("flushing file in destructor failed:" << err);
 }
 
-caf::error generator_file_writer::open(std::string file_name) {
+caf::error generator_file_writer::open(std::string file_name, bool compressed,
+                                       bool timed) {
   if (auto err = flush()) {
     // Log the error, but ignore it otherwise.
     BROKER_ERROR("flushing previous file failed:" << err);
   }
+#ifndef BROKER_HAVE_ZLIB
+  if (compressed) {
+    BROKER_WARNING("compressed recording requires zlib support, "
+                   "falling back to the uncompressed format");
+    compressed = false;
+  }
+#endif
+  compressed_ = compressed;
+  timed_ = timed;
+  last_entry_ = {};
+  if (compressed_)
+    flush_threshold_ = format::default_frame_size;
   f_.open(file_name, std::ofstream::binary);
   if (!f_.is_open())
     return caf::make_error(ec::cannot_open_file, file_name);
-  auto header = format::header();
+  uint8_t file_version;
+  if (timed_)
+    file_version = compressed_ ? format::version_timed_compressed
+                               : format::version_timed;
+  else
+    file_version = compressed_ ? format::version_compressed : format::version;
+  auto header = format::header(file_version);
   if (!f_.write(reinterpret_cast<char*>(header.data()), header.size())) {
     BROKER_ERROR("unable to write to file:" << file_name);
     f_.close();
@@ -59,6 +83,27 @@ caf::error generator_file_writer::open(std::string file_name) {
 caf::error generator_file_writer::flush() {
   if (!f_.is_open() || buf_.empty())
     return caf::none;
+#ifdef BROKER_HAVE_ZLIB
+  if (compressed_) {
+    // Flushes happen between entries, so each frame holds whole entries.
+    auto compressed_size = static_cast<uLongf>(compressBound(buf_.size()));
+    std::vector<Bytef> frame(compressed_size);
+    if (compress2(frame.data(), &compressed_size,
+                  reinterpret_cast<const Bytef*>(buf_.data()), buf_.size(),
+                  Z_DEFAULT_COMPRESSION)
+        != Z_OK)
+      return caf::make_error(ec::cannot_write_file, file_name_);
+    uint32_t sizes[2] = {static_cast<uint32_t>(compressed_size),
+                         static_cast<uint32_t>(buf_.size())};
+    if (!f_.write(reinterpret_cast<const char*>(sizes), sizeof(sizes))
+        || !f_.write(reinterpret_cast<const char*>(frame.data()),
+                     compressed_size))
+      return caf::make_error(ec::cannot_write_file, file_name_);
+    buf_.clear();
+    sink_.seek(0);
+    return caf::none;
+  }
+#endif
   if (!f_.write(reinterpret_cast<const char*>(buf_.data()), buf_.size()))
     return caf::make_error(ec::cannot_write_file, file_name_);
   buf_.clear();
@@ -70,7 +115,7 @@ caf::error generator_file_writer::write(const data_message& x) {
   meta_data_writer writer{sink_};
   uint16_t tid;
   auto entry = format::entry_type::data_message;
-  BROKER_TRY(topic_id(get_topic(x), tid), write_value(sink_, entry),
+  BROKER_TRY(stamp(), topic_id(get_topic(x), tid), write_value(sink_, entry),
              write_value(sink_, tid), writer(get_data(x)));
   if (buf_.size() >= flush_threshold())
     return flush();
@@ -81,7 +126,7 @@ caf::error generator_file_writer::write(const command_message& x) {
   meta_command_writer writer{sink_};
   uint16_t tid;
   auto entry = format::entry_type::command_message;
-  BROKER_TRY(topic_id(get_topic(x), tid), write_value(sink_, entry),
+  BROKER_TRY(stamp(), topic_id(get_topic(x), tid), write_value(sink_, entry),
              write_value(sink_, tid), writer(get_command(x)));
   if (buf_.size() >= flush_threshold())
     return flush();
@@ -94,6 +139,26 @@ caf::error generator_file_writer::write(const data_or_command_message& x) {
   return write(std::get<command_message>(x));
 }
 
+caf::error generator_file_writer::stamp() {
+  if (!timed_)
+    return caf::none;
+  auto now = std::chrono::steady_clock::now();
+  if (last_entry_.time_since_epoch().count() == 0) {
+    // The first message has no predecessor, so there is no gap to record.
+    last_entry_ = now;
+    return caf::none;
+  }
+  auto gap = std::chrono::duration_cast<std::chrono::microseconds>(
+    now - last_entry_);
+  last_entry_ = now;
+  if (gap.count() <= 0)
+    return caf::none;
+  auto entry = format::entry_type::time_delta;
+  auto val = static_cast<uint64_t>(gap.count());
+  BROKER_TRY(write_value(sink_, entry), write_value(sink_, val));
+  return caf::none;
+}
+
 caf::error generator_file_writer::topic_id(const topic& x, uint16_t& id) {
   auto e = topic_table_.end();
   auto i = std::find(topic_table_.begin(), e, x);
@@ -117,9 +182,11 @@ generator_file_writer::operator bool() const {
   return static_cast<bool>(f_);
 }
 
-generator_file_writer_ptr make_generator_file_writer(const std::string& fname) {
+generator_file_writer_ptr make_generator_file_writer(const std::string& fname,
+                                                     bool compressed,
+                                                     bool timed) {
   generator_file_writer_ptr result{new generator_file_writer};
-  if (result->open(fname) != caf::none)
+  if (result->open(fname, compressed, timed) != caf::none)
     return nullptr;
   return result;
 }
@@ -0,0 +1,96 @@
+#include "broker/internal/lag_watchdog.hh"
+
+#include <algorithm>
+#include <chrono>
+
+#include <caf/actor_cast.hpp>
+#include <caf/actor_registry.hpp>
+#include <caf/actor_system.hpp>
+#include <caf/actor_system_config.hpp>
+#include <caf/event_based_actor.hpp>
+#include <caf/string_view.hpp>
+#include <caf/system_messages.hpp>
+#include <caf/telemetry/histogram.hpp>
+#include <caf/telemetry/metric_family_impl.hpp>
+#include <caf/telemetry/metric_registry.hpp>
+
+#include "broker/defaults.hh"
+#include "broker/internal/type_id.hh"
+
+namespace broker::internal {
+
+namespace {
+
+/// Upper bounds for the lag histograms in seconds. Log-spaced buckets cover
+/// the sub-millisecond happy path up to multi-second stalls.
+constexpr double upper_bounds[] = {
+  0.0001, 0.0004, 0.0016, 0.0064, 0.0256, 0.1024, 0.4096, 1.6384, 6.5536,
+};
+
+} // namespace
+
+void record_scheduler_lag(caf::actor_system& sys, caf::string_view actor_name,
+                          timestamp sent) {
+  auto delta = std::chrono::duration<double>{broker::now() - sent};
+  caf::string_view label_names[] = {"actor"};
+  auto family = sys.metrics().histogram_family<double>(
+    "broker", "scheduler-lag", label_names, upper_bounds,
+    "Time between posting a no-op message to a long-lived actor and the "
+    "actor processing it.",
+    "seconds");
+  family->get_or_add({{"actor", actor_name}})
+    ->observe(std::max(delta.count(), 0.0));
+}
+
+void enroll_with_lag_watchdog(caf::local_actor* self) {
+  if (auto hdl = self->system().registry().get(lag_watchdog_registry_key))
+    caf::anon_send(caf::actor_cast<caf::actor>(hdl), atom::join_v,
+                   caf::actor_cast<caf::actor>(self));
+}
+
+lag_watchdog_state::lag_watchdog_state(caf::event_based_actor* self)
+  : lag_watchdog_state(self,
+                       caf::get_or(self->system().config(),
+                                   "broker.metrics.scheduler-lag-interval",
+                                   defaults::metrics::scheduler_lag_interval)) {
+  // nop
+}
+
+lag_watchdog_state::lag_watchdog_state(caf::event_based_actor* self,
+                                       caf::timespan interval)
+  : self_(self), interval_(interval) {
+  self->system().registry().put(lag_watchdog_registry_key,
+                                caf::actor_cast<caf::strong_actor_ptr>(self));
+  self->attach_functor([&sys = self->system()] {
+    sys.registry().erase(lag_watchdog_registry_key);
+  });
+}
+
+caf::behavior lag_watchdog_state::make_behavior() {
+  self_->set_down_handler([this](const caf::down_msg& msg) {
+    auto pred = [&msg](const caf::actor& hdl) {
+      return hdl.address() == msg.source;
+    };
+    targets_.erase(std::remove_if(targets_.begin(), targets_.end(), pred),
+                   targets_.end());
+    if (had_targets_ && targets_.empty())
+      self_->quit();
+  });
+  self_->scheduled_send(self_, self_->clock().now() + interval_, atom::tick_v);
+  return {
+    [this](atom::join, caf::actor& target) {
+      self_->monitor(target);
+      targets_.emplace_back(std::move(target));
+      had_targets_ = true;
+    },
+    [this](atom::tick) {
+      auto ts = broker::now();
+      for (auto& target : targets_)
+        self_->send(target, atom::ping_v, ts);
+      self_->scheduled_send(self_, self_->clock().now() + interval_,
+                            atom::tick_v);
+    },
+  };
+}
+
+} // namespace broker::internal
@@ -0,0 +1,71 @@
+#include "broker/internal/latency_tracer.hh"
+
+#include <algorithm>
+
+#include <caf/actor_system.hpp>
+#include <caf/actor_system_config.hpp>
+#include <caf/scheduled_actor.hpp>
+#include <caf/telemetry/histogram.hpp>
+#include <caf/telemetry/metric_family_impl.hpp>
+#include <caf/telemetry/metric_registry.hpp>
+
+#include "broker/defaults.hh"
+#include "broker/topic.hh"
+
+namespace broker::internal {
+
+namespace {
+
+/// Upper bounds for the latency histograms in seconds. Log-spaced buckets
+/// (roughly powers of four) cover one microsecond to 16 seconds with a
+/// constant relative error, like an HDR histogram with a coarse precision.
+constexpr double upper_bounds[] = {
+  0.000001, 0.000004, 0.000016, 0.000064, 0.000256, 0.001,
+  0.004,    0.016,    0.064,    0.256,    1.0,      4.0,
+  16.0,
+};
+
+/// Extracts the first segment of a topic, e.g., "zeek" for "/zeek/events".
+std::string_view first_segment(const topic& t) noexcept {
+  std::string_view str = t.string();
+  if (!str.empty() && str.front() == topic::sep)
+    str.remove_prefix(1);
+  if (auto pos = str.find(topic::sep); pos != std::string_view::npos)
+    str = str.substr(0, pos);
+  return str;
+}
+
+} // namespace
+
+latency_tracer::latency_tracer(caf::scheduled_actor* self) {
+  const auto& cfg = self->system().config();
+  sample_rate_ = caf::get_or(cfg, "broker.metrics.latency-sample-rate",
+                             defaults::metrics::latency_sample_rate);
+  if (sample_rate_ > 0) {
+    auto& reg = self->system().metrics();
+    caf::string_view label_names[] = {"prefix"};
+    family_ = reg.histogram_family<double>(
+      "broker", "message-latency", label_names, upper_bounds,
+      "Time between publishing a message and delivering it to a local "
+      "subscriber, by first topic segment. Only sampled messages contribute.",
+      "seconds");
+  }
+}
+
+void latency_tracer::record(const node_message& msg) {
+  if (msg.stamp == timestamp{})
+    return;
+  auto delta = std::chrono::duration<double>{broker::now() - msg.stamp};
+  instance(get_topic(msg))->observe(std::max(delta.count(), 0.0));
+}
+
+caf::telemetry::dbl_histogram* latency_tracer::instance(const topic& t) {
+  auto key = std::string{first_segment(t)};
+  if (auto i = instances_.find(key); i != instances_.end())
+    return i->second;
+  auto ptr = family_->get_or_add({{"prefix", key}});
+  instances_.emplace(std::move(key), ptr);
+  return ptr;
+}
+
+} // namespace broker::internal
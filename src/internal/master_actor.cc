@@ -1,5 +1,8 @@
 #include "broker/internal/logger.hh" // Needs to come before CAF includes.
 
+#include <algorithm>
+#include <chrono>
+
 #include <caf/actor.hpp>
 #include <caf/attach_stream_sink.hpp>
 #include <caf/behavior.hpp>
@@ -9,13 +12,25 @@
 #include <caf/stateful_actor.hpp>
 #include <caf/sum_type.hpp>
 #include <caf/system_messages.hpp>
+#include <caf/telemetry/counter.hpp>
+#include <caf/telemetry/gauge.hpp>
+#include <caf/telemetry/histogram.hpp>
+#include <caf/telemetry/metric_family_impl.hpp>
+#include <caf/telemetry/metric_registry.hpp>
 #include <caf/unit.hpp>
 
 #include "broker/convert.hh"
 #include "broker/data.hh"
+#include "broker/defaults.hh"
 #include "broker/detail/abstract_backend.hh"
 #include "broker/detail/die.hh"
+#include "broker/detail/filesystem.hh"
+#include "broker/detail/sdt.hh"
+#include "broker/detail/snapshot_codec.hh"
+#include "broker/detail/store_file.hh"
+#include "broker/internal/lag_watchdog.hh"
 #include "broker/internal/master_actor.hh"
+#include "broker/internal/snapshot_chunk.hh"
 #include "broker/internal/native.hh"
 #include "broker/internal/type_id.hh"
 #include "broker/store.hh"
@@ -43,22 +58,280 @@ auto to_caf_res(expected<T>&& x) {
 
 void master_state::init(caf::event_based_actor* ptr, std::string&& nm,
                         backend_pointer&& bp, caf::actor&& parent,
-                        endpoint::clock* ep_clock) {
+                        endpoint::clock* ep_clock, detail::evictor&& ev) {
   super::init(ptr, ep_clock, std::move(nm), std::move(parent));
   clones_topic = id / topic::clone_suffix();
   backend = std::move(bp);
+  evictor = std::move(ev);
+  if (evictor.enabled()) {
+    // Persistent backends may start out with content; seed the bookkeeping
+    // before the expiries below refresh the TTL order.
+    if (auto ss = backend->snapshot())
+      for (auto& [key, value] : *ss)
+        evictor.insert(key);
+    auto& reg = self->system().metrics();
+    caf::string_view label_names[] = {"store"};
+    auto family
+      = reg.counter_family("broker", "store-evictions", label_names,
+                           "Entries evicted to enforce store entry budgets.");
+    evictions = family->get_or_add({{"store", id}});
+  }
+  coalesce_interval = caf::get_or(self->system().config(),
+                                  "broker.store.coalesce-interval",
+                                  defaults::store::coalesce_interval);
+  snapshot_compression = caf::get_or(self->system().config(),
+                                     "broker.store.snapshot-compression",
+                                     defaults::store::snapshot_compression);
+  auto dict_dir
+    = caf::get_or(self->system().config(),
+                  "broker.compression-dictionary-directory",
+                  caf::string_view{
+                    defaults::compression_dictionary_directory});
+  if (snapshot_compression && !dict_dir.empty()) {
+    if (auto dicts = detail::load_preset_dictionaries(dict_dir)) {
+      preset_dicts = std::move(*dicts);
+      snapshot_preset = preset_dicts.lookup(id);
+    } else {
+      BROKER_WARNING("cannot load preset dictionaries from" << dict_dir);
+    }
+  }
+  compaction_interval = caf::get_or(self->system().config(),
+                                    "broker.store.compaction-interval",
+                                    defaults::store::compaction_interval);
+  slo_sample_rate = caf::get_or(self->system().config(),
+                                "broker.store.slo-sample-rate",
+                                defaults::store::slo_sample_rate);
+  if (compaction_interval.count() > 0) {
+    auto& reg = self->system().metrics();
+    caf::string_view label_names[] = {"store"};
+    const double upper_bounds[] = {0.000001, 0.000004, 0.000016, 0.000064,
+                                   0.000256, 0.001,    0.004,    0.016,
+                                   0.064,    0.256,    1.0,      4.0,
+                                   16.0};
+    auto family
+      = reg.histogram_family<double>("broker", "store-compaction-pause",
+                                     label_names, upper_bounds,
+                                     "Time the master spent compacting its "
+                                     "store backend.",
+                                     "seconds");
+    compaction_pause = family->get_or_add({{"store", id}});
+    if (auto n = backend->size())
+      compaction_watermark = *n;
+    schedule_compaction_tick();
+  }
+  expiry_wheel = detail::timing_wheel<data>{clock->now(),
+                                            defaults::store::tick_interval};
   if (auto es = backend->expiries()) {
     for (auto& e : *es) {
-      auto& key = e.first;
-      auto& expire_time = e.second;
-      auto n = clock->now();
-      auto dur = expire_time - n;
-      auto msg = caf::make_message(atom::expire_v, std::move(key));
-      clock->send_later(facade(caf::actor{self}), dur, &msg);
+      if (evictor.enabled())
+        evictor.insert(e.first, e.second);
+      expiry_wheel.insert(e.second, std::move(e.first));
     }
+    schedule_expiry_tick();
   } else {
     detail::die("failed to get master expiries while initializing");
   }
+  view = detail::store_view::make(id);
+  refresh_view();
+  auto rec_dir
+    = caf::get_or(self->system().config(), "broker.store-recording-directory",
+                  caf::string_view{defaults::store_recording_directory});
+  if (!rec_dir.empty() && broker::detail::is_directory(rec_dir)) {
+    auto file_name = rec_dir + "/" + id + ".dat";
+    cmd_recorder = make_generator_file_writer(file_name);
+    if (cmd_recorder == nullptr)
+      BROKER_WARNING("cannot open command recording file" << file_name);
+    else
+      BROKER_DEBUG("recording store commands to" << file_name);
+  }
+  // Backends without statistics support return an error here, in which case
+  // we never start the stats tick.
+  if (backend->stats())
+    schedule_stats_tick();
+}
+
+void master_state::update_indexes(const data& key, const data* old_value,
+                                  const data* new_value) {
+  for (auto& index : indexes) {
+    if (old_value)
+      index.erase(key, *old_value);
+    if (new_value)
+      index.insert(key, *new_value);
+  }
+  run_derivations(key, old_value, new_value);
+}
+
+void master_state::run_derivation(derivation& d, const data& key,
+                                  const data* old_value,
+                                  const data* new_value) {
+  std::vector<derived_update> updates;
+  d.fn(key, old_value, new_value, updates);
+  publisher_id pub{facade(self->node()), self->id()};
+  for (auto& u : updates) {
+    internal_command cmd;
+    switch (u.op) {
+      case derived_update::action::put:
+        cmd = make_internal_command<put_command>(std::move(u.key),
+                                                 std::move(u.value),
+                                                 std::nullopt, pub);
+        break;
+      case derived_update::action::add: {
+        auto init_type = u.value.get_type();
+        cmd = make_internal_command<add_command>(std::move(u.key),
+                                                 std::move(u.value), init_type,
+                                                 std::nullopt, pub);
+        break;
+      }
+      case derived_update::action::subtract:
+        cmd = make_internal_command<subtract_command>(std::move(u.key),
+                                                      std::move(u.value),
+                                                      std::nullopt, pub);
+        break;
+      case derived_update::action::erase:
+        cmd = make_internal_command<erase_command>(std::move(u.key), pub);
+        break;
+    }
+    self->send(d.target, atom::local_v, std::move(cmd));
+  }
+}
+
+void master_state::run_derivations(const data& key, const data* old_value,
+                                   const data* new_value) {
+  for (auto& d : derivations)
+    run_derivation(d, key, old_value, new_value);
+}
+
+void master_state::rebuild_indexes() {
+  if (indexes.empty() && !subnet_keys)
+    return;
+  if (auto ss = backend->snapshot()) {
+    for (auto& index : indexes)
+      index.rebuild(*ss);
+    if (subnet_keys)
+      subnet_keys->rebuild(*ss);
+  } else {
+    BROKER_ERROR("failed to rebuild secondary indexes:" << ss.error());
+  }
+}
+
+void master_state::subnet_index_insert(const data& key) {
+  if (subnet_keys)
+    if (auto sn = get_if<subnet>(key))
+      subnet_keys->insert(*sn);
+}
+
+void master_state::subnet_index_erase(const data& key) {
+  if (subnet_keys)
+    if (auto sn = get_if<subnet>(key))
+      subnet_keys->erase(*sn);
+}
+
+caf::expected<detail::subnet_index*> master_state::lazy_subnet_index() {
+  if (!subnet_keys) {
+    auto ss = backend->snapshot();
+    if (!ss)
+      return native(ss.error());
+    subnet_keys.emplace();
+    subnet_keys->rebuild(*ss);
+  }
+  return &*subnet_keys;
+}
+
+void master_state::enforce_budget() {
+  if (!evictor.enabled())
+    return;
+  while (evictor.size() > evictor.max_entries()) {
+    auto victim = evictor.evict();
+    if (!victim)
+      break;
+    BROKER_INFO("EVICT" << *victim);
+    if (evictions)
+      evictions->inc();
+    erase_command cmd{std::move(*victim),
+                      publisher_id{facade(self->node()), self->id()}};
+    (*this)(cmd);
+  }
+}
+
+void master_state::maybe_compact() {
+  auto idle = commands_since_compaction_tick == 0;
+  commands_since_compaction_tick = 0;
+  auto n = backend->size();
+  if (!n)
+    return;
+  compaction_watermark = std::max(compaction_watermark, *n);
+  // Compact only once the store lost at least a quarter of its entries since
+  // the watermark, so steady-state stores never pay the pause.
+  if (!idle || *n * 4 >= compaction_watermark * 3)
+    return;
+  auto t0 = std::chrono::steady_clock::now();
+  if (auto res = backend->compact(); !res) {
+    BROKER_ERROR("failed to compact the backend:" << res.error());
+    return;
+  }
+  std::chrono::duration<double> pause = std::chrono::steady_clock::now() - t0;
+  BROKER_INFO("COMPACT" << *n << "entries (watermark" << compaction_watermark
+                        << ") in" << pause.count() << "seconds");
+  compaction_pause->observe(pause.count());
+  compaction_watermark = *n;
+}
+
+void master_state::schedule_compaction_tick() {
+  auto msg = caf::make_message(atom::tick_v, atom::compact_v);
+  clock->send_later(facade(caf::actor{self}), compaction_interval, &msg);
+}
+
+void master_state::refresh_stats() {
+  auto stats = backend->stats();
+  if (!stats)
+    return;
+  auto tbl = get_if<table>(&*stats);
+  if (!tbl)
+    return;
+  auto& reg = self->system().metrics();
+  caf::string_view label_names[] = {"stat", "store"};
+  auto family = reg.gauge_family("broker", "store-backend-stats", label_names,
+                                 "Statistics reported by data store "
+                                 "backends.");
+  for (const auto& [stat, value] : *tbl) {
+    auto stat_name = get_if<std::string>(&stat);
+    auto stat_value = get_if<count>(&value);
+    if (!stat_name || !stat_value)
+      continue;
+    auto g = family->get_or_add({{"stat", *stat_name}, {"store", id}});
+    // CAF gauges have no setter, so we bump by the delta instead.
+    g->inc(static_cast<int64_t>(*stat_value) - g->value());
+  }
+}
+
+void master_state::schedule_stats_tick() {
+  auto msg = caf::make_message(atom::tick_v, atom::status_v);
+  clock->send_later(facade(caf::actor{self}),
+                    defaults::metrics::export_interval, &msg);
+}
+
+void master_state::mark_view_dirty() {
+  view_dirty = true;
+  if (view->active())
+    schedule_view_refresh();
+}
+
+void master_state::refresh_view() {
+  if (auto ss = backend->snapshot()) {
+    view->publish(std::move(*ss));
+    view_dirty = false;
+  } else {
+    BROKER_ERROR("failed to refresh the store view:" << ss.error());
+  }
+}
+
+void master_state::schedule_view_refresh() {
+  if (view_refresh_pending)
+    return;
+  view_refresh_pending = true;
+  auto msg = caf::make_message(atom::tick_v, atom::snapshot_v);
+  clock->send_later(facade(caf::actor{self}), defaults::store::tick_interval,
+                    &msg);
 }
 
 void master_state::broadcast(internal_command&& x) {
@@ -66,18 +339,76 @@ void master_state::broadcast(internal_command&& x) {
              make_command_message(clones_topic, std::move(x)));
 }
 
+void master_state::log_command(const internal_command& x) {
+  op_log.emplace_back(x.seq, x);
+  // Replayed commands must not carry the SLO stamp: measuring the original
+  // broadcast time against a delta replay would only report the length of
+  // the disconnect, not the health of the live pipeline.
+  op_log.back().second.stamp = timestamp{};
+  while (op_log.size() > defaults::store::op_log_capacity)
+    op_log.pop_front();
+}
+
+void master_state::coalesce_update(const data& key,
+                                   std::optional<timespan> expiry,
+                                   publisher_id publisher) {
+  coalesced[key] = coalesced_update{expiry, publisher};
+  schedule_coalesce_flush();
+  mark_view_dirty();
+}
+
+void master_state::flush_coalesced() {
+  coalesce_flush_pending = false;
+  for (auto& [key, info] : coalesced) {
+    auto val = backend->get(key);
+    if (!val) {
+      // The key vanished after its last update; the erase was broadcasted
+      // immediately and already covers it.
+      continue;
+    }
+    broadcast_cmd_to_clones(
+      put_command{key, std::move(*val), info.expiry, info.publisher});
+  }
+  coalesced.clear();
+}
+
+void master_state::schedule_coalesce_flush() {
+  if (coalesce_flush_pending || coalesced.empty())
+    return;
+  coalesce_flush_pending = true;
+  auto msg = caf::make_message(atom::tick_v, atom::flush_v);
+  clock->send_later(facade(caf::actor{self}), coalesce_interval, &msg);
+}
+
 void master_state::remind(timespan expiry, const data& key) {
-  auto msg = caf::make_message(atom::expire_v, key);
-  clock->send_later(facade(caf::actor{self}), expiry, &msg);
+  expiry_wheel.insert(clock->now() + expiry, key);
+  schedule_expiry_tick();
+}
+
+void master_state::schedule_expiry_tick() {
+  if (expiry_tick_pending || expiry_wheel.empty())
+    return;
+  expiry_tick_pending = true;
+  auto msg = caf::make_message(atom::tick_v, atom::expire_v);
+  clock->send_later(facade(caf::actor{self}), defaults::store::tick_interval,
+                    &msg);
 }
 
 void master_state::expire(data& key) {
   BROKER_INFO("EXPIRE" << key);
+  std::optional<data> old_value;
+  if (!indexes.empty() || !derivations.empty())
+    if (auto val = backend->get(key))
+      old_value = std::move(*val);
   if (auto result = backend->expire(key, clock->now()); !result) {
     BROKER_ERROR("EXPIRE" << key << "(FAILED)" << to_string(result.error()));
   } else if (!*result) {
     BROKER_INFO("EXPIRE" << key << "(IGNORE/STALE)");
   } else {
+    if (old_value)
+      update_indexes(key, &*old_value, nullptr);
+    evictor.erase(key);
+    subnet_index_erase(key);
     expire_command cmd{std::move(key),
                        publisher_id{facade(self->node()), self->id()}};
     emit_expire_event(cmd);
@@ -86,11 +417,33 @@ void master_state::expire(data& key) {
 }
 
 void master_state::command(internal_command& cmd) {
+  // Writers stamp a per-writer sequence number; zero means unstamped.
+  if (cmd.seq != 0)
+    if (auto writer = publisher_of(cmd.content))
+      if (writer_filter.is_duplicate(writer, cmd.seq)) {
+        BROKER_DEBUG("drop duplicated command" << cmd.seq << "from" << writer);
+        return;
+      }
   command(cmd.content);
 }
 
 void master_state::command(internal_command::variant_type& cmd) {
+  BROKER_PROBE1(master_dispatch, cmd.index());
+  if (cmd_recorder != nullptr)
+    record_command(cmd);
+  ++commands_since_compaction_tick;
+  auto t0 = std::chrono::steady_clock::now();
   std::visit(*this, cmd);
+  std::chrono::duration<double> runtime = std::chrono::steady_clock::now() - t0;
+  metrics.observe(cmd.index(), runtime.count());
+}
+
+void master_state::record_command(const internal_command::variant_type& cmd) {
+  auto msg = make_command_message(id, internal_command{cmd});
+  if (auto err = cmd_recorder->write(msg)) {
+    BROKER_WARNING("unable to write to command recording file:" << err);
+    cmd_recorder = nullptr;
+  }
 }
 
 void master_state::operator()(none) {
@@ -108,11 +461,15 @@ void master_state::operator()(put_command& x) {
   }
   if (x.expiry)
     remind(*x.expiry, x.key);
+  update_indexes(x.key, old_value ? &*old_value : nullptr, &x.value);
+  evictor.insert(x.key, et);
+  subnet_index_insert(x.key);
   if (old_value)
     emit_update_event(x, *old_value);
   else
     emit_insert_event(x);
   broadcast_cmd_to_clones(std::move(x));
+  enforce_budget();
 }
 
 void master_state::operator()(put_unique_command& x) {
@@ -132,20 +489,30 @@ void master_state::operator()(put_unique_command& x) {
   self->send(native(x.who), caf::make_message(data{true}, x.req_id));
   if (x.expiry)
     remind(*x.expiry, x.key);
+  update_indexes(x.key, nullptr, &x.value);
+  evictor.insert(x.key, et);
+  subnet_index_insert(x.key);
   emit_insert_event(x);
   // Broadcast a regular "put" command. Clones don't have to do their own
   // existence check.
   put_command cmd{std::move(x.key), std::move(x.value), x.expiry,
                   std::move(x.publisher)};
   broadcast_cmd_to_clones(std::move(cmd));
+  enforce_budget();
 }
 
 void master_state::operator()(erase_command& x) {
   BROKER_INFO("ERASE" << x.key);
+  // Reading the old value only pays off when indexes or derivations exist.
+  if (!indexes.empty() || !derivations.empty())
+    if (auto old_value = backend->get(x.key))
+      update_indexes(x.key, &*old_value, nullptr);
   if (auto res = backend->erase(x.key); !res) {
     BROKER_WARNING("failed to erase" << x.key << "->" << res.error());
     return; // TODO: propagate failure? to all clones? as status msg?
   }
+  evictor.erase(x.key);
+  subnet_index_erase(x.key);
   emit_erase_event(x.key, x.publisher);
   broadcast_cmd_to_clones(std::move(x));
 }
@@ -170,15 +537,24 @@ void master_state::operator()(add_command& x) {
   } else {
     if (x.expiry)
       remind(*x.expiry, x.key);
-    // Broadcast a regular "put" command. Clones don't have to repeat the same
-    // processing again.
+    update_indexes(x.key, old_value ? &*old_value : nullptr, &*val);
+    evictor.insert(x.key, et);
+    subnet_index_insert(x.key);
     put_command cmd{std::move(x.key), std::move(*val), std::nullopt,
-                    std::move(x.publisher)};
+                    x.publisher};
     if (old_value)
       emit_update_event(cmd, *old_value);
     else
       emit_insert_event(cmd);
-    broadcast_cmd_to_clones(std::move(cmd));
+    if (coalescing())
+      // Defer the broadcast: hot keys absorb any number of add/subtract
+      // operations per flush window and ship as one merged update.
+      coalesce_update(cmd.key, x.expiry, std::move(x.publisher));
+    else
+      // Broadcast a regular "put" command. Clones don't have to repeat the
+      // same processing again.
+      broadcast_cmd_to_clones(std::move(cmd));
+    enforce_budget();
   }
 }
 
@@ -203,13 +579,58 @@ void master_state::operator()(subtract_command& x) {
   } else {
     if (x.expiry)
       remind(*x.expiry, x.key);
-    // Broadcast a regular "put" command. Clones don't have to repeat the same
-    // processing again.
+    update_indexes(x.key, &*old_value, &*val);
+    evictor.insert(x.key, et);
     put_command cmd{std::move(x.key), std::move(*val), std::nullopt,
-                    std::move(x.publisher)};
+                    x.publisher};
     emit_update_event(cmd, *old_value);
-    broadcast_cmd_to_clones(std::move(cmd));
+    if (coalescing())
+      coalesce_update(cmd.key, x.expiry, std::move(x.publisher));
+    else
+      // Broadcast a regular "put" command. Clones don't have to repeat the
+      // same processing again.
+      broadcast_cmd_to_clones(std::move(cmd));
+  }
+}
+
+void master_state::operator()(multi_put_command& x) {
+  BROKER_INFO("MULTI_PUT with" << x.entries.size() << "entries");
+  auto et = to_opt_timestamp(clock->now(), x.expiry);
+  for (auto& [key, value] : x.entries) {
+    auto old_value = backend->get(key);
+    if (auto res = backend->put(key, value, et); !res) {
+      BROKER_WARNING("failed to put" << key << "->" << value);
+      continue; // TODO: propagate failure? to all clones? as status msg?
+    }
+    if (x.expiry)
+      remind(*x.expiry, key);
+    update_indexes(key, old_value ? &*old_value : nullptr, &value);
+    evictor.insert(key, et);
+    subnet_index_insert(key);
+    if (old_value)
+      emit_update_event(key, *old_value, value, x.expiry, x.publisher);
+    else
+      emit_insert_event(key, value, x.expiry, x.publisher);
+  }
+  broadcast_cmd_to_clones(std::move(x));
+  enforce_budget();
+}
+
+void master_state::operator()(multi_erase_command& x) {
+  BROKER_INFO("MULTI_ERASE with" << x.keys.size() << "keys");
+  for (auto& key : x.keys) {
+    if (!indexes.empty() || !derivations.empty())
+      if (auto old_value = backend->get(key))
+        update_indexes(key, &*old_value, nullptr);
+    if (auto res = backend->erase(key); !res) {
+      BROKER_WARNING("failed to erase" << key << "->" << res.error());
+      continue; // TODO: propagate failure? to all clones? as status msg?
+    }
+    evictor.erase(key);
+    subnet_index_erase(key);
+    emit_erase_event(key, x.publisher);
   }
+  broadcast_cmd_to_clones(std::move(x));
 }
 
 void master_state::operator()(snapshot_command& x) {
@@ -218,32 +639,86 @@ void master_state::operator()(snapshot_command& x) {
     BROKER_INFO("snapshot command with invalid address received");
     return;
   }
-  auto ss = backend->snapshot();
-  if (!ss)
-    detail::die("failed to snapshot master");
   auto hdl = native(x.remote_core);
   self->monitor(hdl);
   clones.emplace(hdl.address(), native(x.remote_clone));
+  resync_clone(native(x.remote_clone));
+}
 
+void master_state::resync_clone(const caf::actor& clone) {
   // The snapshot gets sent over a different channel than updates,
   // so we send a "sync" point over the update channel that target clone
   // can use in order to apply any updates that arrived before it
   // received the now-outdated snapshot.
-  broadcast_cmd_to_clones(snapshot_sync_command{x.remote_clone});
-
-  // TODO: possible improvements to do here
-  // (1) Use a separate *streaming* channel to send the snapshot.
-  //     A benefit of that would potentially be less latent queries
-  //     that go directly against the master store.
-  // (2) Always keep an updated snapshot in memory on the master to
-  //     avoid numerous expensive retrievals from persistent backends
-  //     in quick succession (e.g. at startup).
-  // (3) As an alternative to (2), give backends an API to stream
-  //     key-value pairs without ever needing the full snapshot in
-  //     memory.  Note that this would require halting the application
-  //     of updates on the master while there are any snapshot streams
-  //     still underway.
-  self->send(native(x.remote_clone), set_command{std::move(*ss)});
+  broadcast_cmd_to_clones(snapshot_sync_command{facade(clone)});
+
+  // Small stores ship as a single message; anything larger streams as a
+  // sequence of bounded chunks that interleave with command traffic, so the
+  // master never stalls on one giant send and the clone never has to
+  // materialize the full serialized state.
+  auto chunk_size = defaults::store::snapshot_chunk_size;
+  // With no other transfer in flight, fork the backend state instead of
+  // copying it: chunks then read from the frozen fork while writes continue
+  // against the live state.
+  if (snapshot_transfers.empty()) {
+    if (auto n = backend->snapshot_fork()) {
+      if (*n <= chunk_size) {
+        auto chunk = backend->snapshot_chunk(chunk_size);
+        if (!chunk)
+          detail::die("failed to read from a snapshot fork");
+        self->send(clone, set_command{std::move(*chunk)});
+      } else {
+        auto num_chunks = (*n + chunk_size - 1) / chunk_size;
+        snapshot_transfers.emplace_back(snapshot_transfer{
+          clone, {}, 0, num_chunks, true});
+        self->send(self, atom::snapshot_v, atom::write_v);
+      }
+      return;
+    }
+  }
+  auto ss = backend->snapshot();
+  if (!ss)
+    detail::die("failed to snapshot master");
+  if (ss->size() <= chunk_size) {
+    self->send(clone, set_command{std::move(*ss)});
+  } else {
+    auto num_chunks = (ss->size() + chunk_size - 1) / chunk_size;
+    snapshot_transfers.emplace_back(snapshot_transfer{
+      clone, std::move(*ss), 0, num_chunks});
+    self->send(self, atom::snapshot_v, atom::write_v);
+  }
+}
+
+void master_state::continue_snapshot_transfer() {
+  if (snapshot_transfers.empty())
+    return;
+  auto& transfer = snapshot_transfers.front();
+  broker::snapshot chunk;
+  if (transfer.from_fork) {
+    auto res = backend->snapshot_chunk(defaults::store::snapshot_chunk_size);
+    if (!res)
+      detail::die("failed to read from a snapshot fork");
+    chunk = std::move(*res);
+  } else {
+    auto n = std::min(defaults::store::snapshot_chunk_size,
+                      transfer.remaining.size());
+    chunk.reserve(n);
+    // Node extraction moves keys and values without copying them.
+    for (size_t i = 0; i < n; ++i)
+      chunk.insert(transfer.remaining.extract(transfer.remaining.begin()));
+  }
+  snapshot_chunk msg{transfer.seq++, transfer.num_chunks, {}};
+  detail::encode_snapshot(chunk, snapshot_compression, msg.bytes,
+                          transfer.dict, snapshot_preset);
+  self->send(transfer.clone, std::move(msg));
+  auto done = transfer.from_fork ? transfer.seq == transfer.num_chunks
+                                 : transfer.remaining.empty();
+  if (done)
+    snapshot_transfers.pop_front();
+  // Go through the mailbox again for the next chunk, allowing queued
+  // commands and queries to run in between.
+  if (!snapshot_transfers.empty())
+    self->send(self, atom::snapshot_v, atom::write_v);
 }
 
 void master_state::operator()(snapshot_sync_command&) {
@@ -272,9 +747,98 @@ void master_state::operator()(clear_command& x) {
   }
   if (auto res = backend->clear(); !res)
     detail::die("failed to clear master");
+  for (auto& index : indexes)
+    index.clear();
+  if (subnet_keys)
+    subnet_keys->clear();
+  evictor.clear();
+  // A derivation function cannot invert a wholesale clear, so it cascades to
+  // the derived stores.
+  for (auto& d : derivations)
+    self->send(d.target, atom::local_v,
+               make_internal_command<clear_command>(x.publisher));
   broadcast_cmd_to_clones(std::move(x));
 }
 
+void master_state::operator()(transaction_command& x) {
+  BROKER_INFO("TRANSACTION with" << x.ops.size() << "operations");
+  // The actor processes one command at a time, so applying all operations
+  // here without yielding is what makes the bundle atomic with respect to
+  // other writers. A failing operation is logged and skipped, consistent
+  // with the per-key behavior of the multi commands.
+  auto et = to_opt_timestamp(clock->now(), x.expiry);
+  using action_type = transaction_op::action_type;
+  for (auto& op : x.ops) {
+    switch (op.action) {
+      case action_type::put: {
+        auto old_value = backend->get(op.key);
+        if (auto res = backend->put(op.key, op.value, et); !res) {
+          BROKER_WARNING("failed to put" << op.key << "->" << op.value);
+          continue;
+        }
+        if (x.expiry)
+          remind(*x.expiry, op.key);
+        update_indexes(op.key, old_value ? &*old_value : nullptr, &op.value);
+        evictor.insert(op.key, et);
+        subnet_index_insert(op.key);
+        if (old_value)
+          emit_update_event(op.key, *old_value, op.value, x.expiry,
+                            x.publisher);
+        else
+          emit_insert_event(op.key, op.value, x.expiry, x.publisher);
+        break;
+      }
+      case action_type::erase: {
+        if (!indexes.empty() || !derivations.empty())
+          if (auto old_value = backend->get(op.key))
+            update_indexes(op.key, &*old_value, nullptr);
+        if (auto res = backend->erase(op.key); !res) {
+          BROKER_WARNING("failed to erase" << op.key << "->" << res.error());
+          continue;
+        }
+        evictor.erase(op.key);
+        subnet_index_erase(op.key);
+        emit_erase_event(op.key, x.publisher);
+        break;
+      }
+      case action_type::add:
+      case action_type::subtract: {
+        auto old_value = backend->get(op.key);
+        auto res = op.action == action_type::add
+                     ? backend->add(op.key, op.value, op.init_type, et)
+                     : backend->subtract(op.key, op.value, et);
+        if (!res) {
+          BROKER_WARNING("transaction op failed for" << op.key << "->"
+                                                     << res.error());
+          continue;
+        }
+        auto val = backend->get(op.key);
+        if (!val) {
+          BROKER_ERROR("failed to get" << op.key
+                                       << "after a successful transaction op:"
+                                       << val.error());
+          continue;
+        }
+        if (x.expiry)
+          remind(*x.expiry, op.key);
+        update_indexes(op.key, old_value ? &*old_value : nullptr, &*val);
+        evictor.insert(op.key, et);
+        subnet_index_insert(op.key);
+        if (old_value)
+          emit_update_event(op.key, *old_value, *val, x.expiry, x.publisher);
+        else
+          emit_insert_event(op.key, *val, x.expiry, x.publisher);
+        // Resolve to a plain put so clones need not repeat the computation.
+        op.action = action_type::put;
+        op.value = std::move(*val);
+        break;
+      }
+    }
+  }
+  broadcast_cmd_to_clones(std::move(x));
+  enforce_budget();
+}
+
 bool master_state::exists(const data& key) {
   if (auto res = backend->exists(key))
     return *res;
@@ -284,10 +848,11 @@ bool master_state::exists(const data& key) {
 caf::behavior master_actor(caf::stateful_actor<master_state>* self,
                            caf::actor core, std::string id,
                            master_state::backend_pointer backend,
-                           endpoint::clock* clock) {
+                           endpoint::clock* clock, detail::evictor evictor) {
   self->monitor(core);
   self->state.init(self, std::move(id), std::move(backend),
-                   std::move(core), clock);
+                   std::move(core), clock, std::move(evictor));
+  enroll_with_lag_watchdog(self);
   self->set_down_handler(
     [=](const caf::down_msg& msg) {
       if (msg.source == core) {
@@ -295,7 +860,20 @@ caf::behavior master_actor(caf::stateful_actor<master_state>* self,
         self->quit(msg.reason);
       } else {
         BROKER_INFO("lost a clone");
-        self->state.clones.erase(msg.source);
+        auto& st = self->state;
+        if (auto i = st.clones.find(msg.source); i != st.clones.end()) {
+          // Drop any snapshot transfer still in flight for this clone.
+          auto& transfers = st.snapshot_transfers;
+          auto is_gone = [&](const master_state::snapshot_transfer& x) {
+            return x.clone == i->second;
+          };
+          auto j = std::remove_if(transfers.begin(), transfers.end(), is_gone);
+          for (auto k = j; k != transfers.end(); ++k)
+            if (k->from_fork)
+              st.backend->snapshot_release();
+          transfers.erase(j, transfers.end());
+          st.clones.erase(i);
+        }
       }
     }
   );
@@ -308,12 +886,280 @@ caf::behavior master_actor(caf::stateful_actor<master_state>* self,
     [=](atom::sync_point, caf::actor& who) {
       self->send(who, atom::sync_point_v);
     },
+    [=](atom::snapshot, atom::write) {
+      self->state.continue_snapshot_transfer();
+    },
+    [=](atom::replay, uint64_t since, caf::actor& remote_core,
+        caf::actor& remote_clone) {
+      auto& st = self->state;
+      BROKER_INFO("REPLAY since" << since << "at" << st.command_seq);
+      auto& log = st.op_log;
+      auto covered = since == st.command_seq
+                     || (since < st.command_seq && !log.empty()
+                         && log.front().first <= since + 1);
+      if (!covered) {
+        // The clone fell too far behind (or talks to a restarted master), so
+        // it has to go through the full snapshot protocol instead.
+        self->send(remote_clone, atom::replay_v, atom::restart_v);
+        return;
+      }
+      self->monitor(remote_core);
+      st.clones.emplace(remote_core.address(), remote_clone);
+      // The sync command travels on the update channel and separates commands
+      // the replay already covers from commands the clone has to buffer until
+      // the replay completes.
+      st.broadcast_cmd_to_clones(snapshot_sync_command{facade(remote_clone)});
+      for (auto& [seq, cmd] : log)
+        if (seq > since)
+          self->send(remote_clone, atom::replay_v, cmd);
+      self->send(remote_clone, atom::replay_v, atom::ack_v);
+    },
     [=](atom::expire, data& key) { self->state.expire(key); },
+    [=](atom::tick, atom::expire) {
+      auto& st = self->state;
+      st.expiry_tick_pending = false;
+      std::vector<data> due;
+      st.expiry_wheel.advance(st.clock->now(), due);
+      // The backend ignores stale entries, i.e., keys that went away or got
+      // refreshed with a later expiry in the meantime.
+      for (auto& key : due)
+        st.expire(key);
+      st.schedule_expiry_tick();
+    },
+    [=](atom::tick, atom::flush) { self->state.flush_coalesced(); },
+    [=](atom::tick, atom::snapshot) {
+      // Scheduled after a mutation, or sent by a reader that just attached
+      // to the view and wants it up to date right away.
+      auto& st = self->state;
+      st.view_refresh_pending = false;
+      st.refresh_view();
+    },
+    [=](atom::tick, atom::status) {
+      self->state.refresh_stats();
+      self->state.schedule_stats_tick();
+    },
+    [=](atom::tick, atom::compact) {
+      self->state.maybe_compact();
+      self->state.schedule_compaction_tick();
+    },
+    [=](atom::store, atom::write, const std::string& path)
+      -> caf::result<atom::ok> {
+      BROKER_INFO("SAVE to" << path);
+      auto& st = self->state;
+      auto ss = st.backend->snapshot();
+      if (!ss)
+        return native(ss.error());
+      detail::store_file_writer writer;
+      if (auto res = writer.open(path); !res)
+        return native(res.error());
+      for (auto& [key, value] : *ss)
+        if (auto res = writer.write(key, value); !res)
+          return native(res.error());
+      if (auto res = writer.close(); !res)
+        return native(res.error());
+      return atom::ok_v;
+    },
+    [=](atom::store, atom::read, const std::string& path)
+      -> caf::result<atom::ok> {
+      BROKER_INFO("LOAD from" << path);
+      auto& st = self->state;
+      detail::store_file_reader reader;
+      if (auto res = reader.open(path); !res)
+        return native(res.error());
+      // Feed the backend in bounded batches, so the load never materializes
+      // the whole file in memory.
+      std::vector<std::pair<data, data>> batch;
+      batch.reserve(defaults::store::snapshot_chunk_size);
+      data key;
+      data value;
+      for (;;) {
+        auto more = reader.read(key, value);
+        if (!more)
+          return native(more.error());
+        if (*more) {
+          batch.emplace_back(std::move(key), std::move(value));
+          if (batch.size() < defaults::store::snapshot_chunk_size)
+            continue;
+        }
+        if (!batch.empty()) {
+          if (auto res = st.backend->bulk_insert(std::move(batch)); !res)
+            return native(res.error());
+          batch.clear();
+          batch.reserve(defaults::store::snapshot_chunk_size);
+        }
+        if (!*more)
+          break;
+      }
+      // Bulk-loaded entries never went through the op log, so a delta replay
+      // cannot cover them anymore. Advancing the sequence number past the
+      // (cleared) log forces reconnecting clones into the snapshot protocol,
+      // and attached clones get a fresh snapshot right away.
+      ++st.command_seq;
+      st.op_log.clear();
+      st.mark_view_dirty();
+      st.rebuild_indexes();
+      if (st.evictor.enabled()) {
+        st.evictor.clear();
+        if (auto ss = st.backend->snapshot())
+          for (auto& [k, v] : *ss)
+            st.evictor.insert(k);
+        st.enforce_budget();
+      }
+      for (auto& kvp : st.clones)
+        st.resync_clone(kvp.second);
+      return atom::ok_v;
+    },
+    [=](atom::index, const data& element) -> caf::result<atom::ok> {
+      BROKER_INFO("INDEX on" << element);
+      auto& st = self->state;
+      // Indexes either cover the whole value (nil) or one vector element
+      // (count).
+      std::optional<uint64_t> pos;
+      if (auto n = get_if<count>(element))
+        pos = *n;
+      else if (!is<none>(element)) {
+        auto err = caf::make_error(ec::invalid_data,
+                                   "index element must be a count or nil");
+        return err;
+      }
+      // Creating the same index twice is a no-op.
+      for (auto& index : st.indexes)
+        if (index.element() == pos)
+          return atom::ok_v;
+      auto ss = st.backend->snapshot();
+      if (!ss)
+        return native(ss.error());
+      auto& index = st.indexes.emplace_back(detail::secondary_index{pos});
+      index.rebuild(*ss);
+      return atom::ok_v;
+    },
+    [=](atom::derive, const caf::actor& target,
+        store_derivation& fn) -> caf::result<atom::ok> {
+      BROKER_INFO("DERIVE into" << to_string(target));
+      auto& st = self->state;
+      if (!fn) {
+        auto err = caf::make_error(ec::invalid_data,
+                                   "empty derivation function");
+        return err;
+      }
+      auto ss = st.backend->snapshot();
+      if (!ss)
+        return native(ss.error());
+      auto& d = st.derivations.emplace_back(
+        master_state::derivation{std::move(fn), target});
+      // Seed the derived store as if the derivation had watched every entry
+      // arrive; afterwards, mutations keep it current.
+      for (auto& [key, value] : *ss)
+        st.run_derivation(d, key, nullptr, &value);
+      return atom::ok_v;
+    },
+    [=](atom::get, atom::index, const data& value,
+        const data& element) -> caf::result<data> {
+      auto& st = self->state;
+      std::optional<uint64_t> pos;
+      if (auto n = get_if<count>(element))
+        pos = *n;
+      for (auto& index : st.indexes)
+        if (index.element() == pos) {
+          auto x = index.lookup(value);
+          BROKER_INFO("GET_INDEX" << value << "->" << x);
+          return {std::move(x)};
+        }
+      BROKER_INFO("GET_INDEX" << value << "-> no such index");
+      auto err = caf::make_error(ec::no_such_key, "no such index");
+      return err;
+    },
+    [=](atom::get, atom::subnet, const address& addr) -> caf::result<data> {
+      auto& st = self->state;
+      auto idx = st.lazy_subnet_index();
+      if (!idx)
+        return idx.error();
+      auto sn = (*idx)->lookup(addr);
+      if (!sn) {
+        BROKER_INFO("LPM" << addr << "-> no match");
+        auto err = caf::make_error(ec::no_such_key, "no covering subnet");
+        return err;
+      }
+      auto key = data{*sn};
+      auto val = st.backend->get(key);
+      if (!val)
+        return native(val.error());
+      BROKER_INFO("LPM" << addr << "->" << key);
+      return {data{vector{std::move(key), std::move(*val)}}};
+    },
+    [=](atom::get, atom::snapshot, uint64_t cursor, uint64_t max_n)
+      -> caf::result<data> {
+      auto& st = self->state;
+      if (max_n == 0)
+        max_n = defaults::store::snapshot_chunk_size;
+      auto i = st.scans.end();
+      if (cursor == 0) {
+        // Start a new scan. Forking pins the current state at key set
+        // granularity without copying any values; if another consumer holds
+        // the fork, fall back to an upfront copy.
+        master_state::scan_session session;
+        if (auto n = st.backend->snapshot_fork()) {
+          session.from_fork = true;
+          session.fork_left = *n;
+        } else {
+          auto ss = st.backend->snapshot();
+          if (!ss)
+            return native(ss.error());
+          session.remaining = std::move(*ss);
+        }
+        i = st.scans.emplace(++st.next_scan_id, std::move(session)).first;
+        BROKER_INFO("SCAN start with cursor" << i->first);
+      } else if (i = st.scans.find(cursor); i == st.scans.end()) {
+        auto err = caf::make_error(ec::no_such_key, "unknown scan cursor");
+        return err;
+      }
+      auto& session = i->second;
+      table page;
+      bool done = false;
+      if (session.from_fork) {
+        auto chunk = st.backend->snapshot_chunk(max_n);
+        if (!chunk) {
+          st.scans.erase(i);
+          return native(chunk.error());
+        }
+        for (auto& [key, value] : *chunk)
+          page.emplace(key, std::move(value));
+        session.fork_left -= page.size();
+        done = session.fork_left == 0;
+      } else {
+        auto n = std::min<size_t>(max_n, session.remaining.size());
+        for (size_t j = 0; j < n; ++j) {
+          auto node = session.remaining.extract(session.remaining.begin());
+          page.emplace(std::move(node.key()), std::move(node.mapped()));
+        }
+        done = session.remaining.empty();
+      }
+      auto next = done ? uint64_t{0} : i->first;
+      if (done)
+        st.scans.erase(i);
+      return {data{vector{data{next}, data{std::move(page)}}}};
+    },
     [=](atom::get, atom::keys) -> caf::result<data> {
       auto x = self->state.backend->keys();
       BROKER_INFO("KEYS ->" << x);
       return to_caf_res(std::move(x));
     },
+    [=](atom::get, atom::keys, const data& from, const data& to,
+        uint64_t limit) -> caf::result<data> {
+      auto x = self->state.backend->keys_in_range(from, to, limit);
+      BROKER_INFO("KEYS_IN_RANGE" << from << "->" << to << "limit" << limit);
+      return to_caf_res(std::move(x));
+    },
+    [=](atom::get, atom::keys, const data& from, const data& to,
+        uint64_t limit, request_id id) {
+      auto x = self->state.backend->keys_in_range(from, to, limit);
+      BROKER_INFO("KEYS_IN_RANGE" << from << "->" << to << "limit" << limit
+                                  << "with id:" << id);
+      if (x)
+        return caf::make_message(std::move(*x), id);
+      else
+        return caf::make_message(native(std::move(x.error())), id);
+    },
     [=](atom::get, atom::keys, request_id id) {
       auto x = self->state.backend->keys();
       BROKER_INFO("KEYS" << "with id:" << id << "->" << x);
@@ -334,9 +1180,33 @@ caf::behavior master_actor(caf::stateful_actor<master_state>* self,
     },
     [=](atom::get, const data& key) -> caf::result<data> {
       auto x = self->state.backend->get(key);
+      self->state.evictor.touch(key);
       BROKER_INFO("GET" << key << "->" << x);
       return to_caf_res(std::move(x));
     },
+    [=](atom::get, const vector& keys) -> caf::result<data> {
+      vector xs;
+      xs.reserve(keys.size());
+      // Missing keys yield nil, so the result aligns with the request.
+      for (auto& key : keys)
+        if (auto x = self->state.backend->get(key))
+          xs.emplace_back(std::move(*x));
+        else
+          xs.emplace_back(data{});
+      BROKER_INFO("MULTI_GET with" << keys.size() << "keys");
+      return {data{std::move(xs)}};
+    },
+    [=](atom::get, const vector& keys, request_id id) {
+      vector xs;
+      xs.reserve(keys.size());
+      for (auto& key : keys)
+        if (auto x = self->state.backend->get(key))
+          xs.emplace_back(std::move(*x));
+        else
+          xs.emplace_back(data{});
+      BROKER_INFO("MULTI_GET with" << keys.size() << "keys and id:" << id);
+      return caf::make_message(data{std::move(xs)}, id);
+    },
     [=](atom::get, const data& key, const data& aspect) -> caf::result<data> {
       auto x = self->state.backend->get(key, aspect);
       BROKER_INFO("GET" << key << aspect << "->" << x);
@@ -344,6 +1214,7 @@ caf::behavior master_actor(caf::stateful_actor<master_state>* self,
     },
     [=](atom::get, const data& key, request_id id) {
       auto x = self->state.backend->get(key);
+      self->state.evictor.touch(key);
       BROKER_INFO("GET" << key << "with id:" << id << "->" << x);
       if (x)
         return caf::make_message(std::move(*x), id);
@@ -359,6 +1230,10 @@ caf::behavior master_actor(caf::stateful_actor<master_state>* self,
         return caf::make_message(native(x.error()), id);
     },
     [=](atom::get, atom::name) { return self->state.id; },
+    // --- scheduler-lag probes from the watchdog ------------------------------
+    [=](atom::ping, timestamp sent) {
+      record_scheduler_lag(self->system(), "master/" + self->state.id, sent);
+    },
     // --- stream handshake with core ------------------------------------------
     [=](caf::stream<command_message>& in) {
       BROKER_DEBUG("received stream handshake from core");
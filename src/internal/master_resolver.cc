@@ -7,40 +7,84 @@
 #include <caf/actor.hpp>
 #include <caf/behavior.hpp>
 #include <caf/event_based_actor.hpp>
+#include <caf/result.hpp>
 #include <caf/stateful_actor.hpp>
 
+#include "broker/defaults.hh"
 #include "broker/error.hh"
 #include "broker/internal/logger.hh"
 #include "broker/internal/type_id.hh"
 
 namespace broker::internal {
 
+namespace {
+
+void fan_out(master_resolver_actor* self);
+
+/// Asks one peer for the master. All queries run concurrently; the first
+/// positive answer wins. Peers that fail or stay silent past the timeout
+/// count as a negative response, so a dead peer can never hang the
+/// resolution.
+void query_peer(master_resolver_actor* self, caf::actor peer, bool is_hint) {
+  auto& st = self->state;
+  ++st.remaining_responses;
+  self
+    ->request(peer, defaults::store::resolve_timeout, atom::store_v,
+              atom::master_v, atom::get_v, st.name)
+    .then(
+      [=](caf::actor& master) {
+        auto& st = self->state;
+        if (st.rp.pending()) {
+          BROKER_DEBUG("resolver found master:" << master);
+          st.rp.deliver(std::move(master), std::move(peer));
+          self->quit();
+        }
+      },
+      [=](caf::error&) {
+        auto& st = self->state;
+        if (--st.remaining_responses > 0 || !st.rp.pending())
+          return;
+        if (is_hint && !st.peers.empty()) {
+          // The preferred peer came up empty; now ask everyone else at once.
+          fan_out(self);
+          return;
+        }
+        BROKER_DEBUG("resolver failed to find a master for" << st.name);
+        st.rp.deliver(caf::make_error(ec::no_such_master,
+                                      "no master on peers"));
+        self->quit();
+      });
+}
+
+void fan_out(master_resolver_actor* self) {
+  auto peers = std::move(self->state.peers);
+  for (auto& peer : peers)
+    query_peer(self, std::move(peer), false);
+}
+
+} // namespace
+
 caf::behavior master_resolver(master_resolver_actor* self) {
-  self->set_error_handler([=](caf::error&) {
-    if (--self->state.remaining_responses == 0) {
-      BROKER_DEBUG("resolver failed to find a master");
-      self->send(self->state.who_asked, atom::master_v,
-                 caf::make_error(ec::no_such_master, "no master on peers"));
-      self->quit();
-    }
-  });
   return {
-    [=](const std::vector<caf::actor>& peers, const std::string& name,
-        caf::actor& who_asked) {
-      BROKER_DEBUG("resolver starts looking for:" << name);
-      for (auto& peer : peers)
-        self->send(peer, atom::store_v, atom::master_v,
-                   atom::get_v, name);
-
-      self->state.remaining_responses = peers.size();
-      self->state.who_asked = std::move(who_asked);
+    [=](std::vector<caf::actor>& peers, std::string& name, caf::actor& hint)
+      -> caf::result<caf::actor, caf::actor> {
+      auto& st = self->state;
+      st.name = std::move(name);
+      st.rp = self->make_response_promise<caf::actor, caf::actor>();
+      BROKER_DEBUG("resolver starts looking for:" << st.name);
+      if (hint) {
+        // Give the preferred peer an exclusive first shot: when the hint is
+        // right, resolution takes one round trip and nobody else gets asked.
+        for (auto& peer : peers)
+          if (peer != hint)
+            st.peers.push_back(std::move(peer));
+        query_peer(self, std::move(hint), true);
+      } else {
+        for (auto& peer : peers)
+          query_peer(self, std::move(peer), false);
+      }
+      return st.rp;
     },
-    [=](caf::actor& master) {
-      BROKER_DEBUG("resolver found master:" << master);
-      self->send(self->state.who_asked, atom::master_v,
-                 std::move(master));
-      self->quit();
-    }
   };
 }
 
@@ -59,6 +59,18 @@ caf::error meta_command_writer::operator()(const subtract_command& x) {
   return caf::none;
 }
 
+caf::error meta_command_writer::operator()(const multi_put_command& x) {
+  BROKER_TRY(apply_tag(internal_command_uint_tag<multi_put_command>()),
+             writer_.apply_container(x.entries));
+  return caf::none;
+}
+
+caf::error meta_command_writer::operator()(const multi_erase_command& x) {
+  BROKER_TRY(apply_tag(internal_command_uint_tag<multi_erase_command>()),
+             writer_.apply_container(x.keys));
+  return caf::none;
+}
+
 caf::error meta_command_writer::operator()(const snapshot_command& x) {
   return apply_tag(internal_command_uint_tag<snapshot_command>());
 }
@@ -77,6 +89,17 @@ caf::error meta_command_writer::operator()(const clear_command& x) {
   return apply_tag(internal_command_uint_tag<clear_command>());
 }
 
+caf::error meta_command_writer::operator()(const transaction_command& x) {
+  BROKER_TRY(apply_tag(internal_command_uint_tag<transaction_command>()));
+  auto size = static_cast<uint32_t>(x.ops.size());
+  if (!writer_.sink().value(size))
+    return writer_.sink().get_error();
+  for (auto& op : x.ops)
+    BROKER_TRY(apply_tag(static_cast<uint8_t>(op.action)), writer_(op.key),
+               writer_(op.value), apply_tag(static_cast<uint8_t>(op.init_type)));
+  return caf::none;
+}
+
 caf::error meta_command_writer::apply_tag(uint8_t tag) {
   auto& sink = writer_.sink();
   if (sink.value(tag))
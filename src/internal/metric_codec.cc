@@ -0,0 +1,234 @@
+#include "broker/internal/metric_codec.hh"
+
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "broker/detail/data_codec.hh"
+#include "broker/detail/flat_map.hh"
+#include "broker/error.hh"
+#include "broker/internal/metric_view.hh"
+
+namespace broker::internal {
+
+namespace {
+
+/// Magic bytes plus format version, prefixed to every blob.
+constexpr char magic[] = {'B', 'K', 'M', '\x01'};
+
+constexpr size_t magic_size = sizeof(magic);
+
+/// One dictionary entry: the parts of a metric family that remain constant
+/// across instances and scrape intervals.
+struct family_entry {
+  std::string prefix;
+  std::string name;
+  std::string type;
+  std::string unit;
+  std::string helptext;
+  bool is_sum = false;
+  std::vector<std::string> label_names;
+};
+
+void put_str(std::string_view str, std::vector<std::byte>& buf) {
+  detail::encode_varint(str.size(), buf);
+  auto first = reinterpret_cast<const std::byte*>(str.data());
+  buf.insert(buf.end(), first, first + str.size());
+}
+
+// Values and the meta data row piggyback on the regular data codec, wrapped
+// into a varint length prefix since `detail::decode` reports no consumed
+// byte count.
+void put_data(const data& x, std::vector<std::byte>& buf) {
+  auto bytes = detail::encode(x);
+  detail::encode_varint(bytes.size(), buf);
+  buf.insert(buf.end(), bytes.begin(), bytes.end());
+}
+
+/// Bounds-checked cursor over the blob bytes for decoding.
+struct reader {
+  const std::byte* pos;
+  size_t left;
+
+  bool get_varint(uint64_t& x) {
+    auto n = detail::decode_varint(pos, left, x);
+    if (n == 0)
+      return false;
+    pos += n;
+    left -= n;
+    return true;
+  }
+
+  bool get_byte(std::byte& x) {
+    if (left == 0)
+      return false;
+    x = *pos++;
+    --left;
+    return true;
+  }
+
+  bool get_str(std::string& str) {
+    uint64_t n = 0;
+    if (!get_varint(n) || n > left)
+      return false;
+    str.assign(reinterpret_cast<const char*>(pos), n);
+    pos += n;
+    left -= n;
+    return true;
+  }
+
+  bool get_data(data& x) {
+    uint64_t n = 0;
+    if (!get_varint(n) || n > left)
+      return false;
+    if (auto res = detail::decode(pos, n)) {
+      x = std::move(*res);
+      pos += n;
+      left -= n;
+      return true;
+    }
+    return false;
+  }
+};
+
+} // namespace
+
+std::string encode_metric_rows(const vector& rows) {
+  std::vector<std::byte> buf;
+  buf.reserve(rows.size() * 32);
+  auto m = reinterpret_cast<const std::byte*>(magic);
+  buf.insert(buf.end(), m, m + magic_size);
+  // The meta data row (endpoint name and timestamp) travels as-is.
+  put_data(rows.empty() ? data{} : rows[0], buf);
+  // First pass: assign a dictionary slot to each distinct family. The label
+  // names come from a `broker::table`, i.e., both the dictionary and the
+  // per-row values observe the same sorted key order.
+  std::vector<family_entry> families;
+  detail::flat_map<std::string, uint64_t> family_ids;
+  std::vector<std::pair<uint64_t, metric_view>> instances;
+  for (size_t i = 1; i < rows.size(); ++i) {
+    metric_view mv{rows[i]};
+    if (!mv)
+      continue;
+    std::string key = mv.prefix();
+    key += '\0';
+    key += mv.name();
+    for (const auto& [lbl_name, lbl_val] : mv.labels()) {
+      key += '\0';
+      key += get<std::string>(lbl_name);
+    }
+    auto [iter, added] = family_ids.emplace(std::move(key), families.size());
+    if (added) {
+      family_entry entry{mv.prefix(),   mv.name(),   mv.type_str(),
+                         mv.unit(),     mv.helptext(), mv.is_sum(),
+                         {}};
+      for (const auto& [lbl_name, lbl_val] : mv.labels())
+        entry.label_names.emplace_back(get<std::string>(lbl_name));
+      families.emplace_back(std::move(entry));
+    }
+    instances.emplace_back(iter->second, mv);
+  }
+  // Second pass: dictionary first, then the packed rows.
+  detail::encode_varint(families.size(), buf);
+  for (const auto& entry : families) {
+    put_str(entry.prefix, buf);
+    put_str(entry.name, buf);
+    put_str(entry.type, buf);
+    put_str(entry.unit, buf);
+    put_str(entry.helptext, buf);
+    buf.emplace_back(static_cast<std::byte>(entry.is_sum ? 1 : 0));
+    detail::encode_varint(entry.label_names.size(), buf);
+    for (const auto& lbl_name : entry.label_names)
+      put_str(lbl_name, buf);
+  }
+  detail::encode_varint(instances.size(), buf);
+  for (const auto& [family_id, mv] : instances) {
+    detail::encode_varint(family_id, buf);
+    for (const auto& [lbl_name, lbl_val] : mv.labels())
+      put_str(get<std::string>(lbl_val), buf);
+    put_data(mv.value(), buf);
+  }
+  return std::string{reinterpret_cast<const char*>(buf.data()), buf.size()};
+}
+
+bool is_metric_blob(const data& content) {
+  auto str = get_if<std::string>(content);
+  return str != nullptr && str->size() >= magic_size
+         && memcmp(str->data(), magic, magic_size) == 0;
+}
+
+expected<vector> decode_metric_rows(const std::string& blob) {
+  auto fail = [] {
+    return expected<vector>{
+      make_error(ec::invalid_data, "malformed metrics blob")};
+  };
+  if (blob.size() < magic_size || memcmp(blob.data(), magic, magic_size) != 0)
+    return fail();
+  reader in{reinterpret_cast<const std::byte*>(blob.data()) + magic_size,
+            blob.size() - magic_size};
+  vector rows;
+  data meta;
+  if (!in.get_data(meta))
+    return fail();
+  rows.emplace_back(std::move(meta));
+  uint64_t num_families = 0;
+  if (!in.get_varint(num_families) || num_families > in.left)
+    return fail();
+  std::vector<family_entry> families;
+  families.reserve(num_families);
+  for (uint64_t i = 0; i < num_families; ++i) {
+    family_entry entry;
+    std::byte is_sum{};
+    uint64_t num_labels = 0;
+    if (!in.get_str(entry.prefix) || !in.get_str(entry.name)
+        || !in.get_str(entry.type) || !in.get_str(entry.unit)
+        || !in.get_str(entry.helptext) || !in.get_byte(is_sum)
+        || !in.get_varint(num_labels) || num_labels > in.left)
+      return fail();
+    entry.is_sum = is_sum != std::byte{0};
+    for (uint64_t j = 0; j < num_labels; ++j) {
+      std::string lbl_name;
+      if (!in.get_str(lbl_name))
+        return fail();
+      entry.label_names.emplace_back(std::move(lbl_name));
+    }
+    families.emplace_back(std::move(entry));
+  }
+  uint64_t num_rows = 0;
+  if (!in.get_varint(num_rows) || num_rows > in.left)
+    return fail();
+  rows.reserve(num_rows + 1);
+  for (uint64_t i = 0; i < num_rows; ++i) {
+    uint64_t family_id = 0;
+    if (!in.get_varint(family_id) || family_id >= families.size())
+      return fail();
+    const auto& entry = families[family_id];
+    vector row;
+    row.reserve(metric_view::row_size);
+    row.emplace_back(entry.prefix);
+    row.emplace_back(entry.name);
+    row.emplace_back(entry.type);
+    row.emplace_back(entry.unit);
+    row.emplace_back(entry.helptext);
+    row.emplace_back(entry.is_sum);
+    table labels;
+    for (const auto& lbl_name : entry.label_names) {
+      std::string lbl_val;
+      if (!in.get_str(lbl_val))
+        return fail();
+      labels.emplace(lbl_name, std::move(lbl_val));
+    }
+    row.emplace_back(std::move(labels));
+    data value;
+    if (!in.get_data(value))
+      return fail();
+    row.emplace_back(std::move(value));
+    rows.emplace_back(std::move(row));
+  }
+  if (in.left != 0)
+    return fail();
+  return {std::move(rows)};
+}
+
+} // namespace broker::internal
@@ -1,6 +1,7 @@
 #include "broker/internal/metric_collector.hh"
 
 #include "broker/internal/logger.hh"
+#include "broker/internal/metric_codec.hh"
 
 namespace ct = caf::telemetry;
 
@@ -19,11 +20,15 @@ public:
 
   using super::super;
 
-  void update(metric_view mv) override {
+  bool update(metric_view mv) override {
     if (mv.type() == type_tag) {
-      value_ = get<T>(mv.value());
+      auto val = get<T>(mv.value());
+      auto changed = val != value_;
+      value_ = val;
+      return changed;
     } else {
       BROKER_ERROR("conflicting remote metric update received!");
+      return false;
     }
   }
 
@@ -46,11 +51,15 @@ public:
 
   using super::super;
 
-  void update(metric_view mv) override {
+  bool update(metric_view mv) override {
     if (mv.type() == type_tag) {
-      value_ = get<T>(mv.value());
+      auto val = get<T>(mv.value());
+      auto changed = val != value_;
+      value_ = val;
+      return changed;
     } else {
       BROKER_ERROR("conflicting remote metric update received!");
+      return false;
     }
   }
 
@@ -75,18 +84,27 @@ public:
 
   using native_bucket = typename ct::histogram<T>::bucket_type;
 
-  void update(metric_view mv) override {
+  bool update(metric_view mv) override {
     if (mv.type() == type_tag) {
       auto& vals = get<vector>(mv.value());
       BROKER_ASSERT(vals.size() >= 2);
-      buckets_.clear();
-      std::for_each(vals.begin(), vals.end() - 1, [this](const auto& kvp_data) {
-        auto& kvp = get<vector>(kvp_data);
-        buckets_.emplace_back(get<T>(kvp[0]), get<integer>(kvp[1]));
-      });
-      sum_ = get<T>(vals.back());
+      std::vector<std::pair<T, int64_t>> buckets;
+      buckets.reserve(vals.size() - 1);
+      std::for_each(vals.begin(), vals.end() - 1,
+                    [&buckets](const auto& kvp_data) {
+                      auto& kvp = get<vector>(kvp_data);
+                      buckets.emplace_back(get<T>(kvp[0]),
+                                           get<integer>(kvp[1]));
+                    });
+      auto sum = get<T>(vals.back());
+      if (buckets == buckets_ && sum == sum_)
+        return false;
+      buckets_ = std::move(buckets);
+      sum_ = sum;
+      return true;
     } else {
       BROKER_ERROR("conflicting remote metric update received!");
+      return false;
     }
   }
 
@@ -141,8 +159,12 @@ metric_collector::~metric_collector() {
 size_t metric_collector::insert_or_update(const data& content) {
   if (auto vec = get_if<vector>(content))
     return insert_or_update(*vec);
-  else
-    return 0;
+  if (is_metric_blob(content)) {
+    if (auto rows = decode_metric_rows(get<std::string>(content)))
+      return insert_or_update(*rows);
+    BROKER_ERROR("received a malformed binary metrics blob");
+  }
+  return 0;
 }
 
 size_t metric_collector::insert_or_update(const vector& vec) {
@@ -170,24 +192,42 @@ size_t metric_collector::insert_or_update(const std::string& endpoint_name,
   auto res = size_t{0};
   if (advance_time(endpoint_name, ts))
     for (const auto& row_data : rows)
-      if (auto mv = metric_view{row_data})
-        if (auto ptr = instance(endpoint_name, mv)) {
-          ptr->update(mv);
+      if (auto mv = metric_view{row_data}) {
+        auto& scope = scope_of(mv);
+        if (auto ptr = instance(scope, endpoint_name, mv)) {
+          if (ptr->update(mv))
+            ++scope.generation;
           ++res;
         }
+      }
   return res;
 }
 
 std::string_view metric_collector::prometheus_text() {
-  if (generator_.begin_scrape()) {
+  auto dirty = false;
+  for (auto& [prefix, names] : prefixes_) {
+    for (auto& [name, scope] : names) {
+      if (scope.rendered_generation == scope.generation)
+        continue;
+      generator_.reset();
+      if (!generator_.begin_scrape())
+        continue; // Serve the previous rendering of this family for now.
+      for (auto& instance : scope.instances)
+        instance->append_to(generator_);
+      generator_.end_scrape();
+      auto res = generator_.str();
+      scope.rendered.assign(res.data(), res.size());
+      scope.rendered_generation = scope.generation;
+      dirty = true;
+    }
+  }
+  if (dirty) {
+    text_.clear();
     for (auto& [prefix, names] : prefixes_)
       for (auto& [name, scope] : names)
-        for (auto& instance : scope.instances)
-          instance->append_to(generator_);
-    generator_.end_scrape();
+        text_ += scope.rendered;
   }
-  auto res = generator_.str();
-  return {res.data(), res.size()};
+  return text_;
 }
 
 void metric_collector::clear() {
@@ -196,6 +236,7 @@ void metric_collector::clear() {
   prefixes_.clear();
   last_seen_.clear();
   generator_.reset();
+  text_.clear();
 }
 
 // -- time management ----------------------------------------------------------
@@ -269,10 +310,13 @@ auto owned(metric_collector::label_span xs) {
 
 } // namespace
 
+metric_collector::metric_scope& metric_collector::scope_of(metric_view mv) {
+  return prefixes_[mv.prefix()][mv.name()];
+}
+
 metric_collector::remote_metric*
-metric_collector::instance(const std::string& endpoint_name, metric_view mv) {
-  auto& names = prefixes_[mv.prefix()];
-  auto& scope = names[mv.name()];
+metric_collector::instance(metric_scope& scope,
+                           const std::string& endpoint_name, metric_view mv) {
   if (scope.family == nullptr) {
     auto ptr = new ct::metric_family(mv.type(), mv.prefix(), mv.name(),
                                      owned(label_names_for(mv)), mv.helptext(),
@@ -316,6 +360,7 @@ metric_collector::instance(const std::string& endpoint_name, metric_view mv) {
         return nullptr;
     }
     scope.instances.emplace_back(std::move(new_instance));
+    ++scope.generation;
     return scope.instances.back().get();
   }
 }
@@ -28,6 +28,10 @@ metric_exporter_params::from(const caf::actor_system_config& cfg) {
       = caf::get_or(*dict, "interval", defaults::metrics::export_interval);
     if (result.interval.count() == 0)
       result.interval = defaults::metrics::export_interval;
+    result.binary = caf::get_or(*dict, "binary", false);
+    result.full_sync_interval
+      = caf::get_or(*dict, "full-sync-interval",
+                    defaults::metrics::full_sync_interval);
   }
   return result;
 }
@@ -12,6 +12,8 @@
 #include "broker/detail/next_tick.hh"
 #include "broker/internal/logger.hh"
 #include "broker/message.hh"
+#include "broker/telemetry/log_histogram.hh"
+#include "broker/telemetry/shards.hh"
 
 namespace ct = caf::telemetry;
 
@@ -74,6 +76,8 @@ bool metric_scraper::selected(const ct::metric_family* family) {
 }
 
 void metric_scraper::scrape(caf::telemetry::metric_registry& registry) {
+  // Aggregate the per-thread metric cells before reading the registry.
+  telemetry::shards::flush();
   last_scrape_ = now();
   if (!rows_.empty()) {
     rows_.resize(1);
@@ -91,6 +95,32 @@ void metric_scraper::scrape(caf::telemetry::metric_registry& registry) {
   }
   BROKER_ASSERT(rows_.size() == 1);
   registry.collect(*this);
+  add_log_histograms();
+}
+
+void metric_scraper::add_log_histograms() {
+  auto matches = [this](const auto& hist) {
+    auto eq = [&hist](const auto& prefix) { return hist.prefix() == prefix; };
+    return selected_prefixes_.empty()
+           || std::any_of(selected_prefixes_.begin(), selected_prefixes_.end(),
+                          eq);
+  };
+  for (auto& hist : telemetry::log_histograms()) {
+    if (!matches(hist))
+      continue;
+    vector packed;
+    packed.reserve(hist.num_buckets() + 1); // +1 for the trailing sum
+    for (size_t index = 0; index < hist.num_buckets(); ++index) {
+      vector packed_bucket;
+      packed_bucket.reserve(2);
+      packed_bucket.emplace_back(hist.upper_bound_at(index));
+      packed_bucket.emplace_back(hist.count_at(index));
+      packed.emplace_back(std::move(packed_bucket));
+    }
+    packed.emplace_back(hist.sum());
+    add_row(hist.prefix(), hist.name(), "histogram", hist.unit(),
+            hist.helptext(), false, table{}, std::move(packed));
+  }
 }
 
 void metric_scraper::id(std::string new_id) {
@@ -145,14 +175,27 @@ void metric_scraper::operator()(const ct::metric_family* family,
 template <class T>
 void metric_scraper::add_row(const caf::telemetry::metric_family* family,
                              std::string type, table labels, T value) {
+  add_row(family->prefix(), family->name(), std::move(type), family->unit(),
+          family->helptext(), family->is_sum(), std::move(labels),
+          std::move(value));
+}
+
+template <class T>
+void metric_scraper::add_row(std::string_view prefix, std::string_view name,
+                             std::string type, std::string_view unit,
+                             std::string_view helptext, bool is_sum,
+                             table labels, T value) {
+  auto str = [](auto str_view) {
+    return std::string{str_view.begin(), str_view.end()};
+  };
   vector row;
   row.reserve(8);
-  row.emplace_back(family->prefix());
-  row.emplace_back(family->name());
+  row.emplace_back(str(prefix));
+  row.emplace_back(str(name));
   row.emplace_back(std::move(type));
-  row.emplace_back(family->unit());
-  row.emplace_back(family->helptext());
-  row.emplace_back(family->is_sum());
+  row.emplace_back(str(unit));
+  row.emplace_back(str(helptext));
+  row.emplace_back(is_sum);
   row.emplace_back(std::move(labels));
   row.emplace_back(std::move(value));
   rows_.emplace_back(std::move(row));
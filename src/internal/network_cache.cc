@@ -1,9 +1,42 @@
 #include "broker/internal/network_cache.hh"
 
+#include "broker/config.hh"
+
+#ifdef BROKER_WINDOWS
+#  include <ws2tcpip.h>
+#else
+#  include <arpa/inet.h>
+#endif
+
+#include <caf/telemetry/counter.hpp>
+#include <caf/telemetry/histogram.hpp>
+#include <caf/telemetry/metric_registry.hpp>
+
+#include "broker/internal/dns_resolver.hh"
 #include "broker/internal/logger.hh"
 
 namespace broker::internal {
 
+namespace {
+
+/// Default lifetime for cached hostname lookups. The system resolver does not
+/// expose record TTLs, so the cache uses a configurable lifetime instead
+/// ("broker.dns.ttl").
+constexpr caf::timespan default_dns_ttl = std::chrono::seconds(60);
+
+/// Default lifetime for cached lookup failures ("broker.dns.negative-ttl").
+/// Kept short so a recovered resolver gets picked up quickly.
+constexpr caf::timespan default_dns_negative_ttl = std::chrono::seconds(5);
+
+/// Upper bounds in seconds for the connect duration histograms. A plain TCP
+/// connect usually lands in the low milliseconds, a full TLS handshake adds
+/// round trips and asymmetric crypto on top.
+constexpr double connect_duration_bounds[] = {
+  0.001, 0.01, 0.1, 1.0, 10.0,
+};
+
+} // namespace
+
 network_cache::network_cache(caf::event_based_actor* selfptr) : self(selfptr) {
   // nop
 }
@@ -20,6 +53,73 @@ caf::result<caf::actor> network_cache::fetch(const network_info& x) {
   return rp;
 }
 
+void network_cache::observe_connect(double seconds) {
+  if (connect_duration_ == nullptr) {
+    auto& reg = self->home_system().metrics();
+    connect_duration_
+      = reg
+          .histogram_family<double>("broker", "connect-duration",
+                                    {"transport"}, connect_duration_bounds,
+                                    "Time between initiating a connection to "
+                                    "a remote endpoint and completing the "
+                                    "transport handshake.",
+                                    "seconds")
+          ->get_or_add({{"transport", use_ssl ? "ssl" : "tcp"}});
+  }
+  connect_duration_->observe(seconds);
+}
+
+void network_cache::count_connect_failure() {
+  if (connect_failures_ == nullptr) {
+    auto& reg = self->home_system().metrics();
+    connect_failures_
+      = reg
+          .counter_family("broker", "connect-failures", {"transport"},
+                          "Number of connection attempts to remote endpoints "
+                          "that failed.",
+                          "1", true)
+          ->get_or_add({{"transport", use_ssl ? "ssl" : "tcp"}});
+  }
+  connect_failures_->inc();
+}
+
+bool network_cache::is_ip_literal(const std::string& address) {
+  in_addr v4;
+  if (inet_pton(AF_INET, address.c_str(), &v4) == 1)
+    return true;
+  in6_addr v6;
+  return inet_pton(AF_INET6, address.c_str(), &v6) == 1;
+}
+
+const network_cache::dns_entry*
+network_cache::dns_lookup(const std::string& host) {
+  auto i = dns_cache_.find(host);
+  if (i == dns_cache_.end())
+    return nullptr;
+  if (std::chrono::steady_clock::now() >= i->second.expiry) {
+    dns_cache_.erase(i);
+    return nullptr;
+  }
+  return &i->second;
+}
+
+void network_cache::dns_store(const std::string& host, std::string address) {
+  auto& cfg = self->home_system().config();
+  auto ttl = address.empty()
+               ? caf::get_or(cfg, "broker.dns.negative-ttl",
+                             default_dns_negative_ttl)
+               : caf::get_or(cfg, "broker.dns.ttl", default_dns_ttl);
+  auto expiry = std::chrono::steady_clock::now() + ttl;
+  dns_cache_[host] = dns_entry{std::move(address), expiry};
+}
+
+caf::actor& network_cache::resolver() {
+  if (!resolver_)
+    resolver_ = self->spawn<caf::detached + caf::linked + caf::lazy_init>(
+      dns_resolver);
+  return resolver_;
+}
+
 caf::optional<caf::actor> network_cache::find(const network_info& x) {
   auto i = hdls_.find(x);
   if (i != hdls_.end())
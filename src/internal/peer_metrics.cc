@@ -0,0 +1,194 @@
+#include "broker/internal/peer_metrics.hh"
+
+#include <caf/telemetry/counter.hpp>
+#include <caf/telemetry/histogram.hpp>
+#include <caf/telemetry/metric_registry.hpp>
+
+#include "broker/data.hh"
+#include "broker/topic.hh"
+
+namespace broker::internal {
+
+namespace {
+
+/// Upper bounds in seconds for the queue time histograms. Outbound buffering
+/// usually resolves within the flush interval, hence the focus on the
+/// sub-second range.
+constexpr double queue_time_bounds[] = {
+  0.00001, 0.0001, 0.001, 0.01, 0.1, 1.0,
+};
+
+/// Upper bounds in seconds for the handshake RTT histograms.
+constexpr double rtt_bounds[] = {
+  0.001, 0.01, 0.1, 1.0, 10.0,
+};
+
+/// Assumed per-value framing overhead (type tag plus length) in bytes.
+constexpr size_t framing_overhead = 2;
+
+size_t estimated_size(const data& x) noexcept;
+
+struct wire_size_visitor {
+  size_t operator()(none) noexcept {
+    return framing_overhead;
+  }
+
+  size_t operator()(const std::string& x) noexcept {
+    return framing_overhead + x.size();
+  }
+
+  size_t operator()(const enum_value& x) noexcept {
+    return framing_overhead + x.name.size();
+  }
+
+  size_t operator()(const vector& xs) noexcept {
+    auto result = framing_overhead;
+    for (const auto& x : xs)
+      result += estimated_size(x);
+    return result;
+  }
+
+  size_t operator()(const set& xs) noexcept {
+    auto result = framing_overhead;
+    for (const auto& x : xs)
+      result += estimated_size(x);
+    return result;
+  }
+
+  size_t operator()(const table& xs) noexcept {
+    auto result = framing_overhead;
+    for (const auto& [key, val] : xs)
+      result += estimated_size(key) + estimated_size(val);
+    return result;
+  }
+
+  template <class T>
+  size_t operator()(const T&) noexcept {
+    return framing_overhead + sizeof(T);
+  }
+};
+
+size_t estimated_size(const data& x) noexcept {
+  return visit(wire_size_visitor{}, x);
+}
+
+} // namespace
+
+peer_metrics::peer_metrics(caf::telemetry::metric_registry& reg,
+                           const std::string& peer_id) {
+  messages_in_
+    = reg
+        .counter_family("broker", "peer-messages-in", {"peer"},
+                        "Number of messages received from the peer.", "1",
+                        true)
+        ->get_or_add({{"peer", peer_id}});
+  messages_out_
+    = reg
+        .counter_family("broker", "peer-messages-out", {"peer"},
+                        "Number of messages shipped to the peer.", "1", true)
+        ->get_or_add({{"peer", peer_id}});
+  bytes_in_ = reg
+                .counter_family("broker", "peer-bytes-in", {"peer"},
+                                "Estimated payload volume received from the "
+                                "peer.",
+                                "bytes", true)
+                ->get_or_add({{"peer", peer_id}});
+  bytes_out_ = reg
+                 .counter_family("broker", "peer-bytes-out", {"peer"},
+                                 "Estimated payload volume shipped to the "
+                                 "peer.",
+                                 "bytes", true)
+                 ->get_or_add({{"peer", peer_id}});
+  batches_in_
+    = reg
+        .counter_family("broker", "peer-batches-in", {"peer"},
+                        "Number of batches received from the peer.", "1",
+                        true)
+        ->get_or_add({{"peer", peer_id}});
+  batches_out_
+    = reg
+        .counter_family("broker", "peer-batches-out", {"peer"},
+                        "Number of batches emitted to the peer.", "1", true)
+        ->get_or_add({{"peer", peer_id}});
+  rejected_
+    = reg
+        .counter_family("broker", "peer-rejected-messages", {"peer"},
+                        "Number of messages dropped by the filter of the "
+                        "peer.",
+                        "1", true)
+        ->get_or_add({{"peer", peer_id}});
+  queue_time_
+    = reg
+        .histogram_family<double>("broker", "peer-queue-time", {"peer"},
+                                  queue_time_bounds,
+                                  "Time messages spent in the outbound "
+                                  "buffer before going out to the peer.",
+                                  "seconds")
+        ->get_or_add({{"peer", peer_id}});
+  handshake_rtt_
+    = reg
+        .histogram_family<double>("broker", "peer-handshake-rtt", {"peer"},
+                                  rtt_bounds,
+                                  "Time between starting and completing the "
+                                  "stream handshake to the peer.",
+                                  "seconds")
+        ->get_or_add({{"peer", peer_id}});
+}
+
+void peer_metrics::count_inbound_batch(size_t num_messages,
+                                       size_t num_bytes) noexcept {
+  if (messages_in_ != nullptr) {
+    messages_in_->inc(static_cast<int64_t>(num_messages));
+    bytes_in_->inc(static_cast<int64_t>(num_bytes));
+    batches_in_->inc();
+  }
+}
+
+void peer_metrics::count_outbound(size_t num_messages,
+                                  size_t num_bytes) noexcept {
+  if (messages_out_ != nullptr) {
+    messages_out_->inc(static_cast<int64_t>(num_messages));
+    bytes_out_->inc(static_cast<int64_t>(num_bytes));
+  }
+}
+
+void peer_metrics::count_outbound_batch() noexcept {
+  if (batches_out_ != nullptr)
+    batches_out_->inc();
+}
+
+void peer_metrics::count_rejected(size_t num_messages) noexcept {
+  if (rejected_ != nullptr)
+    rejected_->inc(static_cast<int64_t>(num_messages));
+}
+
+void peer_metrics::observe_queue_time(double seconds) noexcept {
+  if (queue_time_ != nullptr)
+    queue_time_->observe(seconds);
+}
+
+void peer_metrics::observe_handshake_rtt(double seconds) noexcept {
+  if (handshake_rtt_ != nullptr)
+    handshake_rtt_->observe(seconds);
+}
+
+size_t estimated_wire_size(const data_message& msg) noexcept {
+  return get_topic(msg).string().size() + estimated_size(get_data(msg));
+}
+
+size_t estimated_wire_size(const command_message& msg) noexcept {
+  // Store commands are low-volume control traffic; a flat estimate avoids
+  // traversing the command variants.
+  constexpr size_t nominal_command_size = 64;
+  return get_topic(msg).string().size() + nominal_command_size;
+}
+
+size_t estimated_wire_size(const node_message& msg) noexcept {
+  // Origin, sequence number, TTL and stamp travel alongside the content.
+  constexpr size_t envelope_size = 32;
+  if (is_data_message(msg.content))
+    return envelope_size + estimated_wire_size(get<data_message>(msg.content));
+  return envelope_size + estimated_wire_size(get<command_message>(msg.content));
+}
+
+} // namespace broker::internal
@@ -1,7 +1,16 @@
 #include "broker/internal/prometheus.hh"
 
+#include <chrono>
+#include <cstring>
+#include <memory>
 #include <string_view>
 
+#include "broker/config.hh"
+
+#ifdef BROKER_HAVE_ZLIB
+#  include <zlib.h>
+#endif
+
 #include <caf/actor_system_config.hpp>
 #include <caf/attach_stream_sink.hpp>
 #include <caf/string_algorithms.hpp>
@@ -37,6 +46,71 @@ constexpr string_view request_ok
     "Content-Type: text/plain\r\n"
     "Connection: Closed\r\n\r\n";
 
+#ifdef BROKER_HAVE_ZLIB
+
+// HTTP header when sending a gzip-compressed payload.
+constexpr string_view request_ok_gzip
+  = "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Encoding: gzip\r\n"
+    "Connection: Closed\r\n\r\n";
+
+// Returns whether the buffered request contains an Accept-Encoding header
+// that lists gzip. Header names are case-insensitive per RFC 7230.
+bool accepts_gzip(string_view req) {
+  constexpr string_view field = "accept-encoding:";
+  auto to_lower = [](char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+  };
+  size_t pos = 0;
+  while ((pos = req.find('\n', pos)) != string_view::npos) {
+    auto line = req.substr(++pos);
+    if (line.size() < field.size())
+      continue;
+    auto matches_field = [&] {
+      for (size_t i = 0; i < field.size(); ++i)
+        if (to_lower(line[i]) != field[i])
+          return false;
+      return true;
+    };
+    if (!matches_field())
+      continue;
+    auto value = line.substr(field.size());
+    if (auto end = value.find('\r'); end != string_view::npos)
+      value = value.substr(0, end);
+    return value.find("gzip") != string_view::npos;
+  }
+  return false;
+}
+
+// Compresses `text` into a gzip-framed buffer. Returns an empty buffer if
+// zlib reports an error.
+caf::byte_buffer gzip_compress(string_view text) {
+  caf::byte_buffer result;
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  // 15 window bits plus 16 selects the gzip wrapper instead of raw zlib.
+  if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    return result;
+  result.resize(deflateBound(&strm, static_cast<uLong>(text.size())));
+  strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+  strm.avail_in = static_cast<uInt>(text.size());
+  strm.next_out = reinterpret_cast<Bytef*>(result.data());
+  strm.avail_out = static_cast<uInt>(result.size());
+  auto res = deflate(&strm, Z_FINISH);
+  auto out_size = static_cast<size_t>(strm.total_out);
+  deflateEnd(&strm);
+  if (res != Z_STREAM_END) {
+    result.clear();
+    return result;
+  }
+  result.resize(out_size);
+  return result;
+}
+
+#endif // BROKER_HAVE_ZLIB
+
 } // namespace
 
 // -- constructors, destructors, and assignment operators ----------------------
@@ -55,6 +129,9 @@ void prometheus_actor::on_exit() {
   requests_.clear();
   core_ = nullptr;
   exporter_.reset();
+#ifndef BROKER_WINDOWS
+  http_server_.reset();
+#endif
 }
 
 const char* prometheus_actor::name() const {
@@ -70,7 +147,40 @@ caf::behavior prometheus_actor::make_behavior() {
     BROKER_INFO("collect remote metrics from topics" << filter_);
     send(caf::actor{this} * core_, atom::join_v, filter_);
   }
+#ifndef BROKER_WINDOWS
+  // Scrapes served over the keep-alive HTTP server read from a cached
+  // exposition buffer; this actor only refreshes the cache periodically.
+  if (auto port = caf::get_or(config(), "broker.metrics.keepalive-port",
+                              uint16_t{0});
+      port != 0) {
+    auto server = std::make_unique<detail::http_metrics_server>();
+    if (auto actual = server->start(port)) {
+      BROKER_INFO("serving metrics on keep-alive HTTP port" << *actual);
+      http_server_ = std::move(server);
+    } else {
+      BROKER_ERROR("failed to start keep-alive HTTP server on port" << port);
+    }
+  }
+#endif
   auto bhvr = caf::message_handler{
+#ifndef BROKER_WINDOWS
+    [this](atom::tick, atom::write) {
+      if (!http_server_)
+        return;
+      BROKER_ASSERT(exporter_ != nullptr);
+      if (!exporter_->running()) {
+        exporter_->proc_importer.update();
+        exporter_->impl.scrape(system().metrics());
+      }
+      collector_.insert_or_update(exporter_->impl.rows());
+      http_server_->update(collector_.prometheus_text());
+      auto delay = exporter_->interval;
+      if (delay.count() <= 0)
+        delay = std::chrono::seconds(2);
+      scheduled_send(caf::actor{this}, clock().now() + delay, atom::tick_v,
+                     atom::write_v);
+    },
+#endif
     [this](const caf::io::new_data_msg& msg) {
       auto flush_and_close = [this, &msg] {
         flush(msg.handle);
@@ -110,6 +220,17 @@ caf::behavior prometheus_actor::make_behavior() {
       collector_.insert_or_update(exporter_->impl.rows());
       auto text = collector_.prometheus_text();
       auto payload = caf::as_bytes(caf::make_span(text));
+#ifdef BROKER_HAVE_ZLIB
+      caf::byte_buffer compressed;
+      if (accepts_gzip(req_str)) {
+        compressed = gzip_compress(text);
+        if (!compressed.empty()) {
+          hdr = caf::as_bytes(caf::make_span(request_ok_gzip));
+          payload = caf::span<const caf::byte>{compressed.data(),
+                                               compressed.size()};
+        }
+      }
+#endif
       auto& dst = wr_buf(msg.handle);
       dst.insert(dst.end(), hdr.begin(), hdr.end());
       dst.insert(dst.end(), payload.begin(), payload.end());
@@ -150,6 +271,10 @@ caf::behavior prometheus_actor::make_behavior() {
   };
   auto params = metric_exporter_params::from(config());
   exporter_.reset(new exporter_state_type(this, core_, std::move(params)));
+#ifndef BROKER_WINDOWS
+  if (http_server_)
+    send(caf::actor{this}, atom::tick_v, atom::write_v);
+#endif
   return bhvr.or_else(exporter_->make_behavior());
 }
 
@@ -0,0 +1,446 @@
+#include "broker/internal/logger.hh" // Needs to come before CAF includes.
+
+#include <caf/actor.hpp>
+#include <caf/attach_stream_sink.hpp>
+#include <caf/behavior.hpp>
+#include <caf/config_value.hpp>
+#include <caf/error.hpp>
+#include <caf/event_based_actor.hpp>
+#include <caf/make_message.hpp>
+#include <caf/response_promise.hpp>
+#include <caf/stateful_actor.hpp>
+#include <caf/system_messages.hpp>
+
+#include "broker/data.hh"
+#include "broker/detail/assert.hh"
+#include "broker/internal/master_actor.hh"
+#include "broker/internal/shard_router.hh"
+#include "broker/message.hh"
+#include "broker/internal/type_id.hh"
+#include "broker/topic.hh"
+
+namespace broker::internal {
+
+namespace {
+
+/// Merges a keys result (set or vector) from one shard into `merged`.
+void merge_keys(data& x, set& merged) {
+  if (auto xs = get_if<set>(x)) {
+    for (auto& key : *xs)
+      merged.insert(key);
+  } else if (auto xs = get_if<vector>(x)) {
+    for (auto& key : *xs)
+      merged.insert(std::move(key));
+  }
+}
+
+} // namespace
+
+void shard_router_state::init(caf::event_based_actor* ptr, std::string&& nm,
+                              caf::actor&& core_hdl,
+                              std::vector<backend_pointer>&& backends,
+                              endpoint::clock* clock,
+                              detail::evictor::policy ev_policy,
+                              uint64_t ev_max_entries) {
+  self = ptr;
+  id = std::move(nm);
+  core = std::move(core_hdl);
+  auto detached = caf::get_or(self->system().config(), "broker.detach-stores",
+                              false);
+  shards.reserve(backends.size());
+  for (auto& bp : backends) {
+    // Shards share the logical store name: store events and metrics carry the
+    // name users know, and the router is the only actor registered under it.
+    auto ev = detail::evictor{ev_policy, ev_max_entries};
+    auto shard
+      = detached
+          ? self->spawn<caf::linked + caf::lazy_init + caf::detached>(
+              master_actor, core, id, std::move(bp), clock, std::move(ev))
+          : self->spawn<caf::linked + caf::lazy_init>(master_actor, core, id,
+                                                      std::move(bp), clock,
+                                                      std::move(ev));
+    shards.push_back(std::move(shard));
+  }
+}
+
+const caf::actor& shard_router_state::shard_for(const data& key) const {
+  return shards[std::hash<data>{}(key) % shards.size()];
+}
+
+void shard_router_state::route(internal_command& x) {
+  auto fwd = [this](const data& key, internal_command&& cmd) {
+    auto& dst = shard_for(key);
+    self->send(dst, atom::local_v, std::move(cmd));
+  };
+  auto& content = x.content;
+  if (auto cmd = std::get_if<put_command>(&content)) {
+    fwd(cmd->key, std::move(x));
+  } else if (auto cmd = std::get_if<put_unique_command>(&content)) {
+    fwd(cmd->key, std::move(x));
+  } else if (auto cmd = std::get_if<erase_command>(&content)) {
+    fwd(cmd->key, std::move(x));
+  } else if (auto cmd = std::get_if<expire_command>(&content)) {
+    fwd(cmd->key, std::move(x));
+  } else if (auto cmd = std::get_if<add_command>(&content)) {
+    fwd(cmd->key, std::move(x));
+  } else if (auto cmd = std::get_if<subtract_command>(&content)) {
+    fwd(cmd->key, std::move(x));
+  } else if (auto cmd = std::get_if<multi_put_command>(&content)) {
+    std::vector<multi_put_command> parts(shards.size());
+    for (auto& entry : cmd->entries) {
+      auto idx = std::hash<data>{}(entry.first) % shards.size();
+      parts[idx].entries.push_back(std::move(entry));
+    }
+    for (size_t i = 0; i < parts.size(); ++i) {
+      if (parts[i].entries.empty())
+        continue;
+      parts[i].expiry = cmd->expiry;
+      parts[i].publisher = cmd->publisher;
+      self->send(shards[i], atom::local_v,
+                 internal_command{std::move(parts[i])});
+    }
+  } else if (auto cmd = std::get_if<multi_erase_command>(&content)) {
+    std::vector<multi_erase_command> parts(shards.size());
+    for (auto& key : cmd->keys) {
+      auto idx = std::hash<data>{}(key) % shards.size();
+      parts[idx].keys.push_back(std::move(key));
+    }
+    for (size_t i = 0; i < parts.size(); ++i) {
+      if (parts[i].keys.empty())
+        continue;
+      parts[i].publisher = cmd->publisher;
+      self->send(shards[i], atom::local_v,
+                 internal_command{std::move(parts[i])});
+    }
+  } else if (auto cmd = std::get_if<transaction_command>(&content)) {
+    // Atomicity holds per shard: each shard applies its slice of the bundle
+    // back to back. Cross-shard ordering guarantees never existed on sharded
+    // masters in the first place.
+    std::vector<transaction_command> parts(shards.size());
+    for (auto& op : cmd->ops) {
+      auto idx = std::hash<data>{}(op.key) % shards.size();
+      parts[idx].ops.push_back(std::move(op));
+    }
+    for (size_t i = 0; i < parts.size(); ++i) {
+      if (parts[i].ops.empty())
+        continue;
+      parts[i].expiry = cmd->expiry;
+      parts[i].publisher = cmd->publisher;
+      self->send(shards[i], atom::local_v,
+                 internal_command{std::move(parts[i])});
+    }
+  } else if (auto cmd = std::get_if<clear_command>(&content)) {
+    for (auto& shard : shards)
+      self->send(shard, atom::local_v,
+                 internal_command{clear_command{cmd->publisher}});
+  } else if (std::holds_alternative<snapshot_command>(content)) {
+    // A clone tries to attach. The per-shard sequence numbers make a coherent
+    // single update stream impossible, so sharded masters reject clones.
+    BROKER_WARNING("sharded master" << id << "does not support clones");
+  } else {
+    BROKER_WARNING("sharded master" << id << "received an unroutable command");
+  }
+}
+
+caf::behavior shard_router(caf::stateful_actor<shard_router_state>* self,
+                           caf::actor core, std::string id,
+                           std::vector<shard_router_state::backend_pointer>
+                             backends,
+                           endpoint::clock* clock,
+                           detail::evictor::policy ev_policy,
+                           uint64_t ev_max_entries) {
+  BROKER_ASSERT(!backends.empty());
+  self->monitor(core);
+  self->state.init(self, std::move(id), std::move(core), std::move(backends),
+                   clock, ev_policy, ev_max_entries);
+  self->set_down_handler([=](const caf::down_msg& msg) {
+    BROKER_INFO("core is down, kill sharded master as well");
+    self->quit(msg.reason);
+  });
+  return {
+    // --- command routing -----------------------------------------------------
+    [=](atom::local, internal_command& x) { self->state.route(x); },
+    [=](atom::sync_point, caf::actor& who) {
+      self->send(who, atom::sync_point_v);
+    },
+    [=](atom::replay, uint64_t, caf::actor&, caf::actor& remote_clone) {
+      BROKER_WARNING("sharded master" << self->state.id
+                                      << "does not support clones");
+      self->send(remote_clone, atom::replay_v, atom::restart_v);
+    },
+    [=](atom::expire, data& key) {
+      auto& dst = self->state.shard_for(key);
+      self->send(dst, atom::expire_v, std::move(key));
+    },
+    // --- single-key queries, delegated to the owning shard -------------------
+    [=](atom::exists, data& key) {
+      auto& dst = self->state.shard_for(key);
+      return self->delegate(dst, atom::exists_v, std::move(key));
+    },
+    [=](atom::exists, data& key, request_id id) {
+      auto& dst = self->state.shard_for(key);
+      return self->delegate(dst, atom::exists_v, std::move(key), id);
+    },
+    [=](atom::get, data& key) {
+      auto& dst = self->state.shard_for(key);
+      return self->delegate(dst, atom::get_v, std::move(key));
+    },
+    [=](atom::get, data& key, data& aspect) {
+      auto& dst = self->state.shard_for(key);
+      return self->delegate(dst, atom::get_v, std::move(key),
+                            std::move(aspect));
+    },
+    [=](atom::get, data& key, request_id id) {
+      auto& dst = self->state.shard_for(key);
+      return self->delegate(dst, atom::get_v, std::move(key), id);
+    },
+    [=](atom::get, data& key, data& aspect, request_id id) {
+      auto& dst = self->state.shard_for(key);
+      return self->delegate(dst, atom::get_v, std::move(key),
+                            std::move(aspect), id);
+    },
+    [=](atom::get, atom::name) { return self->state.id; },
+    // --- multi-key queries, assembled from per-shard responses ---------------
+    [=](atom::get, const vector& keys) -> caf::result<data> {
+      BROKER_INFO("MULTI_GET with" << keys.size() << "keys");
+      if (keys.empty())
+        return {data{vector{}}};
+      auto rp = self->make_response_promise<data>();
+      auto results = std::make_shared<vector>(keys.size());
+      auto pending = std::make_shared<size_t>(keys.size());
+      for (size_t i = 0; i < keys.size(); ++i) {
+        auto& dst = self->state.shard_for(keys[i]);
+        self->request(dst, caf::infinite, atom::get_v, keys[i])
+          .then(
+            [=](data& x) mutable {
+              (*results)[i] = std::move(x);
+              if (--*pending == 0)
+                rp.deliver(data{std::move(*results)});
+            },
+            [=](caf::error&) mutable {
+              // Missing keys yield nil, matching the unsharded master.
+              if (--*pending == 0)
+                rp.deliver(data{std::move(*results)});
+            });
+      }
+      return rp;
+    },
+    [=](atom::get, const vector& keys, request_id id) {
+      BROKER_INFO("MULTI_GET with" << keys.size() << "keys and id:" << id);
+      auto rp = self->make_response_promise();
+      if (keys.empty()) {
+        rp.deliver(data{vector{}}, id);
+        return rp;
+      }
+      auto results = std::make_shared<vector>(keys.size());
+      auto pending = std::make_shared<size_t>(keys.size());
+      for (size_t i = 0; i < keys.size(); ++i) {
+        auto& dst = self->state.shard_for(keys[i]);
+        self->request(dst, caf::infinite, atom::get_v, keys[i])
+          .then(
+            [=](data& x) mutable {
+              (*results)[i] = std::move(x);
+              if (--*pending == 0)
+                rp.deliver(data{std::move(*results)}, id);
+            },
+            [=](caf::error&) mutable {
+              if (--*pending == 0)
+                rp.deliver(data{std::move(*results)}, id);
+            });
+      }
+      return rp;
+    },
+    [=](atom::get, atom::snapshot, uint64_t cursor, uint64_t max_n)
+      -> caf::result<data> {
+      // Scans iterate the shards one at a time: the router cursor maps to
+      // (shard, shard cursor), so each page costs one shard round trip and
+      // every shard pins its partition only while being iterated.
+      auto& st = self->state;
+      size_t shard_idx = 0;
+      uint64_t shard_cursor = 0;
+      auto scan_id = cursor;
+      if (cursor != 0) {
+        auto i = st.scans.find(cursor);
+        if (i == st.scans.end()) {
+          auto err = caf::make_error(ec::no_such_key, "unknown scan cursor");
+          return err;
+        }
+        shard_idx = i->second.first;
+        shard_cursor = i->second.second;
+      } else {
+        scan_id = ++st.next_scan_id;
+        st.scans.emplace(scan_id, std::pair<size_t, uint64_t>{0, 0});
+      }
+      auto rp = self->make_response_promise<data>();
+      self->request(st.shards[shard_idx], caf::infinite, atom::get_v,
+                    atom::snapshot_v, shard_cursor, max_n)
+        .then(
+          [=](data& res) mutable {
+            auto& st = self->state;
+            auto xs = get_if<vector>(res);
+            if (!xs || xs->size() != 2 || !is<count>((*xs)[0])) {
+              st.scans.erase(scan_id);
+              rp.deliver(
+                caf::make_error(ec::invalid_data, "malformed scan page"));
+              return;
+            }
+            auto next_shard_cursor = get<count>((*xs)[0]);
+            auto next_idx = shard_idx;
+            if (next_shard_cursor == 0)
+              ++next_idx;
+            if (next_shard_cursor == 0 && next_idx >= st.shards.size()) {
+              st.scans.erase(scan_id);
+              rp.deliver(data{vector{data{count{0}}, std::move((*xs)[1])}});
+              return;
+            }
+            st.scans[scan_id] = {next_idx, next_shard_cursor};
+            rp.deliver(data{vector{data{scan_id}, std::move((*xs)[1])}});
+          },
+          [=](caf::error& e) mutable {
+            self->state.scans.erase(scan_id);
+            rp.deliver(std::move(e));
+          });
+      return rp;
+    },
+    [=](atom::get, atom::keys) -> caf::result<data> {
+      auto rp = self->make_response_promise<data>();
+      auto merged = std::make_shared<set>();
+      auto pending = std::make_shared<size_t>(self->state.shards.size());
+      for (auto& shard : self->state.shards)
+        self->request(shard, caf::infinite, atom::get_v, atom::keys_v)
+          .then(
+            [=](data& x) mutable {
+              merge_keys(x, *merged);
+              if (--*pending == 0)
+                rp.deliver(data{std::move(*merged)});
+            },
+            [=](caf::error& e) mutable { rp.deliver(std::move(e)); });
+      return rp;
+    },
+    [=](atom::get, atom::keys, request_id id) {
+      auto rp = self->make_response_promise();
+      auto merged = std::make_shared<set>();
+      auto pending = std::make_shared<size_t>(self->state.shards.size());
+      for (auto& shard : self->state.shards)
+        self->request(shard, caf::infinite, atom::get_v, atom::keys_v)
+          .then(
+            [=](data& x) mutable {
+              merge_keys(x, *merged);
+              if (--*pending == 0)
+                rp.deliver(data{std::move(*merged)}, id);
+            },
+            [=](caf::error& e) mutable {
+              rp.deliver(caf::make_message(std::move(e), id));
+            });
+      return rp;
+    },
+    [=](atom::get, atom::keys, const data& from, const data& to,
+        uint64_t limit) -> caf::result<data> {
+      auto rp = self->make_response_promise<data>();
+      auto merged = std::make_shared<set>();
+      auto pending = std::make_shared<size_t>(self->state.shards.size());
+      for (auto& shard : self->state.shards)
+        self->request(shard, caf::infinite, atom::get_v, atom::keys_v, from,
+                      to, limit)
+          .then(
+            [=](data& x) mutable {
+              merge_keys(x, *merged);
+              if (--*pending == 0) {
+                // Each shard already capped its partition; re-apply the cap
+                // to the merged, ordered result.
+                if (limit > 0)
+                  while (merged->size() > limit)
+                    merged->erase(std::prev(merged->end()));
+                rp.deliver(data{std::move(*merged)});
+              }
+            },
+            [=](caf::error& e) mutable { rp.deliver(std::move(e)); });
+      return rp;
+    },
+    [=](atom::get, atom::keys, const data& from, const data& to,
+        uint64_t limit, request_id id) {
+      auto rp = self->make_response_promise();
+      auto merged = std::make_shared<set>();
+      auto pending = std::make_shared<size_t>(self->state.shards.size());
+      for (auto& shard : self->state.shards)
+        self->request(shard, caf::infinite, atom::get_v, atom::keys_v, from,
+                      to, limit)
+          .then(
+            [=](data& x) mutable {
+              merge_keys(x, *merged);
+              if (--*pending == 0) {
+                if (limit > 0)
+                  while (merged->size() > limit)
+                    merged->erase(std::prev(merged->end()));
+                rp.deliver(data{std::move(*merged)}, id);
+              }
+            },
+            [=](caf::error& e) mutable {
+              rp.deliver(caf::make_message(std::move(e), id));
+            });
+      return rp;
+    },
+    // --- secondary indexes, one partial index per shard ----------------------
+    [=](atom::index, const data& element) -> caf::result<atom::ok> {
+      auto rp = self->make_response_promise<atom::ok>();
+      auto pending = std::make_shared<size_t>(self->state.shards.size());
+      for (auto& shard : self->state.shards)
+        self->request(shard, caf::infinite, atom::index_v, element)
+          .then(
+            [=](atom::ok) mutable {
+              if (--*pending == 0)
+                rp.deliver(atom::ok_v);
+            },
+            [=](caf::error& e) mutable { rp.deliver(std::move(e)); });
+      return rp;
+    },
+    [=](atom::get, atom::index, const data& value,
+        const data& element) -> caf::result<data> {
+      auto rp = self->make_response_promise<data>();
+      auto merged = std::make_shared<set>();
+      auto pending = std::make_shared<size_t>(self->state.shards.size());
+      for (auto& shard : self->state.shards)
+        self->request(shard, caf::infinite, atom::get_v, atom::index_v, value,
+                      element)
+          .then(
+            [=](data& x) mutable {
+              merge_keys(x, *merged);
+              if (--*pending == 0)
+                rp.deliver(data{std::move(*merged)});
+            },
+            [=](caf::error& e) mutable { rp.deliver(std::move(e)); });
+      return rp;
+    },
+    // --- unsupported on sharded stores ---------------------------------------
+    [=](atom::store, atom::write, const std::string&) -> caf::result<atom::ok> {
+      return caf::make_error(ec::unspecified,
+                             "sharded stores do not support bulk export");
+    },
+    [=](atom::store, atom::read, const std::string&) -> caf::result<atom::ok> {
+      return caf::make_error(ec::unspecified,
+                             "sharded stores do not support bulk import");
+    },
+    // --- stream handshake with core ------------------------------------------
+    [=](caf::stream<command_message>& in) {
+      BROKER_DEBUG("received stream handshake from core");
+      attach_stream_sink(
+        self,
+        // input stream
+        in,
+        // initialize state
+        [](caf::unit_t&) {
+          // nop
+        },
+        // processing step
+        [=](caf::unit_t&, command_message y) {
+          auto cmd = move_command(y);
+          self->state.route(cmd);
+        },
+        // cleanup
+        [](caf::unit_t&, const caf::error&) {
+          // nop
+        });
+    }};
+}
+
+} // namespace broker::internal
@@ -59,6 +59,7 @@ void store_actor_state::init(caf::event_based_actor* self,
   this->id = std::move(id);
   this->core = std::move(core);
   this->dst = topic::store_events() / this->id;
+  this->metrics = store_metrics{self->system(), this->id};
 }
 
 void store_actor_state::emit_insert_event(const data& key, const data& value,
@@ -0,0 +1,96 @@
+#include "broker/internal/store_metrics.hh"
+
+#include <caf/actor_system.hpp>
+#include <caf/telemetry/counter.hpp>
+#include <caf/telemetry/histogram.hpp>
+#include <caf/telemetry/metric_registry.hpp>
+
+#include "broker/detail/assert.hh"
+#include "broker/telemetry/shards.hh"
+
+namespace broker::internal {
+
+namespace {
+
+/// Label values for the "command" dimension, in the order of the
+/// alternatives in `internal_command::variant_type`.
+constexpr caf::string_view command_names[store_metrics::num_command_types] = {
+  "none",        "put",           "put_unique", "erase",
+  "expire",      "add",           "subtract",   "multi_put",
+  "multi_erase", "snapshot",      "snapshot_sync", "set",
+  "clear",       "transaction",
+};
+
+/// Upper bounds for the runtime histograms in seconds. Log-spaced buckets
+/// (roughly powers of four) cover one microsecond to 16 seconds with a
+/// constant relative error, like an HDR histogram with a coarse precision.
+constexpr double upper_bounds[] = {
+  0.000001, 0.000004, 0.000016, 0.000064, 0.000256, 0.001,
+  0.004,    0.016,    0.064,    0.256,    1.0,      4.0,
+  16.0,
+};
+
+} // namespace
+
+store_metrics::store_metrics(caf::actor_system& sys,
+                             const std::string& store_name) {
+  auto& reg = sys.metrics();
+  auto counts = reg.counter_family("broker", "store-commands",
+                                   {"command", "store"},
+                                   "Number of commands processed by the "
+                                   "store, by command type.",
+                                   "1", true);
+  auto runtimes = reg.histogram_family<double>(
+    "broker", "store-command-runtime", {"command", "store"}, upper_bounds,
+    "Time the store spent processing a single command, by command type.",
+    "seconds");
+  for (size_t index = 0; index < num_command_types; ++index) {
+    counts_[index] = reinterpret_cast<telemetry::int_counter_hdl*>(
+      counts->get_or_add(
+        {{"command", command_names[index]}, {"store", store_name}}));
+    runtimes_[index] = reinterpret_cast<telemetry::dbl_histogram_hdl*>(
+      runtimes->get_or_add(
+        {{"command", command_names[index]}, {"store", store_name}}));
+  }
+}
+
+void store_metrics::enable_slo_tracking(caf::actor_system& sys,
+                                        const std::string& store_name) {
+  auto& reg = sys.metrics();
+  auto delays = reg.histogram_family<double>(
+    "broker", "store-propagation-delay", {"store"}, upper_bounds,
+    "Delay between the master broadcasting a sampled command and this clone "
+    "applying it.",
+    "seconds");
+  propagation_ = reinterpret_cast<telemetry::dbl_histogram_hdl*>(
+    delays->get_or_add({{"store", store_name}}));
+  auto breaches = reg.counter_family("broker", "store-slo-breaches", {"store"},
+                                     "Number of sampled commands whose "
+                                     "propagation delay exceeded the SLO "
+                                     "threshold.",
+                                     "1", true);
+  slo_breaches_ = reinterpret_cast<telemetry::int_counter_hdl*>(
+    breaches->get_or_add({{"store", store_name}}));
+}
+
+void store_metrics::observe_propagation(double seconds) {
+  if (propagation_ == nullptr)
+    return;
+  telemetry::shards::observe(propagation_, seconds);
+}
+
+void store_metrics::count_slo_breach() {
+  if (slo_breaches_ == nullptr)
+    return;
+  telemetry::shards::add(slo_breaches_, int64_t{1});
+}
+
+void store_metrics::observe(size_t index, double seconds) {
+  BROKER_ASSERT(index < num_command_types);
+  if (counts_[index] == nullptr)
+    return;
+  telemetry::shards::add(counts_[index], int64_t{1});
+  telemetry::shards::observe(runtimes_[index], seconds);
+}
+
+} // namespace broker::internal
@@ -1,5 +1,6 @@
 #include "broker/internal/unipath_manager.hh"
 
+#include <chrono>
 #include <type_traits>
 
 #include <caf/actor_system_config.hpp>
@@ -12,11 +13,16 @@
 
 #include "broker/defaults.hh"
 #include "broker/detail/assert.hh"
+#include "broker/detail/first_segment_filter.hh"
 #include "broker/detail/prefix_matcher.hh"
+#include "broker/detail/radix_tree.hh"
+#include "broker/detail/sdt.hh"
 #include "broker/internal/central_dispatcher.hh"
 #include "broker/internal/logger.hh"
+#include "broker/internal/native.hh"
 #include "broker/internal/type_id.hh"
 #include "broker/message.hh"
+#include "broker/status.hh"
 #include "broker/topic.hh"
 
 namespace broker::internal {
@@ -87,11 +93,17 @@ public:
                  << BROKER_ARG(pending_handshakes)
                  << BROKER_ARG2("num-messages", messages.size()));
     if (is_eligible<T>(scope)) {
-      detail::prefix_matcher matches_filter;
       auto old_size = cache_.size();
+      size_t rejected = 0;
       for (const auto& msg : messages) {
-        if (is_eligible<T>(msg) && matches_filter(filter_, msg)) {
+        if (is_eligible<T>(msg)) {
+          if (!accepts(get_topic(msg))) {
+            ++rejected;
+            continue;
+          }
           if constexpr (std::is_same<T, data_message>::value) {
+            if (tracer_ != nullptr)
+              tracer_->record(msg);
             cache_.emplace_back(get<data_message>(msg.content));
           } else if constexpr (std::is_same<T, command_message>::value) {
             cache_.emplace_back(get<command_message>(msg.content));
@@ -100,7 +112,21 @@ public:
           }
         }
       }
+      if (rejected > 0) {
+        BROKER_PROBE1(manager_reject, rejected);
+        if (metrics_ != nullptr)
+          metrics_->count_rejected(rejected);
+      }
       if (auto added = cache_.size() - old_size; added > 0) {
+        BROKER_PROBE1(manager_accept, added);
+        if (metrics_ != nullptr) {
+          size_t num_bytes = 0;
+          for (auto i = old_size; i < cache_.size(); ++i)
+            num_bytes += estimated_wire_size(cache_[i]);
+          metrics_->count_outbound(added, num_bytes);
+          if (old_size == 0)
+            buffering_since_ = std::chrono::steady_clock::now();
+        }
         super::generated_messages(added);
         if (path_) {
           emit_batches_impl(false);
@@ -149,6 +175,20 @@ public:
     if (auto shipped = old_size - new_size; shipped > 0) {
       super::shipped_messages(shipped);
       super::last_send_ = super::self()->now();
+      if (metrics_ != nullptr) {
+        metrics_->count_outbound_batch();
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> delay = now - buffering_since_;
+        metrics_->observe_queue_time(delay.count());
+        if (manager_ != nullptr && latency_threshold_.count() > 0
+            && delay >= latency_threshold_ && now - last_spike_ >= cooldown_) {
+          last_spike_ = now;
+          manager_->emit_latency_spike(delay.count());
+        }
+        // Approximate the buffering time of leftovers with the emit time.
+        if (!cache_.empty())
+          buffering_since_ = now;
+      }
     }
   }
 
@@ -224,9 +264,59 @@ public:
     return path_ && path_->slots.sender == x;
   }
 
+  /// Replaces the current filter and compiles it: plain prefixes go into the
+  /// radix tree that backs `accepts`, entries with wildcard segments into the
+  /// pre-split pattern list.
+  void set_filter(filter_type new_filter) {
+    filter_ = std::move(new_filter);
+    compiled_filter_.clear();
+    for (auto& prefix : filter_)
+      if (!prefix.contains_wildcard())
+        compiled_filter_.insert({prefix.string(), true});
+    patterns_.assign(filter_);
+    fast_reject_.assign(filter_);
+  }
+
+  /// Checks `t` against the compiled filter. The Bloom filter rejects most
+  /// non-matching topics with two bit tests; hits continue into the radix
+  /// tree, which runs in O(len(t)) regardless of the number of entries, and
+  /// fall back to the wildcard patterns on a miss.
+  [[nodiscard]] bool accepts(const topic& t) const noexcept {
+    if (!fast_reject_.may_match(t))
+      return false;
+    return compiled_filter_.has_prefix_of(t.string()) || patterns_.matches(t);
+  }
+
   unique_path_ptr path_;
   filter_type filter_;
+  detail::first_segment_filter fast_reject_;
+  detail::radix_tree<bool> compiled_filter_;
+  detail::compiled_patterns patterns_;
   std::vector<T> cache_;
+
+  /// Records end-to-end latency when enqueueing data messages for a local
+  /// subscriber. Only set on paths to data_message receivers.
+  latency_tracer* tracer_ = nullptr;
+
+  /// Per-peer traffic accounting. Only set on paths to remote peers.
+  peer_metrics* metrics_ = nullptr;
+
+  /// Time point of the first message buffered since the last emit. Only
+  /// maintained when `metrics_` is non-null.
+  std::chrono::steady_clock::time_point buffering_since_;
+
+  /// Parent manager for emitting health status events. Only set on paths to
+  /// remote peers.
+  unipath_manager* manager_ = nullptr;
+
+  /// Buffering delay that triggers a latency-spike status; zero disables.
+  std::chrono::duration<double> latency_threshold_{0};
+
+  /// Minimum time between two latency-spike events from this path.
+  std::chrono::steady_clock::duration cooldown_{0};
+
+  /// Time point of the last emitted latency-spike event.
+  std::chrono::steady_clock::time_point last_spike_;
 };
 
 template <class T>
@@ -237,7 +327,9 @@ public:
   unipath_manager_out(central_dispatcher* dispatcher,
                       unipath_manager::observer* observer)
     : super(dispatcher, observer), out_(this) {
-    // nop
+    if constexpr (std::is_same<T, data_message>::value)
+      if (dispatcher->tracer().enabled())
+        out_.tracer_ = &dispatcher->tracer();
   }
 
   template <class Filter>
@@ -245,7 +337,7 @@ public:
                       unipath_manager::observer* observer, Filter&& filter)
     : unipath_manager_out(dispatcher, observer) {
     BROKER_TRACE(BROKER_ARG(filter));
-    out_.filter_ = std::forward<Filter>(filter);
+    out_.set_filter(std::forward<Filter>(filter));
   }
 
   bool enqueue(const unipath_manager* source, detail::item_scope scope,
@@ -263,18 +355,34 @@ public:
 
   void filter(filter_type new_filter) override {
     BROKER_TRACE(BROKER_ARG(new_filter));
-    out_.filter_ = std::move(new_filter);
+    out_.set_filter(std::move(new_filter));
+    super::dispatcher_->invalidate_dispatch_cache();
   }
 
-  bool accepts(const topic&t) const noexcept override {
-    detail::prefix_matcher accept;
-    return accept(out_.filter_, t);
+  bool accepts(const topic& t) const noexcept override {
+    return out_.accepts(t);
   }
 
   caf::type_id_t message_type() const noexcept override {
     return caf::type_id_v<T>;
   }
 
+  using super::metrics;
+
+  void metrics(peer_metrics new_metrics) override {
+    super::metrics(std::move(new_metrics));
+    out_.metrics_ = &this->metrics_;
+    out_.manager_ = this;
+    auto& cfg = this->self()->system().config();
+    auto threshold = caf::get_or(cfg, "broker.health.peer-latency-threshold",
+                                 defaults::health::peer_latency_threshold);
+    out_.latency_threshold_
+      = std::chrono::duration_cast<std::chrono::duration<double>>(threshold);
+    out_.cooldown_
+      = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        defaults::health::cooldown);
+  }
+
   caf::downstream_manager& out() override {
     return out_;
   }
@@ -418,12 +526,29 @@ public:
   using super::handle;
 
   void handle_batch(std::vector<node_message>& xs) {
+    if (auto& m = this->metrics(); m) {
+      size_t num_bytes = 0;
+      for (const auto& x : xs)
+        num_bytes += estimated_wire_size(x);
+      m.count_inbound_batch(xs.size(), num_bytes);
+    }
     auto old_size = pending_.size();
     for (auto& x : xs) {
       if (x.ttl == 0) {
         BROKER_WARNING("received node message with TTL 0: dropped");
         continue;
       }
+      if (x.origin) {
+        if (x.origin == super::dispatcher_->origin_id()) {
+          BROKER_DEBUG("dropped our own message echoed back by a peer");
+          continue;
+        }
+        if (super::dispatcher_->dedup_enabled()
+            && super::dispatcher_->dedup().is_duplicate(x.origin, x.seq)) {
+          BROKER_DEBUG("dropped duplicate from" << x.origin);
+          continue;
+        }
+      }
       // Somewhat hacky, but don't forward data store clone messages.
       auto ttl = ends_with(get_topic(x).string(), topic::clone_suffix_str)
                  ? uint16_t{0}
@@ -446,7 +571,10 @@ public:
     auto old_size = pending_.size();
     for (auto& x : xs) {
       force_unshared(x);
-      pending_.emplace_back(make_node_message(std::move(x), ttl_));
+      auto msg = make_node_message(std::move(x), ttl_);
+      msg.origin = super::dispatcher_->origin_id();
+      msg.seq = super::dispatcher_->next_seq();
+      pending_.emplace_back(std::move(msg));
     }
     if (auto added = pending_.size() - old_size; added > 0) {
       auto ys = caf::make_span(std::addressof(pending_[old_size]), added);
@@ -523,6 +651,22 @@ bool unipath_manager::blocks_inputs() {
   return false;
 }
 
+void unipath_manager::metrics(peer_metrics new_metrics) {
+  metrics_ = std::move(new_metrics);
+}
+
+void unipath_manager::emit_latency_spike(double seconds) {
+  auto peer = hdl();
+  if (!peer)
+    return;
+  BROKER_WARNING("peer batch latency spike:" << seconds << "seconds");
+  auto stat = status::make<sc::peer_latency_spike>(
+    facade(peer.node()), "peer batch latency above threshold");
+  auto dmsg = make_data_message(topic::statuses(), get_as<data>(stat));
+  dispatcher_->stage(nullptr, detail::item_scope::local,
+                     make_node_message(std::move(dmsg), uint16_t{1}));
+}
+
 bool unipath_manager::has_inbound_path() const noexcept {
   return inbound_paths().size() == 1;
 }
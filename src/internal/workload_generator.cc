@@ -0,0 +1,77 @@
+#include "broker/internal/workload_generator.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+
+namespace broker::internal {
+
+namespace {
+
+/// Containers smaller than this degenerate into leaf values.
+constexpr size_t min_container_budget = 32;
+
+/// Number of children per generated container level.
+constexpr size_t container_fanout = 4;
+
+} // namespace
+
+workload_generator::workload_generator(parameters params)
+  : params_(std::move(params)), engine_(params_.seed) {
+  auto num_topics = std::max<size_t>(params_.num_topics, 1);
+  topics_.reserve(num_topics);
+  for (size_t i = 0; i < num_topics; ++i)
+    topics_.emplace_back("/benchmark/workload/" + std::to_string(i));
+  // Zipf: weight of the i-th topic is 1 / (i + 1)^s.
+  std::vector<double> weights;
+  weights.reserve(num_topics);
+  for (size_t i = 0; i < num_topics; ++i)
+    weights.emplace_back(1.0
+                         / std::pow(static_cast<double>(i + 1),
+                                    params_.topic_skew));
+  topic_dist_ = std::discrete_distribution<size_t>{weights.begin(),
+                                                   weights.end()};
+  auto median = std::max<size_t>(params_.value_size_median, 1);
+  size_dist_ = std::lognormal_distribution<double>{
+    std::log(static_cast<double>(median)), params_.value_size_sigma};
+}
+
+data_message workload_generator::next() {
+  auto drawn = std::max(size_dist_(engine_), 1.0);
+  auto size = static_cast<size_t>(std::lround(drawn));
+  return make_data_message(pick_topic(),
+                           make_value(size, params_.max_nesting_depth));
+}
+
+const topic& workload_generator::pick_topic() {
+  return topics_[topic_dist_(engine_)];
+}
+
+data workload_generator::make_value(size_t budget, size_t depth) {
+  if (depth == 0 || budget < min_container_budget) {
+    // Leaf: a string paid for byte by byte keeps the overall message size
+    // close to the drawn target.
+    std::string result;
+    result.resize(std::max<size_t>(budget, 1));
+    std::uniform_int_distribution<int16_t> char_dist{'!', '~'};
+    for (auto& c : result)
+      c = static_cast<char>(char_dist(engine_));
+    return data{std::move(result)};
+  }
+  auto child_budget = budget / container_fanout;
+  if (engine_() % 2 == 0) {
+    vector result;
+    result.reserve(container_fanout);
+    for (size_t i = 0; i < container_fanout; ++i)
+      result.emplace_back(make_value(child_budget, depth - 1));
+    return data{std::move(result)};
+  }
+  table result;
+  for (size_t i = 0; i < container_fanout; ++i)
+    result.emplace("field-" + std::to_string(i),
+                   make_value(child_budget, depth - 1));
+  return data{std::move(result)};
+}
+
+} // namespace broker::internal
@@ -1,9 +1,34 @@
 #include "broker/internal_command.hh"
 
+#include <type_traits>
+
 namespace broker {
 
+namespace {
+
+template <class T, class = void>
+struct has_publisher : std::false_type {};
+
+template <class T>
+struct has_publisher<T,
+                     std::void_t<decltype(std::declval<const T&>().publisher)>>
+  : std::true_type {};
+
+} // namespace
+
 internal_command::internal_command(variant_type x) : content(std::move(x)) {
   // nop
 }
 
+publisher_id publisher_of(const internal_command::variant_type& cmd) {
+  return std::visit(
+    [](const auto& x) -> publisher_id {
+      if constexpr (has_publisher<std::decay_t<decltype(x)>>::value)
+        return x.publisher;
+      else
+        return {};
+    },
+    cmd);
+}
+
 } // namespace broker
@@ -1,6 +1,8 @@
 #include "broker/publisher.hh"
 
 #include "broker/data.hh"
+#include "broker/detail/publish_limiter.hh"
+#include "broker/detail/queue_stats.hh"
 #include "broker/endpoint.hh"
 #include "broker/internal/endpoint_access.hh"
 #include "broker/internal/logger.hh"
@@ -102,10 +104,15 @@ publisher_worker(caf::stateful_actor<publisher_worker_state>* self,
 
 } // namespace <anonymous>
 
-publisher::publisher(endpoint& ep, topic t)
+publisher::publisher(endpoint& ep, topic t, int numa_node)
   : drop_on_destruction_(false),
     queue_(detail::make_shared_publisher_queue(queue_size)),
-    topic_(std::move(t)) {
+    topic_(std::move(t)),
+    limiter_(ep.publish_limiter()) {
+  queue_->attach_stats(detail::make_queue_stats(ep, "publisher", {topic_}));
+  queue_->attach_accounting(ep.memory_accountant());
+  if (numa_node >= 0)
+    queue_->set_numa_node(numa_node);
   auto& sys = internal::endpoint_access{&ep}.sys();
   worker_ = facade(sys.spawn(publisher_worker, &ep, queue_));
 }
@@ -142,12 +149,20 @@ void publisher::drop_all_on_destruction() {
 }
 
 void publisher::publish(data x) {
+  if (!limiter_->admit(topic_))
+    return;
   BROKER_INFO("publishing" << std::make_pair(topic_, x));
   if (queue_->produce(topic_, std::move(x)))
     caf::anon_send(native(worker_), atom::resume_v);
 }
 
 void publisher::publish(std::vector<data> xs) {
+  publish(span<data>{xs.data(), xs.size()});
+}
+
+void publisher::publish(span<data> xs) {
+  if (!limiter_->admit(topic_, xs.size()))
+    return;
   auto t = static_cast<ptrdiff_t>(queue_->capacity());
   auto i = xs.begin();
   auto e = xs.end();
@@ -165,6 +180,24 @@ void publisher::publish(std::vector<data> xs) {
   }
 }
 
+void publisher::publish(batch&& xs) {
+  if (!limiter_->admit(topic_, xs.size())) {
+    xs.msgs_.clear();
+    return;
+  }
+  auto t = static_cast<ptrdiff_t>(queue_->capacity());
+  auto i = xs.msgs_.begin();
+  auto e = xs.msgs_.end();
+  while (i != e) {
+    auto j = i + std::min(std::distance(i, e), t);
+    BROKER_INFO("publishing batch of size" << (j - i));
+    if (queue_->produce(i, j))
+      caf::anon_send(native(worker_), atom::resume_v);
+    i = j;
+  }
+  xs.msgs_.clear();
+}
+
 void publisher::reset() {
   if (!worker_)
     return;
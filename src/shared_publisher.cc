@@ -0,0 +1,80 @@
+#include "broker/shared_publisher.hh"
+
+#include "broker/data.hh"
+#include "broker/detail/shared_publisher_queue.hh"
+#include "broker/internal/endpoint_access.hh"
+#include "broker/internal/logger.hh"
+#include "broker/internal/type_id.hh"
+#include "broker/message.hh"
+
+#include <caf/send.hpp>
+
+#include <algorithm>
+#include <mutex>
+
+using broker::internal::native;
+
+namespace atom = broker::internal::atom;
+
+namespace broker {
+
+struct shared_publisher::impl {
+  explicit impl(publisher p) : pub(std::move(p)) {
+    // nop
+  }
+
+  /// Serializes concurrent producers. The core actor never takes this mutex.
+  std::mutex mtx;
+
+  /// The single-threaded handle owning the queue and the background worker.
+  publisher pub;
+};
+
+shared_publisher::shared_publisher(publisher pub)
+  : impl_(std::make_shared<impl>(std::move(pub))) {
+  // nop
+}
+
+shared_publisher::~shared_publisher() {
+  // nop; must not be inline to avoid instantiating impl in the header.
+}
+
+size_t shared_publisher::buffered() const {
+  return impl_->pub.buffered();
+}
+
+size_t shared_publisher::capacity() const {
+  return impl_->pub.capacity();
+}
+
+void shared_publisher::publish(data x) {
+  std::unique_lock guard{impl_->mtx};
+  impl_->pub.publish(std::move(x));
+}
+
+void shared_publisher::publish(std::vector<data> xs) {
+  std::unique_lock guard{impl_->mtx};
+  impl_->pub.publish(std::move(xs));
+}
+
+void shared_publisher::publish(data_message* first, size_t num) {
+  auto& pub = impl_->pub;
+  auto capacity = static_cast<ptrdiff_t>(pub.queue_->capacity());
+  auto i = first;
+  auto e = first + num;
+  std::unique_lock guard{impl_->mtx};
+  while (i != e) {
+    auto j = i + std::min(std::distance(i, e), capacity);
+    BROKER_INFO("publishing batch of size" << (j - i));
+    if (pub.queue_->produce(i, j))
+      caf::anon_send(native(pub.worker_), atom::resume_v);
+    i = j;
+  }
+}
+
+void shared_publisher::publish(std::vector<data_message>& xs) {
+  publish(xs.data(), xs.size());
+  xs.clear();
+}
+
+} // namespace broker
@@ -27,6 +27,14 @@ const char* to_string(sc code) noexcept {
       return "endpoint_discovered";
     case sc::endpoint_unreachable:
       return "endpoint_unreachable";
+    case sc::slow_consumer:
+      return "slow_consumer";
+    case sc::peer_latency_spike:
+      return "peer_latency_spike";
+    case sc::store_backlog:
+      return "store_backlog";
+    case sc::store_slo_breach:
+      return "store_slo_breach";
   }
 }
 
@@ -43,6 +51,10 @@ bool convert(const std::string& str, sc& code) noexcept {
   BROKER_SC_FROM_STRING(peer_lost)
   BROKER_SC_FROM_STRING(endpoint_discovered)
   BROKER_SC_FROM_STRING(endpoint_unreachable)
+  BROKER_SC_FROM_STRING(slow_consumer)
+  BROKER_SC_FROM_STRING(peer_latency_spike)
+  BROKER_SC_FROM_STRING(store_backlog)
+  BROKER_SC_FROM_STRING(store_slo_breach)
   return false;
 }
 
@@ -76,6 +88,10 @@ error status::verify() const {
     case sc::peer_lost:
     case sc::endpoint_discovered:
     case sc::endpoint_unreachable:
+    case sc::slow_consumer:
+    case sc::peer_latency_spike:
+    case sc::store_backlog:
+    case sc::store_slo_breach:
       if (context_.node)
         return {};
       else
@@ -54,8 +54,21 @@ using value_type = status_subscriber::value_type;
 } // namespace
 
 status_subscriber::status_subscriber(endpoint& ep, bool receive_statuses)
-  : impl_(ep, make_status_topics(receive_statuses),
-          std::numeric_limits<long>::max()) {
+  : probe_(std::make_shared<sampling_state>()),
+    impl_(ep, make_status_topics(receive_statuses),
+          std::numeric_limits<long>::max(), backpressure_options{},
+          [probe{probe_}](const data_message& msg) {
+            // Runs on the worker thread for every event that enters the
+            // queue. Publish the error code before bumping the counters so
+            // that a sampler who sees a new count also sees a matching code.
+            if (get_topic(msg) == topic::errors_str) {
+              if (auto value = to<error>(get_data(msg)))
+                probe->last_error.store(static_cast<uint8_t>(value->code()),
+                                        std::memory_order_relaxed);
+              probe->errors.fetch_add(1, std::memory_order_release);
+            }
+            probe->generation.fetch_add(1, std::memory_order_release);
+          }) {
   // nop
 }
 
@@ -52,6 +52,25 @@ request_id store::proxy::get(data key) {
   return id_;
 }
 
+request_id store::proxy::multi_get(std::vector<data> keys) {
+  if (!frontend_)
+    return 0;
+  send_as(proxy_, frontend_, atom::get_v, std::move(keys), ++id_);
+  return id_;
+}
+
+void store::proxy::schedule_get(data key) {
+  scheduled_.emplace_back(std::move(key));
+}
+
+request_id store::proxy::flush() {
+  if (!frontend_ || scheduled_.empty())
+    return 0;
+  send_as(proxy_, frontend_, atom::get_v, std::move(scheduled_), ++id_);
+  scheduled_.clear();
+  return id_;
+}
+
 request_id store::proxy::put_unique(data key, data val,
                                     std::optional<timespan> expiry) {
   if (!frontend_)
@@ -77,6 +96,14 @@ request_id store::proxy::keys() {
   return id_;
 }
 
+request_id store::proxy::keys_in_range(data from, data to, uint64_t limit) {
+  if (!frontend_)
+    return 0;
+  send_as(proxy_, frontend_, atom::get_v, atom::keys_v, std::move(from),
+          std::move(to), limit, ++id_);
+  return id_;
+}
+
 mailbox store::proxy::mailbox() {
   return make_mailbox(caf::actor_cast<internal::flare_actor*>(native(proxy_)));
 }
@@ -103,6 +130,38 @@ publisher_id store::proxy::frontend_id() const noexcept {
   return {facade(hdl.node()), hdl.id()};
 }
 
+std::vector<store::response> store::proxy::drain() {
+  std::vector<store::response> rval;
+  receive_all([&rval](response resp) { rval.emplace_back(std::move(resp)); });
+  return rval;
+}
+
+void store::proxy::receive_all(const std::function<void(response)>& f) {
+  auto fa = caf::actor_cast<internal::flare_actor*>(native(proxy_));
+  size_t consumed = 0;
+  auto fetch = [&] {
+    fa->receive(
+      [&](data& x, request_id id) {
+        ++consumed;
+        f(response{std::move(x), id});
+      },
+      [&](const caf::error& e, request_id id) {
+        BROKER_ERROR("proxy failed to receive response from store" << id);
+        ++consumed;
+        f(response{facade(e), id});
+      });
+  };
+  // Block for the first response, then grab whatever else is already waiting
+  // without blocking again. The flare stays lit during the loop, so none of
+  // the receives performs a blocking wait.
+  fetch();
+  auto mb = mailbox();
+  while (!mb.empty())
+    fetch();
+  // Settle the flare once for the entire batch.
+  fa->extinguish_many(consumed);
+}
+
 std::vector<store::response> store::proxy::receive(size_t n) {
   std::vector<store::response> rval;
   rval.reserve(n);
@@ -150,6 +209,10 @@ expected<data> store::get(data key) const {
   return request<data>(atom::get_v, std::move(key));
 }
 
+expected<data> store::multi_get(std::vector<data> keys) const {
+  return request<data>(atom::get_v, std::move(keys));
+}
+
 expected<data> store::put_unique(data key, data val,
                                  std::optional<timespan> expiry) const {
   if (!frontend_)
@@ -179,14 +242,139 @@ expected<data> store::put_unique(data key, data val,
   return res;
 }
 
+expected<void> store::save_to(const std::string& path) const {
+  if (!frontend_)
+    return make_error(ec::unspecified, "store not initialized");
+  expected<void> res{ec::unspecified};
+  auto& hdl = native(frontend_);
+  caf::scoped_actor self{hdl->home_system()};
+  self->request(hdl, timeout::frontend, atom::store_v, atom::write_v, path)
+    .receive([&](atom::ok) { res = {}; },
+             [&](caf::error& e) { res = facade(e); });
+  return res;
+}
+
+expected<void> store::load_from(const std::string& path) const {
+  if (!frontend_)
+    return make_error(ec::unspecified, "store not initialized");
+  expected<void> res{ec::unspecified};
+  auto& hdl = native(frontend_);
+  caf::scoped_actor self{hdl->home_system()};
+  self->request(hdl, timeout::frontend, atom::store_v, atom::read_v, path)
+    .receive([&](atom::ok) { res = {}; },
+             [&](caf::error& e) { res = facade(e); });
+  return res;
+}
+
+expected<data> store::scan(uint64_t& cursor, uint64_t max_n) const {
+  auto res = request<data>(atom::get_v, atom::snapshot_v, cursor, max_n);
+  if (!res)
+    return res;
+  // The master replies with [next_cursor, page].
+  auto xs = get_if<vector>(*res);
+  if (!xs || xs->size() != 2 || !is<count>((*xs)[0]))
+    return make_error(ec::invalid_data, "malformed scan response");
+  cursor = get<count>((*xs)[0]);
+  return {std::move((*xs)[1])};
+}
+
+expected<void> store::create_index(std::optional<uint64_t> element) const {
+  if (!frontend_)
+    return make_error(ec::unspecified, "store not initialized");
+  expected<void> res{ec::unspecified};
+  auto& hdl = native(frontend_);
+  caf::scoped_actor self{hdl->home_system()};
+  auto arg = element ? data{*element} : data{};
+  self->request(hdl, timeout::frontend, atom::index_v, std::move(arg))
+    .receive([&](atom::ok) { res = {}; },
+             [&](caf::error& e) { res = facade(e); });
+  return res;
+}
+
+expected<data> store::get_index(data value,
+                                std::optional<uint64_t> element) const {
+  auto arg = element ? data{*element} : data{};
+  return request<data>(atom::get_v, atom::index_v, std::move(value),
+                       std::move(arg));
+}
+
+expected<data> store::lookup_subnet(address addr) const {
+  return request<data>(atom::get_v, atom::subnet_v, std::move(addr));
+}
+
 expected<data> store::get_index_from_value(data key, data index) const {
   return request<data>(atom::get_v, std::move(key), std::move(index));
 }
 
+store::reader::reader(std::shared_ptr<detail::store_view> view)
+  : view_(std::move(view)) {
+  // nop
+}
+
+expected<data> store::reader::get(const data& key) const {
+  if (!view_)
+    return make_error(ec::unspecified, "reader not initialized");
+  auto xs = view_->load();
+  if (auto i = xs->find(key); i != xs->end())
+    return i->second;
+  return ec::no_such_key;
+}
+
+bool store::reader::exists(const data& key) const {
+  if (!view_)
+    return false;
+  auto xs = view_->load();
+  return xs->count(key) != 0;
+}
+
+expected<store::reader> store::create_reader() const {
+  if (!frontend_)
+    return make_error(ec::unspecified, "store not initialized");
+  auto view = detail::store_view::lookup(name_);
+  if (!view)
+    return make_error(ec::no_such_master, "no in-process master for store");
+  // Nudge the master to publish a fresh view right away; until it does, the
+  // reader sees the last published state.
+  anon_send(native(frontend_), atom::tick_v, atom::snapshot_v);
+  return reader{std::move(view)};
+}
+
 expected<data> store::keys() const {
   return request<data>(atom::get_v, atom::keys_v);
 }
 
+expected<data> store::keys_in_range(data from, data to, uint64_t limit) const {
+  return request<data>(atom::get_v, atom::keys_v, std::move(from),
+                       std::move(to), limit);
+}
+
+expected<data> store::keys_with_prefix(std::string prefix,
+                                       uint64_t limit) const {
+  // The successor of the prefix in byte order bounds the scan. If the prefix
+  // consists solely of 0xff bytes, no finite bound exists and we fall back to
+  // an unbounded scan plus client-side filtering.
+  auto upper = prefix;
+  while (!upper.empty() && static_cast<unsigned char>(upper.back()) == 0xff)
+    upper.pop_back();
+  data to;
+  if (!upper.empty()) {
+    upper.back() = static_cast<char>(upper.back() + 1);
+    to = std::move(upper);
+  }
+  auto res = keys_in_range(prefix, std::move(to), limit);
+  if (!res)
+    return res;
+  // Non-string keys may sort into the range; drop everything that does not
+  // actually carry the prefix.
+  set filtered;
+  if (auto xs = get_if<set>(*res))
+    for (auto& key : *xs)
+      if (auto str = get_if<std::string>(key);
+          str && str->compare(0, prefix.size(), prefix) == 0)
+        filtered.insert(filtered.end(), key);
+  return {data{std::move(filtered)}};
+}
+
 publisher_id store::frontend_id() const noexcept {
   auto& hdl = native(frontend_);
   return {facade(hdl.node()), hdl.id()};
@@ -198,12 +386,25 @@ void store::put(data key, data value, std::optional<timespan> expiry) const {
                                                expiry, frontend_id()));
 }
 
+void store::multi_put(std::vector<std::pair<data, data>> entries,
+                      std::optional<timespan> expiry) const {
+  anon_send(native(frontend_), atom::local_v,
+            make_internal_command<multi_put_command>(std::move(entries),
+                                                     expiry, frontend_id()));
+}
+
 void store::erase(data key) const {
   anon_send(
     native(frontend_), atom::local_v,
     make_internal_command<erase_command>(std::move(key), frontend_id()));
 }
 
+void store::multi_erase(std::vector<data> keys) const {
+  anon_send(
+    native(frontend_), atom::local_v,
+    make_internal_command<multi_erase_command>(std::move(keys), frontend_id()));
+}
+
 void store::add(data key, data value, data::type init_type,
                 std::optional<timespan> expiry) const {
   anon_send(native(frontend_), atom::local_v,
@@ -224,6 +425,14 @@ void store::clear() const {
             make_internal_command<clear_command>(frontend_id()));
 }
 
+void store::transact(transaction tx, std::optional<timespan> expiry) const {
+  if (tx.empty())
+    return;
+  anon_send(native(frontend_), atom::local_v,
+            make_internal_command<transaction_command>(std::move(tx.ops_),
+                                                       expiry, frontend_id()));
+}
+
 store::store(worker hdl, std::string name)
   : frontend_{std::move(hdl)}, name_{std::move(name)} {
   // nop
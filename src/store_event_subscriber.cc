@@ -0,0 +1,71 @@
+#include "broker/store_event_subscriber.hh"
+
+#include "broker/endpoint.hh"
+#include "broker/internal/logger.hh"
+#include "broker/message.hh"
+#include "broker/topic.hh"
+
+namespace broker {
+
+store_event_subscriber::event::operator bool() const noexcept {
+  return convertible_to_store_event_type(content_);
+}
+
+store_event::type store_event_subscriber::event::type() const noexcept {
+  store_event::type result{};
+  broker::convert(content_, result);
+  return result;
+}
+
+store_event_subscriber::store_event_subscriber(endpoint& ep,
+                                               std::string store_name,
+                                               size_t max_qsize)
+  : impl_(ep, {topic::store_events() / store_name}, max_qsize) {
+  // nop
+}
+
+store_event_subscriber::value_type
+store_event_subscriber::get(timestamp timeout) {
+  if (auto maybe_msg = impl_.get(timeout))
+    return convert(*maybe_msg);
+  return {};
+}
+
+std::vector<store_event_subscriber::value_type>
+store_event_subscriber::get(size_t num, timestamp timeout) {
+  std::vector<value_type> result;
+  auto msgs = impl_.get(num, timeout);
+  for (auto& msg : msgs)
+    append_converted(result, msg);
+  return result;
+}
+
+std::vector<store_event_subscriber::value_type> store_event_subscriber::poll() {
+  std::vector<value_type> result;
+  auto msgs = impl_.poll();
+  for (auto& msg : msgs)
+    append_converted(result, msg);
+  return result;
+}
+
+store_event_subscriber::value_type
+store_event_subscriber::convert(data_message& msg) {
+  // The event arrives as already-decoded data; wrapping it transfers
+  // ownership without copying the payload.
+  event result{move_data(msg)};
+  if (!result)
+    BROKER_WARNING("received malformed store event");
+  return result;
+}
+
+void store_event_subscriber::append_converted(std::vector<value_type>& result,
+                                              data_message& msg) {
+  if (auto x = convert(msg))
+    result.emplace_back(std::move(x));
+}
+
+void store_event_subscriber::reset() {
+  impl_.reset();
+}
+
+} // namespace broker
@@ -11,9 +11,13 @@
 #include <caf/send.hpp>
 #include <caf/stateful_actor.hpp>
 
+#include "broker/data.hh"
+#include "broker/defaults.hh"
 #include "broker/detail/assert.hh"
+#include "broker/detail/queue_stats.hh"
 #include "broker/endpoint.hh"
 #include "broker/filter_type.hh"
+#include "broker/status.hh"
 #include "broker/internal/endpoint_access.hh"
 #include "broker/internal/logger.hh"
 #include "broker/internal/type_id.hh"
@@ -36,6 +40,16 @@ struct subscriber_worker_state {
 
   bool calculate_rate = true;
 
+  /// Number of consecutive ticks the queue must sit at its high watermark
+  /// before we emit a slow-consumer status. Zero disables the check.
+  size_t stall_threshold = 0;
+
+  /// Consecutive ticks with the queue at or above its high watermark.
+  size_t stalled_ticks = 0;
+
+  /// Guards against emitting the status again before the queue recovered.
+  bool stall_reported = false;
+
   static const char* name;
 
   void tick() {
@@ -64,19 +78,47 @@ public:
   using queue_ptr = detail::shared_subscriber_queue_ptr<>;
 
   subscriber_sink(caf::scheduled_actor* self, subscriber_worker_state* state,
-                  queue_ptr qptr, size_t max_qsize)
+                  queue_ptr qptr, backpressure_options opts)
     : stream_manager(self),
       super(self),
       state_(state),
       queue_(std::move(qptr)),
-      max_qsize_(max_qsize) {
+      opts_(std::move(opts)) {
     // nop
   }
 
   using super::congested;
 
   bool congested(const caf::inbound_path&) const noexcept override {
-    return queue_->buffer_size() >= max_qsize_;
+    // The drop policies bound the queue by discarding, so they never
+    // withhold credit.
+    if (opts_.policy != backpressure_policy::block)
+      return false;
+    auto size = queue_->buffer_size();
+    if (congested_) {
+      if (size <= opts_.low_watermark)
+        congested_ = false;
+    } else if (size >= opts_.high_watermark) {
+      congested_ = true;
+    }
+    return congested_;
+  }
+
+  /// Re-evaluates the watermarks and invokes the congestion callback on
+  /// transitions. Called whenever the queue size changed noteworthily.
+  void check_watermarks() {
+    auto size = queue_->buffer_size();
+    if (!tripped_) {
+      if (size >= opts_.high_watermark) {
+        tripped_ = true;
+        if (opts_.on_congestion)
+          opts_.on_congestion(true);
+      }
+    } else if (size <= opts_.low_watermark) {
+      tripped_ = false;
+      if (opts_.on_congestion)
+        opts_.on_congestion(false);
+    }
   }
 
 protected:
@@ -86,9 +128,24 @@ protected:
     if (x.xs.match_elements<vec_type>()) {
       auto& xs = x.xs.get_mutable_as<vec_type>(0);
       auto xs_size = xs.size();
+      auto qsize = queue_->buffer_size();
+      if (opts_.policy == backpressure_policy::drop_newest
+          && qsize >= opts_.high_watermark) {
+        BROKER_DEBUG("queue full: drop batch of size" << xs_size);
+        queue_->note_dropped(xs_size);
+        check_watermarks();
+        return;
+      }
+      if (opts_.policy == backpressure_policy::drop_oldest
+          && qsize + xs_size > opts_.high_watermark) {
+        auto num = qsize + xs_size - opts_.high_watermark;
+        BROKER_DEBUG("queue full: discard" << num << "oldest messages");
+        queue_->discard_oldest(num);
+      }
       state_->counter += xs_size;
       queue_->produce(xs_size, std::make_move_iterator(xs.begin()),
                       std::make_move_iterator(xs.end()));
+      check_watermarks();
       return;
     }
     BROKER_ERROR("received unexpected batch type (dropped)");
@@ -97,20 +154,29 @@ protected:
 private:
   subscriber_worker_state* state_;
   queue_ptr queue_;
-  size_t max_qsize_;
+  backpressure_options opts_;
+
+  /// Stores whether we currently withhold credit (block policy only).
+  mutable bool congested_ = false;
+
+  /// Stores whether we already reported the high watermark via the callback.
+  bool tripped_ = false;
 };
 
 caf::behavior
 subscriber_worker(caf::stateful_actor<subscriber_worker_state>* self,
                   endpoint* ep, detail::shared_subscriber_queue_ptr<> qptr,
-                  std::vector<topic> ts, size_t max_qsize) {
+                  std::vector<topic> ts, backpressure_options opts) {
+  self->state.stall_threshold
+    = caf::get_or(self->system().config(), "broker.health.slow-consumer-seconds",
+                  defaults::health::slow_consumer_seconds);
   self->send(self * native(ep->core()), atom::join_v, std::move(ts));
   self->set_default_handler(caf::skip);
   return {
     [=](caf::stream<data_message> in) {
       BROKER_ASSERT(qptr != nullptr);
       auto mgr = caf::make_counted<subscriber_sink>(self, &self->state, qptr,
-                                                    max_qsize);
+                                                    opts);
       auto slot = mgr->add_unchecked_inbound_path(in);
       if (slot == caf::invalid_stream_slot) {
         BROKER_WARNING("failed to init stream to subscriber_worker");
@@ -123,10 +189,10 @@ subscriber_worker(caf::stateful_actor<subscriber_worker_state>* self,
       self->delayed_send(self, std::chrono::seconds(1), atom::tick_v);
       self->become(
         [=](atom::resume) {
-          // TODO: nop ?
-          // Triggering the actor should be enough to have it check its mailbox
-          // again in order to handle batches from a previously congested
-          // manager.
+          // Triggering the actor is enough to have it check its mailbox again
+          // in order to handle batches from a previously congested manager.
+          // Also gives us a chance to report drained watermarks.
+          mgr->check_watermarks();
         },
         [=](atom::join a0, atom::update a1, filter_type& f) {
           self->send(native(ep->core()), a0, a1, slot_at_sender, std::move(f));
@@ -139,6 +205,24 @@ subscriber_worker(caf::stateful_actor<subscriber_worker_state>* self,
           auto& st = self->state;
           st.tick();
           qptr->rate(st.rate());
+          if (st.stall_threshold > 0) {
+            if (auto size = qptr->buffer_size();
+                size >= opts.high_watermark) {
+              if (++st.stalled_ticks >= st.stall_threshold
+                  && !st.stall_reported) {
+                st.stall_reported = true;
+                auto stat = status::make<sc::slow_consumer>(
+                  ep->node_id(),
+                  "subscriber queue stuck at its high watermark");
+                self->send(native(ep->core()), atom::publish_v, atom::local_v,
+                           make_data_message(topic::statuses(),
+                                             get_as<data>(stat)));
+              }
+            } else if (size <= opts.low_watermark) {
+              st.stalled_ticks = 0;
+              st.stall_reported = false;
+            }
+          }
           if (st.calculate_rate)
             self->delayed_send(self, std::chrono::seconds(1),
                                atom::tick_v);
@@ -158,16 +242,51 @@ subscriber_worker(caf::stateful_actor<subscriber_worker_state>* self,
 } // namespace <anonymous>
 
 subscriber::subscriber(endpoint& ep, std::vector<topic> ts, size_t max_qsize)
+  : subscriber(ep, std::move(ts), max_qsize, backpressure_options{}) {
+  // nop
+}
+
+subscriber::subscriber(endpoint& ep, std::vector<topic> ts, size_t max_qsize,
+                       backpressure_options opts, queue_type::observer obs,
+                       int numa_node)
   : super(max_qsize), filter_(std::move(ts)), ep_(&ep) {
   BROKER_INFO("creating subscriber for topic(s)" << filter_);
+  if (opts.high_watermark == 0)
+    opts.high_watermark = max_qsize;
+  if (opts.low_watermark == 0)
+    opts.low_watermark = opts.high_watermark / 2;
   auto& sys = internal::endpoint_access{ep_}.sys();
-  auto hdl = sys.spawn(subscriber_worker, ep_, queue_, filter_, max_qsize);
+  // Attaching must happen before spawning the worker, i.e., before the queue
+  // gains a second thread.
+  if (obs)
+    queue_->attach_observer(std::move(obs));
+  queue_->attach_stats(detail::make_queue_stats(ep, "subscriber", filter_));
+  queue_->attach_accounting(ep.memory_accountant());
+  queue_->spin_count(caf::get_or(sys.config(), "broker.subscriber.spin-count",
+                                 defaults::subscriber::spin_count));
+  if (numa_node >= 0)
+    queue_->set_numa_node(numa_node);
+  auto hdl
+    = sys.spawn(subscriber_worker, ep_, queue_, filter_, std::move(opts));
   worker_ = facade(hdl);
 }
 
+subscriber::subscriber(endpoint& ep, std::vector<topic> ts, size_t max_qsize,
+                       direct_tag)
+  : super(max_qsize), filter_(std::move(ts)), ep_(&ep), direct_(true) {
+  BROKER_INFO("creating direct subscriber for topic(s)" << filter_);
+  queue_->attach_stats(detail::make_queue_stats(ep, "subscriber", filter_));
+  queue_->attach_accounting(ep.memory_accountant());
+  queue_->spin_count(
+    caf::get_or(internal::endpoint_access{ep_}.sys().config(),
+                "broker.subscriber.spin-count",
+                defaults::subscriber::spin_count));
+  caf::anon_send(native(ep_->core()), atom::join_v, atom::local_v, filter_,
+                 queue_);
+}
+
 subscriber::~subscriber() {
-  if (worker_)
-    caf::anon_send_exit(native(worker_), caf::exit_reason::user_shutdown);
+  reset();
 }
 
 size_t subscriber::rate() const {
@@ -180,7 +299,10 @@ void subscriber::add_topic(topic x, bool block) {
   auto i = std::find(filter_.begin(), e, x);
   if (i == e) {
     filter_.emplace_back(std::move(x));
-    if (block) {
+    if (direct_) {
+      caf::anon_send(native(ep_->core()), atom::join_v, atom::local_v, filter_,
+                     queue_);
+    } else if (block) {
       caf::scoped_actor self{internal::endpoint_access{ep_}.sys()};
       self->send(native(worker_), atom::join_v, atom::update_v, filter_, self);
       self->receive([&](bool){});
@@ -196,7 +318,10 @@ void subscriber::remove_topic(topic x, bool block) {
   auto i = std::find(filter_.begin(), e, x);
   if (i != filter_.end()) {
     filter_.erase(i);
-    if (block) {
+    if (direct_) {
+      caf::anon_send(native(ep_->core()), atom::join_v, atom::local_v, filter_,
+                     queue_);
+    } else if (block) {
       caf::scoped_actor self{internal::endpoint_access{ep_}.sys()};
       self->send(native(worker_), atom::join_v, atom::update_v, filter_, self);
       self->receive([&](bool){});
@@ -207,14 +332,22 @@ void subscriber::remove_topic(topic x, bool block) {
 }
 
 void subscriber::set_rate_calculation(bool x) {
-  caf::anon_send(native(worker_), atom::tick_v, x);
+  if (worker_)
+    caf::anon_send(native(worker_), atom::tick_v, x);
 }
 
 void subscriber::became_not_full() {
-  caf::anon_send(native(worker_), atom::resume_v);
+  if (worker_)
+    caf::anon_send(native(worker_), atom::resume_v);
 }
 
 void subscriber::reset() {
+  if (direct_) {
+    if (queue_)
+      caf::anon_send(native(ep_->core()), atom::join_v, atom::local_v,
+                     filter_type{}, queue_);
+    direct_ = false;
+  }
   if (!worker_)
     return;
   caf::anon_send_exit(native(worker_), caf::exit_reason::user_shutdown);
@@ -1,6 +1,7 @@
 #include "broker/telemetry/counter.hh"
 
 #include "broker/internal/with_native_labels.hh"
+#include "broker/telemetry/shards.hh"
 
 #include <caf/telemetry/counter.hpp>
 #include <caf/telemetry/metric_family.hpp>
@@ -27,14 +28,15 @@ auto& deref(metric_family_hdl* hdl) {
 } // namespace
 
 void inc(dbl_counter_hdl* hdl) noexcept {
-  deref(hdl).inc();
+  shards::add(hdl, 1.0);
 }
 
 void inc(dbl_counter_hdl* hdl, double amount) noexcept {
-  deref(hdl).inc(amount);
+  shards::add(hdl, amount);
 }
 
 double value(dbl_counter_hdl* hdl) noexcept {
+  shards::flush();
   return deref(hdl).value();
 }
 
@@ -48,14 +50,18 @@ dbl_counter_hdl* dbl_counter_get_or_add(metric_family_hdl* hdl,
 }
 
 int64_t inc(int_counter_hdl* hdl) noexcept {
+  // Callers of the value-returning increment need the post-increment value,
+  // which only the shared atomic can provide; this variant stays direct.
+  shards::flush();
   return ++deref(hdl);
 }
 
 void inc(int_counter_hdl* hdl, int64_t amount) noexcept {
-  deref(hdl).inc(amount);
+  shards::add(hdl, amount);
 }
 
 int64_t value(int_counter_hdl* hdl) noexcept {
+  shards::flush();
   return deref(hdl).value();
 }
 
@@ -2,6 +2,7 @@
 
 #include "broker/detail/assert.hh"
 #include "broker/internal/with_native_labels.hh"
+#include "broker/telemetry/shards.hh"
 
 #include <caf/telemetry/histogram.hpp>
 #include <caf/telemetry/metric_family.hpp>
@@ -28,10 +29,11 @@ auto& deref(metric_family_hdl* hdl) {
 } // namespace
 
 void observe(dbl_histogram_hdl* hdl, double value) noexcept {
-  deref(hdl).observe(value);
+  shards::observe(hdl, value);
 }
 
 double sum(dbl_histogram_hdl* hdl) noexcept {
+  shards::flush();
   return deref(hdl).sum();
 }
 
@@ -40,6 +42,7 @@ size_t num_buckets(dbl_histogram_hdl* hdl) noexcept {
 }
 
 double count_at(dbl_histogram_hdl* hdl, size_t index) noexcept {
+  shards::flush();
   auto xs = deref(hdl).buckets();
   BROKER_ASSERT(index < xs.size());
   return xs[index].count.value();
@@ -61,10 +64,11 @@ dbl_histogram_hdl* dbl_histogram_get_or_add(metric_family_hdl* hdl,
 }
 
 void observe(int_histogram_hdl* hdl, int64_t value) noexcept {
-  deref(hdl).observe(value);
+  shards::observe(hdl, value);
 }
 
 int64_t sum(int_histogram_hdl* hdl) noexcept {
+  shards::flush();
   return deref(hdl).sum();
 }
 
@@ -73,6 +77,7 @@ size_t num_buckets(int_histogram_hdl* hdl) noexcept {
 }
 
 int64_t count_at(int_histogram_hdl* hdl, size_t index) noexcept {
+  shards::flush();
   auto xs = deref(hdl).buckets();
   BROKER_ASSERT(index < xs.size());
   return xs[index].count.value();
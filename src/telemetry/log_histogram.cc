@@ -0,0 +1,169 @@
+#include "broker/telemetry/log_histogram.hh"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+#include "broker/detail/assert.hh"
+
+namespace broker::telemetry {
+
+namespace {
+
+/// Protects the process-wide list of instances.
+struct instances_registry {
+  std::mutex mtx;
+  std::vector<log_histogram> list;
+};
+
+instances_registry& instances() {
+  static instances_registry result;
+  return result;
+}
+
+} // namespace
+
+struct log_histogram::impl {
+  std::string prefix;
+  std::string name;
+  std::string helptext;
+  std::string unit;
+  int min_exponent;
+  int max_exponent;
+  int subbucket_bits;
+  /// Upper bounds of the explicit buckets; the overflow bucket is implicit.
+  std::vector<double> bounds;
+  /// One counter per bucket, including the overflow bucket. The cells are
+  /// only ever read during a scrape, so all accesses are relaxed.
+  std::unique_ptr<std::atomic<int64_t>[]> cells;
+  std::atomic<double> sum{0};
+};
+
+std::vector<double> log_linear_bounds(int min_exponent, int max_exponent,
+                                      int subbucket_bits) {
+  BROKER_ASSERT(min_exponent < max_exponent);
+  BROKER_ASSERT(subbucket_bits >= 0 && subbucket_bits <= 8);
+  auto subbuckets = size_t{1} << subbucket_bits;
+  std::vector<double> result;
+  result.reserve(1 + (max_exponent - min_exponent) * subbuckets);
+  result.emplace_back(std::ldexp(1.0, min_exponent));
+  for (auto e = min_exponent; e < max_exponent; ++e)
+    for (size_t k = 1; k <= subbuckets; ++k)
+      result.emplace_back(
+        std::ldexp(1.0 + static_cast<double>(k) / subbuckets, e));
+  return result;
+}
+
+log_histogram log_histogram::get_or_add(std::string_view pre,
+                                        std::string_view name,
+                                        int min_exponent, int max_exponent,
+                                        int subbucket_bits,
+                                        std::string_view helptext,
+                                        std::string_view unit) {
+  auto& reg = instances();
+  std::lock_guard<std::mutex> guard{reg.mtx};
+  for (auto& hdl : reg.list)
+    if (hdl.prefix() == pre && hdl.name() == name)
+      return hdl;
+  auto ptr = std::make_shared<impl>();
+  ptr->prefix = std::string{pre};
+  ptr->name = std::string{name};
+  ptr->helptext = std::string{helptext};
+  ptr->unit = std::string{unit};
+  ptr->min_exponent = min_exponent;
+  ptr->max_exponent = max_exponent;
+  ptr->subbucket_bits = subbucket_bits;
+  ptr->bounds = log_linear_bounds(min_exponent, max_exponent, subbucket_bits);
+  auto num_cells = ptr->bounds.size() + 1;
+  ptr->cells = std::make_unique<std::atomic<int64_t>[]>(num_cells);
+  for (size_t index = 0; index < num_cells; ++index)
+    ptr->cells[index].store(0, std::memory_order_relaxed);
+  auto result = log_histogram{std::move(ptr)};
+  reg.list.push_back(result);
+  return result;
+}
+
+void log_histogram::observe(double value) noexcept {
+  auto& st = *impl_;
+  st.cells[index_of(value)].fetch_add(1, std::memory_order_relaxed);
+  auto old = st.sum.load(std::memory_order_relaxed);
+  while (!st.sum.compare_exchange_weak(old, old + value,
+                                       std::memory_order_relaxed)) {
+    // repeat
+  }
+}
+
+size_t log_histogram::index_of(double value) const noexcept {
+  auto& st = *impl_;
+  // The comparison also sorts NaN, negative values and zero into the
+  // underflow bucket.
+  if (!(value > st.bounds.front()))
+    return 0;
+  if (value > st.bounds.back())
+    return st.bounds.size();
+  // Pull the bucket index straight out of the IEEE 754 representation: the
+  // exponent selects the power-of-two range and the leading mantissa bits
+  // select the linear sub-bucket within it.
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  auto exponent = static_cast<int>((bits >> 52) & 0x7ff) - 1023;
+  auto mantissa = bits & ((uint64_t{1} << 52) - 1);
+  auto sub = mantissa >> (52 - st.subbucket_bits);
+  // Values exactly on a bucket bound belong to the bucket they bound.
+  if ((mantissa & ((uint64_t{1} << (52 - st.subbucket_bits)) - 1)) == 0) {
+    if (sub == 0) {
+      --exponent;
+      sub = (uint64_t{1} << st.subbucket_bits) - 1;
+    } else {
+      --sub;
+    }
+  }
+  return 1
+         + (static_cast<size_t>(exponent - st.min_exponent)
+            << st.subbucket_bits)
+         + static_cast<size_t>(sub);
+}
+
+double log_histogram::sum() const noexcept {
+  return impl_->sum.load(std::memory_order_relaxed);
+}
+
+size_t log_histogram::num_buckets() const noexcept {
+  return impl_->bounds.size() + 1;
+}
+
+int64_t log_histogram::count_at(size_t index) const noexcept {
+  return impl_->cells[index].load(std::memory_order_relaxed);
+}
+
+double log_histogram::upper_bound_at(size_t index) const noexcept {
+  auto& bounds = impl_->bounds;
+  return index < bounds.size() ? bounds[index]
+                               : std::numeric_limits<double>::infinity();
+}
+
+const std::string& log_histogram::prefix() const noexcept {
+  return impl_->prefix;
+}
+
+const std::string& log_histogram::name() const noexcept {
+  return impl_->name;
+}
+
+const std::string& log_histogram::helptext() const noexcept {
+  return impl_->helptext;
+}
+
+const std::string& log_histogram::unit() const noexcept {
+  return impl_->unit;
+}
+
+std::vector<log_histogram> log_histograms() {
+  auto& reg = instances();
+  std::lock_guard<std::mutex> guard{reg.mtx};
+  return reg.list;
+}
+
+} // namespace broker::telemetry
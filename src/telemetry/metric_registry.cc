@@ -241,4 +241,14 @@ metric_registry metric_registry::from(broker::endpoint& where) {
   return metric_registry{new post_init_impl(std::move(ctx)), false};
 }
 
+log_histogram metric_registry::log_histogram_singleton(
+  std::string_view pre, std::string_view name, int min_exponent,
+  int max_exponent, int subbucket_bits, std::string_view helptext,
+  std::string_view unit) {
+  // Log histograms keep their cells outside of the CAF registry, so this
+  // works with any registry handle, including the pre-init instance.
+  return log_histogram::get_or_add(pre, name, min_exponent, max_exponent,
+                                   subbucket_bits, helptext, unit);
+}
+
 } // namespace broker::telemetry
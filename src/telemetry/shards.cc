@@ -0,0 +1,146 @@
+#include "broker/telemetry/shards.hh"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <caf/telemetry/counter.hpp>
+#include <caf/telemetry/histogram.hpp>
+
+namespace ct = caf::telemetry;
+
+namespace broker::telemetry::shards {
+
+namespace {
+
+/// Observations to buffer per histogram cell before replaying them into the
+/// shared metric. Bounds the per-thread memory and amortizes the contended
+/// atomic updates without delaying scrapes (which flush explicitly).
+constexpr size_t max_buffered_observations = 64;
+
+/// Holds the pending updates of one thread. The mutex is virtually always
+/// uncontended: the owning thread takes it on every update, other threads
+/// only during a flush.
+struct thread_cells {
+  std::mutex mtx;
+  std::unordered_map<int_counter_hdl*, int64_t> int_deltas;
+  std::unordered_map<dbl_counter_hdl*, double> dbl_deltas;
+  std::unordered_map<int_histogram_hdl*, std::vector<int64_t>> int_samples;
+  std::unordered_map<dbl_histogram_hdl*, std::vector<double>> dbl_samples;
+};
+
+struct cells_registry {
+  std::mutex mtx;
+  // Records outlive their threads, so pending updates of short-lived threads
+  // still reach the next flush.
+  std::vector<std::shared_ptr<thread_cells>> records;
+};
+
+cells_registry& registry() {
+  static cells_registry instance;
+  return instance;
+}
+
+thread_cells& local_cells() {
+  thread_local std::shared_ptr<thread_cells> rec = [] {
+    auto result = std::make_shared<thread_cells>();
+    auto& reg = registry();
+    std::lock_guard<std::mutex> guard{reg.mtx};
+    reg.records.push_back(result);
+    return result;
+  }();
+  return *rec;
+}
+
+auto& deref(int_counter_hdl* hdl) {
+  return *reinterpret_cast<ct::int_counter*>(hdl);
+}
+
+auto& deref(dbl_counter_hdl* hdl) {
+  return *reinterpret_cast<ct::dbl_counter*>(hdl);
+}
+
+auto& deref(int_histogram_hdl* hdl) {
+  return *reinterpret_cast<ct::int_histogram*>(hdl);
+}
+
+auto& deref(dbl_histogram_hdl* hdl) {
+  return *reinterpret_cast<ct::dbl_histogram*>(hdl);
+}
+
+/// Replays buffered updates into the shared metrics. The metrics themselves
+/// are thread-safe, so draining the cells of another thread is fine.
+void drain(thread_cells& cells) {
+  for (auto& [hdl, delta] : cells.int_deltas)
+    if (delta != 0)
+      deref(hdl).inc(delta);
+  cells.int_deltas.clear();
+  for (auto& [hdl, delta] : cells.dbl_deltas)
+    if (delta != 0)
+      deref(hdl).inc(delta);
+  cells.dbl_deltas.clear();
+  for (auto& [hdl, samples] : cells.int_samples) {
+    for (auto value : samples)
+      deref(hdl).observe(value);
+    samples.clear();
+  }
+  for (auto& [hdl, samples] : cells.dbl_samples) {
+    for (auto value : samples)
+      deref(hdl).observe(value);
+    samples.clear();
+  }
+}
+
+} // namespace
+
+void add(int_counter_hdl* hdl, int64_t amount) noexcept {
+  auto& cells = local_cells();
+  std::lock_guard<std::mutex> guard{cells.mtx};
+  cells.int_deltas[hdl] += amount;
+}
+
+void add(dbl_counter_hdl* hdl, double amount) noexcept {
+  auto& cells = local_cells();
+  std::lock_guard<std::mutex> guard{cells.mtx};
+  cells.dbl_deltas[hdl] += amount;
+}
+
+void observe(int_histogram_hdl* hdl, int64_t value) {
+  auto& cells = local_cells();
+  std::lock_guard<std::mutex> guard{cells.mtx};
+  auto& samples = cells.int_samples[hdl];
+  samples.push_back(value);
+  if (samples.size() >= max_buffered_observations) {
+    for (auto x : samples)
+      deref(hdl).observe(x);
+    samples.clear();
+  }
+}
+
+void observe(dbl_histogram_hdl* hdl, double value) {
+  auto& cells = local_cells();
+  std::lock_guard<std::mutex> guard{cells.mtx};
+  auto& samples = cells.dbl_samples[hdl];
+  samples.push_back(value);
+  if (samples.size() >= max_buffered_observations) {
+    for (auto x : samples)
+      deref(hdl).observe(x);
+    samples.clear();
+  }
+}
+
+void flush() {
+  std::vector<std::shared_ptr<thread_cells>> records;
+  {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> guard{reg.mtx};
+    records = reg.records;
+  }
+  for (auto& rec : records) {
+    std::lock_guard<std::mutex> guard{rec->mtx};
+    drain(*rec);
+  }
+}
+
+} // namespace broker::telemetry::shards
@@ -1,11 +1,12 @@
 #include "broker/time.hh"
 
+#include "broker/detail/time_format.hh"
+
 namespace broker {
 
 bool convert(timespan s, std::string& str) {
-  using std::to_string;
-  str = to_string(s.count());
-  str += "ns";
+  char buf[detail::max_timespan_chars];
+  str.assign(buf, detail::format_timespan(s, buf));
   return true;
 }
 
@@ -20,7 +21,9 @@ bool convert(timespan s, double& secs) {
 }
 
 bool convert(timestamp t, std::string& str) {
-  return convert(t.time_since_epoch(), str);
+  char buf[detail::max_iso8601_chars];
+  str.assign(buf, detail::format_iso8601(t, buf));
+  return true;
 }
 
 bool convert(timestamp t, double& secs) {
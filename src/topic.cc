@@ -51,6 +51,18 @@ bool topic::prefix_of(const topic& t) const {
   return is_prefix(t, str_);
 }
 
+bool topic::contains_wildcard() const noexcept {
+  std::string_view str = str_;
+  for (auto pos = str.find('*'); pos != std::string_view::npos;
+       pos = str.find('*', pos + 1)) {
+    auto at_start = pos == 0 || str[pos - 1] == sep;
+    auto at_end = pos + 1 == str.size() || str[pos + 1] == sep;
+    if (at_start && at_end)
+      return true;
+  }
+  return false;
+}
+
 std::string_view topic::suffix() const noexcept {
   if (auto index = str_.find_last_of(sep); index != std::string::npos) {
     auto first = index + 1;
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Compares two benchmark result files and flags regressions.
+
+Both inputs are JSON documents as written by broker-benchmark or
+broker-cluster-benchmark via --json-output. The script flattens all numeric
+leaves, matches them by path, and reports every metric that moved in the bad
+direction by more than the configured threshold. Metrics whose path mentions
+latency, rss or seconds count as lower-is-better; everything else (throughput,
+message counts) counts as higher-is-better. When a leaf is a list of samples,
+a Welch t-test decides whether the difference is statistically significant
+before the threshold applies.
+
+Exit code is 1 if at least one regression was found, 0 otherwise.
+"""
+
+import argparse
+import json
+import math
+import sys
+
+LOWER_IS_BETTER = ("latency", "rss", "seconds", "cv")
+
+
+def flatten(obj, prefix=""):
+    """Yields (path, value) pairs for all numeric or numeric-list leaves."""
+    if isinstance(obj, dict):
+        for key, value in obj.items():
+            yield from flatten(value, f"{prefix}.{key}" if prefix else key)
+    elif isinstance(obj, list):
+        if obj and all(isinstance(x, (int, float)) for x in obj):
+            yield prefix, obj
+    elif isinstance(obj, (int, float)) and not isinstance(obj, bool):
+        yield prefix, obj
+
+
+def lower_is_better(path):
+    return any(token in path for token in LOWER_IS_BETTER)
+
+
+def welch_t(xs, ys):
+    """Returns the Welch t statistic for two sample lists, or None if the
+    samples carry no usable variance information."""
+    n1, n2 = len(xs), len(ys)
+    if n1 < 2 or n2 < 2:
+        return None
+    m1, m2 = sum(xs) / n1, sum(ys) / n2
+    v1 = sum((x - m1) ** 2 for x in xs) / (n1 - 1)
+    v2 = sum((y - m2) ** 2 for y in ys) / (n2 - 1)
+    denom = math.sqrt(v1 / n1 + v2 / n2)
+    if denom == 0:
+        return None
+    return (m1 - m2) / denom
+
+
+def as_scalar(value):
+    if isinstance(value, list):
+        return sum(value) / len(value)
+    return value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline", help="JSON results of the baseline build")
+    parser.add_argument("current", help="JSON results of the current build")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="relative change that counts as a regression "
+                             "(default: 0.05)")
+    parser.add_argument("--t-critical", type=float, default=2.0,
+                        help="minimum |t| for sample lists to count as a "
+                             "significant change (default: 2.0)")
+    args = parser.parse_args()
+    with open(args.baseline) as f:
+        baseline = dict(flatten(json.load(f)))
+    with open(args.current) as f:
+        current = dict(flatten(json.load(f)))
+    regressions = []
+    for path in sorted(baseline.keys() & current.keys()):
+        old, new = baseline[path], current[path]
+        if isinstance(old, list) and isinstance(new, list):
+            t = welch_t(old, new)
+            if t is not None and abs(t) < args.t_critical:
+                continue
+        old, new = as_scalar(old), as_scalar(new)
+        if old == 0:
+            continue
+        change = (new - old) / abs(old)
+        worse = change > 0 if lower_is_better(path) else change < 0
+        if worse and abs(change) > args.threshold:
+            regressions.append((path, old, new, change))
+        else:
+            print(f"ok: {path}: {old:g} -> {new:g} ({change:+.1%})")
+    for path, old, new, change in regressions:
+        print(f"REGRESSION: {path}: {old:g} -> {new:g} ({change:+.1%})")
+    if not baseline.keys() & current.keys():
+        print("error: no common metrics between the two input files",
+              file=sys.stderr)
+        return 2
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,8 +1,10 @@
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <mutex>
 #include <string>
@@ -10,6 +12,8 @@
 #include <utility>
 #include <vector>
 
+#include <sys/resource.h>
+
 #include "broker/configuration.hh"
 #include "broker/convert.hh"
 #include "broker/data.hh"
@@ -17,6 +21,7 @@
 #include "broker/publisher.hh"
 #include "broker/status.hh"
 #include "broker/status_subscriber.hh"
+#include "broker/telemetry/log_histogram.hh"
 #include "broker/topic.hh"
 #include "broker/zeek.hh"
 
@@ -31,8 +36,10 @@ double rate_increase_interval = 0;
 double rate_increase_amount = 0;
 uint64_t max_received = 0;
 uint64_t max_in_flight = 0;
+double open_loop_rate = 0;
 bool server = false;
 bool verbose = false;
+std::string json_output;
 
 // Global state
 size_t total_recv;
@@ -42,6 +49,102 @@ double last_t;
 
 std::atomic<size_t> num_events;
 
+// Tracks one-way latencies of events that lead with a timestamp argument
+// (server mode). Log-linear buckets from ~1us to 16s give HDR-style
+// resolution without a per-observation bucket scan.
+telemetry::log_histogram& latency_histogram() {
+  static auto instance = telemetry::log_histogram::get_or_add(
+    "benchmark", "latency", -20, 4, 3, "One-way event latency.", "seconds");
+  return instance;
+}
+
+std::atomic<int64_t> max_latency_ns;
+
+void record_latency(const vector& args) {
+  if (args.empty() || !is<timestamp>(args[0]))
+    return;
+  auto lat = broker::now() - get<timestamp>(args[0]);
+  if (lat.count() <= 0)
+    return;
+  latency_histogram().observe(std::chrono::duration<double>(lat).count());
+  auto old = max_latency_ns.load();
+  while (lat.count() > old)
+    if (max_latency_ns.compare_exchange_weak(old, lat.count()))
+      break;
+}
+
+// Returns the upper bound of the bucket holding the q-quantile.
+double latency_percentile(double q, int64_t total) {
+  auto& h = latency_histogram();
+  auto target = static_cast<int64_t>(std::ceil(q * total));
+  int64_t cum = 0;
+  for (size_t i = 0; i < h.num_buckets(); ++i) {
+    cum += h.count_at(i);
+    if (cum >= target)
+      return h.upper_bound_at(i);
+  }
+  return h.upper_bound_at(h.num_buckets() - 1);
+}
+
+void print_latency_report() {
+  auto& h = latency_histogram();
+  int64_t total = 0;
+  for (size_t i = 0; i < h.num_buckets(); ++i)
+    total += h.count_at(i);
+  if (total == 0)
+    return;
+  auto ms = [](double seconds) { return seconds * 1e3; };
+  std::cerr << "latency (ms): p50=" << ms(latency_percentile(.5, total))
+            << " p99=" << ms(latency_percentile(.99, total))
+            << " p99.9=" << ms(latency_percentile(.999, total))
+            << " max=" << max_latency_ns.load() / 1e6 << " (n=" << total << ")"
+            << std::endl;
+}
+
+// Peak resident set size of this process in bytes.
+int64_t max_rss_bytes() {
+  rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0)
+    return 0;
+#ifdef __APPLE__
+  return ru.ru_maxrss; // Reported in bytes.
+#else
+  return ru.ru_maxrss * 1024; // Reported in KiB.
+#endif
+}
+
+// Writes the final results in the shared benchmark schema, so
+// bench-compare.py can diff runs across builds.
+void write_json_results(size_t events, double runtime) {
+  std::ofstream out{json_output};
+  if (!out) {
+    std::cerr << "unable to open JSON output file: " << json_output
+              << std::endl;
+    return;
+  }
+  auto& h = latency_histogram();
+  int64_t samples = 0;
+  for (size_t i = 0; i < h.num_buckets(); ++i)
+    samples += h.count_at(i);
+  out << "{\n"
+      << "  \"schema-version\": 1,\n"
+      << "  \"tool\": \"broker-benchmark\",\n"
+      << "  \"results\": {\n"
+      << "    \"events-received\": " << events << ",\n"
+      << "    \"runtime-seconds\": " << runtime << ",\n"
+      << "    \"throughput\": " << (runtime > 0 ? events / runtime : 0.)
+      << ",\n"
+      << "    \"max-rss-bytes\": " << max_rss_bytes();
+  if (samples > 0)
+    out << ",\n    \"latency-seconds\": {"
+        << "\"p50\": " << latency_percentile(.5, samples)
+        << ", \"p99\": " << latency_percentile(.99, samples)
+        << ", \"p999\": " << latency_percentile(.999, samples)
+        << ", \"max\": " << max_latency_ns.load() / 1e9
+        << ", \"samples\": " << samples << "}";
+  out << "\n  }\n}\n";
+}
+
 size_t reset_num_events() {
   auto result = num_events.load();
   if (result == 0)
@@ -225,6 +328,60 @@ void receivedStats(endpoint& ep, const data& x) {
     max_exceeded_counter = 0;
 }
 
+// Publishes events at a fixed target rate on a schedule that does not depend
+// on the pipeline: when the sender falls behind, it catches up by sending all
+// overdue events instead of silently stretching the interval. Events carry
+// their *scheduled* send time as first argument, so receivers measure latency
+// from when the message should have left (no coordinated omission).
+void open_loop_publish(endpoint& ep, status_subscriber& ss) {
+  using std::chrono::duration_cast;
+  using fractional_second = std::chrono::duration<double>;
+  auto p = ep.make_publisher("/benchmark/events");
+  auto name = "event_" + std::to_string(event_type);
+  auto interval = duration_cast<timespan>(fractional_second{1.0}
+                                          / open_loop_rate);
+  if (interval.count() <= 0)
+    interval = timespan{1};
+  auto deadline = std::chrono::system_clock::now();
+  auto report_at = deadline + std::chrono::seconds(1);
+  size_t sent = 0;
+  size_t late = 0;
+  timespan max_lag{0};
+  for (;;) {
+    deadline += interval;
+    // Returns immediately when we are behind schedule.
+    std::this_thread::sleep_until(deadline);
+    auto stamp = timestamp{duration_cast<timespan>(
+      deadline.time_since_epoch())};
+    auto args = createEventArgs();
+    if (!args.empty() && is<timestamp>(args[0]))
+      args[0] = stamp; // Types 2 and 3 already lead with a timestamp.
+    else
+      args.insert(args.begin(), stamp);
+    p.publish(zeek::Event(std::string(name), std::move(args)));
+    ++sent;
+    ++total_sent;
+    auto now = std::chrono::system_clock::now();
+    if (now > deadline) {
+      ++late;
+      max_lag = std::max(max_lag, duration_cast<timespan>(now - deadline));
+    }
+    if (now >= report_at) {
+      std::cerr << "open-loop: target=" << open_loop_rate << " ev/s sent="
+                << sent << " late=" << late
+                << " max-lag-ms=" << max_lag.count() / 1e6 << std::endl;
+      late = 0;
+      max_lag = timespan{0};
+      report_at += std::chrono::seconds(1);
+      auto status_events = ss.poll();
+      if (verbose)
+        for (auto& ev : status_events)
+          std::visit([](auto& x) { std::cout << to_string(x) << std::endl; },
+                     ev);
+    }
+  }
+}
+
 void client_mode(endpoint& ep, const std::string& host, int port) {
   // Make sure to receive status updates.
   auto ss = ep.make_status_subscriber(true);
@@ -254,6 +411,10 @@ void client_mode(endpoint& ep, const std::string& host, int port) {
   }
   if (verbose)
     std::cout << "*** endpoint is now peering to remote" << std::endl;
+  if (open_loop_rate > 0) {
+    open_loop_publish(ep, ss);
+    return; // Unreachable, open_loop_publish never returns.
+  }
   if (batch_rate == 0) {
     ep.publish_all(
       [] {
@@ -329,10 +490,17 @@ void server_mode(endpoint& ep, const std::string& iface, int port) {
       auto msg = move_data(x);
       // Count number of events (counts each element in a batch as one event).
       if (zeek::Message::type(msg) == zeek::Message::Type::Event) {
+        zeek::Event event(std::move(msg));
+        record_latency(event.args());
         ++num_events;
       } else if (zeek::Message::type(msg) == zeek::Message::Type::Batch) {
         zeek::Batch batch(std::move(msg));
         num_events += batch.batch().size();
+        for (auto& x : batch.batch())
+          if (zeek::Message::type(x) == zeek::Message::Type::Event) {
+            zeek::Event event(x);
+            record_latency(event.args());
+          }
       } else {
         std::cerr << "unexpected message type" << std::endl;
         exit(1);
@@ -360,18 +528,23 @@ void server_mode(endpoint& ep, const std::string& iface, int port) {
   // Collects stats once per second until receiving stop message.
   using std::chrono::duration_cast;
   timestamp timeout = std::chrono::system_clock::now();
+  auto t0 = timeout;
   auto last_time = timeout;
+  size_t lifetime_events = 0;
   while (!terminate) {
     // Sleep until next timeout.
     timeout += std::chrono::seconds(1);
     std::this_thread::sleep_until(timeout);
     // Generate and publish zeek event.
     timestamp now = std::chrono::system_clock::now();
-    auto stats = vector{now, now - last_time, count{reset_num_events()}};
+    auto received = reset_num_events();
+    lifetime_events += received;
+    auto stats = vector{now, now - last_time, count{received}};
     if (verbose)
       std::cout << "stats: " << to_string(stats) << std::endl;
     zeek::Event ev("stats_update", std::move(stats));
     ep.publish("/benchmark/stats", std::move(ev));
+    print_latency_report();
     // Advance time and print status events.
     last_time = now;
     auto status_events = ss.poll();
@@ -380,6 +553,13 @@ void server_mode(endpoint& ep, const std::string& iface, int port) {
         std::visit([](auto& x) { std::cout << to_string(x) << std::endl; }, ev);
   }
   std::cout << "received stop message on /benchmark/terminate" << std::endl;
+  print_latency_report();
+  if (!json_output.empty()) {
+    lifetime_events += reset_num_events();
+    auto runtime = std::chrono::duration<double>(std::chrono::system_clock::now()
+                                                 - t0);
+    write_json_results(lifetime_events, runtime.count());
+  }
 }
 
 void add_options(configuration& cfg) {
@@ -396,8 +576,14 @@ void add_options(configuration& cfg) {
                  "stop benchmark after given count");
   cfg.add_option(&max_in_flight, "max-in-flight,f",
                  "report when exceeding this count");
+  cfg.add_option(&open_loop_rate, "open-loop-rate,o",
+                 "publish at this fixed rate (events/sec) on a schedule "
+                 "independent of the pipeline and stamp each event with its "
+                 "scheduled send time (default: 0, i.e., closed-loop)");
   cfg.add_option(&server, "server", "run in server mode");
   cfg.add_option(&verbose, "verbose", "enable status output");
+  cfg.add_option(&json_output, "json-output,j",
+                 "write results as JSON to this file on exit (server mode)");
 }
 
 void usage(const configuration& cfg, const char* cmd_name) {
@@ -1,8 +1,12 @@
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <numeric>
+#include <sstream>
 #include <string>
 #include <thread>
 
@@ -18,6 +22,16 @@
 #include <caf/string_algorithms.hpp>
 #include <caf/term.hpp>
 
+#include "broker/config.hh"
+
+#ifndef BROKER_WINDOWS
+#  include <sys/resource.h>
+#  include <unistd.h>
+#  ifdef __GLIBC__
+#    include <malloc.h>
+#  endif
+#endif
+
 #include "broker/configuration.hh"
 #include "broker/detail/filesystem.hh"
 #include "broker/endpoint.hh"
@@ -26,6 +40,7 @@
 #include "broker/internal/generator_file_writer.hh"
 #include "broker/internal/native.hh"
 #include "broker/internal/type_id.hh"
+#include "broker/internal/workload_generator.hh"
 #include "broker/subscriber.hh"
 
 using broker::internal::native;
@@ -185,11 +200,39 @@ struct config : actor_system_config {
       .add<string>(
         "mode",
         "one of: benchmark (default), dump-stats (print stats for generator "
-        "files), generate-config (create a config for given recording), or "
-        "shrink-generator-file (reduce entries in a .dat file)")
+        "files), generate-config (create a config for given recording), "
+        "generate-workload (create a synthetic .dat file from distribution "
+        "parameters), or shrink-generator-file (reduce entries in a .dat "
+        "file)")
       .add<bool>("verbose,v", "enable verbose output")
       .add<string_list>("excluded-nodes,e",
-                        "excludes given nodes from the setup");
+                        "excludes given nodes from the setup")
+      .add<size_t>("warmup,w",
+                   "seconds excluded from the measured window as connection "
+                   "warm-up (default: 1)")
+      .add<string>("json-output,j",
+                   "path for writing per-node, per-phase results as JSON "
+                   "('-' for STDOUT)")
+      .add<size_t>("prefetch-depth",
+                   "number of generator file entries to decode ahead of the "
+                   "replay; 0 disables prefetching (default: 64)");
+    opt_group{custom_options_, "workload"}
+      .add<size_t>("num-messages",
+                   "messages to generate in generate-workload mode "
+                   "(default: 10000)")
+      .add<size_t>("num-topics", "number of distinct topics (default: 10)")
+      .add<double>("topic-skew",
+                   "Zipf exponent for topic popularity; 0 = uniform "
+                   "(default: 0)")
+      .add<size_t>("value-size-median",
+                   "median payload size in bytes (default: 128)")
+      .add<double>("value-size-sigma",
+                   "log-normal shape parameter for payload sizes; 0 = fixed "
+                   "size (default: 0.5)")
+      .add<size_t>("nesting-depth",
+                   "maximum container nesting depth; 0 = flat strings "
+                   "(default: 2)")
+      .add<size_t>("seed", "seed for the random engine (default: 0)");
     set("caf.scheduler.max-threads", 1);
     set("caf.logger.file.verbosity", "quiet");
   }
@@ -237,6 +280,11 @@ struct node {
   /// we produce the number of messages in the generator file.
   caf::optional<size_t> num_outputs;
 
+  /// Stores the replay speed multiplier for timed generator files, e.g., 0.5
+  /// for half speed or 10 for tenfold speed. The default of 0 replays as fast
+  /// as the pipeline allows and ignores recorded time gaps.
+  double replay_speed = 0;
+
   /// Stores parent nodes in the pub/sub topology.
   std::vector<node*> left;
 
@@ -342,6 +390,7 @@ expected<node> make_node(const string& name, const caf::settings& parameters) {
   SET_FIELD(num_inputs, optional);
   SET_FIELD(forward, optional);
   SET_FIELD(num_outputs, optional);
+  SET_FIELD(replay_speed, optional);
   SET_FIELD(inputs_by_node, optional);
   SET_FIELD(log_verbosity, optional);
   if (!result.generator_file.empty() && !is_file(result.generator_file))
@@ -400,6 +449,22 @@ struct generator_state {
 
 const char* generator_state::name = "generator";
 
+/// Sleeps until the next message is due when replaying a timed recording at
+/// a fixed speed multiplier. No-op at max speed (speed == 0) and for
+/// recordings without time gaps.
+void throttle_replay(std::chrono::steady_clock::time_point& deadline,
+                     double speed, broker::timespan gap) {
+  if (speed <= 0 || gap.count() == 0)
+    return;
+  using clock = std::chrono::steady_clock;
+  deadline += std::chrono::duration_cast<clock::duration>(gap / speed);
+  auto now = clock::now();
+  if (deadline > now)
+    std::this_thread::sleep_until(deadline);
+  else if (deadline < now - std::chrono::seconds(1))
+    deadline = now; // Do not accumulate unbounded replay debt after stalls.
+}
+
 void generator(caf::stateful_actor<generator_state>* self, node* this_node,
                caf::actor core,
                broker::internal::generator_file_reader_ptr ptr) {
@@ -410,6 +475,7 @@ void generator(caf::stateful_actor<generator_state>* self, node* this_node,
       generator_ptr gptr;
       size_t remaining;
       size_t pushed = 0;
+      std::chrono::steady_clock::time_point deadline;
     };
     attach_stream_source(
       self, core,
@@ -417,6 +483,7 @@ void generator(caf::stateful_actor<generator_state>* self, node* this_node,
         // Take ownership of `ptr`.
         st.gptr = std::move(ptr);
         st.remaining = *this_node->num_outputs;
+        st.deadline = std::chrono::steady_clock::now();
       },
       [=](state& st, caf::downstream<value_type>& out, size_t hint) {
         if (st.gptr == nullptr)
@@ -433,6 +500,8 @@ void generator(caf::stateful_actor<generator_state>* self, node* this_node,
             st.remaining = 0;
             return;
           }
+          throttle_replay(st.deadline, this_node->replay_speed,
+                          st.gptr->drain_gap());
           out.push(std::move(x));
         }
         st.remaining -= n;
@@ -446,6 +515,7 @@ void generator(caf::stateful_actor<generator_state>* self, node* this_node,
     struct state {
       generator_ptr gptr;
       size_t pushed = 0;
+      std::chrono::steady_clock::time_point deadline;
     };
     auto done = [](const state& st) {
       // We are done when gptr becomes null as result of an error or when
@@ -457,6 +527,7 @@ void generator(caf::stateful_actor<generator_state>* self, node* this_node,
       [&](state& st) {
         // Take ownership of `ptr`.
         st.gptr = std::move(ptr);
+        st.deadline = std::chrono::steady_clock::now();
       },
       [=](state& st, caf::downstream<value_type>& out, size_t hint) {
         size_t n = 0;
@@ -470,6 +541,8 @@ void generator(caf::stateful_actor<generator_state>* self, node* this_node,
             st.gptr = nullptr;
             break;
           }
+          throttle_replay(st.deadline, this_node->replay_speed,
+                          st.gptr->drain_gap());
           out.push(std::move(x));
         }
         // Make some noise every 1k messages or when done.
@@ -486,18 +559,187 @@ void run_send_mode(node_manager_actor* self, caf::actor observer) {
   auto this_node = self->state.this_node;
   verbose::println(this_node->name, " starts publishing");
   auto t0 = std::chrono::steady_clock::now();
-  auto g = self->spawn(generator, this_node, native(self->state.ep.core()),
-                       std::move(self->state.generator));
-  g->attach_functor([this_node, t0, observer]() mutable {
+  auto r0 = sample_resources();
+  // Timed replay sleeps between messages, so it must not run on a shared
+  // scheduler thread.
+  auto g = this_node->replay_speed > 0
+             ? self->spawn<caf::detached>(generator, this_node,
+                                          native(self->state.ep.core()),
+                                          std::move(self->state.generator))
+             : self->spawn(generator, this_node,
+                           native(self->state.ep.core()),
+                           std::move(self->state.generator));
+  g->attach_functor([this_node, t0, r0, observer]() mutable {
     auto t1 = std::chrono::steady_clock::now();
-    anon_send(observer, atom::ok_v, atom::write_v, this_node->name,
-              duration_cast<caf::timespan>(t1 - t0));
+    auto runtime = duration_cast<caf::timespan>(t1 - t0);
+    anon_send(observer, atom::ok_v, atom::write_v, this_node->name, runtime,
+              render_resources(r0, sample_resources(),
+                               fractional_seconds{t1 - t0}.count()));
   });
 }
 
+// -- resource usage self-sampling ---------------------------------------------
+
+/// A snapshot of process-level resource usage. All nodes share this process,
+/// so a pair of snapshots describes the process over a node's phase window
+/// rather than the node in isolation. That still pinpoints which phase went
+/// CPU- or memory-bound when comparing runs.
+struct resource_sample {
+  /// User plus system CPU time consumed so far.
+  double cpu_seconds = 0;
+
+  /// Current resident set size in bytes.
+  size_t rss_bytes = 0;
+
+  /// Number of threads in the process.
+  size_t threads = 0;
+
+  /// Bytes currently handed out by malloc; only available with glibc.
+  size_t malloc_bytes = 0;
+
+  /// Whether `malloc_bytes` carries a meaningful value.
+  bool has_malloc_bytes = false;
+};
+
+resource_sample sample_resources() {
+  resource_sample result;
+#ifndef BROKER_WINDOWS
+  rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) == 0) {
+    auto tv_secs = [](const timeval& tv) {
+      return static_cast<double>(tv.tv_sec)
+             + static_cast<double>(tv.tv_usec) / 1e6;
+    };
+    result.cpu_seconds = tv_secs(ru.ru_utime) + tv_secs(ru.ru_stime);
+    // Fallback RSS (peak, in KB); overridden with the current value below.
+    result.rss_bytes = static_cast<size_t>(ru.ru_maxrss) * 1024;
+  }
+#  ifdef __linux__
+  if (std::ifstream statm{"/proc/self/statm"}; statm) {
+    size_t total_pages = 0;
+    size_t rss_pages = 0;
+    if (statm >> total_pages >> rss_pages)
+      result.rss_bytes = rss_pages
+                         * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  }
+  if (std::ifstream status{"/proc/self/status"}; status) {
+    string line;
+    while (std::getline(status, line))
+      if (line.compare(0, 8, "Threads:") == 0) {
+        result.threads = static_cast<size_t>(std::stoul(line.substr(8)));
+        break;
+      }
+  }
+#  endif
+#  if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+  auto mi = mallinfo2();
+  result.malloc_bytes = mi.uordblks + mi.hblkhd;
+  result.has_malloc_bytes = true;
+#  endif
+#endif // BROKER_WINDOWS
+  return result;
+}
+
+/// Renders the difference between two resource samples as a JSON object.
+/// Allocation rates derive from the net change in malloc'ed bytes; counting
+/// individual allocations would require malloc hooks.
+std::string render_resources(const resource_sample& before,
+                             const resource_sample& after,
+                             double runtime_seconds) {
+  auto cpu_delta = after.cpu_seconds - before.cpu_seconds;
+  std::ostringstream oss;
+  oss << "{\"process-wide\": true"
+      << ", \"cpu-seconds\": " << cpu_delta
+      << ", \"cpu-utilization\": "
+      << (runtime_seconds > 0 ? cpu_delta / runtime_seconds : 0.)
+      << ", \"rss-bytes\": " << after.rss_bytes
+      << ", \"rss-delta-bytes\": "
+      << (static_cast<int64_t>(after.rss_bytes)
+          - static_cast<int64_t>(before.rss_bytes))
+      << ", \"threads\": " << after.threads;
+  if (before.has_malloc_bytes && after.has_malloc_bytes) {
+    auto malloc_delta = static_cast<int64_t>(after.malloc_bytes)
+                        - static_cast<int64_t>(before.malloc_bytes);
+    oss << ", \"malloc-bytes\": " << after.malloc_bytes
+        << ", \"net-allocation-bytes-per-second\": "
+        << (runtime_seconds > 0 ? static_cast<double>(malloc_delta)
+                                    / runtime_seconds
+                                : 0.);
+  }
+  oss << "}";
+  return oss.str();
+}
+
+// -- phase-separated throughput accounting ------------------------------------
+
+/// Length of one throughput sample while receiving.
+constexpr auto sample_interval = std::chrono::milliseconds(100);
+
+/// Number of throughput samples per second.
+constexpr auto samples_per_second
+  = static_cast<size_t>(std::chrono::seconds(1) / sample_interval);
+
+/// Length of one throughput sample in (fractional) seconds.
+constexpr double secs_per_sample = fractional_seconds{sample_interval}.count();
+
+/// Upper bound on the coefficient of variation for accepting a window of
+/// samples as steady state.
+constexpr double steady_state_max_cv = 0.25;
+
+/// Minimum number of samples required for detecting a steady state.
+constexpr size_t steady_state_min_samples = 10;
+
+/// Describes the measured window of a receiver, i.e., the suffix of its
+/// throughput samples with sufficiently low variance.
+struct steady_state_window {
+  bool detected = false;
+  size_t first_sample = 0;
+  size_t last_sample = 0;
+  size_t messages = 0;
+  double rate = 0;
+  double cv = 0;
+};
+
+/// Scans `samples` (messages per `sample_interval`) for the earliest start
+/// after `skip` where the remaining samples form a low-variance window.
+steady_state_window find_steady_state(const std::vector<size_t>& samples,
+                                      size_t skip) {
+  steady_state_window result;
+  // Drop trailing idle samples, e.g., time spent waiting for stragglers.
+  auto last = samples.size();
+  while (last > 0 && samples[last - 1] == 0)
+    --last;
+  for (auto first = skip; first + steady_state_min_samples <= last; ++first) {
+    auto n = static_cast<double>(last - first);
+    double sum = 0;
+    for (auto i = first; i < last; ++i)
+      sum += static_cast<double>(samples[i]);
+    auto mean = sum / n;
+    if (mean == 0)
+      break;
+    double sq_sum = 0;
+    for (auto i = first; i < last; ++i) {
+      auto delta = static_cast<double>(samples[i]) - mean;
+      sq_sum += delta * delta;
+    }
+    auto cv = std::sqrt(sq_sum / n) / mean;
+    if (cv <= steady_state_max_cv) {
+      result.detected = true;
+      result.first_sample = first;
+      result.last_sample = last;
+      result.messages = static_cast<size_t>(sum);
+      result.rate = mean * static_cast<double>(samples_per_second);
+      result.cv = cv;
+      return result;
+    }
+  }
+  return result;
+}
+
 struct consumer_state {
   consumer_state(caf::event_based_actor* self) : self(self) {
     start = std::chrono::steady_clock::now();
+    start_resources = sample_resources();
   }
 
   ~consumer_state() {
@@ -507,20 +749,72 @@ struct consumer_state {
   }
 
   void handle_messages(size_t n) {
+    auto now = std::chrono::steady_clock::now();
+    if (!received_first) {
+      received_first = true;
+      first_msg_time = now;
+    }
+    // Account the batch to its throughput sample.
+    auto index = static_cast<size_t>((now - start) / sample_interval);
+    if (samples.size() <= index)
+      samples.resize(index + 1);
+    samples[index] += n;
     // Make some noise every 1k messages.
     if (received / 1000 != (received + n) / 1000)
       verbose::println(this_node->name, " got ", received + n, " messages");
     // Inform the observer when reaching the node's limit.
     auto limit = this_node->num_inputs;
     if (received < limit && received + n >= limit) {
-      auto stop = std::chrono::steady_clock::now();
       anon_send(observer, atom::ok_v, atom::read_v, this_node->name,
-                duration_cast<caf::timespan>(stop - start));
+                duration_cast<caf::timespan>(now - start),
+                render_stats(now, received + n));
       verbose::println(this_node->name, " reached its limit");
     }
     received += n;
   }
 
+  /// Renders the per-phase statistics of this receiver as a JSON object.
+  std::string render_stats(std::chrono::steady_clock::time_point stop,
+                           size_t total) const {
+    auto secs = [](auto duration) {
+      return duration_cast<fractional_seconds>(duration).count();
+    };
+    auto warmup = caf::get_or(self->system().config(), "warmup", size_t{1});
+    auto skip = std::min(samples.size(), warmup * samples_per_second);
+    auto warmup_messages = std::accumulate(samples.begin(),
+                                           samples.begin()
+                                             + static_cast<ptrdiff_t>(skip),
+                                           size_t{0});
+    auto runtime = secs(stop - start);
+    std::ostringstream oss;
+    oss << "{\"expected-messages\": " << this_node->num_inputs
+        << ", \"received-messages\": " << total
+        << ", \"runtime-seconds\": " << runtime
+        << ", \"throughput\": " << (runtime > 0 ? total / runtime : 0.)
+        << ", \"time-to-first-message-seconds\": "
+        << (received_first ? secs(first_msg_time - start) : 0.)
+        << ", \"warmup\": {\"seconds\": " << warmup
+        << ", \"messages\": " << warmup_messages << "}"
+        << ", \"steady-state\": ";
+    if (auto window = find_steady_state(samples, skip); window.detected) {
+      auto to_secs = [](size_t sample) {
+        return secs_per_sample * static_cast<double>(sample);
+      };
+      oss << "{\"detected\": true"
+          << ", \"begin-seconds\": " << to_secs(window.first_sample)
+          << ", \"end-seconds\": " << to_secs(window.last_sample)
+          << ", \"messages\": " << window.messages
+          << ", \"throughput\": " << window.rate
+          << ", \"cv\": " << window.cv << "}";
+    } else {
+      oss << "{\"detected\": false}";
+    }
+    oss << ", \"resources\": "
+        << render_resources(start_resources, sample_resources(), runtime);
+    oss << "}";
+    return oss.str();
+  }
+
   template <class T>
   void attach_sink(caf::stream<T> in, caf::actor observer) {
     if (++connected_streams == 2) {
@@ -545,7 +839,11 @@ struct consumer_state {
   size_t connected_streams = 0;
   static const char* name;
   std::chrono::steady_clock::time_point start;
+  resource_sample start_resources;
   caf::actor observer;
+  std::vector<size_t> samples;
+  bool received_first = false;
+  std::chrono::steady_clock::time_point first_msg_time;
 };
 
 const char* consumer_state::name = "consumer";
@@ -693,6 +991,10 @@ caf::behavior node_manager(node_manager_actor* self, node* this_node) {
         if (st.generator == nullptr)
           return make_error(caf::sec::cannot_open_file,
                             this_node->generator_file);
+        if (auto depth = caf::get_or(self->config(), "prefetch-depth",
+                                     size_t{64});
+            depth > 0)
+          st.generator->enable_prefetch(depth);
       }
       verbose::println(this_node->name, " up and running");
       return atom::ok_v;
@@ -1053,7 +1355,12 @@ int shrink_generator_file(const string& in_file, const string& out_file,
   }
   using format = broker::internal::generator_file_writer::format;
   auto out_guard = caf::detail::make_scope_guard([out] { fclose(out); });
-  auto header = format::header();
+  // The raw chunks arrive decompressed, so strip compression from the
+  // version but keep the timed bit: time_delta entries pass through as-is.
+  auto is_timed = gptr->version() == format::version_timed
+                  || gptr->version() == format::version_timed_compressed;
+  auto header = format::header(is_timed ? format::version_timed
+                                        : format::version);
   if (fwrite(header.data(), 1, header.size(), out) != header.size()) {
     err::println("unable to write to ", out_file);
     return EXIT_FAILURE;
@@ -1078,6 +1385,43 @@ int shrink_generator_file(const string& in_file, const string& out_file,
   return return_code;
 }
 
+int generate_workload(const config& cfg) {
+  if (cfg.remainder.size() != 1) {
+    err::println("invalid arguments to generate-workload mode");
+    err::println("expected one positional argument: OUTPUT");
+    return EXIT_FAILURE;
+  }
+  const auto& out_file = cfg.remainder[0];
+  if (broker::detail::is_file(out_file)) {
+    err::println("output file ", out_file, " already exists");
+    return EXIT_FAILURE;
+  }
+  broker::internal::workload_generator::parameters params;
+  params.seed = static_cast<unsigned>(get_or(cfg, "workload.seed", size_t{0}));
+  params.num_topics = get_or(cfg, "workload.num-topics", size_t{10});
+  params.topic_skew = get_or(cfg, "workload.topic-skew", 0.0);
+  params.value_size_median
+    = get_or(cfg, "workload.value-size-median", size_t{128});
+  params.value_size_sigma = get_or(cfg, "workload.value-size-sigma", 0.5);
+  params.max_nesting_depth = get_or(cfg, "workload.nesting-depth", size_t{2});
+  auto num_messages = get_or(cfg, "workload.num-messages", size_t{10000});
+  auto out = broker::internal::make_generator_file_writer(out_file);
+  if (out == nullptr) {
+    err::println("unable to open ", out_file, " for writing");
+    return EXIT_FAILURE;
+  }
+  broker::internal::workload_generator gen{params};
+  for (size_t i = 0; i < num_messages; ++i) {
+    if (auto err = out->write(gen.next())) {
+      err::println("unable to write to ", out_file, ": ", to_string(err));
+      return EXIT_FAILURE;
+    }
+  }
+  verbose::println("wrote ", num_messages, " messages over ",
+                   gen.topics().size(), " topics to ", out_file);
+  return EXIT_SUCCESS;
+}
+
 int shrink_generator_file(string_list args) {
   if (args.size() != 3) {
     err::println("invalid arguments to shrink-generator-file mode");
@@ -1145,6 +1489,7 @@ enum program_mode_t {
   benchmark_mode,
   dump_stats_mode,
   generate_config_mode,
+  generate_workload_mode,
   shrink_generator_file_mode,
 };
 
@@ -1156,6 +1501,8 @@ program_mode_t get_mode(const config& cfg) {
     return dump_stats_mode;
   else if (*mode_str == "generate-config")
     return generate_config_mode;
+  else if (*mode_str == "generate-workload")
+    return generate_workload_mode;
   else if (*mode_str == "shrink-generator-file")
     return shrink_generator_file_mode;
   else
@@ -1184,6 +1531,8 @@ int main(int argc, char** argv) {
   // Dispatch to modes that don't read a cluster config.
   if (mode == generate_config_mode)
     return generate_config(cfg.remainder);
+  else if (mode == generate_workload_mode)
+    return generate_workload(cfg);
   else if (mode == shrink_generator_file_mode)
     return shrink_generator_file(cfg.remainder);
   // Read cluster config.
@@ -1354,21 +1703,29 @@ int main(int argc, char** argv) {
         throw std::move(err);
       });
   };
+  // Phase results per node for the optional JSON report.
+  std::map<std::string, double> send_runtimes;
+  std::map<std::string, std::string> send_resources;
+  std::map<std::string, std::string> receive_stats;
   auto wait_for_ok_messages = [&](size_t num) {
     size_t i = 0;
     self->receive_for(i, num)(
       [](atom::ok) {
         // All is well.
       },
-      [](atom::ok, atom::write, const std::string& node_name,
-         caf::timespan runtime) {
+      [&](atom::ok, atom::write, const std::string& node_name,
+          caf::timespan runtime, const std::string& resources) {
         out::println(node_name, " (sending): ",
                      duration_cast<fractional_seconds>(runtime));
+        send_runtimes[node_name]
+          = duration_cast<fractional_seconds>(runtime).count();
+        send_resources[node_name] = resources;
       },
-      [](atom::ok, atom::read, const std::string& node_name,
-         caf::timespan runtime) {
+      [&](atom::ok, atom::read, const std::string& node_name,
+          caf::timespan runtime, const std::string& stats) {
         out::println(node_name, " (receiving): ",
                      duration_cast<fractional_seconds>(runtime));
+        receive_stats[node_name] = stats;
       },
       [&](caf::error& err) { throw std::move(err); });
   };
@@ -1398,6 +1755,42 @@ int main(int argc, char** argv) {
       std::accumulate(nodes.begin(), nodes.end(), size_t{0}, ok_count));
     auto t1 = std::chrono::steady_clock::now();
     out::println("system: ", duration_cast<fractional_seconds>(t1 - t0));
+    // Write the machine-readable report when requested.
+    if (auto json_path = get_if<string>(&cfg, "json-output")) {
+      std::ostringstream oss;
+      oss << "{\n  \"schema-version\": 1,\n"
+          << "  \"tool\": \"broker-cluster-benchmark\",\n"
+          << "  \"system\": {\"runtime-seconds\": "
+          << duration_cast<fractional_seconds>(t1 - t0).count()
+          << ", \"warmup-seconds\": " << get_or(cfg, "warmup", size_t{1})
+          << "},\n  \"nodes\": {";
+      bool first_entry = true;
+      for (const auto& x : nodes) {
+        auto send_i = send_runtimes.find(x.name);
+        auto recv_i = receive_stats.find(x.name);
+        if (send_i == send_runtimes.end() && recv_i == receive_stats.end())
+          continue;
+        oss << (first_entry ? "\n" : ",\n") << "    \"" << x.name << "\": {";
+        first_entry = false;
+        if (send_i != send_runtimes.end()) {
+          oss << "\"send\": {\"runtime-seconds\": " << send_i->second
+              << ", \"resources\": " << send_resources[x.name] << "}";
+          if (recv_i != receive_stats.end())
+            oss << ", ";
+        }
+        if (recv_i != receive_stats.end())
+          oss << "\"receive\": " << recv_i->second;
+        oss << "}";
+      }
+      oss << "\n  }\n}";
+      if (*json_path == "-") {
+        out::println(oss.str());
+      } else if (std::ofstream json_file{*json_path}; json_file) {
+        json_file << oss.str() << '\n';
+      } else {
+        err::println("unable to open JSON output file: ", *json_path);
+      }
+    }
     // Shutdown all endpoints.
     verbose::println("shut down all nodes");
     for (auto& x : nodes)
@@ -0,0 +1,360 @@
+// Runs a scripted broker workload deterministically in a single thread. The
+// actor system uses CAF's test coordinator instead of the work-stealing
+// scheduler and broker's simulation clock instead of wall-clock time, so the
+// full actor graph (core actor, dispatcher, master/clone actors) executes the
+// exact same interleaving on every run. That makes ordering and latency
+// pathologies reproducible and bisectable: capture a script that triggers the
+// issue once and replay it until the offending commit or code path is found.
+// All reported times are virtual; the harness only advances them on "advance".
+//
+// Usage: broker-sim [options] <script-file>  (use "-" for stdin)
+//
+// Script commands (one per line, "#" starts a comment):
+//   subscribe <prefix>            attach a subscriber for a topic prefix
+//   publish <topic> <n> [bytes]   inject n messages with a string payload
+//   ping <topic> <n>              inject n messages carrying the virtual
+//                                 send time for latency measurement
+//   master <name> [backend]       attach a master store (default: memory)
+//   clone <name>                  attach a clone of an existing master
+//   put <store> <key> <value>     write to a store (integers stay integers)
+//   erase <store> <key>           remove a store entry
+//   get <store> <key>             read from a store and print the result
+//   advance <duration>            advance virtual time, e.g. 10ms or 2s
+//   recv                          drain all subscribers and print per-prefix
+//                                 counts plus virtual latencies of pings
+//   stats                         print virtual time and message totals
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <caf/actor_system.hpp>
+#include <caf/io/middleman.hpp>
+#include <caf/io/network/test_multiplexer.hpp>
+#include <caf/scheduler/test_coordinator.hpp>
+
+#include "broker/backend.hh"
+#include "broker/configuration.hh"
+#include "broker/data.hh"
+#include "broker/endpoint.hh"
+#include "broker/internal/configuration_access.hh"
+#include "broker/internal/endpoint_access.hh"
+#include "broker/subscriber.hh"
+#include "broker/topic.hh"
+
+using namespace broker;
+
+namespace {
+
+// -- CLI options --------------------------------------------------------------
+
+bool trace = false;
+
+void add_options(configuration& cfg) {
+  cfg.add_option(&trace, "trace,t", "print each script line before executing");
+}
+
+void usage(const configuration& cfg, const char* arg0) {
+  std::cerr << "Usage: " << arg0 << " [options] <script-file>\n"
+            << cfg.help_text();
+}
+
+// -- script parsing helpers ---------------------------------------------------
+
+/// Parses durations of the form "<count><unit>" with ns, us, ms, s or min as
+/// unit. Returns a zero duration on a malformed argument.
+timespan parse_duration(const std::string& str) {
+  size_t pos = 0;
+  long long num;
+  try {
+    num = std::stoll(str, &pos);
+  } catch (std::exception&) {
+    return timespan{0};
+  }
+  auto unit = str.substr(pos);
+  if (unit == "ns")
+    return timespan{num};
+  if (unit == "us")
+    return std::chrono::microseconds{num};
+  if (unit == "ms")
+    return std::chrono::milliseconds{num};
+  if (unit == "s")
+    return std::chrono::seconds{num};
+  if (unit == "min")
+    return std::chrono::minutes{num};
+  return timespan{0};
+}
+
+/// Parses store values: anything that fully reads as an integer stays an
+/// integer, everything else is a string.
+data parse_value(const std::string& str) {
+  size_t pos = 0;
+  try {
+    auto num = std::stoll(str, &pos);
+    if (pos == str.size())
+      return data{integer{num}};
+  } catch (std::exception&) {
+    // fall through
+  }
+  return data{str};
+}
+
+// -- the simulation -----------------------------------------------------------
+
+configuration make_sim_config() {
+  broker_options opts;
+  opts.disable_ssl = true;
+  // Time only moves when the script says so.
+  opts.use_real_time = false;
+  configuration cfg{opts};
+  auto& nat_cfg = internal::configuration_access{&cfg}.cfg();
+  // Run all actors on the calling thread in deterministic order.
+  nat_cfg.set("caf.scheduler.policy", "testing");
+  nat_cfg.set("caf.logger.console.verbosity", "quiet");
+  nat_cfg.load<caf::io::middleman, caf::io::network::test_multiplexer>();
+  return cfg;
+}
+
+struct simulation {
+  using scheduler_type = caf::scheduler::test_coordinator;
+
+  endpoint ep;
+  caf::actor_system& sys;
+  scheduler_type& sched;
+
+  std::vector<std::pair<std::string, subscriber>> subscribers;
+  std::vector<std::pair<std::string, store>> stores;
+
+  uint64_t published = 0;
+  uint64_t received = 0;
+
+  simulation()
+    : ep(make_sim_config()),
+      sys(internal::endpoint_access{&ep}.sys()),
+      sched(dynamic_cast<scheduler_type&>(sys.scheduler())) {
+    // Processing each enqueue right away keeps blocking calls such as
+    // attach_master or store::get from stalling: their request runs to
+    // completion before the caller starts waiting for the response.
+    sched.inline_all_enqueues();
+  }
+
+  ~simulation() {
+    drain();
+  }
+
+  /// Runs the scheduler until no actor has pending work left.
+  void drain() {
+    while (sched.has_job() || sched.has_pending_timeout()) {
+      sched.run();
+      sched.trigger_timeouts();
+    }
+  }
+
+  /// Advances virtual time by `t`, stepping through intermediate actor
+  /// timeouts and keeping broker's simulation clock in lockstep with the
+  /// scheduler clock.
+  void advance(timespan t) {
+    while (t > timespan{0}) {
+      sched.run();
+      auto step = t;
+      if (sched.has_pending_timeout()) {
+        auto& clk = sched.clock();
+        auto delta = clk.schedule().begin()->first - clk.now();
+        if (delta < step)
+          step = delta;
+      }
+      sched.advance_time(step);
+      ep.advance_time(ep.now() + step);
+      sched.run();
+      t -= step;
+    }
+  }
+
+  store* find_store(const std::string& name) {
+    for (auto& [store_name, hdl] : stores)
+      if (store_name == name)
+        return &hdl;
+    std::cerr << "*** no such store: " << name << '\n';
+    return nullptr;
+  }
+
+  /// Executes a single script line. Returns false on a malformed command.
+  bool exec(const std::string& line);
+};
+
+bool simulation::exec(const std::string& line) {
+  std::istringstream in{line};
+  std::string cmd;
+  if (!(in >> cmd) || cmd[0] == '#')
+    return true; // Blank line or comment.
+  if (cmd == "subscribe") {
+    std::string prefix;
+    if (!(in >> prefix))
+      return false;
+    subscribers.emplace_back(prefix, ep.make_subscriber({topic{prefix}}));
+  } else if (cmd == "publish" || cmd == "ping") {
+    std::string subject;
+    uint64_t num = 0;
+    size_t payload = 0;
+    if (!(in >> subject >> num))
+      return false;
+    in >> payload;
+    for (uint64_t i = 0; i < num; ++i) {
+      if (cmd == "ping")
+        ep.publish(subject, data{ep.now()});
+      else
+        ep.publish(subject, data{std::string(payload, 'x')});
+      ++published;
+    }
+  } else if (cmd == "master") {
+    std::string name;
+    std::string type = "memory";
+    if (!(in >> name))
+      return false;
+    in >> type;
+    backend kind;
+    if (type == "memory")
+      kind = backend::memory;
+    else if (type == "sqlite")
+      kind = backend::sqlite;
+    else if (type == "mmapdb")
+      kind = backend::mmapdb;
+    else if (type == "rocksdb")
+      kind = backend::rocksdb;
+    else
+      return false;
+    if (auto res = ep.attach_master(name, kind))
+      stores.emplace_back(name, std::move(*res));
+    else
+      std::cerr << "*** cannot attach master " << name << ": "
+                << to_string(res.error()) << '\n';
+  } else if (cmd == "clone") {
+    std::string name;
+    if (!(in >> name))
+      return false;
+    if (auto res = ep.attach_clone(name))
+      stores.emplace_back(name, std::move(*res));
+    else
+      std::cerr << "*** cannot attach clone " << name << ": "
+                << to_string(res.error()) << '\n';
+  } else if (cmd == "put") {
+    std::string name;
+    std::string key;
+    std::string value;
+    if (!(in >> name >> key >> value))
+      return false;
+    if (auto hdl = find_store(name))
+      hdl->put(data{key}, parse_value(value));
+  } else if (cmd == "erase") {
+    std::string name;
+    std::string key;
+    if (!(in >> name >> key))
+      return false;
+    if (auto hdl = find_store(name))
+      hdl->erase(data{key});
+  } else if (cmd == "get") {
+    std::string name;
+    std::string key;
+    if (!(in >> name >> key))
+      return false;
+    if (auto hdl = find_store(name)) {
+      if (auto res = hdl->get(data{key}))
+        std::cout << name << '[' << key << "] = " << to_string(*res) << '\n';
+      else
+        std::cout << name << '[' << key << "] = <" << to_string(res.error())
+                  << ">\n";
+    }
+  } else if (cmd == "advance") {
+    std::string str;
+    if (!(in >> str))
+      return false;
+    auto t = parse_duration(str);
+    if (t <= timespan{0})
+      return false;
+    advance(t);
+  } else if (cmd == "recv") {
+    drain();
+    for (auto& [prefix, sub] : subscribers) {
+      auto xs = sub.poll();
+      received += xs.size();
+      uint64_t timed = 0;
+      timespan lat_sum{0};
+      timespan lat_max{0};
+      for (auto& msg : xs) {
+        auto& val = get_data(msg);
+        if (is<timestamp>(val)) {
+          auto lat = ep.now() - get<timestamp>(val);
+          ++timed;
+          lat_sum += lat;
+          if (lat > lat_max)
+            lat_max = lat;
+        }
+      }
+      std::cout << "recv " << prefix << ": " << xs.size() << " messages";
+      if (timed > 0)
+        std::cout << " (" << timed << " pings, virtual latency avg "
+                  << (lat_sum / timed).count() << "ns, max "
+                  << lat_max.count() << "ns)";
+      std::cout << '\n';
+    }
+  } else if (cmd == "stats") {
+    std::cout << "t=" << ep.now().time_since_epoch().count()
+              << "ns published=" << published << " received=" << received
+              << '\n';
+  } else {
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  configuration cfg{skip_init};
+  add_options(cfg);
+  try {
+    cfg.init(argc, argv);
+  } catch (std::exception& ex) {
+    std::cerr << ex.what() << "\n\n";
+    usage(cfg, argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (cfg.cli_helptext_printed())
+    return EXIT_SUCCESS;
+  if (cfg.remainder().size() != 1) {
+    std::cerr << "*** expected exactly one script file\n\n";
+    usage(cfg, argv[0]);
+    return EXIT_FAILURE;
+  }
+  auto file_name = cfg.remainder().at(0);
+  std::ifstream file;
+  if (file_name != "-") {
+    file.open(file_name);
+    if (!file.is_open()) {
+      std::cerr << "*** unable to open script file: " << file_name << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+  auto& in = file_name == "-" ? static_cast<std::istream&>(std::cin) : file;
+  simulation sim;
+  std::string line;
+  size_t line_num = 0;
+  while (std::getline(in, line)) {
+    ++line_num;
+    if (trace)
+      std::cout << "[" << line_num << "] " << line << '\n';
+    if (!sim.exec(line)) {
+      std::cerr << "*** malformed command in line " << line_num << ": " << line
+                << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+  sim.drain();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+// Replays a store command recording against a fresh backend. The input is a
+// generator file captured via "broker.store-recording-directory", i.e., the
+// full mutation stream of a master store. Applying that stream directly to a
+// backend isolates the backend cost from actor and messaging overhead, so
+// backend changes can be compared against real production mutation mixes.
+//
+// Usage: broker-store-replay [options] <generator-file>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <variant>
+
+#include "broker/configuration.hh"
+#include "broker/data.hh"
+#include "broker/detail/abstract_backend.hh"
+#include "broker/detail/filesystem.hh"
+#include "broker/detail/make_backend.hh"
+#include "broker/internal/generator_file_reader.hh"
+#include "broker/internal_command.hh"
+#include "broker/message.hh"
+#include "broker/time.hh"
+
+using namespace broker;
+
+namespace {
+
+// -- CLI options --------------------------------------------------------------
+
+std::string backend_type = "memory";
+std::string backend_path;
+uint64_t rounds = 1;
+
+void add_options(configuration& cfg) {
+  cfg.add_option(&backend_type, "backend,b",
+                 "one of: memory (default), sqlite, mmapdb, or rocksdb");
+  cfg.add_option(&backend_path, "path,p",
+                 "database path for persistent backends (recreated for each "
+                 "round)");
+  cfg.add_option(&rounds, "rounds,r",
+                 "number of times to replay the recording (default: 1)");
+}
+
+void usage(const configuration& cfg, const char* arg0) {
+  std::cerr << "Usage: " << arg0 << " [options] <generator-file>\n"
+            << cfg.help_text();
+}
+
+// -- command application ------------------------------------------------------
+
+struct replay_stats {
+  uint64_t applied = 0;
+  uint64_t skipped = 0;
+  uint64_t failed = 0;
+};
+
+/// Applies recorded commands to a backend, mirroring how the master mutates
+/// its backend. Commands that only coordinate actors (snapshot handshakes)
+/// have no backend effect and count as skipped.
+struct command_applier {
+  detail::abstract_backend* backend;
+  timestamp now;
+  replay_stats& stats;
+
+  std::optional<timestamp> to_expiry(const std::optional<timespan>& span) {
+    return span ? std::optional<timestamp>{now + *span}
+                : std::optional<timestamp>{};
+  }
+
+  void count(const expected<void>& res) {
+    if (res)
+      ++stats.applied;
+    else
+      ++stats.failed;
+  }
+
+  void operator()(none&) {
+    ++stats.skipped;
+  }
+
+  void operator()(put_command& x) {
+    count(backend->put(x.key, std::move(x.value), to_expiry(x.expiry)));
+  }
+
+  void operator()(put_unique_command& x) {
+    if (auto res = backend->exists(x.key); res && *res) {
+      ++stats.skipped;
+      return;
+    }
+    count(backend->put(x.key, std::move(x.value), to_expiry(x.expiry)));
+  }
+
+  void operator()(erase_command& x) {
+    count(backend->erase(x.key));
+  }
+
+  void operator()(expire_command&) {
+    // The master generates expirations itself and never consumes them, so
+    // recordings should not contain this command type.
+    ++stats.skipped;
+  }
+
+  void operator()(add_command& x) {
+    count(backend->add(x.key, x.value, x.init_type, to_expiry(x.expiry)));
+  }
+
+  void operator()(subtract_command& x) {
+    count(backend->subtract(x.key, x.value, to_expiry(x.expiry)));
+  }
+
+  void operator()(multi_put_command& x) {
+    auto expiry = to_expiry(x.expiry);
+    for (auto& [key, value] : x.entries)
+      count(backend->put(key, std::move(value), expiry));
+  }
+
+  void operator()(multi_erase_command& x) {
+    for (auto& key : x.keys)
+      count(backend->erase(key));
+  }
+
+  void operator()(snapshot_command&) {
+    ++stats.skipped;
+  }
+
+  void operator()(snapshot_sync_command&) {
+    ++stats.skipped;
+  }
+
+  void operator()(set_command& x) {
+    if (auto res = backend->clear(); !res) {
+      ++stats.failed;
+      return;
+    }
+    for (auto& [key, value] : x.state)
+      count(backend->put(key, value, std::nullopt));
+  }
+
+  void operator()(clear_command&) {
+    count(backend->clear());
+  }
+
+  void operator()(transaction_command& x) {
+    auto expiry = to_expiry(x.expiry);
+    using action_type = transaction_op::action_type;
+    for (auto& op : x.ops) {
+      switch (op.action) {
+        case action_type::put:
+          count(backend->put(op.key, std::move(op.value), expiry));
+          break;
+        case action_type::erase:
+          count(backend->erase(op.key));
+          break;
+        case action_type::add:
+          count(backend->add(op.key, op.value, op.init_type, expiry));
+          break;
+        case action_type::subtract:
+          count(backend->subtract(op.key, op.value, expiry));
+          break;
+      }
+    }
+  }
+};
+
+int replay_round(broker::backend type, const std::string& file_name) {
+  backend_options opts;
+  if (!backend_path.empty()) {
+    // Start from scratch: a leftover database would skew the measurement.
+    detail::remove_all(backend_path);
+    opts["path"] = backend_path;
+  }
+  auto backend = detail::make_backend(type, std::move(opts));
+  if (backend == nullptr) {
+    std::cerr << "*** unable to create backend: " << backend_type << '\n';
+    return EXIT_FAILURE;
+  }
+  auto reader = internal::make_generator_file_reader(file_name);
+  if (reader == nullptr) {
+    std::cerr << "*** unable to open generator file: " << file_name << '\n';
+    return EXIT_FAILURE;
+  }
+  replay_stats stats;
+  command_applier apply{backend.get(), broker::now(), stats};
+  internal::generator_file_reader::value_type entry;
+  auto t0 = std::chrono::steady_clock::now();
+  while (!reader->at_end()) {
+    if (auto err = reader->read(entry)) {
+      std::cerr << "*** error while parsing " << file_name << ": "
+                << to_string(err) << '\n';
+      return EXIT_FAILURE;
+    }
+    if (!is_command_message(entry)) {
+      ++stats.skipped;
+      continue;
+    }
+    auto cmd = move_command(get<command_message>(entry));
+    std::visit(apply, cmd);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  auto secs = std::chrono::duration<double>(t1 - t0).count();
+  auto size = backend->size();
+  std::cout << stats.applied << " mutations in " << secs << "s ("
+            << (secs > 0 ? static_cast<double>(stats.applied) / secs : 0.)
+            << " mutations/s), " << stats.skipped << " skipped, "
+            << stats.failed << " failed, final store size: "
+            << (size ? std::to_string(*size) : "n/a") << '\n';
+  return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  configuration cfg{skip_init};
+  add_options(cfg);
+  try {
+    cfg.init(argc, argv);
+  } catch (std::exception& ex) {
+    std::cerr << ex.what() << "\n\n";
+    usage(cfg, argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (cfg.cli_helptext_printed())
+    return EXIT_SUCCESS;
+  if (cfg.remainder().size() != 1) {
+    std::cerr << "*** expected exactly one generator file\n\n";
+    usage(cfg, argv[0]);
+    return EXIT_FAILURE;
+  }
+  auto file_name = cfg.remainder().at(0);
+  broker::backend type;
+  if (backend_type == "memory") {
+    type = backend::memory;
+  } else if (backend_type == "sqlite") {
+    type = backend::sqlite;
+  } else if (backend_type == "mmapdb") {
+    type = backend::mmapdb;
+  } else if (backend_type == "rocksdb") {
+    type = backend::rocksdb;
+  } else {
+    std::cerr << "*** invalid backend: " << backend_type << "\n\n";
+    usage(cfg, argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (type != backend::memory && backend_path.empty()) {
+    std::cerr << "*** persistent backends require --path\n\n";
+    usage(cfg, argv[0]);
+    return EXIT_FAILURE;
+  }
+  for (uint64_t round = 0; round < rounds; ++round)
+    if (auto res = replay_round(type, file_name); res != EXIT_SUCCESS)
+      return res;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Measures Python binding overhead for representative payload shapes.
+
+For every shape, the benchmark reports the publish/subscribe round-trip rate
+over a loopback peering between two endpoints and the per-call cost of the
+Data.from_py/Data.to_py converters. Results use the same JSON schema as
+broker-benchmark --json-output, so bench-compare.py can diff two runs:
+
+    python3 python-bench.py --json-output results.json
+
+Without --json-output, the document goes to stdout.
+"""
+
+import argparse
+import json
+import sys
+import time
+
+import broker
+
+# Shapes modeled on the traffic in broker-benchmark.py: small event-style
+# argument lists, a bulky string, a dense numeric vector, and a small table.
+PAYLOADS = {
+    "event-args": (1, "test"),
+    "string-1k": "x" * 1024,
+    "count-vector-100": tuple(broker.Count(i) for i in range(100)),
+    "table-small": {"a": 1, "b": 2.5, "c": "three"},
+}
+
+
+def bench_conversion(payload, min_runtime):
+    """Returns the per-call cost of from_py and to_py in seconds."""
+
+    def per_call(fun, arg):
+        iterations = 0
+        start = time.perf_counter()
+        while True:
+            for _ in range(100):
+                fun(arg)
+            iterations += 100
+            elapsed = time.perf_counter() - start
+            if elapsed >= min_runtime:
+                return elapsed / iterations
+
+    converted = broker.Data.from_py(payload)
+    return {
+        "from-py-seconds": per_call(broker.Data.from_py, payload),
+        "to-py-seconds": per_call(broker.Data.to_py, converted),
+    }
+
+
+def bench_roundtrip(payload, num_messages):
+    """Returns the loopback publish/subscribe rate in messages per second."""
+    with broker.Endpoint() as ep1, \
+         broker.Endpoint() as ep2, \
+         ep1.make_subscriber("/bench") as sub:
+
+        port = ep1.listen("127.0.0.1", 0)
+        if not ep2.peer("127.0.0.1", port, 1.0):
+            raise RuntimeError("unable to establish loopback peering")
+
+        start = time.perf_counter()
+        batch = [("/bench/data", payload)] * 100
+        sent = 0
+        received = 0
+        while received < num_messages:
+            if sent < num_messages:
+                ep2.publish_batch(*batch)
+                sent += len(batch)
+            received += len(sub.get_bulk(min(sent - received, 100), 1.0))
+        elapsed = time.perf_counter() - start
+        return num_messages / elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--json-output", metavar="FILE",
+                        help="write results to FILE instead of stdout")
+    parser.add_argument("--num-messages", type=int, default=5000,
+                        help="messages per shape for the round-trip measurement")
+    parser.add_argument("--conversion-runtime", type=float, default=0.25,
+                        help="minimum per-converter measurement time in seconds")
+    args = parser.parse_args()
+
+    results = {}
+    for name, payload in PAYLOADS.items():
+        print("benchmarking {} ...".format(name), file=sys.stderr)
+        results[name] = {
+            "throughput": bench_roundtrip(payload, args.num_messages),
+            "conversion": bench_conversion(payload, args.conversion_runtime),
+        }
+
+    doc = {
+        "schema-version": 1,
+        "tool": "python-bench",
+        "results": results,
+    }
+    if args.json_output:
+        with open(args.json_output, "w") as out:
+            json.dump(doc, out, indent=2)
+            out.write("\n")
+    else:
+        json.dump(doc, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()
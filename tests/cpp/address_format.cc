@@ -0,0 +1,107 @@
+#define SUITE address_format
+
+#include "broker/detail/address_format.hh"
+
+#include "test.hh"
+
+#include <string>
+
+#include "broker/address.hh"
+#include "broker/convert.hh"
+
+using namespace broker;
+
+namespace {
+
+std::string fmt4(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+  uint8_t bytes[] = {a, b, c, d};
+  char buf[detail::max_ipv4_chars];
+  return std::string{buf, detail::format_ipv4(bytes, buf)};
+}
+
+std::string roundtrip6(const std::string& str) {
+  uint8_t bytes[16];
+  if (!detail::parse_ipv6(str, bytes))
+    FAIL("failed to parse " << str);
+  char buf[detail::max_ipv6_chars];
+  return std::string{buf, detail::format_ipv6(bytes, buf)};
+}
+
+bool accepts4(const std::string& str) {
+  uint8_t bytes[4];
+  return detail::parse_ipv4(str, bytes);
+}
+
+bool accepts6(const std::string& str) {
+  uint8_t bytes[16];
+  return detail::parse_ipv6(str, bytes);
+}
+
+} // namespace
+
+TEST(ipv4 formatting covers all octet widths) {
+  CHECK_EQUAL(fmt4(0, 0, 0, 0), "0.0.0.0");
+  CHECK_EQUAL(fmt4(1, 22, 133, 9), "1.22.133.9");
+  CHECK_EQUAL(fmt4(192, 168, 1, 1), "192.168.1.1");
+  CHECK_EQUAL(fmt4(255, 255, 255, 255), "255.255.255.255");
+}
+
+TEST(ipv4 parsing accepts only canonical dotted quads) {
+  uint8_t bytes[4];
+  REQUIRE(detail::parse_ipv4("10.0.0.254", bytes));
+  CHECK_EQUAL(bytes[0], 10u);
+  CHECK_EQUAL(bytes[3], 254u);
+  CHECK(accepts4("0.0.0.0"));
+  CHECK(accepts4("255.255.255.255"));
+  CHECK(!accepts4("1.2.3"));
+  CHECK(!accepts4("1.2.3.4.5"));
+  CHECK(!accepts4("1.2.3.256"));
+  CHECK(!accepts4("01.2.3.4"));
+  CHECK(!accepts4("1..2.3"));
+  CHECK(!accepts4("a.b.c.d"));
+  CHECK(!accepts4("1.2.3.4 "));
+}
+
+TEST(ipv6 formatting produces the RFC 5952 canonical form) {
+  CHECK_EQUAL(roundtrip6("::"), "::");
+  CHECK_EQUAL(roundtrip6("::1"), "::1");
+  CHECK_EQUAL(roundtrip6("2001:db8::1"), "2001:db8::1");
+  CHECK_EQUAL(roundtrip6("2001:0DB8:0000:0000:0000:FF00:0042:8329"),
+              "2001:db8::ff00:42:8329");
+  CHECK_EQUAL(roundtrip6("1:2:3:4:5:6:7:8"), "1:2:3:4:5:6:7:8");
+  // A single zero group stays uncompressed.
+  CHECK_EQUAL(roundtrip6("1:0:2:3:4:5:6:7"), "1:0:2:3:4:5:6:7");
+  // Ties between runs go to the leftmost one.
+  CHECK_EQUAL(roundtrip6("1:0:0:2:0:0:3:4"), "1::2:0:0:3:4");
+  CHECK_EQUAL(roundtrip6("1:2:3:4:5:6:7::"), "1:2:3:4:5:6:7:0");
+}
+
+TEST(ipv6 parsing handles compression and embedded dotted quads) {
+  uint8_t bytes[16];
+  REQUIRE(detail::parse_ipv6("::ffff:192.168.1.1", bytes));
+  CHECK_EQUAL(bytes[10], 0xffu);
+  CHECK_EQUAL(bytes[12], 192u);
+  CHECK_EQUAL(bytes[15], 1u);
+  CHECK(accepts6("1:2:3:4:5:6:1.2.3.4"));
+  CHECK(!accepts6(":::"));
+  CHECK(!accepts6("1::2::3"));
+  CHECK(!accepts6("1:2:3:4:5:6:7"));
+  CHECK(!accepts6("1:2:3:4:5:6:7:8:9"));
+  CHECK(!accepts6("12345::"));
+  CHECK(!accepts6("1.2.3.4::1"));
+}
+
+TEST(address conversion round-trips through the fast kernels) {
+  auto check_roundtrip = [](const std::string& str) {
+    address addr;
+    REQUIRE(convert(str, addr));
+    std::string out;
+    REQUIRE(convert(addr, out));
+    CHECK_EQUAL(out, str);
+  };
+  check_roundtrip("1.2.3.4");
+  check_roundtrip("255.0.255.0");
+  check_roundtrip("::");
+  check_roundtrip("dead::beef");
+  check_roundtrip("2001:db8::ff00:42:8329");
+}
@@ -24,6 +24,7 @@
 #include "broker/detail/filesystem.hh"
 #include "broker/detail/make_backend.hh"
 #include "broker/detail/memory_backend.hh"
+#include "broker/detail/mmap_backend.hh"
 #include "broker/detail/sqlite_backend.hh"
 #include "broker/error.hh"
 #include "broker/expected.hh"
@@ -49,6 +50,9 @@ public:
     path += ".sqlite";
     paths_.push_back(path);
     backends_.push_back(detail::make_backend(backend::sqlite, opts));
+    path += ".mmap";
+    paths_.push_back(path);
+    backends_.push_back(detail::make_backend(backend::mmapdb, opts));
   }
 
   ~meta_backend() {
@@ -83,6 +87,15 @@ public:
     );
   }
 
+  expected<void>
+  bulk_insert(std::vector<std::pair<data, data>> entries) override {
+    return perform<void>(
+      [&](detail::abstract_backend& backend) {
+        return backend.bulk_insert(entries);
+      }
+    );
+  }
+
   expected<void> erase(const data& key) override {
     return perform<void>(
       [&](detail::abstract_backend& backend) {
@@ -297,6 +310,45 @@ TEST(clear/keys) {
   CHECK_EQUAL(*size, 0u);
 }
 
+TEST(range scans) {
+  for (auto key : {"a", "b", "c", "d"}) {
+    auto put = backend->put(key, 0);
+    REQUIRE(put);
+  }
+  auto keys = backend->keys_in_range("b", "d", 0);
+  REQUIRE(keys);
+  CHECK_EQUAL(*keys, (set{"b", "c"}));
+  keys = backend->keys_in_range("b", data{}, 0); // no upper bound
+  REQUIRE(keys);
+  CHECK_EQUAL(*keys, (set{"b", "c", "d"}));
+  keys = backend->keys_in_range("a", data{}, 2); // paginated
+  REQUIRE(keys);
+  CHECK_EQUAL(*keys, (set{"a", "b"}));
+  keys = backend->keys_in_range("x", data{}, 0); // empty range
+  REQUIRE(keys);
+  CHECK_EQUAL(*keys, set{});
+}
+
+TEST(bulk insert) {
+  std::vector<std::pair<data, data>> entries;
+  for (uint64_t i = 0; i < 100; ++i)
+    entries.emplace_back("key-" + std::to_string(i), i);
+  auto res = backend->bulk_insert(std::move(entries));
+  REQUIRE(res);
+  auto size = backend->size();
+  REQUIRE(size);
+  CHECK_EQUAL(*size, 100u);
+  auto val = backend->get("key-42");
+  REQUIRE(val);
+  CHECK_EQUAL(*val, data{42u});
+  // Bulk-inserted entries overwrite existing ones, like put.
+  res = backend->bulk_insert({{"key-42", "overwritten"}});
+  REQUIRE(res);
+  val = backend->get("key-42");
+  REQUIRE(val);
+  CHECK_EQUAL(*val, data{"overwritten"});
+}
+
 TEST(expiration with expiry) {
   using namespace std::chrono;
   auto put = backend->put("foo", "bar", broker::now() + milliseconds(1000));
@@ -325,6 +377,25 @@ TEST(expiration without expiry) {
   REQUIRE(!*expire); // no expiry with key associated
 }
 
+TEST(expiries reflects overwrites and erasures) {
+  using namespace std::chrono;
+  // The memory backend indexes expiry times lazily; this exercises the
+  // stale-entry filtering.
+  detail::memory_backend mb;
+  auto t1 = broker::now() + seconds{10};
+  auto t2 = broker::now() + seconds{20};
+  REQUIRE(mb.put("foo", "bar", t1));
+  REQUIRE(mb.put("baz", 4.2, t1));
+  REQUIRE(mb.put("quux", true)); // no expiry
+  REQUIRE(mb.put("foo", "bar2", t2)); // overwrite with new expiry
+  REQUIRE(mb.erase("baz"));
+  auto es = mb.expiries();
+  REQUIRE(es);
+  REQUIRE_EQUAL(es->size(), 1u);
+  CHECK_EQUAL(es->front().first, data{"foo"});
+  CHECK(es->front().second == t2);
+}
+
 TEST(size/snapshot) {
   using namespace std::chrono;
   auto put = backend->put("foo", "bar");
@@ -342,4 +413,152 @@ TEST(size/snapshot) {
   CHECK_EQUAL(ss->count("foo"), 1u);
 }
 
+TEST(compact after shrinking) {
+  for (int i = 0; i < 100; ++i)
+    REQUIRE(backend->put("key-" + std::to_string(i), i));
+  for (int i = 10; i < 100; ++i)
+    REQUIRE(backend->erase("key-" + std::to_string(i)));
+  REQUIRE(backend->compact());
+  auto size = backend->size();
+  REQUIRE(size);
+  CHECK_EQUAL(*size, 10u);
+  for (int i = 0; i < 10; ++i) {
+    auto v = backend->get("key-" + std::to_string(i));
+    REQUIRE(v);
+    CHECK_EQUAL(*v, data{i});
+  }
+  // The backend stays writable after a compaction.
+  REQUIRE(backend->put("key-new", true));
+  auto e = backend->exists("key-new");
+  REQUIRE(e);
+  CHECK(*e);
+}
+
+TEST(copy-on-write snapshot fork) {
+  // Forking is a memory backend feature; other backends fall back to a full
+  // snapshot copy.
+  detail::memory_backend mb;
+  REQUIRE(mb.put("foo", "bar"));
+  REQUIRE(mb.put("bar", 4.2));
+  REQUIRE(mb.put("baz", true));
+  auto n = mb.snapshot_fork();
+  REQUIRE(n);
+  CHECK_EQUAL(*n, 3u);
+  // Mutations after the fork do not affect the frozen state.
+  REQUIRE(mb.put("foo", "quux"));
+  REQUIRE(mb.erase("bar"));
+  REQUIRE(mb.put("new", 1u));
+  auto chunk1 = mb.snapshot_chunk(2);
+  REQUIRE(chunk1);
+  CHECK_EQUAL(chunk1->size(), 2u);
+  auto chunk2 = mb.snapshot_chunk(2);
+  REQUIRE(chunk2);
+  CHECK_EQUAL(chunk2->size(), 1u);
+  broker::snapshot ss;
+  ss.insert(chunk1->begin(), chunk1->end());
+  ss.insert(chunk2->begin(), chunk2->end());
+  CHECK_EQUAL(ss.size(), 3u);
+  CHECK_EQUAL(ss["foo"], data{"bar"});
+  CHECK_EQUAL(ss["bar"], data{4.2});
+  CHECK_EQUAL(ss["baz"], data{true});
+  // The live state reflects all mutations.
+  CHECK_EQUAL(mb.get("foo"), data{"quux"});
+  CHECK_EQUAL(mb.exists("bar"), false);
+  CHECK_EQUAL(mb.exists("new"), true);
+  // Reading past the last entry released the fork.
+  CHECK(mb.snapshot_fork());
+  mb.snapshot_release();
+}
+
+TEST(mmap persistence) {
+  auto path = detail::make_temp_file_name();
+  {
+    detail::mmap_backend mm{backend_options{{"path", path}}};
+    REQUIRE(!mm.init_failed());
+    REQUIRE(mm.put("foo", 7));
+    REQUIRE(mm.put("bar", "baz"));
+    REQUIRE(mm.put("quux", set{1, 2, 3}));
+    REQUIRE(mm.put("foo", 42)); // overwrite
+    REQUIRE(mm.erase("bar"));
+  }
+  // Reopening replays the log.
+  {
+    detail::mmap_backend mm{backend_options{{"path", path}}};
+    REQUIRE(!mm.init_failed());
+    auto size = mm.size();
+    REQUIRE(size);
+    CHECK_EQUAL(*size, 2u);
+    CHECK_EQUAL(value_of(mm.get("foo")), data{42});
+    CHECK_EQUAL(value_of(mm.get("quux")), data(set{1, 2, 3}));
+    CHECK_EQUAL(error_of(mm.get("bar")), ec::no_such_key);
+    REQUIRE(mm.clear());
+  }
+  // A cleared database stays empty across reopening.
+  detail::mmap_backend mm{backend_options{{"path", path}}};
+  REQUIRE(!mm.init_failed());
+  auto size = mm.size();
+  REQUIRE(size);
+  CHECK_EQUAL(*size, 0u);
+  detail::remove_all(path);
+}
+
+TEST(sqlite transaction batching) {
+  auto path = detail::make_temp_file_name();
+  {
+    auto opts = backend_options{{"path", path}, {"batch-size", count{16}}};
+    detail::sqlite_backend sb{std::move(opts)};
+    REQUIRE(!sb.init_failed());
+    for (int i = 0; i < 20; ++i)
+      REQUIRE(sb.put(i, i * i, std::nullopt));
+    // Reads on the same connection see buffered mutations immediately.
+    CHECK_EQUAL(value_of(sb.get(19)), data{361});
+    auto size = sb.size();
+    REQUIRE(size);
+    CHECK_EQUAL(*size, 20u);
+  }
+  // Destruction commits the partial batch; a fresh connection sees all rows.
+  detail::sqlite_backend sb{backend_options{{"path", path}}};
+  REQUIRE(!sb.init_failed());
+  auto size = sb.size();
+  REQUIRE(size);
+  CHECK_EQUAL(*size, 20u);
+  CHECK_EQUAL(value_of(sb.get(7)), data{49});
+  detail::remove_all(path);
+}
+
+TEST(sqlite in-place blob updates) {
+  auto path = detail::make_temp_file_name();
+  {
+    detail::sqlite_backend sb{backend_options{{"path", path}}};
+    REQUIRE(!sb.init_failed());
+    // Same-size overwrites take the incremental blob path; the new value
+    // must still come back byte for byte.
+    auto big = [](count fill) {
+      table t;
+      for (count i = 0; i < 100; ++i)
+        t.emplace(data{i}, data{i == 42 ? fill : i});
+      return data{std::move(t)};
+    };
+    REQUIRE(sb.put("big", big(0), std::nullopt));
+    REQUIRE(sb.put("big", big(7), std::nullopt));
+    CHECK_EQUAL(value_of(sb.get("big")), big(7));
+    // Writing identical bytes is a no-op, not an error.
+    REQUIRE(sb.put("big", big(7), std::nullopt));
+    CHECK_EQUAL(value_of(sb.get("big")), big(7));
+    // A size-changing overwrite falls back to a full replace.
+    REQUIRE(sb.put("big", "tiny", std::nullopt));
+    CHECK_EQUAL(value_of(sb.get("big")), data{"tiny"});
+    // Subtract funnels through the same path via modify.
+    REQUIRE(sb.put("ctr", count{100}, std::nullopt));
+    REQUIRE(sb.subtract("ctr", count{1}, std::nullopt));
+    CHECK_EQUAL(value_of(sb.get("ctr")), data{count{99}});
+  }
+  // A fresh connection sees the in-place writes.
+  detail::sqlite_backend sb{backend_options{{"path", path}}};
+  REQUIRE(!sb.init_failed());
+  CHECK_EQUAL(value_of(sb.get("big")), data{"tiny"});
+  CHECK_EQUAL(value_of(sb.get("ctr")), data{count{99}});
+  detail::remove_all(path);
+}
+
 FIXTURE_SCOPE_END()
@@ -0,0 +1,91 @@
+// Exercises the flat C API against real endpoints. Payloads cross the
+// boundary in codec format, so the tests encode and decode with the same
+// functions that FFI consumers link against.
+#define SUITE c_api
+
+#include "broker/broker.h"
+
+#include "test.hh"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "broker/data.hh"
+#include "broker/detail/data_codec.hh"
+
+using namespace broker;
+
+namespace {
+
+const uint8_t* bytes(const std::vector<std::byte>& buf) {
+  return reinterpret_cast<const uint8_t*>(buf.data());
+}
+
+} // namespace
+
+TEST(publish and subscribe round-trip) {
+  auto ep = broker_endpoint_new();
+  REQUIRE(ep != nullptr);
+  const char* topic_str = "/test/c-api";
+  size_t topic_size = strlen(topic_str);
+  auto sub = broker_endpoint_subscribe(ep, &topic_str, &topic_size, 1, 20);
+  REQUIRE(sub != nullptr);
+  auto value = data{vector{data{count{42}}, data{"hello"}}};
+  auto payload = detail::encode(value);
+  CHECK_EQUAL(broker_endpoint_publish(ep, topic_str, topic_size,
+                                      bytes(payload), payload.size()),
+              0);
+  auto msg = broker_subscriber_get_timeout(sub, 10.0);
+  REQUIRE(msg != nullptr);
+  size_t size = 0;
+  auto t = broker_message_topic(msg, &size);
+  CHECK_EQUAL(std::string(t, size), topic_str);
+  auto p = broker_message_payload(msg, &size);
+  auto decoded = detail::decode(reinterpret_cast<const std::byte*>(p), size);
+  REQUIRE(decoded);
+  CHECK_EQUAL(*decoded, value);
+  broker_message_destroy(msg);
+  broker_subscriber_destroy(sub);
+  broker_endpoint_destroy(ep);
+}
+
+TEST(malformed payloads are rejected) {
+  auto ep = broker_endpoint_new();
+  REQUIRE(ep != nullptr);
+  uint8_t garbage[] = {0xff, 0xff, 0xff};
+  CHECK_NOT_EQUAL(broker_endpoint_publish(ep, "/test", 5, garbage,
+                                          sizeof(garbage)),
+                  0);
+  broker_endpoint_destroy(ep);
+}
+
+TEST(store put and get) {
+  auto ep = broker_endpoint_new();
+  REQUIRE(ep != nullptr);
+  auto st = broker_endpoint_attach_master(ep, "c-api-test",
+                                          BROKER_C_BACKEND_MEMORY);
+  REQUIRE(st != nullptr);
+  auto key = detail::encode(data{"answer"});
+  auto value = detail::encode(data{count{42}});
+  CHECK_EQUAL(broker_store_put(st, bytes(key), key.size(), bytes(value),
+                               value.size(), 0),
+              0);
+  broker_blob* blob = nullptr;
+  REQUIRE_EQUAL(broker_store_get(st, bytes(key), key.size(), &blob), 0);
+  REQUIRE(blob != nullptr);
+  size_t size = 0;
+  auto p = broker_blob_data(blob, &size);
+  auto decoded = detail::decode(reinterpret_cast<const std::byte*>(p), size);
+  REQUIRE(decoded);
+  CHECK_EQUAL(*decoded, data{count{42}});
+  broker_blob_destroy(blob);
+  auto missing = detail::encode(data{"missing"});
+  broker_blob* no_blob = nullptr;
+  CHECK_NOT_EQUAL(broker_store_get(st, bytes(missing), missing.size(),
+                                   &no_blob),
+                  0);
+  CHECK(no_blob == nullptr);
+  broker_store_destroy(st);
+  broker_endpoint_destroy(ep);
+}
@@ -0,0 +1,64 @@
+#define SUITE clone_cache
+
+#include "broker/detail/clone_cache.hh"
+
+#include "test.hh"
+
+#include <fstream>
+
+#include "broker/data.hh"
+#include "broker/detail/filesystem.hh"
+
+using namespace broker;
+
+TEST(roundtrip) {
+  auto path = detail::make_temp_file_name();
+  std::unordered_map<data, data> entries;
+  entries.emplace(data{"foo"}, data{count{42}});
+  entries.emplace(data{vector{"bar", count{1}}},
+                  data{table{{data{"nested"}, data{4.2}}}});
+  REQUIRE(detail::save_clone_cache(path, entries, 1234));
+  auto cached = detail::load_clone_cache(path);
+  REQUIRE(cached);
+  CHECK_EQUAL(cached->seq, 1234u);
+  CHECK(cached->entries == entries);
+  detail::remove_all(path);
+}
+
+TEST(empty cache) {
+  auto path = detail::make_temp_file_name();
+  REQUIRE(detail::save_clone_cache(path, {}, 0));
+  auto cached = detail::load_clone_cache(path);
+  REQUIRE(cached);
+  CHECK_EQUAL(cached->seq, 0u);
+  CHECK(cached->entries.empty());
+  detail::remove_all(path);
+}
+
+TEST(overwrite replaces previous content) {
+  auto path = detail::make_temp_file_name();
+  std::unordered_map<data, data> entries;
+  entries.emplace(data{"a"}, data{count{1}});
+  entries.emplace(data{"b"}, data{count{2}});
+  REQUIRE(detail::save_clone_cache(path, entries, 10));
+  entries.erase(data{"b"});
+  REQUIRE(detail::save_clone_cache(path, entries, 20));
+  auto cached = detail::load_clone_cache(path);
+  REQUIRE(cached);
+  CHECK_EQUAL(cached->seq, 20u);
+  CHECK_EQUAL(cached->entries.size(), 1u);
+  detail::remove_all(path);
+}
+
+TEST(missing and malformed files) {
+  auto path = detail::make_temp_file_name();
+  CHECK(!detail::load_clone_cache(path));
+  {
+    std::ofstream out{path, std::ios::binary};
+    out << "not a cache file";
+  }
+  auto cached = detail::load_clone_cache(path);
+  REQUIRE(!cached);
+  CHECK_EQUAL(cached.error(), ec::invalid_data);
+  detail::remove_all(path);
+}
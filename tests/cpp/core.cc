@@ -586,6 +586,25 @@ CAF_TEST(unpeer_core1_from_core2) {
   anon_send_exit(core2, caf::exit_reason::user_shutdown);
 }
 
+// Checks emitted events in case we drain a peering before closing it.
+CAF_TEST(unpeer_gracefully_core1_from_core2) {
+  CAF_MESSAGE("initiate handshake between core1 and core2");
+  anon_send(core1, atom::peer_v, core2);
+  run();
+  CAF_MESSAGE("drain and unpeer core1 and core2");
+  anon_send(core1, atom::unpeer_v, atom::drain_v, core2,
+            caf::timespan{std::chrono::seconds(1)});
+  run();
+  BROKER_CHECK_LOG(es.poll(), sc::peer_added, sc::peer_removed);
+  CAF_MESSAGE("draining an unknown peer emits peer_invalid");
+  anon_send(core1, atom::unpeer_v, atom::drain_v, core2,
+            caf::timespan{std::chrono::seconds(1)});
+  run();
+  BROKER_CHECK_LOG(es.poll(), ec::peer_invalid);
+  anon_send_exit(core1, caf::exit_reason::user_shutdown);
+  anon_send_exit(core2, caf::exit_reason::user_shutdown);
+}
+
 // Checks emitted events in case a remote peer unpeers.
 CAF_TEST(unpeer_core2_from_core1) {
   // Initiate handshake between core1 and core2.
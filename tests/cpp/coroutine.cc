@@ -0,0 +1,113 @@
+#define SUITE coroutine
+
+#include "broker/coroutine.hh"
+
+#include "test.hh"
+
+#ifdef BROKER_HAS_COROUTINES
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "broker/data.hh"
+#include "broker/endpoint.hh"
+#include "broker/message.hh"
+#include "broker/topic.hh"
+
+using namespace broker;
+
+namespace {
+
+generator<int> iota(int n) {
+  for (int i = 0; i < n; ++i)
+    co_yield i;
+}
+
+generator<int> broken() {
+  co_yield 1;
+  throw std::runtime_error("broken generator");
+}
+
+generator<data_message> event_burst(size_t num) {
+  for (size_t i = 0; i < num; ++i)
+    co_yield make_data_message("/test", data{count{i}});
+}
+
+struct sink_state {
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::vector<data> values;
+};
+
+sink_task collect(data_message_stream in, sink_state& st) {
+  while (auto* msg = co_await in.next()) {
+    std::unique_lock guard{st.mtx};
+    st.values.push_back(get_data(*msg));
+    st.cv.notify_all();
+  }
+}
+
+} // namespace
+
+TEST(generators yield lazily and report completion) {
+  auto g = iota(3);
+  CHECK(!g.done());
+  std::vector<int> got;
+  while (g.next())
+    got.push_back(g.value());
+  CHECK_EQUAL(got, (std::vector<int>{0, 1, 2}));
+  CHECK(g.done());
+  CHECK(!g.next());
+}
+
+TEST(exceptions escape through next) {
+  auto g = broken();
+  REQUIRE(g.next());
+  CHECK_EQUAL(g.value(), 1);
+  auto threw = false;
+  try {
+    g.next();
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  CHECK(threw);
+}
+
+// Requires a non-deterministic setup: the coroutines run on the endpoint
+// thread pools, so the test merely waits for the pipeline to drain.
+TEST(coroutines drive a full publish subscribe pipeline) {
+  constexpr size_t num_messages = 10;
+  endpoint ep1;
+  endpoint ep2;
+  auto port = ep1.listen("127.0.0.1", 0);
+  REQUIRE(port != 0);
+  sink_state st;
+  auto sink = subscribe_coroutine(ep1, {topic{"/test"}},
+                                  [&st](data_message_stream in) {
+                                    return collect(std::move(in), st);
+                                  });
+  REQUIRE(ep2.peer("127.0.0.1", port));
+  auto source = publish_generator(ep2, event_burst(num_messages));
+  {
+    std::unique_lock guard{st.mtx};
+    auto drained = st.cv.wait_for(guard, std::chrono::seconds(10), [&st] {
+      return st.values.size() == num_messages;
+    });
+    CHECK(drained);
+    for (size_t i = 0; i < st.values.size(); ++i)
+      CHECK_EQUAL(st.values[i], data{count{i}});
+  }
+  ep2.stop(source);
+  ep1.stop(sink);
+}
+
+#else // BROKER_HAS_COROUTINES
+
+TEST(coroutine adapters are disabled on this compiler) {
+  MESSAGE("skipping: requires C++20 coroutine support");
+}
+
+#endif // BROKER_HAS_COROUTINES
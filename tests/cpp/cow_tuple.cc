@@ -0,0 +1,63 @@
+#define SUITE cow_tuple
+
+#include "broker/cow_tuple.hh"
+
+#include "test.hh"
+
+#include <caf/binary_deserializer.hpp>
+#include <caf/binary_serializer.hpp>
+
+#include "broker/data.hh"
+#include "broker/internal/type_id.hh"
+#include "broker/message.hh"
+
+using namespace broker;
+
+namespace {
+
+caf::byte_buffer encode(const data_message& msg) {
+  caf::byte_buffer buf;
+  caf::binary_serializer sink{nullptr, buf};
+  CHECK(sink.apply(msg));
+  return buf;
+}
+
+} // namespace
+
+TEST(binary serialization caches the wire bytes) {
+  auto msg = make_data_message("/test/topic", data{vector{1, "two", 3.0}});
+  CHECK(msg.encoding() == nullptr);
+  auto first = encode(msg);
+  MESSAGE("the first encode installs the cache");
+  REQUIRE(msg.encoding() != nullptr);
+  MESSAGE("further encodes reuse the cached blob verbatim");
+  auto second = encode(msg);
+  CHECK(first == second);
+  MESSAGE("the cached bytes match the field-wise encoding");
+  auto equal_msg = make_data_message("/test/topic", data{vector{1, "two", 3.0}});
+  CHECK(first == encode(equal_msg));
+  MESSAGE("the cached bytes deserialize back to the original message");
+  caf::binary_deserializer source{nullptr, first};
+  data_message copy;
+  REQUIRE(source.apply(copy));
+  CHECK_EQUAL(get_topic(copy), get_topic(msg));
+  CHECK_EQUAL(get_data(copy), get_data(msg));
+}
+
+TEST(mutable access invalidates the cached encoding) {
+  auto msg = make_data_message("/test/topic", data{1});
+  encode(msg);
+  REQUIRE(msg.encoding() != nullptr);
+  msg.unshared();
+  CHECK(msg.encoding() == nullptr);
+}
+
+TEST(copies never share the cached encoding) {
+  auto msg = make_data_message("/test/topic", data{1});
+  encode(msg);
+  auto copy = msg;
+  CHECK(copy.encoding() == msg.encoding()); // same impl, same cache
+  copy.unshared();                          // deep copy now
+  CHECK(copy.encoding() == nullptr);
+  CHECK(msg.encoding() != nullptr);
+}
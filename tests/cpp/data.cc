@@ -142,3 +142,28 @@ TEST(data - table) {
   CHECK_EQUAL(i->second, data{42});
   CHECK_EQUAL(to_string(t), "{bar -> 43, baz -> 44, foo -> 42}");
 }
+
+TEST(data - unsafe accessors) {
+  data x{count{42}};
+  REQUIRE(is<count>(x));
+  CHECK_EQUAL(x.unsafe_get<count>(), 42u);
+  x.unsafe_get<count>() = 7;
+  CHECK_EQUAL(get<count>(x), 7u);
+}
+
+TEST(data - shape tokens) {
+  data msg{vector{"conn", count{3}, 1.5}};
+  auto token = match_shape<std::string, count, real>(msg);
+  REQUIRE(static_cast<bool>(token));
+  CHECK_EQUAL(token.get<0>(), "conn");
+  CHECK_EQUAL(token.get<1>(), 3u);
+  CHECK_EQUAL(token.get<2>(), 1.5);
+  CHECK_EQUAL(token.fields().size(), 3u);
+  MESSAGE("extra trailing elements are permitted");
+  CHECK(static_cast<bool>(match_shape<std::string, count>(msg)));
+  MESSAGE("matching is strict, no conversions");
+  CHECK((!match_shape<std::string, count, count>(msg)));
+  MESSAGE("missing elements and non-vectors yield invalid tokens");
+  CHECK((!match_shape<std::string, count, real, real>(msg)));
+  CHECK(!match_shape<count>(data{"no vector"}));
+}
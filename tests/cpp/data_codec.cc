@@ -0,0 +1,110 @@
+#define SUITE data_codec
+
+#include "broker/detail/data_codec.hh"
+
+#include "test.hh"
+
+#include "broker/data.hh"
+
+using namespace broker;
+
+namespace {
+
+data roundtrip(const data& x) {
+  auto buf = detail::encode(x);
+  auto result = detail::decode(buf);
+  REQUIRE(result);
+  return std::move(*result);
+}
+
+} // namespace
+
+TEST(primitive values) {
+  CHECK_EQUAL(roundtrip(data{}), data{});
+  CHECK_EQUAL(roundtrip(data{true}), data{true});
+  CHECK_EQUAL(roundtrip(data{count{42}}), data{count{42}});
+  CHECK_EQUAL(roundtrip(data{integer{-7}}), data{integer{-7}});
+  CHECK_EQUAL(roundtrip(data{4.2}), data{4.2});
+  CHECK_EQUAL(roundtrip(data{"hello"}), data{"hello"});
+  CHECK_EQUAL(roundtrip(data{enum_value{"foo::bar"}}),
+              data{enum_value{"foo::bar"}});
+}
+
+TEST(network values) {
+  auto addr = unbox(to<address>("2001:db8::1"));
+  CHECK_EQUAL(roundtrip(data{addr}), data{addr});
+  auto sn = subnet{unbox(to<address>("10.0.0.0")), 8};
+  CHECK_EQUAL(roundtrip(data{sn}), data{sn});
+  auto p = port{8080, port::protocol::tcp};
+  CHECK_EQUAL(roundtrip(data{p}), data{p});
+}
+
+TEST(time values) {
+  auto span = timespan{-123456789};
+  CHECK_EQUAL(roundtrip(data{span}), data{span});
+  auto ts = timestamp{timespan{1234567890}};
+  CHECK_EQUAL(roundtrip(data{ts}), data{ts});
+}
+
+TEST(compound values) {
+  auto xs = vector{count{1}, "two", vector{integer{3}, nil}};
+  CHECK_EQUAL(roundtrip(data{xs}), data{xs});
+  auto s = set{data{count{1}}, data{"two"}};
+  CHECK_EQUAL(roundtrip(data{s}), data{s});
+  auto t = table{{data{"key"}, data{count{7}}}, {data{count{1}}, data{"val"}}};
+  CHECK_EQUAL(roundtrip(data{t}), data{t});
+}
+
+TEST(compact encoding) {
+  // A small count occupies one tag byte plus one varint byte.
+  CHECK_EQUAL(detail::encode(data{count{42}}).size(), 2u);
+  // An empty vector occupies one tag byte plus one size byte.
+  CHECK_EQUAL(detail::encode(data{vector{}}).size(), 2u);
+}
+
+TEST(chunked roundtrip) {
+  vector xs;
+  for (int i = 0; i < 1000; ++i)
+    xs.emplace_back(std::string(20, static_cast<char>('a' + i % 26)));
+  auto val = data{std::move(xs)};
+  std::vector<std::vector<std::byte>> chunks;
+  detail::encode_chunked(val, 512, [&](std::vector<std::byte> chunk) {
+    CHECK(chunk.size() <= 512 + 32); // chunk limit plus one encoded element
+    chunks.emplace_back(std::move(chunk));
+  });
+  CHECK(chunks.size() > 1);
+  detail::chunked_decoder dec;
+  for (auto& chunk : chunks)
+    dec.append(chunk);
+  auto result = dec.finish();
+  REQUIRE(result);
+  CHECK_EQUAL(*result, val);
+}
+
+TEST(chunked scalar roundtrip) {
+  auto val = data{std::string(4096, 'x')};
+  detail::chunked_decoder dec;
+  detail::encode_chunked(val, 256, [&](std::vector<std::byte> chunk) {
+    dec.append(chunk);
+  });
+  auto result = dec.finish();
+  REQUIRE(result);
+  CHECK_EQUAL(*result, val);
+}
+
+TEST(chunked truncated input) {
+  auto val = data{vector{count{1}, count{2}, count{3}}};
+  std::vector<std::byte> bytes = detail::encode(val);
+  detail::chunked_decoder dec;
+  dec.append(bytes.data(), bytes.size() - 1);
+  CHECK(!dec.finish());
+}
+
+TEST(malformed input) {
+  auto buf = detail::encode(data{"hello world"});
+  buf.resize(buf.size() / 2);
+  CHECK(!detail::decode(buf));
+  buf.clear();
+  buf.push_back(std::byte{0xFF});
+  CHECK(!detail::decode(buf));
+}
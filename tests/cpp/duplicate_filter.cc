@@ -0,0 +1,66 @@
+#define SUITE duplicate_filter
+
+#include "broker/detail/duplicate_filter.hh"
+
+#include "test.hh"
+
+#include "broker/publisher_id.hh"
+
+using namespace broker;
+
+TEST(detects repeats) {
+  detail::duplicate_filter uut;
+  endpoint_id origin;
+  CHECK(!uut.is_duplicate(origin, 1));
+  CHECK(!uut.is_duplicate(origin, 2));
+  CHECK(!uut.is_duplicate(origin, 3));
+  CHECK(uut.is_duplicate(origin, 1));
+  CHECK(uut.is_duplicate(origin, 2));
+  CHECK(uut.is_duplicate(origin, 3));
+  CHECK(!uut.is_duplicate(origin, 4));
+}
+
+TEST(accepts out of order arrivals inside the window) {
+  detail::duplicate_filter uut;
+  endpoint_id origin;
+  CHECK(!uut.is_duplicate(origin, 10));
+  CHECK(!uut.is_duplicate(origin, 7));
+  CHECK(!uut.is_duplicate(origin, 9));
+  CHECK(uut.is_duplicate(origin, 7));
+  CHECK(uut.is_duplicate(origin, 9));
+  CHECK(!uut.is_duplicate(origin, 8));
+}
+
+TEST(rejects arrivals behind the window) {
+  detail::duplicate_filter uut;
+  endpoint_id origin;
+  CHECK(!uut.is_duplicate(origin, 1));
+  CHECK(!uut.is_duplicate(origin, 100));
+  // Sequence number 1 was seen, anything below 100 - 64 counts as stale.
+  CHECK(uut.is_duplicate(origin, 1));
+  CHECK(uut.is_duplicate(origin, 2));
+  CHECK(!uut.is_duplicate(origin, 99));
+}
+
+TEST(erase resets an origin) {
+  detail::duplicate_filter uut;
+  endpoint_id origin;
+  CHECK(!uut.is_duplicate(origin, 1));
+  CHECK_EQUAL(uut.size(), 1u);
+  uut.erase(origin);
+  CHECK_EQUAL(uut.size(), 0u);
+  CHECK(!uut.is_duplicate(origin, 1));
+}
+
+TEST(works with custom origin keys) {
+  // Store masters key the filter by writer (publisher) instead of by peer.
+  detail::basic_duplicate_filter<publisher_id> uut;
+  publisher_id alice{endpoint_id{}, 1};
+  publisher_id bob{endpoint_id{}, 2};
+  CHECK(!uut.is_duplicate(alice, 1));
+  CHECK(!uut.is_duplicate(bob, 1));
+  CHECK(uut.is_duplicate(alice, 1));
+  CHECK(uut.is_duplicate(bob, 1));
+  CHECK(!uut.is_duplicate(alice, 2));
+  CHECK_EQUAL(uut.size(), 2u);
+}
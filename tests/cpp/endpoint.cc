@@ -0,0 +1,123 @@
+#define SUITE endpoint
+
+#include "broker/endpoint.hh"
+
+#include "test.hh"
+
+#include <stdexcept>
+
+#include <caf/actor_system_config.hpp>
+#include <caf/exit_reason.hpp>
+#include <caf/send.hpp>
+
+#include "broker/detail/filesystem.hh"
+#include "broker/internal/configuration_access.hh"
+#include "broker/internal/native.hh"
+
+using broker::internal::native;
+
+namespace atom = broker::internal::atom;
+
+using namespace broker;
+
+TEST(lazy endpoints defer bring-up until first use) {
+  broker_options opts;
+  opts.lazy_init = true;
+  opts.ignore_broker_conf = true;
+  {
+    MESSAGE("a lazy endpoint that never gets used shuts down without a system");
+    endpoint lazy{configuration{opts}};
+    CHECK(lazy.options().lazy_init);
+  }
+  MESSAGE("the first operation that needs the runtime triggers bring-up");
+  endpoint lazy{configuration{opts}};
+  CHECK(lazy.node_id().valid());
+  lazy.shutdown();
+}
+
+TEST(configuration profiles seed coherent tuning values) {
+  broker_options opts;
+  opts.ignore_broker_conf = true;
+  opts.profile = "low-latency";
+  configuration cfg{opts};
+  auto& content = broker::internal::configuration_access{&cfg}.cfg();
+  CHECK_EQUAL(caf::get_or(content, "broker.dispatcher.stage-capacity",
+                          size_t{0}),
+              size_t{32});
+  CHECK(caf::get_or(content, "broker.detach-stores", false));
+  CHECK_EQUAL(caf::get_or(content, "broker.profile", std::string{}),
+              "low-latency");
+  MESSAGE("unknown profile names get rejected");
+  opts.profile = "warp-speed";
+  auto threw = false;
+  try {
+    configuration bogus{opts};
+  } catch (std::invalid_argument&) {
+    threw = true;
+  }
+  CHECK(threw);
+}
+
+TEST(reconfigure updates runtime-tunable parameters) {
+  broker_options opts;
+  opts.ignore_broker_conf = true;
+  endpoint ep{configuration{opts}};
+  CHECK(ep.reconfigure("broker.dispatcher.flush-interval",
+                       timespan{std::chrono::milliseconds(5)}));
+  CHECK(ep.reconfigure("broker.dispatcher.stage-capacity", count{512}));
+  CHECK(ep.reconfigure("broker.multipath-dedup", false));
+  CHECK(ep.reconfigure("broker.metrics.latency-sample-rate", count{100}));
+  MESSAGE("unknown keys and mismatched value types get rejected");
+  CHECK(!ep.reconfigure("broker.ttl", count{5}));
+  CHECK(!ep.reconfigure("broker.dispatcher.flush-interval", count{5}));
+  CHECK(!ep.reconfigure("broker.dispatcher.stage-capacity", count{0}));
+  ep.shutdown();
+}
+
+TEST(checkpoints round-trip forwarding filter and in-memory stores) {
+  auto dir = detail::make_temp_file_name();
+  {
+    endpoint ep;
+    ep.forward({"/checkpoint/topic"});
+    auto ds = ep.attach_master("cp", backend::memory);
+    REQUIRE(ds);
+    ds->put("foo", 42);
+    REQUIRE_EQUAL(value_of(ds->get("foo")), data{42});
+    REQUIRE(ep.save_checkpoint(dir));
+    CHECK(detail::exists(dir + "/endpoint.meta"));
+    CHECK(detail::exists(dir + "/store-cp.dat"));
+  }
+  MESSAGE("restoring from the checkpoint re-creates the store");
+  {
+    endpoint ep;
+    REQUIRE(ep.restore_checkpoint(dir));
+    // The master already exists after the restore; attaching returns it.
+    auto ds = ep.attach_master("cp", backend::memory);
+    REQUIRE(ds);
+    REQUIRE_EQUAL(value_of(ds->get("foo")), data{42});
+  }
+  MESSAGE("restoring from a missing directory fails");
+  {
+    endpoint ep;
+    CHECK(!ep.restore_checkpoint(dir + ".nope"));
+  }
+  detail::remove_all(dir);
+}
+
+FIXTURE_SCOPE(endpoint_tests, base_fixture)
+
+TEST(logical endpoints share the runtime of their host) {
+  endpoint logical{endpoint::shares_runtime, ep};
+  // Same actor system, hence the same node ID, but a separate core actor.
+  CHECK_EQUAL(logical.node_id(), ep.node_id());
+  CHECK(logical.core() != ep.core());
+  MESSAGE("peer the logical endpoint with its host through the shared system");
+  caf::anon_send(native(logical.core()), atom::peer_v, native(ep.core()));
+  run();
+  MESSAGE("shutting down the logical endpoint leaves the host operational");
+  logical.shutdown();
+  run();
+  CHECK(ep.core());
+}
+
+FIXTURE_SCOPE_END()
@@ -4,6 +4,7 @@
 
 #include "test.hh"
 
+#include "broker/expected.hh"
 #include "broker/internal/native.hh"
 
 #include <string>
@@ -128,4 +129,31 @@ TEST(error view operate directly on raw data) {
   CHECK_EQUAL(net, network_info("foo", 8080, timeout::seconds{42}));
 }
 
+TEST(interned errors are singletons for plain enum codes) {
+  auto& first = interned_error(ec::no_such_key);
+  auto& second = interned_error(ec::no_such_key);
+  CHECK_EQUAL(&first, &second);
+  CHECK(first == make_error(ec::no_such_key));
+  CHECK(first.message() == nullptr);
+}
+
+TEST(plain code expected propagates without materializing an error) {
+  expected<data> miss{ec::no_such_key};
+  REQUIRE(!miss);
+  // Const access hands out the interned singleton.
+  CHECK_EQUAL(&miss.cerror(), &interned_error(ec::no_such_key));
+  CHECK(miss == ec::no_such_key);
+  CHECK(miss != ec::type_clash);
+  auto copy = miss;
+  CHECK_EQUAL(&copy.cerror(), &interned_error(ec::no_such_key));
+  // Mutable access materializes a full error object.
+  auto& ref = copy.error();
+  CHECK_NOT_EQUAL(&ref, &interned_error(ec::no_such_key));
+  CHECK(copy == ec::no_such_key);
+  // Context-carrying errors travel by value, as before.
+  expected<data> failure{make_error(ec::backend_failure, "disk on fire")};
+  REQUIRE(failure.cerror().message() != nullptr);
+  CHECK_EQUAL(*failure.cerror().message(), "disk on fire");
+}
+
 FIXTURE_SCOPE_END()
@@ -4,6 +4,8 @@
 
 #include "test.hh"
 
+#include "broker/detail/prefix_matcher.hh"
+
 using namespace broker;
 
 namespace {
@@ -39,4 +41,35 @@ TEST(extending a filter with known topics does nothing) {
   CHECK_EQUAL(f, make("/foo/bar", "/foo/baz", "/zeek"));
 }
 
+TEST(wildcard segments match exactly one topic segment) {
+  topic pattern = "zeek/logs/*/conn";
+  CHECK(pattern.contains_wildcard());
+  CHECK(!topic{"zeek/logs/conn"}.contains_wildcard());
+  CHECK(!topic{"zeek/l*gs/conn"}.contains_wildcard());
+  CHECK(detail::match_topic_pattern(pattern, "zeek/logs/proxy-1/conn"));
+  CHECK(detail::match_topic_pattern(pattern, "zeek/logs/proxy-1/conn/extra"));
+  CHECK(!detail::match_topic_pattern(pattern, "zeek/logs/proxy-1/dns"));
+  CHECK(!detail::match_topic_pattern(pattern, "zeek/logs/conn"));
+  CHECK(!detail::match_topic_pattern(pattern, "zeek/logs/a/b/conn"));
+}
+
+TEST(the prefix matcher understands wildcard entries) {
+  detail::prefix_matcher accept;
+  auto f = make("/foo/bar", "zeek/logs/*/conn");
+  CHECK(accept(f, topic{"/foo/bar/baz"}));
+  CHECK(accept(f, topic{"zeek/logs/proxy-1/conn"}));
+  CHECK(!accept(f, topic{"zeek/logs/proxy-1/dns"}));
+}
+
+TEST(compiled patterns keep only wildcard entries) {
+  detail::compiled_patterns patterns;
+  patterns.assign(make("/foo/bar", "/zeek"));
+  CHECK(patterns.empty());
+  patterns.assign(make("/foo/bar", "zeek/logs/*/conn", "*/telemetry"));
+  CHECK(!patterns.empty());
+  CHECK(patterns.matches("zeek/logs/proxy-1/conn"));
+  CHECK(patterns.matches("worker-7/telemetry/cpu"));
+  CHECK(!patterns.matches("/foo/bar"));
+}
+
 FIXTURE_SCOPE_END()
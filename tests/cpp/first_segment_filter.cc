@@ -0,0 +1,43 @@
+#define SUITE first_segment_filter
+
+#include "broker/detail/first_segment_filter.hh"
+
+#include "test.hh"
+
+using namespace broker;
+
+TEST(empty filter rejects everything) {
+  detail::first_segment_filter f;
+  CHECK(f.active());
+  CHECK(!f.may_match("/zeek/event/foo"_t));
+}
+
+TEST(matching segments pass) {
+  detail::first_segment_filter f;
+  f.assign({"/zeek/event/"_t, "/zeek/log/conn"_t});
+  CHECK(f.active());
+  CHECK(f.may_match("/zeek/event/foo"_t));
+  CHECK(f.may_match("/zeek/log/conn"_t));
+}
+
+TEST(non matching segments get rejected) {
+  detail::first_segment_filter f;
+  f.assign({"/zeek/event/"_t, "/store/master"_t});
+  CHECK(!f.may_match("/other/event/foo"_t));
+}
+
+TEST(wildcard first segment disables the fast path) {
+  detail::first_segment_filter uut;
+  uut.assign({"*/telemetry"});
+  CHECK(!uut.active());
+  CHECK(uut.may_match("worker-7/telemetry"));
+}
+
+TEST(partial first segment disables the fast path) {
+  detail::first_segment_filter f;
+  // "/ze" may prefix-match "/zeek/...", so segment hashing must not engage.
+  f.assign({"/ze"_t});
+  CHECK(!f.active());
+  CHECK(f.may_match("/zeek/event/foo"_t));
+  CHECK(f.may_match("/anything"_t));
+}
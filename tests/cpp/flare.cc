@@ -0,0 +1,32 @@
+#define SUITE flare
+
+#include "broker/detail/flare.hh"
+
+#include "test.hh"
+
+#include "broker/config.hh"
+
+using namespace broker;
+
+TEST(fire and extinguish) {
+  detail::flare uut;
+  uut.fire(3);
+  CHECK(uut.extinguish_one());
+  CHECK_EQUAL(uut.extinguish(), 2u);
+  CHECK(!uut.extinguish_one());
+}
+
+TEST(spin probe reports readiness without consuming) {
+  detail::flare uut;
+  CHECK(!uut.spin_await_one(16));
+#ifdef BROKER_LINUX
+  // Only the eventfd-based implementation can observe its count cheaply; the
+  // pipe-based fallback always reports not-ready and callers fall through to
+  // the blocking fd wait.
+  uut.fire();
+  CHECK(uut.spin_await_one(16));
+  CHECK(uut.spin_await_one(1));
+  CHECK(uut.extinguish_one());
+  CHECK(!uut.spin_await_one(16));
+#endif
+}
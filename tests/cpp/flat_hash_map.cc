@@ -0,0 +1,127 @@
+#define SUITE flat_hash_map
+
+#include "broker/detail/flat_hash_map.hh"
+
+#include "test.hh"
+
+#include <set>
+#include <string>
+
+using namespace broker;
+
+namespace {
+
+using string_map = detail::flat_hash_map<std::string, int>;
+
+} // namespace
+
+TEST(insert and find) {
+  string_map xs;
+  CHECK(xs.empty());
+  CHECK(xs.insert({"foo", 1}).second);
+  CHECK(xs.insert({"bar", 2}).second);
+  CHECK(!xs.insert({"foo", 3}).second);
+  CHECK_EQUAL(xs.size(), 2u);
+  REQUIRE(xs.find("foo") != xs.end());
+  CHECK_EQUAL(xs.find("foo")->second, 1);
+  CHECK(xs.find("baz") == xs.end());
+}
+
+TEST(subscript operator) {
+  string_map xs;
+  xs["foo"] = 1;
+  xs["foo"] = 2;
+  xs["bar"] = 3;
+  CHECK_EQUAL(xs.size(), 2u);
+  CHECK_EQUAL(xs["foo"], 2);
+  CHECK_EQUAL(xs["bar"], 3);
+  CHECK_EQUAL(xs["baz"], 0);
+  CHECK_EQUAL(xs.size(), 3u);
+}
+
+TEST(erase) {
+  string_map xs;
+  xs["foo"] = 1;
+  xs["bar"] = 2;
+  CHECK_EQUAL(xs.erase("foo"), 1u);
+  CHECK_EQUAL(xs.erase("foo"), 0u);
+  CHECK_EQUAL(xs.size(), 1u);
+  CHECK(xs.find("foo") == xs.end());
+  REQUIRE(xs.find("bar") != xs.end());
+  xs.erase(xs.find("bar"));
+  CHECK(xs.empty());
+}
+
+TEST(iteration) {
+  string_map xs;
+  std::set<std::string> expected;
+  for (int i = 0; i < 100; ++i) {
+    auto key = "key-" + std::to_string(i);
+    xs[key] = i;
+    expected.insert(key);
+  }
+  std::set<std::string> found;
+  for (const auto& [key, value] : xs) {
+    CHECK_EQUAL(value, std::stoi(key.substr(4)));
+    found.insert(key);
+  }
+  CHECK_EQUAL(found, expected);
+}
+
+TEST(growth keeps entries reachable) {
+  // Push the table through several doublings and interleave deletions, which
+  // exercises the robin-hood displacement and backward-shift paths.
+  string_map xs;
+  for (int i = 0; i < 1000; ++i)
+    xs["key-" + std::to_string(i)] = i;
+  for (int i = 0; i < 1000; i += 2)
+    CHECK_EQUAL(xs.erase("key-" + std::to_string(i)), 1u);
+  CHECK_EQUAL(xs.size(), 500u);
+  for (int i = 0; i < 1000; ++i) {
+    auto i_iter = xs.find("key-" + std::to_string(i));
+    if (i % 2 == 0) {
+      CHECK(i_iter == xs.end());
+    } else {
+      REQUIRE(i_iter != xs.end());
+      CHECK_EQUAL(i_iter->second, i);
+    }
+  }
+}
+
+TEST(copy and move) {
+  string_map xs;
+  xs["foo"] = 1;
+  xs["bar"] = 2;
+  auto ys = xs;
+  CHECK_EQUAL(ys.size(), 2u);
+  CHECK_EQUAL(ys["foo"], 1);
+  auto zs = std::move(ys);
+  CHECK_EQUAL(zs.size(), 2u);
+  CHECK_EQUAL(zs["bar"], 2);
+  CHECK_EQUAL(xs.size(), 2u);
+}
+
+TEST(shrink to fit keeps entries reachable) {
+  // Grow the table through several doublings, drain most of it and shrink,
+  // which rehashes the survivors into a much smaller table.
+  string_map xs;
+  for (int i = 0; i < 1000; ++i)
+    xs["key-" + std::to_string(i)] = i;
+  for (int i = 10; i < 1000; ++i)
+    CHECK_EQUAL(xs.erase("key-" + std::to_string(i)), 1u);
+  xs.shrink_to_fit();
+  CHECK_EQUAL(xs.size(), 10u);
+  for (int i = 0; i < 10; ++i) {
+    auto i_iter = xs.find("key-" + std::to_string(i));
+    REQUIRE(i_iter != xs.end());
+    CHECK_EQUAL(i_iter->second, i);
+  }
+  // Shrinking an empty table releases everything; it must stay usable.
+  for (int i = 0; i < 10; ++i)
+    xs.erase("key-" + std::to_string(i));
+  xs.shrink_to_fit();
+  CHECK(xs.empty());
+  CHECK(xs.find("key-0") == xs.end());
+  xs["key-0"] = 42;
+  CHECK_EQUAL(xs["key-0"], 42);
+}
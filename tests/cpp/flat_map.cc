@@ -0,0 +1,52 @@
+#define SUITE flat_map
+
+#include "broker/detail/flat_map.hh"
+
+#include "test.hh"
+
+#include <string>
+
+using namespace broker;
+
+namespace {
+
+using string_map = detail::flat_map<std::string, int>;
+
+} // namespace
+
+TEST(insert and find) {
+  string_map xs;
+  CHECK(xs.empty());
+  CHECK(xs.insert({"foo", 1}).second);
+  CHECK(xs.insert({"bar", 2}).second);
+  CHECK(!xs.insert({"foo", 3}).second);
+  CHECK_EQUAL(xs.size(), 2u);
+  REQUIRE(xs.find("foo") != xs.end());
+  CHECK_EQUAL(xs.find("foo")->second, 1);
+  CHECK(xs.find("baz") == xs.end());
+}
+
+TEST(sorted iteration) {
+  string_map xs{{"c", 3}, {"a", 1}, {"b", 2}};
+  REQUIRE_EQUAL(xs.size(), 3u);
+  auto i = xs.begin();
+  CHECK_EQUAL(i->first, "a");
+  CHECK_EQUAL((++i)->first, "b");
+  CHECK_EQUAL((++i)->first, "c");
+}
+
+TEST(subscript operator) {
+  string_map xs;
+  xs["foo"] = 1;
+  xs["foo"] = 2;
+  CHECK_EQUAL(xs.size(), 1u);
+  CHECK_EQUAL(xs["foo"], 2);
+}
+
+TEST(erase) {
+  string_map xs{{"a", 1}, {"b", 2}};
+  CHECK_EQUAL(xs.erase("a"), 1u);
+  CHECK_EQUAL(xs.erase("a"), 0u);
+  CHECK_EQUAL(xs.size(), 1u);
+  CHECK_EQUAL(xs.count("b"), 1u);
+}
@@ -0,0 +1,46 @@
+#define SUITE format
+
+#include "broker/format.hh"
+
+#include "test.hh"
+
+#include <sstream>
+
+#include "broker/data.hh"
+#include "broker/topic.hh"
+
+using namespace broker;
+
+namespace {
+
+data make_nested() {
+  table xs;
+  xs.emplace(data{"key"}, data{vector{data{1}, data{true}, data{"three"}}});
+  xs.emplace(data{42u}, data{set{data{1.5}, data{"x"}}});
+  return data{std::move(xs)};
+}
+
+} // namespace
+
+TEST(format_to produces the same text as to_string) {
+  auto x = make_nested();
+  std::string buf;
+  format_to(buf, x);
+  CHECK_EQUAL(buf, to_string(x));
+  buf.clear();
+  format_to(buf, topic{"/zeek/events"});
+  CHECK_EQUAL(buf, "/zeek/events");
+}
+
+TEST(format_to appends to the caller buffer) {
+  std::string buf = "data: ";
+  format_to(buf, data{vector{data{1}, data{2}}});
+  CHECK_EQUAL(buf, "data: (1, 2)");
+}
+
+TEST(lazy formatters materialize when streamed) {
+  auto x = make_nested();
+  std::ostringstream os;
+  os << format_lazy(x);
+  CHECK_EQUAL(os.str(), to_string(x));
+}
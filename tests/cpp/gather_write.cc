@@ -0,0 +1,103 @@
+#define SUITE gather_write
+
+#include "broker/detail/gather_write.hh"
+
+#include "test.hh"
+
+#include <cstring>
+
+#include "broker/message.hh"
+
+#ifndef BROKER_WINDOWS
+#include <unistd.h>
+#endif
+
+using namespace broker;
+
+namespace {
+
+std::vector<std::byte> to_bytes(const detail::segment_list& segments,
+                                const std::vector<std::byte>& scratch,
+                                detail::native_socket read_fd,
+                                detail::native_socket write_fd) {
+  // Round-trip through a pipe to exercise the vectored write path.
+  std::vector<std::byte> result;
+#ifndef BROKER_WINDOWS
+  auto copy = segments;
+  REQUIRE(copy.write_all(write_fd));
+  result.resize(copy.total_bytes());
+  size_t pos = 0;
+  while (pos < result.size()) {
+    auto res = ::read(read_fd, result.data() + pos, result.size() - pos);
+    REQUIRE(res > 0);
+    pos += static_cast<size_t>(res);
+  }
+#else
+  // fallback: unused on Windows CI
+  static_cast<void>(scratch);
+  static_cast<void>(read_fd);
+  static_cast<void>(write_fd);
+#endif
+  return result;
+}
+
+} // namespace
+
+#ifndef BROKER_WINDOWS
+
+TEST(frames round trip through vectored writes) {
+  int fds[2];
+  REQUIRE_EQUAL(::pipe(fds), 0);
+  std::vector<std::byte> scratch;
+  detail::segment_list segments{&scratch};
+  auto msg1 = make_data_message("zeek/events", data{count{42}});
+  auto msg2 = make_data_message("zeek/logs", data{"hello"});
+  detail::encode_frame(msg1, scratch, segments);
+  detail::encode_frame(msg2, scratch, segments);
+  CHECK(segments.size() >= 6u);
+  auto bytes = to_bytes(segments, scratch, fds[0], fds[1]);
+  CHECK_EQUAL(bytes.size(), segments.total_bytes());
+  size_t consumed = 0;
+  auto copy1 = detail::decode_frame(bytes.data(), bytes.size(), consumed);
+  REQUIRE(copy1);
+  CHECK_EQUAL(get_topic(*copy1).string(), get_topic(msg1).string());
+  CHECK_EQUAL(get_data(*copy1), get_data(msg1));
+  auto offset = consumed;
+  auto copy2 = detail::decode_frame(bytes.data() + offset,
+                                    bytes.size() - offset, consumed);
+  REQUIRE(copy2);
+  CHECK_EQUAL(get_topic(*copy2).string(), get_topic(msg2).string());
+  CHECK_EQUAL(get_data(*copy2), get_data(msg2));
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST(incomplete frames request more input) {
+  std::vector<std::byte> scratch;
+  detail::segment_list segments{&scratch};
+  auto msg = make_data_message("zeek/events", data{count{42}});
+  detail::encode_frame(msg, scratch, segments);
+  // Assemble the full frame, then truncate it.
+  std::vector<std::byte> bytes;
+  detail::encode_varint(get_topic(msg).string().size(), bytes);
+  auto topic_str = get_topic(msg).string();
+  std::vector<std::byte> payload;
+  detail::encode(get_data(msg), payload);
+  detail::encode_varint(payload.size(), bytes);
+  auto* ptr = reinterpret_cast<const std::byte*>(topic_str.data());
+  bytes.insert(bytes.end(), ptr, ptr + topic_str.size());
+  bytes.insert(bytes.end(), payload.begin(), payload.end());
+  size_t consumed = 0;
+  for (size_t cut = 0; cut < bytes.size(); ++cut) {
+    auto res = detail::decode_frame(bytes.data(), cut, consumed);
+    REQUIRE(!res);
+    CHECK_EQUAL(res.error(), ec::end_of_file);
+  }
+  auto res = detail::decode_frame(bytes.data(), bytes.size(), consumed);
+  REQUIRE(res);
+  CHECK_EQUAL(get_topic(*res).string(), get_topic(msg).string());
+  CHECK_EQUAL(get_data(*res), get_data(msg));
+  CHECK_EQUAL(consumed, bytes.size());
+}
+
+#endif // BROKER_WINDOWS
@@ -0,0 +1,40 @@
+#define SUITE handshake_gate
+
+#include "broker/detail/handshake_gate.hh"
+
+#include "test.hh"
+
+using namespace broker;
+
+using detail::handshake_gate;
+
+TEST(the pending cap bounds in-flight handshakes) {
+  handshake_gate gate{0, 0, 2};
+  CHECK(gate.try_admit());
+  CHECK(gate.try_admit());
+  CHECK_EQUAL(gate.pending(), 2u);
+  CHECK(!gate.try_admit());
+  CHECK_EQUAL(gate.rejected(), 1u);
+  gate.done();
+  CHECK_EQUAL(gate.pending(), 1u);
+  CHECK(gate.try_admit());
+}
+
+TEST(the token bucket denies handshakes beyond the burst) {
+  // A negligible refill rate keeps the bucket empty after the burst drains.
+  handshake_gate gate{0.001, 2, 0};
+  CHECK(gate.try_admit());
+  CHECK(gate.try_admit());
+  CHECK(!gate.try_admit());
+  CHECK_EQUAL(gate.rejected(), 1u);
+  // Denied handshakes must not leak in-flight slots.
+  CHECK_EQUAL(gate.pending(), 2u);
+}
+
+TEST(a gate without limits admits everything) {
+  handshake_gate gate{0, 0, 0};
+  for (int i = 0; i < 100; ++i)
+    CHECK(gate.try_admit());
+  CHECK_EQUAL(gate.rejected(), 0u);
+  CHECK_EQUAL(gate.pending(), 100u);
+}
@@ -0,0 +1,50 @@
+#define SUITE hash
+
+#include "broker/detail/hash.hh"
+
+#include "test.hh"
+
+#include <set>
+#include <string>
+
+#include "broker/data.hh"
+
+using namespace broker;
+
+TEST(hash_bytes is deterministic and seeded) {
+  std::string str = "/zeek/events/example";
+  auto h = detail::hash_bytes(str.data(), str.size());
+  CHECK_EQUAL(h, detail::hash_bytes(str.data(), str.size()));
+  CHECK(h != detail::hash_bytes(str.data(), str.size(), 1));
+  CHECK(h != detail::hash_bytes(str.data(), str.size() - 1));
+}
+
+TEST(hash_bytes separates distinct inputs across all length paths) {
+  // Lengths 0 to 100 cover the short, mid-size and bulk loops.
+  std::set<uint64_t> digests;
+  std::string buf;
+  for (int i = 0; i <= 100; ++i) {
+    digests.insert(detail::hash_bytes(buf.data(), buf.size()));
+    buf.push_back(static_cast<char>('a' + i % 26));
+  }
+  CHECK_EQUAL(digests.size(), 101u);
+}
+
+TEST(hash_combine64 is order-sensitive) {
+  CHECK(detail::hash_combine64(1, 2) != detail::hash_combine64(2, 1));
+}
+
+TEST(fast_hash digests equal data equally) {
+  data x{vector{1, "two", 3.0}};
+  data y{vector{1, "two", 3.0}};
+  CHECK_EQUAL(detail::fast_hash(x), detail::fast_hash(y));
+  CHECK_EQUAL(std::hash<data>{}(x), detail::fast_hash(x));
+}
+
+TEST(fast_hash separates types and element orders) {
+  CHECK(detail::fast_hash(data{count{1}}) != detail::fast_hash(data{1}));
+  CHECK(detail::fast_hash(data{vector{1, 2}})
+        != detail::fast_hash(data{vector{2, 1}}));
+  CHECK(detail::fast_hash(data{std::string{"foo"}})
+        != detail::fast_hash(data{enum_value{"foo"}}));
+}
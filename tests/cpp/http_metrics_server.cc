@@ -0,0 +1,116 @@
+#define SUITE http_metrics_server
+
+#include "broker/detail/http_metrics_server.hh"
+
+#include "test.hh"
+
+#ifndef BROKER_WINDOWS
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+using namespace broker;
+
+using detail::http_metrics_server;
+using detail::invalid_native_socket;
+using detail::native_socket;
+
+namespace {
+
+/// Opens a TCP connection to 127.0.0.1 on `port`.
+native_socket dial(uint16_t port) {
+  auto fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0)
+    return invalid_native_socket;
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return invalid_native_socket;
+  }
+  return fd;
+}
+
+bool send_all(native_socket fd, std::string_view bytes) {
+  size_t written = 0;
+  while (written < bytes.size()) {
+    auto n = ::send(fd, bytes.data() + written, bytes.size() - written, 0);
+    if (n <= 0)
+      return false;
+    written += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+/// Reads until `buf` contains `what` at least `num` times or the peer closes.
+size_t read_until_count(native_socket fd, std::string& buf,
+                        const std::string& what, size_t num) {
+  auto occurrences = [&] {
+    size_t result = 0;
+    size_t pos = 0;
+    while ((pos = buf.find(what, pos)) != std::string::npos) {
+      ++result;
+      pos += what.size();
+    }
+    return result;
+  };
+  char chunk[4096];
+  while (occurrences() < num) {
+    auto n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0)
+      break;
+    buf.append(chunk, static_cast<size_t>(n));
+  }
+  return occurrences();
+}
+
+} // namespace
+
+TEST(pipelined scrapes share one connection) {
+  http_metrics_server server;
+  auto port = server.start(0);
+  REQUIRE(port);
+  server.update("broker_test_metric 42\n");
+  auto fd = dial(*port);
+  REQUIRE(fd != invalid_native_socket);
+  // Two pipelined requests must yield two in-order responses on the same
+  // connection, both served from the cached buffer.
+  REQUIRE(send_all(fd, "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n"
+                       "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n"));
+  std::string buf;
+  CHECK_EQUAL(read_until_count(fd, buf, "broker_test_metric 42", 2), 2u);
+  CHECK_EQUAL(read_until_count(fd, buf, "Connection: keep-alive", 2), 2u);
+  // The connection stays open: a third request still gets an answer, now
+  // with refreshed content.
+  server.update("broker_test_metric 43\n");
+  REQUIRE(send_all(fd, "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n"));
+  CHECK_EQUAL(read_until_count(fd, buf, "broker_test_metric 43", 1), 1u);
+  ::close(fd);
+  server.stop();
+}
+
+TEST(unsupported requests are rejected and closed) {
+  http_metrics_server server;
+  auto port = server.start(0);
+  REQUIRE(port);
+  auto fd = dial(*port);
+  REQUIRE(fd != invalid_native_socket);
+  REQUIRE(send_all(fd, "POST /metrics HTTP/1.1\r\nHost: x\r\n\r\n"));
+  std::string buf;
+  CHECK_EQUAL(read_until_count(fd, buf, "501 Not Implemented", 1), 1u);
+  // The server closes after the error response.
+  char chunk[64];
+  CHECK(::recv(fd, chunk, sizeof(chunk), 0) == 0);
+  ::close(fd);
+  server.stop();
+}
+
+#endif // BROKER_WINDOWS
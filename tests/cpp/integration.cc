@@ -152,7 +152,7 @@ struct peer_fixture {
   }
 
   std::vector<peer_info> peers() {
-    sched.inline_next_enqueue();
+    // Reads the published snapshot; no need to schedule the core.
     return ep.peers();
   }
 
@@ -298,18 +298,15 @@ CAF_TEST_FIXTURE_SCOPE(triangle_use_cases, triangle_fixture)
 CAF_TEST(topic_prefix_matching_async_subscribe) {
   connect_peers();
   MESSAGE("assume two peers for mercury");
-  mercury.loop_after_next_enqueue();
   auto mercury_peers = mercury.ep.peers();
   CAF_REQUIRE_EQUAL(mercury_peers.size(), 2u);
   CAF_CHECK_EQUAL(mercury_peers.front().status, peer_status::peered);
   CAF_CHECK_EQUAL(mercury_peers.back().status, peer_status::peered);
   MESSAGE("assume one peer for venus");
-  venus.loop_after_next_enqueue();
   auto venus_peers = venus.ep.peers();
   CAF_REQUIRE_EQUAL(venus_peers.size(), 1u);
   CAF_CHECK_EQUAL(venus_peers.front().status, peer_status::peered);
   MESSAGE("assume one peer for earth");
-  earth.loop_after_next_enqueue();
   auto earth_peers = earth.ep.peers();
   CAF_REQUIRE_EQUAL(earth_peers.size(), 1u);
   CAF_CHECK_EQUAL(earth_peers.front().status, peer_status::peered);
@@ -350,18 +347,15 @@ CAF_TEST(topic_prefix_matching_async_subscribe) {
 CAF_TEST(topic_prefix_matching_make_subscriber) {
   connect_peers();
   MESSAGE("assume two peers for mercury");
-  mercury.loop_after_next_enqueue();
   auto mercury_peers = mercury.ep.peers();
   CAF_REQUIRE_EQUAL(mercury_peers.size(), 2u);
   CAF_CHECK_EQUAL(mercury_peers.front().status, peer_status::peered);
   CAF_CHECK_EQUAL(mercury_peers.back().status, peer_status::peered);
   MESSAGE("assume one peer for venus");
-  venus.loop_after_next_enqueue();
   auto venus_peers = venus.ep.peers();
   CAF_REQUIRE_EQUAL(venus_peers.size(), 1u);
   CAF_CHECK_EQUAL(venus_peers.front().status, peer_status::peered);
   MESSAGE("assume one peer for earth");
-  earth.loop_after_next_enqueue();
   auto earth_peers = earth.ep.peers();
   CAF_REQUIRE_EQUAL(earth_peers.size(), 1u);
   CAF_CHECK_EQUAL(earth_peers.front().status, peer_status::peered);
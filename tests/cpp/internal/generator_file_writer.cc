@@ -8,6 +8,9 @@
 #include "broker/internal/generator_file_reader.hh"
 #include "broker/internal/type_id.hh"
 
+#include <chrono>
+#include <thread>
+
 using namespace broker;
 
 namespace {
@@ -84,4 +87,69 @@ CAF_TEST(command_message roundtrip with generator_file_reader) {
   CHECK_EQUAL(reader->read(y_msg), ec::end_of_file);
 }
 
+#ifdef BROKER_HAVE_ZLIB
+
+CAF_TEST(compressed files roundtrip across frame boundaries) {
+  std::vector<data_message> inputs;
+  for (int i = 0; i < 100; ++i)
+    inputs.emplace_back(make_data_message(
+      "foo/bar", vector{i, "lorem ipsum dolor sit amet", std::string(64, 'x')}));
+  {
+    auto out = internal::make_generator_file_writer(file_name, true);
+    REQUIRE_NOT_EQUAL(out, nullptr);
+    // Force several compressed frames.
+    out->flush_threshold(512);
+    for (auto& msg : inputs)
+      *out << msg;
+  }
+  auto reader = internal::make_generator_file_reader(file_name);
+  REQUIRE_NOT_EQUAL(reader, nullptr);
+  std::vector<data_message> outputs;
+  std::variant<data_message, command_message> y_msg;
+  while (!reader->at_end()) {
+    REQUIRE_EQUAL(reader->read(y_msg), caf::none);
+    REQUIRE(is_data_message(y_msg));
+    outputs.emplace_back(get<data_message>(std::move(y_msg)));
+  }
+  REQUIRE_EQUAL(outputs.size(), inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i)
+    CHECK_EQUAL(get_data(outputs[i]), get_data(inputs[i]));
+  CHECK_EQUAL(reader->data_entries(), inputs.size());
+  // Reading again after a rewind yields the same entries.
+  reader->rewind();
+  size_t rewound = 0;
+  while (!reader->at_end()) {
+    REQUIRE_EQUAL(reader->read(y_msg), caf::none);
+    ++rewound;
+  }
+  CHECK_EQUAL(rewound, inputs.size());
+}
+
+#endif // BROKER_HAVE_ZLIB
+
+CAF_TEST(timed files record gaps between messages) {
+  {
+    auto out = internal::make_generator_file_writer(file_name, false, true);
+    REQUIRE_NOT_EQUAL(out, nullptr);
+    *out << make_data_message("foo/bar", data{1});
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    *out << make_data_message("foo/bar", data{2});
+  }
+  auto reader = internal::make_generator_file_reader(file_name);
+  REQUIRE_NOT_EQUAL(reader, nullptr);
+  CHECK_EQUAL(reader->version(),
+              internal::generator_file_writer::format::version_timed);
+  std::variant<data_message, command_message> y_msg;
+  // The first message has no predecessor, hence no gap.
+  REQUIRE_EQUAL(reader->read(y_msg), caf::none);
+  CHECK_EQUAL(reader->drain_gap(), timespan{0});
+  // The second message recorded the sleep as its gap.
+  REQUIRE_EQUAL(reader->read(y_msg), caf::none);
+  auto gap = reader->drain_gap();
+  CHECK_GREATER_EQUAL(gap, timespan{std::chrono::milliseconds(5)});
+  // Draining resets the gap.
+  CHECK_EQUAL(reader->drain_gap(), timespan{0});
+  CHECK_EQUAL(reader->at_end(), true);
+}
+
 CAF_TEST_FIXTURE_SCOPE_END()
@@ -0,0 +1,68 @@
+#define SUITE lag_watchdog
+
+#include "broker/internal/lag_watchdog.hh"
+
+#include "test.hh"
+
+#include "broker/internal/metric_scraper.hh"
+#include "broker/internal/metric_view.hh"
+
+namespace atom = broker::internal::atom;
+
+using namespace broker;
+using namespace std::literals;
+
+namespace {
+
+struct dummy_state {
+  caf::event_based_actor* self;
+  size_t pings = 0;
+
+  dummy_state(caf::event_based_actor* self) : self(self) {
+    // nop
+  }
+
+  caf::behavior make_behavior() {
+    internal::enroll_with_lag_watchdog(self);
+    return {
+      [this](atom::ping, timestamp sent) {
+        ++pings;
+        internal::record_scheduler_lag(self->system(), "dummy", sent);
+      },
+    };
+  }
+};
+
+using dummy_actor = caf::stateful_actor<dummy_state>;
+
+struct fixture : base_fixture {};
+
+} // namespace
+
+FIXTURE_SCOPE(lag_watchdog_tests, fixture)
+
+TEST(the watchdog probes enrolled actors once per interval) {
+  auto dog = sys.spawn<internal::lag_watchdog_actor>(caf::timespan{1s});
+  sched.run();
+  auto aut = sys.spawn<dummy_actor>();
+  sched.run();
+  run(1s);
+  CHECK_EQUAL(deref<dummy_actor>(aut).state.pings, 1u);
+  run(2s);
+  CHECK_EQUAL(deref<dummy_actor>(aut).state.pings, 3u);
+  // The probes materialize as per-actor histograms in the registry.
+  internal::metric_scraper scraper{"test"};
+  scraper.scrape(sys.metrics());
+  auto found = false;
+  for (const auto& row : scraper.rows())
+    if (auto mv = internal::metric_view{row};
+        mv && mv.name() == "scheduler-lag")
+      found = true;
+  CHECK(found);
+  // Terminating the last enrolled actor stops the watchdog.
+  anon_send_exit(aut, caf::exit_reason::user_shutdown);
+  run(1s);
+  CHECK(sys.registry().get(internal::lag_watchdog_registry_key) == nullptr);
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,78 @@
+#define SUITE metric_codec
+
+#include "broker/internal/metric_codec.hh"
+
+#include "test.hh"
+
+using namespace broker;
+
+using namespace std::literals;
+
+namespace {
+
+data meta_row() {
+  return data{vector{"exporter-1"s, timestamp{timespan{1'000'000'000}}}};
+}
+
+data counter_row() {
+  return data{vector{"foo"s, "c1"s, "counter"s, "1"s, "Int Counter!"s, true,
+                     table{{"sys"s, "broker"s}}, integer{42}}};
+}
+
+data gauge_row() {
+  return data{vector{"foo"s, "g1"s, "gauge"s, "1"s, "Dbl Gauge!"s, false,
+                     table{}, 2.5}};
+}
+
+data histogram_row() {
+  auto buckets = vector{vector{integer{8}, integer{1}},
+                        vector{integer{16}, integer{2}},
+                        vector{integer{32}, integer{0}}, integer{24}};
+  return data{vector{"foo"s, "h1"s, "histogram"s, "seconds"s,
+                     "Int Histogram!"s, true, table{{"sys"s, "broker"s}},
+                     std::move(buckets)}};
+}
+
+} // namespace
+
+TEST(the binary format reproduces the original rows) {
+  vector rows{meta_row(), counter_row(), gauge_row(), histogram_row()};
+  auto blob = internal::encode_metric_rows(rows);
+  CHECK(internal::is_metric_blob(data{blob}));
+  auto decoded = internal::decode_metric_rows(blob);
+  REQUIRE(decoded);
+  CHECK_EQUAL(*decoded, rows);
+}
+
+TEST(the encoder drops rows that do not match the metric schema) {
+  vector rows{meta_row(), data{"bogus"s}, counter_row()};
+  auto decoded = internal::decode_metric_rows(internal::encode_metric_rows(rows));
+  REQUIRE(decoded);
+  REQUIRE_EQUAL(decoded->size(), 2u);
+  CHECK_EQUAL((*decoded)[0], rows[0]);
+  CHECK_EQUAL((*decoded)[1], rows[2]);
+}
+
+TEST(the decoder rejects hostile row counts) {
+  vector rows{meta_row()};
+  auto blob = internal::encode_metric_rows(rows);
+  // A meta-only blob ends in the zero row count; replace it with a count
+  // that no payload of this size could hold.
+  blob.pop_back();
+  auto hostile = uint64_t{1} << 60;
+  while (hostile >= 0x80) {
+    blob.push_back(static_cast<char>((hostile & 0x7f) | 0x80));
+    hostile >>= 7;
+  }
+  blob.push_back(static_cast<char>(hostile));
+  CHECK(!internal::decode_metric_rows(blob));
+}
+
+TEST(the decoder rejects malformed input) {
+  CHECK(!internal::is_metric_blob(data{"no magic here"s}));
+  CHECK(!internal::decode_metric_rows("no magic here"));
+  vector rows{meta_row(), counter_row()};
+  auto blob = internal::encode_metric_rows(rows);
+  blob.resize(blob.size() / 2); // truncate
+  CHECK(!internal::decode_metric_rows(blob));
+}
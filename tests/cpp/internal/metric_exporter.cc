@@ -168,6 +168,32 @@ TEST(the exporter runs once per interval) {
   }
 }
 
+TEST(the exporter ships deltas between full syncs) {
+  auto published = [this]() -> const vector& {
+    return get<vector>(get_data(core_state().last_message));
+  };
+  foo_bar->inc();
+  sched.advance_time(2s);
+  expect((caf::tick_atom), to(aut));
+  expect((atom::publish, data_message), from(aut).to(core));
+  // The first publish always ships the full set.
+  CHECK_EQUAL(published().size(), 3u);
+  // With no changes since the last scrape, only the meta row goes out.
+  sched.advance_time(2s);
+  expect((caf::tick_atom), to(aut));
+  expect((atom::publish, data_message), from(aut).to(core));
+  CHECK_EQUAL(published().size(), 1u);
+  // A changed gauge travels as meta row plus the one updated row.
+  foo_bar->inc();
+  sched.advance_time(2s);
+  expect((caf::tick_atom), to(aut));
+  expect((atom::publish, data_message), from(aut).to(core));
+  if (CHECK_EQUAL(published().size(), 2u))
+    CHECK_EQUAL(published().at(1),
+                (metric_row{"foo", "bar", "gauge", "1", "FooBar!", false,
+                            table{}, data{2}}));
+}
+
 TEST(the exporter allows changing the interval at runtime) {
   inject((atom::put, timespan), to(aut).with(atom::put_v, timespan{3s}));
   sched.advance_time(2s);
@@ -0,0 +1,53 @@
+#define SUITE interned_enum
+
+#include "broker/detail/interned_enum.hh"
+
+#include "test.hh"
+
+#include "broker/data.hh"
+#include "broker/detail/data_codec.hh"
+
+using namespace broker;
+
+TEST(interning is idempotent) {
+  auto x = detail::interned_enum::intern("Analyzer::HTTP");
+  auto y = detail::interned_enum::intern(enum_value{"Analyzer::HTTP"});
+  CHECK(x.valid());
+  CHECK(x == y);
+  CHECK_EQUAL(x.id(), y.id());
+  CHECK_EQUAL(x.name(), "Analyzer::HTTP");
+  CHECK_EQUAL(x.to_enum_value(), enum_value{"Analyzer::HTTP"});
+}
+
+TEST(distinct names get distinct handles) {
+  auto x = detail::interned_enum::intern("Analyzer::DNS");
+  auto y = detail::interned_enum::intern("Analyzer::SSL");
+  CHECK(x != y);
+  CHECK(x.id() != y.id());
+}
+
+TEST(default handle is invalid) {
+  detail::interned_enum x;
+  CHECK(!x.valid());
+  CHECK_EQUAL(x.to_enum_value(), enum_value{});
+}
+
+TEST(handles encode like enum values) {
+  auto x = detail::interned_enum::intern("Notice::Tally");
+  std::vector<std::byte> buf1;
+  detail::encode_field(x, buf1);
+  std::vector<std::byte> buf2;
+  detail::encode_field(enum_value{"Notice::Tally"}, buf2);
+  CHECK(buf1 == buf2);
+  MESSAGE("decoding a handle interns straight from the wire");
+  detail::field_reader in{buf1.data(), buf1.data() + buf1.size()};
+  detail::interned_enum y;
+  REQUIRE(detail::decode_field(in, y));
+  CHECK(in.pos == in.end);
+  CHECK(x == y);
+  MESSAGE("non-enum input is rejected");
+  std::vector<std::byte> buf3;
+  detail::encode_field(std::string{"Notice::Tally"}, buf3);
+  detail::field_reader in3{buf3.data(), buf3.data() + buf3.size()};
+  CHECK(!detail::decode_field(in3, y));
+}
@@ -0,0 +1,28 @@
+#define SUITE interned_topic
+
+#include "broker/detail/interned_topic.hh"
+
+#include "test.hh"
+
+using namespace broker;
+
+TEST(interning is idempotent) {
+  auto x = detail::interned_topic::intern("/zeek/event/foo");
+  auto y = detail::interned_topic::intern("/zeek/event/foo");
+  CHECK(x.valid());
+  CHECK(x == y);
+  CHECK_EQUAL(x.id(), y.id());
+  CHECK_EQUAL(x.string(), "/zeek/event/foo");
+}
+
+TEST(distinct topics get distinct handles) {
+  auto x = detail::interned_topic::intern("/zeek/event/bar");
+  auto y = detail::interned_topic::intern("/zeek/event/baz");
+  CHECK(x != y);
+  CHECK(x.id() != y.id());
+}
+
+TEST(default handle is invalid) {
+  detail::interned_topic x;
+  CHECK(!x.valid());
+}
@@ -0,0 +1,43 @@
+#define SUITE ktls
+
+#include "broker/detail/ktls.hh"
+
+#include "test.hh"
+
+#ifdef BROKER_HAVE_KTLS
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace broker;
+
+using detail::ktls_session;
+
+TEST(the availability probe reports a stable answer) {
+  auto available = detail::ktls_available();
+  MESSAGE("kernel TLS " << (available ? "available" : "unavailable"));
+  CHECK_EQUAL(available, detail::ktls_available());
+}
+
+TEST(enabling kernel TLS on an unconnected socket fails cleanly) {
+  auto fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  REQUIRE(fd >= 0);
+  ktls_session session;
+  session.tls_version = detail::ktls_tls12;
+  session.key.fill(0);
+  session.salt.fill(0);
+  session.iv.fill(0);
+  session.rec_seq.fill(0);
+  auto res = detail::enable_ktls(fd, session, session);
+  CHECK(!res);
+  ::close(fd);
+}
+
+#else // BROKER_HAVE_KTLS
+
+TEST(kernel TLS support requires Linux with the TLS UAPI header) {
+  MESSAGE("kTLS disabled at compile time; nothing to check");
+}
+
+#endif // BROKER_HAVE_KTLS
@@ -0,0 +1,65 @@
+#define SUITE log_histogram
+
+#include "broker/telemetry/log_histogram.hh"
+
+#include "test.hh"
+
+#include <cmath>
+#include <limits>
+
+using namespace broker;
+
+namespace {
+
+// Scans the bounds linearly, i.e., computes the index the slow way.
+size_t scan_index(const std::vector<double>& bounds, double value) {
+  for (size_t index = 0; index < bounds.size(); ++index)
+    if (value <= bounds[index])
+      return index;
+  return bounds.size();
+}
+
+} // namespace
+
+TEST(log linear bounds subdivide each power of two) {
+  auto bounds = telemetry::log_linear_bounds(-2, 1, 1);
+  // Underflow bound 2^-2, then two linear steps per power of two up to 2^1.
+  std::vector<double> expected{0.25, 0.375, 0.5, 0.75, 1.0, 1.5, 2.0};
+  CHECK_EQUAL(bounds, expected);
+}
+
+TEST(bucket indexes match a linear scan of the bounds) {
+  auto hist = telemetry::log_histogram::get_or_add("test", "log-hist-index",
+                                                   -10, 4, 3, "test metric",
+                                                   "seconds");
+  auto bounds = telemetry::log_linear_bounds(-10, 4, 3);
+  CHECK_EQUAL(hist.num_buckets(), bounds.size() + 1);
+  // Probe bucket interiors, exact bounds and out-of-range values.
+  for (auto value : {1e-9, 0.001, 0.25, 0.3, 1.0, 3.14159, 15.9, 16.0, 1e6})
+    CHECK_EQUAL(hist.index_of(value), scan_index(bounds, value));
+  for (size_t index = 0; index < bounds.size(); ++index)
+    CHECK_EQUAL(hist.index_of(bounds[index]), index);
+  for (auto value : std::vector<double>{0.0, -1.0})
+    CHECK_EQUAL(hist.index_of(value), 0u);
+  CHECK_EQUAL(hist.index_of(std::numeric_limits<double>::quiet_NaN()), 0u);
+}
+
+TEST(observations land in their buckets and add up) {
+  auto hist = telemetry::log_histogram::get_or_add("test", "log-hist-observe",
+                                                   -4, 4, 2, "test metric",
+                                                   "seconds");
+  hist.observe(0.5);
+  hist.observe(0.5);
+  hist.observe(100.0); // overflow bucket
+  CHECK_EQUAL(hist.count_at(hist.index_of(0.5)), 2);
+  CHECK_EQUAL(hist.count_at(hist.num_buckets() - 1), 1);
+  CHECK_EQUAL(hist.upper_bound_at(hist.num_buckets() - 1),
+              std::numeric_limits<double>::infinity());
+  CHECK_EQUAL(hist.sum(), 101.0);
+  // Handles to the same full name share their cells.
+  auto other = telemetry::log_histogram::get_or_add("test", "log-hist-observe",
+                                                    -4, 4, 2, "test metric",
+                                                    "seconds");
+  CHECK_EQUAL(other, hist);
+  CHECK_EQUAL(other.count_at(other.index_of(0.5)), 2);
+}
@@ -0,0 +1,59 @@
+#define SUITE memory_accounting
+
+#include "broker/detail/memory_accounting.hh"
+
+#include "test.hh"
+
+#include "broker/detail/shared_subscriber_queue.hh"
+
+using namespace broker;
+using detail::estimated_memory_use;
+using detail::memory_accountant;
+using detail::memory_region;
+
+TEST(estimates count the object plus its top-level payload) {
+  CHECK_EQUAL(estimated_memory_use(data{count{42}}), sizeof(data));
+  auto str = std::string(100, 'x');
+  CHECK(estimated_memory_use(data{str}) >= sizeof(data) + 100);
+  vector xs;
+  xs.resize(10);
+  CHECK(estimated_memory_use(data{xs}) >= sizeof(data) + 10 * sizeof(data));
+}
+
+TEST(accountants track usage per region and enforce the budget) {
+  memory_accountant acc;
+  CHECK_EQUAL(acc.total_usage(), 0);
+  CHECK(!acc.over_budget());
+  acc.add(memory_region::queues, 100);
+  acc.add(memory_region::dispatcher, 50);
+  CHECK_EQUAL(acc.usage(memory_region::queues), 100);
+  CHECK_EQUAL(acc.usage(memory_region::dispatcher), 50);
+  CHECK_EQUAL(acc.total_usage(), 150);
+  MESSAGE("a budget of zero disables enforcement");
+  CHECK(!acc.over_budget());
+  acc.budget(120);
+  CHECK(acc.over_budget());
+  acc.sub(memory_region::queues, 100);
+  CHECK(!acc.over_budget());
+}
+
+TEST(subscriber queues shed incoming items once over budget) {
+  auto acc = std::make_shared<memory_accountant>();
+  auto q = detail::make_shared_subscriber_queue<data_message>();
+  q->attach_accounting(acc);
+  acc->budget(sizeof(data_message));
+  q->produce(make_data_message("/test", data{"hello"}));
+  CHECK_EQUAL(q->buffer_size(), 1u);
+  CHECK(acc->over_budget());
+  MESSAGE("further items get shed while the budget remains exceeded");
+  q->produce(make_data_message("/test", data{"world"}));
+  CHECK_EQUAL(q->buffer_size(), 1u);
+  MESSAGE("consuming releases the accounted bytes again");
+  size_t consumed = 0;
+  q->consume(10, nullptr, [&consumed](data_message&&) { ++consumed; });
+  CHECK_EQUAL(consumed, 1u);
+  CHECK_EQUAL(acc->usage(memory_region::queues), 0);
+  CHECK(!acc->over_budget());
+  q->produce(make_data_message("/test", data{"again"}));
+  CHECK_EQUAL(q->buffer_size(), 1u);
+}
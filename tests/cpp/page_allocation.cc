@@ -0,0 +1,53 @@
+#define SUITE page_allocation
+
+#include "broker/detail/page_allocation.hh"
+
+#include "test.hh"
+
+#include <cstring>
+
+#include "broker/detail/spsc_queue.hh"
+
+using namespace broker;
+
+TEST(the page size is a power of two) {
+  auto ps = detail::page_size();
+  REQUIRE(ps > 0);
+  CHECK_EQUAL(ps & (ps - 1), 0u);
+}
+
+TEST(mapped pages are writable and zero-initialized) {
+  auto num_bytes = detail::page_size() * 4;
+  auto ptr = detail::allocate_pages(num_bytes, false);
+  if (ptr == nullptr) {
+    MESSAGE("platform without page allocation support, skipping");
+    return;
+  }
+  auto bytes = static_cast<unsigned char*>(ptr);
+  CHECK_EQUAL(bytes[0], 0u);
+  CHECK_EQUAL(bytes[num_bytes - 1], 0u);
+  memset(ptr, 0xAB, num_bytes);
+  CHECK_EQUAL(bytes[num_bytes - 1], 0xABu);
+  detail::deallocate_pages(ptr, num_bytes);
+}
+
+TEST(invalid NUMA bindings are rejected) {
+  auto num_bytes = detail::page_size();
+  auto ptr = detail::allocate_pages(num_bytes, false);
+  CHECK(!detail::bind_to_numa_node(ptr, num_bytes, -1));
+  CHECK(!detail::bind_to_numa_node(nullptr, num_bytes, 0));
+  detail::deallocate_pages(ptr, num_bytes);
+}
+
+TEST(queues with a NUMA hint keep FIFO order across blocks) {
+  detail::spsc_queue<int> xs{4};
+  xs.set_numa_node(0);
+  // Push enough elements to force page-granular follow-up blocks.
+  for (int i = 0; i < 100; ++i)
+    xs.push(i);
+  for (int i = 0; i < 100; ++i) {
+    int x = -1;
+    REQUIRE(xs.pop(x));
+    CHECK_EQUAL(x, i);
+  }
+}
@@ -0,0 +1,78 @@
+#define SUITE peer_listener
+
+#include "broker/detail/peer_listener.hh"
+
+#include "test.hh"
+
+#ifndef BROKER_WINDOWS
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+using namespace broker;
+
+using detail::native_socket;
+using detail::peer_listener;
+
+namespace {
+
+/// Opens a TCP connection to 127.0.0.1 on `port` and closes it again.
+bool dial(uint16_t port) {
+  auto fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0)
+    return false;
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  auto ok = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))
+            == 0;
+  ::close(fd);
+  return ok;
+}
+
+} // namespace
+
+TEST(listeners share one port and accept concurrently) {
+  auto ls = peer_listener::make("127.0.0.1", 0, 3);
+  REQUIRE(ls);
+  CHECK_EQUAL(ls->num_listeners(), 3u);
+  REQUIRE(ls->port() != 0);
+  std::atomic<int> accepted{0};
+  ls->start([&](native_socket fd) {
+    ++accepted;
+    ::close(fd);
+  });
+  constexpr auto num_connects = 32;
+  for (int i = 0; i < num_connects; ++i)
+    CHECK(dial(ls->port()));
+  // The kernel spreads connections across the sockets; wait until every
+  // accept thread caught up.
+  for (int i = 0; i < 500 && accepted.load() < num_connects; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  CHECK_EQUAL(accepted.load(), num_connects);
+  MESSAGE("stop is idempotent");
+  ls->stop();
+  ls->stop();
+}
+
+TEST(zero listeners get clamped to one) {
+  auto ls = peer_listener::make("127.0.0.1", 0, 0);
+  REQUIRE(ls);
+  CHECK_EQUAL(ls->num_listeners(), 1u);
+}
+
+TEST(binding an invalid address fails) {
+  auto ls = peer_listener::make("256.0.0.1", 0, 2);
+  CHECK(!ls);
+}
+
+#endif // BROKER_WINDOWS
@@ -0,0 +1,295 @@
+#define SUITE peer_protocol
+
+#include "broker/detail/peer_protocol.hh"
+
+#include "test.hh"
+
+#include "broker/detail/data_codec.hh"
+#include "broker/detail/peer_connection.hh"
+#include "broker/detail/prefix_matcher.hh"
+#include "broker/detail/preset_dictionary.hh"
+#include "broker/message.hh"
+
+#ifndef BROKER_WINDOWS
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <thread>
+
+using namespace broker;
+
+using detail::frame_header;
+using detail::frame_type;
+using detail::handshake_info;
+using detail::peer_connection;
+
+TEST(frame headers survive a round trip) {
+  std::vector<std::byte> buf;
+  encode(frame_header{12345, frame_type::data_msg}, buf);
+  REQUIRE_EQUAL(buf.size(), detail::frame_header_size);
+  auto hdr = detail::decode_frame_header(buf.data());
+  REQUIRE(hdr);
+  CHECK_EQUAL(hdr->payload_size, 12345u);
+  CHECK(hdr->type == frame_type::data_msg);
+}
+
+TEST(unknown frame types are rejected) {
+  std::vector<std::byte> buf;
+  encode(frame_header{0, frame_type::bye}, buf);
+  buf[4] = static_cast<std::byte>(0xff);
+  auto hdr = detail::decode_frame_header(buf.data());
+  REQUIRE(!hdr);
+  CHECK_EQUAL(hdr.error(), ec::invalid_tag);
+}
+
+TEST(handshakes survive a round trip) {
+  handshake_info hs;
+  hs.id = "node-1";
+  hs.filter = {"/zeek/events", "/zeek/logs"};
+  hs.initial_credit = 64;
+  hs.compression = detail::peer_compression_zlib;
+  hs.features = detail::peer_feature_datagram;
+  hs.datagram_port = 47761;
+  std::vector<std::byte> buf;
+  encode(hs, buf);
+  auto copy = detail::decode_handshake(buf.data(), buf.size());
+  REQUIRE(copy);
+  CHECK_EQUAL(copy->id, hs.id);
+  CHECK_EQUAL(copy->filter, hs.filter);
+  CHECK_EQUAL(copy->initial_credit, hs.initial_credit);
+  CHECK_EQUAL(copy->compression, hs.compression);
+  CHECK_EQUAL(copy->features, hs.features);
+  CHECK_EQUAL(copy->datagram_port, hs.datagram_port);
+}
+
+TEST(homogeneous runs are detected automatically) {
+  std::vector<data_message> msgs;
+  msgs.emplace_back(make_data_message("/zeek/events", data{count{1}}));
+  msgs.emplace_back(make_data_message("/zeek/events", data{count{2}}));
+  msgs.emplace_back(make_data_message("/zeek/events", data{count{3}}));
+  msgs.emplace_back(make_data_message("/zeek/logs", data{count{4}}));
+  CHECK_EQUAL(detail::homogeneous_run(msgs.data(), msgs.size()), 3u);
+  CHECK_EQUAL(detail::homogeneous_run(msgs.data() + 3, 1), 1u);
+  CHECK_EQUAL(detail::homogeneous_run(msgs.data(), 0), 0u);
+}
+
+TEST(data batches survive a round trip) {
+  std::vector<data_message> msgs;
+  for (int i = 0; i < 5; ++i)
+    msgs.emplace_back(make_data_message("/zeek/events",
+                                        data{static_cast<count>(i)}));
+  std::vector<std::byte> buf;
+  detail::encode_data_batch(msgs.data(), msgs.size(), buf);
+  // The shared topic must appear exactly once in the payload.
+  auto single = detail::encode(get_data(msgs[0]));
+  CHECK(buf.size() < msgs.size() * (single.size() + 12));
+  auto copy = detail::decode_data_batch(buf.data(), buf.size());
+  REQUIRE(copy);
+  REQUIRE_EQUAL(copy->size(), msgs.size());
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    CHECK_EQUAL(get_topic((*copy)[i]), get_topic(msgs[i]));
+    CHECK_EQUAL(get_data((*copy)[i]), get_data(msgs[i]));
+  }
+}
+
+TEST(truncated data batches are rejected) {
+  std::vector<data_message> msgs;
+  msgs.emplace_back(make_data_message("/zeek/events", data{count{1}}));
+  msgs.emplace_back(make_data_message("/zeek/events", data{count{2}}));
+  std::vector<std::byte> buf;
+  detail::encode_data_batch(msgs.data(), msgs.size(), buf);
+  auto copy = detail::decode_data_batch(buf.data(), buf.size() - 1);
+  REQUIRE(!copy);
+  CHECK_EQUAL(copy.error(), ec::invalid_data);
+}
+
+TEST(topics can be peeked without decoding the payload) {
+  std::vector<data_message> msgs;
+  msgs.emplace_back(make_data_message("/zeek/events", data{count{1}}));
+  msgs.emplace_back(make_data_message("/zeek/events", data{count{2}}));
+  std::vector<std::byte> buf;
+  detail::encode_data_batch(msgs.data(), msgs.size(), buf);
+  std::string_view raw;
+  REQUIRE(detail::peek_topic(buf.data(), buf.size(), raw));
+  CHECK_EQUAL(raw, "/zeek/events");
+  detail::prefix_matcher accept;
+  CHECK(accept({topic{"/zeek"}}, raw));
+  CHECK(accept({topic{"/zeek/*"}}, raw));
+  CHECK(!accept({topic{"/zeek/logs"}}, raw));
+  // Truncated input must not produce a view.
+  std::string_view untouched;
+  CHECK(!detail::peek_topic(buf.data(), 2, untouched));
+  CHECK(untouched.empty());
+}
+
+TEST(handshakes with hostile topic counts are rejected) {
+  handshake_info hs;
+  hs.id = "node-1";
+  hs.initial_credit = 64;
+  std::vector<std::byte> buf;
+  encode(hs, buf);
+  // An empty filter encodes as a trailing zero-count varint; replace it with
+  // a count that no payload of this size could hold.
+  buf.pop_back();
+  detail::encode_varint(uint64_t{1} << 60, buf);
+  auto copy = detail::decode_handshake(buf.data(), buf.size());
+  REQUIRE(!copy);
+  CHECK_EQUAL(copy.error(), ec::invalid_data);
+}
+
+TEST(handshakes with foreign magic are rejected) {
+  handshake_info hs;
+  hs.id = "node-1";
+  hs.initial_credit = 64;
+  std::vector<std::byte> buf;
+  encode(hs, buf);
+  buf[0] = static_cast<std::byte>(0);
+  auto copy = detail::decode_handshake(buf.data(), buf.size());
+  REQUIRE(!copy);
+  CHECK_EQUAL(copy.error(), ec::peer_incompatible);
+}
+
+#ifndef BROKER_WINDOWS
+
+TEST(connections exchange handshakes and frames over a socketpair) {
+  int fds[2];
+  REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  peer_connection left{fds[0]};
+  peer_connection right{fds[1]};
+  handshake_info left_hs;
+  left_hs.id = "left";
+  left_hs.filter = {"/left"};
+  left_hs.initial_credit = 4;
+  handshake_info right_hs;
+  right_hs.id = "right";
+  right_hs.filter = {"/right"};
+  right_hs.initial_credit = 4;
+  std::thread responder{[&] {
+    auto remote = right.respond_handshake(right_hs);
+    REQUIRE(remote);
+    CHECK_EQUAL(remote->id, "left");
+    // Consume messages until the orderly shutdown; reading replenishes the
+    // sender's credit along the way.
+    for (;;) {
+      auto x = right.read();
+      if (!x) {
+        CHECK_EQUAL(x.error(), ec::end_of_file);
+        return;
+      }
+      CHECK(x->type == frame_type::data_msg);
+    }
+  }};
+  auto remote = left.originate_handshake(left_hs);
+  REQUIRE(remote);
+  CHECK_EQUAL(remote->id, "right");
+  CHECK_EQUAL(left.send_credit(), 4u);
+  // Send more frames than the window holds to exercise the credit exchange.
+  std::vector<std::byte> payload{std::byte{1}, std::byte{2}, std::byte{3}};
+  for (int i = 0; i < 32; ++i)
+    REQUIRE(left.send(frame_type::data_msg, payload));
+  REQUIRE(left.send(frame_type::bye, nullptr, 0));
+  responder.join();
+}
+
+#ifdef BROKER_HAVE_ZLIB
+
+TEST(negotiated compression shrinks repetitive payloads transparently) {
+  int fds[2];
+  REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  peer_connection left{fds[0]};
+  peer_connection right{fds[1]};
+  handshake_info left_hs;
+  left_hs.id = "left";
+  left_hs.initial_credit = 8;
+  left_hs.compression = detail::peer_compression_zlib;
+  handshake_info right_hs;
+  right_hs.id = "right";
+  right_hs.initial_credit = 8;
+  right_hs.compression = detail::peer_compression_zlib;
+  std::vector<std::byte> payload;
+  payload.resize(4096, std::byte{'x'});
+  std::thread responder{[&] {
+    auto remote = right.respond_handshake(right_hs);
+    REQUIRE(remote);
+    CHECK(right.compression_enabled());
+    auto x = right.read();
+    REQUIRE(x);
+    CHECK(x->type == frame_type::data_msg);
+    CHECK(x->payload == payload);
+    CHECK_EQUAL(right.received().raw, payload.size());
+    CHECK(right.received().wire < right.received().raw);
+    auto eof = right.read();
+    REQUIRE(!eof);
+    CHECK_EQUAL(eof.error(), ec::end_of_file);
+  }};
+  auto remote = left.originate_handshake(left_hs);
+  REQUIRE(remote);
+  CHECK(left.compression_enabled());
+  REQUIRE(left.send(frame_type::data_msg, payload));
+  CHECK_EQUAL(left.sent().raw, payload.size());
+  CHECK(left.sent().wire < left.sent().raw);
+  REQUIRE(left.send(frame_type::bye, nullptr, 0));
+  responder.join();
+}
+
+TEST(negotiated preset dictionaries prime payload compression) {
+  // A payload of unique bytes defeats plain deflate, but compresses to a
+  // handful of back-references against a dictionary that contains it.
+  std::vector<std::byte> payload;
+  uint32_t state = 1;
+  for (int i = 0; i < 512; ++i) {
+    state = state * 1664525 + 1013904223;
+    payload.push_back(static_cast<std::byte>(state >> 24));
+  }
+  detail::preset_dictionary dict;
+  dict.name = "default";
+  dict.bytes = payload;
+  dict.checksum = detail::preset_dictionary_checksum(dict.bytes.data(),
+                                                     dict.bytes.size());
+  detail::preset_dictionary_set dicts;
+  dicts.add(dict);
+  int fds[2];
+  REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  peer_connection left{fds[0]};
+  peer_connection right{fds[1]};
+  left.use_preset_dictionaries(&dict, &dicts);
+  right.use_preset_dictionaries(nullptr, &dicts);
+  handshake_info left_hs;
+  left_hs.id = "left";
+  left_hs.initial_credit = 8;
+  left_hs.compression = detail::peer_compression_zlib
+                        | detail::peer_compression_zlib_dict;
+  handshake_info right_hs;
+  right_hs.id = "right";
+  right_hs.initial_credit = 8;
+  right_hs.compression = detail::peer_compression_zlib
+                         | detail::peer_compression_zlib_dict;
+  std::thread responder{[&] {
+    auto remote = right.respond_handshake(right_hs);
+    REQUIRE(remote);
+    // The responder holds no write dictionary, so only its receive path
+    // participates.
+    CHECK(!right.dictionary_compression_enabled());
+    auto x = right.read();
+    REQUIRE(x);
+    CHECK(x->type == frame_type::data_msg);
+    CHECK(x->payload == payload);
+    CHECK_EQUAL(right.received().raw, payload.size());
+    CHECK(right.received().wire < right.received().raw);
+    auto eof = right.read();
+    REQUIRE(!eof);
+    CHECK_EQUAL(eof.error(), ec::end_of_file);
+  }};
+  auto remote = left.originate_handshake(left_hs);
+  REQUIRE(remote);
+  CHECK(left.dictionary_compression_enabled());
+  REQUIRE(left.send(frame_type::data_msg, payload));
+  CHECK(left.sent().wire < left.sent().raw);
+  REQUIRE(left.send(frame_type::bye, nullptr, 0));
+  responder.join();
+}
+
+#endif // BROKER_HAVE_ZLIB
+
+#endif // BROKER_WINDOWS
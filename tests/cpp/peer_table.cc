@@ -0,0 +1,82 @@
+#define SUITE peer_table
+
+#include "broker/detail/peer_table.hh"
+
+#include "test.hh"
+
+#include <caf/node_id.hpp>
+
+#include "broker/internal/native.hh"
+
+using namespace broker;
+
+namespace {
+
+endpoint_id make_id(uint32_t n) {
+  auto id = caf::make_node_id(n, "402FA79E64ACFA54522FFC7AC886630670517900");
+  if (!id)
+    FAIL("caf::make_node_id failed");
+  return internal::facade(*id);
+}
+
+} // namespace
+
+TEST(insert and find) {
+  detail::peer_table<int> uut;
+  CHECK(uut.empty());
+  uut[make_id(1)] = 10;
+  uut[make_id(2)] = 20;
+  CHECK_EQUAL(uut.size(), 2u);
+  REQUIRE(uut.find(make_id(1)) != nullptr);
+  CHECK_EQUAL(*uut.find(make_id(1)), 10);
+  REQUIRE(uut.find(make_id(2)) != nullptr);
+  CHECK_EQUAL(*uut.find(make_id(2)), 20);
+  CHECK(uut.find(make_id(3)) == nullptr);
+  uut[make_id(1)] = 11;
+  CHECK_EQUAL(uut.size(), 2u);
+  CHECK_EQUAL(*uut.find(make_id(1)), 11);
+}
+
+TEST(slot indexes are stable and dense) {
+  detail::peer_table<int> uut;
+  for (uint32_t i = 0; i < 5; ++i)
+    uut[make_id(i)] = static_cast<int>(i);
+  auto idx2 = uut.index_of(make_id(2));
+  CHECK(idx2 != detail::peer_table<int>::npos);
+  CHECK_LESS(idx2, uut.slot_count());
+  // Erasing other entries must not move the remaining slots.
+  uut.erase(make_id(0));
+  uut.erase(make_id(4));
+  CHECK_EQUAL(uut.index_of(make_id(2)), idx2);
+  CHECK_EQUAL(uut.index_of(make_id(0)), detail::peer_table<int>::npos);
+  // A new entry reuses a freed slot instead of growing the array.
+  auto before = uut.slot_count();
+  uut[make_id(9)] = 9;
+  CHECK_EQUAL(uut.slot_count(), before);
+  CHECK_EQUAL(uut.index_of(make_id(2)), idx2);
+}
+
+TEST(hashed index takes over past the linear threshold) {
+  detail::peer_table<int> uut;
+  constexpr uint32_t num = 50;
+  for (uint32_t i = 0; i < num; ++i)
+    uut[make_id(i)] = static_cast<int>(i);
+  CHECK_EQUAL(uut.size(), size_t{num});
+  for (uint32_t i = 0; i < num; ++i) {
+    REQUIRE(uut.find(make_id(i)) != nullptr);
+    CHECK_EQUAL(*uut.find(make_id(i)), static_cast<int>(i));
+  }
+  CHECK(uut.find(make_id(num)) == nullptr);
+  for (uint32_t i = 0; i < num; i += 2)
+    CHECK(uut.erase(make_id(i)));
+  CHECK_EQUAL(uut.size(), size_t{num / 2});
+  for (uint32_t i = 0; i < num; ++i) {
+    if (i % 2 == 0)
+      CHECK(uut.find(make_id(i)) == nullptr);
+    else
+      REQUIRE(uut.find(make_id(i)) != nullptr);
+  }
+  uut.clear();
+  CHECK(uut.empty());
+  CHECK(uut.find(make_id(1)) == nullptr);
+}
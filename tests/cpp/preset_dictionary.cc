@@ -0,0 +1,151 @@
+#define SUITE preset_dictionary
+
+#include "broker/detail/preset_dictionary.hh"
+
+#include "test.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <string_view>
+
+#include "broker/config.hh"
+#include "broker/detail/filesystem.hh"
+
+using namespace broker;
+
+using detail::preset_dictionary;
+using detail::preset_dictionary_set;
+
+namespace {
+
+std::vector<std::byte> bytes_of(std::string_view str) {
+  std::vector<std::byte> result;
+  for (auto c : str)
+    result.push_back(static_cast<std::byte>(c));
+  return result;
+}
+
+preset_dictionary make_dict(std::string name, std::string_view content) {
+  preset_dictionary result;
+  result.name = std::move(name);
+  result.bytes = bytes_of(content);
+  result.checksum = detail::preset_dictionary_checksum(result.bytes.data(),
+                                                       result.bytes.size());
+  return result;
+}
+
+} // namespace
+
+TEST(checksums match the deflate dictionary id) {
+  // Adler-32 of "hello" per RFC 1950.
+  auto hello = bytes_of("hello");
+  CHECK_EQUAL(detail::preset_dictionary_checksum(hello.data(), hello.size()),
+              0x062C0215u);
+  CHECK_EQUAL(detail::preset_dictionary_checksum(nullptr, 0), 1u);
+}
+
+TEST(training places frequent samples at the end) {
+  std::vector<std::vector<std::byte>> samples;
+  samples.emplace_back(bytes_of("common"));
+  samples.emplace_back(bytes_of("rare"));
+  samples.emplace_back(bytes_of("common"));
+  samples.emplace_back(bytes_of("common"));
+  auto dict = detail::train_preset_dictionary(samples, 32768);
+  // Duplicates collapse; the most frequent sample forms the tail.
+  CHECK_EQUAL(dict.size(), 10u);
+  CHECK(std::equal(dict.end() - 6, dict.end(), bytes_of("common").begin()));
+}
+
+TEST(training respects the size cap) {
+  std::vector<std::vector<std::byte>> samples;
+  samples.emplace_back(std::vector<std::byte>(100, std::byte{'a'}));
+  samples.emplace_back(std::vector<std::byte>(50, std::byte{'b'}));
+  samples.emplace_back(std::vector<std::byte>(50, std::byte{'b'}));
+  auto dict = detail::train_preset_dictionary(samples, 60);
+  // Trimming the front keeps the more frequent sample intact.
+  REQUIRE_EQUAL(dict.size(), 60u);
+  CHECK(dict.front() == std::byte{'a'});
+  CHECK(dict.back() == std::byte{'b'});
+}
+
+TEST(sets resolve by name and checksum with a default fallback) {
+  preset_dictionary_set dicts;
+  CHECK(dicts.empty());
+  CHECK(dicts.lookup("conn") == nullptr);
+  dicts.add(make_dict("conn", "orig_host resp_host service"));
+  dicts.add(make_dict("default", "ts uid id"));
+  REQUIRE_EQUAL(dicts.size(), 2u);
+  auto conn = dicts.by_name("conn");
+  REQUIRE(conn != nullptr);
+  CHECK_EQUAL(conn->name, "conn");
+  CHECK(dicts.by_checksum(conn->checksum) == conn);
+  CHECK(dicts.by_name("dns") == nullptr);
+  CHECK(dicts.by_checksum(0xdeadbeef) == nullptr);
+  CHECK(dicts.lookup("conn") == conn);
+  CHECK(dicts.lookup("dns") == dicts.by_name("default"));
+}
+
+TEST(dictionaries survive a roundtrip through the filesystem) {
+  auto dir = detail::make_temp_file_name();
+  REQUIRE(detail::mkdirs(dir));
+  auto write_file = [&](const std::string& name, std::string_view content) {
+    std::ofstream out{dir + "/" + name, std::ios::binary};
+    out << content;
+  };
+  write_file("conn.dict", "orig_host resp_host service");
+  write_file("default.dict", "ts uid id");
+  write_file("notes.txt", "not a dictionary");
+  auto dicts = detail::load_preset_dictionaries(dir);
+  REQUIRE(dicts);
+  REQUIRE_EQUAL(dicts->size(), 2u);
+  // Entries load in name order and only from ".dict" files.
+  CHECK_EQUAL(dicts->entries()[0].name, "conn");
+  CHECK_EQUAL(dicts->entries()[1].name, "default");
+  auto expected = make_dict("conn", "orig_host resp_host service");
+  auto conn = dicts->by_name("conn");
+  REQUIRE(conn != nullptr);
+  CHECK(conn->bytes == expected.bytes);
+  CHECK_EQUAL(conn->checksum, expected.checksum);
+  detail::remove_all(dir);
+}
+
+TEST(loading from a missing directory fails) {
+  auto dicts = detail::load_preset_dictionaries("/broker/does/not/exist");
+  REQUIRE(!dicts);
+  CHECK_EQUAL(dicts.error(), ec::cannot_open_file);
+}
+
+#ifdef BROKER_HAVE_ZLIB
+
+TEST(a matching dictionary shrinks small payloads) {
+  auto payload = bytes_of("session orig_host=10.0.0.1 resp_host=10.0.0.2 "
+                          "service=http duration=0.25");
+  auto dict = make_dict("conn", "session orig_host= resp_host= service=http "
+                                "duration=");
+  preset_dictionary_set dicts;
+  dicts.add(dict);
+  std::vector<std::byte> plain;
+  REQUIRE(detail::deflate_bytes(payload.data(), payload.size(), nullptr,
+                                plain));
+  std::vector<std::byte> primed;
+  REQUIRE(detail::deflate_bytes(payload.data(), payload.size(), &dict,
+                                primed));
+  CHECK(primed.size() < plain.size());
+  // Both forms inflate through the same entry point.
+  std::vector<std::byte> restored(payload.size());
+  CHECK(detail::inflate_bytes(plain.data(), plain.size(), &dicts, restored));
+  CHECK(restored == payload);
+  restored.assign(payload.size(), std::byte{0});
+  CHECK(detail::inflate_bytes(primed.data(), primed.size(), &dicts,
+                              restored));
+  CHECK(restored == payload);
+  // Without the dictionary, the primed stream must not inflate.
+  CHECK(!detail::inflate_bytes(primed.data(), primed.size(), nullptr,
+                               restored));
+  preset_dictionary_set other;
+  other.add(make_dict("default", "ts uid id"));
+  CHECK(!detail::inflate_bytes(primed.data(), primed.size(), &other,
+                               restored));
+}
+
+#endif // BROKER_HAVE_ZLIB
@@ -0,0 +1,79 @@
+#define SUITE publish_limiter
+
+#include "broker/detail/publish_limiter.hh"
+
+#include "test.hh"
+
+#include <chrono>
+#include <thread>
+
+using namespace broker;
+
+namespace {
+
+using detail::publish_limiter;
+
+} // namespace
+
+TEST(topics without a limit pass through) {
+  publish_limiter uut;
+  CHECK(uut.admit("/zeek/events"));
+  publish_limit limit;
+  limit.messages_per_second = 1;
+  limit.burst = 1;
+  uut.attach("/zeek/telemetry", limit);
+  CHECK(uut.admit("/zeek/events"));
+  CHECK_EQUAL(uut.dropped(), 0u);
+}
+
+TEST(the drop policy discards and counts overflow) {
+  publish_limiter uut;
+  publish_limit limit;
+  limit.messages_per_second = 1;
+  limit.burst = 3;
+  uut.attach("/zeek/telemetry", limit);
+  CHECK(uut.admit("/zeek/telemetry/cpu"));
+  CHECK(uut.admit("/zeek/telemetry/cpu"));
+  CHECK(uut.admit("/zeek/telemetry/mem"));
+  CHECK(!uut.admit("/zeek/telemetry/mem"));
+  CHECK(!uut.admit("/zeek/telemetry/cpu", 2));
+  CHECK_EQUAL(uut.dropped(), 3u);
+}
+
+TEST(the bucket refills over time) {
+  publish_limiter uut;
+  publish_limit limit;
+  limit.messages_per_second = 1000;
+  limit.burst = 1;
+  uut.attach("/zeek/telemetry", limit);
+  CHECK(uut.admit("/zeek/telemetry"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CHECK(uut.admit("/zeek/telemetry"));
+}
+
+TEST(the block policy waits for the refill) {
+  publish_limiter uut;
+  publish_limit limit;
+  limit.messages_per_second = 1000;
+  limit.burst = 1;
+  limit.policy = publish_limit_policy::block;
+  uut.attach("/zeek/telemetry", limit);
+  CHECK(uut.admit("/zeek/telemetry"));
+  // Drained bucket: the second call must block until a token is available
+  // instead of reporting a drop.
+  CHECK(uut.admit("/zeek/telemetry"));
+  CHECK_EQUAL(uut.dropped(), 0u);
+}
+
+TEST(re-attaching replaces and a non-positive rate detaches) {
+  publish_limiter uut;
+  publish_limit limit;
+  limit.messages_per_second = 1;
+  limit.burst = 1;
+  uut.attach("/zeek/telemetry", limit);
+  CHECK(uut.admit("/zeek/telemetry"));
+  CHECK(!uut.admit("/zeek/telemetry"));
+  limit.messages_per_second = 0;
+  uut.attach("/zeek/telemetry", limit);
+  CHECK(uut.admit("/zeek/telemetry"));
+}
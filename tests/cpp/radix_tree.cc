@@ -120,6 +120,52 @@ TEST(long prefix) {
                     {make_pair("this:key:has:a:long:common:prefix:2", 2)}));
 }
 
+TEST(longest_common_prefix handles block boundaries) {
+  using detail::longest_common_prefix;
+  // Exercises the 32-byte compare blocks of the vectorized build as well as
+  // the scalar tail; both must agree on all of these inputs.
+  string base(64, 'a');
+  auto k1 = base;
+  // Mismatch inside the first block.
+  auto k2 = base;
+  k2[5] = 'b';
+  CHECK(longest_common_prefix(k1, k2, 0) == 5u);
+  // Mismatch on the last byte of the first block and on the first byte of
+  // the second one.
+  k2 = base;
+  k2[31] = 'b';
+  CHECK(longest_common_prefix(k1, k2, 0) == 31u);
+  k2 = base;
+  k2[32] = 'b';
+  CHECK(longest_common_prefix(k1, k2, 0) == 32u);
+  // Identical keys match through the null terminator.
+  CHECK(longest_common_prefix(k1, base, 0) == 65u);
+  // A key that prefixes the other stops at the shorter key's terminator,
+  // also when it sits right on a block boundary.
+  string short_key(32, 'a');
+  CHECK(longest_common_prefix(short_key, base, 0) == 32u);
+  // A nonzero depth shifts the comparison window.
+  k2 = base;
+  k2[35] = 'b';
+  CHECK(longest_common_prefix(k1, k2, 3) == 32u);
+}
+
+TEST(keys sharing long prefixes survive a roundtrip) {
+  // Keys that differ only after a 32-byte boundary drive the prefix kernel
+  // through insert and find.
+  test_radix_tree rt;
+  string base(40, 'x');
+  CHECK(rt.insert({base + ":1", 1}).second);
+  CHECK(rt.insert({base + ":2", 2}).second);
+  CHECK(rt.insert({base, 3}).second);
+  CHECK(rt.find(base + ":1")->second == 1);
+  CHECK(rt.find(base + ":2")->second == 2);
+  CHECK(rt.find(base)->second == 3);
+  CHECK(check_match(rt.prefixed_by(base),
+                    {make_pair(base, 3), make_pair(base + ":1", 1),
+                     make_pair(base + ":2", 2)}));
+}
+
 TEST(prefix_of) {
   test_radix_tree t{make_pair("one", 1)};
 
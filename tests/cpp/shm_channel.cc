@@ -0,0 +1,115 @@
+#define SUITE shm_channel
+
+#include "broker/detail/shm_channel.hh"
+
+#include "test.hh"
+
+#ifndef BROKER_WINDOWS
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace broker;
+
+using detail::shm_channel;
+
+namespace {
+
+// Segment names are global to the host; include the PID so parallel test
+// runs do not collide.
+std::string unique_name(const char* suffix) {
+  return "/broker-test-" + std::to_string(::getpid()) + "-" + suffix;
+}
+
+std::vector<std::byte> to_bytes(const char* str) {
+  auto ptr = reinterpret_cast<const std::byte*>(str);
+  return {ptr, ptr + std::strlen(str)};
+}
+
+} // namespace
+
+TEST(channels deliver messages in both directions) {
+  auto server = shm_channel::create(unique_name("duplex"), 4096);
+  REQUIRE(server);
+  auto client = shm_channel::attach(unique_name("duplex"));
+  REQUIRE(client);
+  CHECK(server->put(to_bytes("ping")));
+  std::vector<std::byte> msg;
+  client->get(msg);
+  CHECK(msg == to_bytes("ping"));
+  CHECK(client->put(to_bytes("pong")));
+  server->get(msg);
+  CHECK(msg == to_bytes("pong"));
+  CHECK(!server->try_get(msg));
+}
+
+TEST(producers block on a full ring until the consumer drains it) {
+  // A ring this small forces wrapping and back-pressure with every batch.
+  auto server = shm_channel::create(unique_name("wrap"), 64);
+  REQUIRE(server);
+  auto client = shm_channel::attach(unique_name("wrap"));
+  REQUIRE(client);
+  constexpr int num_messages = 1000;
+  std::thread producer{[&] {
+    std::vector<std::byte> msg;
+    msg.resize(24);
+    for (int i = 0; i < num_messages; ++i) {
+      std::memcpy(msg.data(), &i, sizeof(i));
+      REQUIRE(server->put(msg));
+    }
+  }};
+  std::vector<std::byte> msg;
+  for (int i = 0; i < num_messages; ++i) {
+    client->get(msg);
+    REQUIRE_EQUAL(msg.size(), 24u);
+    int seq = -1;
+    std::memcpy(&seq, msg.data(), sizeof(seq));
+    CHECK_EQUAL(seq, i);
+  }
+  producer.join();
+}
+
+TEST(capacities round up to the next power of two) {
+  // Non-power-of-two rings would corrupt framing once the 32-bit cursors
+  // wrap, so create() rounds 100 up to 128.
+  auto server = shm_channel::create(unique_name("pow2"), 100);
+  REQUIRE(server);
+  auto client = shm_channel::attach(unique_name("pow2"));
+  REQUIRE(client);
+  std::vector<std::byte> msg;
+  msg.resize(124); // Fills the rounded ring exactly: 4-byte prefix + 124.
+  CHECK(server->put(msg));
+  std::vector<std::byte> received;
+  client->get(received);
+  CHECK_EQUAL(received.size(), 124u);
+  msg.resize(125); // One byte over the rounded capacity.
+  CHECK(!server->put(msg));
+}
+
+TEST(zero capacities are rejected) {
+  auto server = shm_channel::create(unique_name("zero"), 0);
+  CHECK(!server);
+}
+
+TEST(oversized messages are rejected up front) {
+  auto server = shm_channel::create(unique_name("oversize"), 64);
+  REQUIRE(server);
+  std::vector<std::byte> msg;
+  msg.resize(128);
+  CHECK(!server->put(msg));
+}
+
+TEST(attaching to a missing segment fails) {
+  auto client = shm_channel::attach(unique_name("missing"));
+  CHECK(!client);
+}
+
+#else // BROKER_WINDOWS
+
+TEST(shared memory transport is disabled on this platform) {
+  MESSAGE("skipping: no POSIX shared memory on Windows");
+}
+
+#endif // BROKER_WINDOWS
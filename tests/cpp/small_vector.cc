@@ -0,0 +1,62 @@
+#define SUITE small_vector
+
+#include "broker/detail/small_vector.hh"
+
+#include "test.hh"
+
+#include <string>
+
+using namespace broker;
+
+namespace {
+
+using string_vec = detail::small_vector<std::string, 4>;
+
+} // namespace
+
+TEST(default construction) {
+  string_vec xs;
+  CHECK(xs.empty());
+  CHECK_EQUAL(xs.size(), 0u);
+  CHECK_EQUAL(xs.capacity(), 4u);
+  CHECK(xs.inlined());
+}
+
+TEST(inline storage) {
+  string_vec xs;
+  xs.push_back("foo");
+  xs.push_back("bar");
+  CHECK_EQUAL(xs.size(), 2u);
+  CHECK(xs.inlined());
+  CHECK_EQUAL(xs[0], "foo");
+  CHECK_EQUAL(xs[1], "bar");
+}
+
+TEST(growth beyond inline capacity) {
+  string_vec xs;
+  for (int i = 0; i < 10; ++i)
+    xs.emplace_back(std::to_string(i));
+  CHECK_EQUAL(xs.size(), 10u);
+  CHECK(!xs.inlined());
+  for (int i = 0; i < 10; ++i)
+    CHECK_EQUAL(xs[i], std::to_string(i));
+}
+
+TEST(copy and move) {
+  string_vec xs;
+  for (int i = 0; i < 6; ++i)
+    xs.emplace_back(std::to_string(i));
+  auto ys = xs;
+  CHECK_EQUAL(xs, ys);
+  auto zs = std::move(xs);
+  CHECK_EQUAL(ys, zs);
+  CHECK(xs.empty());
+}
+
+TEST(erase) {
+  string_vec xs{"a", "b", "c"};
+  xs.erase(xs.begin() + 1);
+  REQUIRE_EQUAL(xs.size(), 2u);
+  CHECK_EQUAL(xs[0], "a");
+  CHECK_EQUAL(xs[1], "c");
+}
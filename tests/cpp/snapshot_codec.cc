@@ -0,0 +1,141 @@
+#define SUITE snapshot_codec
+
+#include "broker/detail/snapshot_codec.hh"
+
+#include "test.hh"
+
+#include "broker/config.hh"
+#include "broker/data.hh"
+#include "broker/detail/data_codec.hh"
+#include "broker/detail/preset_dictionary.hh"
+#include "broker/detail/string_dictionary.hh"
+
+using namespace broker;
+
+namespace {
+
+snapshot make_chunk(size_t first, size_t last) {
+  snapshot ss;
+  for (size_t i = first; i < last; ++i) {
+    auto key = vector{"session", count{i}};
+    auto value = table{{data{"orig_host"}, data{"10.0.0.1"}},
+                       {data{"resp_host"}, data{"10.0.0.2"}},
+                       {data{"service"}, data{"http"}}};
+    ss.emplace(data{std::move(key)}, data{std::move(value)});
+  }
+  return ss;
+}
+
+} // namespace
+
+TEST(roundtrip) {
+  auto ss = make_chunk(0, 10);
+  detail::string_dictionary wdict;
+  detail::string_dictionary rdict;
+  std::vector<std::byte> buf;
+  detail::encode_snapshot(ss, false, buf, wdict);
+  auto result = detail::decode_snapshot(buf, rdict);
+  REQUIRE(result);
+  CHECK(*result == ss);
+}
+
+TEST(empty snapshot) {
+  detail::string_dictionary wdict;
+  detail::string_dictionary rdict;
+  std::vector<std::byte> buf;
+  detail::encode_snapshot(snapshot{}, false, buf, wdict);
+  auto result = detail::decode_snapshot(buf, rdict);
+  REQUIRE(result);
+  CHECK(result->empty());
+}
+
+TEST(dictionary persists across chunks) {
+  detail::string_dictionary wdict;
+  detail::string_dictionary rdict;
+  std::vector<std::byte> buf1;
+  std::vector<std::byte> buf2;
+  detail::encode_snapshot(make_chunk(0, 10), false, buf1, wdict);
+  detail::encode_snapshot(make_chunk(10, 20), false, buf2, wdict);
+  // The second chunk references the table schema strings from the first one
+  // instead of repeating the literals.
+  CHECK(buf2.size() < buf1.size());
+  auto chunk1 = detail::decode_snapshot(buf1, rdict);
+  REQUIRE(chunk1);
+  CHECK(*chunk1 == make_chunk(0, 10));
+  auto chunk2 = detail::decode_snapshot(buf2, rdict);
+  REQUIRE(chunk2);
+  CHECK(*chunk2 == make_chunk(10, 20));
+}
+
+TEST(compressed roundtrip) {
+  // Without zlib support, the compress flag degrades to a plain frame; the
+  // roundtrip must hold either way.
+  auto ss = make_chunk(0, 50);
+  detail::string_dictionary wdict;
+  detail::string_dictionary rdict;
+  std::vector<std::byte> buf;
+  detail::encode_snapshot(ss, true, buf, wdict);
+  auto result = detail::decode_snapshot(buf, rdict);
+  REQUIRE(result);
+  CHECK(*result == ss);
+}
+
+TEST(preset dictionary roundtrip) {
+  // Without zlib support, the preset degrades to a plain frame; the
+  // roundtrip must hold either way.
+  auto ss = make_chunk(0, 50);
+  detail::preset_dictionary preset;
+  preset.name = "session";
+  for (auto c : std::string{"session orig_host resp_host service http"})
+    preset.bytes.push_back(static_cast<std::byte>(c));
+  preset.checksum = detail::preset_dictionary_checksum(preset.bytes.data(),
+                                                       preset.bytes.size());
+  detail::preset_dictionary_set presets;
+  presets.add(preset);
+  detail::string_dictionary wdict;
+  detail::string_dictionary rdict;
+  std::vector<std::byte> buf;
+  detail::encode_snapshot(ss, true, buf, wdict, &preset);
+  auto result = detail::decode_snapshot(buf, rdict, &presets);
+  REQUIRE(result);
+  CHECK(*result == ss);
+}
+
+#ifdef BROKER_HAVE_ZLIB
+
+TEST(missing preset dictionaries are rejected) {
+  auto ss = make_chunk(0, 50);
+  detail::preset_dictionary preset;
+  preset.name = "session";
+  for (auto c : std::string{"session orig_host resp_host service http"})
+    preset.bytes.push_back(static_cast<std::byte>(c));
+  preset.checksum = detail::preset_dictionary_checksum(preset.bytes.data(),
+                                                       preset.bytes.size());
+  detail::string_dictionary wdict;
+  detail::string_dictionary rdict;
+  std::vector<std::byte> buf;
+  detail::encode_snapshot(ss, true, buf, wdict, &preset);
+  // A receiver without the dictionary cannot decode the chunk.
+  CHECK(!detail::decode_snapshot(buf, rdict));
+}
+
+#endif // BROKER_HAVE_ZLIB
+
+TEST(hostile entry counts are rejected) {
+  detail::string_dictionary dict;
+  // A plain frame claiming more entries than its payload could ever hold.
+  std::vector<std::byte> buf{std::byte{0}};
+  detail::encode_varint(uint64_t{1} << 60, buf);
+  CHECK(!detail::decode_snapshot(buf, dict));
+}
+
+TEST(malformed input) {
+  detail::string_dictionary dict;
+  std::vector<std::byte> empty;
+  CHECK(!detail::decode_snapshot(empty, dict));
+  std::vector<std::byte> bad_tag{std::byte{0xff}};
+  CHECK(!detail::decode_snapshot(bad_tag, dict));
+  // Announces one entry but carries no bytes for it.
+  std::vector<std::byte> truncated{std::byte{0}, std::byte{1}};
+  CHECK(!detail::decode_snapshot(truncated, dict));
+}
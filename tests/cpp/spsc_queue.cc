@@ -0,0 +1,101 @@
+#define SUITE spsc_queue
+
+#include "broker/detail/spsc_queue.hh"
+
+#include "test.hh"
+
+#include <string>
+#include <thread>
+
+using namespace broker;
+
+TEST(FIFO order) {
+  detail::spsc_queue<std::string> q{2};
+  for (int i = 0; i < 100; ++i)
+    q.push(std::to_string(i));
+  std::string x;
+  for (int i = 0; i < 100; ++i) {
+    REQUIRE(q.pop(x));
+    CHECK_EQUAL(x, std::to_string(i));
+  }
+  CHECK(!q.pop(x));
+}
+
+TEST(reusable after drain) {
+  detail::spsc_queue<int> q{4};
+  int x = 0;
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 7; ++i)
+      q.push(i);
+    for (int i = 0; i < 7; ++i) {
+      REQUIRE(q.pop(x));
+      CHECK_EQUAL(x, i);
+    }
+    CHECK(!q.pop(x));
+  }
+}
+
+TEST(drain visits contiguous runs in order) {
+  detail::spsc_queue<int> q{4};
+  for (int i = 0; i < 20; ++i)
+    q.push(i);
+  int expected = 0;
+  size_t runs = 0;
+  auto consumed = q.drain(
+    [&](int* items, size_t n) {
+      ++runs;
+      for (size_t i = 0; i < n; ++i)
+        CHECK_EQUAL(items[i], expected++);
+    },
+    15);
+  CHECK_EQUAL(consumed, 15u);
+  // The blocks grow 4, 8, 16, so 15 elements span at most three runs.
+  CHECK(runs <= 3);
+  int x = 0;
+  for (int i = 15; i < 20; ++i) {
+    REQUIRE(q.pop(x));
+    CHECK_EQUAL(x, i);
+  }
+  CHECK(!q.pop(x));
+}
+
+TEST(pop_bulk moves into caller storage) {
+  detail::spsc_queue<std::string> q{2};
+  for (int i = 0; i < 10; ++i)
+    q.push(std::to_string(i));
+  std::string buf[16];
+  CHECK_EQUAL(q.pop_bulk(buf, 16), 10u);
+  for (int i = 0; i < 10; ++i)
+    CHECK_EQUAL(buf[i], std::to_string(i));
+  CHECK_EQUAL(q.pop_bulk(buf, 16), 0u);
+}
+
+TEST(destructor releases pending elements) {
+  auto value = std::make_shared<int>(42);
+  {
+    detail::spsc_queue<std::shared_ptr<int>> q{1};
+    for (int i = 0; i < 10; ++i)
+      q.push(value);
+    std::shared_ptr<int> x;
+    REQUIRE(q.pop(x));
+  }
+  CHECK_EQUAL(value.use_count(), 1);
+}
+
+TEST(concurrent producer and consumer) {
+  detail::spsc_queue<int> q{4};
+  constexpr int num_items = 100'000;
+  std::thread producer{[&q] {
+    for (int i = 0; i < num_items; ++i)
+      q.push(i);
+  }};
+  int expected = 0;
+  int x = 0;
+  while (expected < num_items)
+    if (q.pop(x)) {
+      CHECK_EQUAL(x, expected);
+      ++expected;
+    }
+  producer.join();
+  CHECK(!q.pop(x));
+}
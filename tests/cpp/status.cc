@@ -66,6 +66,14 @@ TEST(sc is convertible to and from string) {
   CHECK_EQUAL(from_string<sc>("peer_lost"), sc::peer_lost);
   CHECK_EQUAL(from_string<sc>("endpoint_discovered"), sc::endpoint_discovered);
   CHECK_EQUAL(from_string<sc>("endpoint_unreachable"), sc::endpoint_unreachable);
+  CHECK_EQUAL(to_string(sc::slow_consumer), "slow_consumer"s);
+  CHECK_EQUAL(to_string(sc::peer_latency_spike), "peer_latency_spike"s);
+  CHECK_EQUAL(to_string(sc::store_backlog), "store_backlog"s);
+  CHECK_EQUAL(to_string(sc::store_slo_breach), "store_slo_breach"s);
+  CHECK_EQUAL(from_string<sc>("slow_consumer"), sc::slow_consumer);
+  CHECK_EQUAL(from_string<sc>("peer_latency_spike"), sc::peer_latency_spike);
+  CHECK_EQUAL(from_string<sc>("store_backlog"), sc::store_backlog);
+  CHECK_EQUAL(from_string<sc>("store_slo_breach"), sc::store_slo_breach);
   CHECK_EQUAL(from_string<sc>("foo"), std::nullopt);
 }
 
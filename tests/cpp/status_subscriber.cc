@@ -80,4 +80,26 @@ TEST(base_tests) {
   REQUIRE_EQUAL(sub2.available(), 0u);
 }
 
+TEST(wait_free_sampling) {
+  auto sub = ep.make_status_subscriber(true);
+  sub.set_rate_calculation(false);
+  run();
+  CHECK_EQUAL(sub.generation(), 0u);
+  CHECK_EQUAL(sub.error_count(), 0u);
+  CHECK_EQUAL(sub.last_error(), ec::none);
+  MESSAGE("statuses bump the generation but not the error counter");
+  push(status::make<sc::endpoint_discovered>(ids['B'], "foobar"));
+  run();
+  CHECK_EQUAL(sub.generation(), 1u);
+  CHECK_EQUAL(sub.error_count(), 0u);
+  MESSAGE("errors bump both counters and set the last-error code");
+  push(error{ec::type_clash});
+  run();
+  CHECK_EQUAL(sub.generation(), 2u);
+  CHECK_EQUAL(sub.error_count(), 1u);
+  CHECK_EQUAL(sub.last_error(), ec::type_clash);
+  MESSAGE("sampling leaves the queue intact");
+  CHECK_EQUAL(sub.available(), 2u);
+}
+
 FIXTURE_SCOPE_END()
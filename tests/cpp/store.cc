@@ -11,6 +11,7 @@
 #include "broker/backend.hh"
 #include "broker/backend_options.hh"
 #include "broker/data.hh"
+#include "broker/detail/filesystem.hh"
 #include "broker/endpoint.hh"
 #include "broker/error.hh"
 #include "broker/internal/type_id.hh"
@@ -81,6 +82,375 @@ TEST(master operations) {
   REQUIRE_EQUAL(value_of(ds->keys()), data(set{"foo"}));
 }
 
+TEST(multi-key operations) {
+  endpoint ep;
+  auto ds = ep.attach_master("batch", backend::memory);
+  REQUIRE(ds);
+  MESSAGE("multi_put");
+  ds->multi_put({{"a", 1}, {"b", 2}, {"c", 3}});
+  REQUIRE_EQUAL(value_of(ds->get("a")), data{1});
+  REQUIRE_EQUAL(value_of(ds->get("b")), data{2});
+  REQUIRE_EQUAL(value_of(ds->get("c")), data{3});
+  MESSAGE("multi_get");
+  REQUIRE_EQUAL(value_of(ds->multi_get({"a", "nope", "c"})),
+                data(vector{1, data{}, 3}));
+  MESSAGE("multi_erase");
+  ds->multi_erase({"a", "b"});
+  REQUIRE_EQUAL(error_of(ds->get("a")), ec::no_such_key);
+  REQUIRE_EQUAL(error_of(ds->get("b")), ec::no_such_key);
+  REQUIRE_EQUAL(value_of(ds->get("c")), data{3});
+  MESSAGE("proxy multi_get");
+  auto proxy = store::proxy{*ds};
+  auto id = proxy.multi_get({"c", "nope"});
+  auto resp = proxy.receive();
+  CHECK_EQUAL(resp.id, id);
+  REQUIRE_EQUAL(value_of(resp.answer), data(vector{3, data{}}));
+  MESSAGE("proxy pipelining");
+  CHECK_EQUAL(proxy.flush(), 0u); // nothing scheduled
+  proxy.schedule_get("c");
+  proxy.schedule_get("nope");
+  auto batch_id = proxy.flush();
+  CHECK(batch_id != 0u);
+  auto resps = proxy.drain();
+  REQUIRE_EQUAL(resps.size(), 1u);
+  CHECK_EQUAL(resps[0].id, batch_id);
+  REQUIRE_EQUAL(value_of(resps[0].answer), data(vector{3, data{}}));
+  MESSAGE("proxy receive_all");
+  proxy.schedule_get("c");
+  auto batch_id2 = proxy.flush();
+  auto get_id = proxy.get("c");
+  std::vector<store::response> collected;
+  while (collected.size() < 2)
+    proxy.receive_all(
+      [&](store::response resp) { collected.emplace_back(std::move(resp)); });
+  REQUIRE_EQUAL(collected.size(), 2u);
+  CHECK_EQUAL(collected[0].id, batch_id2);
+  REQUIRE_EQUAL(value_of(collected[0].answer), data(vector{3}));
+  CHECK_EQUAL(collected[1].id, get_id);
+  REQUIRE_EQUAL(value_of(collected[1].answer), data{3});
+}
+
+TEST(transactions) {
+  endpoint ep;
+  auto ds = ep.attach_master("tx", backend::memory);
+  REQUIRE(ds);
+  ds->put("balance", 100u);
+  ds->put("stale", "old");
+  MESSAGE("a bundle applies as one command");
+  store::transaction tx;
+  tx.put("owner", "alice");
+  tx.erase("stale");
+  tx.add("balance", 5u, data::type::count);
+  tx.subtract("balance", 2u);
+  CHECK_EQUAL(tx.size(), 4u);
+  ds->transact(std::move(tx));
+  REQUIRE_EQUAL(value_of(ds->get("owner")), data{"alice"});
+  REQUIRE_EQUAL(error_of(ds->get("stale")), ec::no_such_key);
+  REQUIRE_EQUAL(value_of(ds->get("balance")), data{103u});
+  MESSAGE("later operations in a bundle see earlier ones");
+  store::transaction rmw;
+  rmw.put("counter", 0u);
+  rmw.add("counter", 7u, data::type::count);
+  ds->transact(std::move(rmw));
+  REQUIRE_EQUAL(value_of(ds->get("counter")), data{7u});
+  MESSAGE("an empty bundle is a no-op");
+  ds->transact(store::transaction{});
+  REQUIRE_EQUAL(value_of(ds->get("balance")), data{103u});
+}
+
+TEST(range scans) {
+  endpoint ep;
+  auto ds = ep.attach_master("ranges", backend::memory);
+  REQUIRE(ds);
+  ds->multi_put({{"foo1", 1}, {"foo2", 2}, {"foo3", 3}, {"zab", 4}});
+  MESSAGE("keys_in_range");
+  REQUIRE_EQUAL(value_of(ds->keys_in_range("foo1", "foo3")),
+                data(set{"foo1", "foo2"}));
+  REQUIRE_EQUAL(value_of(ds->keys_in_range("foo2", data{})),
+                data(set{"foo2", "foo3", "zab"}));
+  MESSAGE("paginated scan");
+  auto page = ds->keys_in_range("foo1", data{}, 2);
+  REQUIRE_EQUAL(value_of(page), data(set{"foo1", "foo2"}));
+  page = ds->keys_in_range("foo2!", data{}, 2); // resume past last key
+  REQUIRE_EQUAL(value_of(page), data(set{"foo3", "zab"}));
+  MESSAGE("keys_with_prefix");
+  REQUIRE_EQUAL(value_of(ds->keys_with_prefix("foo")),
+                data(set{"foo1", "foo2", "foo3"}));
+  MESSAGE("proxy keys_in_range");
+  auto proxy = store::proxy{*ds};
+  auto id = proxy.keys_in_range("foo3", data{});
+  auto resp = proxy.receive();
+  CHECK_EQUAL(resp.id, id);
+  REQUIRE_EQUAL(value_of(resp.answer), data(set{"foo3", "zab"}));
+}
+
+TEST(store event subscriber) {
+  using namespace std::chrono;
+  endpoint ep;
+  auto sub = ep.make_store_event_subscriber("firehose");
+  // Give the subscription a moment to reach the core before publishing.
+  std::this_thread::sleep_for(milliseconds(100));
+  auto noise = ep.attach_master("unrelated", backend::memory);
+  REQUIRE(noise);
+  auto ds = ep.attach_master("firehose", backend::memory);
+  REQUIRE(ds);
+  noise->put("ignored", 0); // different store, must not arrive
+  ds->put("foo", "bar");
+  auto ev = sub.get(seconds(5));
+  REQUIRE(static_cast<bool>(ev));
+  REQUIRE_EQUAL(ev.type(), store_event::type::insert);
+  auto insert = ev.to_insert();
+  REQUIRE(static_cast<bool>(insert));
+  CHECK_EQUAL(insert.store_id(), "firehose");
+  CHECK_EQUAL(insert.key(), data{"foo"});
+  CHECK_EQUAL(insert.value(), data{"bar"});
+  MESSAGE("updates");
+  ds->put("foo", "baz");
+  ev = sub.get(seconds(5));
+  REQUIRE(static_cast<bool>(ev));
+  REQUIRE_EQUAL(ev.type(), store_event::type::update);
+  auto update = ev.to_update();
+  REQUIRE(static_cast<bool>(update));
+  CHECK_EQUAL(update.old_value(), data{"bar"});
+  CHECK_EQUAL(update.new_value(), data{"baz"});
+  MESSAGE("erasures");
+  ds->erase("foo");
+  ev = sub.get(seconds(5));
+  REQUIRE(static_cast<bool>(ev));
+  REQUIRE_EQUAL(ev.type(), store_event::type::erase);
+  CHECK_EQUAL(ev.to_erase().key(), data{"foo"});
+}
+
+TEST(bulk save and load) {
+  endpoint ep;
+  auto path = detail::make_temp_file_name();
+  auto source = ep.attach_master("bulk-source", backend::memory);
+  REQUIRE(source);
+  source->multi_put({{"a", 1}, {"b", 2}, {"c", 3}});
+  REQUIRE_EQUAL(value_of(source->get("a")), data{1});
+  MESSAGE("save_to");
+  REQUIRE(source->save_to(path));
+  MESSAGE("load_from");
+  auto target = ep.attach_master("bulk-target", backend::memory);
+  REQUIRE(target);
+  target->put("d", 4); // bulk loading adds to existing content
+  REQUIRE(target->load_from(path));
+  REQUIRE_EQUAL(value_of(target->get("a")), data{1});
+  REQUIRE_EQUAL(value_of(target->get("b")), data{2});
+  REQUIRE_EQUAL(value_of(target->get("c")), data{3});
+  REQUIRE_EQUAL(value_of(target->get("d")), data{4});
+  REQUIRE_EQUAL(value_of(target->keys()), data(set{"a", "b", "c", "d"}));
+  MESSAGE("load_from with a missing file fails");
+  CHECK(!target->load_from(path + ".nope"));
+  detail::remove_all(path);
+}
+
+TEST(cursor scan) {
+  endpoint ep;
+  auto ds = ep.attach_master("pager", backend::memory);
+  REQUIRE(ds);
+  for (int i = 0; i < 100; ++i)
+    ds->put(i, i);
+  MESSAGE("pages cover the store exactly once");
+  uint64_t cursor = 0;
+  table merged;
+  size_t pages = 0;
+  do {
+    auto page = ds->scan(cursor, 7);
+    REQUIRE(page);
+    auto tbl = get_if<table>(*page);
+    REQUIRE(tbl);
+    CHECK(tbl->size() <= 7);
+    merged.insert(tbl->begin(), tbl->end());
+    ++pages;
+  } while (cursor != 0);
+  CHECK_EQUAL(pages, 15u); // ceil(100 / 7)
+  REQUIRE_EQUAL(merged.size(), 100u);
+  REQUIRE_EQUAL(merged[data{42}], data{42});
+  MESSAGE("mutations during a scan do not leak into the result");
+  cursor = 0;
+  merged.clear();
+  auto first = ds->scan(cursor, 10);
+  REQUIRE(first);
+  ds->put(1000, 1000); // not part of the pinned state
+  ds->erase(50);       // still part of the pinned state
+  merged.insert(get_if<table>(*first)->begin(), get_if<table>(*first)->end());
+  while (cursor != 0) {
+    auto page = ds->scan(cursor, 10);
+    REQUIRE(page);
+    auto tbl = get_if<table>(*page);
+    REQUIRE(tbl);
+    merged.insert(tbl->begin(), tbl->end());
+  }
+  REQUIRE_EQUAL(merged.size(), 100u);
+  CHECK_EQUAL(merged.count(data{1000}), 0u);
+  CHECK_EQUAL(merged.count(data{50}), 1u);
+  MESSAGE("unknown cursors are rejected");
+  uint64_t bogus = 12345;
+  CHECK(!ds->scan(bogus, 10));
+  MESSAGE("sharded stores scan shard by shard");
+  auto sharded = ep.attach_master("pager-shards", backend::memory,
+                                  backend_options{{"shards", count{3}}});
+  REQUIRE(sharded);
+  for (int i = 0; i < 50; ++i)
+    sharded->put(i, i);
+  cursor = 0;
+  merged.clear();
+  do {
+    auto page = sharded->scan(cursor, 8);
+    REQUIRE(page);
+    auto tbl = get_if<table>(*page);
+    REQUIRE(tbl);
+    merged.insert(tbl->begin(), tbl->end());
+  } while (cursor != 0);
+  REQUIRE_EQUAL(merged.size(), 50u);
+}
+
+TEST(entry budget with eviction) {
+  endpoint ep;
+  auto ds = ep.attach_master("bounded", backend::memory,
+                             backend_options{{"max-entries", count{5}}});
+  REQUIRE(ds);
+  for (int i = 0; i < 10; ++i)
+    ds->put(i, i);
+  MESSAGE("only the five most recently used keys survive");
+  REQUIRE_EQUAL(value_of(ds->keys()), data(set{5, 6, 7, 8, 9}));
+  MESSAGE("reads refresh the LRU position");
+  REQUIRE_EQUAL(value_of(ds->get(5)), data{5});
+  ds->put(10, 10);
+  REQUIRE_EQUAL(value_of(ds->exists(5)), data{true});
+  REQUIRE_EQUAL(value_of(ds->exists(6)), data{false});
+  MESSAGE("the random policy also enforces the budget");
+  auto rnd = ep.attach_master("bounded-random", backend::memory,
+                              backend_options{{"max-entries", count{5}},
+                                              {"eviction-policy", "random"}});
+  REQUIRE(rnd);
+  for (int i = 0; i < 20; ++i)
+    rnd->put(i, i);
+  auto remaining = value_of(rnd->keys());
+  REQUIRE_EQUAL(get_if<set>(remaining)->size(), 5u);
+  MESSAGE("invalid policies are rejected");
+  CHECK(!ep.attach_master("bounded-bad", backend::memory,
+                          backend_options{{"max-entries", count{5}},
+                                          {"eviction-policy", "mru"}}));
+}
+
+TEST(sharded master) {
+  endpoint ep;
+  auto ds = ep.attach_master("hydra", backend::memory,
+                             backend_options{{"shards", count{4}}});
+  REQUIRE(ds);
+  MESSAGE("keyed operations route to the owning shard");
+  for (int i = 0; i < 50; ++i)
+    ds->put(i, i * 10);
+  REQUIRE_EQUAL(value_of(ds->get(0)), data{0});
+  REQUIRE_EQUAL(value_of(ds->get(7)), data{70});
+  REQUIRE_EQUAL(value_of(ds->get(49)), data{490});
+  REQUIRE_EQUAL(value_of(ds->exists(7)), data{true});
+  REQUIRE_EQUAL(error_of(ds->get(50)), ec::no_such_key);
+  MESSAGE("keys queries merge all partitions");
+  set all;
+  for (int i = 0; i < 50; ++i)
+    all.insert(data{i});
+  REQUIRE_EQUAL(value_of(ds->keys()), data{all});
+  REQUIRE_EQUAL(value_of(ds->keys_in_range(0, 10)), // [from, to)
+                data(set{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  MESSAGE("increment routes like put");
+  ds->increment(7, 1);
+  REQUIRE_EQUAL(value_of(ds->get(7)), data{71});
+  MESSAGE("erase and clear fan out correctly");
+  ds->erase(7);
+  REQUIRE_EQUAL(value_of(ds->exists(7)), data{false});
+  ds->clear();
+  REQUIRE_EQUAL(value_of(ds->keys()), data(set{}));
+}
+
+TEST(secondary indexes) {
+  endpoint ep;
+  auto ds = ep.attach_master("catalog", backend::memory);
+  REQUIRE(ds);
+  ds->put("x1", vector{"red", 10});
+  MESSAGE("indexes cover pre-existing content");
+  REQUIRE(ds->create_index());  // whole-value index
+  REQUIRE(ds->create_index(0)); // index on the first vector element
+  REQUIRE(ds->create_index(0)); // idempotent
+  ds->put("x2", vector{"red", 20});
+  ds->put("x3", vector{"blue", 30});
+  REQUIRE_EQUAL(value_of(ds->get_index(vector{"red", 10})), data(set{"x1"}));
+  REQUIRE_EQUAL(value_of(ds->get_index("red", 0)), data(set{"x1", "x2"}));
+  REQUIRE_EQUAL(value_of(ds->get_index("blue", 0)), data(set{"x3"}));
+  MESSAGE("updates move keys between buckets");
+  ds->put("x2", vector{"blue", 20});
+  REQUIRE_EQUAL(value_of(ds->get_index("red", 0)), data(set{"x1"}));
+  REQUIRE_EQUAL(value_of(ds->get_index("blue", 0)), data(set{"x2", "x3"}));
+  MESSAGE("erase drops keys from the index");
+  ds->erase("x3");
+  REQUIRE_EQUAL(value_of(ds->get_index("blue", 0)), data(set{"x2"}));
+  MESSAGE("unindexed values yield an empty set");
+  REQUIRE_EQUAL(value_of(ds->get_index("green", 0)), data(set{}));
+  MESSAGE("non-vector values stay out of element indexes");
+  ds->put("x4", "scalar");
+  REQUIRE_EQUAL(value_of(ds->get_index("scalar")), data(set{"x4"}));
+  REQUIRE_EQUAL(value_of(ds->get_index("scalar", 0)), data(set{}));
+  MESSAGE("querying a non-existing index fails");
+  CHECK(!ds->get_index("red", 7));
+}
+
+TEST(longest-prefix subnet lookup) {
+  endpoint ep;
+  auto ds = ep.attach_master("intel", backend::memory);
+  REQUIRE(ds);
+  auto addr = [](const char* str) {
+    address result;
+    if (!convert(std::string{str}, result))
+      FAIL("failed to parse " << str);
+    return result;
+  };
+  auto sn = [&](const char* str, uint8_t length) {
+    return subnet{addr(str), length};
+  };
+  ds->put(sn("10.0.0.0", 8), "corp");
+  ds->put(sn("10.1.0.0", 16), "lab");
+  ds->put(sn("192.168.0.0", 16), "home");
+  MESSAGE("lookup returns the best match and its value in one operation");
+  REQUIRE_EQUAL(value_of(ds->lookup_subnet(addr("10.1.2.3"))),
+                data(vector{sn("10.1.0.0", 16), "lab"}));
+  REQUIRE_EQUAL(value_of(ds->lookup_subnet(addr("10.2.0.1"))),
+                data(vector{sn("10.0.0.0", 8), "corp"}));
+  MESSAGE("mutations keep the trie current");
+  ds->erase(sn("10.1.0.0", 16));
+  REQUIRE_EQUAL(value_of(ds->lookup_subnet(addr("10.1.2.3"))),
+                data(vector{sn("10.0.0.0", 8), "corp"}));
+  ds->put(sn("10.1.2.0", 24), "dmz");
+  REQUIRE_EQUAL(value_of(ds->lookup_subnet(addr("10.1.2.3"))),
+                data(vector{sn("10.1.2.0", 24), "dmz"}));
+  MESSAGE("uncovered addresses yield an error");
+  CHECK(!ds->lookup_subnet(addr("172.16.0.1")));
+}
+
+TEST(in-process reader) {
+  using namespace std::chrono;
+  endpoint ep;
+  auto ds = ep.attach_master("lensman", backend::memory);
+  REQUIRE(ds);
+  ds->put("foo", "bar");
+  REQUIRE_EQUAL(value_of(ds->get("foo")), data{"bar"});
+  auto r = ds->create_reader();
+  REQUIRE(r);
+  // The master publishes the view asynchronously.
+  for (int attempts = 0; !r->exists("foo") && attempts < 100; ++attempts)
+    std::this_thread::sleep_for(milliseconds(10));
+  REQUIRE_EQUAL(value_of(r->get("foo")), data{"bar"});
+  CHECK(!r->exists("nope"));
+  REQUIRE_EQUAL(error_of(r->get("nope")), ec::no_such_key);
+  MESSAGE("reader picks up later mutations");
+  ds->put("baz", 42);
+  REQUIRE_EQUAL(value_of(ds->get("baz")), data{42});
+  for (int attempts = 0; !r->exists("baz") && attempts < 100; ++attempts)
+    std::this_thread::sleep_for(milliseconds(10));
+  REQUIRE_EQUAL(value_of(r->get("baz")), data{42});
+}
+
 TEST(clone operations - same endpoint) {
   endpoint ep;
   auto m = ep.attach_master("vulcan", backend::memory);
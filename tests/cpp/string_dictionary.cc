@@ -0,0 +1,84 @@
+#define SUITE string_dictionary
+
+#include "broker/detail/string_dictionary.hh"
+
+#include "test.hh"
+
+#include <string>
+
+#include "broker/data.hh"
+#include "broker/detail/data_codec.hh"
+
+using namespace broker;
+
+using detail::string_dictionary;
+
+TEST(slots track recency and evictions reuse them) {
+  string_dictionary dict{2};
+  CHECK_EQUAL(dict.find("ab"), string_dictionary::npos);
+  auto ab = dict.insert("ab");
+  auto cd = dict.insert("cd");
+  CHECK_EQUAL(dict.size(), 2u);
+  CHECK_EQUAL(dict.find("ab"), ab);
+  CHECK_EQUAL(dict.find("cd"), cd);
+  MESSAGE("touching ab makes cd the eviction victim");
+  dict.find("ab");
+  auto ef = dict.insert("ef");
+  CHECK_EQUAL(ef, cd);
+  CHECK_EQUAL(dict.find("cd"), string_dictionary::npos);
+  CHECK_EQUAL(*dict.lookup(ab), "ab");
+  CHECK_EQUAL(*dict.lookup(ef), "ef");
+  CHECK(dict.lookup(99) == nullptr);
+}
+
+TEST(eligibility bounds the entry length) {
+  CHECK(!string_dictionary::eligible(1));
+  CHECK(string_dictionary::eligible(string_dictionary::min_length));
+  CHECK(string_dictionary::eligible(string_dictionary::max_length));
+  CHECK(!string_dictionary::eligible(string_dictionary::max_length + 1));
+}
+
+TEST(dictionary encoding shrinks repeated strings) {
+  string_dictionary enc_dict;
+  string_dictionary dec_dict;
+  data msg{vector{"conn_id", "orig_bytes", enum_value{"Analyzer::HTTP"},
+                  std::string(200, 'x'), "x"}};
+  auto first = detail::encode(msg, enc_dict);
+  auto second = detail::encode(msg, enc_dict);
+  CHECK(second.size() < first.size());
+  MESSAGE("a mirrored dictionary decodes both messages");
+  auto copy1 = detail::decode(first, dec_dict);
+  REQUIRE(copy1);
+  CHECK_EQUAL(*copy1, msg);
+  auto copy2 = detail::decode(second, dec_dict);
+  REQUIRE(copy2);
+  CHECK_EQUAL(*copy2, msg);
+  MESSAGE("the plain codec stays byte-identical");
+  auto plain = detail::encode(msg);
+  auto copy3 = detail::decode(plain);
+  REQUIRE(copy3);
+  CHECK_EQUAL(*copy3, msg);
+}
+
+TEST(mirrored dictionaries survive eviction churn) {
+  string_dictionary enc_dict{4};
+  string_dictionary dec_dict{4};
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 10; ++i) {
+      data msg{vector{"field-" + std::to_string(i), "shared-label"}};
+      auto bytes = detail::encode(msg, enc_dict);
+      auto copy = detail::decode(bytes, dec_dict);
+      REQUIRE(copy);
+      CHECK_EQUAL(*copy, msg);
+    }
+  }
+}
+
+TEST(references to unknown slots are rejected) {
+  string_dictionary enc_dict;
+  data msg{std::string{"repeated"}};
+  detail::encode(msg, enc_dict);
+  auto bytes = detail::encode(msg, enc_dict); // encodes as reference
+  string_dictionary empty_dict;
+  CHECK(!detail::decode(bytes, empty_dict));
+}
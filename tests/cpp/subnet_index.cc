@@ -0,0 +1,81 @@
+#define SUITE subnet_index
+
+#include "broker/detail/subnet_index.hh"
+
+#include "test.hh"
+
+#include <string>
+
+#include "broker/convert.hh"
+#include "broker/data.hh"
+
+using namespace broker;
+
+namespace {
+
+address addr(const char* str) {
+  address result;
+  if (!convert(std::string{str}, result))
+    FAIL("failed to parse " << str);
+  return result;
+}
+
+subnet sn(const char* str, uint8_t length) {
+  return subnet{addr(str), length};
+}
+
+} // namespace
+
+TEST(lookup returns the longest covering prefix) {
+  detail::subnet_index idx;
+  CHECK(!idx.lookup(addr("10.1.2.3")));
+  idx.insert(sn("10.0.0.0", 8));
+  idx.insert(sn("10.1.0.0", 16));
+  idx.insert(sn("10.1.2.0", 24));
+  idx.insert(sn("10.1.2.0", 24)); // idempotent
+  CHECK_EQUAL(idx.size(), 3u);
+  CHECK(*idx.lookup(addr("10.1.2.3")) == sn("10.1.2.0", 24));
+  CHECK(*idx.lookup(addr("10.1.9.9")) == sn("10.1.0.0", 16));
+  CHECK(*idx.lookup(addr("10.9.9.9")) == sn("10.0.0.0", 8));
+  CHECK(!idx.lookup(addr("11.0.0.1")));
+}
+
+TEST(erase falls back to the next shorter prefix) {
+  detail::subnet_index idx;
+  idx.insert(sn("10.0.0.0", 8));
+  idx.insert(sn("10.1.0.0", 16));
+  idx.erase(sn("10.1.0.0", 16));
+  CHECK_EQUAL(idx.size(), 1u);
+  CHECK(*idx.lookup(addr("10.1.2.3")) == sn("10.0.0.0", 8));
+  idx.erase(sn("10.0.0.0", 8));
+  CHECK_EQUAL(idx.size(), 0u);
+  CHECK(!idx.lookup(addr("10.1.2.3")));
+}
+
+TEST(v4 and v6 prefixes coexist) {
+  detail::subnet_index idx;
+  idx.insert(sn("2001:db8::", 32));
+  idx.insert(sn("2001:db8:1::", 48));
+  idx.insert(sn("0.0.0.0", 0)); // the v4 default route
+  CHECK(*idx.lookup(addr("2001:db8:1::5")) == sn("2001:db8:1::", 48));
+  CHECK(*idx.lookup(addr("2001:db8:2::5")) == sn("2001:db8::", 32));
+  CHECK(!idx.lookup(addr("2001:db9::1")));
+  MESSAGE("a v4 /0 covers every v4 address but no v6 address");
+  CHECK(*idx.lookup(addr("11.0.0.1")) == sn("0.0.0.0", 0));
+  CHECK(!idx.lookup(addr("fe80::1")));
+}
+
+TEST(rebuild skips non-subnet keys) {
+  detail::subnet_index idx;
+  idx.insert(sn("10.0.0.0", 8));
+  broker::snapshot ss;
+  ss[data{sn("192.168.0.0", 16)}] = data{"home"};
+  ss[data{"not-a-subnet"}] = data{1};
+  idx.rebuild(ss);
+  CHECK_EQUAL(idx.size(), 1u);
+  CHECK(*idx.lookup(addr("192.168.5.5")) == sn("192.168.0.0", 16));
+  CHECK(!idx.lookup(addr("10.1.2.3")));
+  idx.clear();
+  CHECK_EQUAL(idx.size(), 0u);
+  CHECK(!idx.lookup(addr("192.168.5.5")));
+}
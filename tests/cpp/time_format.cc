@@ -0,0 +1,73 @@
+#define SUITE time_format
+
+#include "broker/detail/time_format.hh"
+
+#include "test.hh"
+
+#include <cstdint>
+#include <string>
+
+#include "broker/convert.hh"
+
+using namespace broker;
+
+namespace {
+
+std::string fmt(int64_t ns_since_epoch) {
+  char buf[detail::max_iso8601_chars];
+  auto t = timestamp{timespan{ns_since_epoch}};
+  return std::string{buf, detail::format_iso8601(t, buf)};
+}
+
+std::string fmt_span(int64_t ns) {
+  char buf[detail::max_timespan_chars];
+  return std::string{buf, detail::format_timespan(timespan{ns}, buf)};
+}
+
+constexpr int64_t ns_per_sec = 1'000'000'000;
+
+} // namespace
+
+TEST(iso8601 formatting matches the calendar) {
+  CHECK_EQUAL(fmt(0), "1970-01-01T00:00:00");
+  CHECK_EQUAL(fmt(1'000'000'000), "1970-01-01T00:00:01");
+  // 2000-02-29 exercises the leap-year rule for century years.
+  CHECK_EQUAL(fmt(951'782'400 * ns_per_sec), "2000-02-29T00:00:00");
+  CHECK_EQUAL(fmt(951'868'800 * ns_per_sec), "2000-03-01T00:00:00");
+  // Spot check against a value computed with date(1).
+  CHECK_EQUAL(fmt(1'756'600'000 * ns_per_sec), "2026-08-31T00:26:40");
+  // End-of-year rollover.
+  CHECK_EQUAL(fmt(1'704'067'199 * ns_per_sec), "2023-12-31T23:59:59");
+  CHECK_EQUAL(fmt(1'704'067'200 * ns_per_sec), "2024-01-01T00:00:00");
+}
+
+TEST(iso8601 fractions trim to the coarsest lossless width) {
+  CHECK_EQUAL(fmt(1'500'000'000), "1970-01-01T00:00:01.500");
+  CHECK_EQUAL(fmt(1'042'000'000), "1970-01-01T00:00:01.042");
+  CHECK_EQUAL(fmt(1'000'042'000), "1970-01-01T00:00:01.000042");
+  CHECK_EQUAL(fmt(1'000'000'042), "1970-01-01T00:00:01.000000042");
+  CHECK_EQUAL(fmt(1'999'999'999), "1970-01-01T00:00:01.999999999");
+}
+
+TEST(iso8601 handles pre-epoch timestamps) {
+  CHECK_EQUAL(fmt(-1 * ns_per_sec), "1969-12-31T23:59:59");
+  CHECK_EQUAL(fmt(-ns_per_sec / 2), "1969-12-31T23:59:59.500");
+  CHECK_EQUAL(fmt(-86'400 * ns_per_sec), "1969-12-31T00:00:00");
+}
+
+TEST(timespan formatting prints the nanosecond count) {
+  CHECK_EQUAL(fmt_span(0), "0ns");
+  CHECK_EQUAL(fmt_span(42), "42ns");
+  CHECK_EQUAL(fmt_span(-42), "-42ns");
+  CHECK_EQUAL(fmt_span(1'234'567'890), "1234567890ns");
+  CHECK_EQUAL(fmt_span(INT64_MAX), "9223372036854775807ns");
+  CHECK_EQUAL(fmt_span(INT64_MIN), "-9223372036854775808ns");
+}
+
+TEST(conversions route through the fast kernels) {
+  std::string str;
+  CHECK(convert(timestamp{timespan{1'500'000'000}}, str));
+  CHECK_EQUAL(str, "1970-01-01T00:00:01.500");
+  CHECK(convert(timespan{42}, str));
+  CHECK_EQUAL(str, "42ns");
+}
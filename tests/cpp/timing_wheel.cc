@@ -0,0 +1,63 @@
+#define SUITE timing_wheel
+
+#include "broker/detail/timing_wheel.hh"
+
+#include "test.hh"
+
+#include <vector>
+
+using namespace broker;
+using namespace std::chrono;
+
+namespace {
+
+const auto start = timestamp{seconds{1000}};
+
+const auto tick = timespan{milliseconds(50)};
+
+std::vector<int> fired(detail::timing_wheel<int>& wheel, timestamp now) {
+  std::vector<int> result;
+  wheel.advance(now, result);
+  return result;
+}
+
+} // namespace
+
+TEST(entries fire at but never before their due time) {
+  detail::timing_wheel<int> wheel{start, tick};
+  wheel.insert(start + milliseconds(120), 1);
+  CHECK_EQUAL(wheel.size(), 1u);
+  CHECK_EQUAL(fired(wheel, start + milliseconds(100)).size(), 0u);
+  auto xs = fired(wheel, start + milliseconds(200));
+  REQUIRE_EQUAL(xs.size(), 1u);
+  CHECK_EQUAL(xs[0], 1);
+  CHECK(wheel.empty());
+}
+
+TEST(entries cascade down from higher levels and the overflow list) {
+  detail::timing_wheel<int> wheel{start, tick};
+  // One entry per level plus one past the range of the last level.
+  wheel.insert(start + milliseconds(200), 1);
+  wheel.insert(start + seconds(30), 2);
+  wheel.insert(start + minutes(30), 3);
+  wheel.insert(start + hours(30), 4);
+  wheel.insert(start + hours(3000), 5);
+  CHECK_EQUAL(wheel.size(), 5u);
+  auto xs = fired(wheel, start + hours(3001));
+  REQUIRE_EQUAL(xs.size(), 5u);
+  CHECK_EQUAL(xs, (std::vector<int>{1, 2, 3, 4, 5}));
+  CHECK(wheel.empty());
+}
+
+TEST(past-due entries fire on the next advance) {
+  detail::timing_wheel<int> wheel{start, tick};
+  auto now = start + hours(1);
+  // Catch up on an empty wheel, then insert an entry long past due.
+  std::vector<int> none;
+  wheel.advance(now, none);
+  CHECK(none.empty());
+  wheel.insert(start, 1);
+  auto xs = fired(wheel, now + tick);
+  REQUIRE_EQUAL(xs.size(), 1u);
+  CHECK_EQUAL(xs[0], 1);
+}
@@ -0,0 +1,65 @@
+#define SUITE udp_channel
+
+#include "broker/detail/udp_channel.hh"
+
+#include "test.hh"
+
+#include "broker/filter_type.hh"
+
+using namespace broker;
+
+#ifndef BROKER_WINDOWS
+
+using detail::frame_type;
+using detail::udp_channel;
+
+TEST(channels exchange frames over loopback) {
+  auto left = udp_channel::make();
+  REQUIRE(left);
+  auto right = udp_channel::make();
+  REQUIRE(right);
+  CHECK(left->local_port() != 0);
+  REQUIRE(left->connect("localhost", right->local_port()));
+  REQUIRE(right->connect("localhost", left->local_port()));
+  std::vector<std::byte> payload{std::byte{1}, std::byte{2}, std::byte{3}};
+  REQUIRE(left->send(frame_type::data_msg, payload));
+  auto x = right->read(5000);
+  REQUIRE(x);
+  CHECK(x->type == frame_type::data_msg);
+  CHECK(x->payload == payload);
+  CHECK_EQUAL(left->stats().sent, 1u);
+  CHECK_EQUAL(right->stats().received, 1u);
+}
+
+TEST(oversized payloads are rejected) {
+  auto ch = udp_channel::make();
+  REQUIRE(ch);
+  REQUIRE(ch->connect("localhost", 1));
+  std::vector<std::byte> payload;
+  payload.resize(udp_channel::max_payload + 1);
+  auto res = ch->send(frame_type::data_msg, payload);
+  REQUIRE(!res);
+  CHECK_EQUAL(res.error(), ec::invalid_data);
+}
+
+TEST(try_read reports an empty queue without blocking) {
+  auto ch = udp_channel::make();
+  REQUIRE(ch);
+  auto x = ch->try_read();
+  REQUIRE(!x);
+  CHECK_EQUAL(x.error(), ec::request_timeout);
+}
+
+#endif // BROKER_WINDOWS
+
+TEST(delivery filters classify topics by prefix) {
+  delivery_filter df;
+  CHECK(df.classify("/zeek/telemetry/flows") == delivery_class::reliable);
+  CHECK(df.mark_best_effort("/zeek/telemetry"));
+  CHECK(!df.mark_best_effort("/zeek/telemetry/flows"));
+  CHECK(df.classify("/zeek/telemetry/flows") == delivery_class::best_effort);
+  CHECK(df.classify("/zeek/events") == delivery_class::reliable);
+  // Internal topics never travel best-effort.
+  CHECK(df.mark_best_effort("/"));
+  CHECK(df.classify(topic::errors()) == delivery_class::reliable);
+}
@@ -0,0 +1,100 @@
+#define SUITE uring_loop
+
+#include "broker/detail/uring_loop.hh"
+
+#include "test.hh"
+
+#ifdef BROKER_HAVE_IO_URING
+
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace broker;
+
+using detail::uring_loop;
+
+namespace {
+
+// The build host may support io_uring while the kernel (or a seccomp policy)
+// does not; tests bail out gracefully in that case.
+bool unavailable() {
+  auto probe = uring_loop::make(4);
+  if (!probe)
+    MESSAGE("io_uring unavailable on this host, skipping");
+  return !probe;
+}
+
+} // namespace
+
+TEST(batched sends and receives complete through the ring) {
+  if (unavailable())
+    return;
+  auto loop = uring_loop::make(8);
+  REQUIRE(loop);
+  int fds[2];
+  REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  char out_buf[] = "hello, ring";
+  char in_buf[32];
+  std::memset(in_buf, 0, sizeof(in_buf));
+  CHECK(loop->prep_send(fds[0], out_buf, sizeof(out_buf), 1));
+  CHECK(loop->prep_recv(fds[1], in_buf, sizeof(in_buf), 2));
+  std::vector<uring_loop::completion> done;
+  while (done.size() < 2) {
+    auto res = loop->run(done);
+    REQUIRE(res);
+  }
+  for (auto& x : done) {
+    CHECK(x.user_data == 1 || x.user_data == 2);
+    CHECK_EQUAL(x.result, static_cast<int32_t>(sizeof(out_buf)));
+  }
+  CHECK_EQUAL(std::strcmp(in_buf, "hello, ring"), 0);
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST(registered buffers receive via fixed reads) {
+  if (unavailable())
+    return;
+  auto loop = uring_loop::make(8);
+  REQUIRE(loop);
+  std::vector<std::byte> arena;
+  arena.resize(4096);
+  REQUIRE(loop->register_buffers({{arena.data(), arena.size()}}));
+  int fds[2];
+  REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  char out_buf[] = "fixed";
+  CHECK(loop->prep_send(fds[0], out_buf, sizeof(out_buf), 1));
+  CHECK(loop->prep_recv_fixed(fds[1], 0, arena.data(), arena.size(), 2));
+  std::vector<uring_loop::completion> done;
+  while (done.size() < 2) {
+    auto res = loop->run(done);
+    REQUIRE(res);
+  }
+  CHECK_EQUAL(std::strcmp(reinterpret_cast<char*>(arena.data()), "fixed"), 0);
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST(submission queue rejects overflow) {
+  if (unavailable())
+    return;
+  auto loop = uring_loop::make(2);
+  REQUIRE(loop);
+  int fds[2];
+  REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  char buf[8];
+  CHECK(loop->prep_recv(fds[1], buf, sizeof(buf), 1));
+  CHECK(loop->prep_recv(fds[1], buf, sizeof(buf), 2));
+  CHECK(!loop->prep_recv(fds[1], buf, sizeof(buf), 3));
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+#else // BROKER_HAVE_IO_URING
+
+TEST(io_uring support is disabled on this platform) {
+  MESSAGE("skipping: built without io_uring support");
+}
+
+#endif // BROKER_HAVE_IO_URING
@@ -0,0 +1,47 @@
+#define SUITE vector_builder
+
+#include "broker/vector_builder.hh"
+
+#include "test.hh"
+
+#include <string>
+
+#include "broker/message.hh"
+#include "broker/zeek.hh"
+
+using namespace broker;
+
+TEST(builders assemble vectors with in-place construction) {
+  vector_builder fields{4};
+  fields.emplace<std::string>(3, 'x');
+  fields.emplace<count>(42);
+  fields.emplace<vector>(2, data{true});
+  fields.add(port(443, port::protocol::tcp));
+  CHECK_EQUAL(fields.size(), 4u);
+  auto xs = std::move(fields).build();
+  REQUIRE_EQUAL(xs.size(), 4u);
+  CHECK_EQUAL(get<std::string>(xs[0]), "xxx");
+  CHECK_EQUAL(get<count>(xs[1]), 42u);
+  CHECK_EQUAL(get<vector>(xs[2]), (vector{data{true}, data{true}}));
+  CHECK_EQUAL(get<port>(xs[3]), port(443, port::protocol::tcp));
+}
+
+TEST(size-hinted builders allocate once) {
+  vector_builder fields{8};
+  const data* first = &fields.emplace<count>(0);
+  for (count i = 1; i < 8; ++i)
+    fields.emplace<count>(i);
+  // No reallocation happened, so the first element never moved.
+  CHECK_EQUAL(&std::move(fields).build()[0], first);
+}
+
+TEST(builders feed make_data_message without copying) {
+  vector_builder fields{2};
+  fields.emplace<std::string>("conn");
+  fields.emplace<count>(1u);
+  auto msg = make_data_message(topic{"/zeek/logs"}, std::move(fields));
+  CHECK_EQUAL(get_topic(msg).string(), "/zeek/logs");
+  auto& xs = get<vector>(get_data(msg));
+  REQUIRE_EQUAL(xs.size(), 2u);
+  CHECK_EQUAL(get<std::string>(xs[0]), "conn");
+}
@@ -20,3 +20,76 @@ TEST(event) {
   CHECK_EQUAL(ev2.name(), "test");
   CHECK_EQUAL(ev2.args(), args);
 }
+
+TEST(messages built from header prototypes keep the wire layout) {
+  zeek::Event ev("test", vector{1});
+  auto expected_ev = data{vector{zeek::ProtocolVersion, count{1},
+                                 vector{"test", vector{1}}}};
+  CHECK_EQUAL(ev.as_data(), expected_ev);
+  zeek::IdentifierUpdate iu("id", data{count{7}});
+  auto expected_iu = data{vector{zeek::ProtocolVersion, count{4},
+                                 vector{"id", count{7}}}};
+  CHECK_EQUAL(iu.as_data(), expected_iu);
+}
+
+TEST(validated event views skip per-accessor checks) {
+  zeek::Event ev("test", vector{1, "s"});
+  auto v = ev.make_view();
+  REQUIRE(v.valid());
+  CHECK_EQUAL(v.name(), "test");
+  CHECK_EQUAL(v.args().size(), 2u);
+  // Views reject structurally invalid messages up front.
+  CHECK(!zeek::Event::view::make(data{vector{count{1}, count{99}}}));
+  CHECK(!zeek::Event::view::make(data{"not a message"}));
+}
+
+TEST(validated log-write views expose all fields) {
+  zeek::LogWrite lw(enum_value{"stream"}, enum_value{"writer"}, data{"path"},
+                    data{"serial"});
+  auto v = zeek::LogWrite::view::make(lw.as_data());
+  REQUIRE(v.valid());
+  CHECK_EQUAL(v.stream_id().name, "stream");
+  CHECK_EQUAL(v.writer_id().name, "writer");
+  CHECK_EQUAL(get<std::string>(v.path()), "path");
+  CHECK_EQUAL(get<std::string>(v.serial_data()), "serial");
+  // An event is not a log write.
+  zeek::Event ev("test", vector{});
+  CHECK(!zeek::LogWrite::view::make(ev.as_data()));
+}
+
+TEST(batches support move-based extraction and view iteration) {
+  zeek::Batch batch{3};
+  batch.add(zeek::Event("a", vector{count{1}}));
+  batch.add(zeek::Event("b", vector{count{2}}));
+  batch.add(zeek::LogWrite(enum_value{"s"}, enum_value{"w"}, data{"p"},
+                           data{"d"}));
+  size_t events = 0;
+  size_t writes = 0;
+  for (auto view : batch) {
+    if (view.as_event())
+      ++events;
+    else if (view.as_log_write())
+      ++writes;
+  }
+  CHECK_EQUAL(events, 2u);
+  CHECK_EQUAL(writes, 1u);
+  auto moved = batch.take(1);
+  auto ev = zeek::Event::view::make(moved);
+  REQUIRE(ev);
+  CHECK_EQUAL(ev.name(), "b");
+  // The slot keeps a placeholder, so indices remain stable.
+  CHECK_EQUAL(batch.batch().size(), 3u);
+  CHECK(!zeek::Event::view::make(batch.batch()[1]));
+}
+
+TEST(size-hinted batch assembly) {
+  zeek::Batch batch{2};
+  CHECK(batch.valid());
+  CHECK_EQUAL(batch.batch().size(), 0u);
+  CHECK(batch.batch().capacity() >= 2u);
+  batch.add(zeek::Event("test", vector{1}));
+  batch.add(data{zeek::Event("test2", vector{2})});
+  REQUIRE_EQUAL(batch.batch().size(), 2u);
+  zeek::Event first(batch.batch()[0]);
+  CHECK_EQUAL(first.name(), "test");
+}
@@ -75,6 +75,59 @@ class TestCommunication(unittest.TestCase):
             dict_data["c"] = "not immutable"
             self.assertEqual(len(dict_data), 3)
 
+    def test_bulk_messages(self):
+        with broker.Endpoint() as ep1, \
+             broker.Endpoint() as ep2, \
+             ep1.make_subscriber("/test") as s1:
+
+            port = ep1.listen("127.0.0.1", 0)
+            ep2.peer("127.0.0.1", port, 1.0)
+
+            batch = [("/test/%d" % i, (i,)) for i in range(20)]
+            ep2.publish_batch(*batch)
+
+            msgs = s1.get_bulk(20)
+            self.assertFalse(s1.available())
+            self.assertEqual(msgs, batch)
+
+            # The timeout variant returns a partial batch on expiry.
+            msgs = s1.get_bulk(1, 0.2)
+            self.assertEqual(msgs, [])
+
+    def test_async_get(self):
+        import asyncio
+
+        with broker.Endpoint() as ep1, \
+             broker.Endpoint() as ep2, \
+             ep1.make_subscriber("/test") as s1:
+
+            port = ep1.listen("127.0.0.1", 0)
+            ep2.peer("127.0.0.1", port, 1.0)
+
+            async def consume():
+                msgs = []
+                while len(msgs) < 3:
+                    msgs.append(await s1.get_async())
+                return msgs
+
+            async def produce():
+                for i in range(3):
+                    ep2.publish("/test/%d" % i, (i,))
+                    await asyncio.sleep(0.01)
+
+            async def run():
+                consumer = asyncio.ensure_future(consume())
+                await produce()
+                return await consumer
+
+            loop = asyncio.new_event_loop()
+            try:
+                msgs = loop.run_until_complete(run())
+            finally:
+                loop.close()
+
+            self.assertEqual(msgs, [("/test/%d" % i, (i,)) for i in range(3)])
+
     def test_immutable_messages(self):
         with broker.Endpoint() as ep1, \
              broker.Endpoint() as ep2, \
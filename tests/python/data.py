@@ -361,5 +361,49 @@ class TestDataConstruction(unittest.TestCase):
 
         self.check_to_broker(v[3], 'nil', broker.Data.Type.Nil)
 
+    def test_as_numpy(self):
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest("numpy not available")
+
+        d = broker.Data([broker.Count(i) for i in range(100)])
+        a = d.as_numpy()
+        self.assertEqual(a.dtype, numpy.uint64)
+        self.assertFalse(a.flags.writeable)
+        self.assertTrue((a == numpy.arange(100, dtype=numpy.uint64)).all())
+
+        d = broker.Data([0.5 * i for i in range(100)])
+        a = d.as_numpy()
+        self.assertEqual(a.dtype, numpy.float64)
+        self.assertTrue((a == 0.5 * numpy.arange(100)).all())
+
+        self.assertEqual(len(broker.Data([]).as_numpy()), 0)
+
+        with self.assertRaises(ValueError):
+            broker.Data(42).as_numpy()
+        with self.assertRaises(ValueError):
+            broker.Data([1, 'mixed']).as_numpy()
+
+    def test_buffer_protocol(self):
+        # String payloads expose their bytes without an intermediate copy.
+        d = broker.Data('payload')
+        view = memoryview(d)
+        self.assertTrue(view.readonly)
+        self.assertEqual(view.tobytes(), b'payload')
+
+        # Vectors of counts appear as a (strided) array of 64-bit values.
+        d = broker.Data([broker.Count(i) for i in range(10)])
+        view = memoryview(d)
+        self.assertTrue(view.readonly)
+        self.assertEqual(view.itemsize, 8)
+        self.assertEqual(list(view), list(range(10)))
+
+        # Other payload types have no zero-copy representation.
+        with self.assertRaises(ValueError):
+            memoryview(broker.Data(42))
+        with self.assertRaises(ValueError):
+            memoryview(broker.Data([1, 'mixed']))
+
 if __name__ == '__main__':
     unittest.main(verbosity=3)
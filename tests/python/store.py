@@ -47,6 +47,26 @@ class TestStore(unittest.TestCase):
             self.assertEqual(x, "value")
             self.assertEqual(m.name(), "test")
 
+    def test_proxy_receive_all(self):
+        with broker.Endpoint() as ep1, \
+             ep1.attach_master("test", broker.Backend.Memory) as m:
+
+            m.put("a", 1)
+            m.put("b", 2)
+
+            proxy = m.make_proxy()
+            id_a = proxy.get("a")
+            id_b = proxy.get("b")
+            id_c = proxy.get("nope")
+
+            responses = []
+            while len(responses) < 3:
+                responses += proxy.receive_all()
+
+            self.assertEqual(responses[0], (id_a, 1))
+            self.assertEqual(responses[1], (id_b, 2))
+            self.assertEqual(responses[2], (id_c, None))
+
     def test_from_master(self):
         (ep0, ep1, ep2, m, c1, c2) = create_stores()
 